@@ -0,0 +1,596 @@
+# Generates a packed-state statechart model of cell behaviour from a description of the chart in JSON.
+#
+# Usage, from the project directory:
+#
+#   python PythonScripts/GenerateStatechart.py src/statechart/FateUncoupledFromCyclePacked.json
+#
+# This writes <chart>.hpp and <chart>Generated.cpp next to the description. With --check before the description,
+# nothing is written: the script fails if either file differs from what it would write, so a test can check
+# that the checked-in files are up to date with the description. They hold everything a
+# boost::statechart model spells out by hand: the states, the events that force the chart into a state, the
+# encoding of the state for saving and copying, and the dispatch of updates. The chart's behaviour, the entry
+# action and update reaction of each leaf state, is still written by hand, in <chart>.cpp.
+#
+# The generated chart keeps its whole state in one word, with a field for each orthogonal region holding the
+# number of the region's active leaf state. A transition writes the field and runs the new state's entry
+# action; nothing is allocated, and updates are dispatched with a switch on the field rather than through
+# boost::statechart's event queue.
+#
+# The description is a JSON object with:
+#
+#   chart          name of the chart, and of the generated files
+#   description    a sentence or two about the model, copied into the generated header
+#   variables      the chart's variables, saved with its state: a list of objects with a name, a comment and
+#                  "copied", whether a daughter cell's chart starts with the parent's value (otherwise the
+#                  entry actions set it). TimeInPhase is required.
+#   update_order   the regions, in the order each is updated when the cell is checked
+#   regions        the orthogonal regions, in order: objects with a name, the name of the initial state and
+#                  a list of states
+#
+# A state is an object with a name and either a list of inner states and an initial state (a composite
+# state), or (a leaf state) optionally:
+#
+#   entry          true if it has an entry action, Enter<name>()
+#   update         true if it reacts to updates, Update<name>(), which returns the leaf state of the same
+#                  region to move to, or NO_TRANSITION
+#   to             the leaf states an update may move to, checked in debug builds
+#   locals         names of variables of the state, set by its entry action. Like those of a boost statechart
+#                  state, they are not saved, unless also listed under saved.
+#   saved          those of its locals saved after the chart's variables, so that a restored chart keeps the
+#                  values its entry action drew rather than drawing them again. Each region saves one value per
+#                  name saved by any of its leaf states, 0 when the active leaf state has no such local.
+#
+# Leaf states are numbered from 1 in the order they are listed, and the number is the state's bit in
+# GetState(), so a generated chart whose states are listed in the same order as a boost::statechart chart's
+# states are numbered saves its state in the same way. At most 31 leaf states are allowed. The cell cycle
+# leaf states CellCycle_Mitosis_G1, _S, _G2 and _M are required by StatechartCellCycleModel.
+
+from __future__ import print_function
+
+import json
+import os
+import re
+import sys
+
+
+LICENSE = """/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+"""
+
+# Leaf states StatechartCellCycleModel forces the chart into, with the events it uses to do so
+CELL_CYCLE_EVENTS = [("CellCycle_Mitosis_G1", "EvGoToCellCycle_Mitosis_G1"),
+                     ("CellCycle_Mitosis_S", "EvGoToCellCycle_Mitosis_S"),
+                     ("CellCycle_Mitosis_G2", "EvGoToCellCycle_Mitosis_G2"),
+                     ("CellCycle_Mitosis_M", "EvGoToCellCycle_Mitosis_M")]
+
+MAX_LEAF_STATES = 31
+
+
+def Fail(message):
+    sys.stderr.write("GenerateStatechart: " + message + "\n")
+    sys.exit(1)
+
+
+def Require(condition, message):
+    if not condition:
+        Fail(message)
+
+
+def RegionConstant(name):
+    """CellCycle -> CELL_CYCLE_REGION"""
+    words = re.sub(r"([a-z0-9])([A-Z])", r"\1_\2", name)
+    return words.upper() + "_REGION"
+
+
+def Bits(numLeaves):
+    """Width of a field that can hold the numbers 0 to numLeaves-1"""
+    bits = 1
+    while (1 << bits) < numLeaves:
+        bits += 1
+    return bits
+
+
+class Chart(object):
+    """The description, checked and flattened into regions of numbered leaf states"""
+
+    def __init__(self, description):
+        for key in ["chart", "description", "variables", "update_order", "regions"]:
+            Require(key in description, "the description has no " + key)
+        self.name = description["chart"]
+        Require(re.match(r"^[A-Za-z][A-Za-z0-9_]*$", self.name) is not None, "bad chart name " + self.name)
+        self.description = description["description"]
+        self.variables = description["variables"]
+        for variable in self.variables:
+            Require("name" in variable, "a variable has no name")
+        Require("TimeInPhase" in [v["name"] for v in self.variables], "the chart needs a TimeInPhase variable")
+
+        self.regions = []       # name, first leaf number, number of leaves, initial leaf, shift, bits
+        self.leaves = []        # state objects, numbered from 1
+        self.leafRegion = {}    # leaf name -> region index
+        self.composites = []    # name, first leaf, last leaf
+        names = set()
+        shift = 0
+        for region in description["regions"]:
+            Require("name" in region and "states" in region, "a region needs a name and states")
+            Require(region["name"] not in names, "the name " + region["name"] + " is used twice")
+            names.add(region["name"])
+            first = len(self.leaves) + 1
+            self.AddStates(region["states"], len(self.regions), names)
+            initial = self.InitialLeaf(region, region["states"])
+            count = len(self.leaves) + 1 - first
+            Require(count > 0, "region " + region["name"] + " has no leaf states")
+            bits = Bits(count)
+            self.regions.append({"name": region["name"], "first": first, "count": count,
+                                 "initial": initial, "shift": shift, "bits": bits})
+            shift += bits
+        Require(len(self.leaves) <= MAX_LEAF_STATES, "at most %d leaf states are allowed" % MAX_LEAF_STATES)
+        Require(shift <= 32, "the state does not fit in one 32 bit word")
+        self.stateBits = shift
+
+        regionNames = [r["name"] for r in self.regions]
+        self.updateOrder = description["update_order"]
+        Require(sorted(self.updateOrder) == sorted(regionNames),
+                "update_order must list every region once")
+
+        self.leafNumber = dict((leaf["name"], i + 1) for i, leaf in enumerate(self.leaves))
+        for leaf in self.leaves:
+            for target in leaf.get("to", []):
+                Require(target in self.leafNumber, leaf["name"] + " moves to unknown leaf state " + target)
+                Require(self.leafRegion[target] == self.leafRegion[leaf["name"]],
+                        leaf["name"] + " moves to " + target + ", which is in another region")
+            Require(not leaf.get("to") or leaf.get("update"), leaf["name"] + " has transitions but no update")
+            for local in leaf.get("saved", []):
+                Require(local in leaf.get("locals", []), leaf["name"] + " saves " + local + ", which is not a local")
+        for state, event in CELL_CYCLE_EVENTS:
+            Require(state in self.leafNumber, "the chart needs a leaf state " + state)
+
+    def AddStates(self, states, regionIndex, names):
+        for state in states:
+            Require("name" in state, "a state has no name")
+            Require(state["name"] not in names, "the name " + state["name"] + " is used twice")
+            names.add(state["name"])
+            if "states" in state:
+                first = len(self.leaves) + 1
+                self.AddStates(state["states"], regionIndex, names)
+                self.composites.append({"name": state["name"], "first": first, "last": len(self.leaves)})
+            else:
+                self.leaves.append(state)
+                self.leafRegion[state["name"]] = regionIndex
+
+    def InitialLeaf(self, container, states):
+        initial = container.get("initial", states[0]["name"])
+        for state in states:
+            if state["name"] == initial:
+                if "states" in state:
+                    return self.InitialLeaf(state, state["states"])
+                return initial
+        Fail("the initial state " + initial + " of " + container["name"] + " is not one of its states")
+
+    def RegionOf(self, leafName):
+        return self.regions[self.leafRegion[leafName]]
+
+    def SavedLocals(self):
+        """Each region with saved locals, with the names it saves in order of first appearance"""
+        saved = []
+        for index, region in enumerate(self.regions):
+            names = []
+            for leaf in self.leaves:
+                if self.leafRegion[leaf["name"]] == index:
+                    names += [local for local in leaf.get("saved", []) if local not in names]
+            if names:
+                saved.append((region, names))
+        return saved
+
+
+def Header(chart, source):
+    name = chart.name
+    guard = name.upper() + "_HPP_"
+    out = [LICENSE]
+    out.append("// Generated from %s by PythonScripts/GenerateStatechart.py. Edit the" % source)
+    out.append("// description and run the script again, rather than editing this file. The entry actions and update")
+    out.append("// reactions are written by hand, in %s.cpp." % name)
+    out.append("")
+    out.append("#ifndef %s" % guard)
+    out.append("#define %s" % guard)
+    out.append("")
+    out.append("#include <StatechartCellCycleModel.hpp>")
+    out.append("#include <ElegansDevStatechartCellCycleModel.hpp>")
+    out.append("")
+    out.append("#include <bitset>")
+    out.append("#include <vector>")
+    out.append("#include <boost/cstdint.hpp>")
+    out.append("")
+    out.append("")
+    out.append("/*")
+    for line in WrapComment(chart.description):
+        out.append("* " + line)
+    out.append("*")
+    out.append("* The state is packed into one word, with a field for each orthogonal region holding the number of its")
+    out.append("* active leaf state:")
+    out.append("*")
+    width = max(len(r["name"]) for r in chart.regions) + 2
+    out.append("*   " + "region".ljust(width) + "bits    leaf states (initial first)")
+    for region in chart.regions:
+        bits = "%d" % region["shift"] if region["bits"] == 1 else "%d-%d" % (region["shift"], region["shift"] + region["bits"] - 1)
+        leaves = [l["name"] for l in chart.leaves[region["first"] - 1:region["first"] - 1 + region["count"]]]
+        leaves.remove(region["initial"])
+        lines = WrapComment(", ".join([region["initial"]] + leaves), 105 - width - 8)
+        out.append("*   " + region["name"].ljust(width) + bits.ljust(8) + lines[0])
+        for line in lines[1:]:
+            out.append("*   " + " " * (width + 8) + line)
+    out.append("*")
+    out.append("* Checking the cell updates the regions in the order " + ", ".join(chart.updateOrder) + ".")
+    out.append("*/")
+    out.append("struct %s{" % name)
+    out.append("")
+    out.append("  //Leaf states, numbered as their bits in GetState()")
+    out.append("  enum State{")
+    out.append("    NO_TRANSITION = 0,")
+    for i, leaf in enumerate(chart.leaves):
+        out.append("    %s = %d%s" % (leaf["name"], i + 1, "," if i + 1 < len(chart.leaves) else ""))
+    out.append("  };")
+    out.append("")
+    out.append("  //Orthogonal regions")
+    out.append("  enum Region{")
+    for i, region in enumerate(chart.regions):
+        out.append("    %s = %d," % (RegionConstant(region["name"]), i))
+    out.append("    NUM_REGIONS = %d" % len(chart.regions))
+    out.append("  };")
+    out.append("")
+    out.append("  %s();" % name)
+    out.append("")
+    out.append("  CellPtr pCell;")
+    out.append("  void SetCell(CellPtr newCell);")
+    out.append("")
+    out.append("  //Enters the initial state of every region, in order, running their entry actions")
+    out.append("  void initiate();")
+    out.append("")
+    out.append("  //Updates every region once. The other events force the cell cycle into a phase, re-entering it if it is")
+    out.append("  //already there, as a boost::statechart GOTO event does.")
+    out.append("  void process_event(const EvCheckCellData&);")
+    for state, event in CELL_CYCLE_EVENTS:
+        out.append("  void process_event(const %s&);" % event)
+    out.append("")
+    out.append("  //Copying, saving and restoring, as required by StatechartCellCycleModel")
+    out.append("  boost::shared_ptr<%s> CopyInto(boost::shared_ptr<%s> myNewStatechart);" % (name, name))
+    out.append("  std::bitset<MAX_STATE_COUNT> GetState();")
+    out.append("  std::vector<double> GetVariables();")
+    out.append("  void SetState(std::bitset<MAX_STATE_COUNT> state);")
+    out.append("  void SetVariables(std::vector<double> variableValues);")
+    out.append("")
+    out.append("  //Makes a leaf state the active state of its region, and runs its entry action")
+    out.append("  void Enter(State state);")
+    out.append("")
+    out.append("  //The active leaf state of a region")
+    out.append("  State GetLeaf(Region region) const{")
+    out.append("    return (State)(mFirstLeaf[region] + ((mStateWord >> mShifts[region]) & mMasks[region]));")
+    out.append("  }")
+    out.append("")
+    out.append("  //Whether a leaf state is active")
+    out.append("  bool IsIn(State state) const{")
+    out.append("    return GetLeaf((Region)mRegionOf[state]) == state;")
+    out.append("  }")
+    if chart.composites:
+        out.append("")
+        out.append("  //Whether a composite state is active")
+        for composite in chart.composites:
+            region = RegionConstant(chart.RegionOf(chart.leaves[composite["first"] - 1]["name"])["name"])
+            out.append("  bool IsIn%s() const{" % composite["name"])
+            out.append("    State leaf = GetLeaf(%s);" % region)
+            out.append("    return leaf >= %s && leaf <= %s;" % (chart.leaves[composite["first"] - 1]["name"],
+                                                                chart.leaves[composite["last"] - 1]["name"]))
+            out.append("  }")
+    out.append("")
+    out.append("  //The packed state")
+    out.append("  boost::uint32_t GetStateWord() const{")
+    out.append("    return mStateWord;")
+    out.append("  }")
+    out.append("")
+    out.append("  //Statechart associated variables")
+    for variable in chart.variables:
+        comment = variable.get("comment", "")
+        out.append("  double %s;%s" % (variable["name"], ("  //" + comment) if comment else ""))
+    withLocals = [l for l in chart.leaves if l.get("locals")]
+    if withLocals:
+        out.append("")
+        if chart.SavedLocals():
+            out.append("  //Variables of leaf states, set by their entry actions. Those listed as saved in the description")
+            out.append("  //are saved after the chart's variables.")
+        else:
+            out.append("  //Variables of leaf states, set by their entry actions. Not saved.")
+        for leaf in withLocals:
+            out.append("  struct{ %s } %sLocals;" % (" ".join("double %s;" % v for v in leaf["locals"]), leaf["name"]))
+    out.append("")
+    out.append("private:")
+    out.append("")
+    out.append("  boost::uint32_t mStateWord;")
+    out.append("")
+    out.append("  //Layout of the state word: each region's first leaf state, field position and field mask; and the")
+    out.append("  //region of each leaf state, the initial leaf state of each region, and the leaf states each leaf")
+    out.append("  //state's update may move to, as bits")
+    out.append("  static const unsigned mFirstLeaf[NUM_REGIONS];")
+    out.append("  static const unsigned mShifts[NUM_REGIONS];")
+    out.append("  static const boost::uint32_t mMasks[NUM_REGIONS];")
+    out.append("  static const unsigned mRegionOf[%d];" % (len(chart.leaves) + 1))
+    out.append("  static const State mInitialStates[NUM_REGIONS];")
+    out.append("  static const boost::uint32_t mTransitions[%d];" % (len(chart.leaves) + 1))
+    out.append("")
+    out.append("  //Entry actions and update reactions, written by hand in %s.cpp" % name)
+    for leaf in chart.leaves:
+        if leaf.get("entry"):
+            out.append("  void Enter%s();" % leaf["name"])
+        if leaf.get("update"):
+            out.append("  State Update%s();" % leaf["name"])
+    out.append("};")
+    out.append("")
+    out.append("")
+    out.append("#include \"SerializationExportWrapper.hpp\"")
+    out.append("EXPORT_TEMPLATE_CLASS1(StatechartCellCycleModel, %s)" % name)
+    out.append("EXPORT_TEMPLATE_CLASS1(ElegansDevStatechartCellCycleModel, %s)" % name)
+    out.append("")
+    out.append("#endif /*%s*/" % guard)
+    return "\n".join(out) + "\n"
+
+
+def Source(chart, source):
+    name = chart.name
+    out = [LICENSE]
+    out.append("// Generated from %s by PythonScripts/GenerateStatechart.py. Edit the" % source)
+    out.append("// description and run the script again, rather than editing this file.")
+    out.append("")
+    out.append("#include \"%s.hpp\"" % name)
+    out.append("")
+    out.append("")
+    out.append("const unsigned %s::mFirstLeaf[NUM_REGIONS] = {%s};" % (name, ", ".join(str(r["first"]) for r in chart.regions)))
+    out.append("const unsigned %s::mShifts[NUM_REGIONS] = {%s};" % (name, ", ".join(str(r["shift"]) for r in chart.regions)))
+    out.append("const boost::uint32_t %s::mMasks[NUM_REGIONS] = {%s};" % (name, ", ".join("%du" % ((1 << r["bits"]) - 1) for r in chart.regions)))
+    out.append("const unsigned %s::mRegionOf[%d] = {0, %s};" % (name, len(chart.leaves) + 1,
+               ", ".join(str(chart.leafRegion[l["name"]]) for l in chart.leaves)))
+    out.append("const %s::State %s::mInitialStates[NUM_REGIONS] = {%s};" % (name, name, ", ".join(r["initial"] for r in chart.regions)))
+    transitions = []
+    for leaf in chart.leaves:
+        mask = 0
+        for target in leaf.get("to", []):
+            mask |= 1 << chart.leafNumber[target]
+        transitions.append("0x%08xu" % mask)
+    out.append("const boost::uint32_t %s::mTransitions[%d] = {0u, %s};" % (name, len(chart.leaves) + 1, ", ".join(transitions)))
+    out.append("")
+    out.append("")
+    out.append("%s::%s(){" % (name, name))
+    out.append("  pCell = boost::shared_ptr<Cell>();")
+    out.append("  mStateWord = 0;")
+    for variable in chart.variables:
+        out.append("  %s = 0;" % variable["name"])
+    out.append("}")
+    out.append("")
+    out.append("")
+    out.append("void %s::SetCell(CellPtr newCell){" % name)
+    out.append("  assert(newCell!=NULL);")
+    out.append("  pCell = newCell;")
+    out.append("}")
+    out.append("")
+    out.append("")
+    out.append("void %s::initiate(){" % name)
+    out.append("  mStateWord = 0;")
+    out.append("  for (unsigned region = 0; region < NUM_REGIONS; region++){")
+    out.append("    Enter(mInitialStates[region]);")
+    out.append("  }")
+    out.append("}")
+    out.append("")
+    out.append("")
+    out.append("//Each region's update may move it to another leaf state, whose entry action runs before the next region")
+    out.append("//is updated")
+    out.append("void %s::process_event(const EvCheckCellData&){" % name)
+    out.append("  State next;")
+    for regionName in chart.updateOrder:
+        region = [r for r in chart.regions if r["name"] == regionName][0]
+        leaves = chart.leaves[region["first"] - 1:region["first"] - 1 + region["count"]]
+        updating = [l for l in leaves if l.get("update")]
+        out.append("")
+        if not updating:
+            out.append("  //%s: no state reacts to updates" % regionName)
+            continue
+        out.append("  switch (GetLeaf(%s)){" % RegionConstant(regionName))
+        for leaf in updating:
+            out.append("    case %s: next = Update%s(); break;" % (leaf["name"], leaf["name"]))
+        out.append("    default: next = NO_TRANSITION;")
+        out.append("  }")
+        out.append("  if (next != NO_TRANSITION){")
+        out.append("    assert(mTransitions[GetLeaf(%s)] & (1u << next));" % RegionConstant(regionName))
+        out.append("    Enter(next);")
+        out.append("  }")
+    out.append("}")
+    out.append("")
+    for state, event in CELL_CYCLE_EVENTS:
+        out.append("void %s::process_event(const %s&){" % (name, event))
+        out.append("  Enter(%s);" % state)
+        out.append("}")
+    out.append("")
+    out.append("")
+    out.append("void %s::Enter(State state){" % name)
+    out.append("  unsigned region = mRegionOf[state];")
+    out.append("  mStateWord = (mStateWord & ~(mMasks[region] << mShifts[region])) | ((state - mFirstLeaf[region]) << mShifts[region]);")
+    entering = [l for l in chart.leaves if l.get("entry")]
+    if entering:
+        out.append("  switch (state){")
+        for leaf in entering:
+            out.append("    case %s: Enter%s(); break;" % (leaf["name"], leaf["name"]))
+        out.append("    default: break;")
+        out.append("  }")
+    out.append("}")
+    out.append("")
+    out.append("")
+    out.append("//The daughter's chart enters the parent's states after its initial ones, so both entry actions run")
+    out.append("boost::shared_ptr<%s> %s::CopyInto(boost::shared_ptr<%s> myNewStatechart){" % (name, name, name))
+    out.append("  myNewStatechart->initiate();")
+    out.append("  for (unsigned region = 0; region < NUM_REGIONS; region++){")
+    out.append("    myNewStatechart->Enter(GetLeaf((Region)region));")
+    out.append("  }")
+    for variable in chart.variables:
+        if variable.get("copied"):
+            out.append("  myNewStatechart->%s = this->%s;" % (variable["name"], variable["name"]))
+    out.append("  return myNewStatechart;")
+    out.append("}")
+    out.append("")
+    out.append("")
+    out.append("std::bitset<MAX_STATE_COUNT> %s::GetState(){" % name)
+    out.append("  std::bitset<MAX_STATE_COUNT> state;")
+    out.append("  for (unsigned region = 0; region < NUM_REGIONS; region++){")
+    out.append("    state.set(GetLeaf((Region)region), 1);")
+    out.append("  }")
+    out.append("  return state;")
+    out.append("}")
+    out.append("")
+    out.append("")
+    out.append("//Enters every leaf state whose bit is set, in order")
+    out.append("void %s::SetState(std::bitset<MAX_STATE_COUNT> state){" % name)
+    out.append("  for (unsigned leaf = 1; leaf <= %s; leaf++){" % chart.leaves[-1]["name"])
+    out.append("    if (state[leaf]){")
+    out.append("      Enter((State)leaf);")
+    out.append("    }")
+    out.append("  }")
+    out.append("}")
+    out.append("")
+    out.append("")
+    out.append("std::vector<double> %s::GetVariables(){" % name)
+    out.append("  std::vector<double> variables;")
+    for variable in chart.variables:
+        out.append("  variables.push_back(%s);" % variable["name"])
+    savedLocals = chart.SavedLocals()
+    if savedLocals:
+        out.append("  //Then the saved locals of each region's active leaf state")
+    for region, names in savedLocals:
+        out.append("  switch (GetLeaf(%s)){" % RegionConstant(region["name"]))
+        for leaf in chart.leaves[region["first"] - 1:region["first"] - 1 + region["count"]]:
+            if leaf.get("saved"):
+                values = [(leaf["name"] + "Locals." + n) if n in leaf["saved"] else "0.0" for n in names]
+                out.append("    case %s: %s break;" % (leaf["name"], " ".join("variables.push_back(%s);" % v for v in values)))
+        out.append("    default: %s break;" % " ".join("variables.push_back(0.0);" for n in names))
+        out.append("  }")
+    out.append("  return variables;")
+    out.append("}")
+    out.append("")
+    out.append("")
+    if savedLocals:
+        out.append("//Call after SetState, which enters the active leaf states whose saved locals are restored. Variables")
+        out.append("//saved without the leaf states' locals leave the values the entry actions set.")
+    out.append("void %s::SetVariables(std::vector<double> variables){" % name)
+    for i, variable in enumerate(chart.variables):
+        out.append("  %s = variables.at(%d);" % (variable["name"], i))
+    if savedLocals:
+        out.append("  if (variables.size() > %d){" % len(chart.variables))
+        position = len(chart.variables)
+        for region, names in savedLocals:
+            out.append("    switch (GetLeaf(%s)){" % RegionConstant(region["name"]))
+            for leaf in chart.leaves[region["first"] - 1:region["first"] - 1 + region["count"]]:
+                if leaf.get("saved"):
+                    sets = ["%sLocals.%s = variables.at(%d);" % (leaf["name"], n, position + names.index(n))
+                            for n in leaf["saved"]]
+                    out.append("      case %s: %s break;" % (leaf["name"], " ".join(sets)))
+            out.append("      default: break;")
+            out.append("    }")
+            position += len(names)
+        out.append("  }")
+    out.append("}")
+    out.append("")
+    out.append("")
+    out.append("#include \"SerializationExportWrapperForCpp.hpp\"")
+    out.append("EXPORT_TEMPLATE_CLASS1(StatechartCellCycleModel, %s)" % name)
+    out.append("EXPORT_TEMPLATE_CLASS1(ElegansDevStatechartCellCycleModel, %s)" % name)
+    return "\n".join(out) + "\n"
+
+
+def WrapComment(text, width=105):
+    lines = []
+    line = ""
+    for word in text.split():
+        if line and len(line) + 1 + len(word) > width:
+            lines.append(line)
+            line = word
+        else:
+            line = (line + " " + word) if line else word
+    if line:
+        lines.append(line)
+    return lines
+
+
+def WriteIfChanged(path, text):
+    """Leaves an unchanged file alone, so that the build does not recompile it"""
+    if os.path.exists(path):
+        with open(path) as existing:
+            if existing.read() == text:
+                return
+    with open(path, "w") as output:
+        output.write(text)
+    print("Wrote " + path)
+
+
+def CheckUnchanged(path, text):
+    """Fails if a file is not what would be written to it"""
+    if not os.path.exists(path):
+        Fail(path + " is missing; run the script to generate it")
+    with open(path) as existing:
+        if existing.read() != text:
+            Fail(path + " differs from its description; run the script to regenerate it")
+
+
+def Main(arguments):
+    check = len(arguments) == 2 and arguments[0] == "--check"
+    if check:
+        arguments = arguments[1:]
+    if len(arguments) != 1:
+        Fail("usage: GenerateStatechart.py [--check] <chart description .json>")
+    path = arguments[0]
+    with open(path) as descriptionFile:
+        try:
+            description = json.load(descriptionFile)
+        except ValueError as error:
+            Fail("%s is not valid JSON: %s" % (path, error))
+    chart = Chart(description)
+    directory = os.path.dirname(path)
+    # The description's path is recorded relative to the project directory, wherever the script is run from
+    projectDirectory = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    source = os.path.relpath(os.path.abspath(path), projectDirectory).replace(os.sep, "/")
+    outputs = [(os.path.join(directory, chart.name + ".hpp"), Header(chart, source)),
+               (os.path.join(directory, chart.name + "Generated.cpp"), Source(chart, source))]
+    for outputPath, text in outputs:
+        if check:
+            CheckUnchanged(outputPath, text)
+        else:
+            WriteIfChanged(outputPath, text)
+
+
+if __name__ == "__main__":
+    Main(sys.argv[1:])
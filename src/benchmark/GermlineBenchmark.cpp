@@ -0,0 +1,345 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GermlineBenchmark.hpp"
+#include "GermlineSimulation.hpp"
+#include "GlobalParameterStruct.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SimulationTime.hpp"
+#include "OutputFileHandler.hpp"
+#include "Exception.hpp"
+
+#include <map>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <time.h>
+
+
+//Monotonic wall time, in seconds
+static double WallSeconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + 1e-9*now.tv_nsec;
+}
+
+
+//Median of a list of times, which is reordered
+static double Median(std::vector<double>& rValues)
+{
+    std::sort(rValues.begin(), rValues.end());
+    unsigned n = rValues.size();
+    return (n % 2 == 1) ? rValues[n/2] : 0.5*(rValues[n/2 - 1] + rValues[n/2]);
+}
+
+
+//Constructor
+GermlineBenchmark::GermlineBenchmark(std::string outputDirectory, double tubeLength, unsigned numSteps)
+    : mOutputDirectory(outputDirectory),
+      mTubeLength(tubeLength),
+      mNumSteps(numSteps)
+{
+    if (mNumSteps == 0){
+        EXCEPTION("A benchmark needs at least one timestep.");
+    }
+    unsigned sizes[] = {100, 1000, 10000, 100000};
+    mPopulationSizes.assign(sizes, sizes + 4);
+}
+
+
+//Setter for mPopulationSizes
+void GermlineBenchmark::SetPopulationSizes(const std::vector<unsigned>& rPopulationSizes)
+{
+    mPopulationSizes = rPopulationSizes;
+}
+
+
+//Names used in BenchmarkResults.txt
+std::string GermlineBenchmark::GetComponentName(unsigned component)
+{
+    const char* names[] = {"Neighbours", "Force", "BoundaryCondition", "CellVolumes", "Statechart", "Killers",
+                           "Output", "Total"};
+    if (component >= NUM_COMPONENTS){
+        EXCEPTION("There is no benchmark component " << component);
+    }
+    return names[component];
+}
+
+
+//Each population size in turn, smallest first
+void GermlineBenchmark::Run()
+{
+    mNsPerCellPerStep.assign(mPopulationSizes.size(), std::vector<double>(NUM_COMPONENTS, 0.0));
+
+    std::cout << "Cells";
+    for (unsigned component = 0; component < NUM_COMPONENTS; component++){
+        std::cout << "\t" << GetComponentName(component);
+    }
+    std::cout << "\t(ns per cell per step)" << std::endl;
+
+    for (unsigned sizeIndex = 0; sizeIndex < mPopulationSizes.size(); sizeIndex++){
+        RunPopulationSize(sizeIndex);
+        std::cout << mPopulationSizes[sizeIndex];
+        for (unsigned component = 0; component < NUM_COMPONENTS; component++){
+            std::cout << "\t" << mNsPerCellPerStep[sizeIndex][component];
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "Scaling exponents:";
+    for (unsigned component = 0; component < NUM_COMPONENTS; component++){
+        std::cout << " " << GetComponentName(component) << " " << GetScalingExponent(component);
+    }
+    std::cout << std::endl;
+}
+
+
+//The worm is an adult, so that contact inhibition, fertilisation and apoptosis all do their full work
+void GermlineBenchmark::RunPopulationSize(unsigned sizeIndex)
+{
+    unsigned numCells = mPopulationSizes[sizeIndex];
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+
+    double startTime = 40.0;
+    double timeStep = 1.0/parameters->PeekParameter(36);
+    SimulationTime::Destroy();
+    SimulationTime* p_time = SimulationTime::Instance();
+    p_time->SetStartTime(startTime);
+    p_time->SetEndTimeAndNumberOfTimeSteps(startTime + mNumSteps*timeStep, mNumSteps);
+
+    //The same gonad every time the benchmark is run
+    RandomNumberGenerator::Instance()->Reseed(0);
+    GermlineSimulation germline;
+    germline.SetupSynthetic(numCells, mTubeLength);
+    NodeBasedCellPopulation<3>& population = germline.rGetCellPopulation();
+    boost::shared_ptr<RepulsionForceSizeCorrected<3> > p_force = germline.GetForce();
+    boost::shared_ptr<LeaderCellBoundaryCondition<3> > p_boundary = germline.GetBoundaryCondition();
+    boost::shared_ptr<Fertilisation<3> > p_fertilisation = germline.GetFertilisation();
+    boost::shared_ptr<OocyteFatedCellApoptosis<3> > p_apoptosis = germline.GetApoptosis();
+
+    //Output every timestep, to a folder per population size
+    std::stringstream directory;
+    directory << mOutputDirectory << "/Cells" << numCells;
+    GonadArmDataOutput<3> dataOutput(1);
+    dataOutput.SetBoundaryCondition(p_boundary);
+    CellTrackingOutput<3> trackingOutput(1, 1);
+    LineageOutput<3> lineageOutput;
+    dataOutput.SetupSolve(population, directory.str());
+    trackingOutput.SetupSolve(population, directory.str());
+    lineageOutput.SetupSolve(population, directory.str());
+
+    std::vector<std::vector<double> > seconds(NUM_COMPONENTS, std::vector<double>(mNumSteps, 0.0));
+    for (unsigned step = 0; step < mNumSteps; step++){
+        p_time->IncrementTimeOneStep();
+        double start;
+
+        start = WallSeconds();
+        population.Update();
+        seconds[NEIGHBOURS][step] = WallSeconds() - start;
+
+        std::map<Node<3>*, c_vector<double, 3> > oldLocations;
+        for (AbstractMesh<3,3>::NodeIterator node_iter = population.rGetMesh().GetNodeIteratorBegin();
+             node_iter != population.rGetMesh().GetNodeIteratorEnd(); ++node_iter)
+        {
+            node_iter->ClearAppliedForce();
+            oldLocations[&(*node_iter)] = node_iter->rGetLocation();
+        }
+        start = WallSeconds();
+        p_force->AddForceContribution(population);
+        seconds[FORCE][step] = WallSeconds() - start;
+
+        start = WallSeconds();
+        p_boundary->ImposeBoundaryCondition(oldLocations);
+        seconds[BOUNDARY_CONDITION][step] = WallSeconds() - start;
+
+        start = WallSeconds();
+        for (AbstractCellPopulation<3>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter){
+            cell_iter->GetCellData()->SetItem("volume", population.GetVolumeOfCell(*cell_iter));
+        }
+        seconds[CELL_VOLUMES][step] = WallSeconds() - start;
+
+        start = WallSeconds();
+        for (AbstractCellPopulation<3>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter){
+            cell_iter->ReadyToDivide();
+        }
+        seconds[STATECHART][step] = WallSeconds() - start;
+
+        start = WallSeconds();
+        p_fertilisation->CheckAndLabelCellsForApoptosisOrDeath();
+        p_apoptosis->CheckAndLabelCellsForApoptosisOrDeath();
+        seconds[KILLERS][step] = WallSeconds() - start;
+
+        start = WallSeconds();
+        dataOutput.UpdateAtEndOfTimeStep(population);
+        trackingOutput.UpdateAtEndOfTimeStep(population);
+        lineageOutput.UpdateAtEndOfTimeStep(population);
+        seconds[OUTPUT][step] = WallSeconds() - start;
+
+        //The total leaves out the benchmark's own bookkeeping
+        for (unsigned component = 0; component < TOTAL; component++){
+            seconds[TOTAL][step] += seconds[component][step];
+        }
+    }
+    for (unsigned component = 0; component < NUM_COMPONENTS; component++){
+        mNsPerCellPerStep[sizeIndex][component] = 1e9*Median(seconds[component])/numCells;
+    }
+}
+
+
+//Getter
+double GermlineBenchmark::GetNsPerCellPerStep(unsigned sizeIndex, unsigned component) const
+{
+    if (sizeIndex >= mNsPerCellPerStep.size() || component >= NUM_COMPONENTS){
+        EXCEPTION("No benchmark result for population size " << sizeIndex << " and component " << component);
+    }
+    return mNsPerCellPerStep[sizeIndex][component];
+}
+
+
+//Least squares slope of log(ns per step) against log(cells). Sizes where a component took no measurable time
+//are left out.
+double GermlineBenchmark::GetScalingExponent(unsigned component) const
+{
+    double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+    unsigned n = 0;
+    for (unsigned sizeIndex = 0; sizeIndex < mNsPerCellPerStep.size(); sizeIndex++){
+        double nsPerStep = GetNsPerCellPerStep(sizeIndex, component)*mPopulationSizes[sizeIndex];
+        if (nsPerStep <= 0.0){
+            continue;
+        }
+        double x = log((double)mPopulationSizes[sizeIndex]);
+        double y = log(nsPerStep);
+        sumX += x;
+        sumY += y;
+        sumXX += x*x;
+        sumXY += x*y;
+        n++;
+    }
+    double denominator = n*sumXX - sumX*sumX;
+    if (n < 2 || denominator <= 0.0){
+        return 0.0;
+    }
+    return (n*sumXY - sumX*sumY)/denominator;
+}
+
+
+//One row per component and population size
+void GermlineBenchmark::WriteResults() const
+{
+    OutputFileHandler handler(mOutputDirectory, false);
+    out_stream RESULTS = handler.OpenOutputFile("BenchmarkResults.txt");
+    *RESULTS << "Component\tCells\tNsPerCellPerStep\tScalingExponent\n";
+    for (unsigned component = 0; component < NUM_COMPONENTS; component++){
+        double exponent = GetScalingExponent(component);
+        for (unsigned sizeIndex = 0; sizeIndex < mNsPerCellPerStep.size(); sizeIndex++){
+            *RESULTS << GetComponentName(component) << "\t" << mPopulationSizes[sizeIndex] << "\t"
+                     << std::setprecision(6) << mNsPerCellPerStep[sizeIndex][component] << "\t" << exponent << "\n";
+        }
+    }
+    RESULTS->close();
+}
+
+
+//Matches rows by component name and number of cells
+unsigned GermlineBenchmark::CompareWithEarlierResults(std::string earlierDirectory, double tolerance, std::ostream& rOut) const
+{
+    std::string earlierFile = OutputFileHandler::GetChasteTestOutputDirectory() + earlierDirectory + "/BenchmarkResults.txt";
+    std::ifstream EARLIER(earlierFile.c_str());
+    if (!EARLIER.is_open()){
+        EXCEPTION("Failed to open " << earlierFile);
+    }
+    std::map<std::pair<std::string, unsigned>, double> earlierTimes;
+    std::string line;
+    std::getline(EARLIER, line);    // <- column names
+    while (std::getline(EARLIER, line)){
+        std::istringstream row(line);
+        std::string component;
+        unsigned cells;
+        double nsPerCellPerStep;
+        if (row >> component >> cells >> nsPerCellPerStep){
+            earlierTimes[std::make_pair(component, cells)] = nsPerCellPerStep;
+        }
+    }
+
+    OutputFileHandler handler(mOutputDirectory, false);
+    out_stream COMPARISON = handler.OpenOutputFile("BenchmarkComparison.txt");
+    *COMPARISON << "Component\tCells\tEarlierNsPerCellPerStep\tNsPerCellPerStep\tRatio\n";
+    rOut << "Compared with " << earlierDirectory << " (ratio of times, now over earlier):" << std::endl;
+
+    unsigned numSlower = 0;
+    for (unsigned component = 0; component < NUM_COMPONENTS; component++){
+        for (unsigned sizeIndex = 0; sizeIndex < mNsPerCellPerStep.size(); sizeIndex++){
+            std::map<std::pair<std::string, unsigned>, double>::const_iterator earlier =
+                earlierTimes.find(std::make_pair(GetComponentName(component), mPopulationSizes[sizeIndex]));
+            if (earlier == earlierTimes.end() || earlier->second <= 0.0){
+                continue;
+            }
+            double now = mNsPerCellPerStep[sizeIndex][component];
+            double ratio = now/earlier->second;
+            *COMPARISON << GetComponentName(component) << "\t" << mPopulationSizes[sizeIndex] << "\t"
+                        << earlier->second << "\t" << now << "\t" << ratio << "\n";
+
+            bool slower = ratio > 1.0 + tolerance;
+            bool faster = ratio < 1.0/(1.0 + tolerance);
+            rOut << GetComponentName(component) << "\t" << mPopulationSizes[sizeIndex] << "\t" << ratio
+                 << (slower ? "\tSLOWER" : (faster ? "\tfaster" : "")) << std::endl;
+            if (slower){
+                numSlower++;
+            }
+        }
+    }
+    COMPARISON->close();
+    return numSlower;
+}
+
+
+//Getters
+const std::vector<unsigned>& GermlineBenchmark::rGetPopulationSizes() const
+{
+    return mPopulationSizes;
+}
+
+double GermlineBenchmark::GetTubeLength() const
+{
+    return mTubeLength;
+}
+
+unsigned GermlineBenchmark::GetNumSteps() const
+{
+    return mNumSteps;
+}
@@ -0,0 +1,173 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GERMLINEBENCHMARK_HPP_
+#define GERMLINEBENCHMARK_HPP_
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+/*
+* Times each part of a germline simulation step on synthetic gonads of increasing size (see
+* GermlineSimulation::SetupSynthetic), to show how the cost of each part scales with the number of cells.
+*
+* For each population size, the parts are run one after another for a number of timesteps, in the order the
+* simulation runs them: the neighbour search (the population update), the force, the boundary condition, the
+* cell volumes, the statechart updates, the two cell killers and the three output modifiers (sampling every
+* timestep). Nothing moves the cells other than the boundary condition, so every timestep does the same work.
+* Each part's time is the median over the timesteps, reported in nanoseconds per cell per timestep, and each
+* part's scaling exponent is the slope of a least squares fit of log(time per timestep) against log(cells):
+* 1 for a part whose cost grows in proportion to the number of cells.
+*
+* Results are written to BenchmarkResults.txt in the output directory, a tab delimited table with columns
+* Component, Cells, NsPerCellPerStep and ScalingExponent, and can be compared with the results of an earlier
+* benchmark (see CompareWithEarlierResults).
+*/
+
+class GermlineBenchmark
+{
+public:
+
+    //The timed parts of a step, plus their total
+    enum Component
+    {
+        NEIGHBOURS,
+        FORCE,
+        BOUNDARY_CONDITION,
+        CELL_VOLUMES,
+        STATECHART,
+        KILLERS,
+        OUTPUT,
+        TOTAL,
+        NUM_COMPONENTS
+    };
+
+private:
+
+    //Output directory, relative to where Chaste output is stored
+    std::string mOutputDirectory;
+
+    //Length of the synthetic gonads, in microns
+    double mTubeLength;
+
+    //Number of timesteps timed at each population size
+    unsigned mNumSteps;
+
+    //Number of cells in each synthetic gonad
+    std::vector<unsigned> mPopulationSizes;
+
+    //Median nanoseconds per cell per timestep, for each population size and component
+    std::vector<std::vector<double> > mNsPerCellPerStep;
+
+    //Builds one synthetic gonad and times its steps
+    void RunPopulationSize(unsigned sizeIndex);
+
+public:
+
+    /**
+    * Constructor. The population sizes default to 100, 1000, 10000 and 100000 cells.
+    *
+    * @param outputDirectory the output directory, relative to where Chaste output is stored
+    * @param tubeLength the length of the synthetic gonads, in microns
+    * @param numSteps the number of timesteps to time at each population size
+    */
+    GermlineBenchmark(std::string outputDirectory, double tubeLength, unsigned numSteps);
+
+
+    //Setter for mPopulationSizes
+    void SetPopulationSizes(const std::vector<unsigned>& rPopulationSizes);
+
+
+    /**
+    * Runs the benchmark at every population size, printing the results as they come. Needs the global
+    * parameters to have been read in; the simulation time is reset for each population size.
+    */
+    void Run();
+
+
+    /**
+    * @return the name of a component, as written to BenchmarkResults.txt
+    *
+    * @param component the component
+    */
+    static std::string GetComponentName(unsigned component);
+
+
+    /**
+    * @return the median time a component took, in nanoseconds per cell per timestep
+    *
+    * @param sizeIndex index into the population sizes
+    * @param component the component
+    */
+    double GetNsPerCellPerStep(unsigned sizeIndex, unsigned component) const;
+
+
+    /**
+    * @return the exponent of the power law that best fits a component's time per timestep against the
+    * number of cells
+    *
+    * @param component the component
+    */
+    double GetScalingExponent(unsigned component) const;
+
+
+    /**
+    * Writes BenchmarkResults.txt to the output directory.
+    */
+    void WriteResults() const;
+
+
+    /**
+    * Compares these results with those of an earlier benchmark, for each component and population size the
+    * two have in common, writing the times and their ratio (now over earlier) to BenchmarkComparison.txt in the
+    * output directory and to rOut.
+    *
+    * @param earlierDirectory the earlier benchmark's output directory, relative to where Chaste output is stored
+    * @param tolerance the fraction by which a time may exceed the earlier one before it counts as slower
+    * @param rOut stream to print the comparison to
+    * @return the number of times that are slower than the earlier ones by more than the tolerance
+    */
+    unsigned CompareWithEarlierResults(std::string earlierDirectory, double tolerance, std::ostream& rOut) const;
+
+
+    //Getters
+    const std::vector<unsigned>& rGetPopulationSizes() const;
+    double GetTubeLength() const;
+    unsigned GetNumSteps() const;
+
+};
+
+#endif /*GERMLINEBENCHMARK_HPP_*/
@@ -34,8 +34,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "DTCMovementModel.hpp"
+#include "GermlineProfiler.hpp"
 #include "NodeBasedCellPopulation.hpp"
 #include "GlobalParameterStruct.hpp"
+#include "Exception.hpp"
 
 #include <cmath>
 #include <vector>
@@ -57,7 +59,10 @@ DTCMovementModel<DIM>::DTCMovementModel(bool Unc5Initial,
     PathPointCollection(startingLocations),
     PathPointTypes(startingTypes),
     CurrentLocation(currentLocation),
-    Spacing(spacing)
+    Spacing(spacing),
+    mArm(0),
+    mLeaderNodeIndex(0),
+    mMultipleArms(false)
 {   
     //Get the radius of the DTC turn
     WormBodyRadius = GlobalParameterStruct::Instance()->GetParameter(7);
@@ -77,6 +82,7 @@ DTCMovementModel<DIM>::~DTCMovementModel(){}
 template<unsigned DIM>
 void DTCMovementModel<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM, DIM>& rCellPopulation)
 {
+    ScopedProfileTimer timer(GermlineProfiler::DTC_MOVEMENT);
 
     //This block updates the genes Vab3 and Unc5 dependent on time (i.e. worm age). 
     //After a delay, Unc5 switches on, and the DTC turns onto the dorsal surface
@@ -95,6 +101,9 @@ void DTCMovementModel<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM, DI
         DTCBeingPushed = false;
         for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
             cell_iter != rCellPopulation.End(); ++cell_iter){
+            if (mMultipleArms && cell_iter->GetCellData()->GetItem("Arm") != (double)mArm){
+                continue;                                                       //Only cells in this DTC's arm can push it
+            }
             if (cell_iter->GetCellData()->GetItem("IsDTC") == 0.0 &&            //If there's a germ cell present (not DTC)
                 cell_iter->GetCellData()->GetItem("DistanceAwayFromDTC") < 5){  //within 5 microns, DTC is being pushed.
                 DTCBeingPushed = true;
@@ -129,6 +138,7 @@ void DTCMovementModel<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM, DI
 
     //Work out how fast the DTC angle should be changing in a turn, given DTC migration speed  
     double timestep = SimulationTime::Instance()->GetTimeStep();
+    double direction = (mArm == 1) ? -1.0 : 1.0;  //Direction along z away from the worm's centre
     double thetaIncrement = (currentSpeed*timestep) / WormBodyRadius;
     
 
@@ -164,7 +174,7 @@ void DTCMovementModel<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM, DI
 
             //If the middle of the dorsal surface has been reached, let the DTC migrate back toward the middle of the worm
             if (theta >= -0.1 && theta <= 0.1){
-                CurrentLocation[2] -= currentSpeed*timestep;
+                CurrentLocation[2] -= direction*currentSpeed*timestep;
                 pointType = 2;
 
             //If the DTC is not in the centre of the dorsal surface, let it migrate toward it, making a turn
@@ -182,12 +192,12 @@ void DTCMovementModel<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM, DI
 
         }else{
             //If the turn hasn't started yet, the DTC moves away from the worm's centre along the ventral side
-            CurrentLocation[2] += currentSpeed*timestep;
+            CurrentLocation[2] += direction*currentSpeed*timestep;
             pointType = 0;
         }
 
         //Update the DTC position in the mechanics simulation
-        rCellPopulation.GetNode(0)->rGetModifiableLocation() = CurrentLocation;
+        rCellPopulation.GetNode(mLeaderNodeIndex)->rGetModifiableLocation() = CurrentLocation;
     }
 
     //If the DTC has moved further than the spacing interval, add a new point to the PointCollection
@@ -220,15 +230,15 @@ void DTCMovementModel<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM, DI
                     otherStraightEndIndex = i - 1;
                 }
                 if (PathPointTypes[i] == 1){
-                    PathPointCollection[i][2] += Spacing; //Translate the loop points by updating their positions
+                    PathPointCollection[i][2] += direction*Spacing; //Translate the loop points by updating their positions
                 }
             }
 
             //Work out the locations of the two new required points
             c_vector<double, DIM> newPoint1 = PathPointCollection[oneStraightEndIndex];
-            newPoint1[2] += Spacing;
+            newPoint1[2] += direction*Spacing;
             c_vector<double, DIM> newPoint2 = PathPointCollection[otherStraightEndIndex + 1];
-            newPoint2[2] += Spacing;
+            newPoint2[2] += direction*Spacing;
 
             //Make space for these new points in the collection vectors
             int currentSize = PathPointTypes.size();
@@ -295,6 +305,41 @@ template<unsigned DIM>
 bool DTCMovementModel<DIM>::getVab3() const{
     return Vab3;
 }
+template<unsigned DIM>
+bool DTCMovementModel<DIM>::getTurnComplete() const{
+    return TurnComplete;
+}
+
+
+//Setter for TurnComplete
+template<unsigned DIM>
+void DTCMovementModel<DIM>::setTurnComplete(bool turnComplete){
+    TurnComplete = turnComplete;
+}
+
+
+//Arm settings
+template<unsigned DIM>
+void DTCMovementModel<DIM>::setArm(unsigned arm, unsigned leaderNodeIndex){
+    if (arm > 1){
+        EXCEPTION("A gonad has at most two arms, numbered 0 and 1.");
+    }
+    mArm = arm;
+    mLeaderNodeIndex = leaderNodeIndex;
+    mMultipleArms = true;
+}
+template<unsigned DIM>
+unsigned DTCMovementModel<DIM>::getArm() const{
+    return mArm;
+}
+template<unsigned DIM>
+unsigned DTCMovementModel<DIM>::getLeaderNodeIndex() const{
+    return mLeaderNodeIndex;
+}
+template<unsigned DIM>
+bool DTCMovementModel<DIM>::hasMultipleArms() const{
+    return mMultipleArms;
+}
 
 
 //Nothing to do on setup here...
@@ -311,6 +356,7 @@ void DTCMovementModel<DIM>::OutputSimulationModifierParameters(out_stream& rPara
     *rParamsFile << "\t\t\t<Unc5Value>" << getUnc5() << "</Unc5Value>\n";
     *rParamsFile << "\t\t\t<Vab3Value>" << getVab3() << "</Vab3Value>\n";
     *rParamsFile << "\t\t\t<PointOnPathSpacing>" << getSpacing() << "</PointOnPathSpacing>\n";
+    *rParamsFile << "\t\t\t<Arm>" << getArm() << "</Arm>\n";
     //call method on direct parent class
     AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
 }
@@ -37,6 +37,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define DTCMOVEMENTMODEL_HPP_
 
 #include "ChasteSerialization.hpp"
+#include "ChasteSerializationVersion.hpp"
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/string.hpp>
 
@@ -49,6 +50,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 * This modifier can be used together with a LeaderCellBoundaryCondition, to produce a tubular boundary 
 * condition enforced allong the path of the moving cell.
 *
+* A population can hold more than one gonad arm, each led by its own DTC with its own modifier (see setArm).
+* Each cell then has an "Arm" cell data item, and each modifier only looks at the cells of its own arm. Arm 0
+* migrates away from the worm's centre along +z, and arm 1 is its mirror image, migrating along -z.
+*
 * This particular modifier is C. elegans germline specific, reflecting the motion of the Distal Tip Cell during 
 * gonad development. To model other leader cells, it is recommended to create a new class inheriting from 
 * AbstractCellBasedSimulationModifier and use this file as a guide to produce the desired pattern of movement.
@@ -66,6 +71,12 @@ private:
     void serialize(Archive & archive, const unsigned int version)
     {
         archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM, DIM> >(*this);
+        //Archives from before gonads could have several arms hold a single arm, as constructed
+        if (version >= 1){
+            archive & mArm;
+            archive & mLeaderNodeIndex;
+            archive & mMultipleArms;
+        }
     }
 
     /* Some C. elegans specific variables: */
@@ -81,6 +92,11 @@ private:
     std::vector< int > PathPointTypes;                         //A flag associated with each point, for additional info
     c_vector < double, DIM > CurrentLocation;                  //Current leader cell position           
     double Spacing;                                            //Separation of points on path
+
+    //Which arm this leader cell leads, its node index, and whether the population has more than one arm
+    unsigned mArm;
+    unsigned mLeaderNodeIndex;
+    bool mMultipleArms;
      
 
 public:
@@ -139,6 +155,26 @@ public:
     double getTimeSinceLastUpdate() const;
     bool getUnc5() const;
     bool getVab3() const;
+    bool getTurnComplete() const;
+
+    //Setter for TurnComplete, which is worked out as the DTC moves. Used when restoring a saved simulation.
+    void setTurnComplete(bool turnComplete);
+
+
+    /**
+    * Makes this the leader cell of one arm of a gonad with more than one arm. Only cells whose "Arm" cell data
+    * matches are then considered, and arm 1 migrates in the opposite direction along z to arm 0. The path
+    * points given to the constructor must already lie along the arm.
+    *
+    * @param arm the arm, 0 or 1
+    * @param leaderNodeIndex the node index of the arm's DTC
+    */
+    void setArm(unsigned arm, unsigned leaderNodeIndex);
+
+    //Getters for the arm settings
+    unsigned getArm() const;
+    unsigned getLeaderNodeIndex() const;
+    bool hasMultipleArms() const;
 
 
     /**
@@ -160,6 +196,17 @@ namespace boost
 {
     namespace serialization
     {
+        /**
+        * Specify a version number for archive backwards compatibility. Version 1 added the arm members;
+        * this is how to do BOOST_CLASS_VERSION(DTCMovementModel, 1) with a templated class.
+        */
+        template<unsigned DIM>
+        struct version<DTCMovementModel<DIM> >
+        {
+            ///Macro to set the version number of templated archive in known versions of Boost
+            CHASTE_VERSION_CONTENT(1);
+        };
+
         /**
         * Serialize information required to construct a DTCMovementModel.
         */
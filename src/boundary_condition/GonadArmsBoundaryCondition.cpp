@@ -0,0 +1,159 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GonadArmsBoundaryCondition.hpp"
+#include "GermlineProfiler.hpp"
+#include "GermlineThreadPool.hpp"
+#include "Exception.hpp"
+
+
+//Applies one arm's boundary condition per task
+template<unsigned DIM>
+class ImposeArmTask : public AbstractParallelTask
+{
+private:
+    const std::vector<boost::shared_ptr<LeaderCellBoundaryCondition<DIM> > >& mrArms;
+
+public:
+    ImposeArmTask(const std::vector<boost::shared_ptr<LeaderCellBoundaryCondition<DIM> > >& rArms)
+        : mrArms(rArms)
+    {
+    }
+
+    void RunTask(unsigned taskIndex)
+    {
+        mrArms[taskIndex]->ImposeOnArm();
+    }
+};
+
+
+//Constructor
+template<unsigned DIM>
+GonadArmsBoundaryCondition<DIM>::GonadArmsBoundaryCondition(AbstractCellPopulation<DIM>* pCellPopulation)
+  : AbstractCellPopulationBoundaryCondition<DIM>(pCellPopulation)
+{
+}
+
+
+
+//Adds the next arm
+template<unsigned DIM>
+void GonadArmsBoundaryCondition<DIM>::AddArm(boost::shared_ptr<LeaderCellBoundaryCondition<DIM> > pArm)
+{
+  if (pArm->GetLeaderCellModifier()->getArm() != mArms.size()){
+    EXCEPTION("Arm " << mArms.size() << " was given the boundary condition of arm "
+              << pArm->GetLeaderCellModifier()->getArm() << ".");
+  }
+  mArms.push_back(pArm);
+}
+
+
+
+//Each arm's condition only moves that arm's cells, so the arms can be done at once. If the arms share out
+//their cells between slabs they already use the thread pool, so are done one after the other instead.
+template<unsigned DIM>
+void GonadArmsBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations)
+{
+  ScopedProfileTimer timer(GermlineProfiler::BOUNDARY_CONDITION);
+  bool armsUseSlabs = false;
+  for (unsigned arm = 0; arm < mArms.size(); arm++){
+    boost::shared_ptr<ArcLengthSlabs<DIM> > pSlabs = mArms[arm]->GetSlabs();
+    if (pSlabs && pSlabs->GetNumSlabs() > 1){
+      armsUseSlabs = true;
+    }
+  }
+  if (armsUseSlabs){
+    for (unsigned arm = 0; arm < mArms.size(); arm++){
+      mArms[arm]->ImposeOnArm();
+    }
+  }else{
+    ImposeArmTask<DIM> task(mArms);
+    GermlineThreadPool::Instance()->Run(task, mArms.size());
+  }
+}
+
+
+
+//As for LeaderCellBoundaryCondition, nothing to check
+template<unsigned DIM>
+bool GonadArmsBoundaryCondition<DIM>::VerifyBoundaryCondition()
+{
+  bool condition_satisfied = true;
+  return condition_satisfied;
+}
+
+
+
+//Getters
+template<unsigned DIM>
+unsigned GonadArmsBoundaryCondition<DIM>::GetNumArms() const
+{
+  return mArms.size();
+}
+
+template<unsigned DIM>
+boost::shared_ptr<LeaderCellBoundaryCondition<DIM> > GonadArmsBoundaryCondition<DIM>::GetArm(unsigned arm) const
+{
+  if (arm >= mArms.size()){
+    EXCEPTION("The gonad has no arm " << arm << ".");
+  }
+  return mArms[arm];
+}
+
+
+
+//Parameter output to log file
+template<unsigned DIM>
+void GonadArmsBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditionParameters(out_stream& rParamsFile)
+{
+  *rParamsFile << "\t\t\t<NumArms>" << mArms.size() << "</NumArms>\n";
+
+  // Call method on parent class
+  AbstractCellPopulationBoundaryCondition<DIM>::OutputCellPopulationBoundaryConditionParameters(rParamsFile);
+}
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class GonadArmsBoundaryCondition<1>;
+template class GonadArmsBoundaryCondition<2>;
+template class GonadArmsBoundaryCondition<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GonadArmsBoundaryCondition)
@@ -0,0 +1,165 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GONADARMSBOUNDARYCONDITION_HPP_
+#define GONADARMSBOUNDARYCONDITION_HPP_
+
+#include "AbstractCellPopulationBoundaryCondition.hpp"
+#include "LeaderCellBoundaryCondition.hpp"
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+
+/**
+* The boundary condition of a gonad with more than one arm: holds one LeaderCellBoundaryCondition per arm,
+* each keeping its own arm's cells in its own tube, and applies them together. The arms share no cells, so
+* their conditions are shared out among the threads of the GermlineThreadPool.
+*/
+
+template<unsigned DIM>
+class GonadArmsBoundaryCondition : public AbstractCellPopulationBoundaryCondition<DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+    * Serialize the object.
+    * @param archive the archive
+    * @param version the current version of this class
+    */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellPopulationBoundaryCondition<DIM> >(*this);
+        archive & mArms;
+    }
+
+
+    //The boundary condition of each arm, in order of arm
+    std::vector<boost::shared_ptr<LeaderCellBoundaryCondition<DIM> > > mArms;
+
+public:
+
+
+    /**
+    * Constructor.
+    *
+    * @param pCellPopulation pointer to the cell population
+    */
+    GonadArmsBoundaryCondition(AbstractCellPopulation<DIM>* pCellPopulation);
+
+
+    /**
+    * Adds the boundary condition of the next arm.
+    *
+    * @param pArm the arm's boundary condition, whose leader cell must lead that arm (see DTCMovementModel::setArm)
+    */
+    void AddArm(boost::shared_ptr<LeaderCellBoundaryCondition<DIM> > pArm);
+
+
+    /**
+    * Overridden ImposeBoundaryCondition() method.
+    * Apply each arm's boundary condition, on as many threads as the thread pool has.
+    *
+    * @param rOldLocations the node locations before any boundary conditions are applied
+    */
+    void ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations);
+
+
+    /**
+    * Overridden VerifyBoundaryCondition() method.
+    * Verify the boundary conditions have been applied.
+    *
+    * @return whether the boundary conditions are satisfied.
+    */
+    bool VerifyBoundaryCondition();
+
+
+    //Getters
+    unsigned GetNumArms() const;
+    boost::shared_ptr<LeaderCellBoundaryCondition<DIM> > GetArm(unsigned arm) const;
+
+
+    /**
+    * Overridden OutputCellPopulationBoundaryConditionParameters() method.
+    * Output cell population boundary condition parameters to file.
+    *
+    * @param rParamsFile the file stream to which the parameters are output
+    */
+    void OutputCellPopulationBoundaryConditionParameters(out_stream& rParamsFile);
+};
+
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GonadArmsBoundaryCondition)
+
+namespace boost
+{
+    namespace serialization
+    {
+        /**
+        * Serialize information required to construct a GonadArmsBoundaryCondition.
+        */
+        template<class Archive, unsigned DIM>
+        inline void save_construct_data(
+            Archive & ar, const GonadArmsBoundaryCondition<DIM>* t, const BOOST_PFTO unsigned int file_version)
+        {
+            // Save data required to construct instance
+            const AbstractCellPopulation<DIM>* const p_cell_population = t->GetCellPopulation();
+            ar << p_cell_population;
+        }
+
+
+        /**
+        * De-serialize constructor parameters and initialize a GonadArmsBoundaryCondition.
+        */
+        template<class Archive, unsigned DIM>
+        inline void load_construct_data(
+            Archive & ar, GonadArmsBoundaryCondition<DIM>* t, const unsigned int file_version)
+        {
+            // Retrieve data from archive required to construct new instance
+            AbstractCellPopulation<DIM>* p_cell_population;
+            ar >> p_cell_population;
+
+            // Invoke inplace constructor to initialise instance
+            ::new(t)GonadArmsBoundaryCondition<DIM>(p_cell_population);
+        }
+    }
+} // namespace ...
+
+#endif /*GONADARMSBOUNDARYCONDITION_HPP_*/
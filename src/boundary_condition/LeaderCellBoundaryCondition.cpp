@@ -34,10 +34,32 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "LeaderCellBoundaryCondition.hpp"
+#include "GermlineProfiler.hpp"
+#include "GermlineThreadPool.hpp"
 #include "NodeBasedCellPopulation.hpp"
 #include "GlobalParameterStruct.hpp"
 
 
+//Corrects one slab's cells per task
+template<unsigned DIM>
+class ImposeOnSlabTask : public AbstractParallelTask
+{
+private:
+    LeaderCellBoundaryCondition<DIM>& mrBoundaryCondition;
+
+public:
+    ImposeOnSlabTask(LeaderCellBoundaryCondition<DIM>& rBoundaryCondition)
+        : mrBoundaryCondition(rBoundaryCondition)
+    {
+    }
+
+    void RunTask(unsigned taskIndex)
+    {
+        mrBoundaryCondition.ImposeOnSlab(taskIndex);
+    }
+};
+
+
 //Constructor
 template<unsigned DIM>
 LeaderCellBoundaryCondition<DIM>::LeaderCellBoundaryCondition(AbstractCellPopulation<DIM>* pCellPopulation,
@@ -45,7 +67,9 @@ LeaderCellBoundaryCondition<DIM>::LeaderCellBoundaryCondition(AbstractCellPopula
   double startingRadius)
   : AbstractCellPopulationBoundaryCondition<DIM>(pCellPopulation),
   pLeaderCell(pLeaderCellBoundaryModifier),
-  TubeRadius(startingRadius) {
+  TubeRadius(startingRadius),
+  mTimeStepOfDistances(0),
+  mSpacing(0.0) {
 
   if (dynamic_cast<NodeBasedCellPopulation<DIM>*>(this->mpCellPopulation) == NULL)
   {
@@ -65,11 +89,19 @@ LeaderCellBoundaryCondition<DIM>::LeaderCellBoundaryCondition(AbstractCellPopula
 template<unsigned DIM>
 void LeaderCellBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations)
 {
+  ScopedProfileTimer timer(GermlineProfiler::BOUNDARY_CONDITION);
+  ImposeOnArm();
+}
+
 
+//The work of ImposeBoundaryCondition, untimed so that it can run on any thread. Only touches this arm's cells.
+template<unsigned DIM>
+void LeaderCellBoundaryCondition<DIM>::ImposeOnArm()
+{
   //Get some relevant information from the leader cell modifier
-  std::vector< c_vector<double, DIM> > LeaderCellPointCollection = pLeaderCell->getPathPointCollection();
-  std::vector< int > LeaderCellPointTypes = pLeaderCell->getPathPointTypes();
-  double Spacing = pLeaderCell->getSpacing();
+  mPathPoints = pLeaderCell->getPathPointCollection();
+  mPathPointTypes = pLeaderCell->getPathPointTypes();
+  mSpacing = pLeaderCell->getSpacing();
     
   //!C. ELEGANS SPECIFIC CODE!: Alters the rate of radial gonad growth dependent on the age of worm
   double currentTime = SimulationTime::Instance()->GetTime();
@@ -87,175 +119,241 @@ void LeaderCellBoundaryCondition<DIM>::ImposeBoundaryCondition(const std::map<No
   }
 
   //Guard against the possibility that the PointCollection may be empty at the start of a simulation
-  if ((int)LeaderCellPointCollection.size() > 0){
-
-    //Iterate over the cell population
+  mDistancesFromDTC.clear();
+  mCells.clear();
+  mTimeStepOfDistances = SimulationTime::Instance()->GetTimeStepsElapsed();
+  bool multipleArms = pLeaderCell->hasMultipleArms();
+  double arm = pLeaderCell->getArm();
+  bool useSlabs = mpSlabs && mpSlabs->GetNumSlabs() > 1;
+  if ((int)mPathPoints.size() > 0){
+
+    //Iterate over the cell population, gathering the arm's cells, and correcting each in turn or gathering their
+    //nodes too so they can be corrected slab by slab
+    mNodes.clear();
     for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
       cell_iter != this->mpCellPopulation->End();
       ++cell_iter)
     {
 
-      //Don't apply the boundary condition to the leader cell itself, assumed to be the first cell in the population
-      if (cell_iter != this->mpCellPopulation->Begin()){
-
-
-        //Read in some properties of this cell
-        Node<DIM>* cell_centre_node = this->mpCellPopulation->GetNode(this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
-        c_vector<double, DIM> cell_location = cell_centre_node->rGetLocation();
-        double radius = cell_centre_node->GetRadius();
-
-        //Identify the closest point on leader cell path to this cell, using memoization if possible
-        double minDistanceFromPath = DBL_MAX;
-        int closestPointIndex = 0;
-        //If there is no memoized closest point from the previous timestep, loop over all midline points to find the closest
-        if (cell_iter->GetCellData()->GetItem("PreviousClosestPointIndex") == -1){
-          double CurrentDistance;
-          for (int i = 0; i < (int)LeaderCellPointCollection.size(); i++){
-            c_vector<double, DIM> PointOnPathLoc = LeaderCellPointCollection[i];
-            CurrentDistance = norm_2(PointOnPathLoc - cell_location);
-            if (CurrentDistance < minDistanceFromPath){
-              minDistanceFromPath = CurrentDistance;
-              closestPointIndex = i;
-            }
-          }
-        //Otherwise search within a few points either side of the previous closest midline point.
-        //Decide how far either side to look by how far the cell may have moved since the last timestep
-        }else{
-          int maxSpheresMoved = (int)(MaxMovementDistance / Spacing) + 5; // safety factor because of stretching
-          double previousIndex = cell_iter->GetCellData()->GetItem("PreviousClosestPointIndex");
-          double top = fmin(previousIndex + maxSpheresMoved, LeaderCellPointCollection.size() - 1);
-          double bottom = fmax(previousIndex - maxSpheresMoved, 0);
-          double CurrentDistance;
-          for (int i = (int)bottom; i <= (int)top; i++){
-            c_vector<double, DIM> PointOnPathLoc = LeaderCellPointCollection[i];
-            CurrentDistance = norm_2(PointOnPathLoc - cell_location);
-            if (CurrentDistance < minDistanceFromPath){
-              minDistanceFromPath = CurrentDistance;
-              closestPointIndex = i;
-            }
-          }
-        }
-
-
-        // The following applies a correction to the cell's position if required... 
-        // What to do depends on whether the closest midline point is in one of the 2 endcaps or not.
-
-        //IF CLOSEST POINT IS ONE END OF MIDLINE
-        if (closestPointIndex == (int)LeaderCellPointCollection.size() - 1){
-
-          //p1, p2 are the two final points in the leader cell's path. Work out whether the query cell is out past the end of the path
-          //i.e. in the endcap, or whether it lies between p1 and p2 i.e. in the final cylindrical portion of the tube 
-          c_vector<double, DIM> p1 = LeaderCellPointCollection[closestPointIndex];
-          c_vector<double, DIM> p2 = LeaderCellPointCollection[closestPointIndex - 1];
-          c_vector<double, DIM> ghostPoint = p1 + (p1 - p2);
-          double d1 = norm_2(cell_location - p2);
-          double d2 = norm_2(cell_location - ghostPoint);
-          if (d2 < d1){
-            //Query cell is in the hemispherical endcap - correct if necessary to enforce boundary, or if the cell is in a region with a rachis
-            if (minDistanceFromPath > (TubeRadius - radius) || LeaderCellPointTypes[closestPointIndex] == 2 || LeaderCellPointTypes[closestPointIndex] == 1){
-              cell_centre_node->rGetModifiableLocation() = p1 + ((TubeRadius - radius) / minDistanceFromPath)*(cell_location - p1);
-            }
-          }
-          else{
-            //Otherwise the cell is still in cylindrical part of the tube. 
-            //Correct it toward the line between the path end point and previous path point as required
-            c_vector<double, DIM> v1 = p1 - p2;
-            c_vector<double, DIM> v2 = cell_location - p2;
-            double sep = norm_2(p1 - p2);
-            double dot = v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2];
-            c_vector<double, DIM> path = p2 - p1;
-            c_vector<double, DIM> closestPointOnPath = p2 + (dot / (sep*sep))*(p1 - p2);
-            double trueMinDistanceFromPath = norm_2(closestPointOnPath - cell_location);
-            if (trueMinDistanceFromPath > (TubeRadius - radius) || LeaderCellPointTypes[closestPointIndex] == 2 || LeaderCellPointTypes[closestPointIndex] == 1){
-              cell_centre_node->rGetModifiableLocation() = closestPointOnPath + ((TubeRadius - radius) / trueMinDistanceFromPath)
-                *(cell_location - closestPointOnPath);
-            }
-          }
-
-        //ELSE IF CLOSEST POINT IS OTHER END OF MIDLINE (IDENTICAL PROCEDURE)
-        }else if (closestPointIndex == 0){
-
-          c_vector<double, DIM> p2 = LeaderCellPointCollection[0];
-          c_vector<double, DIM> p1 = LeaderCellPointCollection[1];
-          c_vector<double, DIM> ghostPoint = p2 + (p2 - p1);
-          double d1 = norm_2(cell_location - p1);
-          double d2 = norm_2(cell_location - ghostPoint);
-          if (d2 < d1){
-            if (minDistanceFromPath > (TubeRadius - radius) || LeaderCellPointTypes[0] == 2){
-              cell_centre_node->rGetModifiableLocation() = p2 + ((TubeRadius - radius) / minDistanceFromPath)*(cell_location - p2);
-            }
-          }
-          else{
-            c_vector<double, DIM> v1 = p1 - p2;
-            c_vector<double, DIM> v2 = cell_location - p2;
-            double sep = norm_2(p1 - p2);
-            double dot = v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2];
-            c_vector<double, DIM> path = p2 - p1;
-            c_vector<double, DIM> closestPointOnPath = p2 + (dot / (sep*sep))*(p1 - p2);
-            double trueMinDistanceFromPath = norm_2(closestPointOnPath - cell_location);
-            if (trueMinDistanceFromPath > (TubeRadius - radius) || LeaderCellPointTypes[closestPointIndex] == 2 || LeaderCellPointTypes[closestPointIndex] == 1){
-              cell_centre_node->rGetModifiableLocation() = closestPointOnPath + ((TubeRadius - radius) / trueMinDistanceFromPath)
-                *(cell_location - closestPointOnPath);
-            }
-          }
-
-        //ELSE IF CLOSEST POINT IS ANY OTHER POINT ON PATH 
-        }else{
-
-          //Work out which is the second closest point on the path, and therefore which segment of the midline
-          //the query cell should be moved toward
-          double d1 = norm_2(cell_location - LeaderCellPointCollection[closestPointIndex - 1]);
-          double d2 = norm_2(cell_location - LeaderCellPointCollection[closestPointIndex + 1]);
-          c_vector<double, DIM> p1;
-          c_vector<double, DIM> p2;
-          if (d1 < d2){
-            p1 = LeaderCellPointCollection[closestPointIndex - 1];
-            p2 = LeaderCellPointCollection[closestPointIndex];
-          }
-          else{
-            p1 = LeaderCellPointCollection[closestPointIndex + 1];
-            p2 = LeaderCellPointCollection[closestPointIndex];
-          }
-
-          //Get query cell perpendicular distance from the closest segment of the path
-          c_vector<double, DIM> v1 = p1 - p2;
-          c_vector<double, DIM> v2 = cell_location - p2;
-          double sep = norm_2(p1 - p2);
-          double dot = v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2];
-          c_vector<double, DIM> path = p2 - p1;
-          c_vector<double, DIM> closestPointOnPath = p2 + (dot / (sep*sep))*(p1 - p2);
-          double trueMinDistanceFromPath = norm_2(closestPointOnPath - cell_location);
-
-          //Correct cell position as required
-          if (trueMinDistanceFromPath > (TubeRadius - radius) || LeaderCellPointTypes[closestPointIndex] == 2 || LeaderCellPointTypes[closestPointIndex] == 1){
-            cell_centre_node->rGetModifiableLocation() = closestPointOnPath + ((TubeRadius - radius) / trueMinDistanceFromPath)
-              *(cell_location - closestPointOnPath);
-          }
-
-          //Record whether cell is in the proximal arm (useful in some cell cycle models) 
-          if(pLeaderCell->getPathPointTypes()[closestPointIndex]==0){
-            cell_iter->GetCellData()->SetItem("InProximalArm", 1.0);
-          }else{
-            cell_iter->GetCellData()->SetItem("InProximalArm", 0.0);
-          }
-
-        }
-
-        //Record new closest point on midline path, for memoization purposes
-        cell_iter->GetCellData()->SetItem("PreviousClosestPointIndex", (double)closestPointIndex);
-        //Also record distance from DTC and max cell radius that fits in the gonad, for use by other classes
-        cell_iter->GetCellData()->SetItem("DistanceAwayFromDTC", Spacing*(LeaderCellPointCollection.size() - 1 - closestPointIndex));
-        cell_iter->GetCellData()->SetItem("MaxRadius", TubeRadius);
+      //In a gonad with more than one arm, other arms' cells are left to their own boundary conditions
+      if (multipleArms && cell_iter->GetCellData()->GetItem("Arm") != arm){
+        continue;
+      }
+      Node<DIM>* cell_centre_node = this->mpCellPopulation->GetNode(this->mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
+      mCells.push_back(*cell_iter);
+      if (useSlabs){
+        mNodes.push_back(cell_centre_node);
+      }else{
+        mDistancesFromDTC.push_back(ImposeOnCell(*cell_iter, cell_centre_node));
+      }
+    }
 
+    //Each slab's cells are corrected on their own thread (see ArcLengthSlabs), along with a last set of any
+    //cells the slabs have not seen yet. Each cell's correction only touches that cell.
+    if (useSlabs){
+      unsigned numSlabs = mpSlabs->GetNumSlabs();
+      mDistancesFromDTC.assign(mCells.size(), 0.0);
+      mSlabCellIndices.resize(numSlabs + 1);
+      for (unsigned slab = 0; slab <= numSlabs; slab++){
+        mSlabCellIndices[slab].clear();
       }
+      for (unsigned i = 0; i < mNodes.size(); i++){
+        mSlabCellIndices[mpSlabs->GetSlabOfNode(mNodes[i]->GetIndex())].push_back(i);
+      }
+      ImposeOnSlabTask<DIM> task(*this);
+      GermlineThreadPool::Instance()->Run(task, numSlabs + 1);
+    }
+  }
+}
+
 
+
+//Corrects the cells of one slab, as gathered by ImposeOnArm
+template<unsigned DIM>
+void LeaderCellBoundaryCondition<DIM>::ImposeOnSlab(unsigned slab)
+{
+  const std::vector<unsigned>& r_indices = mSlabCellIndices[slab];
+  for (unsigned i = 0; i < r_indices.size(); i++){
+    mDistancesFromDTC[r_indices[i]] = ImposeOnCell(mCells[r_indices[i]], mNodes[r_indices[i]]);
+  }
+}
+
+
+
+//Moves one cell back inside the tube if it has strayed out, and records its distance from the DTC. The path
+//is the one ImposeOnArm read from the leader cell.
+template<unsigned DIM>
+double LeaderCellBoundaryCondition<DIM>::ImposeOnCell(CellPtr pCell, Node<DIM>* pNode)
+{
+  const std::vector< c_vector<double, DIM> >& LeaderCellPointCollection = mPathPoints;
+  const std::vector< int >& LeaderCellPointTypes = mPathPointTypes;
+  double Spacing = mSpacing;
+
+  //Don't apply the boundary condition to the leader cell itself (node 0, the first cell, unless set otherwise)
+  if (pNode->GetIndex() == pLeaderCell->getLeaderNodeIndex()){
+    return pCell->GetCellData()->GetItem("DistanceAwayFromDTC");
+  }
+
+  //Read in some properties of this cell
+  c_vector<double, DIM> cell_location = pNode->rGetLocation();
+  double radius = pNode->GetRadius();
+
+  //Identify the closest point on leader cell path to this cell, using memoization if possible
+  double minDistanceFromPath = DBL_MAX;
+  int closestPointIndex = 0;
+  //If there is no memoized closest point from the previous timestep, loop over all midline points to find the closest
+  if (pCell->GetCellData()->GetItem("PreviousClosestPointIndex") == -1){
+    double CurrentDistance;
+    for (int i = 0; i < (int)LeaderCellPointCollection.size(); i++){
+      c_vector<double, DIM> PointOnPathLoc = LeaderCellPointCollection[i];
+      CurrentDistance = norm_2(PointOnPathLoc - cell_location);
+      if (CurrentDistance < minDistanceFromPath){
+        minDistanceFromPath = CurrentDistance;
+        closestPointIndex = i;
+      }
+    }
+  //Otherwise search within a few points either side of the previous closest midline point.
+  //Decide how far either side to look by how far the cell may have moved since the last timestep
+  }else{
+    int maxSpheresMoved = (int)(MaxMovementDistance / Spacing) + 5; // safety factor because of stretching
+    double previousIndex = pCell->GetCellData()->GetItem("PreviousClosestPointIndex");
+    double top = fmin(previousIndex + maxSpheresMoved, LeaderCellPointCollection.size() - 1);
+    double bottom = fmax(previousIndex - maxSpheresMoved, 0);
+    double CurrentDistance;
+    for (int i = (int)bottom; i <= (int)top; i++){
+      c_vector<double, DIM> PointOnPathLoc = LeaderCellPointCollection[i];
+      CurrentDistance = norm_2(PointOnPathLoc - cell_location);
+      if (CurrentDistance < minDistanceFromPath){
+        minDistanceFromPath = CurrentDistance;
+        closestPointIndex = i;
+      }
     }
   }
+
+
+  // The following applies a correction to the cell's position if required... 
+  // What to do depends on whether the closest midline point is in one of the 2 endcaps or not.
+
+  //IF CLOSEST POINT IS ONE END OF MIDLINE
+  if (closestPointIndex == (int)LeaderCellPointCollection.size() - 1){
+
+    //p1, p2 are the two final points in the leader cell's path. Work out whether the query cell is out past the end of the path
+    //i.e. in the endcap, or whether it lies between p1 and p2 i.e. in the final cylindrical portion of the tube 
+    c_vector<double, DIM> p1 = LeaderCellPointCollection[closestPointIndex];
+    c_vector<double, DIM> p2 = LeaderCellPointCollection[closestPointIndex - 1];
+    c_vector<double, DIM> ghostPoint = p1 + (p1 - p2);
+    double d1 = norm_2(cell_location - p2);
+    double d2 = norm_2(cell_location - ghostPoint);
+    if (d2 < d1){
+      //Query cell is in the hemispherical endcap - correct if necessary to enforce boundary, or if the cell is in a region with a rachis
+      if (minDistanceFromPath > (TubeRadius - radius) || LeaderCellPointTypes[closestPointIndex] == 2 || LeaderCellPointTypes[closestPointIndex] == 1){
+        pNode->rGetModifiableLocation() = p1 + ((TubeRadius - radius) / minDistanceFromPath)*(cell_location - p1);
+      }
+    }
+    else{
+      //Otherwise the cell is still in cylindrical part of the tube. 
+      //Correct it toward the line between the path end point and previous path point as required
+      c_vector<double, DIM> v1 = p1 - p2;
+      c_vector<double, DIM> v2 = cell_location - p2;
+      double sep = norm_2(p1 - p2);
+      double dot = v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2];
+      c_vector<double, DIM> path = p2 - p1;
+      c_vector<double, DIM> closestPointOnPath = p2 + (dot / (sep*sep))*(p1 - p2);
+      double trueMinDistanceFromPath = norm_2(closestPointOnPath - cell_location);
+      if (trueMinDistanceFromPath > (TubeRadius - radius) || LeaderCellPointTypes[closestPointIndex] == 2 || LeaderCellPointTypes[closestPointIndex] == 1){
+        pNode->rGetModifiableLocation() = closestPointOnPath + ((TubeRadius - radius) / trueMinDistanceFromPath)
+          *(cell_location - closestPointOnPath);
+      }
+    }
+
+  //ELSE IF CLOSEST POINT IS OTHER END OF MIDLINE (IDENTICAL PROCEDURE)
+  }else if (closestPointIndex == 0){
+
+    c_vector<double, DIM> p2 = LeaderCellPointCollection[0];
+    c_vector<double, DIM> p1 = LeaderCellPointCollection[1];
+    c_vector<double, DIM> ghostPoint = p2 + (p2 - p1);
+    double d1 = norm_2(cell_location - p1);
+    double d2 = norm_2(cell_location - ghostPoint);
+    if (d2 < d1){
+      if (minDistanceFromPath > (TubeRadius - radius) || LeaderCellPointTypes[0] == 2){
+        pNode->rGetModifiableLocation() = p2 + ((TubeRadius - radius) / minDistanceFromPath)*(cell_location - p2);
+      }
+    }
+    else{
+      c_vector<double, DIM> v1 = p1 - p2;
+      c_vector<double, DIM> v2 = cell_location - p2;
+      double sep = norm_2(p1 - p2);
+      double dot = v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2];
+      c_vector<double, DIM> path = p2 - p1;
+      c_vector<double, DIM> closestPointOnPath = p2 + (dot / (sep*sep))*(p1 - p2);
+      double trueMinDistanceFromPath = norm_2(closestPointOnPath - cell_location);
+      if (trueMinDistanceFromPath > (TubeRadius - radius) || LeaderCellPointTypes[closestPointIndex] == 2 || LeaderCellPointTypes[closestPointIndex] == 1){
+        pNode->rGetModifiableLocation() = closestPointOnPath + ((TubeRadius - radius) / trueMinDistanceFromPath)
+          *(cell_location - closestPointOnPath);
+      }
+    }
+
+  //ELSE IF CLOSEST POINT IS ANY OTHER POINT ON PATH 
+  }else{
+
+    //Work out which is the second closest point on the path, and therefore which segment of the midline
+    //the query cell should be moved toward
+    double d1 = norm_2(cell_location - LeaderCellPointCollection[closestPointIndex - 1]);
+    double d2 = norm_2(cell_location - LeaderCellPointCollection[closestPointIndex + 1]);
+    c_vector<double, DIM> p1;
+    c_vector<double, DIM> p2;
+    if (d1 < d2){
+      p1 = LeaderCellPointCollection[closestPointIndex - 1];
+      p2 = LeaderCellPointCollection[closestPointIndex];
+    }
+    else{
+      p1 = LeaderCellPointCollection[closestPointIndex + 1];
+      p2 = LeaderCellPointCollection[closestPointIndex];
+    }
+
+    //Get query cell perpendicular distance from the closest segment of the path
+    c_vector<double, DIM> v1 = p1 - p2;
+    c_vector<double, DIM> v2 = cell_location - p2;
+    double sep = norm_2(p1 - p2);
+    double dot = v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2];
+    c_vector<double, DIM> path = p2 - p1;
+    c_vector<double, DIM> closestPointOnPath = p2 + (dot / (sep*sep))*(p1 - p2);
+    double trueMinDistanceFromPath = norm_2(closestPointOnPath - cell_location);
+
+    //Correct cell position as required
+    if (trueMinDistanceFromPath > (TubeRadius - radius) || LeaderCellPointTypes[closestPointIndex] == 2 || LeaderCellPointTypes[closestPointIndex] == 1){
+      pNode->rGetModifiableLocation() = closestPointOnPath + ((TubeRadius - radius) / trueMinDistanceFromPath)
+        *(cell_location - closestPointOnPath);
+    }
+
+    //Record whether cell is in the proximal arm (useful in some cell cycle models) 
+    if(LeaderCellPointTypes[closestPointIndex]==0){
+      pCell->GetCellData()->SetItem("InProximalArm", 1.0);
+    }else{
+      pCell->GetCellData()->SetItem("InProximalArm", 0.0);
+    }
+
+  }
+
+  //Record new closest point on midline path, for memoization purposes
+  pCell->GetCellData()->SetItem("PreviousClosestPointIndex", (double)closestPointIndex);
+  //Also record distance from DTC and max cell radius that fits in the gonad, for use by other classes
+  double distanceAwayFromDTC = Spacing*(LeaderCellPointCollection.size() - 1 - closestPointIndex);
+  pCell->GetCellData()->SetItem("DistanceAwayFromDTC", distanceAwayFromDTC);
+  pCell->GetCellData()->SetItem("MaxRadius", TubeRadius);
+  return distanceAwayFromDTC;
 }
 
 
 
 
+//Setter for mpSlabs
+template<unsigned DIM>
+void LeaderCellBoundaryCondition<DIM>::SetSlabs(boost::shared_ptr<ArcLengthSlabs<DIM> > pSlabs){
+  mpSlabs = pSlabs;
+};
+
+
 //Getter methods for private members
 template<unsigned DIM>
   boost::shared_ptr<DTCMovementModel<DIM> > LeaderCellBoundaryCondition<DIM>::GetLeaderCellModifier() const{
@@ -265,6 +363,22 @@ template<unsigned DIM>
   double LeaderCellBoundaryCondition<DIM>::GetTubeRadius() const{
   return TubeRadius;
 };
+template<unsigned DIM>
+  boost::shared_ptr<ArcLengthSlabs<DIM> > LeaderCellBoundaryCondition<DIM>::GetSlabs() const{
+  return mpSlabs;
+};
+template<unsigned DIM>
+  const std::vector<double>& LeaderCellBoundaryCondition<DIM>::rGetDistancesFromDTC() const{
+  return mDistancesFromDTC;
+};
+template<unsigned DIM>
+  const std::vector<CellPtr>& LeaderCellBoundaryCondition<DIM>::rGetCells() const{
+  return mCells;
+};
+template<unsigned DIM>
+  unsigned LeaderCellBoundaryCondition<DIM>::GetTimeStepOfDistances() const{
+  return mTimeStepOfDistances;
+};
 
 
 
@@ -38,6 +38,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "AbstractCellPopulationBoundaryCondition.hpp"
 #include "DTCMovementModel.hpp"
+#include "ArcLengthSlabs.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
@@ -46,6 +47,12 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /**
 * A boundary condition that takes in a pointer to a leader cell modifier. This class ensures
 * that cells stay within a certain distance of that leader cell's path.
+*
+* If the leader cell leads one arm of a gonad with more than one arm (see DTCMovementModel::setArm), only
+* that arm's cells are kept in its tube, and GonadArmsBoundaryCondition applies each arm's condition.
+*
+* Each cell is corrected independently of the others, so if slabs along the gonad are set (see SetSlabs), the
+* cells of each slab are corrected on their own thread.
 */
 
 template<unsigned DIM>
@@ -76,6 +83,33 @@ private:
     //Max possible distance a cell can move in a timestep
     double MaxMovementDistance;
 
+    //Each cell's distance from the DTC as set by the last ImposeBoundaryCondition(), in population order,
+    //and the timestep that was. Kept so data output can reuse them rather than look them up again.
+    std::vector<double> mDistancesFromDTC;
+    unsigned mTimeStepOfDistances;
+
+    //The leader cell's path, as read at the start of ImposeOnArm()
+    std::vector< c_vector<double, DIM> > mPathPoints;
+    std::vector< int > mPathPointTypes;
+    double mSpacing;
+
+    //Slabs to share the cells out between, if set, and working space: the arm's cells in population order
+    //(kept, see rGetCells), their nodes, and the indices of each slab's cells among them
+    boost::shared_ptr<ArcLengthSlabs<DIM> > mpSlabs;
+    std::vector<CellPtr> mCells;
+    std::vector<Node<DIM>*> mNodes;
+    std::vector<std::vector<unsigned> > mSlabCellIndices;
+
+    /**
+    * Moves a cell back inside the tube around the leader cell's path if it lies outside, and records its
+    * distance from the DTC in its cell data. Leaves the leader cell itself where it is.
+    *
+    * @param pCell the cell
+    * @param pNode the cell's node
+    * @return the cell's distance from the DTC
+    */
+    double ImposeOnCell(CellPtr pCell, Node<DIM>* pNode);
+
 public:
 
 
@@ -100,6 +134,31 @@ public:
     void ImposeBoundaryCondition(const std::map<Node<DIM>*, c_vector<double, DIM> >& rOldLocations);
 
 
+    /**
+    * Applies the boundary condition to the cells of the leader cell's arm, as ImposeBoundaryCondition() does,
+    * but without timing it, so that the arms of a gonad can be done on separate threads.
+    */
+    void ImposeOnArm();
+
+
+    /**
+    * Corrects the cells of one slab, as gathered by ImposeOnArm(). Called on the thread pool.
+    *
+    * @param slab the slab, or the number of slabs for the cells the slabs did not hold when last updated
+    */
+    void ImposeOnSlab(unsigned slab);
+
+
+    /**
+    * Sets slabs along the gonad whose cells are corrected on separate threads. They are not updated here,
+    * since the force updates them earlier in the same timestep (see RepulsionForceSizeCorrected::SetSlabs).
+    * Not archived.
+    *
+    * @param pSlabs the slabs
+    */
+    void SetSlabs(boost::shared_ptr<ArcLengthSlabs<DIM> > pSlabs);
+
+
     /**
     * Overridden VerifyBoundaryCondition() method.
     * Verify the boundary conditions have been applied.
@@ -113,6 +172,27 @@ public:
     //Getters for private members
     boost::shared_ptr< DTCMovementModel<DIM> > GetLeaderCellModifier() const;
     double GetTubeRadius() const;
+    boost::shared_ptr<ArcLengthSlabs<DIM> > GetSlabs() const;
+
+
+    /**
+    * @return each cell's distance from the DTC, in the order the population iterates over cells, as recorded
+    * by the last ImposeBoundaryCondition(), or only the arm's own cells if the gonad has more than one arm.
+    * Empty if the leader cell has no path yet. Only valid while the population is unchanged, i.e. until the
+    * next timestep's births and deaths; see GetTimeStepOfDistances().
+    */
+    const std::vector<double>& rGetDistancesFromDTC() const;
+
+
+    /**
+    * @return the cells whose distances rGetDistancesFromDTC() gives, in the same order: those of the arm if the
+    * gonad has more than one arm, otherwise all of them. Valid for as long as the distances are.
+    */
+    const std::vector<CellPtr>& rGetCells() const;
+
+
+    //Number of timesteps that had elapsed when the distances were recorded
+    unsigned GetTimeStepOfDistances() const;
 
 
     /**
@@ -0,0 +1,175 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "AbcDistanceModifier.hpp"
+#include "Exception.hpp"
+
+#include <cmath>
+
+
+//Constructor
+template<unsigned DIM>
+AbcDistanceModifier<DIM>::AbcDistanceModifier(double tolerance)
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mTolerance(tolerance),
+      mNumObservationsCompared(0),
+      mSumOfSquares(0.0),
+      mRejected(false)
+{}
+
+
+//Empty destructor
+template<unsigned DIM>
+AbcDistanceModifier<DIM>::~AbcDistanceModifier(){}
+
+
+//Observations are compared in the order they were added, so they must come in order of time
+template<unsigned DIM>
+void AbcDistanceModifier<DIM>::AddObservation(double time, unsigned column, double value, double scale)
+{
+  if (!mObservationTimes.empty() && time < mObservationTimes.back()){
+    EXCEPTION("Observations must be added in order of time.");
+  }
+  if (column == 0 || column >= GonadArmDataOutput<DIM>::GetColumnNames().size()){
+    EXCEPTION("There is no GonadData column " << column << " to observe.");
+  }
+  if (!(scale > 0.0)){
+    EXCEPTION("An observation's scale must be positive.");
+  }
+  mObservationTimes.push_back(time);
+  mObservationColumns.push_back(column);
+  mObservedValues.push_back(value);
+  mObservationScales.push_back(scale);
+}
+
+
+//Setter for mpDataOutput
+template<unsigned DIM>
+void AbcDistanceModifier<DIM>::SetDataOutput(boost::shared_ptr<GonadArmDataOutput<DIM> > pDataOutput)
+{
+  mpDataOutput = pDataOutput;
+}
+
+
+//Getters
+template<unsigned DIM>
+double AbcDistanceModifier<DIM>::GetTolerance() const
+{
+  return mTolerance;
+}
+
+template<unsigned DIM>
+unsigned AbcDistanceModifier<DIM>::GetNumObservations() const
+{
+  return mObservationTimes.size();
+}
+
+template<unsigned DIM>
+unsigned AbcDistanceModifier<DIM>::GetNumObservationsCompared() const
+{
+  return mNumObservationsCompared;
+}
+
+template<unsigned DIM>
+bool AbcDistanceModifier<DIM>::IsRejected() const
+{
+  return mRejected;
+}
+
+template<unsigned DIM>
+double AbcDistanceModifier<DIM>::GetDistance() const
+{
+  return sqrt(mSumOfSquares);
+}
+
+
+//A new run starts with nothing compared
+template<unsigned DIM>
+void AbcDistanceModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+  if (!mpDataOutput){
+    EXCEPTION("Give the AbcDistanceModifier a data output to monitor.");
+  }
+  mNumObservationsCompared = 0;
+  mSumOfSquares = 0.0;
+  mRejected = false;
+}
+
+
+//The data output only records a row on sampling timesteps, so a row can only reach observations once
+template<unsigned DIM>
+void AbcDistanceModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+  const std::vector<double>& rRecord = mpDataOutput->rGetLatestRecord();
+  if (rRecord.empty()){
+    return;
+  }
+  while (mNumObservationsCompared < mObservationTimes.size() &&
+         rRecord[0] >= mObservationTimes[mNumObservationsCompared] - 1e-9){
+    unsigned i = mNumObservationsCompared;
+    double difference = (rRecord[mObservationColumns[i]] - mObservedValues[i])/mObservationScales[i];
+    mSumOfSquares += difference*difference;
+    mNumObservationsCompared++;
+  }
+  if (GetDistance() > mTolerance){
+    mRejected = true;
+    EXCEPTION("Stopped at time " << rRecord[0] << ": distance from the data " << GetDistance()
+              << " exceeds the tolerance " << mTolerance);
+  }
+}
+
+
+//Output this class's parameters to a log file
+template<unsigned DIM>
+void AbcDistanceModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+  *rParamsFile << "\t\t\t<Tolerance>" << mTolerance << "</Tolerance>\n";
+  *rParamsFile << "\t\t\t<NumObservations>" << mObservationTimes.size() << "</NumObservations>\n";
+  // Call method on direct parent class
+  AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class AbcDistanceModifier<1>;
+template class AbcDistanceModifier<2>;
+template class AbcDistanceModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(AbcDistanceModifier)
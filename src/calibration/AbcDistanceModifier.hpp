@@ -0,0 +1,167 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ABCDISTANCEMODIFIER_HPP_
+#define ABCDISTANCEMODIFIER_HPP_
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "GonadArmDataOutput.hpp"
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/shared_ptr.hpp>
+#include <limits>
+
+/**
+ * A modifier that measures, as a simulation runs, how far its GonadData are from observed data, and stops
+ * the simulation as soon as they are further than a tolerance. Used by AbcSmcCalibration to reject
+ * parameter sets early.
+ *
+ * Each observation is a value of one GonadData column at one time, with a scale (e.g. its measurement
+ * error) that the difference is divided by. An observation is compared with the first row the data output
+ * records at or after its time, and the distance is the square root of the sum of squared scaled
+ * differences of the observations compared so far. It can only grow as the run goes on, so a run whose
+ * distance exceeds the tolerance before the end would also have exceeded it at the end. It is then stopped
+ * by throwing an exception, after IsRejected has been set so the caller can tell it from a failure. Add the
+ * modifier after the data output, so that it sees each row in the timestep it is recorded.
+ */
+template<unsigned DIM>
+class AbcDistanceModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mTolerance;
+        archive & mObservationTimes;
+        archive & mObservationColumns;
+        archive & mObservedValues;
+        archive & mObservationScales;
+        archive & mNumObservationsCompared;
+        archive & mSumOfSquares;
+        archive & mRejected;
+    }
+
+    //Distance beyond which the simulation is stopped
+    double mTolerance;
+
+    //The observations, in order of time
+    std::vector<double> mObservationTimes;
+    std::vector<unsigned> mObservationColumns;
+    std::vector<double> mObservedValues;
+    std::vector<double> mObservationScales;
+
+    //How many observations have been compared, and the sum of their squared scaled differences
+    unsigned mNumObservationsCompared;
+    double mSumOfSquares;
+
+    //Whether the simulation was stopped for exceeding the tolerance
+    bool mRejected;
+
+    //The data output whose rows are compared. Not archived.
+    boost::shared_ptr<GonadArmDataOutput<DIM> > mpDataOutput;
+
+public:
+
+    //Constructor. The default tolerance never stops a simulation.
+    AbcDistanceModifier(double tolerance = std::numeric_limits<double>::infinity());
+
+
+    //Destructor
+    virtual ~AbcDistanceModifier();
+
+
+    /**
+     * Adds an observation. Observations must be added in order of time.
+     *
+     * @param time the time of the observation
+     * @param column the GonadData column observed (see GonadArmDataOutput::GetColumnNames)
+     * @param value the observed value
+     * @param scale what the difference from the observed value is divided by
+     */
+    void AddObservation(double time, unsigned column, double value, double scale);
+
+
+    //Setter for mpDataOutput
+    void SetDataOutput(boost::shared_ptr<GonadArmDataOutput<DIM> > pDataOutput);
+
+
+    //Getters
+    double GetTolerance() const;
+    unsigned GetNumObservations() const;
+    unsigned GetNumObservationsCompared() const;
+    bool IsRejected() const;
+
+
+    /**
+     * @return the distance between the observations compared so far and the simulation
+     */
+    double GetDistance() const;
+
+
+    /**
+     * Overriden SetupSolve method. Clears the distance.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+     void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+
+    /**
+     * Overriden UpdateAtEndOfTimeStep method. Compares any observations that the latest row of data has
+     * reached, and stops the simulation if the distance has exceeded the tolerance.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+     void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+
+     //Output any parameters associated with this class
+     void OutputSimulationModifierParameters(out_stream& rParamsFile);
+
+};
+
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(AbcDistanceModifier)
+
+#endif /*ABCDISTANCEMODIFIER_HPP_*/
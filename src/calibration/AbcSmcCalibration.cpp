@@ -0,0 +1,645 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "AbcSmcCalibration.hpp"
+#include "AbcDistanceModifier.hpp"
+#include "GermlineSimulation.hpp"
+#include "GonadArmDataOutput.hpp"
+#include "GlobalParameterStruct.hpp"
+#include "RunManifest.hpp"
+#include "SimulationTime.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "CellBasedEventHandler.hpp"
+#include "CellId.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "OutputFileHandler.hpp"
+#include "SmartPointers.hpp"
+#include "Exception.hpp"
+
+#include <cmath>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+
+//Splits a line from a calibration or observations file into its tab separated fields
+static std::vector<std::string> SplitOnTabs(const std::string& rLine)
+{
+    std::vector<std::string> fields;
+    std::stringstream lineStream(rLine);
+    std::string field;
+    while (std::getline(lineStream, field, '\t')){
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+
+//Reads the value field of the next header line, throwing if the file ends early
+static std::string ReadHeaderValue(std::ifstream& rFile, std::string description)
+{
+    std::string line;
+    if (!std::getline(rFile, line)){
+        EXCEPTION("Calibration file ended before the " << description << " was given.");
+    }
+    std::vector<std::string> fields = SplitOnTabs(line);
+    if (fields.empty()){
+        EXCEPTION("Calibration file has an empty line where the " << description << " was expected.");
+    }
+    std::string value = fields[0];
+    value.erase(value.find_last_not_of(" \r") + 1);
+    return value;
+}
+
+
+//Constructor, leaves the calibration empty
+AbcSmcCalibration::AbcSmcCalibration()
+    : mNumParticles(0),
+      mNumGenerations(0),
+      mSeed(0),
+      mToleranceQuantile(0.5),
+      mInitialTolerance(0.0),
+      mForkTime(0.0),
+      mMaxSimulationsPerGeneration(0),
+      mUseFork(false)
+{}
+
+
+//Reads the calibration in the fixed line order documented in the header, then its observations
+void AbcSmcCalibration::ConfigureFromFile(std::string filename, std::string directory)
+{
+    mParameterDirectory = directory;
+    std::string filepath = directory + filename;
+    std::ifstream CALIBRATION(filepath.c_str());
+    if (!CALIBRATION.is_open()){
+        EXCEPTION("Failed to open calibration file " << filepath);
+    }
+
+    mName                        = ReadHeaderValue(CALIBRATION, "calibration name");
+    mBaseParameterFile           = ReadHeaderValue(CALIBRATION, "base parameter file");
+    mObservationsFile            = ReadHeaderValue(CALIBRATION, "observations file");
+    mNumParticles                = atoi(ReadHeaderValue(CALIBRATION, "number of particles").c_str());
+    mNumGenerations              = atoi(ReadHeaderValue(CALIBRATION, "number of generations").c_str());
+    mSeed                        = atoi(ReadHeaderValue(CALIBRATION, "random seed").c_str());
+    mToleranceQuantile           = strtod(ReadHeaderValue(CALIBRATION, "tolerance quantile").c_str(), 0);
+    mInitialTolerance            = strtod(ReadHeaderValue(CALIBRATION, "first tolerance").c_str(), 0);
+    mForkTime                    = strtod(ReadHeaderValue(CALIBRATION, "fork time").c_str(), 0);
+    mMaxSimulationsPerGeneration = atoi(ReadHeaderValue(CALIBRATION, "most simulations per generation").c_str());
+
+    if (mNumParticles < 2){
+        EXCEPTION("A calibration needs at least two particles per generation.");
+    }
+    if (!(mToleranceQuantile > 0.0 && mToleranceQuantile <= 1.0)){
+        EXCEPTION("The tolerance quantile must be between 0 and 1.");
+    }
+
+    //Remaining lines describe the calibrated parameters
+    mParameterIndices.clear();
+    mMinimumValues.clear();
+    mMaximumValues.clear();
+    mParameterNames.clear();
+    std::string line;
+    while (std::getline(CALIBRATION, line)){
+        std::vector<std::string> fields = SplitOnTabs(line);
+        if (fields.empty() || fields[0].empty()){
+            continue;
+        }
+        if (fields.size() < 3){
+            EXCEPTION("Calibration file parameter lines need an index, minimum and maximum.");
+        }
+        mParameterIndices.push_back(atoi(fields[0].c_str()));
+        mMinimumValues.push_back(strtod(fields[1].c_str(), 0));
+        mMaximumValues.push_back(strtod(fields[2].c_str(), 0));
+        mParameterNames.push_back(fields.size() > 3 ? fields[3] : std::string());
+        if (!(mMaximumValues.back() > mMinimumValues.back())){
+            EXCEPTION("Parameter " << mParameterIndices.back() << "'s maximum must be above its minimum.");
+        }
+    }
+    CALIBRATION.close();
+
+    if (mParameterIndices.empty()){
+        EXCEPTION("Calibration file does not calibrate any parameters.");
+    }
+    ReadObservations();
+}
+
+
+//Observations are sorted by time, keeping the file's order between those at the same time
+void AbcSmcCalibration::ReadObservations()
+{
+    std::string filepath = mParameterDirectory + mObservationsFile;
+    std::ifstream OBSERVATIONS(filepath.c_str());
+    if (!OBSERVATIONS.is_open()){
+        EXCEPTION("Failed to open observations file " << filepath);
+    }
+    std::vector<std::string> columnNames = GonadArmDataOutput<3>::GetColumnNames();
+    std::vector<std::pair<double, unsigned> > order;
+    std::vector<unsigned> columns;
+    std::vector<double> values;
+    std::vector<double> scales;
+    std::string line;
+    while (std::getline(OBSERVATIONS, line)){
+        std::vector<std::string> fields = SplitOnTabs(line);
+        if (fields.empty() || fields[0].empty()){
+            continue;
+        }
+        if (fields.size() < 4){
+            EXCEPTION("Observation lines need a time, a GonadData column, a value and a scale.");
+        }
+        std::vector<std::string>::iterator column = std::find(columnNames.begin(), columnNames.end(), fields[1]);
+        if (column == columnNames.end() || column == columnNames.begin()){
+            EXCEPTION("There is no GonadData column " << fields[1] << " to observe.");
+        }
+        order.push_back(std::make_pair(strtod(fields[0].c_str(), 0), (unsigned)order.size()));
+        columns.push_back(column - columnNames.begin());
+        values.push_back(strtod(fields[2].c_str(), 0));
+        scales.push_back(strtod(fields[3].c_str(), 0));
+    }
+    OBSERVATIONS.close();
+    if (order.empty()){
+        EXCEPTION("Observations file " << filepath << " has no observations.");
+    }
+    std::sort(order.begin(), order.end());
+
+    mObservationTimes.clear();
+    mObservationColumns.clear();
+    mObservedValues.clear();
+    mObservationScales.clear();
+    for (unsigned i = 0; i < order.size(); i++){
+        mObservationTimes.push_back(order[i].first);
+        mObservationColumns.push_back(columns[order[i].second]);
+        mObservedValues.push_back(values[order[i].second]);
+        mObservationScales.push_back(scales[order[i].second]);
+    }
+    if (mForkTime > 0.0 && mObservationTimes[0] <= mForkTime){
+        EXCEPTION("Every observation must come after the fork time, " << mForkTime);
+    }
+}
+
+
+//Runs any generations not yet finished
+void AbcSmcCalibration::Run()
+{
+    LoadGenerations();
+    if (mForkTime > 0.0 && mGenerations.size() < mNumGenerations){
+        PrepareFork();
+    }
+
+    for (unsigned generation = mGenerations.size(); generation < mNumGenerations; generation++){
+        double tolerance = GetTolerance(generation);
+        unsigned generationSeed = RunManifest::DeriveSeed(mSeed, "Generation", generation);
+        std::vector<double> kernelSds;
+        if (generation > 0){
+            kernelSds = GetKernelSds(generation);
+        }
+        std::cout << "Generation " << generation << ": tolerance " << tolerance << std::endl;
+
+        Generation current;
+        current.Tolerance = tolerance;
+        current.NumSimulations = 0;
+        current.NumStoppedEarly = 0;
+        current.SimulatedHours = 0.0;
+        current.FullRunHours = 0.0;
+        double runHours = mObservationTimes.back() - (mUseFork ? mForkTime : 0.0);
+
+        while (current.Particles.size() < mNumParticles){
+            if (mMaxSimulationsPerGeneration > 0 && current.NumSimulations >= mMaxSimulationsPerGeneration){
+                std::cout << "Generation " << generation << " accepted only " << current.Particles.size() << " of "
+                          << mNumParticles << " particles in " << current.NumSimulations
+                          << " simulations, so the calibration stops at generation " << generation-1 << std::endl;
+                return;
+            }
+            unsigned proposal = current.NumSimulations;
+            std::stringstream directory;
+            directory << mName << "/Generation" << generation << "/Proposal" << std::setfill('0') << std::setw(5) << proposal;
+
+            Particle particle;
+            particle.Values = Propose(generation, proposal);
+            particle.Directory = directory.str();
+            bool stoppedEarly;
+            double simulatedHours;
+            particle.Distance = RunSimulation(particle.Values, RunManifest::DeriveSeed(generationSeed, "Run", proposal),
+                                              particle.Directory, tolerance, stoppedEarly, simulatedHours);
+            current.NumSimulations++;
+            current.NumStoppedEarly += stoppedEarly ? 1 : 0;
+            current.SimulatedHours += simulatedHours;
+            current.FullRunHours += runHours;
+
+            if (!stoppedEarly && particle.Distance <= tolerance){
+                particle.Weight = (generation == 0) ? 1.0 : ComputeWeight(particle.Values, kernelSds);
+                current.Particles.push_back(particle);
+            }
+        }
+
+        double totalWeight = 0.0;
+        for (unsigned i = 0; i < current.Particles.size(); i++){
+            totalWeight += current.Particles[i].Weight;
+        }
+        for (unsigned i = 0; i < current.Particles.size(); i++){
+            current.Particles[i].Weight /= totalWeight;
+        }
+        mGenerations.push_back(current);
+        WriteGeneration(generation);
+
+        std::cout << "Generation " << generation << ": accepted " << mNumParticles << " of " << current.NumSimulations
+                  << " simulations, " << current.NumStoppedEarly << " stopped early, simulating "
+                  << current.SimulatedHours << " of " << current.FullRunHours << " hours" << std::endl;
+    }
+}
+
+
+//Every run of every generation starts from the same larval state, saved once
+void AbcSmcCalibration::PrepareFork()
+{
+    std::string larvalDirectory = mName + "/Larval";
+    OutputFileHandler handler(larvalDirectory, false);
+    std::string snapshotPath = handler.GetOutputDirectoryFullPath() + "GermlineSnapshot.bin";
+    if (GermlineSnapshot::IsValidFile(snapshotPath)){
+        mForkSnapshot.ReadFromFile(snapshotPath);
+        mUseFork = true;
+        return;
+    }
+
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+    CellId::ResetMaxCellId();
+    CellPropertyRegistry::Instance()->Clear();
+    unsigned seed = RunManifest::DeriveSeed(mSeed, "Larval");
+
+    GermlineSimulation germline;
+    parameters->ConfigureFromFile(mBaseParameterFile, mParameterDirectory);
+    parameters->ResetDirectoryName(larvalDirectory);
+    parameters->ResetParameter(35, mForkTime);
+    parameters->ResetParameter(39, 0.0);
+    parameters->ResetParameter(40, 0.0);
+    parameters->ResetParameter(43, seed);
+    parameters->ResetParameter(48, 1.0);
+    SimulationTime::Destroy();
+    SimulationTime::Instance()->SetStartTime(0.0);
+    RunManifest::SeedRandomNumberGenerators(seed);
+    germline.SetupFromParameters();
+    RunManifest::Write(larvalDirectory, mParameterDirectory + mBaseParameterFile, seed, "larval stage of calibration " + mName);
+    germline.rGetSimulator().Solve();
+
+    //Capturing the snapshot records the apoptosis killer's use of the death rate, so comes before the check
+    GermlineSnapshot snapshot;
+    snapshot.Capture(germline.rGetCellPopulation(), *germline.GetLeaderCell(), *germline.GetBoundaryCondition(),
+                     *germline.GetApoptosis());
+    parameters->WriteFirstReadTimes(larvalDirectory);
+    std::vector<int> usedBeforeFork;
+    for (unsigned p = 0; p < mParameterIndices.size(); p++){
+        if (parameters->GetFirstReadTime(mParameterIndices[p]) >= 0){
+            usedBeforeFork.push_back(mParameterIndices[p]);
+        }
+    }
+    if (!usedBeforeFork.empty()){
+        std::cout << "Parameter " << usedBeforeFork[0] << (usedBeforeFork.size() > 1 ? " and others are" : " is")
+                  << " used before the fork time, so every run starts from time 0" << std::endl;
+        mUseFork = false;
+        return;
+    }
+    snapshot.WriteToFile(snapshotPath);
+    mForkSnapshot = snapshot;
+    mUseFork = true;
+}
+
+
+//Reads AbcGeneration<number>.txt files for as long as they are there
+void AbcSmcCalibration::LoadGenerations()
+{
+    mGenerations.clear();
+    OutputFileHandler handler(mName, false);
+    for (unsigned generation = 0; generation < mNumGenerations; generation++){
+        std::stringstream filepath;
+        filepath << handler.GetOutputDirectoryFullPath() << "AbcGeneration" << generation << ".txt";
+        std::ifstream GENERATION(filepath.str().c_str());
+        if (!GENERATION.is_open()){
+            break;
+        }
+        Generation current;
+        std::string line;
+        while (std::getline(GENERATION, line)){
+            std::vector<std::string> fields = SplitOnTabs(line);
+            if (fields.size() < 2){
+                continue;
+            }
+            if (fields[0] == "Tolerance"){
+                current.Tolerance = strtod(fields[1].c_str(), 0);
+            }else if (fields[0] == "Simulations"){
+                current.NumSimulations = atoi(fields[1].c_str());
+            }else if (fields[0] == "StoppedEarly"){
+                current.NumStoppedEarly = atoi(fields[1].c_str());
+            }else if (fields[0] == "SimulatedHours"){
+                current.SimulatedHours = strtod(fields[1].c_str(), 0);
+            }else if (fields[0] == "FullRunHours"){
+                current.FullRunHours = strtod(fields[1].c_str(), 0);
+            }else if (fields[0] != "Particle"){
+                if (fields.size() != mParameterIndices.size() + 4){
+                    EXCEPTION(filepath.str() << " does not match the calibrated parameters.");
+                }
+                Particle particle;
+                particle.Weight = strtod(fields[1].c_str(), 0);
+                particle.Distance = strtod(fields[2].c_str(), 0);
+                for (unsigned p = 0; p < mParameterIndices.size(); p++){
+                    particle.Values.push_back(strtod(fields[3+p].c_str(), 0));
+                }
+                particle.Directory = fields.back();
+                current.Particles.push_back(particle);
+            }
+        }
+        GENERATION.close();
+        if (current.Particles.size() != mNumParticles){
+            EXCEPTION(filepath.str() << " holds " << current.Particles.size() << " particles, not " << mNumParticles);
+        }
+        mGenerations.push_back(current);
+        std::cout << "Read generation " << generation << " from " << filepath.str() << std::endl;
+    }
+}
+
+
+//A tab delimited table of the particles, after "key, tab, value" lines about the generation
+void AbcSmcCalibration::WriteGeneration(unsigned generation) const
+{
+    OutputFileHandler handler(mName, false);
+    std::stringstream filepath;
+    filepath << handler.GetOutputDirectoryFullPath() << "AbcGeneration" << generation << ".txt";
+    std::string temporaryFilepath = filepath.str() + ".tmp";
+
+    std::ofstream GENERATION(temporaryFilepath.c_str());
+    if (!GENERATION.is_open()){
+        EXCEPTION("Failed to write " << temporaryFilepath);
+    }
+    GENERATION << std::setprecision(17);
+    const Generation& rGeneration = mGenerations[generation];
+    GENERATION << "Tolerance\t" << rGeneration.Tolerance << "\n";
+    GENERATION << "Simulations\t" << rGeneration.NumSimulations << "\n";
+    GENERATION << "StoppedEarly\t" << rGeneration.NumStoppedEarly << "\n";
+    GENERATION << "SimulatedHours\t" << rGeneration.SimulatedHours << "\n";
+    GENERATION << "FullRunHours\t" << rGeneration.FullRunHours << "\n";
+    GENERATION << "Particle\tWeight\tDistance";
+    for (unsigned p = 0; p < mParameterIndices.size(); p++){
+        GENERATION << "\tP" << mParameterIndices[p];
+    }
+    GENERATION << "\tDirectory\n";
+    for (unsigned i = 0; i < rGeneration.Particles.size(); i++){
+        const Particle& rParticle = rGeneration.Particles[i];
+        GENERATION << i << "\t" << rParticle.Weight << "\t" << rParticle.Distance;
+        for (unsigned p = 0; p < rParticle.Values.size(); p++){
+            GENERATION << "\t" << rParticle.Values[p];
+        }
+        GENERATION << "\t" << rParticle.Directory << "\n";
+    }
+    GENERATION.close();
+
+    if (std::rename(temporaryFilepath.c_str(), filepath.str().c_str()) != 0){
+        EXCEPTION("Failed to replace " << filepath.str());
+    }
+}
+
+
+//Each proposal has its own seed, so a generation can be repeated exactly whatever the runs did to the
+//random number generator
+std::vector<double> AbcSmcCalibration::Propose(unsigned generation, unsigned proposal) const
+{
+    RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+    p_gen->Reseed(RunManifest::DeriveSeed(RunManifest::DeriveSeed(mSeed, "Generation", generation), "Proposal", proposal));
+    unsigned numParams = mParameterIndices.size();
+    std::vector<double> values(numParams);
+
+    if (generation == 0){
+        for (unsigned p = 0; p < numParams; p++){
+            values[p] = mMinimumValues[p] + p_gen->ranf()*(mMaximumValues[p] - mMinimumValues[p]);
+        }
+        return values;
+    }
+
+    //Pick a particle by weight and move it, until the move lands inside the priors
+    const std::vector<Particle>& rPrevious = mGenerations[generation-1].Particles;
+    std::vector<double> kernelSds = GetKernelSds(generation);
+    for (unsigned attempt = 0; attempt < 10000; attempt++){
+        double u = p_gen->ranf();
+        unsigned chosen = 0;
+        double cumulativeWeight = rPrevious[0].Weight;
+        while (cumulativeWeight < u && chosen + 1 < rPrevious.size()){
+            chosen++;
+            cumulativeWeight += rPrevious[chosen].Weight;
+        }
+        bool inside = true;
+        for (unsigned p = 0; p < numParams; p++){
+            values[p] = p_gen->NormalRandomDeviate(rPrevious[chosen].Values[p], kernelSds[p]);
+            inside = inside && values[p] >= mMinimumValues[p] && values[p] <= mMaximumValues[p];
+        }
+        if (inside){
+            return values;
+        }
+    }
+    EXCEPTION("Could not move a particle of generation " << generation-1 << " inside the priors.");
+}
+
+
+//The uniform priors' density is the same everywhere inside them, so only the kernel matters
+double AbcSmcCalibration::ComputeWeight(const std::vector<double>& rValues, const std::vector<double>& rKernelSds) const
+{
+    const std::vector<Particle>& rPrevious = mGenerations[mGenerations.size()-1].Particles;
+    double sum = 0.0;
+    for (unsigned j = 0; j < rPrevious.size(); j++){
+        double density = rPrevious[j].Weight;
+        for (unsigned p = 0; p < rValues.size(); p++){
+            double z = (rValues[p] - rPrevious[j].Values[p])/rKernelSds[p];
+            density *= exp(-0.5*z*z)/rKernelSds[p];
+        }
+        sum += density;
+    }
+    return (sum > 0.0) ? 1.0/sum : 0.0;
+}
+
+
+//Twice the previous generation's weighted variance (Beaumont et al. 2009), kept above a sliver of the prior
+//range so a population that has collapsed onto one value can still move
+std::vector<double> AbcSmcCalibration::GetKernelSds(unsigned generation) const
+{
+    const std::vector<Particle>& rPrevious = mGenerations[generation-1].Particles;
+    std::vector<double> kernelSds(mParameterIndices.size());
+    for (unsigned p = 0; p < mParameterIndices.size(); p++){
+        double mean = 0.0;
+        for (unsigned i = 0; i < rPrevious.size(); i++){
+            mean += rPrevious[i].Weight*rPrevious[i].Values[p];
+        }
+        double variance = 0.0;
+        for (unsigned i = 0; i < rPrevious.size(); i++){
+            double deviation = rPrevious[i].Values[p] - mean;
+            variance += rPrevious[i].Weight*deviation*deviation;
+        }
+        kernelSds[p] = std::max(sqrt(2.0*variance), 1e-6*(mMaximumValues[p] - mMinimumValues[p]));
+    }
+    return kernelSds;
+}
+
+
+//Starts from the same state as a new run of TestElegansGermline, or from the larval snapshot, whatever
+//earlier runs did to the global state
+double AbcSmcCalibration::RunSimulation(const std::vector<double>& rValues, unsigned seed, std::string directory,
+                                        double tolerance, bool& rStoppedEarly, double& rSimulatedHours)
+{
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+    double endTime = mObservationTimes.back();
+    rStoppedEarly = false;
+
+    //Cell IDs pick each cell's random numbers, so they must start from the same place
+    CellId::ResetMaxCellId();
+    CellPropertyRegistry::Instance()->Clear();
+
+    //Runs are not split between processes, nor checkpointed
+    GermlineSimulation germline;
+    double startTime = 0.0;
+    std::string sourceFile;
+    if (mUseFork){
+        //The new values go into a copy of the snapshot, so the killers are built with them
+        GermlineSnapshot snapshot = mForkSnapshot;
+        for (unsigned p = 0; p < rValues.size(); p++){
+            snapshot.SetParameter(mParameterIndices[p], rValues[p]);
+        }
+        snapshot.SetParameter(35, endTime);
+        snapshot.SetParameter(43, seed);
+        germline.SetupFromSnapshot(snapshot);
+        parameters->ResetDirectoryName(directory);
+        germline.rGetSimulator().SetOutputDirectory(directory.c_str());
+        germline.rGetSimulator().SetEndTime(endTime);
+        startTime = snapshot.GetTime();
+        sourceFile = mName + "/Larval/GermlineSnapshot.bin";
+    }else{
+        parameters->ConfigureFromFile(mBaseParameterFile, mParameterDirectory);
+        parameters->ResetDirectoryName(directory);
+        for (unsigned p = 0; p < rValues.size(); p++){
+            parameters->ResetParameter(mParameterIndices[p], rValues[p]);
+        }
+        parameters->ResetParameter(35, endTime);
+        parameters->ResetParameter(39, 0.0);
+        parameters->ResetParameter(40, 0.0);
+        parameters->ResetParameter(43, seed);
+        parameters->ResetParameter(48, 1.0);
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        sourceFile = mParameterDirectory + mBaseParameterFile;
+    }
+    RunManifest::SeedRandomNumberGenerators(seed);
+    if (!mUseFork){
+        germline.SetupFromParameters();
+    }
+    RunManifest::Write(directory, sourceFile, seed, "proposal of calibration " + mName);
+
+    MAKE_PTR_ARGS(AbcDistanceModifier<3>, p_distance, (tolerance));
+    for (unsigned i = 0; i < mObservationTimes.size(); i++){
+        p_distance->AddObservation(mObservationTimes[i], mObservationColumns[i], mObservedValues[i], mObservationScales[i]);
+    }
+    p_distance->SetDataOutput(germline.GetDataOutput());
+    germline.rGetSimulator().AddSimulationModifier(p_distance);
+
+    //A stopped run leaves Chaste's timers running, so they are reset
+    try{
+        germline.rGetSimulator().Solve();
+    }catch (Exception& e){
+        CellBasedEventHandler::Reset();
+        rSimulatedHours = SimulationTime::Instance()->GetTime() - startTime;
+        if (p_distance->IsRejected()){
+            rStoppedEarly = true;
+            return p_distance->GetDistance();
+        }
+        std::cout << "Run in " << directory << " failed: " << e.GetMessage() << std::endl;
+        return std::numeric_limits<double>::infinity();
+    }
+    rSimulatedHours = SimulationTime::Instance()->GetTime() - startTime;
+
+    if (p_distance->GetNumObservationsCompared() < p_distance->GetNumObservations()){
+        EXCEPTION("Run in " << directory << " ended before its observation at time "
+                  << mObservationTimes[p_distance->GetNumObservationsCompared()]
+                  << "; observations must be at times the GonadData are sampled.");
+    }
+    return p_distance->GetDistance();
+}
+
+
+//The first generation's tolerance is given; later ones follow from the previous generation
+double AbcSmcCalibration::GetTolerance(unsigned generation) const
+{
+    if (generation == 0){
+        return (mInitialTolerance > 0.0) ? mInitialTolerance : std::numeric_limits<double>::infinity();
+    }
+    if (generation > mGenerations.size()){
+        EXCEPTION("Generation " << generation-1 << " has not finished.");
+    }
+    std::vector<double> distances;
+    const std::vector<Particle>& rPrevious = mGenerations[generation-1].Particles;
+    for (unsigned i = 0; i < rPrevious.size(); i++){
+        distances.push_back(rPrevious[i].Distance);
+    }
+    std::sort(distances.begin(), distances.end());
+    unsigned index = (unsigned)(mToleranceQuantile*(distances.size() - 1) + 0.5);
+    return distances[index];
+}
+
+
+//Getters
+std::string AbcSmcCalibration::GetName() const
+{
+    return mName;
+}
+
+unsigned AbcSmcCalibration::GetNumGenerationsFinished() const
+{
+    return mGenerations.size();
+}
+
+const AbcSmcCalibration::Generation& AbcSmcCalibration::rGetGeneration(unsigned generation) const
+{
+    if (generation >= mGenerations.size()){
+        EXCEPTION("Generation " << generation << " has not finished.");
+    }
+    return mGenerations[generation];
+}
+
+const std::vector<int>& AbcSmcCalibration::rGetParameterIndices() const
+{
+    return mParameterIndices;
+}
+
+bool AbcSmcCalibration::IsUsingFork() const
+{
+    return mUseFork;
+}
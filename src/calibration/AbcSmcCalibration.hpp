@@ -0,0 +1,223 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ABCSMCCALIBRATION_HPP_
+#define ABCSMCCALIBRATION_HPP_
+
+#include "GermlineSnapshot.hpp"
+
+#include <string>
+#include <vector>
+
+/*
+* Fits parameters to observed GonadData by approximate Bayesian computation, with sequential Monte Carlo
+* (ABC-SMC, as in Toni et al. 2009 and Beaumont et al. 2009). Each generation is a population of parameter
+* sets (particles) whose simulations came within a tolerance of the data. The first generation's particles
+* are drawn from uniform priors; each later one's are drawn from the previous generation by weight and moved
+* by a Gaussian kernel (with twice the previous generation's weighted variance), and its tolerance is a
+* quantile of the previous generation's distances, so the populations close in on the posterior.
+*
+* The simulations are run one after another in this process, each monitored by an AbcDistanceModifier, which
+* stops a run as soon as its distance from the data exceeds the generation's tolerance. Runs that are clearly
+* wrong after a few simulated hours are then not run to the end. Every run's end time is the last observation.
+*
+* Many calibrated parameters only matter to the adult (e.g. the death rate). With a fork time, the larval
+* stage is simulated once with the base parameters and its snapshot reused by every run of every generation,
+* as in a warm started sweep. If a calibrated parameter turns out to have been used before the fork (see
+* GlobalParameterStruct::GetFirstReadTime), every run starts from time 0 instead.
+*
+* A calibration is read from a file in the data directory. Like a sweep file, every line holds a value, a
+* tab, then an optional comment, and the lines must come in this order:
+*
+* - Line 1: calibration name, also the output directory for the generations and all runs
+* - Line 2: name of the base parameter file (e.g. Baseline.txt)
+* - Line 3: name of the observations file, in the same directory
+* - Line 4: number of particles in each generation
+* - Line 5: number of generations
+* - Line 6: random seed, from which the proposals' and runs' seeds are derived
+* - Line 7: quantile of the previous generation's distances used as the next tolerance (e.g. 0.5)
+* - Line 8: tolerance of the first generation. 0 for none, so every run goes to the end.
+* - Line 9: fork time in hours. 0 runs every simulation from scratch.
+* - Line 10: most simulations to run in one generation before giving up. 0 for no limit.
+* - Subsequent lines: parameter index, tab, minimum, tab, maximum, tab, comment.
+*
+* The observations file has one line per observation: time, tab, GonadData column name, tab, observed value,
+* tab, scale (see AbcDistanceModifier), tab, comment. See data/ExampleCalibration.txt and
+* data/ExampleObservations.txt.
+*
+* Each finished generation is written to AbcGeneration<number>.txt in the output directory, and runs write to
+* Generation<number>/Proposal<number>. Seeds depend only on the generation and proposal numbers, so an
+* interrupted calibration, run again, reads the finished generations back and repeats the unfinished one
+* exactly, reusing the larval snapshot if it was saved.
+*/
+
+class AbcSmcCalibration
+{
+public:
+
+    //A parameter set, and how well its simulation fitted
+    struct Particle
+    {
+        std::vector<double> Values;     //one per calibrated parameter
+        double Weight;
+        double Distance;
+        std::string Directory;
+    };
+
+    //A finished generation
+    struct Generation
+    {
+        double Tolerance;
+        unsigned NumSimulations;
+        unsigned NumStoppedEarly;
+        double SimulatedHours;          //hours simulated by all runs
+        double FullRunHours;            //hours they would have simulated without early rejection
+        std::vector<Particle> Particles;
+    };
+
+private:
+
+    //Header values, see above
+    std::string mName;
+    std::string mBaseParameterFile;
+    std::string mObservationsFile;
+    unsigned mNumParticles;
+    unsigned mNumGenerations;
+    unsigned mSeed;
+    double mToleranceQuantile;
+    double mInitialTolerance;
+    double mForkTime;
+    unsigned mMaxSimulationsPerGeneration;
+
+    //Directory the calibration, parameter and observations files are in
+    std::string mParameterDirectory;
+
+    //One entry per calibrated parameter: its index and prior range
+    std::vector<int> mParameterIndices;
+    std::vector<double> mMinimumValues;
+    std::vector<double> mMaximumValues;
+    std::vector<std::string> mParameterNames;
+
+    //The observations, in order of time
+    std::vector<double> mObservationTimes;
+    std::vector<unsigned> mObservationColumns;
+    std::vector<double> mObservedValues;
+    std::vector<double> mObservationScales;
+
+    //The larval stage every run starts from, if it could be reused
+    GermlineSnapshot mForkSnapshot;
+    bool mUseFork;
+
+    //Finished generations
+    std::vector<Generation> mGenerations;
+
+    //Reads the observations file
+    void ReadObservations();
+
+    //Runs the larval stage, or reads its snapshot if an earlier attempt saved one, and decides whether to use it
+    void PrepareFork();
+
+    //Reads back the generations an earlier attempt finished
+    void LoadGenerations();
+
+    //Writes a finished generation to file, via a temporary file and a rename
+    void WriteGeneration(unsigned generation) const;
+
+    //Draws a proposal: from the priors for generation 0, otherwise by moving a particle of the previous generation
+    std::vector<double> Propose(unsigned generation, unsigned proposal) const;
+
+    //Weight of an accepted particle of a generation after the first, before normalising
+    double ComputeWeight(const std::vector<double>& rValues, const std::vector<double>& rKernelSds) const;
+
+    //Standard deviation of the perturbation kernel for each parameter, from the previous generation
+    std::vector<double> GetKernelSds(unsigned generation) const;
+
+    /**
+    * Runs one simulation, stopping it early if its distance exceeds the tolerance.
+    *
+    * @param rValues the calibrated parameters' values
+    * @param seed the run seed
+    * @param directory the output directory
+    * @param tolerance the distance beyond which the run is stopped
+    * @param rStoppedEarly set to whether the run was stopped
+    * @param rSimulatedHours set to the hours simulated
+    * @return the distance from the data: at the end, or when the run was stopped (infinite if it failed)
+    */
+    double RunSimulation(const std::vector<double>& rValues, unsigned seed, std::string directory,
+                         double tolerance, bool& rStoppedEarly, double& rSimulatedHours);
+
+public:
+
+    /**
+    * Constructor. Leaves the calibration empty until ConfigureFromFile is called.
+    */
+    AbcSmcCalibration();
+
+
+    /**
+    * Reads the calibration and its observations from file.
+    *
+    * @param filename name of the calibration file
+    * @param directory location of the calibration, parameter and observations files
+    */
+    void ConfigureFromFile(std::string filename, std::string directory);
+
+
+    /**
+    * Runs every generation not yet finished, printing a summary of each as it finishes. Stops early if a
+    * generation reaches the most simulations allowed without accepting enough particles.
+    */
+    void Run();
+
+
+    /**
+    * @return the tolerance of a generation: the initial tolerance for the first (infinite if none), and
+    * otherwise the given quantile of the previous generation's distances
+    *
+    * @param generation the generation
+    */
+    double GetTolerance(unsigned generation) const;
+
+
+    //Getters
+    std::string GetName() const;
+    unsigned GetNumGenerationsFinished() const;
+    const Generation& rGetGeneration(unsigned generation) const;
+    const std::vector<int>& rGetParameterIndices() const;
+    bool IsUsingFork() const;
+
+};
+
+#endif /*ABCSMCCALIBRATION_HPP_*/
@@ -35,13 +35,16 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
 #include "Fertilisation.hpp"
+#include "GermlineProfiler.hpp"
 
 
 //Constructor, initialises mSpermathecaLength
 template<unsigned DIM>
 Fertilisation<DIM>::Fertilisation(AbstractCellPopulation<DIM>* pCellPopulation, double spermathecaLength)
     :AbstractCellKiller<DIM>(pCellPopulation),
-    mSpermathecaLength(spermathecaLength){
+    mSpermathecaLength(spermathecaLength),
+    mArmOnly(false),
+    mArm(0){
 }
 
 
@@ -58,6 +61,23 @@ double Fertilisation<DIM>::GetSpermathecaLength() const
 }
 
 
+//Restrict to one arm
+template<unsigned DIM>
+void Fertilisation<DIM>::SetArm(unsigned arm)
+{
+    mArmOnly = true;
+    mArm = arm;
+}
+
+
+//Every cell is in the arm unless the killer is restricted to one
+template<unsigned DIM>
+bool Fertilisation<DIM>::IsInArm(CellPtr pCell) const
+{
+    return !mArmOnly || pCell->GetCellData()->GetItem("Arm") == (double)mArm;
+}
+
+
 //Kills the selected cell
 template<unsigned DIM>
 void Fertilisation<DIM>::CheckAndLabelSingleCellForApoptosis(CellPtr pCell)
@@ -71,6 +91,7 @@ void Fertilisation<DIM>::CheckAndLabelSingleCellForApoptosis(CellPtr pCell)
 template<unsigned DIM>
 void Fertilisation<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
 {
+    ScopedProfileTimer timer(GermlineProfiler::FERTILISATION);
 
     bool stopOvulation = false;
 
@@ -85,7 +106,7 @@ void Fertilisation<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
             ++cell_iter)
         {
             //Loop over cells and find max distance from DTC. That value = total gonad length
-            if (cell_iter->GetCellData()->GetItem("DistanceAwayFromDTC") > gonadLength){
+            if (IsInArm(*cell_iter) && cell_iter->GetCellData()->GetItem("DistanceAwayFromDTC") > gonadLength){
                 gonadLength = cell_iter->GetCellData()->GetItem("DistanceAwayFromDTC");
             }
         }
@@ -97,7 +118,8 @@ void Fertilisation<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
         {
             
             //Loop over all cells again, and now only consider mature, unfertilised oocytes in the spermatheca 
-            if (cell_iter->GetCellData()->GetItem("Differentiation_Oocyte") == 1.0 
+            if (IsInArm(*cell_iter)
+                && cell_iter->GetCellData()->GetItem("Differentiation_Oocyte") == 1.0 
                 && gonadLength - cell_iter->GetCellData()->GetItem("DistanceAwayFromDTC") <= mSpermathecaLength 
                 && cell_iter->HasApoptosisBegun() == false
                 && stopOvulation==false){
@@ -106,7 +128,8 @@ void Fertilisation<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
                 for (typename AbstractCellPopulation<DIM>::Iterator cell_iter2 = this->mpCellPopulation->Begin();
                     cell_iter2 != this->mpCellPopulation->End(); ++cell_iter2)
                 {
-                    if (cell_iter2->GetCellData()->GetItem("Differentiation_Sperm") == 1.0
+                    if (IsInArm(*cell_iter2)
+                        && cell_iter2->GetCellData()->GetItem("Differentiation_Sperm") == 1.0
                         && cell_iter2->HasApoptosisBegun() == false
                         && gonadLength - cell_iter2->GetCellData()->GetItem("DistanceAwayFromDTC") <= mSpermathecaLength
                         && stopOvulation==false){
@@ -131,6 +154,9 @@ template<unsigned DIM>
 void Fertilisation<DIM>::OutputCellKillerParameters(out_stream& rParamsFile)
 {
     *rParamsFile << "\t\t\t<LengthOfSpermatheca>" << mSpermathecaLength << "</LengthOfSpermatheca>\n";
+    if (mArmOnly){
+        *rParamsFile << "\t\t\t<Arm>" << mArm << "</Arm>\n";
+    }
 
     // Call method on direct parent class
     AbstractCellKiller<DIM>::OutputCellKillerParameters(rParamsFile);
@@ -38,6 +38,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "AbstractCellKiller.hpp"
 #include "ChasteSerialization.hpp"
+#include "ChasteSerializationVersion.hpp"
 #include <boost/serialization/base_object.hpp>
 
 /**
@@ -48,6 +49,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *
 * This is implemented as a cell killer because both cells involved in fertilisation/ovulation 
 * are deleted from the simulation.
+*
+* In a gonad with more than one arm, each arm has its own spermatheca and its own killer (see SetArm).
 */
 
 template<unsigned DIM>
@@ -60,6 +63,15 @@ private:
     */
     double mSpermathecaLength;
 
+    /*
+    * Whether only the cells of one arm are considered, and which arm (their "Arm" cell data)
+    */
+    bool mArmOnly;
+    unsigned mArm;
+
+    //Whether a cell is one this killer considers
+    bool IsInArm(CellPtr pCell) const;
+
 
     /** Needed for serialization. */
     friend class boost::serialization::access;
@@ -73,6 +85,11 @@ private:
     void serialize(Archive & archive, const unsigned int version)
     {
         archive & boost::serialization::base_object<AbstractCellKiller<DIM> >(*this);
+        //Archives from before gonads could have several arms hold a killer for the whole gonad, as constructed
+        if (version >= 1){
+            archive & mArmOnly;
+            archive & mArm;
+        }
     }
 
 public:
@@ -98,6 +115,15 @@ public:
     double GetSpermathecaLength() const;
 
 
+    /**
+    * Makes the killer only consider the cells of one arm of the gonad, for gonads with more than one arm.
+    * The gonad length is then that arm's length, and only that arm's oocytes and sperm are paired.
+    *
+    * @param arm the arm, matching the cells' "Arm" cell data
+    */
+    void SetArm(unsigned arm);
+
+
     /**
     * Once a sperm and an oocyte involved in fertilisation have been labelled for death, this
     * function sends the kill signal.
@@ -135,6 +161,17 @@ namespace boost
 {
     namespace serialization
     {
+        /**
+        * Specify a version number for archive backwards compatibility. Version 1 added the arm members;
+        * this is how to do BOOST_CLASS_VERSION(Fertilisation, 1) with a templated class.
+        */
+        template<unsigned DIM>
+        struct version<Fertilisation<DIM> >
+        {
+            ///Macro to set the version number of templated archive in known versions of Boost
+            CHASTE_VERSION_CONTENT(1);
+        };
+
         /**
         * Serialize information required to construct a Fertilisation cell killer.
         */
@@ -35,13 +35,15 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
 #include "OocyteFatedCellApoptosis.hpp"
+#include "GermlineProfiler.hpp"
 
 
 //Constructor, initialises mHourlyProbabilityOfDeath
 template<unsigned DIM>
 OocyteFatedCellApoptosis<DIM>::OocyteFatedCellApoptosis(AbstractCellPopulation<DIM>* pCellPopulation, double HourlyProbabilityOfDeath)
         : AbstractCellKiller<DIM>(pCellPopulation),
-          mHourlyProbabilityOfDeath(HourlyProbabilityOfDeath){
+          mHourlyProbabilityOfDeath(HourlyProbabilityOfDeath),
+          mTimeOfFirstUse(-1.0){
 }
 
 
@@ -59,6 +61,14 @@ double OocyteFatedCellApoptosis<DIM>::GetHourlyProbabilityOfDeath() const
 }
 
 
+//Getter for mTimeOfFirstUse
+template<unsigned DIM>
+double OocyteFatedCellApoptosis<DIM>::GetTimeOfFirstUse() const
+{
+    return mTimeOfFirstUse;
+}
+
+
 /*
 * Actual cell killer method. Also sets the property Apoptosis to 1.0, incase another class wants
 * to count the number of dying cells at any given moment.
@@ -77,6 +87,7 @@ void OocyteFatedCellApoptosis<DIM>::CheckAndLabelSingleCellForApoptosis(CellPtr
 template<unsigned DIM>
 void OocyteFatedCellApoptosis<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
 {
+  ScopedProfileTimer timer(GermlineProfiler::APOPTOSIS);
 
   //Loop over the cell population
   for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
@@ -87,9 +98,18 @@ void OocyteFatedCellApoptosis<DIM>::CheckAndLabelCellsForApoptosisOrDeath()
     if (cell_iter->GetCellData()->GetItem("OocyteFated") == 1.0 &&
       cell_iter->GetCellData()->GetItem("DistanceAwayFromDTC") < 250.0){
 
-      // Random number generator used to determine if this cell should undergo apoptosis. The probability
-      // of death used here is based on the Chaste class "RandomCellKiller"
-      if (RandomNumberGenerator::Instance()->ranf() < 
+      if (mTimeOfFirstUse < 0){
+        mTimeOfFirstUse = SimulationTime::Instance()->GetTime();
+      }
+
+      // Random number used to determine if this cell should undergo apoptosis, one per cell per timestep so
+      // that it does not depend on the order cells are visited. Timesteps are counted from time 0 rather than
+      // with GetTimeStepsElapsed, which restarts when a simulation is restored. The probability of death used
+      // here is based on the Chaste class "RandomCellKiller"
+      boost::uint64_t timestep = (boost::uint64_t)floor(SimulationTime::Instance()->GetTime()/SimulationTime::Instance()->GetTimeStep() + 0.5);
+      CellRandomStreams* p_streams = CellRandomStreams::Instance();
+      double random = p_streams->ranf(CellRandomStreams::APOPTOSIS, p_streams->GetStreamKey(*cell_iter), timestep);
+      if (random < 
          (1.0 - pow((1.0 - mHourlyProbabilityOfDeath), SimulationTime::Instance()->GetTimeStep()) ) ){
          CheckAndLabelSingleCellForApoptosis(*cell_iter);
       }
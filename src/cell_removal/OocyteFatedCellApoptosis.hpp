@@ -38,6 +38,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "AbstractCellKiller.hpp"
 #include "RandomNumberGenerator.hpp"
+#include "CellRandomStreams.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
@@ -66,9 +67,11 @@ private:
     {
         archive & boost::serialization::base_object<AbstractCellKiller<DIM> >(*this);
 
-        // Make sure the random number generator is also archived
+        // Make sure the random number generators are also archived
         SerializableSingleton<RandomNumberGenerator>* p_rng_wrapper = RandomNumberGenerator::Instance()->GetSerializationWrapper();
         archive & p_rng_wrapper;
+        SerializableSingleton<CellRandomStreams>* p_streams_wrapper = CellRandomStreams::Instance()->GetSerializationWrapper();
+        archive & p_streams_wrapper;
     }
 
 
@@ -77,6 +80,12 @@ private:
     */
     double mHourlyProbabilityOfDeath;
 
+    /*
+    * Simulation time at which the death probability was first applied to a cell, or -1 if it hasn't
+    * been yet. Lets a simulation tell whether the death rate has affected it so far. Not archived.
+    */
+    double mTimeOfFirstUse;
+
 public:
 
 
@@ -101,6 +110,12 @@ public:
     double GetHourlyProbabilityOfDeath() const;
 
 
+    /**
+     * @return the time the death probability was first applied to a cell, or -1 if never.
+     */
+    double GetTimeOfFirstUse() const;
+
+
     /**
      * This function sends the kill signal to cells labelled for death.
      * 
@@ -0,0 +1,151 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GermlineVolumeTrackingModifier.hpp"
+#include "GermlineProfiler.hpp"
+#include "Exception.hpp"
+
+
+//Constructor
+template<unsigned DIM>
+GermlineVolumeTrackingModifier<DIM>::GermlineVolumeTrackingModifier(int samplingInterval)
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mSamplingInterval(samplingInterval),
+      mNumVolumesUpdated(0)
+{
+  if (mSamplingInterval <= 0){
+    EXCEPTION("The sampling interval must be at least one timestep.");
+  }
+}
+
+
+//Empty destructor
+template<unsigned DIM>
+GermlineVolumeTrackingModifier<DIM>::~GermlineVolumeTrackingModifier(){}
+
+
+//Getter methods for private members
+template<unsigned DIM>
+int GermlineVolumeTrackingModifier<DIM>::GetSamplingInterval() const
+{
+  return mSamplingInterval;
+};
+template<unsigned DIM>
+unsigned GermlineVolumeTrackingModifier<DIM>::GetNumVolumesUpdated() const
+{
+  return mNumVolumesUpdated;
+};
+
+
+//Every cell starts with a volume
+template<unsigned DIM>
+void GermlineVolumeTrackingModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+  UpdateCellData(rCellPopulation, true);
+}
+
+
+//Only cells that will read their volume before the next update get a new one
+template<unsigned DIM>
+void GermlineVolumeTrackingModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+  UpdateCellData(rCellPopulation, false);
+}
+
+
+//Same as VolumeTrackingModifier::UpdateCellData, for a subset of the cells
+template<unsigned DIM>
+void GermlineVolumeTrackingModifier<DIM>::UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation, bool allCells)
+{
+  ScopedProfileTimer timer(GermlineProfiler::CELL_VOLUMES);
+
+  //Make sure the cell population is updated
+  rCellPopulation.Update();
+
+  //The statechart applies contact inhibition once GetTime()>17, reading the volume recorded now during
+  //the next timestep. Starting a timestep early does no harm.
+  double time = SimulationTime::Instance()->GetTime();
+  bool adult = time + SimulationTime::Instance()->GetTimeStep() > 17.0;
+  bool sampling = SimulationTime::Instance()->GetTimeStepsElapsed() % mSamplingInterval == 0;
+
+  mNumVolumesUpdated = 0;
+  if (!allCells && !adult && !sampling){
+    return;
+  }
+
+  for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+  cell_iter != rCellPopulation.End(); ++cell_iter)
+  {
+    bool needed = allCells;
+    if (!needed && adult){
+      //G1 (1.0) and G2 (3.0) are the phases with contact inhibition
+      double phase = cell_iter->GetCellData()->GetItem("CellCyclePhase");
+      needed = (phase == 1.0 || phase == 3.0);
+    }
+    if (!needed && sampling){
+      //The cells GonadArmDataOutput measures cell rows by
+      needed = cell_iter->GetCellData()->GetItem("DistanceAwayFromDTC") < 75.0 &&
+               cell_iter->GetCellData()->GetItem("IsDTC") == 0.0;
+    }
+    if (needed){
+      double cell_volume = rCellPopulation.GetVolumeOfCell(*cell_iter);
+      cell_iter->GetCellData()->SetItem("volume", cell_volume);
+      mNumVolumesUpdated++;
+    }
+  }
+}
+
+
+//Output this class's parameters to a log file
+template<unsigned DIM>
+void GermlineVolumeTrackingModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+  *rParamsFile << "\t\t\t<SamplingInterval>" << mSamplingInterval << "</SamplingInterval>\n";
+  // Call method on direct parent class
+  AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class GermlineVolumeTrackingModifier<1>;
+template class GermlineVolumeTrackingModifier<2>;
+template class GermlineVolumeTrackingModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GermlineVolumeTrackingModifier)
@@ -0,0 +1,157 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GERMLINEVOLUMETRACKINGMODIFIER_HPP_
+#define GERMLINEVOLUMETRACKINGMODIFIER_HPP_
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+/**
+ * A replacement for Chaste's VolumeTrackingModifier that only works out the "volume" cell data of the cells
+ * that are about to use it:
+ *
+ * - once the worm is an adult (after 17 hours), cells in G1 or G2, the phases in which the statechart applies
+ *   contact inhibition, since the volume they read next timestep is the one recorded at the end of this one;
+ * - every mSamplingInterval timesteps, the germ cells in the first 75 microns of the distal arm, whose
+ *   volumes GonadArmDataOutput uses to estimate the length of a cell row. It must be added to the simulation
+ *   before GonadArmDataOutput, with the same interval.
+ *
+ * Those cells get exactly the volumes VolumeTrackingModifier would give them, because the population is
+ * still updated every timestep just as VolumeTrackingModifier does (the neighbour lists the next timestep
+ * starts from depend on it). Every cell's volume is worked out at the start of a simulation. Other cells keep
+ * the volume they had when it was last worked out, which is what appears in their .vtu output.
+ */
+template<unsigned DIM>
+class GermlineVolumeTrackingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+    }
+
+    //Number of timesteps between GonadArmDataOutput samples
+    int mSamplingInterval;
+
+    //Number of cells whose volume was worked out at the last timestep, for reference
+    unsigned mNumVolumesUpdated;
+
+    //Updates the population, then works out the volume of every cell if allCells is true, or otherwise
+    //of the cells listed above
+    void UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation, bool allCells);
+
+public:
+
+    //Constructor
+    GermlineVolumeTrackingModifier(int samplingInterval);
+
+
+    //Destructor
+    virtual ~GermlineVolumeTrackingModifier();
+
+
+    //Getters for private members
+    int GetSamplingInterval() const;
+    unsigned GetNumVolumesUpdated() const;
+
+
+    /**
+     * Overriden SetupSolve method. Works out the volume of every cell.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+     void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+
+    /**
+     * Overriden UpdateAtEndOfTimeStep method. Works out the volumes of the cells that will need them.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+     void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+
+     //Output any parameters associated with this class
+     void OutputSimulationModifierParameters(out_stream& rParamsFile);
+
+};
+
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GermlineVolumeTrackingModifier)
+
+namespace boost
+{
+    namespace serialization
+    {
+        /**
+        * Serialize information required to construct a GermlineVolumeTrackingModifier.
+        */
+        template<class Archive, unsigned DIM>
+        inline void save_construct_data(
+            Archive & ar, const GermlineVolumeTrackingModifier<DIM> * t, const BOOST_PFTO unsigned int file_version)
+        {
+            // Save data required to construct instance
+            int interval = t->GetSamplingInterval();
+            ar << interval;
+        }
+
+        /**
+        * De-serialize constructor parameters and initialise a GermlineVolumeTrackingModifier.
+        */
+        template<class Archive, unsigned DIM>
+        inline void load_construct_data(
+            Archive & ar, GermlineVolumeTrackingModifier<DIM> * t, const unsigned int file_version)
+        {
+            // Retrieve data from archive required to construct new instance
+            int interval;
+            ar >> interval;
+
+            // Invoke inplace constructor to initialise instance
+            ::new(t)GermlineVolumeTrackingModifier<DIM>(interval);
+        }
+    }
+} // namespace ...
+
+#endif /*GERMLINEVOLUMETRACKINGMODIFIER_HPP_*/
@@ -0,0 +1,107 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "OverlapVolumeEstimator.hpp"
+#include "Exception.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+
+//The plane through the circle where the surfaces meet is (d^2 + R^2 - r^2)/2d from this sphere's centre.
+//The cap beyond it has height h = R minus that distance, and volume pi h^2 (3R - h)/3.
+double OverlapVolumeEstimator::GetCapVolume(double radius, double otherRadius, double separation)
+{
+    if (separation >= radius + otherRadius){
+        return 0.0;
+    }
+
+    //Concentric spheres share the overlap equally
+    double planeDistance = 0.0;
+    if (separation > 0.0){
+        planeDistance = (separation*separation + radius*radius - otherRadius*otherRadius)/(2.0*separation);
+    }
+
+    //A sphere entirely inside the other gives up all of itself, and one enclosing the other gives up nothing
+    double height = std::min(std::max(radius - planeDistance, 0.0), 2.0*radius);
+    return M_PI*height*height*(3.0*radius - height)/3.0;
+}
+
+
+//Zero the caps of every node
+void OverlapVolumeEstimator::Reset(unsigned numNodes)
+{
+    mCapVolumes.assign(numNodes, 0.0);
+}
+
+
+//Each node of the pair gives up its own cap to the other
+void OverlapVolumeEstimator::AddOverlap(unsigned indexA, double radiusA, unsigned indexB, double radiusB, double separation)
+{
+    if (indexA >= mCapVolumes.size() || indexB >= mCapVolumes.size()){
+        EXCEPTION("Node index out of range in OverlapVolumeEstimator. Reset it with the number of nodes first.");
+    }
+    mCapVolumes[indexA] += GetCapVolume(radiusA, radiusB, separation);
+    mCapVolumes[indexB] += GetCapVolume(radiusB, radiusA, separation);
+}
+
+
+//Sphere volume less the caps given up
+double OverlapVolumeEstimator::GetVolume(unsigned index, double radius) const
+{
+    double volume = 4.0*M_PI*radius*radius*radius/3.0;
+    if (index < mCapVolumes.size()){
+        volume -= mCapVolumes[index];
+    }
+    return std::max(volume, 0.0);
+}
+
+
+//Getter and setter for one node's caps
+double OverlapVolumeEstimator::GetVolumeGivenUp(unsigned index) const
+{
+    if (index >= mCapVolumes.size()){
+        return 0.0;
+    }
+    return mCapVolumes[index];
+}
+
+void OverlapVolumeEstimator::SetVolumeGivenUp(unsigned index, double volume)
+{
+    if (index >= mCapVolumes.size()){
+        EXCEPTION("Node index out of range in OverlapVolumeEstimator. Reset it with the number of nodes first.");
+    }
+    mCapVolumes[index] = volume;
+}
@@ -0,0 +1,122 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef OVERLAPVOLUMEESTIMATOR_HPP_
+#define OVERLAPVOLUMEESTIMATOR_HPP_
+
+#include <vector>
+
+/*
+* Estimates the compressed volume of spherical cells from the overlaps between them, as a cheaper alternative
+* to NodeBasedCellPopulation::GetVolumeOfCell for contact inhibition.
+*
+* Where two cells overlap, the lens they share is split between them by the plane through the circle in which
+* their surfaces meet, so each gives up a spherical cap to the other. A cell's estimated volume is that of its
+* sphere less the caps it gives up to all of its overlapping neighbours, or zero if the caps add up to more (which
+* can only happen where three or more cells overlap the same space).
+*
+* Overlaps are added one pair at a time, so the estimate can be gathered in a loop that already visits each
+* overlapping pair, such as the one in RepulsionForceSizeCorrected. Cells are identified by node index.
+*/
+
+class OverlapVolumeEstimator
+{
+private:
+
+    //Volume each node has given up to its neighbours so far, by node index
+    std::vector<double> mCapVolumes;
+
+public:
+
+    /**
+    * @return the volume of a sphere on the far side of the plane through the intersection of its surface with
+    * that of another sphere, i.e. the cap it gives up to the other sphere. Zero if they do not overlap.
+    *
+    * @param radius the sphere's radius
+    * @param otherRadius the other sphere's radius
+    * @param separation the distance between their centres
+    */
+    static double GetCapVolume(double radius, double otherRadius, double separation);
+
+
+    /**
+    * Clears all overlaps, ready for a new set.
+    *
+    * @param numNodes one more than the largest node index that will be added
+    */
+    void Reset(unsigned numNodes);
+
+
+    /**
+    * Adds the overlap between a pair of nodes.
+    *
+    * @param indexA the first node's index
+    * @param radiusA the first node's radius
+    * @param indexB the second node's index
+    * @param radiusB the second node's radius
+    * @param separation the distance between them
+    */
+    void AddOverlap(unsigned indexA, double radiusA, unsigned indexB, double radiusB, double separation);
+
+
+    /**
+    * @return the estimated volume of a node's cell, given the overlaps added since the last Reset
+    *
+    * @param index the node's index
+    * @param radius the node's radius
+    */
+    double GetVolume(unsigned index, double radius) const;
+
+
+    /**
+    * @return the volume a node has given up to its neighbours so far, e.g. to send to another process that
+    * adds overlaps for the same node (see RepulsionForceSizeCorrected::SetTransport)
+    *
+    * @param index the node's index
+    */
+    double GetVolumeGivenUp(unsigned index) const;
+
+
+    /**
+    * Replaces the volume a node has given up to its neighbours.
+    *
+    * @param index the node's index
+    * @param volume the volume
+    */
+    void SetVolumeGivenUp(unsigned index, double volume);
+
+};
+
+#endif /*OVERLAPVOLUMEESTIMATOR_HPP_*/
@@ -0,0 +1,320 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GermlineCheckpointModifier.hpp"
+#include "GermlineProfiler.hpp"
+#include "GermlineSnapshot.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "OutputFileHandler.hpp"
+#include "BinaryRecordReader.hpp"
+#include "TrajectoryReader.hpp"
+#include "SimulationTime.hpp"
+#include "Exception.hpp"
+
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include <dirent.h>
+
+
+//File name of a checkpoint slot
+static std::string CheckpointFileName(unsigned slot)
+{
+    std::stringstream name;
+    name << "Checkpoint" << slot << ".bin";
+    return name.str();
+}
+
+
+//Keeps the lines of a tab delimited data file whose first column (time) is no later than the given time
+static void TruncateDataFile(std::string filePath, double time)
+{
+    std::ifstream input(filePath.c_str());
+    if (!input.is_open()){
+        return;
+    }
+    std::vector<std::string> keptLines;
+    std::string line;
+    while (std::getline(input, line)){
+        if (std::strtod(line.c_str(), NULL) <= time + 1e-6){
+            keptLines.push_back(line);
+        }
+    }
+    input.close();
+
+    std::string tempPath = filePath + ".tmp";
+    std::ofstream output(tempPath.c_str());
+    for (unsigned i = 0; i < keptLines.size(); i++){
+        output << keptLines[i] << "\n";
+    }
+    output.close();
+    if (output.fail() || std::rename(tempPath.c_str(), filePath.c_str()) != 0){
+        EXCEPTION("Failed to trim " << filePath);
+    }
+}
+
+
+
+//Constructor
+GermlineCheckpointModifier::GermlineCheckpointModifier(boost::shared_ptr<DTCMovementModel<3> > pLeaderCell,
+                                                       boost::shared_ptr<LeaderCellBoundaryCondition<3> > pBoundaryCondition,
+                                                       boost::shared_ptr<OocyteFatedCellApoptosis<3> > pApoptosis,
+                                                       double simulatedHoursBetweenCheckpoints,
+                                                       double wallClockMinutesBetweenCheckpoints,
+                                                       unsigned timestepsPerHour,
+                                                       unsigned numCheckpointsKept)
+    : AbstractCellBasedSimulationModifier<3>(),
+      mpLeaderCell(pLeaderCell),
+      mpBoundaryCondition(pBoundaryCondition),
+      mpApoptosis(pApoptosis),
+      mSimulatedHoursBetweenCheckpoints(simulatedHoursBetweenCheckpoints),
+      mWallClockMinutesBetweenCheckpoints(wallClockMinutesBetweenCheckpoints),
+      mTimestepsPerHour(timestepsPerHour),
+      mNumCheckpointsKept(numCheckpointsKept),
+      mTimeOfLastCheckpoint(0.0),
+      mWallTimeOfLastCheckpoint(0),
+      mNextCheckpoint(0)
+{
+    if (mNumCheckpointsKept == 0){
+        EXCEPTION("At least one checkpoint file must be kept.");
+    }
+    if (mTimestepsPerHour == 0){
+        mTimestepsPerHour = 1;
+    }
+}
+
+
+//Destructor
+GermlineCheckpointModifier::~GermlineCheckpointModifier(){}
+
+
+//Start timing from now, and write next over whichever slot is empty, invalid or oldest
+void GermlineCheckpointModifier::SetupSolve(AbstractCellPopulation<3,3>& rCellPopulation, std::string outputDirectory)
+{
+    OutputFileHandler handler(mCheckpointDirectory.empty() ? outputDirectory : mCheckpointDirectory, false);
+    mOutputDirectoryFullPath = handler.GetOutputDirectoryFullPath();
+    mTimeOfLastCheckpoint = SimulationTime::Instance()->GetTime();
+    mWallTimeOfLastCheckpoint = std::time(NULL);
+
+    mNextCheckpoint = 0;
+    double oldestTime = DBL_MAX;
+    for (unsigned slot = 0; slot < mNumCheckpointsKept; slot++){
+        GermlineSnapshot snapshot;
+        try{
+            snapshot.ReadFromFile(mOutputDirectoryFullPath + CheckpointFileName(slot));
+        }
+        catch (Exception&){
+            mNextCheckpoint = slot;
+            return;
+        }
+        if (snapshot.GetTime() < oldestTime){
+            oldestTime = snapshot.GetTime();
+            mNextCheckpoint = slot;
+        }
+    }
+}
+
+
+//Checkpoint on whole hours once enough simulated or real time has passed
+void GermlineCheckpointModifier::UpdateAtEndOfTimeStep(AbstractCellPopulation<3,3>& rCellPopulation)
+{
+    ScopedProfileTimer timer(GermlineProfiler::CHECKPOINTS);
+
+    if (SimulationTime::Instance()->GetTimeStepsElapsed() % mTimestepsPerHour != 0){
+        return;
+    }
+
+    double time = SimulationTime::Instance()->GetTime();
+    std::time_t wallTime = std::time(NULL);
+    bool simulatedTimeDue = mSimulatedHoursBetweenCheckpoints > 0
+                            && time - mTimeOfLastCheckpoint >= mSimulatedHoursBetweenCheckpoints - 1e-6;
+    bool wallClockDue = mWallClockMinutesBetweenCheckpoints > 0
+                        && std::difftime(wallTime, mWallTimeOfLastCheckpoint) >= 60.0*mWallClockMinutesBetweenCheckpoints;
+    if (!simulatedTimeDue && !wallClockDue){
+        return;
+    }
+
+    NodeBasedCellPopulation<3>* p_population = dynamic_cast<NodeBasedCellPopulation<3>*>(&rCellPopulation);
+    if (p_population == NULL){
+        EXCEPTION("GermlineCheckpointModifier requires a NodeBasedCellPopulation.");
+    }
+    if (mpDataOutput){
+        mpDataOutput->FlushOutput();
+    }
+    if (mpLineageOutput){
+        mpLineageOutput->FlushOutput();
+    }
+    GermlineSnapshot snapshot;
+    snapshot.Capture(*p_population, *mpLeaderCell, *mpBoundaryCondition, *mpApoptosis);
+    snapshot.WriteToFile(mOutputDirectoryFullPath + CheckpointFileName(mNextCheckpoint));
+    std::cout << "Checkpoint " << mNextCheckpoint << " written at time " << time << std::endl;
+
+    mTimeOfLastCheckpoint = time;
+    mWallTimeOfLastCheckpoint = wallTime;
+    mNextCheckpoint = (mNextCheckpoint + 1) % mNumCheckpointsKept;
+}
+
+
+//Setter for mCheckpointDirectory
+void GermlineCheckpointModifier::SetCheckpointDirectory(std::string directory)
+{
+    mCheckpointDirectory = directory;
+}
+
+
+//Setter for mpDataOutput
+void GermlineCheckpointModifier::SetDataOutput(boost::shared_ptr<GonadArmDataOutput<3> > pDataOutput)
+{
+    mpDataOutput = pDataOutput;
+}
+
+
+//Setter for mpLineageOutput
+void GermlineCheckpointModifier::SetLineageOutput(boost::shared_ptr<LineageOutput<3> > pLineageOutput)
+{
+    mpLineageOutput = pLineageOutput;
+}
+
+
+//Output the checkpoint settings
+void GermlineCheckpointModifier::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<SimulatedHoursBetweenCheckpoints>" << mSimulatedHoursBetweenCheckpoints << "</SimulatedHoursBetweenCheckpoints>\n";
+    *rParamsFile << "\t\t\t<WallClockMinutesBetweenCheckpoints>" << mWallClockMinutesBetweenCheckpoints << "</WallClockMinutesBetweenCheckpoints>\n";
+    *rParamsFile << "\t\t\t<NumCheckpointsKept>" << mNumCheckpointsKept << "</NumCheckpointsKept>\n";
+    // Call method on direct parent class
+    AbstractCellBasedSimulationModifier<3>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+
+//Reads every slot of every results_from_time_X folder, skipping any that are missing or damaged
+std::string GermlineCheckpointModifier::FindLatestCheckpoint(std::string outputDirectory, unsigned numCheckpointsKept)
+{
+    std::string chasteOutput = OutputFileHandler::GetChasteTestOutputDirectory();
+    if (outputDirectory.empty() || outputDirectory[outputDirectory.size()-1] != '/'){
+        outputDirectory += "/";
+    }
+
+    std::vector<std::string> resultsFolders;
+    DIR* p_dir = opendir((chasteOutput + outputDirectory).c_str());
+    if (p_dir == NULL){
+        return "";
+    }
+    for (struct dirent* p_entry = readdir(p_dir); p_entry != NULL; p_entry = readdir(p_dir)){
+        std::string name(p_entry->d_name);
+        if (name.compare(0, 18, "results_from_time_") == 0){
+            resultsFolders.push_back(outputDirectory + name + "/");
+        }
+    }
+    closedir(p_dir);
+
+    std::string latest;
+    double latestTime = -DBL_MAX;
+    for (unsigned i = 0; i < resultsFolders.size(); i++){
+        for (unsigned slot = 0; slot < numCheckpointsKept; slot++){
+            std::string filePath = resultsFolders[i] + CheckpointFileName(slot);
+            GermlineSnapshot snapshot;
+            try{
+                snapshot.ReadFromFile(chasteOutput + filePath);
+            }
+            catch (Exception&){
+                continue;
+            }
+            if (snapshot.GetTime() > latestTime){
+                latestTime = snapshot.GetTime();
+                latest = filePath;
+            }
+        }
+    }
+    return latest;
+}
+
+
+//Trims the data files written by GonadArmDataOutput, CellTrackingOutput and LineageOutput
+void GermlineCheckpointModifier::DiscardOutputAfter(std::string outputDirectoryFullPath, double time)
+{
+    TruncateDataFile(outputDirectoryFullPath + "GonadData.txt", time);
+    BinaryRecordReader::TruncateAfter(outputDirectoryFullPath + "GonadData.bin", time);
+    TruncateDataFile(outputDirectoryFullPath + "TrackingData.txt", time);
+    TrajectoryReader::TruncateAfter(outputDirectoryFullPath + "TrackingData.traj", time);
+    TruncateDataFile(outputDirectoryFullPath + "DivisionData.txt", time);
+    BinaryRecordReader::TruncateAfter(outputDirectoryFullPath + "DivisionData.bin", time);
+}
+
+
+//Getters
+boost::shared_ptr<DTCMovementModel<3> > GermlineCheckpointModifier::GetLeaderCell() const
+{
+    return mpLeaderCell;
+}
+
+boost::shared_ptr<LeaderCellBoundaryCondition<3> > GermlineCheckpointModifier::GetBoundaryCondition() const
+{
+    return mpBoundaryCondition;
+}
+
+boost::shared_ptr<OocyteFatedCellApoptosis<3> > GermlineCheckpointModifier::GetApoptosis() const
+{
+    return mpApoptosis;
+}
+
+double GermlineCheckpointModifier::GetSimulatedHoursBetweenCheckpoints() const
+{
+    return mSimulatedHoursBetweenCheckpoints;
+}
+
+double GermlineCheckpointModifier::GetWallClockMinutesBetweenCheckpoints() const
+{
+    return mWallClockMinutesBetweenCheckpoints;
+}
+
+unsigned GermlineCheckpointModifier::GetTimestepsPerHour() const
+{
+    return mTimestepsPerHour;
+}
+
+unsigned GermlineCheckpointModifier::GetNumCheckpointsKept() const
+{
+    return mNumCheckpointsKept;
+}
+
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(GermlineCheckpointModifier)
@@ -0,0 +1,277 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GERMLINECHECKPOINTMODIFIER_HPP_
+#define GERMLINECHECKPOINTMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "DTCMovementModel.hpp"
+#include "LeaderCellBoundaryCondition.hpp"
+#include "OocyteFatedCellApoptosis.hpp"
+#include "GonadArmDataOutput.hpp"
+#include "LineageOutput.hpp"
+
+#include <string>
+#include <ctime>
+
+/**
+* A modifier that periodically saves a GermlineSnapshot of the simulation, so that a run which is killed
+* can be resumed from its latest checkpoint (see TestElegansGermlineResume) rather than from the start.
+*
+* A checkpoint is taken every mSimulatedHoursBetweenCheckpoints simulated hours, or once
+* mWallClockMinutesBetweenCheckpoints real minutes have passed since the last one, whichever comes first
+* (either can be switched off by setting it to 0). Checkpoints are only taken on whole simulated hours, so a
+* resumed run keeps recording data at the same times as the original.
+*
+* Checkpoints rotate through mNumCheckpointsKept files, Checkpoint0.bin, Checkpoint1.bin, ..., in the
+* simulation's results folder (results_from_time_X), always overwriting the oldest. Each is written to a temporary file and renamed into place, so even
+* if the process is killed mid-write, the previous checkpoints are left intact.
+*
+* This modifier should be added to the simulation last, so the checkpoint sees the other modifiers' updates.
+*/
+class GermlineCheckpointModifier : public AbstractCellBasedSimulationModifier<3,3>
+{
+
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<3,3> >(*this);
+    }
+
+    //Simulation components whose state is not held in the cell population
+    boost::shared_ptr<DTCMovementModel<3> > mpLeaderCell;
+    boost::shared_ptr<LeaderCellBoundaryCondition<3> > mpBoundaryCondition;
+    boost::shared_ptr<OocyteFatedCellApoptosis<3> > mpApoptosis;
+
+    //Checkpoint frequency. 0 switches off the corresponding trigger.
+    double mSimulatedHoursBetweenCheckpoints;
+    double mWallClockMinutesBetweenCheckpoints;
+
+    //Number of timesteps in a simulated hour, used to only checkpoint on whole hours
+    unsigned mTimestepsPerHour;
+
+    //Number of checkpoint files to rotate through
+    unsigned mNumCheckpointsKept;
+
+    //If set, data output that is flushed before each checkpoint, so the data file is never behind it
+    boost::shared_ptr<GonadArmDataOutput<3> > mpDataOutput;
+
+    //If set, division output that is flushed before each checkpoint, for the same reason
+    boost::shared_ptr<LineageOutput<3> > mpLineageOutput;
+
+    //If set, the directory to write checkpoints to instead of the results folder (e.g. when continuing a run)
+    std::string mCheckpointDirectory;
+
+    //Where checkpoints go, and when and where the last one was written
+    std::string mOutputDirectoryFullPath;
+    double mTimeOfLastCheckpoint;
+    std::time_t mWallTimeOfLastCheckpoint;
+    unsigned mNextCheckpoint;
+
+public:
+
+    /**
+    * Constructor.
+    *
+    * @param pLeaderCell the DTC movement modifier
+    * @param pBoundaryCondition the tube boundary condition
+    * @param pApoptosis the apoptosis killer, whose first use of the death rate is recorded in each checkpoint
+    * @param simulatedHoursBetweenCheckpoints simulated time between checkpoints, 0 for none
+    * @param wallClockMinutesBetweenCheckpoints real time between checkpoints, 0 for none
+    * @param timestepsPerHour number of timesteps in a simulated hour
+    * @param numCheckpointsKept number of checkpoint files to rotate through
+    */
+    GermlineCheckpointModifier(boost::shared_ptr<DTCMovementModel<3> > pLeaderCell,
+                               boost::shared_ptr<LeaderCellBoundaryCondition<3> > pBoundaryCondition,
+                               boost::shared_ptr<OocyteFatedCellApoptosis<3> > pApoptosis,
+                               double simulatedHoursBetweenCheckpoints,
+                               double wallClockMinutesBetweenCheckpoints,
+                               unsigned timestepsPerHour,
+                               unsigned numCheckpointsKept = 2);
+
+
+    /**
+    * Destructor.
+    */
+    virtual ~GermlineCheckpointModifier();
+
+
+    /**
+    * Overridden SetupSolve method. Notes the output directory and picks the oldest checkpoint slot to write next.
+    *
+    * @param rCellPopulation reference to the cell population
+    * @param outputDirectory the output directory, relative to where Chaste output is stored
+    */
+    void SetupSolve(AbstractCellPopulation<3,3>& rCellPopulation, std::string outputDirectory);
+
+
+    /**
+    * Overridden UpdateAtEndOfTimeStep method. Writes a checkpoint if one is due.
+    *
+    * @param rCellPopulation reference to the cell population
+    */
+    void UpdateAtEndOfTimeStep(AbstractCellPopulation<3,3>& rCellPopulation);
+
+
+    /**
+    * Write checkpoints to a given directory rather than the simulation's results folder. A resumed run uses
+    * this to carry on rotating through the checkpoints it was restored from. Not archived.
+    *
+    * @param directory the directory, relative to where Chaste output is stored
+    */
+    void SetCheckpointDirectory(std::string directory);
+
+
+    /**
+    * Flush a data output before every checkpoint. Needed when the output buffers its data (as binary
+    * GonadData output does), so that a run resumed from the checkpoint has no gap in its data. Not archived.
+    *
+    * @param pDataOutput the data output
+    */
+    void SetDataOutput(boost::shared_ptr<GonadArmDataOutput<3> > pDataOutput);
+
+
+    //As SetDataOutput, for the division log. Not archived.
+    void SetLineageOutput(boost::shared_ptr<LineageOutput<3> > pLineageOutput);
+
+
+    //Output the checkpoint settings
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+
+
+    /**
+    * @return the path, relative to where Chaste output is stored, of the most recent valid checkpoint in any
+    * results folder of a simulation's output directory, or an empty string if there is none
+    *
+    * @param outputDirectory the simulation's output directory, relative to where Chaste output is stored
+    * @param numCheckpointsKept the number of checkpoint files the run rotated through
+    */
+    static std::string FindLatestCheckpoint(std::string outputDirectory, unsigned numCheckpointsKept = 2);
+
+
+    /**
+    * Removes rows recorded after a given time from the GonadData, TrackingData and DivisionData files (text or
+    * binary) in a directory, so that a resumed run does not repeat the rows written between its checkpoint and
+    * the crash.
+    *
+    * @param outputDirectoryFullPath full path of the results folder holding the checkpoint
+    * @param time the time of the checkpoint being resumed from
+    */
+    static void DiscardOutputAfter(std::string outputDirectoryFullPath, double time);
+
+
+    //Getters for the constructor arguments
+    boost::shared_ptr<DTCMovementModel<3> > GetLeaderCell() const;
+    boost::shared_ptr<LeaderCellBoundaryCondition<3> > GetBoundaryCondition() const;
+    boost::shared_ptr<OocyteFatedCellApoptosis<3> > GetApoptosis() const;
+    double GetSimulatedHoursBetweenCheckpoints() const;
+    double GetWallClockMinutesBetweenCheckpoints() const;
+    unsigned GetTimestepsPerHour() const;
+    unsigned GetNumCheckpointsKept() const;
+
+};
+
+
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(GermlineCheckpointModifier)
+
+namespace boost
+{
+    namespace serialization
+    {
+        /**
+        * Serialize information required to construct a GermlineCheckpointModifier.
+        */
+        template<class Archive>
+        inline void save_construct_data(
+            Archive & ar, const GermlineCheckpointModifier* t, const BOOST_PFTO unsigned int file_version)
+        {
+            // Save data required to construct instance
+            const boost::shared_ptr<DTCMovementModel<3> > pLeaderCell = t->GetLeaderCell();
+            ar << pLeaderCell;
+            const boost::shared_ptr<LeaderCellBoundaryCondition<3> > pBoundaryCondition = t->GetBoundaryCondition();
+            ar << pBoundaryCondition;
+            const boost::shared_ptr<OocyteFatedCellApoptosis<3> > pApoptosis = t->GetApoptosis();
+            ar << pApoptosis;
+            const double simulatedHours = t->GetSimulatedHoursBetweenCheckpoints();
+            ar << simulatedHours;
+            const double wallClockMinutes = t->GetWallClockMinutesBetweenCheckpoints();
+            ar << wallClockMinutes;
+            const unsigned timestepsPerHour = t->GetTimestepsPerHour();
+            ar << timestepsPerHour;
+            const unsigned numKept = t->GetNumCheckpointsKept();
+            ar << numKept;
+        }
+
+
+        /**
+        * De-serialize constructor parameters and initialize a GermlineCheckpointModifier.
+        */
+        template<class Archive>
+        inline void load_construct_data(
+            Archive & ar, GermlineCheckpointModifier* t, const unsigned int file_version)
+        {
+            // Retrieve data from archive required to construct new instance
+            boost::shared_ptr<DTCMovementModel<3> > pLeaderCell;
+            ar >> pLeaderCell;
+            boost::shared_ptr<LeaderCellBoundaryCondition<3> > pBoundaryCondition;
+            ar >> pBoundaryCondition;
+            boost::shared_ptr<OocyteFatedCellApoptosis<3> > pApoptosis;
+            ar >> pApoptosis;
+            double simulatedHours;
+            ar >> simulatedHours;
+            double wallClockMinutes;
+            ar >> wallClockMinutes;
+            unsigned timestepsPerHour;
+            ar >> timestepsPerHour;
+            unsigned numKept;
+            ar >> numKept;
+
+            // Invoke inplace constructor to initialise instance
+            ::new(t)GermlineCheckpointModifier(pLeaderCell, pBoundaryCondition, pApoptosis,
+                                               simulatedHours, wallClockMinutes, timestepsPerHour, numKept);
+        }
+    }
+} // namespace ...
+
+#endif /*GERMLINECHECKPOINTMODIFIER_HPP_*/
@@ -0,0 +1,687 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CheckpointArchiveTypes.hpp"
+#include "GermlineSnapshot.hpp"
+#include "GlobalParameterStruct.hpp"
+#include "SimulationTime.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "CellRandomStreams.hpp"
+#include "CellId.hpp"
+#include "CellAncestor.hpp"
+#include "CellData.hpp"
+#include "CellPropertyCollection.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "SmartPointers.hpp"
+#include "Exception.hpp"
+
+#include <map>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#include <boost/crc.hpp>
+
+
+//File layout constants. Bump the version whenever the payload layout changes.
+static const char SNAPSHOT_MAGIC[8] = {'E','G','S','N','A','P','\0','\0'};
+static const boost::uint32_t SNAPSHOT_VERSION = 2;
+static const boost::uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+static const unsigned SNAPSHOT_HEADER_SIZE = 8 + 4 + 4 + 8 + 4;   // <- magic, version, byte order, payload size, CRC
+
+
+//Helpers for packing values and arrays into a byte buffer, and reading them back out
+template<typename T>
+static void WriteValue(std::vector<char>& rBuffer, const T& rValue)
+{
+    const char* p_bytes = reinterpret_cast<const char*>(&rValue);
+    rBuffer.insert(rBuffer.end(), p_bytes, p_bytes + sizeof(T));
+}
+
+template<typename T>
+static void WriteArray(std::vector<char>& rBuffer, const std::vector<T>& rValues)
+{
+    WriteValue(rBuffer, (boost::uint64_t)rValues.size());
+    if (!rValues.empty()){
+        const char* p_bytes = reinterpret_cast<const char*>(&rValues[0]);
+        rBuffer.insert(rBuffer.end(), p_bytes, p_bytes + rValues.size()*sizeof(T));
+    }
+}
+
+static void WriteString(std::vector<char>& rBuffer, const std::string& rValue)
+{
+    WriteValue(rBuffer, (boost::uint64_t)rValue.size());
+    rBuffer.insert(rBuffer.end(), rValue.begin(), rValue.end());
+}
+
+static void CheckRemaining(const std::vector<char>& rBuffer, std::size_t position, boost::uint64_t numBytes)
+{
+    if (numBytes > rBuffer.size() - position){
+        EXCEPTION("Snapshot is truncated or corrupt.");
+    }
+}
+
+template<typename T>
+static void ReadValue(const std::vector<char>& rBuffer, std::size_t& rPosition, T& rValue)
+{
+    CheckRemaining(rBuffer, rPosition, sizeof(T));
+    std::memcpy(&rValue, &rBuffer[rPosition], sizeof(T));
+    rPosition += sizeof(T);
+}
+
+template<typename T>
+static void ReadArray(const std::vector<char>& rBuffer, std::size_t& rPosition, std::vector<T>& rValues)
+{
+    boost::uint64_t size;
+    ReadValue(rBuffer, rPosition, size);
+    CheckRemaining(rBuffer, rPosition, size*sizeof(T));
+    rValues.resize(size);
+    if (size > 0){
+        std::memcpy(&rValues[0], &rBuffer[rPosition], size*sizeof(T));
+        rPosition += size*sizeof(T);
+    }
+}
+
+static void ReadString(const std::vector<char>& rBuffer, std::size_t& rPosition, std::string& rValue)
+{
+    boost::uint64_t size;
+    ReadValue(rBuffer, rPosition, size);
+    CheckRemaining(rBuffer, rPosition, size);
+    rValue.assign(rBuffer.begin() + rPosition, rBuffer.begin() + rPosition + size);
+    rPosition += size;
+}
+
+static boost::uint32_t Checksum(const std::vector<char>& rBuffer, std::size_t start)
+{
+    boost::crc_32_type crc;
+    if (rBuffer.size() > start){
+        crc.process_bytes(&rBuffer[start], rBuffer.size() - start);
+    }
+    return crc.checksum();
+}
+
+
+
+//Constructor
+GermlineSnapshot::GermlineSnapshot()
+    : mTime(0.0),
+      mDt(0.0),
+      mMaxCellId(0),
+      mNumChartVariables(0),
+      mUnc5(0),
+      mVab3(0),
+      mTurnComplete(0),
+      mTimeSinceLastUpdate(0.0),
+      mSpacing(0.0),
+      mLeaderCellLocation(3, 0.0),
+      mTubeRadius(0.0),
+      mCellRandomSeed(0)
+{}
+
+
+//Copies the state of a running simulation into flat arrays
+void GermlineSnapshot::Capture(NodeBasedCellPopulation<3>& rCellPopulation,
+                               const DTCMovementModel<3>& rLeaderCell,
+                               const LeaderCellBoundaryCondition<3>& rBoundaryCondition,
+                               const OocyteFatedCellApoptosis<3>& rApoptosis)
+{
+    //Time and parameters
+    mTime = SimulationTime::Instance()->GetTime();
+    mDt = SimulationTime::Instance()->GetTimeStep();
+    GlobalParameterStruct* p_parameters = GlobalParameterStruct::Instance();
+    if (rApoptosis.GetTimeOfFirstUse() >= 0){
+        p_parameters->RecordParameterRead(21, rApoptosis.GetTimeOfFirstUse());
+    }
+    mDirectory = p_parameters->GetDirectory();
+    mParameters.clear();
+    mFirstReadTimes.clear();
+    for (unsigned i = 0; i < p_parameters->GetNumParameters(); i++){
+        mParameters.push_back(p_parameters->PeekParameter(i));
+        mFirstReadTimes.push_back(p_parameters->GetFirstReadTime(i));
+    }
+
+    //Cells. The DTC (node 0) goes first, so that it is node 0 again on restore.
+    std::vector<CellPtr> cells;
+    CellPtr p_leader_cell = rCellPopulation.GetCellUsingLocationIndex(0);
+    cells.push_back(p_leader_cell);
+    for (AbstractCellPopulation<3>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End(); ++cell_iter)
+    {
+        if (*cell_iter != p_leader_cell){
+            cells.push_back(*cell_iter);
+        }
+    }
+    unsigned numCells = cells.size();
+
+    MAKE_PTR(CellId, p_id);
+    mMaxCellId = p_id->GetMaxCellId();
+    mCellIds.resize(numCells);
+    mAncestors.resize(numCells);
+    mX.resize(numCells);
+    mY.resize(numCells);
+    mZ.resize(numCells);
+    mRadii.resize(numCells);
+    mBirthTimes.resize(numCells);
+    mIsDifferentiated.resize(numCells);
+    mTimesUntilDeath.resize(numCells);
+    mApoptosisTimes.resize(numCells);
+    mChartStates.resize(numCells);
+    mChartVariables.clear();
+    mCellDataKeys.clear();
+    mCellDataValues.clear();
+    mCellDataPresent.clear();
+    std::map<std::string, unsigned> keyColumns;
+
+    for (unsigned i = 0; i < numCells; i++){
+        CellPtr p_cell = cells[i];
+        Node<3>* p_node = rCellPopulation.GetNode(rCellPopulation.GetLocationIndexUsingCell(p_cell));
+        const c_vector<double, 3>& rLocation = p_node->rGetLocation();
+
+        mCellIds[i] = p_cell->GetCellId();
+        mAncestors[i] = p_cell->GetAncestor();
+        mX[i] = rLocation[0];
+        mY[i] = rLocation[1];
+        mZ[i] = rLocation[2];
+        mRadii[i] = p_node->GetRadius();
+        mBirthTimes[i] = p_cell->GetCellCycleModel()->GetBirthTime();
+        mIsDifferentiated[i] = p_cell->GetCellProliferativeType()->IsType<DifferentiatedCellProliferativeType>();
+        mTimesUntilDeath[i] = p_cell->HasApoptosisBegun() ? std::max(p_cell->GetTimeUntilDeath(), 0.0) : -1.0;
+        mApoptosisTimes[i] = p_cell->GetApoptosisTime();
+
+        AbstractStatechartCellCycleModel* p_model = dynamic_cast<AbstractStatechartCellCycleModel*>(p_cell->GetCellCycleModel());
+        if (p_model == NULL){
+            EXCEPTION("GermlineSnapshot requires every cell to have a statechart cell cycle model.");
+        }
+        mChartStates[i] = (boost::uint32_t)p_model->GetChartState().to_ulong();
+        std::vector<double> variables = p_model->GetChartVariables();
+        if (i == 0){
+            mNumChartVariables = variables.size();
+        }
+        if (variables.size() != mNumChartVariables){
+            EXCEPTION("Cells in a snapshot must all use the same statechart.");
+        }
+        mChartVariables.insert(mChartVariables.end(), variables.begin(), variables.end());
+
+        //Cell data: add a column the first time a key is seen
+        std::vector<std::string> keys = p_cell->GetCellData()->GetKeys();
+        for (unsigned k = 0; k < keys.size(); k++){
+            std::map<std::string, unsigned>::iterator column = keyColumns.find(keys[k]);
+            if (column == keyColumns.end()){
+                column = keyColumns.insert(std::make_pair(keys[k], (unsigned)mCellDataKeys.size())).first;
+                mCellDataKeys.push_back(keys[k]);
+                mCellDataValues.push_back(std::vector<double>(numCells, 0.0));
+                mCellDataPresent.push_back(std::vector<boost::uint8_t>(numCells, 0));
+            }
+            mCellDataValues[column->second][i] = p_cell->GetCellData()->GetItem(keys[k]);
+            mCellDataPresent[column->second][i] = 1;
+        }
+    }
+
+    //Leader cell and boundary condition
+    mUnc5 = rLeaderCell.getUnc5();
+    mVab3 = rLeaderCell.getVab3();
+    mTurnComplete = rLeaderCell.getTurnComplete();
+    mTimeSinceLastUpdate = rLeaderCell.getTimeSinceLastUpdate();
+    mSpacing = rLeaderCell.getSpacing();
+    c_vector<double, 3> leaderCellLocation = rLeaderCell.getCurrentLocation();
+    for (unsigned d = 0; d < 3; d++){
+        mLeaderCellLocation[d] = leaderCellLocation[d];
+    }
+    std::vector< c_vector<double, 3> > pathPoints = rLeaderCell.getPathPointCollection();
+    std::vector< int > pathTypes = rLeaderCell.getPathPointTypes();
+    mPathX.resize(pathPoints.size());
+    mPathY.resize(pathPoints.size());
+    mPathZ.resize(pathPoints.size());
+    mPathTypes.assign(pathTypes.begin(), pathTypes.end());
+    for (unsigned p = 0; p < pathPoints.size(); p++){
+        mPathX[p] = pathPoints[p][0];
+        mPathY[p] = pathPoints[p][1];
+        mPathZ[p] = pathPoints[p][2];
+    }
+    mTubeRadius = rBoundaryCondition.GetTubeRadius();
+
+    //Random number generator, via its serialization wrapper as in Chaste's own checkpoints
+    std::ostringstream rngStream;
+    {
+        boost::archive::binary_oarchive archive(rngStream);
+        SerializableSingleton<RandomNumberGenerator>* const p_wrapper = RandomNumberGenerator::Instance()->GetSerializationWrapper();
+        archive << p_wrapper;
+    }
+    mRandomNumberGeneratorState = rngStream.str();
+    mCellRandomSeed = CellRandomStreams::Instance()->GetSeed();
+}
+
+
+//Packs the snapshot into a buffer, then writes it to a temporary file which replaces the target once safely on disk
+void GermlineSnapshot::WriteToFile(std::string filePath) const
+{
+    std::vector<char> buffer(SNAPSHOT_HEADER_SIZE);
+
+    WriteValue(buffer, mTime);
+    WriteValue(buffer, mDt);
+    WriteString(buffer, mDirectory);
+    WriteArray(buffer, mParameters);
+    WriteArray(buffer, mFirstReadTimes);
+
+    WriteValue(buffer, mMaxCellId);
+    WriteArray(buffer, mCellIds);
+    WriteArray(buffer, mAncestors);
+    WriteArray(buffer, mX);
+    WriteArray(buffer, mY);
+    WriteArray(buffer, mZ);
+    WriteArray(buffer, mRadii);
+    WriteArray(buffer, mBirthTimes);
+    WriteArray(buffer, mIsDifferentiated);
+    WriteArray(buffer, mTimesUntilDeath);
+    WriteArray(buffer, mApoptosisTimes);
+    WriteArray(buffer, mChartStates);
+    WriteValue(buffer, mNumChartVariables);
+    WriteArray(buffer, mChartVariables);
+    WriteValue(buffer, (boost::uint64_t)mCellDataKeys.size());
+    for (unsigned k = 0; k < mCellDataKeys.size(); k++){
+        WriteString(buffer, mCellDataKeys[k]);
+        WriteArray(buffer, mCellDataValues[k]);
+        WriteArray(buffer, mCellDataPresent[k]);
+    }
+
+    WriteValue(buffer, mUnc5);
+    WriteValue(buffer, mVab3);
+    WriteValue(buffer, mTurnComplete);
+    WriteValue(buffer, mTimeSinceLastUpdate);
+    WriteValue(buffer, mSpacing);
+    WriteArray(buffer, mLeaderCellLocation);
+    WriteArray(buffer, mPathX);
+    WriteArray(buffer, mPathY);
+    WriteArray(buffer, mPathZ);
+    WriteArray(buffer, mPathTypes);
+    WriteValue(buffer, mTubeRadius);
+
+    WriteString(buffer, mRandomNumberGeneratorState);
+    WriteValue(buffer, mCellRandomSeed);
+
+    //Fill in the header now the payload is known
+    boost::uint64_t payloadSize = buffer.size() - SNAPSHOT_HEADER_SIZE;
+    boost::uint32_t checksum = Checksum(buffer, SNAPSHOT_HEADER_SIZE);
+    std::size_t position = 0;
+    std::memcpy(&buffer[position], SNAPSHOT_MAGIC, 8);                  position += 8;
+    std::memcpy(&buffer[position], &SNAPSHOT_VERSION, 4);               position += 4;
+    std::memcpy(&buffer[position], &SNAPSHOT_BYTE_ORDER, 4);            position += 4;
+    std::memcpy(&buffer[position], &payloadSize, 8);                    position += 8;
+    std::memcpy(&buffer[position], &checksum, 4);
+
+    std::string tempPath = filePath + ".tmp";
+    FILE* p_file = std::fopen(tempPath.c_str(), "wb");
+    if (p_file == NULL){
+        EXCEPTION("Could not open " << tempPath << " to write a snapshot.");
+    }
+    bool written = std::fwrite(&buffer[0], 1, buffer.size(), p_file) == buffer.size();
+    written = (std::fflush(p_file) == 0) && written;
+    written = (fsync(fileno(p_file)) == 0) && written;
+    written = (std::fclose(p_file) == 0) && written;
+    if (!written || std::rename(tempPath.c_str(), filePath.c_str()) != 0){
+        std::remove(tempPath.c_str());
+        EXCEPTION("Failed to write snapshot " << filePath);
+    }
+}
+
+
+//Reads and validates a snapshot file
+void GermlineSnapshot::ReadFromFile(std::string filePath)
+{
+    FILE* p_file = std::fopen(filePath.c_str(), "rb");
+    if (p_file == NULL){
+        EXCEPTION("Could not open snapshot " << filePath);
+    }
+    std::vector<char> buffer;
+    char chunk[65536];
+    std::size_t numRead;
+    while ((numRead = std::fread(chunk, 1, sizeof(chunk), p_file)) > 0){
+        buffer.insert(buffer.end(), chunk, chunk + numRead);
+    }
+    std::fclose(p_file);
+
+    //Header
+    if (buffer.size() < SNAPSHOT_HEADER_SIZE || std::memcmp(&buffer[0], SNAPSHOT_MAGIC, 8) != 0){
+        EXCEPTION(filePath << " is not a germline snapshot.");
+    }
+    boost::uint32_t version;
+    boost::uint32_t byteOrder;
+    boost::uint64_t payloadSize;
+    boost::uint32_t checksum;
+    std::size_t position = 8;
+    ReadValue(buffer, position, version);
+    ReadValue(buffer, position, byteOrder);
+    ReadValue(buffer, position, payloadSize);
+    ReadValue(buffer, position, checksum);
+    if (version < 1 || version > SNAPSHOT_VERSION){
+        EXCEPTION("Snapshot " << filePath << " has format version " << version << ", but only versions 1 to "
+                  << SNAPSHOT_VERSION << " can be read.");
+    }
+    if (byteOrder != SNAPSHOT_BYTE_ORDER){
+        EXCEPTION("Snapshot " << filePath << " was written on a machine with a different byte order.");
+    }
+    if (payloadSize != buffer.size() - SNAPSHOT_HEADER_SIZE || checksum != Checksum(buffer, SNAPSHOT_HEADER_SIZE)){
+        EXCEPTION("Snapshot " << filePath << " is truncated or corrupt.");
+    }
+
+    //Payload, in the order it was written
+    ReadValue(buffer, position, mTime);
+    ReadValue(buffer, position, mDt);
+    ReadString(buffer, position, mDirectory);
+    ReadArray(buffer, position, mParameters);
+    ReadArray(buffer, position, mFirstReadTimes);
+
+    ReadValue(buffer, position, mMaxCellId);
+    ReadArray(buffer, position, mCellIds);
+    ReadArray(buffer, position, mAncestors);
+    ReadArray(buffer, position, mX);
+    ReadArray(buffer, position, mY);
+    ReadArray(buffer, position, mZ);
+    ReadArray(buffer, position, mRadii);
+    ReadArray(buffer, position, mBirthTimes);
+    ReadArray(buffer, position, mIsDifferentiated);
+    ReadArray(buffer, position, mTimesUntilDeath);
+    ReadArray(buffer, position, mApoptosisTimes);
+    ReadArray(buffer, position, mChartStates);
+    ReadValue(buffer, position, mNumChartVariables);
+    ReadArray(buffer, position, mChartVariables);
+    boost::uint64_t numKeys;
+    ReadValue(buffer, position, numKeys);
+    mCellDataKeys.resize(numKeys);
+    mCellDataValues.resize(numKeys);
+    mCellDataPresent.resize(numKeys);
+    for (unsigned k = 0; k < numKeys; k++){
+        ReadString(buffer, position, mCellDataKeys[k]);
+        ReadArray(buffer, position, mCellDataValues[k]);
+        ReadArray(buffer, position, mCellDataPresent[k]);
+    }
+
+    ReadValue(buffer, position, mUnc5);
+    ReadValue(buffer, position, mVab3);
+    ReadValue(buffer, position, mTurnComplete);
+    ReadValue(buffer, position, mTimeSinceLastUpdate);
+    ReadValue(buffer, position, mSpacing);
+    ReadArray(buffer, position, mLeaderCellLocation);
+    ReadArray(buffer, position, mPathX);
+    ReadArray(buffer, position, mPathY);
+    ReadArray(buffer, position, mPathZ);
+    ReadArray(buffer, position, mPathTypes);
+    ReadValue(buffer, position, mTubeRadius);
+
+    ReadString(buffer, position, mRandomNumberGeneratorState);
+    mCellRandomSeed = 0;
+    if (version >= 2){
+        ReadValue(buffer, position, mCellRandomSeed);   // <- version 1 runs drew cells' numbers from the generator above
+    }
+
+    //Consistency of the per cell arrays
+    unsigned numCells = mCellIds.size();
+    if (mX.size() != numCells || mY.size() != numCells || mZ.size() != numCells || mRadii.size() != numCells
+        || mBirthTimes.size() != numCells || mIsDifferentiated.size() != numCells || mAncestors.size() != numCells
+        || mTimesUntilDeath.size() != numCells || mApoptosisTimes.size() != numCells || mChartStates.size() != numCells
+        || mChartVariables.size() != numCells*mNumChartVariables || mLeaderCellLocation.size() != 3
+        || mPathY.size() != mPathX.size() || mPathZ.size() != mPathX.size() || mPathTypes.size() != mPathX.size()){
+        EXCEPTION("Snapshot " << filePath << " is inconsistent.");
+    }
+}
+
+
+//Checks a file without keeping its contents
+bool GermlineSnapshot::IsValidFile(std::string filePath)
+{
+    try{
+        GermlineSnapshot snapshot;
+        snapshot.ReadFromFile(filePath);
+    }
+    catch (Exception&){
+        return false;
+    }
+    return true;
+}
+
+
+//Puts the saved parameters and time back. The time stepper is only needed (and only valid) after the start.
+void GermlineSnapshot::RestoreParametersAndTime() const
+{
+    GlobalParameterStruct* p_parameters = GlobalParameterStruct::Instance();
+    p_parameters->SetAllParameters(mParameters);
+    p_parameters->ResetDirectoryName(mDirectory);
+    for (unsigned i = 0; i < mFirstReadTimes.size(); i++){
+        if (mFirstReadTimes[i] >= 0){
+            p_parameters->RecordParameterRead(i, mFirstReadTimes[i]);
+        }
+    }
+
+    CellRandomStreams::Instance()->SetSeed(mCellRandomSeed);
+
+    SimulationTime::Destroy();
+    SimulationTime::Instance()->SetStartTime(mTime);
+    if (mTime > 0.0){
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(mTime + mDt, 1);
+    }
+}
+
+
+//Only the stored copy changes; the global parameters take it up when the snapshot is restored
+void GermlineSnapshot::SetParameter(unsigned index, double value)
+{
+    if (index >= mParameters.size()){
+        EXCEPTION("The snapshot holds no parameter " << index);
+    }
+    mParameters[index] = value;
+}
+
+
+double GermlineSnapshot::GetParameterFirstReadTime(unsigned index) const
+{
+    if (index >= mFirstReadTimes.size()){
+        return -1.0;
+    }
+    return mFirstReadTimes[index];
+}
+
+
+//Loads the generator state saved by Capture
+void GermlineSnapshot::RestoreRandomNumberGenerator() const
+{
+    std::istringstream rngStream(mRandomNumberGeneratorState);
+    boost::archive::binary_iarchive archive(rngStream);
+    SerializableSingleton<RandomNumberGenerator>* p_wrapper;
+    archive >> p_wrapper;
+}
+
+
+//Nodes are numbered in population order
+void GermlineSnapshot::CreateNodes(std::vector<Node<3>*>& rNodes) const
+{
+    rNodes.clear();
+    for (unsigned i = 0; i < mCellIds.size(); i++){
+        Node<3>* p_node = new Node<3>(i, false, mX[i], mY[i], mZ[i]);
+        p_node->SetRadius(mRadii[i]);
+        rNodes.push_back(p_node);
+    }
+}
+
+
+//Each model restores its chart's state and variables once it is given its cell
+void GermlineSnapshot::CreateCells(const AbstractStatechartModelFactory& rModel, std::vector<CellPtr>& rCells) const
+{
+    std::vector<AbstractCellCycleModel*> models;
+    for (unsigned i = 0; i < mCellIds.size(); i++){
+        std::vector<double> variables(mChartVariables.begin() + i*mNumChartVariables,
+                                      mChartVariables.begin() + (i+1)*mNumChartVariables);
+        models.push_back(rModel.CreateRestoredCellCycleModel(std::bitset<MAX_STATE_COUNT>((unsigned long)mChartStates[i]), variables));
+    }
+    CreateCellsFromModels(models, rCells);
+}
+
+
+//Cell IDs are handed out in creation order, so cells are created in ID order (skipping IDs of cells that
+//have since been removed), then put back into population order
+void GermlineSnapshot::CreateCellsFromModels(const std::vector<AbstractCellCycleModel*>& rModels, std::vector<CellPtr>& rCells) const
+{
+    unsigned numCells = mCellIds.size();
+    std::vector< std::pair<boost::uint32_t, unsigned> > idOrder;
+    for (unsigned i = 0; i < numCells; i++){
+        idOrder.push_back(std::make_pair(mCellIds[i], i));
+    }
+    std::sort(idOrder.begin(), idOrder.end());
+
+    boost::shared_ptr<AbstractCellProperty> p_state = CellPropertyRegistry::Instance()->Get<WildTypeCellMutationState>();
+    boost::shared_ptr<AbstractCellProperty> p_stem_type = CellPropertyRegistry::Instance()->Get<StemCellProliferativeType>();
+    boost::shared_ptr<AbstractCellProperty> p_diff_type = CellPropertyRegistry::Instance()->Get<DifferentiatedCellProliferativeType>();
+
+    CellId::ResetMaxCellId();
+    MAKE_PTR(CellId, p_unused_id);
+    rCells.assign(numCells, CellPtr());
+
+    for (unsigned n = 0; n < numCells; n++){
+        unsigned i = idOrder[n].second;
+        while (p_unused_id->GetMaxCellId() < mCellIds[i]){
+            p_unused_id->AssignCellId();
+        }
+
+        //The chart is restored as the cell is constructed, and may read cell data, so that goes in first
+        MAKE_PTR(CellData, p_cell_data);
+        for (unsigned k = 0; k < mCellDataKeys.size(); k++){
+            if (mCellDataPresent[k][i]){
+                p_cell_data->SetItem(mCellDataKeys[k], mCellDataValues[k][i]);
+            }
+        }
+        CellPropertyCollection properties;
+        properties.AddProperty(p_cell_data);
+
+        rModels[i]->SetBirthTime(mBirthTimes[i]);
+        CellPtr p_cell(new Cell(p_state, rModels[i], false, properties));
+        p_cell->SetCellProliferativeType(mIsDifferentiated[i] ? p_diff_type : p_stem_type);
+        if (mAncestors[i] != UNSIGNED_UNSET){
+            MAKE_PTR_ARGS(CellAncestor, p_ancestor, (mAncestors[i]));
+            p_cell->SetAncestor(p_ancestor);
+        }
+        rCells[i] = p_cell;
+    }
+    while (p_unused_id->GetMaxCellId() < mMaxCellId){
+        p_unused_id->AssignCellId();
+    }
+
+    //Cell data is set again now, since chart state constructors overwrite some of it
+    for (unsigned k = 0; k < mCellDataKeys.size(); k++){
+        for (unsigned i = 0; i < numCells; i++){
+            if (mCellDataPresent[k][i]){
+                rCells[i]->GetCellData()->SetItem(mCellDataKeys[k], mCellDataValues[k][i]);
+            }
+        }
+    }
+
+    //Apoptosis restarts now, lasting only the time that remained
+    for (unsigned i = 0; i < numCells; i++){
+        if (mTimesUntilDeath[i] >= 0.0){
+            rCells[i]->SetApoptosisTime(mTimesUntilDeath[i]);
+            rCells[i]->StartApoptosis();
+        }
+        rCells[i]->SetApoptosisTime(mApoptosisTimes[i]);
+    }
+}
+
+
+//Getters
+double GermlineSnapshot::GetTime() const
+{
+    return mTime;
+}
+
+unsigned GermlineSnapshot::GetNumCells() const
+{
+    return mCellIds.size();
+}
+
+std::vector< c_vector<double, 3> > GermlineSnapshot::GetPathPointCollection() const
+{
+    std::vector< c_vector<double, 3> > pathPoints(mPathX.size());
+    for (unsigned p = 0; p < mPathX.size(); p++){
+        pathPoints[p][0] = mPathX[p];
+        pathPoints[p][1] = mPathY[p];
+        pathPoints[p][2] = mPathZ[p];
+    }
+    return pathPoints;
+}
+
+std::vector< int > GermlineSnapshot::GetPathPointTypes() const
+{
+    return std::vector< int >(mPathTypes.begin(), mPathTypes.end());
+}
+
+c_vector<double, 3> GermlineSnapshot::GetLeaderCellLocation() const
+{
+    c_vector<double, 3> location;
+    for (unsigned d = 0; d < 3; d++){
+        location[d] = mLeaderCellLocation[d];
+    }
+    return location;
+}
+
+double GermlineSnapshot::GetSpacing() const
+{
+    return mSpacing;
+}
+
+double GermlineSnapshot::GetTimeSinceLastUpdate() const
+{
+    return mTimeSinceLastUpdate;
+}
+
+bool GermlineSnapshot::GetUnc5() const
+{
+    return mUnc5;
+}
+
+bool GermlineSnapshot::GetVab3() const
+{
+    return mVab3;
+}
+
+bool GermlineSnapshot::GetTurnComplete() const
+{
+    return mTurnComplete;
+}
+
+double GermlineSnapshot::GetTubeRadius() const
+{
+    return mTubeRadius;
+}
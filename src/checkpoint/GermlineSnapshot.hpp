@@ -0,0 +1,249 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GERMLINESNAPSHOT_HPP_
+#define GERMLINESNAPSHOT_HPP_
+
+#include <string>
+#include <vector>
+#include <bitset>
+#include <boost/cstdint.hpp>
+
+#include "UblasVectorInclude.hpp"
+#include "Node.hpp"
+#include "Cell.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "DTCMovementModel.hpp"
+#include "LeaderCellBoundaryCondition.hpp"
+#include "OocyteFatedCellApoptosis.hpp"
+#include "StatechartCellCycleModel.hpp"
+#include "StatechartModelFactory.hpp"
+
+/*
+* A compact, germline specific snapshot of a running simulation, used for frequent checkpointing.
+*
+* Unlike CellBasedSimulationArchiver, which pushes every object (and every chart's bitset and variables)
+* through a boost archive one at a time, a snapshot stores the state as flat arrays (positions, radii,
+* birth times, packed chart states, cell data...) that are written and read with a single block copy each.
+* The file holds:
+*
+* - A header: magic string, format version, byte order check, payload length and a CRC32 of the payload.
+* - Simulation time, time step, output directory, the full parameter vector and parameter first read times.
+* - One entry per cell, in population order: ID, ancestor, position, radius, birth time, proliferative type,
+*   time until death (negative if not apoptotic), apoptosis duration, chart state and chart variables, and cell data.
+* - The DTC's path (midline points and types), current location and gene states, and the tube radius.
+* - The random number generator state, and the seed of the cells' random number streams (CellRandomStreams).
+*
+* A file whose magic, version or checksum do not match is rejected with an exception, so a truncated or
+* partially written snapshot is never loaded. Files are written to a temporary name and renamed into place.
+*
+* As with the archive, the duration and compression threshold drawn on entry to a chart state are not stored;
+* they are redrawn when the chart is restored. Nodes are renumbered 0..N-1 in population order on restore,
+* with the DTC first, so a restored run is equivalent to, but not bitwise identical with, an uninterrupted one.
+*/
+
+class GermlineSnapshot
+{
+private:
+
+    //Simulation time and setup
+    double mTime;
+    double mDt;
+    std::string mDirectory;
+    std::vector<double> mParameters;
+    std::vector<double> mFirstReadTimes;
+
+    //Cells, stored as one array per property
+    boost::uint32_t mMaxCellId;
+    std::vector<boost::uint32_t> mCellIds;
+    std::vector<boost::uint32_t> mAncestors;
+    std::vector<double> mX;
+    std::vector<double> mY;
+    std::vector<double> mZ;
+    std::vector<double> mRadii;
+    std::vector<double> mBirthTimes;
+    std::vector<boost::uint8_t> mIsDifferentiated;
+    std::vector<double> mTimesUntilDeath;
+    std::vector<double> mApoptosisTimes;
+    std::vector<boost::uint32_t> mChartStates;
+    boost::uint32_t mNumChartVariables;
+    std::vector<double> mChartVariables;              // <- mNumChartVariables entries per cell
+
+    //Cell data, one column per key. Not every cell has every item, so presence is stored too.
+    std::vector<std::string> mCellDataKeys;
+    std::vector< std::vector<double> > mCellDataValues;
+    std::vector< std::vector<boost::uint8_t> > mCellDataPresent;
+
+    //Leader cell and boundary condition
+    boost::uint8_t mUnc5;
+    boost::uint8_t mVab3;
+    boost::uint8_t mTurnComplete;
+    double mTimeSinceLastUpdate;
+    double mSpacing;
+    std::vector<double> mLeaderCellLocation;
+    std::vector<double> mPathX;
+    std::vector<double> mPathY;
+    std::vector<double> mPathZ;
+    std::vector<boost::int32_t> mPathTypes;
+    double mTubeRadius;
+
+    //Serialized random number generator, and the seed of CellRandomStreams
+    std::string mRandomNumberGeneratorState;
+    boost::uint32_t mCellRandomSeed;
+
+    /**
+    * Creates the cells from their cell cycle models, restoring IDs, types, apoptosis, ancestors and cell data.
+    *
+    * @param rModels one cell cycle model per cell, in population order, already holding the chart state
+    * @param rCells filled with the cells, in population order
+    */
+    void CreateCellsFromModels(const std::vector<AbstractCellCycleModel*>& rModels, std::vector<CellPtr>& rCells) const;
+
+public:
+
+    /**
+    * Constructor. Leaves the snapshot empty.
+    */
+    GermlineSnapshot();
+
+
+    /**
+    * Records the current state of a simulation, along with the global parameters, time and random
+    * number generator.
+    *
+    * @param rCellPopulation the population; every cell must have a statechart cell cycle model
+    * @param rLeaderCell the DTC movement modifier
+    * @param rBoundaryCondition the tube boundary condition
+    * @param rApoptosis the apoptosis killer. Its first use of the death rate (parameters[21]) is recorded
+    * in the global parameters before they are saved.
+    */
+    void Capture(NodeBasedCellPopulation<3>& rCellPopulation,
+                 const DTCMovementModel<3>& rLeaderCell,
+                 const LeaderCellBoundaryCondition<3>& rBoundaryCondition,
+                 const OocyteFatedCellApoptosis<3>& rApoptosis);
+
+
+    /**
+    * Writes the snapshot, replacing any existing file atomically.
+    *
+    * @param filePath full path of the file to write
+    */
+    void WriteToFile(std::string filePath) const;
+
+
+    /**
+    * Reads a snapshot, checking its version and checksum.
+    *
+    * @param filePath full path of the file to read
+    */
+    void ReadFromFile(std::string filePath);
+
+
+    /**
+    * @return whether a file holds a complete snapshot that this version can read
+    *
+    * @param filePath full path of the file to check
+    */
+    static bool IsValidFile(std::string filePath);
+
+
+    /**
+    * Restores the global parameters, simulation time and the seed of CellRandomStreams. Must be called before
+    * creating cells, whose cell cycle models read all three.
+    */
+    void RestoreParametersAndTime() const;
+
+
+    /**
+    * Changes one of the saved parameters, so that a simulation restored from the snapshot carries on with a
+    * new value. Only sensible for a parameter the saved run had not yet used (see
+    * GlobalParameterStruct::GetFirstReadTime), such as the end time.
+    *
+    * @param index the parameter's index
+    * @param value its new value
+    */
+    void SetParameter(unsigned index, double value);
+
+
+    /**
+    * @return the simulation time at which the saved run first used a parameter, or -1 if it had not (or the
+    * snapshot holds no such parameter)
+    *
+    * @param index the parameter's index
+    */
+    double GetParameterFirstReadTime(unsigned index) const;
+
+
+    /**
+    * Restores the random number generator. Call this last, after the cells (whose charts draw random
+    * numbers as they are restored) have been created.
+    */
+    void RestoreRandomNumberGenerator() const;
+
+
+    /**
+    * Creates one node per cell, in population order, with its position and radius. The caller owns the nodes.
+    *
+    * @param rNodes filled with the nodes
+    */
+    void CreateNodes(std::vector<Node<3>*>& rNodes) const;
+
+
+    /**
+    * Creates one cell per node, in population order, with a fresh cell cycle model restored to the saved
+    * chart state.
+    *
+    * @param rModel the statechart model the snapshot was taken with
+    * @param rCells filled with the cells
+    */
+    void CreateCells(const AbstractStatechartModelFactory& rModel, std::vector<CellPtr>& rCells) const;
+
+
+    //Getters for the leader cell and boundary condition state
+    double GetTime() const;
+    unsigned GetNumCells() const;
+    std::vector< c_vector<double, 3> > GetPathPointCollection() const;
+    std::vector< int > GetPathPointTypes() const;
+    c_vector<double, 3> GetLeaderCellLocation() const;
+    double GetSpacing() const;
+    double GetTimeSinceLastUpdate() const;
+    bool GetUnc5() const;
+    bool GetVab3() const;
+    bool GetTurnComplete() const;
+    double GetTubeRadius() const;
+
+};
+
+#endif /*GERMLINESNAPSHOT_HPP_*/
@@ -35,11 +35,25 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "GlobalParameterStruct.hpp"
 #include "Exception.hpp"
+#include "SimulationTime.hpp"
+#include "OutputFileHandler.hpp"
+
+#include <pthread.h>
 
 
 //A pointer to the single parameter struct instance. Initially null.
 GlobalParameterStruct* GlobalParameterStruct::mpInstance = NULL;
 
+//Guards the first read times, as statecharts may read parameters on several threads (see GermlineThreadPool).
+//A read only takes it while the parameter's flag (loaded atomically) says it has no first read time yet.
+static pthread_mutex_t FirstReadMutex = PTHREAD_MUTEX_INITIALIZER;
+
+//Parameters from 39 on are optional, and a config file may stop short of them. Each takes the value the
+//simulation behaves as if given when it is missing (see GermlineSimulation), should it be reset.
+static const int FirstOptionalParameter = 39;
+static const double OptionalParameterDefaults[] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 1.0, 0.0, 1.0, 0.0};
+static const int NumOptionalParameters = sizeof(OptionalParameterDefaults)/sizeof(OptionalParameterDefaults[0]);
+
 
 //For retrieving a pointer to the current GlobalParameterStruct struct 
 GlobalParameterStruct* GlobalParameterStruct::Instance()
@@ -57,6 +71,9 @@ GlobalParameterStruct::GlobalParameterStruct()
 {
     Directory =  std::string();
     Params = std::vector<double>();
+    FirstReadTimes = std::vector<double>();
+    FirstReadFlags = std::vector<char>();
+    ParamTexts = std::vector<std::string>();
     assert(mpInstance == NULL); 
 }
 
@@ -84,13 +101,27 @@ void GlobalParameterStruct::ConfigureFromFile(std::string filename, std::string
     CONFIG.getline(temp, 256);
     Directory = temp;
     //std::cout << Directory << std::endl;
+    Params.clear();
+    FirstReadTimes.clear();
+    FirstReadFlags.clear();
+    ParamTexts.clear();
 
     while (!CONFIG.getline(temp, 256, '\t').eof())
     {
       //Get each param and ftor in Params vector.
-      param = strtod(temp, 0);
+      char* end;
+      param = strtod(temp, &end);
       //std::cout << "Parameter " << Params.size() << " = " << param << std::endl;
       Params.push_back(param);  
+      FirstReadTimes.push_back(-1.0);
+      FirstReadFlags.push_back(0);
+      //Keep the text of a value that isn't a number, e.g. a statechart model's name
+      std::string text;
+      if (end == temp){
+        std::istringstream textStream(temp);
+        textStream >> text;
+      }
+      ParamTexts.push_back(text);
       CONFIG.getline(temp, 256);
     }
     CONFIG.close();
@@ -113,15 +144,73 @@ void GlobalParameterStruct::Destroy()
 }
 
 
-//Retreives a parameter value by index
+//Retreives a parameter value by index, noting the time of the first read
 double GlobalParameterStruct::GetParameter(int index){
   if(index > (int)Params.size()-1){
     EXCEPTION("Parameter has yet to be initialised. Check that ConfigureFromFile was called and that you are using the correct input file.");
   }
+  if(!__atomic_load_n(&FirstReadFlags[index], __ATOMIC_ACQUIRE)){
+    pthread_mutex_lock(&FirstReadMutex);
+    if(FirstReadTimes[index] < 0){
+      FirstReadTimes[index] = SimulationTime::Instance()->IsStartTimeSetUp() ? SimulationTime::Instance()->GetTime() : 0.0;
+    }
+    __atomic_store_n(&FirstReadFlags[index], 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&FirstReadMutex);
+  }
   return Params[index];
 }
 
 
+//Retreives a parameter value by index, without counting it as a read
+double GlobalParameterStruct::PeekParameter(int index){
+  if(index > (int)Params.size()-1){
+    EXCEPTION("Parameter has yet to be initialised. Check that ConfigureFromFile was called and that you are using the correct input file.");
+  }
+  return Params[index];
+}
+
+
+//Retreives the text a parameter was given as, if not a number
+std::string GlobalParameterStruct::GetParameterText(int index){
+  if(index < 0 || index > (int)ParamTexts.size()-1){
+    return std::string();
+  }
+  return ParamTexts[index];
+}
+
+
+//Retreives the time a parameter was first read, -1 if never
+double GlobalParameterStruct::GetFirstReadTime(int index){
+  if(index < 0 || index >= (int)FirstReadTimes.size()){
+    EXCEPTION("There is no parameter " << index << " to get the first read time of.");
+  }
+  pthread_mutex_lock(&FirstReadMutex);
+  double time = FirstReadTimes[index];
+  pthread_mutex_unlock(&FirstReadMutex);
+  return time;
+}
+
+
+//Records a read made on a parameter's behalf, keeping the earliest
+void GlobalParameterStruct::RecordParameterRead(int index, double time){
+  if(index < 0 || index >= (int)FirstReadTimes.size()){
+    EXCEPTION("There is no parameter " << index << " to record a read of.");
+  }
+  pthread_mutex_lock(&FirstReadMutex);
+  if(FirstReadTimes[index] < 0 || time < FirstReadTimes[index]){
+    FirstReadTimes[index] = time;
+  }
+  __atomic_store_n(&FirstReadFlags[index], 1, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&FirstReadMutex);
+}
+
+
+//Number of parameters read in
+unsigned GlobalParameterStruct::GetNumParameters(){
+  return Params.size();
+}
+
+
 //Retreives the results directory name
 std::string GlobalParameterStruct::GetDirectory(){
   return Directory;
@@ -134,8 +223,44 @@ void GlobalParameterStruct::ResetDirectoryName(std::string newName){
 }
 
 
-//Resets a single parameter value. Can be useful in parameter sweeps
+//Resets a single parameter value. Can be useful in parameter sweeps. An optional parameter the config file
+//stopped short of is added, along with any before it, at the values a missing parameter behaves as.
 void GlobalParameterStruct::ResetParameter(int index, double newValue){
+  if(index < 0 || index >= FirstOptionalParameter + NumOptionalParameters){
+    EXCEPTION("There is no parameter " << index << " to reset.");
+  }
+  if(index >= (int)Params.size()){
+    if((int)Params.size() < FirstOptionalParameter){
+      EXCEPTION("Parameter " << index << " can't be reset, as the parameters file stops at parameter "
+                << (int)Params.size()-1 << ", short of the optional parameters.");
+    }
+    while((int)Params.size() <= index){
+      Params.push_back(OptionalParameterDefaults[Params.size() - FirstOptionalParameter]);
+      FirstReadTimes.push_back(-1.0);
+      FirstReadFlags.push_back(0);
+      ParamTexts.push_back(std::string());
+    }
+  }
   Params[index] = newValue;
+  ParamTexts[index] = std::string();
 };
 
+
+//Replaces every parameter value, e.g. with those from a snapshot
+void GlobalParameterStruct::SetAllParameters(const std::vector<double>& rParams){
+  Params = rParams;
+  FirstReadTimes.assign(Params.size(), -1.0);
+  FirstReadFlags.assign(Params.size(), 0);
+  ParamTexts.assign(Params.size(), std::string());
+}
+
+
+//Writes out when each parameter was first read
+void GlobalParameterStruct::WriteFirstReadTimes(std::string outputDirectory){
+  OutputFileHandler handler(outputDirectory, false);
+  out_stream READS = handler.OpenOutputFile("ParameterFirstReads.txt");
+  for (unsigned i = 0; i < FirstReadTimes.size(); i++){
+    *READS << i << "\t" << FirstReadTimes[i] << "\n";
+  }
+  READS->close();
+}
@@ -74,6 +74,26 @@ private:
     */
     std::vector<double> Params;
 
+    /*
+    *  Simulation time at which each parameter was first read with GetParameter, or -1 if it
+    *  has not been read yet. Used to tell which parameters can safely be changed part way
+    *  through a run (see TestElegansGermlineFromCheckpoint). Not archived.
+    */
+    std::vector<double> FirstReadTimes;
+
+    /*
+    *  Whether each parameter has a first read time yet: 1 once it has. Loaded atomically, so that the many reads
+    *  after the first, which may come from several threads at once, need not take a lock. Not archived.
+    */
+    std::vector<char> FirstReadFlags;
+
+    /*
+    *  The text of each parameter given in the config file as something other than a number (e.g. the
+    *  name of a statechart model, see StatechartModelRegistry), or an empty string. Such parameters
+    *  read as 0 until reset. Not archived.
+    */
+    std::vector<std::string> ParamTexts;
+
 
     /** Needed for serialization. */
     friend class boost::serialization::access;
@@ -97,6 +117,9 @@ private:
     {
         archive & Params;
         archive & Directory;
+        FirstReadTimes.assign(Params.size(), -1.0);
+        FirstReadFlags.assign(Params.size(), 0);
+        ParamTexts.assign(Params.size(), std::string());
     }
     BOOST_SERIALIZATION_SPLIT_MEMBER()
 
@@ -131,11 +154,51 @@ public:
     static void Destroy();
 
     /**
-    * @return a particular parameter value by number
+    * @return a particular parameter value by number. Safe to call from several threads at once.
     */
     double GetParameter(int index);
 
 
+    /**
+    * @return a particular parameter value by number, without recording the read. For code
+    * that only reports a value, rather than letting it affect the simulation.
+    */
+    double PeekParameter(int index);
+
+
+    /**
+    * @return the text a parameter was given as in the config file, if it wasn't a number, or an empty
+    * string. Resetting the parameter clears it.
+    */
+    std::string GetParameterText(int index);
+
+
+    /**
+    * @return the simulation time at which a parameter was first read, or -1 if it hasn't been
+    */
+    double GetFirstReadTime(int index);
+
+
+    /**
+    * @record a use of a parameter whose value was handed over earlier (e.g. via a constructor),
+    * at the time it first actually affected the simulation
+    */
+    void RecordParameterRead(int index, double time);
+
+
+    /**
+    * @return the number of parameters
+    */
+    unsigned GetNumParameters();
+
+
+    /**
+    * @write the first read time of every parameter to ParameterFirstReads.txt in the given output
+    * directory. Each line holds a parameter number, a tab, then the time (-1 if never read).
+    */
+    void WriteFirstReadTimes(std::string outputDirectory);
+
+
     /**
     * @get the name of the results directory
     */
@@ -143,7 +206,9 @@ public:
 
 
     /**
-    * @reset a parameter value - occasionaly useful when conducting a parameter sweep
+    * @reset a parameter value - occasionaly useful when conducting a parameter sweep. An optional
+    * parameter (39 on) beyond the end of the config file is added, along with any before it, at the value
+    * a missing parameter behaves as. Any other index beyond the end of the file is an Exception.
     */
     void ResetParameter(int index, double newValue);
 
@@ -153,6 +218,13 @@ public:
     */
     void ResetDirectoryName(std::string newName);
 
+
+    /**
+    * @replace the whole parameter set, e.g. when restoring a saved simulation. First read times are
+    * cleared, and can be restored with RecordParameterRead.
+    */
+    void SetAllParameters(const std::vector<double>& rParams);
+
 };
 
 #endif /*GLOBALPARAMETERSTRUCT_HPP_*/
\ No newline at end of file
@@ -0,0 +1,229 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "BinaryRecordReader.hpp"
+#include "Exception.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+
+
+const char BinaryRecordReader::MAGIC[8] = {'E','G','R','E','C','S','\0','\0'};
+const boost::uint32_t BinaryRecordReader::FORMAT_VERSION;
+const boost::uint32_t BinaryRecordReader::BYTE_ORDER_MARK;
+
+
+//Reads a fixed size value, returning false at the end of the file
+template<typename T>
+static bool ReadValue(FILE* pFile, T& rValue)
+{
+    return std::fread(&rValue, sizeof(T), 1, pFile) == 1;
+}
+
+
+//Constructor, reads the header and counts the complete records that follow it
+BinaryRecordReader::BinaryRecordReader(std::string filePath)
+    : mFilePath(filePath),
+      mDataOffset(0),
+      mNumRecords(0)
+{
+    FILE* p_file = std::fopen(filePath.c_str(), "rb");
+    if (p_file == NULL){
+        EXCEPTION("Could not open record file " << filePath);
+    }
+
+    char magic[8];
+    boost::uint32_t version = 0;
+    boost::uint32_t byteOrder = 0;
+    boost::uint32_t numColumns = 0;
+    bool ok = std::fread(magic, 1, 8, p_file) == 8 && std::memcmp(magic, MAGIC, 8) == 0;
+    ok = ok && ReadValue(p_file, version) && ReadValue(p_file, byteOrder) && ReadValue(p_file, numColumns);
+    if (!ok){
+        std::fclose(p_file);
+        EXCEPTION(filePath << " is not a record file.");
+    }
+    if (version != FORMAT_VERSION){
+        std::fclose(p_file);
+        EXCEPTION("Record file " << filePath << " has format version " << version << ", but only version "
+                  << FORMAT_VERSION << " can be read.");
+    }
+    if (byteOrder != BYTE_ORDER_MARK){
+        std::fclose(p_file);
+        EXCEPTION("Record file " << filePath << " was written on a machine with a different byte order.");
+    }
+
+    for (unsigned i = 0; i < numColumns; i++){
+        boost::uint32_t length = 0;
+        if (!ReadValue(p_file, length) || length > 1024){
+            std::fclose(p_file);
+            EXCEPTION("Record file " << filePath << " has a damaged header.");
+        }
+        std::string name(length, ' ');
+        if (length > 0 && std::fread(&name[0], 1, length, p_file) != length){
+            std::fclose(p_file);
+            EXCEPTION("Record file " << filePath << " has a damaged header.");
+        }
+        mColumnNames.push_back(name);
+    }
+
+    mDataOffset = std::ftell(p_file);
+    std::fseek(p_file, 0, SEEK_END);
+    long fileSize = std::ftell(p_file);
+    std::fclose(p_file);
+
+    long recordSize = sizeof(double)*mColumnNames.size();
+    if (recordSize > 0){
+        mNumRecords = (unsigned)((fileSize - mDataOffset)/recordSize);
+    }
+}
+
+
+//Getters
+const std::vector<std::string>& BinaryRecordReader::rGetColumnNames() const
+{
+    return mColumnNames;
+}
+
+unsigned BinaryRecordReader::GetNumColumns() const
+{
+    return mColumnNames.size();
+}
+
+unsigned BinaryRecordReader::GetNumRecords() const
+{
+    return mNumRecords;
+}
+
+long BinaryRecordReader::GetDataOffset() const
+{
+    return mDataOffset;
+}
+
+
+//Reads all the records in one block
+std::vector<std::vector<double> > BinaryRecordReader::ReadRecords() const
+{
+    unsigned numColumns = mColumnNames.size();
+    std::vector<double> values(mNumRecords*numColumns);
+    if (!values.empty()){
+        FILE* p_file = std::fopen(mFilePath.c_str(), "rb");
+        if (p_file == NULL){
+            EXCEPTION("Could not open record file " << mFilePath);
+        }
+        std::fseek(p_file, mDataOffset, SEEK_SET);
+        size_t numRead = std::fread(&values[0], sizeof(double), values.size(), p_file);
+        std::fclose(p_file);
+        if (numRead != values.size()){
+            EXCEPTION("Record file " << mFilePath << " changed while it was being read.");
+        }
+    }
+
+    std::vector<std::vector<double> > records(mNumRecords);
+    for (unsigned i = 0; i < mNumRecords; i++){
+        records[i].assign(values.begin() + i*numColumns, values.begin() + (i+1)*numColumns);
+    }
+    return records;
+}
+
+
+//Picks one column out of the records
+std::vector<double> BinaryRecordReader::ReadColumn(std::string columnName) const
+{
+    unsigned column = 0;
+    while (column < mColumnNames.size() && mColumnNames[column] != columnName){
+        column++;
+    }
+    if (column == mColumnNames.size()){
+        EXCEPTION("Record file " << mFilePath << " has no column " << columnName);
+    }
+
+    std::vector<std::vector<double> > records = ReadRecords();
+    std::vector<double> values(records.size());
+    for (unsigned i = 0; i < records.size(); i++){
+        values[i] = records[i][column];
+    }
+    return values;
+}
+
+
+//Uses default stream formatting, as the text output does
+void BinaryRecordReader::WriteDelimited(std::string outputPath, std::string delimiter, bool includeHeader) const
+{
+    std::ofstream output(outputPath.c_str());
+    if (!output.is_open()){
+        EXCEPTION("Could not open " << outputPath << " for writing.");
+    }
+    if (includeHeader){
+        for (unsigned j = 0; j < mColumnNames.size(); j++){
+            output << (j > 0 ? delimiter : "") << mColumnNames[j];
+        }
+        output << "\n";
+    }
+    std::vector<std::vector<double> > records = ReadRecords();
+    for (unsigned i = 0; i < records.size(); i++){
+        for (unsigned j = 0; j < records[i].size(); j++){
+            output << (j > 0 ? delimiter : "") << records[i][j];
+        }
+        output << "\n";
+    }
+    output.close();
+    if (output.fail()){
+        EXCEPTION("Failed to write " << outputPath);
+    }
+}
+
+
+//Records are in time order, so cut the file at the first one that is too late
+void BinaryRecordReader::TruncateAfter(std::string filePath, double time)
+{
+    std::ifstream test(filePath.c_str());
+    if (!test.is_open()){
+        return;
+    }
+    test.close();
+
+    BinaryRecordReader reader(filePath);
+    std::vector<std::vector<double> > records = reader.ReadRecords();
+    unsigned numKept = 0;
+    while (numKept < records.size() && !records[numKept].empty() && records[numKept][0] <= time + 1e-6){
+        numKept++;
+    }
+    long keptSize = reader.GetDataOffset() + (long)(sizeof(double)*reader.GetNumColumns()*numKept);
+    if (truncate(filePath.c_str(), keptSize) != 0){
+        EXCEPTION("Failed to trim " << filePath);
+    }
+}
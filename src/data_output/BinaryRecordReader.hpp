@@ -0,0 +1,134 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef BINARYRECORDREADER_HPP_
+#define BINARYRECORDREADER_HPP_
+
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+/*
+* Reads the binary record files written by BinaryRecordWriter (e.g. GonadData.bin).
+*
+* A record file is a header followed by fixed width records:
+*
+* - Header: magic string, format version, byte order check, number of columns, then each column name
+*   as a length and its characters.
+* - Records: one double per column, record after record, with no separators.
+*
+* Because every record is the same size, a file cut short by a crash is still readable: any incomplete
+* record at the end is ignored. The reader works out everything it needs from the header, so it can be
+* used on any record file, whatever its columns.
+*/
+
+class BinaryRecordReader
+{
+private:
+
+    //File being read
+    std::string mFilePath;
+
+    //Column names from the header
+    std::vector<std::string> mColumnNames;
+
+    //Offset of the first record, in bytes
+    long mDataOffset;
+
+    //Number of complete records in the file
+    unsigned mNumRecords;
+
+public:
+
+    //Format constants shared with BinaryRecordWriter
+    static const char MAGIC[8];
+    static const boost::uint32_t FORMAT_VERSION = 1;
+    static const boost::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+
+    /**
+    * Constructor. Reads and checks the file's header, throwing an exception if it is not a record file.
+    *
+    * @param filePath full path of the file
+    */
+    BinaryRecordReader(std::string filePath);
+
+
+    //Getters
+    const std::vector<std::string>& rGetColumnNames() const;
+    unsigned GetNumColumns() const;
+    unsigned GetNumRecords() const;
+    long GetDataOffset() const;
+
+
+    /**
+    * @return every complete record in the file, in the order they were written
+    */
+    std::vector<std::vector<double> > ReadRecords() const;
+
+
+    /**
+    * @return every value of one column, in the order the records were written
+    *
+    * @param columnName the column's name, as given in the header
+    */
+    std::vector<double> ReadColumn(std::string columnName) const;
+
+
+    /**
+    * Writes the records to a delimited text file, one record per line.
+    *
+    * Numbers are formatted exactly as the text data output formats them, so with a tab delimiter and no
+    * header the result is identical to the text file the simulation would otherwise have written.
+    *
+    * @param outputPath full path of the file to write
+    * @param delimiter string written between columns
+    * @param includeHeader whether to write the column names as the first line
+    */
+    void WriteDelimited(std::string outputPath, std::string delimiter, bool includeHeader) const;
+
+
+    /**
+    * Removes the records whose first column (time) is later than a given time, along with any incomplete
+    * record at the end, so that a resumed run can append to the file. Does nothing if the file does not exist.
+    *
+    * @param filePath full path of the file
+    * @param time the latest time to keep
+    */
+    static void TruncateAfter(std::string filePath, double time);
+
+};
+
+#endif /*BINARYRECORDREADER_HPP_*/
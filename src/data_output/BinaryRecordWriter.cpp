@@ -0,0 +1,270 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "BinaryRecordWriter.hpp"
+#include "BinaryRecordReader.hpp"
+#include "Exception.hpp"
+
+#include <boost/cstdint.hpp>
+#include <fstream>
+#include <unistd.h>
+
+
+//Constructor
+BinaryRecordWriter::BinaryRecordWriter(const std::vector<std::string>& rColumnNames, unsigned recordsPerBlock)
+    : mColumnNames(rColumnNames),
+      mRecordsPerBlock(recordsPerBlock > 0 ? recordsPerBlock : 1),
+      mpFile(NULL),
+      mWriting(false),
+      mClosing(false),
+      mWriteFailed(false)
+{
+    if (mColumnNames.empty()){
+        EXCEPTION("A record file needs at least one column.");
+    }
+    pthread_mutex_init(&mMutex, NULL);
+    pthread_cond_init(&mWorkAvailable, NULL);
+    pthread_cond_init(&mWorkDone, NULL);
+}
+
+
+//Destructor. Must not throw, so any write failure at this point is lost.
+BinaryRecordWriter::~BinaryRecordWriter()
+{
+    if (mpFile != NULL){
+        try{
+            Close();
+        }
+        catch (Exception&){
+        }
+    }
+    pthread_cond_destroy(&mWorkDone);
+    pthread_cond_destroy(&mWorkAvailable);
+    pthread_mutex_destroy(&mMutex);
+}
+
+
+//Writes the header for a new file, or checks the header of an existing one before appending
+void BinaryRecordWriter::Open(std::string filePath, bool append)
+{
+    if (mpFile != NULL){
+        EXCEPTION("Record file " << mFilePath << " is already open.");
+    }
+    mFilePath = filePath;
+
+    bool existing = false;
+    if (append){
+        std::ifstream test(filePath.c_str(), std::ios::binary | std::ios::ate);
+        existing = test.is_open() && test.tellg() > 0;
+    }
+
+    if (existing){
+        BinaryRecordReader reader(filePath);
+        if (reader.rGetColumnNames() != mColumnNames){
+            EXCEPTION("Cannot append to " << filePath << ", which has different columns.");
+        }
+        long completeSize = reader.GetDataOffset() + (long)(sizeof(double)*mColumnNames.size()*reader.GetNumRecords());
+        if (truncate(filePath.c_str(), completeSize) != 0){
+            EXCEPTION("Could not remove the incomplete record at the end of " << filePath);
+        }
+        mpFile = std::fopen(filePath.c_str(), "ab");
+        if (mpFile == NULL){
+            EXCEPTION("Could not open " << filePath << " to append records.");
+        }
+    }else{
+        mpFile = std::fopen(filePath.c_str(), "wb");
+        if (mpFile == NULL){
+            EXCEPTION("Could not open " << filePath << " to write records.");
+        }
+        boost::uint32_t version = BinaryRecordReader::FORMAT_VERSION;
+        boost::uint32_t byteOrder = BinaryRecordReader::BYTE_ORDER_MARK;
+        boost::uint32_t numColumns = mColumnNames.size();
+        bool written = std::fwrite(BinaryRecordReader::MAGIC, 1, 8, mpFile) == 8;
+        written = written && std::fwrite(&version, sizeof(version), 1, mpFile) == 1;
+        written = written && std::fwrite(&byteOrder, sizeof(byteOrder), 1, mpFile) == 1;
+        written = written && std::fwrite(&numColumns, sizeof(numColumns), 1, mpFile) == 1;
+        for (unsigned i = 0; i < mColumnNames.size(); i++){
+            boost::uint32_t length = mColumnNames[i].size();
+            written = written && std::fwrite(&length, sizeof(length), 1, mpFile) == 1;
+            written = written && std::fwrite(mColumnNames[i].data(), 1, length, mpFile) == length;
+        }
+        if (!written || std::fflush(mpFile) != 0){
+            std::fclose(mpFile);
+            mpFile = NULL;
+            EXCEPTION("Failed to write the header of " << filePath);
+        }
+    }
+
+    mCurrentBlock.clear();
+    mCurrentBlock.reserve(mRecordsPerBlock*mColumnNames.size());
+    mClosing = false;
+    mWriteFailed = false;
+    if (pthread_create(&mThread, NULL, RunWriterThread, this) != 0){
+        std::fclose(mpFile);
+        mpFile = NULL;
+        EXCEPTION("Could not start the writer thread for " << filePath);
+    }
+}
+
+
+//Copies the record into the current block, handing the block over when full
+void BinaryRecordWriter::Append(const std::vector<double>& rRecord)
+{
+    if (mpFile == NULL){
+        EXCEPTION("No record file is open.");
+    }
+    if (rRecord.size() != mColumnNames.size()){
+        EXCEPTION("Record has " << rRecord.size() << " values, but " << mFilePath << " has "
+                  << mColumnNames.size() << " columns.");
+    }
+    CheckForWriteFailure();
+    mCurrentBlock.insert(mCurrentBlock.end(), rRecord.begin(), rRecord.end());
+    if (mCurrentBlock.size() >= mRecordsPerBlock*mColumnNames.size()){
+        HandOverCurrentBlock();
+    }
+}
+
+
+//Hands over whatever has been gathered and waits for the background thread to finish with it
+void BinaryRecordWriter::Flush()
+{
+    if (mpFile == NULL){
+        return;
+    }
+    HandOverCurrentBlock();
+    pthread_mutex_lock(&mMutex);
+    while (!mPendingBlocks.empty() || mWriting){
+        pthread_cond_wait(&mWorkDone, &mMutex);
+    }
+    pthread_mutex_unlock(&mMutex);
+    CheckForWriteFailure();
+}
+
+
+//Lets the background thread finish the queue, then closes the file
+void BinaryRecordWriter::Close()
+{
+    if (mpFile == NULL){
+        return;
+    }
+    HandOverCurrentBlock();
+    pthread_mutex_lock(&mMutex);
+    mClosing = true;
+    pthread_cond_signal(&mWorkAvailable);
+    pthread_mutex_unlock(&mMutex);
+    pthread_join(mThread, NULL);
+
+    bool closed = std::fclose(mpFile) == 0;
+    mpFile = NULL;
+    if (!closed){
+        mWriteFailed = true;
+    }
+    CheckForWriteFailure();
+}
+
+
+//Whether a file is open
+bool BinaryRecordWriter::IsOpen() const
+{
+    return mpFile != NULL;
+}
+
+
+//Queues the current block. Swapping avoids copying the records.
+void BinaryRecordWriter::HandOverCurrentBlock()
+{
+    if (mCurrentBlock.empty()){
+        return;
+    }
+    pthread_mutex_lock(&mMutex);
+    mPendingBlocks.push_back(std::vector<double>());
+    mPendingBlocks.back().swap(mCurrentBlock);
+    pthread_cond_signal(&mWorkAvailable);
+    pthread_mutex_unlock(&mMutex);
+    mCurrentBlock.reserve(mRecordsPerBlock*mColumnNames.size());
+}
+
+
+//Reports a failure on the background thread once, on the simulation's thread
+void BinaryRecordWriter::CheckForWriteFailure()
+{
+    pthread_mutex_lock(&mMutex);
+    bool failed = mWriteFailed;
+    mWriteFailed = false;
+    pthread_mutex_unlock(&mMutex);
+    if (failed){
+        EXCEPTION("Failed to write records to " << mFilePath);
+    }
+}
+
+
+//Background thread entry point
+void* BinaryRecordWriter::RunWriterThread(void* pWriter)
+{
+    static_cast<BinaryRecordWriter*>(pWriter)->WriteBlocks();
+    return NULL;
+}
+
+
+//Writes queued blocks until told to close and the queue is empty. The lock is not held while writing,
+//so the simulation can keep queueing.
+void BinaryRecordWriter::WriteBlocks()
+{
+    pthread_mutex_lock(&mMutex);
+    while (true){
+        while (mPendingBlocks.empty() && !mClosing){
+            pthread_cond_wait(&mWorkAvailable, &mMutex);
+        }
+        if (mPendingBlocks.empty()){
+            break;
+        }
+        std::vector<double> block;
+        block.swap(mPendingBlocks.front());
+        mPendingBlocks.pop_front();
+        mWriting = true;
+        pthread_mutex_unlock(&mMutex);
+
+        bool written = std::fwrite(&block[0], sizeof(double), block.size(), mpFile) == block.size();
+        written = (std::fflush(mpFile) == 0) && written;
+
+        pthread_mutex_lock(&mMutex);
+        mWriting = false;
+        if (!written){
+            mWriteFailed = true;
+        }
+        pthread_cond_broadcast(&mWorkDone);
+    }
+    pthread_mutex_unlock(&mMutex);
+}
@@ -0,0 +1,152 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef BINARYRECORDWRITER_HPP_
+#define BINARYRECORDWRITER_HPP_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstdio>
+#include <pthread.h>
+
+/*
+* Writes fixed width binary records (one double per column) to a file, in the format read by
+* BinaryRecordReader, without making the simulation wait on the file system.
+*
+* Records are gathered into blocks of mRecordsPerBlock. Each full block is handed to a background thread,
+* which writes it with a single write and flush, so the simulation makes no system calls for output at all,
+* and a shared or network file system sees one write per block rather than one per record. Flush() hands
+* over a partly filled block too, and waits until everything so far is on disk.
+*
+* Errors on the background thread are reported by the next call to Append(), Flush() or Close().
+*/
+
+class BinaryRecordWriter
+{
+private:
+
+    //Column names, written in the header
+    std::vector<std::string> mColumnNames;
+
+    //Number of records gathered before they are handed to the background thread
+    unsigned mRecordsPerBlock;
+
+    //Path and handle of the open file
+    std::string mFilePath;
+    FILE* mpFile;
+
+    //Records not yet handed over
+    std::vector<double> mCurrentBlock;
+
+    //State shared with the background thread, guarded by mMutex
+    std::deque<std::vector<double> > mPendingBlocks;
+    bool mWriting;
+    bool mClosing;
+    bool mWriteFailed;
+
+    //Background thread and its synchronisation
+    pthread_t mThread;
+    pthread_mutex_t mMutex;
+    pthread_cond_t mWorkAvailable;
+    pthread_cond_t mWorkDone;
+
+    //Entry point and loop of the background thread
+    static void* RunWriterThread(void* pWriter);
+    void WriteBlocks();
+
+    //Passes the current block, if it has any records, to the background thread
+    void HandOverCurrentBlock();
+
+    //Throws if the background thread failed to write
+    void CheckForWriteFailure();
+
+    //Not copyable
+    BinaryRecordWriter(const BinaryRecordWriter&);
+    BinaryRecordWriter& operator=(const BinaryRecordWriter&);
+
+public:
+
+    /**
+    * Constructor.
+    *
+    * @param rColumnNames the name of each column
+    * @param recordsPerBlock the number of records written to disk at once
+    */
+    BinaryRecordWriter(const std::vector<std::string>& rColumnNames, unsigned recordsPerBlock = 32);
+
+
+    /**
+    * Destructor. Closes the file if it is still open.
+    */
+    ~BinaryRecordWriter();
+
+
+    /**
+    * Opens a file and starts the background thread.
+    *
+    * @param filePath full path of the file
+    * @param append whether to add to an existing file with the same columns, rather than replace it.
+    * Any incomplete record at the end of the existing file is removed first.
+    */
+    void Open(std::string filePath, bool append);
+
+
+    /**
+    * Adds a record. It reaches the file once its block is full, or on Flush() or Close().
+    *
+    * @param rRecord one value per column
+    */
+    void Append(const std::vector<double>& rRecord);
+
+
+    /**
+    * Writes out all records added so far and waits until they are on disk.
+    */
+    void Flush();
+
+
+    /**
+    * Writes out all records, stops the background thread and closes the file.
+    */
+    void Close();
+
+
+    //Whether a file is open
+    bool IsOpen() const;
+
+};
+
+#endif /*BINARYRECORDWRITER_HPP_*/
@@ -34,7 +34,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "CellTrackingOutput.hpp"
+#include "GermlineProfiler.hpp"
 #include "GlobalParameterStruct.hpp"
+#include <algorithm>
+#include <utility>
 
 
 //Constructor 
@@ -55,8 +58,19 @@ CellTrackingOutput<DIM>::~CellTrackingOutput(){};
 template<unsigned DIM>
 void CellTrackingOutput<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation,
 std::string outputDirectory){
-  OutputFileHandler rOutputFileHandler(outputDirectory, false);
-  OutputFile = rOutputFileHandler.OpenOutputFile("TrackingData.txt");
+  std::string directory = mAppendDirectory.empty() ? outputDirectory : mAppendDirectory;
+  OutputFileHandler rOutputFileHandler(directory, false);
+
+  //Parameters[41]: binary data output (0 = text). Does not affect the simulation itself, so only peeked at.
+  GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+  if (parameters->GetNumParameters() > 41 && parameters->PeekParameter(41) > 0){
+    mpTrajectoryOutput.reset(new TrajectoryWriter());
+    mpTrajectoryOutput->Open(rOutputFileHandler.GetOutputDirectoryFullPath() + "TrackingData.traj", !mAppendDirectory.empty());
+  }else if (mAppendDirectory.empty()){
+    OutputFile = rOutputFileHandler.OpenOutputFile("TrackingData.txt");
+  }else{
+    OutputFile = rOutputFileHandler.OpenOutputFile("TrackingData.txt", std::ios::out | std::ios::app);
+  }
 };
 
 
@@ -76,6 +90,22 @@ int CellTrackingOutput<DIM>::GetCellIdInterval() const
 };
 
 
+//Setter for mAppendDirectory
+template<unsigned DIM>
+void CellTrackingOutput<DIM>::SetAppendDirectory(std::string directory)
+{
+  mAppendDirectory = directory;
+};
+
+
+
+//Orders tracked cells by ID, for the compressed output
+template<unsigned DIM>
+static bool CompareIds(const std::pair<unsigned, c_vector<double, DIM> >& rA, const std::pair<unsigned, c_vector<double, DIM> >& rB)
+{
+  return rA.first < rB.first;
+}
+
 
 /*
 * Actual data recording function. 
@@ -85,10 +115,14 @@ int CellTrackingOutput<DIM>::GetCellIdInterval() const
 template<unsigned DIM>
 void CellTrackingOutput<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
 {
+  ScopedProfileTimer timer(GermlineProfiler::TRACKING_OUTPUT);
   
   //If it's an output timestep
   if (SimulationTime::Instance()->GetTimeStepsElapsed() % GetSamplingInterval() == 0){
 
+    //Tracked cells and their positions, gathered for the compressed output
+    std::vector<std::pair<unsigned, c_vector<double, DIM> > > trackedCells;
+
     //Loop over cells
     for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
     cell_iter != rCellPopulation.End(); ++cell_iter)
@@ -103,18 +137,40 @@ void CellTrackingOutput<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,D
       // simulations. That condition can be removed.  
       if (id % GetCellIdInterval() == 0 && id != 0){
         c_vector<double, DIM> location = node->rGetLocation();
-        *OutputFile << SimulationTime::Instance()->GetTime() << "\t" << id 
-        << "\t" <<  location[0] << "\t" <<  location[1] << "\t" <<  location[2] << "\n";
+        if (mpTrajectoryOutput){
+          trackedCells.push_back(std::make_pair(id, location));
+        }else{
+          *OutputFile << SimulationTime::Instance()->GetTime() << "\t" << id 
+          << "\t" <<  location[0] << "\t" <<  location[1] << "\t" <<  location[2] << "\n";
+        }
       }
     }
-  
-  //Output the data to file immediately, so if the simulation crashes you will have some data saved
-  OutputFile->flush();
+
+    if (mpTrajectoryOutput){
+      //Frames store cells in ID order, with three coordinates each
+      std::sort(trackedCells.begin(), trackedCells.end(), CompareIds<DIM>);
+      std::vector<unsigned> ids(trackedCells.size());
+      std::vector<double> positions(3*trackedCells.size(), 0.0);
+      for (unsigned i = 0; i < trackedCells.size(); i++){
+        ids[i] = trackedCells[i].first;
+        for (unsigned j = 0; j < DIM && j < 3; j++){
+          positions[3*i+j] = trackedCells[i].second[j];
+        }
+      }
+      mpTrajectoryOutput->WriteFrame(SimulationTime::Instance()->GetTime(), ids, positions);
+    }else{
+      //Output the data to file immediately, so if the simulation crashes you will have some data saved
+      OutputFile->flush();
+    }
   }
 
   //If simulation is finished, close the output file.
   if(SimulationTime::Instance()->IsFinished()){
-    OutputFile->close();
+    if (mpTrajectoryOutput){
+      mpTrajectoryOutput->Close();
+    }else{
+      OutputFile->close();
+    }
   }
 }
 
@@ -38,14 +38,19 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "AbstractCellBasedSimulationModifier.hpp"
 #include "OutputFileHandler.hpp"
+#include "TrajectoryWriter.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/string.hpp>
+#include <boost/shared_ptr.hpp>
 
 
 /**
  * A modifier that every (samplingInterval) timesteps saves to a file the position of every (cellIdInterval)-th cell
+ *
+ * Positions go to the text file TrackingData.txt, or if parameter 41 is non-zero, to the compressed trajectory
+ * file TrackingData.traj (see TrajectoryReader), which TestExportTrajectories converts back to text.
  */
 
 template<unsigned DIM>
@@ -63,6 +68,9 @@ private:
 
     //Output file stream
     out_stream OutputFile;
+
+    //Compressed output, used instead of OutputFile if parameter 41 asks for it
+    boost::shared_ptr<TrajectoryWriter> mpTrajectoryOutput;
     
     //Number of timesteps between position measurements
     int mSamplingInterval;
@@ -70,6 +78,9 @@ private:
     //How many cells to track (every idInterval-th cell is followed. E.g. for idInterval=5 every 5th cell is tracked)
     int mCellIdInterval;
 
+    //If set, the directory of an existing output file to add to (e.g. when continuing from a checkpoint)
+    std::string mAppendDirectory;
+
 
 public:
 
@@ -91,6 +102,13 @@ public:
     int GetCellIdInterval() const;
 
 
+    /*
+    * Setter for mAppendDirectory, relative to the Chaste output directory. Data is then appended to the file
+    * in that directory instead of written to a new one in the simulation's results folder. Not archived.
+    */
+    void SetAppendDirectory(std::string directory);
+
+
     /**
      * Overriden SetupSolve method
      * Specifies what to do before the start of the simulation. In this case, open an output file.
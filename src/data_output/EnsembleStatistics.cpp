@@ -0,0 +1,228 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "EnsembleStatistics.hpp"
+#include "BinaryRecordReader.hpp"
+#include "OutputFileHandler.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+
+
+//Constructor
+EnsembleStatistics::EnsembleStatistics(const std::vector<std::string>& rColumnNames)
+    : mColumnNames(rColumnNames),
+      mNumRuns(0)
+{
+    if (mColumnNames.size() < 2){
+        EXCEPTION("Ensemble statistics need a time column and at least one other.");
+    }
+}
+
+
+//Welford update of each column at the record's time
+void EnsembleStatistics::AddRecord(const std::vector<double>& rRecord)
+{
+    if (rRecord.size() != mColumnNames.size()){
+        EXCEPTION("A record has " << rRecord.size() << " columns rather than " << mColumnNames.size() << ".");
+    }
+
+    boost::int64_t key = (boost::int64_t)std::floor(rRecord[0]*1e6 + 0.5);
+    std::map<boost::int64_t, TimePoint>::iterator point = mTimePoints.find(key);
+    if (point == mTimePoints.end()){
+        TimePoint newPoint;
+        newPoint.Time = rRecord[0];
+        newPoint.NumRecords = 0;
+        ColumnStatistics empty;
+        empty.Count = 0;
+        empty.Mean = 0.0;
+        empty.SumOfSquaredDeviations = 0.0;
+        newPoint.Columns.assign(mColumnNames.size() - 1, empty);
+        point = mTimePoints.insert(std::make_pair(key, newPoint)).first;
+    }
+
+    TimePoint& rPoint = point->second;
+    rPoint.NumRecords++;
+    for (unsigned i = 1; i < rRecord.size(); i++){
+        double value = rRecord[i];
+        if (value != value || std::fabs(value) >= 1e300){
+            continue; //Missing
+        }
+        ColumnStatistics& rColumn = rPoint.Columns[i-1];
+        rColumn.Count++;
+        double delta = value - rColumn.Mean;
+        rColumn.Mean += delta/rColumn.Count;
+        rColumn.SumOfSquaredDeviations += delta*(value - rColumn.Mean);
+        rColumn.Values.push_back(value);
+    }
+}
+
+
+//Reads the binary or text data files of each of the run's results folders
+unsigned EnsembleStatistics::AddRun(std::string outputDirectory, std::string baseName)
+{
+    std::string fullPath = OutputFileHandler::GetChasteTestOutputDirectory() + outputDirectory;
+    if (fullPath.empty() || fullPath[fullPath.size()-1] != '/'){
+        fullPath += "/";
+    }
+    DIR* p_dir = opendir(fullPath.c_str());
+    if (p_dir == NULL){
+        EXCEPTION("Could not read directory " << fullPath);
+    }
+    std::vector<std::string> resultsFolders;
+    for (struct dirent* p_entry = readdir(p_dir); p_entry != NULL; p_entry = readdir(p_dir)){
+        std::string name(p_entry->d_name);
+        if (name.compare(0, 18, "results_from_time_") == 0){
+            resultsFolders.push_back(fullPath + name + "/");
+        }
+    }
+    closedir(p_dir);
+
+    unsigned numRecords = 0;
+    for (unsigned i = 0; i < resultsFolders.size(); i++){
+        std::string binaryFile = resultsFolders[i] + baseName + ".bin";
+        std::string textFile = resultsFolders[i] + baseName + ".txt";
+        if (std::ifstream(binaryFile.c_str()).is_open()){
+            BinaryRecordReader reader(binaryFile);
+            std::vector<std::vector<double> > records = reader.ReadRecords();
+            for (unsigned j = 0; j < records.size(); j++){
+                AddRecord(records[j]);
+            }
+            numRecords += records.size();
+        }else{
+            std::ifstream file(textFile.c_str());
+            std::string line;
+            std::vector<double> record(mColumnNames.size());
+            while (std::getline(file, line)){
+                //Lines cut short (e.g. by a crash) are skipped
+                std::istringstream fields(line);
+                unsigned column = 0;
+                while (column < record.size() && fields >> record[column]){
+                    column++;
+                }
+                if (column == record.size()){
+                    AddRecord(record);
+                    numRecords++;
+                }
+            }
+        }
+    }
+    mNumRuns++;
+    return numRecords;
+}
+
+
+//Getters
+unsigned EnsembleStatistics::GetNumRuns() const
+{
+    return mNumRuns;
+}
+
+unsigned EnsembleStatistics::GetNumTimePoints() const
+{
+    return mTimePoints.size();
+}
+
+
+//Linear interpolation between order statistics (R's quantile type 7)
+double EnsembleStatistics::Quantile(const std::vector<double>& rSortedValues, double probability)
+{
+    double position = probability*(rSortedValues.size() - 1);
+    unsigned below = (unsigned)std::floor(position);
+    if (below + 1 >= rSortedValues.size()){
+        return rSortedValues.back();
+    }
+    double fraction = position - below;
+    return rSortedValues[below] + fraction*(rSortedValues[below+1] - rSortedValues[below]);
+}
+
+
+//Header of the summary table
+void EnsembleStatistics::WriteHeader(std::ostream& rFile) const
+{
+    rFile << "Time\tN";
+    for (unsigned i = 1; i < mColumnNames.size(); i++){
+        const std::string& rName = mColumnNames[i];
+        rFile << "\t" << rName << "_Mean\t" << rName << "_SD\t" << rName << "_Q05\t" << rName << "_Median\t" << rName << "_Q95";
+    }
+    rFile << "\n";
+}
+
+
+//One row per time point
+void EnsembleStatistics::WriteRows(std::ostream& rFile, std::string linePrefix) const
+{
+    std::vector<double> sortedValues;
+    for (std::map<boost::int64_t, TimePoint>::const_iterator point = mTimePoints.begin(); point != mTimePoints.end(); ++point){
+        const TimePoint& rPoint = point->second;
+        rFile << linePrefix << rPoint.Time << "\t" << rPoint.NumRecords;
+        for (unsigned i = 0; i < rPoint.Columns.size(); i++){
+            const ColumnStatistics& rColumn = rPoint.Columns[i];
+            if (rColumn.Count == 0){
+                rFile << "\t" << DBL_MAX << "\t0\t" << DBL_MAX << "\t" << DBL_MAX << "\t" << DBL_MAX;
+                continue;
+            }
+            sortedValues = rColumn.Values;
+            std::sort(sortedValues.begin(), sortedValues.end());
+            rFile << "\t" << rColumn.Mean
+                  << "\t" << std::sqrt(rColumn.SumOfSquaredDeviations/rColumn.Count)
+                  << "\t" << Quantile(sortedValues, 0.05)
+                  << "\t" << Quantile(sortedValues, 0.5)
+                  << "\t" << Quantile(sortedValues, 0.95);
+        }
+        rFile << "\n";
+    }
+}
+
+
+//The means, as records
+std::vector<std::vector<double> > EnsembleStatistics::GetMeans() const
+{
+    std::vector<std::vector<double> > means;
+    for (std::map<boost::int64_t, TimePoint>::const_iterator point = mTimePoints.begin(); point != mTimePoints.end(); ++point){
+        const TimePoint& rPoint = point->second;
+        std::vector<double> record(1, rPoint.Time);
+        for (unsigned i = 0; i < rPoint.Columns.size(); i++){
+            record.push_back(rPoint.Columns[i].Count > 0 ? rPoint.Columns[i].Mean : DBL_MAX);
+        }
+        means.push_back(record);
+    }
+    return means;
+}
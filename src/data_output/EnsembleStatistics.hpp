@@ -0,0 +1,150 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ENSEMBLESTATISTICS_HPP_
+#define ENSEMBLESTATISTICS_HPP_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include <boost/cstdint.hpp>
+
+/*
+* Summary statistics, at each sampling time, of a data file (such as GonadData) across replicate runs.
+*
+* Records are added one at a time, each starting with its time, and are matched across runs by time. For each
+* column the mean and standard deviation are kept as running totals (Welford's method), and the values
+* themselves are kept so that exact quantiles can be given; with tens of replicates per run this is cheap.
+* The standard deviation divides by the number of values, as plotGonadData.R always has.
+*
+* Values of 1e300 or more (e.g. the DBL_MAX that GonadData records for the first meiotic cell before there is
+* one) and NaNs mark missing data, and are left out. If a column has no data at a time, its mean and quantiles
+* are given as DBL_MAX and its standard deviation as 0, as a single run would show it.
+*/
+
+class EnsembleStatistics
+{
+private:
+
+    //Running statistics of one column at one time
+    struct ColumnStatistics
+    {
+        unsigned Count;
+        double Mean;
+        double SumOfSquaredDeviations;
+        std::vector<double> Values;
+    };
+
+    //Statistics of every column at one time
+    struct TimePoint
+    {
+        double Time;
+        unsigned NumRecords;
+        std::vector<ColumnStatistics> Columns;
+    };
+
+    //Column names, starting with the time
+    std::vector<std::string> mColumnNames;
+
+    //Time points, keyed by time in millionths of an hour so that times written as text still match
+    std::map<boost::int64_t, TimePoint> mTimePoints;
+
+    //Number of runs added with AddRun()
+    unsigned mNumRuns;
+
+    //Quantile of sorted values, interpolated as by R's default quantile()
+    static double Quantile(const std::vector<double>& rSortedValues, double probability);
+
+public:
+
+    /**
+    * Constructor.
+    *
+    * @param rColumnNames names of the columns of the records, the first being the time
+    */
+    EnsembleStatistics(const std::vector<std::string>& rColumnNames);
+
+
+    /**
+    * Adds one record to the statistics.
+    *
+    * @param rRecord the time followed by the other columns
+    */
+    void AddRecord(const std::vector<double>& rRecord);
+
+
+    /**
+    * Adds every record of a run, read from <baseName>.bin or <baseName>.txt in each of its results folders.
+    *
+    * @param outputDirectory the run's output directory, relative to where Chaste output is stored
+    * @param baseName the data file name without extension, e.g. "GonadData"
+    * @return the number of records added. Runs with no data file add none.
+    */
+    unsigned AddRun(std::string outputDirectory, std::string baseName);
+
+
+    //Number of runs added with AddRun() and number of distinct times seen
+    unsigned GetNumRuns() const;
+    unsigned GetNumTimePoints() const;
+
+
+    /**
+    * Writes the header of a summary table: Time, N (the number of records at that time), then for each
+    * column <name>_Mean, <name>_SD, <name>_Q05, <name>_Median and <name>_Q95, tab delimited.
+    *
+    * @param rFile stream to write to
+    */
+    void WriteHeader(std::ostream& rFile) const;
+
+
+    /**
+    * Writes one row of the summary table per time, in time order.
+    *
+    * @param rFile stream to write to
+    * @param linePrefix text to start every row with, e.g. a design point number and a tab
+    */
+    void WriteRows(std::ostream& rFile, std::string linePrefix = "") const;
+
+
+    /**
+    * @return one record per time, in time order: the time followed by the mean of each column, or DBL_MAX for
+    * a column with no data at that time. For a single run, these are the run's own records.
+    */
+    std::vector<std::vector<double> > GetMeans() const;
+
+};
+
+#endif /*ENSEMBLESTATISTICS_HPP_*/
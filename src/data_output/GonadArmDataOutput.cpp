@@ -34,7 +34,26 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "GonadArmDataOutput.hpp"
+#include "GermlineProfiler.hpp"
 #include "NodeBasedCellPopulation.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <sstream>
+
+//Cell data keys, made once rather than for every lookup
+static const std::string DistanceKey("DistanceAwayFromDTC");
+static const std::string IsDTCKey("IsDTC");
+static const std::string VolumeKey("volume");
+static const std::string PhaseKey("CellCyclePhase");
+static const std::string SpermKey("Differentiation_Sperm");
+static const std::string ArrestedKey("ArrestedFor");
+static const std::string RowKey("RowNumber");
+static const std::string ArmKey("Arm");
+
+//The first meiotic and last mitotic row columns only report rows this close to the DTC, though every row is
+//counted
+static const unsigned NumReportedRows = 128;
 
 
 //Constructor, initialises sampling interval and sets output file to null
@@ -42,7 +61,11 @@ template<unsigned DIM>
 GonadArmDataOutput<DIM>::GonadArmDataOutput(int interval)
     : AbstractCellBasedSimulationModifier<DIM>(),
       OutputFile(NULL),
-      mInterval(interval)
+      mInterval(interval),
+      mArmOnly(false),
+      mArm(0),
+      mSpermCount(0),
+      mTimeArrested(0.0)
 {}
 
 
@@ -59,12 +82,92 @@ int GonadArmDataOutput<DIM>::GetInterval() const
 };
 
 
-//Open an output file GonadData.txt in the simulation directory
+//Getter for mLatestRecord
+template<unsigned DIM>
+const std::vector<double>& GonadArmDataOutput<DIM>::rGetLatestRecord() const
+{
+  return mLatestRecord;
+};
+
+
+//Setter for mAppendDirectory
+template<unsigned DIM>
+void GonadArmDataOutput<DIM>::SetAppendDirectory(std::string directory)
+{
+  mAppendDirectory = directory;
+};
+
+
+//Setter for mpBoundaryCondition
+template<unsigned DIM>
+void GonadArmDataOutput<DIM>::SetBoundaryCondition(boost::shared_ptr<LeaderCellBoundaryCondition<DIM> > pBoundaryCondition)
+{
+  mpBoundaryCondition = pBoundaryCondition;
+};
+
+
+//Restrict to one arm
+template<unsigned DIM>
+void GonadArmDataOutput<DIM>::SetArm(unsigned arm)
+{
+  mArmOnly = true;
+  mArm = arm;
+};
+
+
+//Arm 0, or the only arm, keeps the usual name
+template<unsigned DIM>
+std::string GonadArmDataOutput<DIM>::GetFileBaseName() const
+{
+  if (mArm == 0){
+    return "GonadData";
+  }
+  std::stringstream name;
+  name << "GonadDataArm" << mArm;
+  return name.str();
+};
+
+
+//Names of the GonadData columns, as stored in the header of GonadData.bin
+template<unsigned DIM>
+std::vector<std::string> GonadArmDataOutput<DIM>::GetColumnNames()
+{
+  const char* names[] = {"Time", "GonadLength", "CellCycleDuration", "SpermCount", "ProliferativeCount",
+                         "DeathRate", "TotalCells", "LastProliferativeCell", "FirstMeioticCell", "G1Count",
+                         "SCount", "G2Count", "MCount", "MeioticSCount", "FirstMeioticRow", "LastMitoticRow"};
+  return std::vector<std::string>(names, names + 16);
+}
+
+
+//Open an output file GonadData.txt (or GonadData.bin, or those of another arm) in the simulation directory
 template<unsigned DIM>
 void GonadArmDataOutput<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
 {
-  OutputFileHandler rOutputFileHandler(outputDirectory, false);
-  OutputFile = rOutputFileHandler.OpenOutputFile("GonadData.txt");
+  std::string directory = mAppendDirectory.empty() ? outputDirectory : mAppendDirectory;
+  OutputFileHandler rOutputFileHandler(directory, false);
+
+  //Parameters[41]: binary data output (0 = text). Does not affect the simulation itself, so only peeked at.
+  GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+  if (parameters->GetNumParameters() > 41 && parameters->PeekParameter(41) > 0){
+    mpBinaryOutput.reset(new BinaryRecordWriter(GetColumnNames()));
+    mpBinaryOutput->Open(rOutputFileHandler.GetOutputDirectoryFullPath() + GetFileBaseName() + ".bin", !mAppendDirectory.empty());
+  }else if (mAppendDirectory.empty()){
+    OutputFile = rOutputFileHandler.OpenOutputFile(GetFileBaseName() + ".txt");
+  }else{
+    OutputFile = rOutputFileHandler.OpenOutputFile(GetFileBaseName() + ".txt", std::ios::out | std::ios::app);
+  }
+}
+
+
+//Hand any buffered records to disk
+template<unsigned DIM>
+void GonadArmDataOutput<DIM>::FlushOutput()
+{
+  if (mpBinaryOutput){
+    mpBinaryOutput->Flush();
+  }else if (OutputFile){
+    OutputFile->flush();
+  }
 }
 
 
@@ -73,73 +176,67 @@ void GonadArmDataOutput<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellP
 template<unsigned DIM>
 void GonadArmDataOutput<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
 {
+  ScopedProfileTimer timer(GermlineProfiler::DATA_OUTPUT);
 
   //If it's a sampling time, start gathering some useful data
   if(SimulationTime::Instance()->GetTimeStepsElapsed() % GetInterval() ==0){
 
-
-    //Estimates the length in microns of one cell row, based on the cell separations in the first
-    //75 microns of the distal zone:
-    int    numberOfMeasurements = 0;
-    double meanSeparation = 0;
-    //loop over cells
-    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
-    cell_iter != rCellPopulation.End();++cell_iter)
-    { //consider distal arm germ cells only
-      if(cell_iter->GetCellData()->GetItem("DistanceAwayFromDTC")<75.0 &&
-         cell_iter->GetCellData()->GetItem("IsDTC")==0.0)
+    //Gather the cells counted, with their distances from the DTC: the boundary condition's, if it worked them
+    //out for this population, i.e. during this timestep (SimulationTime has been incremented since). Its cells
+    //are only this arm's in a gonad with more than one arm, so they need not be picked out.
+    mCellData.clear();
+    mDistances.clear();
+    mPhases.clear();
+    mVolumes.clear();
+    mSpermCount = 0;
+    mTimeArrested = 0.0;
+    if (mpBoundaryCondition &&
+        mpBoundaryCondition->GetTimeStepOfDistances() + 1 == SimulationTime::Instance()->GetTimeStepsElapsed() &&
+        !mpBoundaryCondition->rGetDistancesFromDTC().empty()){
+      const std::vector<CellPtr>& r_cells = mpBoundaryCondition->rGetCells();
+      const std::vector<double>& r_distances = mpBoundaryCondition->rGetDistancesFromDTC();
+      for (unsigned i = 0; i < r_cells.size(); i++){
+        GatherCell(r_cells[i]->GetCellData().get(), r_distances[i]);
+      }
+    }else{
+      for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+      cell_iter != rCellPopulation.End();++cell_iter)
       {
-        //Get cell's compressed volume
-        double vol = cell_iter->GetCellData()->GetItem("volume");
-        //Work out effective diameter and add to meanSeparation running total
-        double diam = 2*pow(vol*0.239,0.3333);
-        meanSeparation += diam;
-        numberOfMeasurements++;
+        CellData* p_data = cell_iter->GetCellData().get();
+        if (mArmOnly && p_data->GetItem(ArmKey) != (double)mArm){
+          continue;
+        }
+        GatherCell(p_data, p_data->GetItem(DistanceKey));
       }
     }
-    meanSeparation = meanSeparation/numberOfMeasurements;
-
 
-    //Initialize variables to store the data we'll generate while looping over all cells
+    //Initialize variables to store the data we'll generate from the gathered cells
     double cellCycleDuration = (rCellPopulation.Begin())->GetCellCycleModel()->GetSDuration()
                               +(rCellPopulation.Begin())->GetCellCycleModel()->GetG2Duration()
                               +(rCellPopulation.Begin())->GetCellCycleModel()->GetTransitCellG1Duration()
                               +(rCellPopulation.Begin())->GetCellCycleModel()->GetMDuration();
+    int    numberOfMeasurements = 0;
+    double meanSeparation = 0;
     double gonadLength = 0;
     double lastProliferativeCell = 0;
     double firstMeioticCell = DBL_MAX;
-    int totalCells = 0;
-    int spermCount = 0;
+    int totalCells = mCellData.size();
     int prolifCount = 0;
     int G1count = 0;
     int Scount = 0;
     int G2count = 0;
     int Mcount = 0;
     int MeioticS = 0;
-    double TimeArrested = 0;
-    double meioticCountArray[128] = {0}; // <- These arrays store info on whether there is
-    double mitoticCountArray[128] = {0}; // a prolif cell / 2 meiotic cells in each row for 
-                                         // the first 128 rows.
-
-    //Loop over cells
-    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
-    cell_iter != rCellPopulation.End();++cell_iter)
-    {
-
-      //Work out a cell's row (counting from the DTC), based on the mean compressed cell diameter
-      double dist = cell_iter->GetCellData()->GetItem("DistanceAwayFromDTC");
-      double row = round(dist / meanSeparation);
-      cell_iter->GetCellData()->SetItem("RowNumber",row);
-      double phase = cell_iter->GetCellData()->GetItem("CellCyclePhase");
-      //For the first 128 rows:
-      if(row < 128.0){
-       if(phase < 0){
-        //If cell is in meiosis, record the fact in meioticCountArray
-        meioticCountArray[(int)row] = meioticCountArray[(int)row] + 1;
-       }else{
-        //otherwise record a proliferative cell in mitoticCountArray
-        mitoticCountArray[(int)row] = mitoticCountArray[(int)row] + 1;
-       }
+
+    for (unsigned i = 0; i < mCellData.size(); i++){
+      double dist = mDistances[i];
+      double phase = mPhases[i];
+
+      //For distal arm germ cells in the first 75 microns, add the effective diameter of the cell's compressed
+      //volume to the running total used to estimate the length in microns of one cell row
+      if(mVolumes[i] >= 0.0){
+        meanSeparation += 2*cbrt(mVolumes[i]*0.239);
+        numberOfMeasurements++;
       }
 
       //Establish the gonad length
@@ -147,11 +244,6 @@ void GonadArmDataOutput<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,D
         gonadLength = dist;
       }
 
-      //Count sperm 
-      if(cell_iter->GetCellData()->GetItem("Differentiation_Sperm") == 1.0){
-        spermCount++;
-      }
-
       //count proliferative cells and calculate the positions of the closes meiotic cell to the
       //DTC and furthest mitotic cell from DTC
       if(phase > 0.0){
@@ -165,76 +257,132 @@ void GonadArmDataOutput<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,D
         }
       }
 
-      //Count number of cells in each phase, and track how long cells are spending in arrest
+      //Count number of cells in each phase
       if(phase == 1.0){
         G1count++;
-         TimeArrested += cell_iter->GetCellData()->GetItem("ArrestedFor");
       }else if(phase == 2.0){
         Scount++;
-        TimeArrested += cell_iter->GetCellData()->GetItem("ArrestedFor");
       }else if(phase == 3.0){
         G2count++;
-          TimeArrested += cell_iter->GetCellData()->GetItem("ArrestedFor");
       }else if(phase == 4.0){
         Mcount++;
-        TimeArrested += cell_iter->GetCellData()->GetItem("ArrestedFor");
       }else if(phase == 2.5){
         MeioticS++;
       }
+    }
+    meanSeparation = meanSeparation/numberOfMeasurements;
 
-      //Count total cells
-      totalCells++;
+    //Work out each cell's row (counting from the DTC), based on the mean compressed cell diameter, and
+    //count the meiotic and proliferative cells in each row, as far as the furthest cell's row
+    double lastRow = round(gonadLength / meanSeparation);
+    unsigned numRows = (lastRow >= 0.0 && lastRow < (double)UINT_MAX) ? (unsigned)lastRow + 1 : 0;
+    mMeioticRowCounts.assign(numRows, 0u);
+    mMitoticRowCounts.assign(numRows, 0u);
+    for (unsigned i = 0; i < mCellData.size(); i++){
+      double row = round(mDistances[i] / meanSeparation);
+      mCellData[i]->SetItem(RowKey, row);
+      if (!(row >= 0.0 && row < (double)numRows)){
+        continue; //No distal cells to measure rows by
+      }
+      unsigned rowIndex = (unsigned)row;
+      if(mPhases[i] < 0){
+        mMeioticRowCounts[rowIndex]++;
+      }else{
+        mMitoticRowCounts[rowIndex]++;
+      }
     }
 
-    //Loop through our stored info on the cells each row contains. Work out which is
-    //the first meiotic row (with 2 meiotic cells) and which is the last mitotic row
-    //(1 proliferative cell)
-    int firstMeioticRow = 128;
+    //Work out which is the first meiotic row (with 2 meiotic cells) and which is the last mitotic row
+    //(1 proliferative cell). The columns report rows up to NumReportedRows, as they always have: with no
+    //meiotic row before it, NumReportedRows is recorded.
+    int firstMeioticRow = NumReportedRows;
     int lastMitoticRow = 0;
-    for(int i=0; i<128; i++){
-      if(meioticCountArray[i] > 1 && i < firstMeioticRow){
+    unsigned numReported = std::min(numRows, NumReportedRows);
+    for(unsigned i=0; i<numReported; i++){
+      if(mMeioticRowCounts[i] > 1){
         firstMeioticRow = i;
+        break;
       }
-      if(mitoticCountArray[i] > 0 && i > lastMitoticRow){
-        lastMitoticRow = i;
+    }
+    for(unsigned i=numReported; i>0; i--){
+      if(mMitoticRowCounts[i-1] > 0){
+        lastMitoticRow = i-1;
+        break;
       }
     }
 
     //Get the cell death rate parameter, just for reference really. TODO: replace with
     //a count of the actual number of apoptotic cells? Would be more informative.
-    double deathRate = GlobalParameterStruct::Instance()->GetParameter(21);
+    double deathRate = GlobalParameterStruct::Instance()->PeekParameter(21);
     
     //Add mean time spent in arrest to the programmed in cell cycle duration
-    cellCycleDuration += (TimeArrested) / (Mcount + Scount + G2count + G1count);
+    cellCycleDuration += (mTimeArrested) / (Mcount + Scount + G2count + G1count);
 
-    //Write data
-    *OutputFile << SimulationTime::Instance()->GetTime() << "\t" 
-                << gonadLength << "\t" 
-                << cellCycleDuration << "\t" 
-                << spermCount << "\t" 
-                << prolifCount << "\t" 
-                << deathRate << "\t" 
-                << totalCells << "\t" 
-                << lastProliferativeCell << "\t" 
-                << firstMeioticCell << "\t" 
-                << G1count << "\t" 
-                << Scount << "\t" 
-                << G2count << "\t" 
-                << Mcount << "\t" 
-                << MeioticS << "\t" 
-                << firstMeioticRow << "\t" 
-                << lastMitoticRow  << "\n";
-    
-    //Flush the output file to record data as soon as possible
-    OutputFile->flush();
+    //Keep the record for anything monitoring the run as it goes
+    double record[16] = {SimulationTime::Instance()->GetTime(), gonadLength, cellCycleDuration,
+                         (double)mSpermCount, (double)prolifCount, deathRate, (double)totalCells,
+                         lastProliferativeCell, firstMeioticCell, (double)G1count, (double)Scount,
+                         (double)G2count, (double)Mcount, (double)MeioticS, (double)firstMeioticRow,
+                         (double)lastMitoticRow};
+    mLatestRecord.assign(record, record + 16);
 
-    //Output time for reference
-    std::cout << "Time = " << SimulationTime::Instance()->GetTime() << std::endl;
+    //Write data
+    if (mpBinaryOutput){
+      //Queue a binary record; the writer thread puts it on disk
+      mpBinaryOutput->Append(mLatestRecord);
+    }else{
+      *OutputFile << SimulationTime::Instance()->GetTime() << "\t" 
+                  << gonadLength << "\t" 
+                  << cellCycleDuration << "\t" 
+                  << mSpermCount << "\t" 
+                  << prolifCount << "\t" 
+                  << deathRate << "\t" 
+                  << totalCells << "\t" 
+                  << lastProliferativeCell << "\t" 
+                  << firstMeioticCell << "\t" 
+                  << G1count << "\t" 
+                  << Scount << "\t" 
+                  << G2count << "\t" 
+                  << Mcount << "\t" 
+                  << MeioticS << "\t" 
+                  << firstMeioticRow << "\t" 
+                  << lastMitoticRow  << "\n";
+
+      //Flush the output file to record data as soon as possible
+      OutputFile->flush();
+    }
   }
 
   //If the simulation is finished, close the output file.
   if(SimulationTime::Instance()->IsFinished()){
-    OutputFile->close();
+    if (mpBinaryOutput){
+      mpBinaryOutput->Close();
+    }else{
+      OutputFile->close();
+    }
+  }
+}
+
+
+//Reads what the statistics need from one cell's data, each item at most once, into the typed per-cell arrays
+template<unsigned DIM>
+void GonadArmDataOutput<DIM>::GatherCell(CellData* pData, double distance)
+{
+  double phase = pData->GetItem(PhaseKey);
+  mCellData.push_back(pData);
+  mDistances.push_back(distance);
+  mPhases.push_back(phase);
+
+  //Only distal germ cells in the first 75 microns are measured for the row length, so no other cell's volume is read
+  bool measured = distance < 75.0 && pData->GetItem(IsDTCKey) == 0.0;
+  mVolumes.push_back(measured ? pData->GetItem(VolumeKey) : -1.0);
+
+  //Count sperm, and track how long cycling cells are spending in arrest
+  if (pData->GetItem(SpermKey) == 1.0){
+    mSpermCount++;
+  }
+  if (phase == 1.0 || phase == 2.0 || phase == 3.0 || phase == 4.0){
+    mTimeArrested += pData->GetItem(ArrestedKey);
   }
 }
 
@@ -244,6 +392,9 @@ template<unsigned DIM>
 void GonadArmDataOutput<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
 {
   *rParamsFile << "\t\t\t<SampleDataEveryXTimesteps>" << mInterval << "</SampleDataEveryXTimesteps>\n";
+  if (mArmOnly){
+    *rParamsFile << "\t\t\t<Arm>" << mArm << "</Arm>\n";
+  }
   // Call method on direct parent class
   AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile); 
 }
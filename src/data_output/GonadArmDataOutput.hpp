@@ -39,14 +39,30 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "AbstractCellBasedSimulationModifier.hpp"
 #include "OutputFileHandler.hpp"
 #include "GlobalParameterStruct.hpp"
+#include "BinaryRecordWriter.hpp"
+#include "LeaderCellBoundaryCondition.hpp"
+#include "CellData.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/string.hpp>
+#include <boost/shared_ptr.hpp>
 
 /**
  * A modifier class that every mInterval simulation timesteps, saves to a file some
  * C. elegans germline properties. Obviously only relevant for doing C. elegans germ line simulations
+ *
+ * By default the data go to the tab delimited text file GonadData.txt. If parameter 41 is non-zero they
+ * instead go to GonadData.bin, as binary records written on a background thread (see BinaryRecordWriter),
+ * which can be converted back to GonadData.txt with TestExportGonadData.
+ *
+ * Each cell's data is read once per sample, into typed per-cell arrays that the statistics are then worked
+ * out from, so that sampling every timestep stays cheap. The cells and their distances from the DTC are taken
+ * from the boundary condition when it gathered them this timestep (see SetBoundaryCondition). Rows are counted
+ * as far along the gonad as cells reach, though the row columns only report the first 128.
+ *
+ * In a gonad with more than one arm, each arm has its own output (see SetArm): arm 0's data go to GonadData,
+ * and arm 1's to GonadDataArm1, with the same columns.
  */
 template<unsigned DIM>
 class GonadArmDataOutput : public AbstractCellBasedSimulationModifier<DIM,DIM>
@@ -63,14 +79,47 @@ private:
     
         SerializableSingleton<GlobalParameterStruct>* p_params_wrapper = GlobalParameterStruct::Instance()->GetSerializationWrapper();
         archive & p_params_wrapper;
+        archive & mArmOnly;
+        archive & mArm;
     }
 
     //Output file stream
     out_stream OutputFile;
+
+    //Binary output, used instead of OutputFile if parameter 41 asks for it
+    boost::shared_ptr<BinaryRecordWriter> mpBinaryOutput;
     
     //Number of timesteps between data recordings
     int mInterval;
 
+    //If set, the directory of an existing output file to add to (e.g. when continuing from a checkpoint)
+    std::string mAppendDirectory;
+
+    //If set, the boundary condition whose distances from the DTC are reused instead of looked up
+    boost::shared_ptr<LeaderCellBoundaryCondition<DIM> > mpBoundaryCondition;
+
+    //Whether only the cells of one arm are counted, and which arm (their "Arm" cell data)
+    bool mArmOnly;
+    unsigned mArm;
+
+    //Working space, kept between samples so sampling does not allocate: each gathered cell's data, distance
+    //from the DTC, phase and volume (-1 if not measured), the number of meiotic and proliferative cells in
+    //each row, and the sperm count and total time in arrest of the gathered cells
+    std::vector<CellData*> mCellData;
+    std::vector<double> mDistances;
+    std::vector<double> mPhases;
+    std::vector<double> mVolumes;
+    std::vector<unsigned> mMeioticRowCounts;
+    std::vector<unsigned> mMitoticRowCounts;
+    unsigned mSpermCount;
+    double mTimeArrested;
+
+    //Adds a cell to the working space, reading its cell data
+    void GatherCell(CellData* pData, double distance);
+
+    //The columns of the last row recorded, empty until the first sample
+    std::vector<double> mLatestRecord;
+
 public:
 
 
@@ -86,6 +135,30 @@ public:
     int GetInterval() const;
 
 
+    //The last row of data recorded, one value per column (see GetColumnNames), so that the run can be
+    //monitored as it goes. Empty until the first sample.
+    const std::vector<double>& rGetLatestRecord() const;
+
+
+    //Setter for mAppendDirectory, relative to the Chaste output directory. Data is then appended to the file
+    //in that directory instead of written to a new one in the simulation's results folder. Not archived.
+    void SetAppendDirectory(std::string directory);
+
+
+    //Reuse the cells a boundary condition has already gathered this timestep, and their distances from the
+    //DTC, rather than go over the population and read the distances from each cell's data. Not archived.
+    void SetBoundaryCondition(boost::shared_ptr<LeaderCellBoundaryCondition<DIM> > pBoundaryCondition);
+
+
+    //Only count the cells of one arm of the gonad, for gonads with more than one arm. The boundary condition
+    //set must then be that arm's.
+    void SetArm(unsigned arm);
+
+
+    //Name of the output file, without its .txt or .bin extension
+    std::string GetFileBaseName() const;
+
+
     /**
      * Overriden UpdateAtEndOfTimeStep method
      * Specifies what to do in the simulation at the end of each timestep, in this case record data
@@ -108,6 +181,19 @@ public:
 
 
 
+    /**
+     * Makes sure all data recorded so far is in the output file, e.g. before taking a checkpoint.
+     */
+     void FlushOutput();
+
+
+    /**
+     * @return the names of the columns of GonadData, in order
+     */
+     static std::vector<std::string> GetColumnNames();
+
+
+
      //Output any parameters associated with this class
      void OutputSimulationModifierParameters(out_stream& rParamsFile);
 
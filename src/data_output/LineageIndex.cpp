@@ -0,0 +1,335 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "LineageIndex.hpp"
+#include "BinaryRecordReader.hpp"
+#include "BinaryRecordWriter.hpp"
+#include "OutputFileHandler.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <deque>
+#include <dirent.h>
+#include <sys/stat.h>
+
+
+//One division, for sorting
+struct LineageDivision
+{
+    unsigned parent;
+    unsigned daughter;
+    double time;
+    unsigned founder;
+};
+
+
+//Orders divisions by parent, then time, then daughter
+static bool CompareDivisions(const LineageDivision& rA, const LineageDivision& rB)
+{
+    if (rA.parent != rB.parent){
+        return rA.parent < rB.parent;
+    }
+    if (rA.time != rB.time){
+        return rA.time < rB.time;
+    }
+    return rA.daughter < rB.daughter;
+}
+
+
+//Modification time of a file, or 0 if it does not exist
+static time_t GetModificationTime(const std::string& rFilePath)
+{
+    struct stat fileStatus;
+    if (stat(rFilePath.c_str(), &fileStatus) != 0){
+        return 0;
+    }
+    return fileStatus.st_mtime;
+}
+
+
+//Column names of the index file
+std::vector<std::string> LineageIndex::GetColumnNames()
+{
+    const char* names[] = {"ParentId", "DaughterId", "Time", "Founder"};
+    return std::vector<std::string>(names, names + 4);
+}
+
+
+//Reads the time, parent and daughter columns of each log
+void LineageIndex::BuildFromLogs(const std::vector<std::string>& rLogFiles)
+{
+    mParents.clear();
+    mDaughters.clear();
+    mTimes.clear();
+    mFounders.clear();
+
+    for (unsigned i = 0; i < rLogFiles.size(); i++){
+        const std::string& rFile = rLogFiles[i];
+        if (rFile.size() > 4 && rFile.compare(rFile.size()-4, 4, ".bin") == 0){
+            BinaryRecordReader reader(rFile);
+            std::vector<double> times = reader.ReadColumn("Time");
+            std::vector<double> parents = reader.ReadColumn("ParentId");
+            std::vector<double> daughters = reader.ReadColumn("DaughterId");
+            for (unsigned j = 0; j < times.size(); j++){
+                mTimes.push_back(times[j]);
+                mParents.push_back((unsigned)parents[j]);
+                mDaughters.push_back((unsigned)daughters[j]);
+            }
+        }else{
+            std::ifstream log(rFile.c_str());
+            if (!log.is_open()){
+                EXCEPTION("Could not open division log " << rFile);
+            }
+            //Time, ParentId and DaughterId are the first three columns. A line cut short by a crash is skipped.
+            std::string line;
+            while (std::getline(log, line)){
+                std::istringstream fields(line);
+                double time, parent, daughter;
+                if (fields >> time >> parent >> daughter){
+                    mTimes.push_back(time);
+                    mParents.push_back((unsigned)parent);
+                    mDaughters.push_back((unsigned)daughter);
+                }
+            }
+        }
+    }
+
+    Finalise();
+}
+
+
+//Sorts the divisions, then follows each daughter's parents back to one that was never born in the simulation
+void LineageIndex::Finalise()
+{
+    std::vector<LineageDivision> divisions(mParents.size());
+    std::map<unsigned, unsigned> parentOf;
+    for (unsigned i = 0; i < divisions.size(); i++){
+        divisions[i].parent = mParents[i];
+        divisions[i].daughter = mDaughters[i];
+        divisions[i].time = mTimes[i];
+        parentOf[mDaughters[i]] = mParents[i];
+    }
+    std::sort(divisions.begin(), divisions.end(), CompareDivisions);
+
+    std::map<unsigned, unsigned> founderOf;
+    for (unsigned i = 0; i < divisions.size(); i++){
+        //Walk up until reaching a founder, or a cell whose founder is already known
+        std::vector<unsigned> path(1, divisions[i].daughter);
+        unsigned founder = divisions[i].parent;
+        while (true){
+            std::map<unsigned, unsigned>::const_iterator known = founderOf.find(founder);
+            if (known != founderOf.end()){
+                founder = known->second;
+                break;
+            }
+            std::map<unsigned, unsigned>::const_iterator parent = parentOf.find(founder);
+            if (parent == parentOf.end() || path.size() > parentOf.size()){
+                break;
+            }
+            path.push_back(founder);
+            founder = parent->second;
+        }
+        for (unsigned j = 0; j < path.size(); j++){
+            founderOf[path[j]] = founder;
+        }
+        divisions[i].founder = founder;
+    }
+
+    mParents.resize(divisions.size());
+    mDaughters.resize(divisions.size());
+    mTimes.resize(divisions.size());
+    mFounders.resize(divisions.size());
+    for (unsigned i = 0; i < divisions.size(); i++){
+        mParents[i] = divisions[i].parent;
+        mDaughters[i] = divisions[i].daughter;
+        mTimes[i] = divisions[i].time;
+        mFounders[i] = divisions[i].founder;
+    }
+}
+
+
+//Saves the index as binary records
+void LineageIndex::Save(std::string filePath) const
+{
+    BinaryRecordWriter writer(GetColumnNames(), 1024);
+    writer.Open(filePath, false);
+    std::vector<double> record(4);
+    for (unsigned i = 0; i < mParents.size(); i++){
+        record[0] = mParents[i];
+        record[1] = mDaughters[i];
+        record[2] = mTimes[i];
+        record[3] = mFounders[i];
+        writer.Append(record);
+    }
+    writer.Close();
+}
+
+
+//Loads a saved index, which is already sorted
+void LineageIndex::Load(std::string filePath)
+{
+    BinaryRecordReader reader(filePath);
+    if (reader.rGetColumnNames() != GetColumnNames()){
+        EXCEPTION(filePath << " is not a lineage index.");
+    }
+    std::vector<std::vector<double> > records = reader.ReadRecords();
+    mParents.resize(records.size());
+    mDaughters.resize(records.size());
+    mTimes.resize(records.size());
+    mFounders.resize(records.size());
+    for (unsigned i = 0; i < records.size(); i++){
+        mParents[i] = (unsigned)records[i][0];
+        mDaughters[i] = (unsigned)records[i][1];
+        mTimes[i] = records[i][2];
+        mFounders[i] = (unsigned)records[i][3];
+    }
+}
+
+
+//Finds the run's division logs, and rebuilds the index if any is newer than it
+void LineageIndex::LoadOrBuild(std::string outputDirectory)
+{
+    std::string fullPath = OutputFileHandler::GetChasteTestOutputDirectory() + outputDirectory;
+    if (fullPath.empty() || fullPath[fullPath.size()-1] != '/'){
+        fullPath += "/";
+    }
+
+    std::vector<std::string> logFiles;
+    DIR* p_dir = opendir(fullPath.c_str());
+    if (p_dir == NULL){
+        EXCEPTION("Could not read directory " << fullPath);
+    }
+    for (struct dirent* p_entry = readdir(p_dir); p_entry != NULL; p_entry = readdir(p_dir)){
+        std::string name(p_entry->d_name);
+        if (name.compare(0, 18, "results_from_time_") != 0){
+            continue;
+        }
+        const char* logNames[] = {"/DivisionData.bin", "/DivisionData.txt"};
+        for (unsigned i = 0; i < 2; i++){
+            std::string logFile = fullPath + name + logNames[i];
+            if (GetModificationTime(logFile) > 0){
+                logFiles.push_back(logFile);
+            }
+        }
+    }
+    closedir(p_dir);
+    if (logFiles.empty()){
+        EXCEPTION("No division logs found in " << fullPath);
+    }
+
+    std::string indexFile = fullPath + "LineageIndex.bin";
+    time_t indexTime = GetModificationTime(indexFile);
+    bool upToDate = indexTime > 0;
+    for (unsigned i = 0; i < logFiles.size() && upToDate; i++){
+        upToDate = GetModificationTime(logFiles[i]) < indexTime;
+    }
+
+    if (upToDate){
+        try{
+            Load(indexFile);
+            return;
+        }
+        catch (Exception&){
+            //Damaged index, so rebuild it
+        }
+    }
+    BuildFromLogs(logFiles);
+    Save(indexFile);
+}
+
+
+//Number of divisions in the index
+unsigned LineageIndex::GetNumDivisions() const
+{
+    return mParents.size();
+}
+
+
+//The daughters of a cell are consecutive, in order of birth
+std::vector<unsigned> LineageIndex::GetDaughters(unsigned cellId) const
+{
+    std::pair<std::vector<unsigned>::const_iterator, std::vector<unsigned>::const_iterator> range =
+        std::equal_range(mParents.begin(), mParents.end(), cellId);
+    unsigned first = range.first - mParents.begin();
+    unsigned last = range.second - mParents.begin();
+    return std::vector<unsigned>(mDaughters.begin() + first, mDaughters.begin() + last);
+}
+
+
+//Breadth first search down the tree. A cell is always born after its parent, so the search stops at endTime.
+void LineageIndex::GetDescendants(unsigned cellId, double startTime, double endTime, std::vector<unsigned>& rDescendants,
+                                  std::vector<unsigned>& rParents, std::vector<double>& rBirthTimes) const
+{
+    rDescendants.clear();
+    rParents.clear();
+    rBirthTimes.clear();
+
+    std::deque<unsigned> toSearch(1, cellId);
+    while (!toSearch.empty()){
+        unsigned parent = toSearch.front();
+        toSearch.pop_front();
+        std::pair<std::vector<unsigned>::const_iterator, std::vector<unsigned>::const_iterator> range =
+            std::equal_range(mParents.begin(), mParents.end(), parent);
+        for (unsigned i = range.first - mParents.begin(); i < (unsigned)(range.second - mParents.begin()); i++){
+            if (mTimes[i] > endTime){
+                break;
+            }
+            toSearch.push_back(mDaughters[i]);
+            if (mTimes[i] >= startTime){
+                rDescendants.push_back(mDaughters[i]);
+                rParents.push_back(parent);
+                rBirthTimes.push_back(mTimes[i]);
+            }
+        }
+    }
+}
+
+
+//Each founder counts itself, plus one for each division in its clone by the given time
+std::map<unsigned, unsigned> LineageIndex::GetCloneSizes(double time) const
+{
+    std::map<unsigned, unsigned> cloneSizes;
+    for (unsigned i = 0; i < mFounders.size(); i++){
+        if (cloneSizes.find(mFounders[i]) == cloneSizes.end()){
+            cloneSizes[mFounders[i]] = 1;
+        }
+        if (mTimes[i] <= time){
+            cloneSizes[mFounders[i]]++;
+        }
+    }
+    return cloneSizes;
+}
@@ -0,0 +1,144 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef LINEAGEINDEX_HPP_
+#define LINEAGEINDEX_HPP_
+
+#include <string>
+#include <vector>
+#include <map>
+
+/*
+* A parent to child index of the divisions recorded by LineageOutput, for fast lineage queries.
+*
+* The index holds one entry per division (parent ID, daughter ID, time, and the founder the daughter descends
+* from), sorted by parent and then time, so a cell's daughters are found by binary search and a cell's
+* descendants by walking down the tree. A founder is a cell with no recorded parent, such as one of the
+* starting cells.
+*
+* Building the index means reading the division logs of every results folder in a run; the index is then saved
+* in the run's output directory as LineageIndex.bin (in the BinaryRecordReader format), and loaded from there
+* by later queries unless a division log has been written to since.
+*/
+
+class LineageIndex
+{
+private:
+
+    //Divisions, sorted by parent and then time
+    std::vector<unsigned> mParents;
+    std::vector<unsigned> mDaughters;
+    std::vector<double> mTimes;
+    std::vector<unsigned> mFounders;
+
+    //Sorts the divisions and works out each daughter's founder
+    void Finalise();
+
+public:
+
+    //Column names of the index file
+    static std::vector<std::string> GetColumnNames();
+
+
+    /**
+    * Builds the index from division logs, each either a DivisionData.txt or a DivisionData.bin file.
+    *
+    * @param rLogFiles full paths of the logs
+    */
+    void BuildFromLogs(const std::vector<std::string>& rLogFiles);
+
+
+    /**
+    * Saves the index.
+    *
+    * @param filePath full path of the file to write
+    */
+    void Save(std::string filePath) const;
+
+
+    /**
+    * Loads a saved index.
+    *
+    * @param filePath full path of the file
+    */
+    void Load(std::string filePath);
+
+
+    /**
+    * Loads the index of a run from LineageIndex.bin in its output directory, first building and saving it if it
+    * is missing or older than any of the run's division logs.
+    *
+    * @param outputDirectory the run's output directory, relative to where Chaste output is stored
+    */
+    void LoadOrBuild(std::string outputDirectory);
+
+
+    //Number of divisions in the index
+    unsigned GetNumDivisions() const;
+
+
+    /**
+    * @return the daughters of a cell, in order of birth
+    *
+    * @param cellId the parent's ID
+    */
+    std::vector<unsigned> GetDaughters(unsigned cellId) const;
+
+
+    /**
+    * Finds every descendant of a cell born in a time window.
+    *
+    * @param cellId the ancestor's ID
+    * @param startTime the earliest birth time to include
+    * @param endTime the latest birth time to include. Descendants born after this are not searched.
+    * @param rDescendants filled with the descendants' IDs
+    * @param rParents filled with each descendant's parent
+    * @param rBirthTimes filled with each descendant's birth time
+    */
+    void GetDescendants(unsigned cellId, double startTime, double endTime, std::vector<unsigned>& rDescendants,
+                        std::vector<unsigned>& rParents, std::vector<double>& rBirthTimes) const;
+
+
+    /**
+    * @return for each founder with at least one recorded division, the number of cells in its clone (itself and
+    * all its descendants) born by a given time. Cells that have since died or been removed are included.
+    *
+    * @param time the latest birth time to count
+    */
+    std::map<unsigned, unsigned> GetCloneSizes(double time) const;
+
+};
+
+#endif /*LINEAGEINDEX_HPP_*/
@@ -0,0 +1,209 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "LineageOutput.hpp"
+#include "GermlineProfiler.hpp"
+#include "GlobalParameterStruct.hpp"
+#include <algorithm>
+
+
+//Returns a cell data item, or a default if the cell does not have it
+static double GetItemOrDefault(CellPtr pCell, const std::string& rKey, double defaultValue)
+{
+  std::vector<std::string> keys = pCell->GetCellData()->GetKeys();
+  if (std::find(keys.begin(), keys.end(), rKey) == keys.end()){
+    return defaultValue;
+  }
+  return pCell->GetCellData()->GetItem(rKey);
+}
+
+
+//Constructor
+template<unsigned DIM>
+LineageOutput<DIM>::LineageOutput()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      OutputFile(NULL)
+{}
+
+
+//Empty destructor
+template<unsigned DIM>
+LineageOutput<DIM>::~LineageOutput(){}
+
+
+//Setter for mAppendDirectory
+template<unsigned DIM>
+void LineageOutput<DIM>::SetAppendDirectory(std::string directory)
+{
+  mAppendDirectory = directory;
+};
+
+
+//Names of the DivisionData columns
+template<unsigned DIM>
+std::vector<std::string> LineageOutput<DIM>::GetColumnNames()
+{
+  const char* names[] = {"Time", "ParentId", "DaughterId", "X", "Y", "Z",
+                         "CellCyclePhase", "SpermFated", "OocyteFated"};
+  return std::vector<std::string>(names, names + 9);
+}
+
+
+//Cells that have never been labelled (e.g. at the start of a new simulation) start their own lineage
+template<unsigned DIM>
+void LineageOutput<DIM>::LabelCells(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+  for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+  cell_iter != rCellPopulation.End(); ++cell_iter)
+  {
+    if (GetItemOrDefault(*cell_iter, "LineageId", -1.0) < 0){
+      cell_iter->GetCellData()->SetItem("LineageId", cell_iter->GetCellId());
+    }
+  }
+}
+
+
+//Open an output file DivisionData.txt (or DivisionData.bin) in the simulation directory
+template<unsigned DIM>
+void LineageOutput<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+  std::string directory = mAppendDirectory.empty() ? outputDirectory : mAppendDirectory;
+  OutputFileHandler rOutputFileHandler(directory, false);
+
+  //Parameters[41]: binary data output (0 = text). Does not affect the simulation itself, so only peeked at.
+  GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+  if (parameters->GetNumParameters() > 41 && parameters->PeekParameter(41) > 0){
+    mpBinaryOutput.reset(new BinaryRecordWriter(GetColumnNames()));
+    mpBinaryOutput->Open(rOutputFileHandler.GetOutputDirectoryFullPath() + "DivisionData.bin", !mAppendDirectory.empty());
+  }else if (mAppendDirectory.empty()){
+    OutputFile = rOutputFileHandler.OpenOutputFile("DivisionData.txt");
+  }else{
+    OutputFile = rOutputFileHandler.OpenOutputFile("DivisionData.txt", std::ios::out | std::ios::app);
+  }
+
+  LabelCells(rCellPopulation);
+}
+
+
+//Divisions happen before modifiers are updated, so any daughter born this timestep still carries its
+//parent's LineageId
+template<unsigned DIM>
+void LineageOutput<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+  ScopedProfileTimer timer(GermlineProfiler::LINEAGE_OUTPUT);
+
+  double time = SimulationTime::Instance()->GetTime();
+  bool anyDivisions = false;
+
+  for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+  cell_iter != rCellPopulation.End(); ++cell_iter)
+  {
+    //Every cell was labelled in SetupSolve, and daughters inherit the label
+    unsigned id = cell_iter->GetCellId();
+    double lineageId = cell_iter->GetCellData()->GetItem("LineageId");
+    if (lineageId == (double)id){
+      continue;
+    }
+    cell_iter->GetCellData()->SetItem("LineageId", id);
+
+    c_vector<double, DIM> location = rCellPopulation.GetLocationOfCellCentre(*cell_iter);
+    double record[9] = {time, lineageId, (double)id, 0.0, 0.0, 0.0,
+                        GetItemOrDefault(*cell_iter, "CellCyclePhase", -1.0),
+                        GetItemOrDefault(*cell_iter, "SpermFated", -1.0),
+                        GetItemOrDefault(*cell_iter, "OocyteFated", -1.0)};
+    for (unsigned j = 0; j < DIM && j < 3; j++){
+      record[3+j] = location[j];
+    }
+
+    if (mpBinaryOutput){
+      mpBinaryOutput->Append(std::vector<double>(record, record + 9));
+    }else{
+      *OutputFile << record[0];
+      for (unsigned j = 1; j < 9; j++){
+        *OutputFile << "\t" << record[j];
+      }
+      *OutputFile << "\n";
+      anyDivisions = true;
+    }
+  }
+
+  //Text output is flushed after each timestep with a division, as the other data files are after each sample
+  if (anyDivisions){
+    OutputFile->flush();
+  }
+
+  //If the simulation is finished, close the output file.
+  if(SimulationTime::Instance()->IsFinished()){
+    if (mpBinaryOutput){
+      mpBinaryOutput->Close();
+    }else{
+      OutputFile->close();
+    }
+  }
+}
+
+
+//Hand any buffered records to disk
+template<unsigned DIM>
+void LineageOutput<DIM>::FlushOutput()
+{
+  if (mpBinaryOutput){
+    mpBinaryOutput->Flush();
+  }else if (OutputFile){
+    OutputFile->flush();
+  }
+}
+
+
+//Output this class's parameters to a log file
+template<unsigned DIM>
+void LineageOutput<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+  // No parameters to output, so just call method on direct parent class
+  AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class LineageOutput<1>;
+template class LineageOutput<2>;
+template class LineageOutput<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(LineageOutput)
@@ -0,0 +1,137 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef LINEAGEOUTPUT_HPP_
+#define LINEAGEOUTPUT_HPP_
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "OutputFileHandler.hpp"
+#include "BinaryRecordWriter.hpp"
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/shared_ptr.hpp>
+
+/**
+ * A modifier that records every cell division, for lineage analysis (see LineageIndex and getTreePath.R).
+ *
+ * Each division is one row: time, parent ID, daughter ID, the daughter's position, and the fate state it was
+ * born with (CellCyclePhase, SpermFated and OocyteFated, or -1 where a cell has no such data). Rows go to the
+ * tab delimited text file DivisionData.txt, or if parameter 41 is non-zero, to binary records in DivisionData.bin.
+ *
+ * Divisions are found through the cell data item "LineageId", which every cell carries and which is set to
+ * the cell's own ID. When a cell divides, Chaste copies its cell data to the daughter, so a cell whose
+ * LineageId differs from its ID is a new daughter, and its LineageId is its parent's ID.
+ */
+template<unsigned DIM>
+class LineageOutput : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+    }
+
+    //Output file stream
+    out_stream OutputFile;
+
+    //Binary output, used instead of OutputFile if parameter 41 asks for it
+    boost::shared_ptr<BinaryRecordWriter> mpBinaryOutput;
+
+    //If set, the directory of an existing output file to add to (e.g. when continuing from a checkpoint)
+    std::string mAppendDirectory;
+
+    //Marks every cell without a LineageId as its own lineage
+    void LabelCells(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    //Constructor
+    LineageOutput();
+
+
+    //Destructor
+    virtual ~LineageOutput();
+
+
+    //Setter for mAppendDirectory, relative to the Chaste output directory. Divisions are then appended to the
+    //file in that directory instead of written to a new one in the simulation's results folder. Not archived.
+    void SetAppendDirectory(std::string directory);
+
+
+    /**
+     * Overriden SetupSolve method. Opens the output file and labels the starting cells.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+     void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+
+    /**
+     * Overriden UpdateAtEndOfTimeStep method. Records any divisions that took place during the timestep.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+     void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+
+    /**
+     * Makes sure all divisions recorded so far are in the output file, e.g. before taking a checkpoint.
+     */
+     void FlushOutput();
+
+
+    /**
+     * @return the names of the columns of DivisionData, in order
+     */
+     static std::vector<std::string> GetColumnNames();
+
+
+     //Output any parameters associated with this class
+     void OutputSimulationModifierParameters(out_stream& rParamsFile);
+
+};
+
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(LineageOutput)
+
+#endif /*LINEAGEOUTPUT_HPP_*/
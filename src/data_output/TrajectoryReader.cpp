@@ -0,0 +1,411 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "TrajectoryReader.hpp"
+#include "BinaryRecordReader.hpp"
+#include "BinaryRecordWriter.hpp"
+#include "Exception.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <unistd.h>
+
+
+const char TrajectoryReader::MAGIC[8] = {'E','G','T','R','A','J','\0','\0'};
+const boost::uint32_t TrajectoryReader::FORMAT_VERSION;
+const boost::uint32_t TrajectoryReader::BYTE_ORDER_MARK;
+const boost::uint32_t TrajectoryReader::FRAME_MARKER;
+
+//Bytes in a frame header: marker, time, keyframe flag, number of cells, payload length
+static const long FRAME_HEADER_SIZE = 4 + 8 + 1 + 4 + 4;
+
+
+//Reads a fixed size value, returning false at the end of the file
+template<typename T>
+static bool ReadValue(FILE* pFile, T& rValue)
+{
+    return std::fread(&rValue, sizeof(T), 1, pFile) == 1;
+}
+
+
+//Reads a variable length unsigned integer (7 bits per byte, high bit set on all but the last byte)
+static bool DecodeVarint(const std::vector<unsigned char>& rBuffer, unsigned& rPosition, boost::uint64_t& rValue)
+{
+    rValue = 0;
+    for (unsigned shift = 0; shift < 64 && rPosition < rBuffer.size(); shift += 7){
+        unsigned char byte = rBuffer[rPosition++];
+        rValue |= (boost::uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0){
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//Undoes the zig-zag mapping of signed to unsigned integers (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...)
+static boost::int64_t UnZigZag(boost::uint64_t value)
+{
+    return (boost::int64_t)(value >> 1) ^ -(boost::int64_t)(value & 1);
+}
+
+
+//Column names of the index file
+std::vector<std::string> TrajectoryReader::GetIndexColumnNames()
+{
+    std::vector<std::string> names;
+    names.push_back("Time");
+    names.push_back("Offset");
+    names.push_back("IsKeyframe");
+    return names;
+}
+
+
+//Constructor, reads the header, then takes frame positions from the index as far as it agrees with the file,
+//and scans the frame headers for the rest
+TrajectoryReader::TrajectoryReader(std::string filePath)
+    : mFilePath(filePath),
+      mQuantum(0.0),
+      mKeyframeInterval(0),
+      mDataOffset(0),
+      mDataEnd(0)
+{
+    FILE* p_file = std::fopen(filePath.c_str(), "rb");
+    if (p_file == NULL){
+        EXCEPTION("Could not open trajectory file " << filePath);
+    }
+
+    char magic[8];
+    boost::uint32_t version = 0;
+    boost::uint32_t byteOrder = 0;
+    boost::uint32_t keyframeInterval = 0;
+    bool ok = std::fread(magic, 1, 8, p_file) == 8 && std::memcmp(magic, MAGIC, 8) == 0;
+    ok = ok && ReadValue(p_file, version) && ReadValue(p_file, byteOrder);
+    ok = ok && ReadValue(p_file, mQuantum) && ReadValue(p_file, keyframeInterval);
+    if (!ok){
+        std::fclose(p_file);
+        EXCEPTION(filePath << " is not a trajectory file.");
+    }
+    if (version != FORMAT_VERSION){
+        std::fclose(p_file);
+        EXCEPTION("Trajectory file " << filePath << " has format version " << version << ", but only version "
+                  << FORMAT_VERSION << " can be read.");
+    }
+    if (byteOrder != BYTE_ORDER_MARK){
+        std::fclose(p_file);
+        EXCEPTION("Trajectory file " << filePath << " was written on a machine with a different byte order.");
+    }
+    mKeyframeInterval = keyframeInterval;
+    mDataOffset = std::ftell(p_file);
+    std::fseek(p_file, 0, SEEK_END);
+    long fileSize = std::ftell(p_file);
+
+    //Use the index while each entry starts where the previous frame ends
+    std::vector<std::vector<double> > index;
+    std::string indexPath = filePath + "idx";
+    if (std::ifstream(indexPath.c_str()).is_open()){
+        try{
+            BinaryRecordReader indexReader(indexPath);
+            if (indexReader.rGetColumnNames() == GetIndexColumnNames()){
+                index = indexReader.ReadRecords();
+            }
+        }
+        catch (Exception&){
+            index.clear();
+        }
+    }
+
+    //Take the index entries while they run forward through the file, then check the last one against the
+    //file itself. If it does not match, the index is ignored and the whole file is scanned.
+    for (unsigned i = 0; i < index.size(); i++){
+        long entryOffset = (long)index[i][1];
+        if ((i == 0 && entryOffset != mDataOffset) || (i > 0 && entryOffset <= mFrameOffsets.back())
+            || entryOffset >= fileSize){
+            break;
+        }
+        mFrameTimes.push_back(index[i][0]);
+        mFrameOffsets.push_back(entryOffset);
+        mFrameIsKeyframe.push_back(index[i][2] != 0.0);
+    }
+
+    long offset = mDataOffset;
+    double time;
+    bool isKeyframe;
+    boost::uint32_t numCells;
+    boost::uint32_t payloadSize;
+    if (!mFrameOffsets.empty()){
+        bool lastEntryMatches = ReadFrameHeader(p_file, mFrameOffsets.back(), time, isKeyframe, numCells, payloadSize)
+                                && time == mFrameTimes.back() && isKeyframe == mFrameIsKeyframe.back()
+                                && mFrameOffsets.back() + FRAME_HEADER_SIZE + (long)payloadSize <= fileSize;
+        if (lastEntryMatches){
+            offset = mFrameOffsets.back() + FRAME_HEADER_SIZE + payloadSize;
+        }else{
+            mFrameTimes.clear();
+            mFrameOffsets.clear();
+            mFrameIsKeyframe.clear();
+        }
+    }
+
+    //Scan whatever the index did not cover
+    while (ReadFrameHeader(p_file, offset, time, isKeyframe, numCells, payloadSize)
+           && offset + FRAME_HEADER_SIZE + (long)payloadSize <= fileSize){
+        mFrameTimes.push_back(time);
+        mFrameOffsets.push_back(offset);
+        mFrameIsKeyframe.push_back(isKeyframe);
+        offset += FRAME_HEADER_SIZE + payloadSize;
+    }
+    mDataEnd = offset;
+    std::fclose(p_file);
+
+    if (!mFrameIsKeyframe.empty() && !mFrameIsKeyframe[0]){
+        EXCEPTION("Trajectory file " << filePath << " does not start with a keyframe.");
+    }
+}
+
+
+//Getters
+unsigned TrajectoryReader::GetNumFrames() const
+{
+    return mFrameTimes.size();
+}
+
+double TrajectoryReader::GetFrameTime(unsigned frame) const
+{
+    return mFrameTimes[frame];
+}
+
+double TrajectoryReader::GetQuantum() const
+{
+    return mQuantum;
+}
+
+long TrajectoryReader::GetFrameOffset(unsigned frame) const
+{
+    return mFrameOffsets[frame];
+}
+
+long TrajectoryReader::GetDataEnd() const
+{
+    return mDataEnd;
+}
+
+
+//Frame times increase, so binary search
+unsigned TrajectoryReader::FindFrame(double time) const
+{
+    std::vector<double>::const_iterator it = std::upper_bound(mFrameTimes.begin(), mFrameTimes.end(), time + 1e-9);
+    if (it == mFrameTimes.begin()){
+        return 0;
+    }
+    return (unsigned)(it - mFrameTimes.begin()) - 1;
+}
+
+
+//Reads the fixed size part of a frame
+bool TrajectoryReader::ReadFrameHeader(FILE* pFile, long offset, double& rTime, bool& rIsKeyframe,
+                                       boost::uint32_t& rNumCells, boost::uint32_t& rPayloadSize) const
+{
+    if (std::fseek(pFile, offset, SEEK_SET) != 0){
+        return false;
+    }
+    boost::uint32_t marker = 0;
+    unsigned char keyframe = 0;
+    bool ok = ReadValue(pFile, marker) && marker == FRAME_MARKER;
+    ok = ok && ReadValue(pFile, rTime) && ReadValue(pFile, keyframe);
+    ok = ok && ReadValue(pFile, rNumCells) && ReadValue(pFile, rPayloadSize);
+    rIsKeyframe = (keyframe != 0);
+    return ok;
+}
+
+
+//Undoes the ID gaps, and adds position changes to the previous frame's positions for cells that were in it
+void TrajectoryReader::DecodeFrame(FILE* pFile, unsigned frame, std::vector<unsigned>& rIds,
+                                   std::vector<boost::int64_t>& rQuantised) const
+{
+    double time;
+    bool isKeyframe;
+    boost::uint32_t numCells;
+    boost::uint32_t payloadSize;
+    if (!ReadFrameHeader(pFile, mFrameOffsets[frame], time, isKeyframe, numCells, payloadSize)){
+        EXCEPTION("Trajectory file " << mFilePath << " changed while it was being read.");
+    }
+    std::vector<unsigned char> payload(payloadSize);
+    if (payloadSize > 0 && std::fread(&payload[0], 1, payloadSize, pFile) != payloadSize){
+        EXCEPTION("Trajectory file " << mFilePath << " changed while it was being read.");
+    }
+
+    std::vector<unsigned> previousIds;
+    std::vector<boost::int64_t> previousQuantised;
+    previousIds.swap(rIds);
+    previousQuantised.swap(rQuantised);
+    rIds.resize(numCells);
+    rQuantised.resize(3*numCells);
+
+    unsigned position = 0;
+    unsigned previousIndex = 0;
+    boost::uint64_t id = 0;
+    for (unsigned i = 0; i < numCells; i++){
+        boost::uint64_t gap;
+        if (!DecodeVarint(payload, position, gap)){
+            EXCEPTION("Trajectory file " << mFilePath << " has a damaged frame at time " << time);
+        }
+        id += gap;
+        rIds[i] = (unsigned)id;
+
+        //Both frames are in ID order, so the previous frame is searched by walking along it
+        while (previousIndex < previousIds.size() && previousIds[previousIndex] < rIds[i]){
+            previousIndex++;
+        }
+        bool inPrevious = !isKeyframe && previousIndex < previousIds.size() && previousIds[previousIndex] == rIds[i];
+
+        for (unsigned j = 0; j < 3; j++){
+            boost::uint64_t value;
+            if (!DecodeVarint(payload, position, value)){
+                EXCEPTION("Trajectory file " << mFilePath << " has a damaged frame at time " << time);
+            }
+            rQuantised[3*i+j] = UnZigZag(value) + (inPrevious ? previousQuantised[3*previousIndex+j] : 0);
+        }
+    }
+}
+
+
+//Decodes forward from the last keyframe at or before the frame
+void TrajectoryReader::ReadFrame(unsigned frame, std::vector<unsigned>& rIds, std::vector<double>& rPositions) const
+{
+    if (frame >= mFrameTimes.size()){
+        EXCEPTION("Trajectory file " << mFilePath << " has no frame " << frame);
+    }
+    unsigned keyframe = frame;
+    while (!mFrameIsKeyframe[keyframe]){
+        keyframe--;
+    }
+
+    FILE* p_file = std::fopen(mFilePath.c_str(), "rb");
+    if (p_file == NULL){
+        EXCEPTION("Could not open trajectory file " << mFilePath);
+    }
+    std::vector<boost::int64_t> quantised;
+    rIds.clear();
+    try{
+        for (unsigned i = keyframe; i <= frame; i++){
+            DecodeFrame(p_file, i, rIds, quantised);
+        }
+    }
+    catch (Exception&){
+        std::fclose(p_file);
+        throw;
+    }
+    std::fclose(p_file);
+
+    rPositions.resize(quantised.size());
+    for (unsigned i = 0; i < quantised.size(); i++){
+        rPositions[i] = mQuantum*quantised[i];
+    }
+}
+
+
+//Decodes the frames in order, so each is only decoded once
+void TrajectoryReader::WriteText(std::string outputPath, double startTime, double endTime) const
+{
+    std::ofstream output(outputPath.c_str());
+    if (!output.is_open()){
+        EXCEPTION("Could not open " << outputPath << " for writing.");
+    }
+    if (!mFrameTimes.empty()){
+        unsigned first = FindFrame(startTime);
+        while (!mFrameIsKeyframe[first]){
+            first--;
+        }
+
+        FILE* p_file = std::fopen(mFilePath.c_str(), "rb");
+        if (p_file == NULL){
+            EXCEPTION("Could not open trajectory file " << mFilePath);
+        }
+        std::vector<unsigned> ids;
+        std::vector<boost::int64_t> quantised;
+        for (unsigned frame = first; frame < mFrameTimes.size() && mFrameTimes[frame] <= endTime + 1e-9; frame++){
+            try{
+                DecodeFrame(p_file, frame, ids, quantised);
+            }
+            catch (Exception&){
+                std::fclose(p_file);
+                throw;
+            }
+            if (mFrameTimes[frame] < startTime - 1e-9){
+                continue;
+            }
+            for (unsigned i = 0; i < ids.size(); i++){
+                output << mFrameTimes[frame] << "\t" << ids[i] << "\t" << mQuantum*quantised[3*i]
+                       << "\t" << mQuantum*quantised[3*i+1] << "\t" << mQuantum*quantised[3*i+2] << "\n";
+            }
+        }
+        std::fclose(p_file);
+    }
+    output.close();
+    if (output.fail()){
+        EXCEPTION("Failed to write " << outputPath);
+    }
+}
+
+
+//Cuts the file after the last frame to keep, and rewrites the index to match
+void TrajectoryReader::TruncateAfter(std::string filePath, double time)
+{
+    if (!std::ifstream(filePath.c_str()).is_open()){
+        return;
+    }
+    TrajectoryReader reader(filePath);
+    unsigned numKept = 0;
+    while (numKept < reader.GetNumFrames() && reader.GetFrameTime(numKept) <= time + 1e-6){
+        numKept++;
+    }
+    long keptSize = (numKept < reader.GetNumFrames()) ? reader.GetFrameOffset(numKept) : reader.GetDataEnd();
+    if (truncate(filePath.c_str(), keptSize) != 0){
+        EXCEPTION("Failed to trim " << filePath);
+    }
+
+    BinaryRecordWriter index(GetIndexColumnNames());
+    index.Open(filePath + "idx", false);
+    for (unsigned i = 0; i < numKept; i++){
+        std::vector<double> entry(3);
+        entry[0] = reader.mFrameTimes[i];
+        entry[1] = (double)reader.mFrameOffsets[i];
+        entry[2] = reader.mFrameIsKeyframe[i] ? 1.0 : 0.0;
+        index.Append(entry);
+    }
+    index.Close();
+}
@@ -0,0 +1,161 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TRAJECTORYREADER_HPP_
+#define TRAJECTORYREADER_HPP_
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <boost/cstdint.hpp>
+
+/*
+* Reads the compressed trajectory files (TrackingData.traj) written by TrajectoryWriter.
+*
+* A trajectory file is a header followed by one frame per sampling time:
+*
+* - Header: magic string, format version, byte order check, the position quantum (microns per stored unit)
+*   and the keyframe interval.
+* - Frame: frame marker, time, keyframe flag, number of cells, payload length, then the payload. For each
+*   cell, in increasing ID order, the payload holds the gap from the previous ID and the three quantised
+*   coordinates, all as variable length integers. In a keyframe the coordinates are stored as they are; in
+*   other frames, a cell that was in the previous frame stores only its change in position since then.
+*
+* Cells move a few microns an hour, so most values fit in one or two bytes, against around 40 characters
+* per line of text. Decoding a frame needs the frames back to the last keyframe, which is never more than
+* the keyframe interval away.
+*
+* Frame positions and times are also written to an index file (TrackingData.trajidx, in the BinaryRecordReader
+* format) so any time can be found without reading the file from the start. If the index is missing,
+* behind (e.g. after a crash) or does not match the file, the frames it lacks are found by scanning the
+* frame headers.
+*/
+
+class TrajectoryReader
+{
+private:
+
+    //File being read
+    std::string mFilePath;
+
+    //Settings from the header
+    double mQuantum;
+    unsigned mKeyframeInterval;
+
+    //Offsets of the first frame, and of the end of the last complete frame, in bytes
+    long mDataOffset;
+    long mDataEnd;
+
+    //Time, file offset and keyframe flag of every complete frame
+    std::vector<double> mFrameTimes;
+    std::vector<long> mFrameOffsets;
+    std::vector<bool> mFrameIsKeyframe;
+
+    //Reads the frame header at an offset, returning false if it is incomplete
+    bool ReadFrameHeader(FILE* pFile, long offset, double& rTime, bool& rIsKeyframe, boost::uint32_t& rNumCells,
+                         boost::uint32_t& rPayloadSize) const;
+
+    //Decodes one frame. rIds and rQuantised hold the previous frame on entry, and this frame on return.
+    void DecodeFrame(FILE* pFile, unsigned frame, std::vector<unsigned>& rIds, std::vector<boost::int64_t>& rQuantised) const;
+
+public:
+
+    //Format constants shared with TrajectoryWriter
+    static const char MAGIC[8];
+    static const boost::uint32_t FORMAT_VERSION = 1;
+    static const boost::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static const boost::uint32_t FRAME_MARKER = 0x4D415246;
+
+    //Column names of the index file
+    static std::vector<std::string> GetIndexColumnNames();
+
+
+    /**
+    * Constructor. Reads the header and the frame index, throwing an exception if this is not a trajectory file.
+    *
+    * @param filePath full path of the trajectory file. The index is looked for next to it, with "idx" appended.
+    */
+    TrajectoryReader(std::string filePath);
+
+
+    //Getters
+    unsigned GetNumFrames() const;
+    double GetFrameTime(unsigned frame) const;
+    double GetQuantum() const;
+    long GetFrameOffset(unsigned frame) const;
+    long GetDataEnd() const;
+
+
+    /**
+    * @return the index of the last frame at or before a given time, or of the first frame if all are later
+    *
+    * @param time the time to look for
+    */
+    unsigned FindFrame(double time) const;
+
+
+    /**
+    * Reads the cells in one frame.
+    *
+    * @param frame the frame's index
+    * @param rIds filled with the cell IDs, in increasing order
+    * @param rPositions filled with x, y and z for each cell in turn, in microns
+    */
+    void ReadFrame(unsigned frame, std::vector<unsigned>& rIds, std::vector<double>& rPositions) const;
+
+
+    /**
+    * Writes the frames between two times as tab delimited text, in the layout of TrackingData.txt
+    * (time, ID, x, y, z), with cells in ID order within each frame.
+    *
+    * @param outputPath full path of the file to write
+    * @param startTime the first time to write
+    * @param endTime the last time to write
+    */
+    void WriteText(std::string outputPath, double startTime, double endTime) const;
+
+
+    /**
+    * Removes the frames later than a given time, along with any incomplete frame at the end, from a trajectory
+    * file and its index, so that a resumed run can append to them. Does nothing if the file does not exist.
+    *
+    * @param filePath full path of the trajectory file
+    * @param time the latest time to keep
+    */
+    static void TruncateAfter(std::string filePath, double time);
+
+};
+
+#endif /*TRAJECTORYREADER_HPP_*/
@@ -0,0 +1,228 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "TrajectoryWriter.hpp"
+#include "TrajectoryReader.hpp"
+#include "Exception.hpp"
+
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+
+
+//Appends a variable length unsigned integer (7 bits per byte, high bit set on all but the last byte)
+static void EncodeVarint(boost::uint64_t value, std::vector<unsigned char>& rBuffer)
+{
+    while (value >= 0x80){
+        rBuffer.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    rBuffer.push_back((unsigned char)value);
+}
+
+
+//Maps signed to unsigned integers so that small changes either way stay small (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...)
+static boost::uint64_t ZigZag(boost::int64_t value)
+{
+    return ((boost::uint64_t)value << 1) ^ (boost::uint64_t)(value >> 63);
+}
+
+
+//Constructor
+TrajectoryWriter::TrajectoryWriter(double quantum, unsigned keyframeInterval)
+    : mQuantum(quantum),
+      mKeyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1),
+      mpFile(NULL),
+      mOffset(0),
+      mFramesSinceKeyframe(0)
+{
+    if (mQuantum <= 0.0){
+        EXCEPTION("The trajectory quantum must be positive.");
+    }
+}
+
+
+//Destructor. Must not throw.
+TrajectoryWriter::~TrajectoryWriter()
+{
+    if (mpFile != NULL){
+        try{
+            Close();
+        }
+        catch (Exception&){
+        }
+    }
+}
+
+
+//Writes the header for a new file, or tidies up an existing one before appending
+void TrajectoryWriter::Open(std::string filePath, bool append)
+{
+    if (mpFile != NULL){
+        EXCEPTION("Trajectory file " << mFilePath << " is already open.");
+    }
+    mFilePath = filePath;
+    mpIndex.reset(new BinaryRecordWriter(TrajectoryReader::GetIndexColumnNames()));
+
+    bool existing = false;
+    if (append){
+        std::ifstream test(filePath.c_str(), std::ios::binary | std::ios::ate);
+        existing = test.is_open() && test.tellg() > 0;
+    }
+
+    if (existing){
+        //Drops any incomplete frame, and makes the index match the file
+        TrajectoryReader::TruncateAfter(filePath, DBL_MAX);
+        TrajectoryReader reader(filePath);
+        mQuantum = reader.GetQuantum();
+        mOffset = reader.GetDataEnd();
+        mpFile = std::fopen(filePath.c_str(), "ab");
+        if (mpFile == NULL){
+            EXCEPTION("Could not open " << filePath << " to append frames.");
+        }
+        mpIndex->Open(filePath + "idx", true);
+    }else{
+        mpFile = std::fopen(filePath.c_str(), "wb");
+        if (mpFile == NULL){
+            EXCEPTION("Could not open " << filePath << " to write frames.");
+        }
+        boost::uint32_t version = TrajectoryReader::FORMAT_VERSION;
+        boost::uint32_t byteOrder = TrajectoryReader::BYTE_ORDER_MARK;
+        boost::uint32_t keyframeInterval = mKeyframeInterval;
+        bool written = std::fwrite(TrajectoryReader::MAGIC, 1, 8, mpFile) == 8;
+        written = written && std::fwrite(&version, sizeof(version), 1, mpFile) == 1;
+        written = written && std::fwrite(&byteOrder, sizeof(byteOrder), 1, mpFile) == 1;
+        written = written && std::fwrite(&mQuantum, sizeof(mQuantum), 1, mpFile) == 1;
+        written = written && std::fwrite(&keyframeInterval, sizeof(keyframeInterval), 1, mpFile) == 1;
+        if (!written || std::fflush(mpFile) != 0){
+            std::fclose(mpFile);
+            mpFile = NULL;
+            EXCEPTION("Failed to write the header of " << filePath);
+        }
+        mOffset = std::ftell(mpFile);
+        mpIndex->Open(filePath + "idx", false);
+    }
+
+    //Nothing to take differences from yet
+    mFramesSinceKeyframe = mKeyframeInterval;
+    mPreviousIds.clear();
+    mPreviousPositions.clear();
+}
+
+
+//Encodes the frame into a buffer, then writes header and buffer together
+void TrajectoryWriter::WriteFrame(double time, const std::vector<unsigned>& rIds, const std::vector<double>& rPositions)
+{
+    if (mpFile == NULL){
+        EXCEPTION("No trajectory file is open.");
+    }
+    if (rPositions.size() != 3*rIds.size()){
+        EXCEPTION("A trajectory frame needs three coordinates per cell.");
+    }
+
+    unsigned char isKeyframe = (mFramesSinceKeyframe >= mKeyframeInterval) ? 1 : 0;
+    std::vector<boost::int64_t> positions(rPositions.size());
+    for (unsigned i = 0; i < rPositions.size(); i++){
+        positions[i] = (boost::int64_t)std::floor(rPositions[i]/mQuantum + 0.5);
+    }
+
+    std::vector<unsigned char> payload;
+    payload.reserve(8*rIds.size());
+    unsigned previousIndex = 0;
+    for (unsigned i = 0; i < rIds.size(); i++){
+        if (i > 0 && rIds[i] <= rIds[i-1]){
+            EXCEPTION("Cells in a trajectory frame must be in increasing ID order.");
+        }
+        EncodeVarint(rIds[i] - (i > 0 ? rIds[i-1] : 0), payload);
+
+        //Both frames are in ID order, so the previous frame is searched by walking along it
+        while (previousIndex < mPreviousIds.size() && mPreviousIds[previousIndex] < rIds[i]){
+            previousIndex++;
+        }
+        bool inPrevious = !isKeyframe && previousIndex < mPreviousIds.size() && mPreviousIds[previousIndex] == rIds[i];
+
+        for (unsigned j = 0; j < 3; j++){
+            boost::int64_t reference = inPrevious ? mPreviousPositions[3*previousIndex+j] : 0;
+            EncodeVarint(ZigZag(positions[3*i+j] - reference), payload);
+        }
+    }
+
+    boost::uint32_t marker = TrajectoryReader::FRAME_MARKER;
+    boost::uint32_t numCells = rIds.size();
+    boost::uint32_t payloadSize = payload.size();
+    bool written = std::fwrite(&marker, sizeof(marker), 1, mpFile) == 1;
+    written = written && std::fwrite(&time, sizeof(time), 1, mpFile) == 1;
+    written = written && std::fwrite(&isKeyframe, 1, 1, mpFile) == 1;
+    written = written && std::fwrite(&numCells, sizeof(numCells), 1, mpFile) == 1;
+    written = written && std::fwrite(&payloadSize, sizeof(payloadSize), 1, mpFile) == 1;
+    written = written && (payload.empty() || std::fwrite(&payload[0], 1, payload.size(), mpFile) == payload.size());
+    written = (std::fflush(mpFile) == 0) && written;
+    if (!written){
+        EXCEPTION("Failed to write a frame to " << mFilePath);
+    }
+
+    std::vector<double> entry(3);
+    entry[0] = time;
+    entry[1] = (double)mOffset;
+    entry[2] = isKeyframe;
+    mpIndex->Append(entry);
+
+    mOffset += 4 + 8 + 1 + 4 + 4 + payloadSize;
+    mFramesSinceKeyframe = isKeyframe ? 1 : mFramesSinceKeyframe + 1;
+    mPreviousIds = rIds;
+    mPreviousPositions.swap(positions);
+}
+
+
+//Closes the file and index
+void TrajectoryWriter::Close()
+{
+    if (mpFile == NULL){
+        return;
+    }
+    bool closed = std::fclose(mpFile) == 0;
+    mpFile = NULL;
+    mpIndex->Close();
+    if (!closed){
+        EXCEPTION("Failed to close " << mFilePath);
+    }
+}
+
+
+//Whether a file is open
+bool TrajectoryWriter::IsOpen() const
+{
+    return mpFile != NULL;
+}
@@ -0,0 +1,133 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TRAJECTORYWRITER_HPP_
+#define TRAJECTORYWRITER_HPP_
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "BinaryRecordWriter.hpp"
+
+/*
+* Writes cell trajectories as compressed frames, in the format described in TrajectoryReader.
+*
+* Each frame stores the cells' IDs as gaps and their positions quantised to mQuantum microns. Positions are
+* stored relative to the cell's position in the previous frame, except in keyframes, written every
+* mKeyframeInterval frames (and as the first frame after opening), where they are stored as they are.
+* Each frame is flushed as soon as it is written, so a crash loses at most the frame being written.
+*/
+
+class TrajectoryWriter
+{
+private:
+
+    //Size of a quantisation step, in microns
+    double mQuantum;
+
+    //Number of frames from one keyframe to the next
+    unsigned mKeyframeInterval;
+
+    //Open trajectory file, its path and its current length
+    std::string mFilePath;
+    FILE* mpFile;
+    long mOffset;
+
+    //Index of frame times and offsets
+    boost::shared_ptr<BinaryRecordWriter> mpIndex;
+
+    //Frames written since the last keyframe
+    unsigned mFramesSinceKeyframe;
+
+    //IDs and quantised positions of the previous frame
+    std::vector<unsigned> mPreviousIds;
+    std::vector<boost::int64_t> mPreviousPositions;
+
+    //Not copyable
+    TrajectoryWriter(const TrajectoryWriter&);
+    TrajectoryWriter& operator=(const TrajectoryWriter&);
+
+public:
+
+    /**
+    * Constructor.
+    *
+    * @param quantum the size of a quantisation step, in microns
+    * @param keyframeInterval the number of frames from one keyframe to the next
+    */
+    TrajectoryWriter(double quantum = 0.001, unsigned keyframeInterval = 24);
+
+
+    /**
+    * Destructor. Closes the file if it is still open.
+    */
+    ~TrajectoryWriter();
+
+
+    /**
+    * Opens a trajectory file, and its index (the same path with "idx" appended).
+    *
+    * @param filePath full path of the file
+    * @param append whether to add to an existing file rather than replace it. Any incomplete frame at the
+    * end of the existing file is removed first, and the existing file's quantum is kept.
+    */
+    void Open(std::string filePath, bool append);
+
+
+    /**
+    * Writes a frame.
+    *
+    * @param time the simulation time
+    * @param rIds the IDs of the cells, in increasing order
+    * @param rPositions x, y and z for each cell in turn, in microns
+    */
+    void WriteFrame(double time, const std::vector<unsigned>& rIds, const std::vector<double>& rPositions);
+
+
+    /**
+    * Closes the file and its index.
+    */
+    void Close();
+
+
+    //Whether a file is open
+    bool IsOpen() const;
+
+};
+
+#endif /*TRAJECTORYWRITER_HPP_*/
@@ -34,16 +34,76 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "RepulsionForceSizeCorrected.hpp"
+#include "GermlineProfiler.hpp"
+#include "GermlineThreadPool.hpp"
 #include "IsNan.hpp"
 
+#include <algorithm>
+
 //Constructor
 template<unsigned DIM>
 RepulsionForceSizeCorrected<DIM>::RepulsionForceSizeCorrected()
-   : GeneralisedLinearSpringForce<DIM>()
+   : GeneralisedLinearSpringForce<DIM>(),
+     mEstimateVolumes(false),
+     mNumArms(1)
 {
 }
 
 
+//Works out the contributions of one list of pairs per task
+template<unsigned DIM>
+class CalculatePairListTask : public AbstractParallelTask
+{
+private:
+    RepulsionForceSizeCorrected<DIM>& mrForce;
+    AbstractCellPopulation<DIM>& mrCellPopulation;
+    const std::vector<const std::vector<unsigned>*>& mrPairLists;
+
+public:
+    CalculatePairListTask(RepulsionForceSizeCorrected<DIM>& rForce, AbstractCellPopulation<DIM>& rCellPopulation,
+                          const std::vector<const std::vector<unsigned>*>& rPairLists)
+        : mrForce(rForce),
+          mrCellPopulation(rCellPopulation),
+          mrPairLists(rPairLists)
+    {
+    }
+
+    void RunTask(unsigned taskIndex)
+    {
+        mrForce.CalculatePairContributions(mrCellPopulation, *mrPairLists[taskIndex]);
+    }
+};
+
+
+//Adds up the contributions to one block of node indices per task
+template<unsigned DIM>
+class SumNodeBlockTask : public AbstractParallelTask
+{
+private:
+    RepulsionForceSizeCorrected<DIM>& mrForce;
+    AbstractCellPopulation<DIM>& mrCellPopulation;
+    unsigned mNumNodes;
+    unsigned mNumTasks;
+
+public:
+    SumNodeBlockTask(RepulsionForceSizeCorrected<DIM>& rForce, AbstractCellPopulation<DIM>& rCellPopulation,
+                     unsigned numNodes, unsigned numTasks)
+        : mrForce(rForce),
+          mrCellPopulation(rCellPopulation),
+          mNumNodes(numNodes),
+          mNumTasks(numTasks)
+    {
+    }
+
+    void RunTask(unsigned taskIndex)
+    {
+        unsigned first = (unsigned)(((unsigned long long)mNumNodes * taskIndex) / mNumTasks);
+        unsigned end = (unsigned)(((unsigned long long)mNumNodes * (taskIndex + 1)) / mNumTasks);
+        mrForce.SumPairContributions(mrCellPopulation, first, end);
+    }
+};
+
+
 /*
 * Overriden AddForceContribution method. Largely the same as GeneralisedLinearSpringForce, except with a
 * cell radius scaling.
@@ -51,6 +111,7 @@ RepulsionForceSizeCorrected<DIM>::RepulsionForceSizeCorrected()
 template<unsigned DIM>
 void RepulsionForceSizeCorrected<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation)
 {
+    ScopedProfileTimer timer(GermlineProfiler::FORCE);
 
     // Throw an exception if the simulation doesn't use a NodeBasedCellPopulation
     if (dynamic_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation) == NULL)
@@ -58,60 +119,520 @@ void RepulsionForceSizeCorrected<DIM>::AddForceContribution(AbstractCellPopulati
         EXCEPTION("RepulsionForceSizeCorrected is to be used with a NodeBasedCellPopulation only");
     }
 
-    //Loop over pairs of nodes
-    std::vector< std::pair<Node<DIM>*, Node<DIM>* > >& r_node_pairs = (static_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation))->rGetNodePairs();
-    for (typename std::vector< std::pair<Node<DIM>*, Node<DIM>* > >::iterator iter = r_node_pairs.begin();
-        iter != r_node_pairs.end();
-        iter++)
+    NodeBasedCellPopulation<DIM>* p_population = static_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation);
+    if (mEstimateVolumes)
+    {
+        mVolumeEstimator.Reset(p_population->rGetMesh().GetMaximumNodeIndex() + 1);
+    }
+
+    //Loop over pairs of nodes: all at once; or split into lists of pairs, slab by slab and edge by edge, then any
+    //other pairs, or arm by arm and then across arms, whose contributions are worked out a list per task and
+    //then added up a block of nodes per task. Split across processes, each does its own slabs and the edge above
+    //each, and process 0 the other pairs.
+    std::vector< std::pair<Node<DIM>*, Node<DIM>* > >& r_node_pairs = p_population->rGetNodePairs();
+    bool slabs = mpSlabs && mpSlabs->GetNumSlabs() > 1;
+    if (slabs || mNumArms > 1)
+    {
+        mPairLists.clear();
+        if (slabs)
+        {
+            mpSlabs->Update(rCellPopulation);
+            mpSlabs->SplitPairs(r_node_pairs, mSlabPairIndices, mEdgePairIndices, mOtherPairIndices);
+            unsigned rank = IsDistributed() ? mpTransport->GetRank() : 0;
+            unsigned numSlabs = mpSlabs->GetNumSlabs();
+            for (unsigned slab = 0; slab < mSlabPairIndices.size(); slab++)
+            {
+                if (!IsDistributed() || mpTransport->GetProcessOfSlab(slab, numSlabs) == rank)
+                {
+                    mPairLists.push_back(&mSlabPairIndices[slab]);
+                }
+            }
+            for (unsigned edge = 0; edge < mEdgePairIndices.size(); edge++)
+            {
+                if (!IsDistributed() || mpTransport->GetProcessOfSlab(edge, numSlabs) == rank)
+                {
+                    mPairLists.push_back(&mEdgePairIndices[edge]);
+                }
+            }
+            if (rank == 0)
+            {
+                mPairLists.push_back(&mOtherPairIndices);
+            }
+        }
+        else
+        {
+            SplitPairsByArm(*p_population);
+            for (unsigned arm = 0; arm <= mNumArms; arm++)
+            {
+                mPairLists.push_back(&mArmPairIndices[arm]);
+            }
+        }
+
+        mPairContributions.resize(r_node_pairs.size());
+        CalculatePairListTask<DIM> calculate_task(*this, rCellPopulation, mPairLists);
+        GermlineThreadPool::Instance()->Run(calculate_task, mPairLists.size());
+        if (IsDistributed())
+        {
+            ExchangePairContributions(*p_population);
+        }
+
+        IndexPairsByNode(*p_population);
+        unsigned numTasks = GermlineThreadPool::Instance()->GetNumThreads();
+        SumNodeBlockTask<DIM> sum_task(*this, rCellPopulation, mNodePairStarts.size() - 1, numTasks);
+        GermlineThreadPool::Instance()->Run(sum_task, numTasks);
+        if (IsDistributed())
+        {
+            ExchangeForces(*p_population);
+        }
+    }
+    else
+    {
+        for (unsigned i = 0; i < r_node_pairs.size(); i++)
+        {
+            AddPairForce(r_node_pairs[i], *p_population);
+        }
+    }
+
+    //Record the volumes, including those of cells with no overlapping neighbours
+    if (mEstimateVolumes)
+    {
+        for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+            cell_iter != rCellPopulation.End(); ++cell_iter)
+        {
+            Node<DIM>* p_node = p_population->GetNode(p_population->GetLocationIndexUsingCell(*cell_iter));
+            cell_iter->GetCellData()->SetItem("volume", mVolumeEstimator.GetVolume(p_node->GetIndex(), p_node->GetRadius()));
+        }
+    }
+}
+
+
+//The contributions of a list of pairs
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::CalculatePairContributions(AbstractCellPopulation<DIM>& rCellPopulation,
+                                                                  const std::vector<unsigned>& rPairIndices)
+{
+    NodeBasedCellPopulation<DIM>* p_population = static_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation);
+    std::vector< std::pair<Node<DIM>*, Node<DIM>* > >& r_node_pairs = p_population->rGetNodePairs();
+    for (unsigned i = 0; i < rPairIndices.size(); i++)
+    {
+        CalculatePairContribution(r_node_pairs[rPairIndices[i]], *p_population, mPairContributions[rPairIndices[i]]);
+    }
+}
+
+
+//Each node's pairs, in the order they are listed, by counting each node's pairs and then filling in their indices
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::IndexPairsByNode(NodeBasedCellPopulation<DIM>& rPopulation)
+{
+    std::vector< std::pair<Node<DIM>*, Node<DIM>* > >& r_node_pairs = rPopulation.rGetNodePairs();
+    unsigned numNodes = rPopulation.rGetMesh().GetMaximumNodeIndex() + 1;
+    mNodePairStarts.assign(numNodes + 1, 0);
+    for (unsigned i = 0; i < r_node_pairs.size(); i++)
+    {
+        mNodePairStarts[r_node_pairs[i].first->GetIndex() + 1]++;
+        mNodePairStarts[r_node_pairs[i].second->GetIndex() + 1]++;
+    }
+    for (unsigned node = 0; node < numNodes; node++)
+    {
+        mNodePairStarts[node + 1] += mNodePairStarts[node];
+    }
+
+    //Each node's start is moved along as its pairs are filled in, then moved back
+    mNodePairIndices.resize(2*r_node_pairs.size());
+    for (unsigned i = 0; i < r_node_pairs.size(); i++)
+    {
+        mNodePairIndices[mNodePairStarts[r_node_pairs[i].first->GetIndex()]++] = i;
+        mNodePairIndices[mNodePairStarts[r_node_pairs[i].second->GetIndex()]++] = i;
+    }
+    for (unsigned node = numNodes; node > 0; node--)
+    {
+        mNodePairStarts[node] = mNodePairStarts[node - 1];
+    }
+    mNodePairStarts[0] = 0;
+}
+
+
+/*
+* Each node's force is added to in order of pair, as AddPairForce adds to it when looping over every pair, and
+* then replaced by the total, so the result is exactly the same. Nodes without pairs are left alone.
+*/
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::SumPairContributions(AbstractCellPopulation<DIM>& rCellPopulation,
+                                                            unsigned firstNode, unsigned endNode)
+{
+    NodeBasedCellPopulation<DIM>* p_population = static_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation);
+    std::vector< std::pair<Node<DIM>*, Node<DIM>* > >& r_node_pairs = p_population->rGetNodePairs();
+    unsigned rank = IsDistributed() ? mpTransport->GetRank() : 0;
+    for (unsigned node = firstNode; node < endNode; node++)
+    {
+        unsigned start = mNodePairStarts[node];
+        unsigned end = mNodePairStarts[node + 1];
+        if (start == end || (IsDistributed() && GetProcessOfNode(node) != rank))
+        {
+            continue;
+        }
+        Node<DIM>* p_node = p_population->GetNode(node);
+        c_vector<double, DIM> force = p_node->rGetAppliedForce();
+        double volumeGivenUp = 0.0;
+        for (unsigned k = start; k < end; k++)
+        {
+            unsigned pair = mNodePairIndices[k];
+            const PairContribution& r_contribution = mPairContributions[pair];
+            if (!r_contribution.overlap)
+            {
+                continue;
+            }
+            if (r_node_pairs[pair].first->GetIndex() == node)
+            {
+                force += r_contribution.forceA;
+                volumeGivenUp += r_contribution.capA;
+            }
+            else
+            {
+                force += r_contribution.forceB;
+                volumeGivenUp += r_contribution.capB;
+            }
+        }
+        p_node->rGetAppliedForce() = force;
+        if (mEstimateVolumes)
+        {
+            mVolumeEstimator.SetVolumeGivenUp(node, volumeGivenUp);
+        }
+    }
+}
+
+
+//What one pair of nodes adds to each node's force and volume given up
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::CalculatePairContribution(const std::pair<Node<DIM>*, Node<DIM>* >& rPair,
+                                                                 NodeBasedCellPopulation<DIM>& rPopulation,
+                                                                 PairContribution& rContribution)
+{
+    Node<DIM>* p_node_a = rPair.first;
+    Node<DIM>* p_node_b = rPair.second;
+
+    // Get the node locations
+    c_vector<double, DIM> node_a_location = p_node_a->rGetLocation();
+    c_vector<double, DIM> node_b_location =  p_node_b->rGetLocation();
+
+    // Get the node radii
+    double node_a_radius = p_node_a->GetRadius();
+    double node_b_radius = p_node_b->GetRadius();
+
+    // Get the unit vector between the two nodes
+    c_vector<double, DIM> unit_difference;
+    unit_difference = rPopulation.rGetMesh().GetVectorFromAtoB(node_a_location, node_b_location);
+
+    // Calculate the value of the rest length
+    double rest_length = node_a_radius+node_b_radius;
+
+    //If we have an overlap
+    double separation = norm_2(unit_difference);
+    rContribution.overlap = (separation < rest_length);
+    if (rContribution.overlap)
+    {
+        rContribution.capA = 0.0;
+        rContribution.capB = 0.0;
+        if (mEstimateVolumes)
+        {
+            rContribution.capA = OverlapVolumeEstimator::GetCapVolume(node_a_radius, node_b_radius, separation);
+            rContribution.capB = OverlapVolumeEstimator::GetCapVolume(node_b_radius, node_a_radius, separation);
+        }
+
+        // Calculate the force between nodes and check it isn't nan. Uses the parent method CalculateForceBetweenNodes
+        c_vector<double, DIM> force = this->CalculateForceBetweenNodes(p_node_a->GetIndex(), p_node_b->GetIndex(), rPopulation);
+        c_vector<double, DIM> negative_force = -1.0 * force;
+        for (unsigned j=0; j<DIM; j++)
+        {
+            assert(!std::isnan(force[j]));
+        }
+
+        // The force contribution to each node CORRECTED BY CELL RADIUS
+        // AS A PROPORTION OF THE NORMAL CHASTE CELL RADIUS (5 microns) 
+        for (unsigned j=0; j<DIM; j++)
+        {
+            force[j]         =force[j]/(node_a_radius/5.0);
+            negative_force[j]=negative_force[j]/(node_b_radius/5.0);
+        }
+        rContribution.forceA = force;
+        rContribution.forceB = negative_force;
+    }
+}
+
+
+//The force between one pair of nodes
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::AddPairForce(std::pair<Node<DIM>*, Node<DIM>* >& rPair,
+                                                    NodeBasedCellPopulation<DIM>& rPopulation)
+{
+    PairContribution contribution;
+    CalculatePairContribution(rPair, rPopulation, contribution);
+    if (contribution.overlap)
+    {
+        if (mEstimateVolumes)
+        {
+            unsigned index_a = rPair.first->GetIndex();
+            unsigned index_b = rPair.second->GetIndex();
+            mVolumeEstimator.SetVolumeGivenUp(index_a, mVolumeEstimator.GetVolumeGivenUp(index_a) + contribution.capA);
+            mVolumeEstimator.SetVolumeGivenUp(index_b, mVolumeEstimator.GetVolumeGivenUp(index_b) + contribution.capB);
+        }
+        rPair.first->AddAppliedForceContribution(contribution.forceA);
+        rPair.second->AddAppliedForceContribution(contribution.forceB);
+    }
+}
+
+
+//Each node's arm is looked up once, then each pair goes to its arm's list, or to the last list if it
+//crosses arms. Pairs keep their order within each list.
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::SplitPairsByArm(NodeBasedCellPopulation<DIM>& rPopulation)
+{
+    mArmOfNode.assign(rPopulation.rGetMesh().GetMaximumNodeIndex() + 1, -1.0);
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rPopulation.Begin();
+        cell_iter != rPopulation.End(); ++cell_iter)
     {
-        std::pair<Node<DIM>*, Node<DIM>* > pair = *iter;
-        Node<DIM>* p_node_a = pair.first;
-        Node<DIM>* p_node_b = pair.second;
+        mArmOfNode[rPopulation.GetLocationIndexUsingCell(*cell_iter)] = cell_iter->GetCellData()->GetItem("Arm");
+    }
 
-        // Get the node locations
-        c_vector<double, DIM> node_a_location = p_node_a->rGetLocation();
-        c_vector<double, DIM> node_b_location =  p_node_b->rGetLocation();
+    mArmPairIndices.resize(mNumArms + 1);
+    for (unsigned arm = 0; arm <= mNumArms; arm++)
+    {
+        mArmPairIndices[arm].clear();
+    }
+    std::vector< std::pair<Node<DIM>*, Node<DIM>* > >& r_node_pairs = rPopulation.rGetNodePairs();
+    for (unsigned i = 0; i < r_node_pairs.size(); i++)
+    {
+        double arm_a = mArmOfNode[r_node_pairs[i].first->GetIndex()];
+        double arm_b = mArmOfNode[r_node_pairs[i].second->GetIndex()];
+        if (arm_a == arm_b && arm_a >= 0.0 && arm_a < mNumArms)
+        {
+            mArmPairIndices[(unsigned)arm_a].push_back(i);
+        }
+        else
+        {
+            mArmPairIndices[mNumArms].push_back(i);
+        }
+    }
+}
 
-        // Get the node radii
-        double node_a_radius = p_node_a->GetRadius();
-        double node_b_radius = p_node_b->GetRadius();
 
-        // Get the unit vector between the two nodes
-        c_vector<double, DIM> unit_difference;
-        unit_difference = (static_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation))->rGetMesh().GetVectorFromAtoB(node_a_location, node_b_location);
+//Setter and getter for mpSlabs
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::SetSlabs(boost::shared_ptr<ArcLengthSlabs<DIM> > pSlabs)
+{
+    mpSlabs = pSlabs;
+}
+template<unsigned DIM>
+boost::shared_ptr<ArcLengthSlabs<DIM> > RepulsionForceSizeCorrected<DIM>::GetSlabs() const
+{
+    return mpSlabs;
+}
 
-        // Calculate the value of the rest length
-        double rest_length = node_a_radius+node_b_radius;
 
-        //If we have an overlap
-        if (norm_2(unit_difference) < rest_length)
+//Whether there is more than one process to share the slabs out between
+template<unsigned DIM>
+bool RepulsionForceSizeCorrected<DIM>::IsDistributed() const
+{
+    return mpSlabs && mpSlabs->GetNumSlabs() > 1 && mpTransport && mpTransport->GetNumProcesses() > 1;
+}
+
+
+//A node with no cell at the last slab update belongs to process 0
+template<unsigned DIM>
+unsigned RepulsionForceSizeCorrected<DIM>::GetProcessOfNode(unsigned nodeIndex) const
+{
+    return mpTransport->GetProcessOfSlab(mpSlabs->GetSlabOfNode(nodeIndex), mpSlabs->GetNumSlabs());
+}
+
+
+//Node index, force, then the volume given up to neighbours if volumes are estimated
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::PackNode(Node<DIM>* pNode, std::vector<double>& rMessage) const
+{
+    rMessage.push_back(pNode->GetIndex());
+    c_vector<double, DIM>& r_force = pNode->rGetAppliedForce();
+    for (unsigned j=0; j<DIM; j++)
+    {
+        rMessage.push_back(r_force[j]);
+    }
+    if (mEstimateVolumes)
+    {
+        rMessage.push_back(mVolumeEstimator.GetVolumeGivenUp(pNode->GetIndex()));
+    }
+}
+
+
+//Pair index, whether the nodes overlap, each node's force, then each node's volume given up
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::PackPair(unsigned pairIndex, std::vector<double>& rMessage) const
+{
+    const PairContribution& r_contribution = mPairContributions[pairIndex];
+    rMessage.push_back(pairIndex);
+    rMessage.push_back(r_contribution.overlap ? 1.0 : 0.0);
+    for (unsigned j=0; j<DIM; j++)
+    {
+        rMessage.push_back(r_contribution.overlap ? r_contribution.forceA[j] : 0.0);
+    }
+    for (unsigned j=0; j<DIM; j++)
+    {
+        rMessage.push_back(r_contribution.overlap ? r_contribution.forceB[j] : 0.0);
+    }
+    rMessage.push_back(r_contribution.overlap ? r_contribution.capA : 0.0);
+    rMessage.push_back(r_contribution.overlap ? r_contribution.capB : 0.0);
+}
+
+
+/*
+* Only the pairs across slab edges (and, on process 0, the other pairs) can have a node in another process's
+* slabs. Each such pair goes to the owner of each of its nodes, once, so that every process then has the
+* contributions of every pair of each of its own nodes.
+*/
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::ExchangePairContributions(NodeBasedCellPopulation<DIM>& rPopulation)
+{
+    unsigned rank = mpTransport->GetRank();
+    unsigned numProcesses = mpTransport->GetNumProcesses();
+    std::vector< std::pair<Node<DIM>*, Node<DIM>* > >& r_node_pairs = rPopulation.rGetNodePairs();
+    unsigned valuesPerPair = 2 + 2*DIM + 2;
+
+    mOutgoing.assign(numProcesses, std::vector<double>());
+    for (unsigned list = 0; list < mPairLists.size(); list++)
+    {
+        const std::vector<unsigned>& r_pairs = *mPairLists[list];
+        for (unsigned i = 0; i < r_pairs.size(); i++)
         {
-            // Calculate the force between nodes and check it isn't nan. Uses the parent method CalculateForceBetweenNodes
-            c_vector<double, DIM> force = this->CalculateForceBetweenNodes(p_node_a->GetIndex(), p_node_b->GetIndex(), rCellPopulation);
-            c_vector<double, DIM> negative_force = -1.0 * force;
+            unsigned owner_a = GetProcessOfNode(r_node_pairs[r_pairs[i]].first->GetIndex());
+            unsigned owner_b = GetProcessOfNode(r_node_pairs[r_pairs[i]].second->GetIndex());
+            if (owner_a != rank)
+            {
+                PackPair(r_pairs[i], mOutgoing[owner_a]);
+            }
+            if (owner_b != rank && owner_b != owner_a)
+            {
+                PackPair(r_pairs[i], mOutgoing[owner_b]);
+            }
+        }
+    }
+
+    mIncoming.resize(1);
+    for (unsigned other = 0; other < numProcesses; other++)
+    {
+        if (other == rank)
+        {
+            continue;
+        }
+        mpTransport->Exchange(other, mOutgoing[other], mIncoming[0]);
+        for (unsigned start = 0; start + valuesPerPair <= mIncoming[0].size(); start += valuesPerPair)
+        {
+            PairContribution& r_contribution = mPairContributions[(unsigned)mIncoming[0][start]];
+            r_contribution.overlap = (mIncoming[0][start + 1] != 0.0);
             for (unsigned j=0; j<DIM; j++)
             {
-                assert(!std::isnan(force[j]));
+                r_contribution.forceA[j] = mIncoming[0][start + 2 + j];
+                r_contribution.forceB[j] = mIncoming[0][start + 2 + DIM + j];
             }
+            r_contribution.capA = mIncoming[0][start + 2 + 2*DIM];
+            r_contribution.capB = mIncoming[0][start + 3 + 2*DIM];
+        }
+    }
+}
+
+
+/*
+* Every node's total has been worked out by the process that owns it. Each process sends the totals of its own
+* nodes to every other, which take them in place of their own.
+*/
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::ExchangeForces(NodeBasedCellPopulation<DIM>& rPopulation)
+{
+    unsigned rank = mpTransport->GetRank();
+    unsigned numProcesses = mpTransport->GetNumProcesses();
+    unsigned valuesPerNode = 1 + DIM + (mEstimateVolumes ? 1 : 0);
 
-            // Add the force contribution to each node CORRECTED BY CELL RADIUS
-            // AS A PROPORTION OF THE NORMAL CHASTE CELL RADIUS (5 microns) 
+    mOutgoing.resize(numProcesses);
+    mOutgoing[rank].clear();
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rPopulation.Begin();
+        cell_iter != rPopulation.End(); ++cell_iter)
+    {
+        unsigned index = rPopulation.GetLocationIndexUsingCell(*cell_iter);
+        if (GetProcessOfNode(index) == rank)
+        {
+            PackNode(rPopulation.GetNode(index), mOutgoing[rank]);
+        }
+    }
+    mpTransport->AllGather(mOutgoing[rank], mIncoming);
+    for (unsigned other = 0; other < numProcesses; other++)
+    {
+        if (other == rank)
+        {
+            continue;
+        }
+        for (unsigned start = 0; start + valuesPerNode <= mIncoming[other].size(); start += valuesPerNode)
+        {
+            Node<DIM>* p_node = rPopulation.GetNode((unsigned)mIncoming[other][start]);
+            c_vector<double, DIM> force;
             for (unsigned j=0; j<DIM; j++)
             {
-                force[j]         =force[j]/(node_a_radius/5.0);
-                negative_force[j]=negative_force[j]/(node_b_radius/5.0);
+                force[j] = mIncoming[other][start + 1 + j];
+            }
+            p_node->ClearAppliedForce();
+            p_node->AddAppliedForceContribution(force);
+            if (mEstimateVolumes)
+            {
+                mVolumeEstimator.SetVolumeGivenUp(p_node->GetIndex(), mIncoming[other][start + 1 + DIM]);
             }
-            p_node_a->AddAppliedForceContribution(force);
-            p_node_b->AddAppliedForceContribution(negative_force);
         }
     }
 }
 
 
-//Output parameters to log file. Nothing to add here.
+//Setter and getter for mpTransport
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::SetTransport(boost::shared_ptr<AbstractSlabTransport> pTransport)
+{
+    mpTransport = pTransport;
+}
+template<unsigned DIM>
+boost::shared_ptr<AbstractSlabTransport> RepulsionForceSizeCorrected<DIM>::GetTransport() const
+{
+    return mpTransport;
+}
+
+
+//Setter and getter for mNumArms
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::SetNumArms(unsigned numArms)
+{
+    mNumArms = (numArms > 0) ? numArms : 1;
+}
+template<unsigned DIM>
+unsigned RepulsionForceSizeCorrected<DIM>::GetNumArms() const
+{
+    return mNumArms;
+}
+
+
+//Setter and getter for mEstimateVolumes
+template<unsigned DIM>
+void RepulsionForceSizeCorrected<DIM>::SetEstimateVolumes(bool estimateVolumes)
+{
+    mEstimateVolumes = estimateVolumes;
+}
+template<unsigned DIM>
+bool RepulsionForceSizeCorrected<DIM>::GetEstimateVolumes() const
+{
+    return mEstimateVolumes;
+}
+
+
+//Output parameters to log file
 template<unsigned DIM>
 void RepulsionForceSizeCorrected<DIM>::OutputForceParameters(out_stream& rParamsFile)
 {
+    *rParamsFile << "\t\t\t<EstimateVolumes>" << mEstimateVolumes << "</EstimateVolumes>\n";
+    *rParamsFile << "\t\t\t<NumArms>" << mNumArms << "</NumArms>\n";
+    *rParamsFile << "\t\t\t<NumSlabs>" << (mpSlabs ? mpSlabs->GetNumSlabs() : 1) << "</NumSlabs>\n";
+
     // Call direct parent class
     GeneralisedLinearSpringForce<DIM>::OutputForceParameters(rParamsFile);
 }
@@ -38,6 +38,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "GeneralisedLinearSpringForce.hpp"
 #include "NodeBasedCellPopulation.hpp"
+#include "OverlapVolumeEstimator.hpp"
+#include "ArcLengthSlabs.hpp"
+#include "AbstractSlabTransport.hpp"
+#include <boost/shared_ptr.hpp>
 
 /**
 * A two-body repulsion force law, designed for use in node-based simulations.
@@ -46,6 +50,25 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 * This is a modification of the GeneralisedLinearSpringForce class. The main change is that the force 
 * experienced by a cell is scaled linearly downward proportional to its radius, to account for the 
 * different drag forces experienced by cells of different sizes.
+*
+* Optionally, the force also estimates each cell's compressed volume from the overlaps it visits (see
+* OverlapVolumeEstimator) and records it as the "volume" cell data, which contact inhibition then uses in place
+* of the volume from a VolumeTrackingModifier. The volumes are those of the cells at the start of the timestep,
+* i.e. before this timestep's movement.
+*
+* In a gonad with more than one arm (see SetNumArms), the pairs of cells within each arm, and the few pairs with
+* a cell in each of two arms, are worked out as separate tasks on the GermlineThreadPool. Alternatively the pairs
+* can be split between slabs along the gonad (see SetSlabs and ArcLengthSlabs): the pairs within each slab, those
+* across each slab edge, and any others. Either way each task only works out what each of its pairs adds to the
+* forces (and overlap volumes) of its two cells. Each cell's contributions are then added up on its own, in
+* order of pair, as the single threaded loop adds them, so the results are exactly the same however the pairs
+* were split up and however many threads there are.
+*
+* The slabs can also be shared out between processes (see SetTransport), each of which runs the whole
+* simulation but only works out the pairs of its own slabs, and of the edge above each. A process sends the
+* contributions of its pairs to the owners of the pairs' cells in other processes' slabs; each process then adds
+* up the total forces (and overlap volumes) of its own cells and sends them to all the others, so every process
+* moves every cell the same way, and as a single process would.
 */
 
 template<unsigned DIM>
@@ -65,8 +88,84 @@ private :
     void serialize(Archive & archive, const unsigned int version)
     {
         archive & boost::serialization::base_object<GeneralisedLinearSpringForce<DIM> >(*this);
+        archive & mEstimateVolumes;
+        archive & mNumArms;
     }
 
+    //Whether to record each cell's estimated volume
+    bool mEstimateVolumes;
+
+    //Overlaps found during the last force calculation
+    OverlapVolumeEstimator mVolumeEstimator;
+
+    //What a pair of nodes adds to the force on each node and, if volumes are estimated, to the volume each gives
+    //up, if they overlap
+    struct PairContribution
+    {
+        bool overlap;
+        c_vector<double, DIM> forceA;
+        c_vector<double, DIM> forceB;
+        double capA;
+        double capB;
+    };
+
+    //Working space for splitting the pairs up: each pair's contribution, by pair index, and the indices of each
+    //node's pairs, in order, from mNodePairIndices[mNodePairStarts[node]] up to that of the next node
+    std::vector<PairContribution> mPairContributions;
+    std::vector<unsigned> mNodePairStarts;
+    std::vector<unsigned> mNodePairIndices;
+
+    //Number of arms of the gonad, and working space for splitting the node pairs between them: the indices of
+    //the pairs within each arm, then of the pairs across arms, and each node's arm
+    unsigned mNumArms;
+    std::vector<std::vector<unsigned> > mArmPairIndices;
+    std::vector<double> mArmOfNode;
+
+    //Slabs along the gonad to split the pairs between, if set, and working space: the indices of the pairs
+    //within each slab, across each slab edge, and any others, and the lists given to each set of tasks
+    boost::shared_ptr<ArcLengthSlabs<DIM> > mpSlabs;
+    std::vector<std::vector<unsigned> > mSlabPairIndices;
+    std::vector<std::vector<unsigned> > mEdgePairIndices;
+    std::vector<unsigned> mOtherPairIndices;
+    std::vector<const std::vector<unsigned>*> mPairLists;
+
+    //Processes to share the slabs out between, if set, and working space: the messages to and from each process
+    boost::shared_ptr<AbstractSlabTransport> mpTransport;
+    std::vector<std::vector<double> > mOutgoing;
+    std::vector<std::vector<double> > mIncoming;
+
+    //Whether the slabs are shared out between more than one process
+    bool IsDistributed() const;
+
+    //Process that owns a node's slab
+    unsigned GetProcessOfNode(unsigned nodeIndex) const;
+
+    //Adds a node's force, and overlap volume if volumes are estimated, to a message
+    void PackNode(Node<DIM>* pNode, std::vector<double>& rMessage) const;
+
+    //Adds a pair's index and contribution to a message
+    void PackPair(unsigned pairIndex, std::vector<double>& rMessage) const;
+
+    //Sends the contributions of this process's pairs to the owners of their nodes in other processes' slabs,
+    //and takes those sent to it
+    void ExchangePairContributions(NodeBasedCellPopulation<DIM>& rPopulation);
+
+    //Gives every process the total forces on this process's cells, and takes theirs
+    void ExchangeForces(NodeBasedCellPopulation<DIM>& rPopulation);
+
+    //Sorts the node pairs into those within each arm and those across arms
+    void SplitPairsByArm(NodeBasedCellPopulation<DIM>& rPopulation);
+
+    //Fills mNodePairStarts and mNodePairIndices from the population's node pairs
+    void IndexPairsByNode(NodeBasedCellPopulation<DIM>& rPopulation);
+
+    //Works out what one pair of nodes adds to each node's force and volume given up
+    void CalculatePairContribution(const std::pair<Node<DIM>*, Node<DIM>* >& rPair, NodeBasedCellPopulation<DIM>& rPopulation,
+                                   PairContribution& rContribution);
+
+    //Adds the force between one pair of nodes, if they overlap
+    void AddPairForce(std::pair<Node<DIM>*, Node<DIM>* >& rPair, NodeBasedCellPopulation<DIM>& rPopulation);
+
 public :
 
     /**
@@ -81,9 +180,75 @@ public :
      */
     void AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation);
 
+    /**
+     * Works out what some of the population's pairs of nodes add to the forces on their nodes, without adding
+     * them or timing it, so that the pairs can be shared out between threads.
+     *
+     * @param rCellPopulation reference to the CellPopulation, which must be a NodeBasedCellPopulation
+     * @param rPairIndices indices into the population's node pairs
+     */
+    void CalculatePairContributions(AbstractCellPopulation<DIM>& rCellPopulation, const std::vector<unsigned>& rPairIndices);
+
+    /**
+     * Adds the contributions of each node's pairs to its force (and volume given up), in order of pair, for a
+     * range of node indices, so that the nodes can be shared out between threads. Split across processes, only
+     * this process's nodes are done.
+     *
+     * @param rCellPopulation reference to the CellPopulation, which must be a NodeBasedCellPopulation
+     * @param firstNode the first node index
+     * @param endNode one past the last node index
+     */
+    void SumPairContributions(AbstractCellPopulation<DIM>& rCellPopulation, unsigned firstNode, unsigned endNode);
+
+    /**
+     * Sets the number of arms of the gonad, read from each cell's "Arm" cell data. With more than one, the
+     * arms' forces are calculated in parallel. One by default.
+     *
+     * @param numArms the number of arms
+     */
+    void SetNumArms(unsigned numArms);
+
+    //Getter for mNumArms
+    unsigned GetNumArms() const;
+
+    /**
+     * Sets slabs along the gonad to share the force calculation out between, on the GermlineThreadPool. The
+     * force updates the slabs each time it is calculated, and takes precedence over splitting by arm. Not
+     * archived.
+     *
+     * @param pSlabs the slabs
+     */
+    void SetSlabs(boost::shared_ptr<ArcLengthSlabs<DIM> > pSlabs);
+
+    //Getter for mpSlabs
+    boost::shared_ptr<ArcLengthSlabs<DIM> > GetSlabs() const;
+
+    /**
+     * Sets processes to share the slabs' force calculations out between. Only used with more than one slab, and
+     * at least as many slabs as processes. Every process must hold the same cells, in the same places, at the
+     * start of each timestep, and ends it holding the same total forces on every cell. Not archived.
+     *
+     * @param pTransport carries the forces between the processes
+     */
+    void SetTransport(boost::shared_ptr<AbstractSlabTransport> pTransport);
+
+    //Getter for mpTransport
+    boost::shared_ptr<AbstractSlabTransport> GetTransport() const;
+
+    /**
+     * Sets whether to record each cell's estimated compressed volume as its "volume" cell data, every time the
+     * force is calculated. Off by default.
+     *
+     * @param estimateVolumes whether to estimate volumes
+     */
+    void SetEstimateVolumes(bool estimateVolumes);
+
+    //Getter for mEstimateVolumes
+    bool GetEstimateVolumes() const;
+
     /**
      * Outputs force Parameters to file
-     * Nothing to add here over and above the parameters that exist in the parent class.
+     * Adds whether volumes are estimated to the parameters that exist in the parent class.
      *
      * @param rParamsFile the file stream to which the parameters are output
      */
@@ -0,0 +1,109 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "AbstractSlabTransport.hpp"
+#include "Exception.hpp"
+
+
+//Constructor
+AbstractSlabTransport::AbstractSlabTransport()
+    : mRank(0),
+      mNumProcesses(1)
+{
+}
+
+
+//Empty destructor
+AbstractSlabTransport::~AbstractSlabTransport()
+{
+}
+
+
+//Nothing to finish by default
+void AbstractSlabTransport::Finish()
+{
+}
+
+
+//The lower numbered process sends first
+void AbstractSlabTransport::Exchange(unsigned otherRank, const std::vector<double>& rSend, std::vector<double>& rReceived)
+{
+    if (otherRank == mRank || otherRank >= mNumProcesses){
+        EXCEPTION("Process " << mRank << " cannot exchange messages with process " << otherRank << ".");
+    }
+    if (mRank < otherRank){
+        Send(otherRank, rSend);
+        Receive(otherRank, rReceived);
+    }else{
+        Receive(otherRank, rReceived);
+        Send(otherRank, rSend);
+    }
+}
+
+
+//Every process exchanges with the others in increasing order, so each pair meets without a cycle of waits
+void AbstractSlabTransport::AllGather(const std::vector<double>& rMine, std::vector<std::vector<double> >& rAll)
+{
+    rAll.resize(mNumProcesses);
+    for (unsigned rank = 0; rank < mNumProcesses; rank++){
+        if (rank == mRank){
+            rAll[rank] = rMine;
+        }else{
+            Exchange(rank, rMine, rAll[rank]);
+        }
+    }
+}
+
+
+//Consecutive blocks of slabs
+unsigned AbstractSlabTransport::GetProcessOfSlab(unsigned slab, unsigned numSlabs) const
+{
+    if (slab >= numSlabs){
+        return 0;
+    }
+    return (slab*mNumProcesses)/numSlabs;
+}
+
+
+//Getters
+unsigned AbstractSlabTransport::GetRank() const
+{
+    return mRank;
+}
+
+unsigned AbstractSlabTransport::GetNumProcesses() const
+{
+    return mNumProcesses;
+}
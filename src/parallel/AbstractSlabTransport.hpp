@@ -0,0 +1,135 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ABSTRACTSLABTRANSPORT_HPP_
+#define ABSTRACTSLABTRANSPORT_HPP_
+
+#include <vector>
+
+/*
+* Carries messages between the processes a germline simulation's force is worked out by, so that the arc length
+* slabs (see ArcLengthSlabs) can be shared out between processes as well as threads. Only the force is split:
+* each process holds the whole population and runs the whole simulation from the same starting state, and
+* owns a consecutive block of slabs only for the force. It works out what the pairs within its slabs and across
+* the edge above each add to the forces on their cells, sends those on other processes' cells to their owners,
+* and every owner sends its cells' totals to every process (see RepulsionForceSizeCorrected::SetTransport).
+* Every process therefore moves its cells identically. All other work, and the memory, is replicated.
+*
+* This is not yet a decomposition of the gonad between processes. That would need each process to hold only
+* its own slabs' cells, with halos of the neighbouring slabs' cells for the force, the boundary condition and
+* the statecharts, and cells handed between processes as they cross slab edges. It is still to be done.
+*
+* Messages are vectors of doubles, sent between two processes at a time. Subclasses provide the sending and
+* receiving: SocketSlabTransport over UNIX sockets between processes forked on one machine, and
+* MpiSlabTransport over MPI on a cluster.
+*/
+class AbstractSlabTransport
+{
+protected:
+
+    //This process's number, from 0, and the number of processes
+    unsigned mRank;
+    unsigned mNumProcesses;
+
+public:
+
+    //Constructor. A single process until a subclass says otherwise.
+    AbstractSlabTransport();
+
+    virtual ~AbstractSlabTransport();
+
+
+    /**
+    * Sends a message to another process. May wait until that process receives it.
+    *
+    * @param toRank the process to send to
+    * @param rData the message
+    */
+    virtual void Send(unsigned toRank, const std::vector<double>& rData) = 0;
+
+
+    /**
+    * Waits for the next message from another process.
+    *
+    * @param fromRank the process to receive from
+    * @param rData filled with the message
+    */
+    virtual void Receive(unsigned fromRank, std::vector<double>& rData) = 0;
+
+
+    /**
+    * Called by every process once the simulation is over. By default does nothing.
+    */
+    virtual void Finish();
+
+
+    /**
+    * Sends a message to another process and receives one back. The lower numbered process sends first, so
+    * two processes exchanging with each other never both wait to send.
+    *
+    * @param otherRank the other process
+    * @param rSend the message to send
+    * @param rReceived filled with the message received
+    */
+    void Exchange(unsigned otherRank, const std::vector<double>& rSend, std::vector<double>& rReceived);
+
+
+    /**
+    * Gives every process every process's message. Processes exchange in order of their numbers, so every
+    * process must call this at the same point.
+    *
+    * @param rMine this process's message
+    * @param rAll filled with each process's message, by process number, including this one's
+    */
+    void AllGather(const std::vector<double>& rMine, std::vector<std::vector<double> >& rAll);
+
+
+    /**
+    * @return the process that owns a slab: the slabs are split into consecutive blocks, one per process.
+    * Slabs at or beyond the number of slabs (cells the slabs did not hold) belong to process 0.
+    *
+    * @param slab the slab
+    * @param numSlabs the number of slabs
+    */
+    unsigned GetProcessOfSlab(unsigned slab, unsigned numSlabs) const;
+
+
+    //Getters
+    unsigned GetRank() const;
+    unsigned GetNumProcesses() const;
+
+};
+
+#endif /*ABSTRACTSLABTRANSPORT_HPP_*/
@@ -0,0 +1,206 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ArcLengthSlabs.hpp"
+#include "Exception.hpp"
+#include "SimulationTime.hpp"
+
+#include <algorithm>
+
+
+//Constructor. No edges until the first Update().
+template<unsigned DIM>
+ArcLengthSlabs<DIM>::ArcLengthSlabs(unsigned numSlabs, double imbalanceTolerance)
+    : mNumSlabs(numSlabs),
+      mImbalanceTolerance(imbalanceTolerance),
+      mNumRebalances(0),
+      mTimeStepOfUpdate(0)
+{
+    if (numSlabs == 0){
+        EXCEPTION("There must be at least one slab.");
+    }
+    mSlabSizes.assign(mNumSlabs, 0);
+}
+
+
+//Reads every cell's distance, then sorts the cells into slabs, rebalancing if they are uneven
+template<unsigned DIM>
+void ArcLengthSlabs<DIM>::Update(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    static const std::string distanceKey("DistanceAwayFromDTC");
+
+    mDistances.clear();
+    mNodeIndices.clear();
+    unsigned maxNodeIndex = 0;
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+        cell_iter != rCellPopulation.End(); ++cell_iter)
+    {
+        unsigned nodeIndex = rCellPopulation.GetLocationIndexUsingCell(*cell_iter);
+        mDistances.push_back(cell_iter->GetCellData()->GetItem(distanceKey));
+        mNodeIndices.push_back(nodeIndex);
+        maxNodeIndex = std::max(maxNodeIndex, nodeIndex);
+    }
+    mSlabOfNode.assign(maxNodeIndex + 1, mNumSlabs);
+
+    if (mEdges.size() + 1 != mNumSlabs){
+        Rebalance();
+    }
+    AssignSlabs();
+
+    //Move the edges if the largest slab has grown too far beyond the mean
+    unsigned largest = *std::max_element(mSlabSizes.begin(), mSlabSizes.end());
+    double mean = (double)mDistances.size()/mNumSlabs;
+    if (largest > (1.0 + mImbalanceTolerance)*mean + 1.0){
+        Rebalance();
+        AssignSlabs();
+    }
+    mTimeStepOfUpdate = SimulationTime::Instance()->GetTimeStepsElapsed();
+}
+
+
+//A cell on an edge goes in the lower slab
+template<unsigned DIM>
+void ArcLengthSlabs<DIM>::AssignSlabs()
+{
+    mSlabSizes.assign(mNumSlabs, 0);
+    for (unsigned i = 0; i < mDistances.size(); i++){
+        unsigned slab = std::lower_bound(mEdges.begin(), mEdges.end(), mDistances[i]) - mEdges.begin();
+        mSlabOfNode[mNodeIndices[i]] = slab;
+        mSlabSizes[slab]++;
+    }
+}
+
+
+//Each edge is the distance of the cell that many cells from the DTC, found by partial sorting. Cells at
+//the same distance cannot be split, so with few distinct distances the slabs can stay uneven.
+template<unsigned DIM>
+void ArcLengthSlabs<DIM>::Rebalance()
+{
+    std::vector<double> sorted(mDistances);
+    mEdges.assign(mNumSlabs - 1, 0.0);
+    for (unsigned edge = 0; edge + 1 < mNumSlabs && !sorted.empty(); edge++){
+        unsigned rank = (unsigned)(((edge + 1)*(double)sorted.size())/mNumSlabs);
+        rank = std::min(rank, (unsigned)sorted.size() - 1);
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+        mEdges[edge] = sorted[rank];
+    }
+    std::sort(mEdges.begin(), mEdges.end());
+    mNumRebalances++;
+}
+
+
+//Slab of a node at the last Update
+template<unsigned DIM>
+unsigned ArcLengthSlabs<DIM>::GetSlabOfNode(unsigned nodeIndex) const
+{
+    if (nodeIndex >= mSlabOfNode.size()){
+        return mNumSlabs;
+    }
+    return mSlabOfNode[nodeIndex];
+}
+
+
+//Within a slab, across an edge between neighbouring slabs, or anything else
+template<unsigned DIM>
+void ArcLengthSlabs<DIM>::SplitPairs(const std::vector<std::pair<Node<DIM>*, Node<DIM>*> >& rNodePairs,
+                                     std::vector<std::vector<unsigned> >& rWithinSlabs,
+                                     std::vector<std::vector<unsigned> >& rAcrossEdges,
+                                     std::vector<unsigned>& rOthers) const
+{
+    rWithinSlabs.resize(mNumSlabs);
+    for (unsigned slab = 0; slab < mNumSlabs; slab++){
+        rWithinSlabs[slab].clear();
+    }
+    rAcrossEdges.resize(mNumSlabs - 1);
+    for (unsigned edge = 0; edge + 1 < mNumSlabs; edge++){
+        rAcrossEdges[edge].clear();
+    }
+    rOthers.clear();
+
+    for (unsigned i = 0; i < rNodePairs.size(); i++){
+        unsigned slab_a = GetSlabOfNode(rNodePairs[i].first->GetIndex());
+        unsigned slab_b = GetSlabOfNode(rNodePairs[i].second->GetIndex());
+        if (slab_a >= mNumSlabs || slab_b >= mNumSlabs){
+            rOthers.push_back(i);
+        }else if (slab_a == slab_b){
+            rWithinSlabs[slab_a].push_back(i);
+        }else if (slab_a + 1 == slab_b || slab_b + 1 == slab_a){
+            rAcrossEdges[std::min(slab_a, slab_b)].push_back(i);
+        }else{
+            rOthers.push_back(i);
+        }
+    }
+}
+
+
+//Getters
+template<unsigned DIM>
+unsigned ArcLengthSlabs<DIM>::GetNumSlabs() const
+{
+    return mNumSlabs;
+}
+
+template<unsigned DIM>
+const std::vector<double>& ArcLengthSlabs<DIM>::rGetEdges() const
+{
+    return mEdges;
+}
+
+template<unsigned DIM>
+const std::vector<unsigned>& ArcLengthSlabs<DIM>::rGetSlabSizes() const
+{
+    return mSlabSizes;
+}
+
+template<unsigned DIM>
+unsigned ArcLengthSlabs<DIM>::GetNumRebalances() const
+{
+    return mNumRebalances;
+}
+
+template<unsigned DIM>
+unsigned ArcLengthSlabs<DIM>::GetTimeStepOfUpdate() const
+{
+    return mTimeStepOfUpdate;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class ArcLengthSlabs<1>;
+template class ArcLengthSlabs<2>;
+template class ArcLengthSlabs<3>;
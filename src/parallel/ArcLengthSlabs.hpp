@@ -0,0 +1,149 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ARCLENGTHSLABS_HPP_
+#define ARCLENGTHSLABS_HPP_
+
+#include <vector>
+#include <utility>
+#include "AbstractCellPopulation.hpp"
+#include "Node.hpp"
+
+/*
+* Splits the cells of a gonad into slabs along its length, by their "DistanceAwayFromDTC" cell data, so that
+* the mechanics and statechart updates of each slab can be done on a separate thread (see GermlineThreadPool).
+* The gonad is a long, narrow tube, so slabs of equal numbers of cells are compact and only touch their
+* neighbours: the pairs of cells that interact across a slab edge (the halo) are few.
+*
+* The slab edges are distances from the DTC. Update() sorts the cells into slabs by the current edges, and
+* moves the edges to give every slab the same number of cells (the quantiles of the cells' distances) only if
+* the largest slab has grown more than a tolerance beyond the mean, e.g. as proliferation fills the distal end.
+* Between rebalances a cell stays in its slab until it moves past an edge.
+*
+* Node pairs are split (SplitPairs) into the pairs within each slab, those across the edge between each two
+* neighbouring slabs, and any others, so that each slab's and each edge's pairs can be worked out as a
+* separate task.
+*
+* In a gonad with two arms both arms share the slabs, since distances are measured from each arm's own DTC.
+*/
+
+template<unsigned DIM>
+class ArcLengthSlabs
+{
+private:
+
+    //Number of slabs
+    unsigned mNumSlabs;
+
+    //How far beyond the mean number of cells the largest slab may grow before the edges are moved, as a fraction
+    double mImbalanceTolerance;
+
+    //Upper distance from the DTC of each slab but the last
+    std::vector<double> mEdges;
+
+    //Slab of each node, by node index, or mNumSlabs for a node without a cell
+    std::vector<unsigned> mSlabOfNode;
+
+    //Number of cells in each slab
+    std::vector<unsigned> mSlabSizes;
+
+    //Number of times the edges have been moved, and the timestep of the last Update()
+    unsigned mNumRebalances;
+    unsigned mTimeStepOfUpdate;
+
+    //Working space: each cell's distance, and its node index
+    std::vector<double> mDistances;
+    std::vector<unsigned> mNodeIndices;
+
+    //Sorts the cells in mDistances into slabs by the current edges
+    void AssignSlabs();
+
+    //Moves the edges to the quantiles of mDistances
+    void Rebalance();
+
+public:
+
+    /**
+    * Constructor.
+    *
+    * @param numSlabs the number of slabs, at least 1
+    * @param imbalanceTolerance how far beyond the mean number of cells the largest slab may grow before the
+    *        edges are moved, as a fraction of the mean
+    */
+    ArcLengthSlabs(unsigned numSlabs, double imbalanceTolerance = 0.1);
+
+
+    /**
+    * Sorts the population's cells into slabs, moving the edges first if the slabs have become unbalanced
+    * (or on the first call). Cells need their "DistanceAwayFromDTC" cell data.
+    *
+    * @param rCellPopulation the population, whose locations are node indices
+    */
+    void Update(AbstractCellPopulation<DIM>& rCellPopulation);
+
+
+    /**
+    * @return the slab of a node at the last Update(), or the number of slabs if it had no cell then
+    *
+    * @param nodeIndex the node's index
+    */
+    unsigned GetSlabOfNode(unsigned nodeIndex) const;
+
+
+    /**
+    * Splits node pairs into the pairs within each slab, across each edge, and the rest. Each list holds
+    * indices into rNodePairs, in order.
+    *
+    * @param rNodePairs the pairs of nodes, e.g. NodeBasedCellPopulation::rGetNodePairs()
+    * @param rWithinSlabs filled with one list per slab
+    * @param rAcrossEdges filled with one list per edge, the edge between slabs i and i+1 being i
+    * @param rOthers filled with the pairs between slabs that are not neighbours, or with nodes that had no cell
+    */
+    void SplitPairs(const std::vector<std::pair<Node<DIM>*, Node<DIM>*> >& rNodePairs,
+                    std::vector<std::vector<unsigned> >& rWithinSlabs,
+                    std::vector<std::vector<unsigned> >& rAcrossEdges,
+                    std::vector<unsigned>& rOthers) const;
+
+
+    //Getters
+    unsigned GetNumSlabs() const;
+    const std::vector<double>& rGetEdges() const;
+    const std::vector<unsigned>& rGetSlabSizes() const;
+    unsigned GetNumRebalances() const;
+    unsigned GetTimeStepOfUpdate() const;
+
+};
+
+#endif /*ARCLENGTHSLABS_HPP_*/
@@ -0,0 +1,240 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GermlineThreadPool.hpp"
+#include "Exception.hpp"
+
+#include <exception>
+
+
+//A pointer to the single thread pool instance. Initially null.
+GermlineThreadPool* GermlineThreadPool::mpInstance = NULL;
+
+
+//For retrieving a pointer to the current thread pool
+GermlineThreadPool* GermlineThreadPool::Instance()
+{
+    if (mpInstance == NULL){
+        mpInstance = new GermlineThreadPool();
+    }
+    return mpInstance;
+}
+
+
+//Deletes the thread pool
+void GermlineThreadPool::Destroy()
+{
+    delete mpInstance;
+    mpInstance = NULL;
+}
+
+
+//Protected constructor. There are no background threads until SetNumThreads asks for them.
+GermlineThreadPool::GermlineThreadPool()
+    : mNumThreads(1),
+      mpTask(NULL),
+      mNumTasks(0),
+      mNextTask(0),
+      mNumTasksDone(0),
+      mGeneration(0),
+      mStopping(false)
+{
+    pthread_mutex_init(&mMutex, NULL);
+    pthread_cond_init(&mWorkAvailable, NULL);
+    pthread_cond_init(&mWorkDone, NULL);
+}
+
+
+//Destructor
+GermlineThreadPool::~GermlineThreadPool()
+{
+    StopThreads();
+    pthread_cond_destroy(&mWorkDone);
+    pthread_cond_destroy(&mWorkAvailable);
+    pthread_mutex_destroy(&mMutex);
+}
+
+
+//Nothing to do if the number is unchanged
+void GermlineThreadPool::SetNumThreads(unsigned numThreads)
+{
+    if (numThreads == 0){
+        numThreads = 1;
+    }
+    if (numThreads == mNumThreads){
+        return;
+    }
+    StopThreads();
+    StartThreads(numThreads);
+}
+
+
+//Starts the background threads. If one fails to start, the pool makes do with those that did.
+void GermlineThreadPool::StartThreads(unsigned numThreads)
+{
+    mStopping = false;
+    for (unsigned i = 1; i < numThreads; i++){
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, RunWorkerThread, this) != 0){
+            break;
+        }
+        mThreads.push_back(thread);
+    }
+    mNumThreads = mThreads.size() + 1;
+}
+
+
+//Wakes the background threads to tell them to stop, and waits for them to
+void GermlineThreadPool::StopThreads()
+{
+    pthread_mutex_lock(&mMutex);
+    mStopping = true;
+    pthread_cond_broadcast(&mWorkAvailable);
+    pthread_mutex_unlock(&mMutex);
+    for (unsigned i = 0; i < mThreads.size(); i++){
+        pthread_join(mThreads[i], NULL);
+    }
+    mThreads.clear();
+    mNumThreads = 1;
+}
+
+
+//Getter
+unsigned GermlineThreadPool::GetNumThreads() const
+{
+    return mNumThreads;
+}
+
+
+//With one thread or one task there is no one to share with
+void GermlineThreadPool::Run(AbstractParallelTask& rTask, unsigned numTasks)
+{
+    if (mNumThreads == 1 || numTasks <= 1){
+        for (unsigned i = 0; i < numTasks; i++){
+            rTask.RunTask(i);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&mMutex);
+    mpTask = &rTask;
+    mNumTasks = numTasks;
+    mNextTask = 0;
+    mNumTasksDone = 0;
+    mError.clear();
+    mGeneration++;
+    pthread_cond_broadcast(&mWorkAvailable);
+    pthread_mutex_unlock(&mMutex);
+
+    RunTasks();
+
+    pthread_mutex_lock(&mMutex);
+    while (mNumTasksDone < mNumTasks){
+        pthread_cond_wait(&mWorkDone, &mMutex);
+    }
+    mpTask = NULL;
+    std::string error = mError;
+    pthread_mutex_unlock(&mMutex);
+
+    if (!error.empty()){
+        EXCEPTION(error);
+    }
+}
+
+
+//Takes the next task until there are none left. Errors are kept for Run() to report.
+void GermlineThreadPool::RunTasks()
+{
+    while (true){
+        pthread_mutex_lock(&mMutex);
+        if (mpTask == NULL || mNextTask >= mNumTasks){
+            pthread_mutex_unlock(&mMutex);
+            return;
+        }
+        AbstractParallelTask* p_task = mpTask;
+        unsigned taskIndex = mNextTask++;
+        pthread_mutex_unlock(&mMutex);
+
+        std::string error;
+        try{
+            p_task->RunTask(taskIndex);
+        }
+        catch (Exception& e){
+            error = e.GetShortMessage();
+        }
+        catch (std::exception& e){
+            error = e.what();
+        }
+
+        pthread_mutex_lock(&mMutex);
+        if (!error.empty() && mError.empty()){
+            mError = error;
+        }
+        mNumTasksDone++;
+        if (mNumTasksDone == mNumTasks){
+            pthread_cond_broadcast(&mWorkDone);
+        }
+        pthread_mutex_unlock(&mMutex);
+    }
+}
+
+
+//Entry point of the background threads
+void* GermlineThreadPool::RunWorkerThread(void* pPool)
+{
+    static_cast<GermlineThreadPool*>(pPool)->WorkerLoop();
+    return NULL;
+}
+
+
+//Waits for each new piece of work, and helps with it
+void GermlineThreadPool::WorkerLoop()
+{
+    pthread_mutex_lock(&mMutex);
+    unsigned generationSeen = mGeneration;
+    while (true){
+        while (!mStopping && mGeneration == generationSeen){
+            pthread_cond_wait(&mWorkAvailable, &mMutex);
+        }
+        if (mStopping){
+            break;
+        }
+        generationSeen = mGeneration;
+        pthread_mutex_unlock(&mMutex);
+        RunTasks();
+        pthread_mutex_lock(&mMutex);
+    }
+    pthread_mutex_unlock(&mMutex);
+}
@@ -0,0 +1,154 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GERMLINETHREADPOOL_HPP_
+#define GERMLINETHREADPOOL_HPP_
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+/*
+* A piece of work that can be split into numbered tasks, run in any order and on any thread. Tasks must not
+* touch the same data, other than to read it.
+*/
+class AbstractParallelTask
+{
+public:
+
+    virtual ~AbstractParallelTask()
+    {
+    }
+
+
+    /**
+    * Runs one task.
+    *
+    * @param taskIndex the number of the task, from 0 to one less than the number of tasks
+    */
+    virtual void RunTask(unsigned taskIndex) = 0;
+
+};
+
+
+/*
+* A fixed set of threads that the parts of a timestep can share out their work over, e.g. the force and
+* boundary condition of each arm of a two arm gonad. The thread that calls Run() works on the tasks too, so
+* a pool of N threads starts N-1 background threads, and a pool of one thread runs every task in turn on the
+* calling thread, exactly as if there were no pool.
+*
+* The threads wait between calls to Run(), rather than being started every timestep. An Exception thrown by a
+* task is passed back to the caller of Run(), once every task has finished.
+*
+* Profiling timers (see ScopedProfileTimer) are not thread safe, so tasks must not contain any: the work is
+* timed as part of the phase that calls Run().
+*/
+class GermlineThreadPool
+{
+private:
+
+    //A pointer to the singleton instance of this class
+    static GermlineThreadPool* mpInstance;
+
+    //Number of threads, including the caller of Run(), and the background threads
+    unsigned mNumThreads;
+    std::vector<pthread_t> mThreads;
+
+    //State shared with the background threads, guarded by mMutex: the current work, the next task to start,
+    //the number of tasks finished, a count of calls to Run() so threads can tell new work from old, whether
+    //the threads should stop, and the first error a task threw
+    pthread_mutex_t mMutex;
+    pthread_cond_t mWorkAvailable;
+    pthread_cond_t mWorkDone;
+    AbstractParallelTask* mpTask;
+    unsigned mNumTasks;
+    unsigned mNextTask;
+    unsigned mNumTasksDone;
+    unsigned mGeneration;
+    bool mStopping;
+    std::string mError;
+
+    //Protected constructor. Use Instance().
+    GermlineThreadPool();
+
+    //Destructor. Stops the background threads.
+    ~GermlineThreadPool();
+
+    //Entry point and loop of the background threads
+    static void* RunWorkerThread(void* pPool);
+    void WorkerLoop();
+
+    //Runs tasks of the current work until none are left to start
+    void RunTasks();
+
+    //Starts or stops background threads
+    void StartThreads(unsigned numThreads);
+    void StopThreads();
+
+public:
+
+    //For retrieving a pointer to the single instance of the class
+    static GermlineThreadPool* Instance();
+
+
+    //Deletes the single instance, stopping its threads
+    static void Destroy();
+
+
+    /**
+    * Sets the number of threads, starting or stopping background threads to match. Must not be called while
+    * Run() is running.
+    *
+    * @param numThreads the number of threads, including the caller of Run(). 0 is taken as 1.
+    */
+    void SetNumThreads(unsigned numThreads);
+
+
+    //Number of threads, including the caller of Run()
+    unsigned GetNumThreads() const;
+
+
+    /**
+    * Runs every task of a piece of work, sharing them among the threads, and returns once all have finished.
+    * Must not be called from inside a task.
+    *
+    * @param rTask the work
+    * @param numTasks the number of tasks
+    */
+    void Run(AbstractParallelTask& rTask, unsigned numTasks);
+
+};
+
+#endif /*GERMLINETHREADPOOL_HPP_*/
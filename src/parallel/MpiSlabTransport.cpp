@@ -0,0 +1,100 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MpiSlabTransport.hpp"
+#include "PetscTools.hpp"
+#include "Exception.hpp"
+
+#include <mpi.h>
+
+
+//Tag of every message. Messages between two processes arrive in the order they were sent.
+static const int SLAB_MESSAGE_TAG = 4701;
+
+
+//Takes the rank and size before isolating, since isolation hides them from the rest of Chaste
+MpiSlabTransport::MpiSlabTransport()
+{
+    int rank = 0;
+    int size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    mRank = rank;
+    mNumProcesses = size;
+    PetscTools::IsolateProcesses(true);
+}
+
+
+//Undoes the isolation
+MpiSlabTransport::~MpiSlabTransport()
+{
+    PetscTools::IsolateProcesses(false);
+}
+
+
+//An empty message still sends a (zero length) message, so every Send is matched by a Receive
+void MpiSlabTransport::Send(unsigned toRank, const std::vector<double>& rData)
+{
+    double empty = 0.0;
+    const double* p_data = rData.empty() ? &empty : &rData[0];
+    if (MPI_Send(const_cast<double*>(p_data), rData.size(), MPI_DOUBLE, toRank, SLAB_MESSAGE_TAG, MPI_COMM_WORLD) != MPI_SUCCESS){
+        EXCEPTION("Process " << mRank << " could not send to process " << toRank << ".");
+    }
+}
+
+//Probes first to find the message's length
+void MpiSlabTransport::Receive(unsigned fromRank, std::vector<double>& rData)
+{
+    MPI_Status status;
+    int count = 0;
+    if (MPI_Probe(fromRank, SLAB_MESSAGE_TAG, MPI_COMM_WORLD, &status) != MPI_SUCCESS
+        || MPI_Get_count(&status, MPI_DOUBLE, &count) != MPI_SUCCESS){
+        EXCEPTION("Process " << mRank << " could not receive from process " << fromRank << ".");
+    }
+    rData.resize(count);
+    double empty = 0.0;
+    double* p_data = rData.empty() ? &empty : &rData[0];
+    if (MPI_Recv(p_data, count, MPI_DOUBLE, fromRank, SLAB_MESSAGE_TAG, MPI_COMM_WORLD, &status) != MPI_SUCCESS){
+        EXCEPTION("Process " << mRank << " could not receive from process " << fromRank << ".");
+    }
+}
+
+
+//Every process waits here, so none goes back to collective Chaste calls while another is still isolated
+void MpiSlabTransport::Finish()
+{
+    MPI_Barrier(MPI_COMM_WORLD);
+    PetscTools::IsolateProcesses(false);
+}
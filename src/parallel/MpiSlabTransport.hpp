@@ -0,0 +1,76 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MPISLABTRANSPORT_HPP_
+#define MPISLABTRANSPORT_HPP_
+
+#include "AbstractSlabTransport.hpp"
+
+/*
+* Splits a simulation across the processes of an MPI run, e.g. on a cluster. Needs PETSc and MPI to have been
+* set up for real (PetscSetupAndFinalize.hpp rather than FakePetscSetup.hpp), and the program to have been
+* started with mpirun.
+*
+* Every process runs the whole simulation, so Chaste must not share the mesh out between them itself. The
+* constructor therefore isolates the processes (PetscTools::IsolateProcesses), so that to the rest of Chaste
+* each looks like a serial run with its own output, and messages go directly over MPI_COMM_WORLD. Finish()
+* undoes the isolation, once every process has got there.
+*/
+class MpiSlabTransport : public AbstractSlabTransport
+{
+public:
+
+    //Constructor. Takes the process number and count from MPI, then isolates the processes.
+    MpiSlabTransport();
+
+
+    //Destructor. Undoes the isolation if Finish() has not.
+    ~MpiSlabTransport();
+
+
+    //Sends a message, see AbstractSlabTransport
+    void Send(unsigned toRank, const std::vector<double>& rData);
+
+
+    //Receives a message, see AbstractSlabTransport
+    void Receive(unsigned fromRank, std::vector<double>& rData);
+
+
+    //Waits for every process, then undoes the isolation
+    void Finish();
+
+};
+
+#endif /*MPISLABTRANSPORT_HPP_*/
@@ -0,0 +1,206 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SocketSlabTransport.hpp"
+#include "Exception.hpp"
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <errno.h>
+#include <boost/cstdint.hpp>
+
+
+//Writes or reads a whole buffer, carrying on after partial transfers. False if the other end has gone.
+static bool WriteAll(int socket, const char* pData, size_t numBytes)
+{
+    while (numBytes > 0){
+        ssize_t written = write(socket, pData, numBytes);
+        if (written < 0 && errno == EINTR){
+            continue;
+        }
+        if (written <= 0){
+            return false;
+        }
+        pData += written;
+        numBytes -= written;
+    }
+    return true;
+}
+
+static bool ReadAll(int socket, char* pData, size_t numBytes)
+{
+    while (numBytes > 0){
+        ssize_t numRead = read(socket, pData, numBytes);
+        if (numRead < 0 && errno == EINTR){
+            continue;
+        }
+        if (numRead <= 0){
+            return false;
+        }
+        pData += numRead;
+        numBytes -= numRead;
+    }
+    return true;
+}
+
+
+//Makes a socket pair for every two processes, then forks. Each process keeps its own end of the pairs it is
+//in, and closes the rest.
+SocketSlabTransport::SocketSlabTransport(unsigned numProcesses)
+{
+    if (numProcesses == 0){
+        EXCEPTION("There must be at least one process.");
+    }
+    mNumProcesses = numProcesses;
+    mRank = 0;
+
+    //ends[a][b] is process a's end of the pair between a and b
+    std::vector<std::vector<int> > ends(numProcesses, std::vector<int>(numProcesses, -1));
+    for (unsigned a = 0; a < numProcesses; a++){
+        for (unsigned b = a + 1; b < numProcesses; b++){
+            int pair[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0){
+                EXCEPTION("Could not create a socket pair between processes " << a << " and " << b << ".");
+            }
+            ends[a][b] = pair[0];
+            ends[b][a] = pair[1];
+        }
+    }
+
+    for (unsigned rank = 1; rank < numProcesses; rank++){
+        pid_t pid = fork();
+        if (pid < 0){
+            EXCEPTION("Could not fork process " << rank << ".");
+        }
+        if (pid == 0){
+            mRank = rank;
+            mChildren.clear();
+            break;
+        }
+        mChildren.push_back(pid);
+    }
+
+    mSockets.assign(numProcesses, -1);
+    for (unsigned a = 0; a < numProcesses; a++){
+        for (unsigned b = 0; b < numProcesses; b++){
+            if (ends[a][b] < 0){
+                continue;
+            }
+            if (a == mRank){
+                mSockets[b] = ends[a][b];
+            }else{
+                close(ends[a][b]);
+            }
+        }
+    }
+}
+
+
+//Closes the sockets. A forked process that gets here without Finish(), e.g. after an Exception, exits as a
+//failure rather than carry on with the rest of the program.
+SocketSlabTransport::~SocketSlabTransport()
+{
+    CloseSockets();
+    if (mRank > 0){
+        _exit(1);
+    }
+}
+
+void SocketSlabTransport::CloseSockets()
+{
+    for (unsigned rank = 0; rank < mSockets.size(); rank++){
+        if (mSockets[rank] >= 0){
+            close(mSockets[rank]);
+            mSockets[rank] = -1;
+        }
+    }
+}
+
+
+//The number of doubles, then the doubles
+void SocketSlabTransport::Send(unsigned toRank, const std::vector<double>& rData)
+{
+    if (toRank >= mSockets.size() || mSockets[toRank] < 0){
+        EXCEPTION("Process " << mRank << " has no socket to process " << toRank << ".");
+    }
+    boost::uint64_t size = rData.size();
+    bool sent = WriteAll(mSockets[toRank], (const char*)&size, sizeof(size));
+    if (sent && size > 0){
+        sent = WriteAll(mSockets[toRank], (const char*)&rData[0], size*sizeof(double));
+    }
+    if (!sent){
+        EXCEPTION("Process " << mRank << " could not send to process " << toRank << ", which may have stopped.");
+    }
+}
+
+void SocketSlabTransport::Receive(unsigned fromRank, std::vector<double>& rData)
+{
+    if (fromRank >= mSockets.size() || mSockets[fromRank] < 0){
+        EXCEPTION("Process " << mRank << " has no socket to process " << fromRank << ".");
+    }
+    boost::uint64_t size = 0;
+    bool received = ReadAll(mSockets[fromRank], (char*)&size, sizeof(size));
+    if (received){
+        rData.resize(size);
+        if (size > 0){
+            received = ReadAll(mSockets[fromRank], (char*)&rData[0], size*sizeof(double));
+        }
+    }
+    if (!received){
+        EXCEPTION("Process " << mRank << " could not receive from process " << fromRank << ", which may have stopped.");
+    }
+}
+
+
+//A forked process exits without running anything else of the program that forked it
+void SocketSlabTransport::Finish()
+{
+    CloseSockets();
+    if (mRank > 0){
+        _exit(0);
+    }
+    unsigned numFailed = 0;
+    for (unsigned i = 0; i < mChildren.size(); i++){
+        int status = 0;
+        if (waitpid(mChildren[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+            numFailed++;
+        }
+    }
+    mChildren.clear();
+    if (numFailed > 0){
+        EXCEPTION(numFailed << " of the forked processes failed.");
+    }
+}
@@ -0,0 +1,95 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SOCKETSLABTRANSPORT_HPP_
+#define SOCKETSLABTRANSPORT_HPP_
+
+#include "AbstractSlabTransport.hpp"
+#include <sys/types.h>
+
+/*
+* Shares a simulation's force out between processes on one machine: the constructor forks the calling process, and the
+* processes talk over a UNIX socket pair between each two of them. A stand-in for MpiSlabTransport, so that
+* the parallel force can be run and tested without MPI.
+*
+* Each forked process carries on from the constructor with its own copy of the simulation, and must call
+* Finish() once the simulation is over: the forked processes then exit, and process 0 waits for them. A
+* message is sent as its length followed by its doubles.
+*/
+class SocketSlabTransport : public AbstractSlabTransport
+{
+private:
+
+    //Socket to each other process, by process number, or -1 for this one
+    std::vector<int> mSockets;
+
+    //Process ids of the forked processes, kept by process 0
+    std::vector<pid_t> mChildren;
+
+    //Closes every socket
+    void CloseSockets();
+
+public:
+
+    /**
+    * Constructor. Forks numProcesses - 1 further processes. Must be called before any threads are started,
+    * since a forked process only has the thread that forked it.
+    *
+    * @param numProcesses the number of processes, including this one
+    */
+    SocketSlabTransport(unsigned numProcesses);
+
+
+    //Destructor. Closes the sockets, and ends a forked process that has not called Finish().
+    ~SocketSlabTransport();
+
+
+    //Sends a message, see AbstractSlabTransport
+    void Send(unsigned toRank, const std::vector<double>& rData);
+
+
+    //Receives a message, see AbstractSlabTransport
+    void Receive(unsigned fromRank, std::vector<double>& rData);
+
+
+    /**
+    * Ends a forked process, so this never returns in one, or in process 0 waits for the forked processes to
+    * end, throwing if any of them failed.
+    */
+    void Finish();
+
+};
+
+#endif /*SOCKETSLABTRANSPORT_HPP_*/
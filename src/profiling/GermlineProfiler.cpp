@@ -0,0 +1,268 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GermlineProfiler.hpp"
+#include "Exception.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <time.h>
+
+
+//A pointer to the single profiler instance. Initially null, and off.
+GermlineProfiler* GermlineProfiler::mpInstance = NULL;
+bool GermlineProfiler::mEnabled = false;
+
+
+//For retrieving a pointer to the current profiler
+GermlineProfiler* GermlineProfiler::Instance()
+{
+    if (mpInstance == NULL){
+        mpInstance = new GermlineProfiler();
+    }
+    return mpInstance;
+}
+
+
+//Deletes the profiler
+void GermlineProfiler::Destroy()
+{
+    mEnabled = false;
+    delete mpInstance;
+    mpInstance = NULL;
+}
+
+
+//Protected constructor. Start clears everything before use.
+GermlineProfiler::GermlineProfiler()
+    : mStartTicks(0),
+      mStartSeconds(0.0),
+      mLastStepTicks(0),
+      mNumSteps(0),
+      mSamplingTimestepMultiple(1),
+      mStepsSinceSample(0)
+{
+    for (unsigned phase = 0; phase < NUM_PHASES; phase++){
+        mStepTicks[phase] = 0;
+        mStepCalls[phase] = 0;
+        mTotalCalls[phase] = 0;
+    }
+    for (unsigned phase = 0; phase <= NUM_PHASES; phase++){
+        mTotalTicks[phase] = 0;
+    }
+}
+
+
+//Monotonic wall time
+double GermlineProfiler::WallSeconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + 1e-9*now.tv_nsec;
+}
+
+
+//Names used in Profile.json
+std::string GermlineProfiler::GetPhaseName(unsigned phase)
+{
+    const char* names[] = {"Force", "BoundaryCondition", "DTCMovement", "Fertilisation", "Apoptosis", "Statechart",
+                           "CellVolumes", "DataOutput", "TrackingOutput", "LineageOutput", "Checkpoints", "Other"};
+    if (phase > NUM_PHASES){
+        EXCEPTION("There is no profiling phase " << phase);
+    }
+    return names[phase];
+}
+
+
+//Clears the results, then turns the timers on
+void GermlineProfiler::Start(unsigned samplingTimestepMultiple)
+{
+    for (unsigned phase = 0; phase < NUM_PHASES; phase++){
+        mStepTicks[phase] = 0;
+        mStepCalls[phase] = 0;
+        mTotalCalls[phase] = 0;
+    }
+    for (unsigned phase = 0; phase <= NUM_PHASES; phase++){
+        mTotalTicks[phase] = 0;
+    }
+    mHistograms.assign(NUM_PHASES+1, std::vector<unsigned>(64, 0));
+    mNumSteps = 0;
+
+    mSamplingTimestepMultiple = (samplingTimestepMultiple > 0) ? samplingTimestepMultiple : 1;
+    mStepsSinceSample = 0;
+    mTicksSinceSample.assign(NUM_PHASES+1, 0);
+    mSampleTimes.clear();
+    mSampleCells.clear();
+    mSampleSteps.clear();
+    mSampleTicks.clear();
+
+    mStartSeconds = WallSeconds();
+    mStartTicks = ReadClock();
+    mLastStepTicks = mStartTicks;
+    mEnabled = true;
+}
+
+
+//Turns the timers off
+void GermlineProfiler::Stop()
+{
+    mEnabled = false;
+}
+
+
+//Moves the step's ticks into the totals. Other is whatever the timers did not see.
+void GermlineProfiler::EndStep(double time, unsigned numCells)
+{
+    if (!mEnabled){
+        return;
+    }
+    boost::uint64_t now = ReadClock();
+    boost::uint64_t stepTicks = now - mLastStepTicks;
+    mLastStepTicks = now;
+
+    boost::uint64_t timedTicks = 0;
+    for (unsigned phase = 0; phase <= NUM_PHASES; phase++){
+        boost::uint64_t ticks;
+        if (phase < NUM_PHASES){
+            if (mStepCalls[phase] == 0){
+                continue;
+            }
+            ticks = mStepTicks[phase];
+            timedTicks += ticks;
+            mTotalCalls[phase] += mStepCalls[phase];
+            mStepTicks[phase] = 0;
+            mStepCalls[phase] = 0;
+        }else{
+            ticks = (stepTicks > timedTicks) ? stepTicks - timedTicks : 0;
+        }
+        mTotalTicks[phase] += ticks;
+        mTicksSinceSample[phase] += ticks;
+
+        unsigned bucket = 0;
+        while (bucket < 63 && (ticks >> (bucket + 1)) > 0){
+            bucket++;
+        }
+        mHistograms[phase][bucket]++;
+    }
+    mNumSteps++;
+
+    mStepsSinceSample++;
+    if (mStepsSinceSample >= mSamplingTimestepMultiple){
+        mSampleTimes.push_back(time);
+        mSampleCells.push_back(numCells);
+        mSampleSteps.push_back(mStepsSinceSample);
+        mSampleTicks.push_back(mTicksSinceSample);
+        mTicksSinceSample.assign(NUM_PHASES+1, 0);
+        mStepsSinceSample = 0;
+    }
+}
+
+
+//Written by hand, as the layout is fixed and there is nothing to escape
+void GermlineProfiler::WriteJson(std::string filePath) const
+{
+    std::ofstream JSON(filePath.c_str());
+    if (!JSON.is_open()){
+        EXCEPTION("Failed to open " << filePath << " to write the profile.");
+    }
+    double ticksPerSecond = GetTicksPerSecond();
+    JSON << std::setprecision(9);
+
+    JSON << "{\n";
+#if defined(__x86_64__) || defined(__i386__)
+    JSON << "  \"Clock\": \"rdtsc\",\n";
+#else
+    JSON << "  \"Clock\": \"clock_gettime\",\n";
+#endif
+    JSON << "  \"TicksPerSecond\": " << ticksPerSecond << ",\n";
+    JSON << "  \"Steps\": " << mNumSteps << ",\n";
+
+    JSON << "  \"Phases\": [\n";
+    for (unsigned phase = 0; phase <= NUM_PHASES; phase++){
+        JSON << "    {\"Name\": \"" << GetPhaseName(phase) << "\", \"Seconds\": " << mTotalTicks[phase]/ticksPerSecond
+             << ", \"Calls\": " << (phase < NUM_PHASES ? mTotalCalls[phase] : (boost::uint64_t)mNumSteps)
+             << ", \"StepHistogram\": [";
+        bool first = true;
+        for (unsigned bucket = 0; bucket < mHistograms[phase].size(); bucket++){
+            if (mHistograms[phase][bucket] == 0){
+                continue;
+            }
+            double lowerEdge = (bucket == 0) ? 0.0 : ((boost::uint64_t)1 << bucket)/ticksPerSecond;
+            JSON << (first ? "" : ", ") << "[" << lowerEdge << ", " << mHistograms[phase][bucket] << "]";
+            first = false;
+        }
+        JSON << "]}" << (phase < NUM_PHASES ? "," : "") << "\n";
+    }
+    JSON << "  ],\n";
+
+    JSON << "  \"Samples\": [\n";
+    for (unsigned sample = 0; sample < mSampleTimes.size(); sample++){
+        JSON << "    {\"Time\": " << mSampleTimes[sample] << ", \"Cells\": " << mSampleCells[sample]
+             << ", \"Steps\": " << mSampleSteps[sample] << ", \"Seconds\": [";
+        for (unsigned phase = 0; phase <= NUM_PHASES; phase++){
+            JSON << (phase > 0 ? ", " : "") << mSampleTicks[sample][phase]/ticksPerSecond;
+        }
+        JSON << "]}" << (sample + 1 < mSampleTimes.size() ? "," : "") << "\n";
+    }
+    JSON << "  ]\n";
+    JSON << "}\n";
+    JSON.close();
+}
+
+
+//Getters
+unsigned GermlineProfiler::GetNumSteps() const
+{
+    return mNumSteps;
+}
+
+//Compares the clock with wall time since Start, so the time stamp counter needs no separate calibration
+double GermlineProfiler::GetTicksPerSecond() const
+{
+    double seconds = WallSeconds() - mStartSeconds;
+    boost::uint64_t ticks = ReadClock() - mStartTicks;
+    if (seconds <= 0.0 || ticks == 0){
+        return 1e9;
+    }
+    return ticks/seconds;
+}
+
+double GermlineProfiler::GetTotalSeconds(unsigned phase) const
+{
+    if (phase > NUM_PHASES){
+        EXCEPTION("There is no profiling phase " << phase);
+    }
+    return mTotalTicks[phase]/GetTicksPerSecond();
+}
@@ -0,0 +1,262 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GERMLINEPROFILER_HPP_
+#define GERMLINEPROFILER_HPP_
+
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+/*
+* Times the parts of a germline simulation step: the force, the boundary condition, the DTC movement, the cell
+* killers, the statechart updates, the cell volumes, the output modifiers and the checkpoints. Everything else
+* in a step (Chaste's own updates to positions, births and the population) is counted as "Other".
+*
+* Each part is timed by putting a ScopedProfileTimer at the top of the function that does it. Timers read the
+* time stamp counter (or on other processors, a nanosecond clock), and add the ticks to an accumulator for the
+* current step; ProfilingModifier ends each step, adding the step's ticks to the totals and to a histogram per
+* phase, and every sampling interval records the ticks since the last sample along with the number of cells.
+* Phases must not be nested, or the inner phase is counted twice. Timers are only used on the simulation's own
+* thread, so there is one set of accumulators: work shared out on the GermlineThreadPool is timed as a whole,
+* by the timer of the phase that hands it out.
+*
+* When profiling is off, a timer only checks one static flag, so the timers are left in place in every run.
+* The results are written as Profile.json (see WriteJson).
+*/
+
+class GermlineProfiler
+{
+public:
+
+    //The timed parts of a step. Other, the rest of the step, is reported after these.
+    enum Phase
+    {
+        FORCE,
+        BOUNDARY_CONDITION,
+        DTC_MOVEMENT,
+        FERTILISATION,
+        APOPTOSIS,
+        STATECHART,
+        CELL_VOLUMES,
+        DATA_OUTPUT,
+        TRACKING_OUTPUT,
+        LINEAGE_OUTPUT,
+        CHECKPOINTS,
+        NUM_PHASES
+    };
+
+private:
+
+    //A pointer to the singleton instance of this class
+    static GermlineProfiler* mpInstance;
+
+    //Whether timers are currently recording
+    static bool mEnabled;
+
+    //Clock reading and wall time when profiling started, to convert ticks to seconds, and the clock reading
+    //at the end of the last step
+    boost::uint64_t mStartTicks;
+    double mStartSeconds;
+    boost::uint64_t mLastStepTicks;
+
+    //Ticks and timer calls in the current step, per phase
+    boost::uint64_t mStepTicks[NUM_PHASES];
+    unsigned mStepCalls[NUM_PHASES];
+
+    //Ticks per phase (plus Other) over the whole run, and timer calls per phase
+    boost::uint64_t mTotalTicks[NUM_PHASES+1];
+    boost::uint64_t mTotalCalls[NUM_PHASES];
+
+    //For each phase (plus Other), the number of steps taking between 2^b and 2^(b+1) ticks in bucket b. Steps
+    //in which a phase did not run are left out of its histogram.
+    std::vector<std::vector<unsigned> > mHistograms;
+
+    //Number of steps ended
+    unsigned mNumSteps;
+
+    //Samples: time, number of cells, steps since the previous sample, and ticks per phase (plus Other) since
+    //the previous sample
+    unsigned mSamplingTimestepMultiple;
+    unsigned mStepsSinceSample;
+    std::vector<boost::uint64_t> mTicksSinceSample;
+    std::vector<double> mSampleTimes;
+    std::vector<unsigned> mSampleCells;
+    std::vector<unsigned> mSampleSteps;
+    std::vector<std::vector<boost::uint64_t> > mSampleTicks;
+
+    //Protected constructor. Use Instance().
+    GermlineProfiler();
+
+    //Monotonic wall time, in seconds
+    static double WallSeconds();
+
+public:
+
+    //For retrieving a pointer to the single instance of the class
+    static GermlineProfiler* Instance();
+
+
+    //Deletes the single instance, turning profiling off
+    static void Destroy();
+
+
+    //Whether timers are recording. Checked by every timer, so kept inline.
+    static bool IsEnabled()
+    {
+        return mEnabled;
+    }
+
+
+    //The current clock reading, in ticks
+    static boost::uint64_t ReadClock()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (boost::uint64_t)now.tv_sec*1000000000u + now.tv_nsec;
+#endif
+    }
+
+
+    /**
+    * @return the name of a phase, as written to Profile.json. NUM_PHASES gives "Other".
+    *
+    * @param phase the phase
+    */
+    static std::string GetPhaseName(unsigned phase);
+
+
+    /**
+    * Clears any earlier results and starts recording.
+    *
+    * @param samplingTimestepMultiple number of steps between samples
+    */
+    void Start(unsigned samplingTimestepMultiple);
+
+
+    //Stops recording. The results are kept until the next Start.
+    void Stop();
+
+
+    /**
+    * Adds a timer's ticks to the current step. Only called while recording.
+    *
+    * @param phase the phase timed
+    * @param ticks the ticks it took
+    */
+    void AddTime(Phase phase, boost::uint64_t ticks)
+    {
+        mStepTicks[phase] += ticks;
+        mStepCalls[phase]++;
+    }
+
+
+    /**
+    * Ends a step, adding its ticks to the totals, histograms and current sample.
+    *
+    * @param time the simulation time at the end of the step
+    * @param numCells the number of cells, recorded with each sample
+    */
+    void EndStep(double time, unsigned numCells);
+
+
+    /**
+    * Writes the results as JSON: the clock used and its rate, the number of steps, then for each phase its
+    * total seconds, number of timer calls, and the per step histogram as [lower edge in seconds, number of
+    * steps] pairs for non-empty buckets, then the samples, each with its time, number of cells, number of
+    * steps and seconds per phase.
+    *
+    * @param filePath full path of the file to write
+    */
+    void WriteJson(std::string filePath) const;
+
+
+    //Getters
+    unsigned GetNumSteps() const;
+    double GetTicksPerSecond() const;
+    double GetTotalSeconds(unsigned phase) const;
+
+};
+
+
+/*
+* Times the rest of the enclosing scope as part of a phase, if profiling is on.
+*/
+class ScopedProfileTimer
+{
+private:
+
+    GermlineProfiler::Phase mPhase;
+    bool mActive;
+    boost::uint64_t mStart;
+
+    //Not copyable
+    ScopedProfileTimer(const ScopedProfileTimer&);
+    ScopedProfileTimer& operator=(const ScopedProfileTimer&);
+
+public:
+
+    //Constructor. Reads the clock if profiling is on.
+    explicit ScopedProfileTimer(GermlineProfiler::Phase phase)
+        : mPhase(phase),
+          mActive(GermlineProfiler::IsEnabled()),
+          mStart(0)
+    {
+        if (mActive){
+            mStart = GermlineProfiler::ReadClock();
+        }
+    }
+
+
+    //Destructor. Adds the time since construction to the phase.
+    ~ScopedProfileTimer()
+    {
+        if (mActive && GermlineProfiler::IsEnabled()){
+            GermlineProfiler::Instance()->AddTime(mPhase, GermlineProfiler::ReadClock() - mStart);
+        }
+    }
+
+};
+
+#endif /*GERMLINEPROFILER_HPP_*/
@@ -0,0 +1,106 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ProfilingModifier.hpp"
+#include "GermlineProfiler.hpp"
+#include "OutputFileHandler.hpp"
+
+
+//Constructor
+template<unsigned DIM>
+ProfilingModifier<DIM>::ProfilingModifier(unsigned samplingInterval)
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mSamplingInterval(samplingInterval)
+{}
+
+
+//Empty destructor
+template<unsigned DIM>
+ProfilingModifier<DIM>::~ProfilingModifier(){}
+
+
+//Getter for mSamplingInterval
+template<unsigned DIM>
+unsigned ProfilingModifier<DIM>::GetSamplingInterval() const
+{
+  return mSamplingInterval;
+};
+
+
+//Starting here leaves the simulation's own setup out of the profile
+template<unsigned DIM>
+void ProfilingModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+  OutputFileHandler handler(outputDirectory, false);
+  mOutputDirectoryFullPath = handler.GetOutputDirectoryFullPath();
+  GermlineProfiler::Instance()->Start(mSamplingInterval);
+}
+
+
+//One profiling step per timestep
+template<unsigned DIM>
+void ProfilingModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+  GermlineProfiler* p_profiler = GermlineProfiler::Instance();
+  p_profiler->EndStep(SimulationTime::Instance()->GetTime(), rCellPopulation.GetNumRealCells());
+
+  if (SimulationTime::Instance()->IsFinished()){
+    p_profiler->Stop();
+    p_profiler->WriteJson(mOutputDirectoryFullPath + "Profile.json");
+  }
+}
+
+
+//Output this class's parameters to a log file
+template<unsigned DIM>
+void ProfilingModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+  *rParamsFile << "\t\t\t<SamplingInterval>" << mSamplingInterval << "</SamplingInterval>\n";
+  // Call method on direct parent class
+  AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class ProfilingModifier<1>;
+template class ProfilingModifier<2>;
+template class ProfilingModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(ProfilingModifier)
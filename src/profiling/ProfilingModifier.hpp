@@ -0,0 +1,112 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef PROFILINGMODIFIER_HPP_
+#define PROFILINGMODIFIER_HPP_
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+/**
+ * A modifier that runs the GermlineProfiler for the length of a simulation: it starts the profiler in
+ * SetupSolve, ends a profiling step at the end of each timestep, and when the simulation finishes, stops the
+ * profiler and writes Profile.json to the results folder. Add it after the output modifiers, so that their
+ * time counts towards the step they record.
+ */
+template<unsigned DIM>
+class ProfilingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mSamplingInterval;
+    }
+
+    //Number of timesteps between profiling samples
+    unsigned mSamplingInterval;
+
+    //Full path of the results folder, where Profile.json is written
+    std::string mOutputDirectoryFullPath;
+
+public:
+
+    //Constructor
+    ProfilingModifier(unsigned samplingInterval = 1);
+
+
+    //Destructor
+    virtual ~ProfilingModifier();
+
+
+    //Getter for mSamplingInterval
+    unsigned GetSamplingInterval() const;
+
+
+    /**
+     * Overriden SetupSolve method. Starts the profiler.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+     void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+
+    /**
+     * Overriden UpdateAtEndOfTimeStep method. Ends the profiling step, and writes the profile once the
+     * simulation is finished.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+     void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+
+     //Output any parameters associated with this class
+     void OutputSimulationModifierParameters(out_stream& rParamsFile);
+
+};
+
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(ProfilingModifier)
+
+#endif /*PROFILINGMODIFIER_HPP_*/
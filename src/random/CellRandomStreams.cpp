@@ -0,0 +1,220 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CellRandomStreams.hpp"
+#include "CellData.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+
+//A pointer to the single instance. Initially null.
+CellRandomStreams* CellRandomStreams::mpInstance = NULL;
+
+
+//Philox4x32 multipliers and key increments
+static const boost::uint32_t PHILOX_M0 = 0xD2511F53u;
+static const boost::uint32_t PHILOX_M1 = 0xCD9E8D57u;
+static const boost::uint32_t PHILOX_W0 = 0x9E3779B9u;
+static const boost::uint32_t PHILOX_W1 = 0xBB67AE85u;
+
+//Doubles on (0,1) are made from 53 random bits
+static const double TWO_POWER_MINUS_53 = 1.0/9007199254740992.0;
+
+//Philox key used to mix lineage keys, so they don't share numbers with any run's draws
+static const boost::uint32_t LINEAGE_KEY[2] = {0x4C494E45u, 0x41474521u};
+
+//Cell data items holding each cell's stream key and draw count. Keys fit in a double exactly.
+static const std::string STREAM_KEY_ITEM("RandomStream");
+static const std::string DRAWS_ITEM("RandomDraws");
+static const boost::uint64_t STREAM_KEY_MASK = ((boost::uint64_t)1 << 48) - 1;
+
+
+//Splits a stream key and draw number into a Philox counter
+static void MakeCounter(boost::uint64_t streamKey, boost::uint64_t drawNumber, boost::uint32_t counter[4])
+{
+    counter[0] = (boost::uint32_t)streamKey;
+    counter[1] = (boost::uint32_t)(streamKey >> 32);
+    counter[2] = (boost::uint32_t)drawNumber;
+    counter[3] = (boost::uint32_t)(drawNumber >> 32);
+}
+
+
+//Makes a double on (0,1), never exactly 0 or 1, from two words
+static double ToOpenUnitInterval(boost::uint32_t high, boost::uint32_t low)
+{
+    boost::uint64_t bits = ((boost::uint64_t)(high >> 5) << 26) | (boost::uint64_t)(low >> 6);
+    return ((double)bits + 0.5)*TWO_POWER_MINUS_53;
+}
+
+
+//For retrieving a pointer to the instance
+CellRandomStreams* CellRandomStreams::Instance()
+{
+    if (mpInstance == NULL)
+    {
+        mpInstance = new CellRandomStreams();
+    }
+    return mpInstance;
+}
+
+
+//Protected constructor
+CellRandomStreams::CellRandomStreams()
+    : mSeed(0)
+{
+    assert(mpInstance == NULL);
+}
+
+
+//Deletes the instance
+void CellRandomStreams::Destroy()
+{
+    if (mpInstance)
+    {
+        delete mpInstance;
+        mpInstance = NULL;
+    }
+}
+
+
+//Setter and getter for the seed
+void CellRandomStreams::SetSeed(unsigned seed)
+{
+    mSeed = seed;
+}
+unsigned CellRandomStreams::GetSeed() const
+{
+    return mSeed;
+}
+
+
+//Ten rounds, each multiplying two words and mixing the halves of the products with the other words and the key
+void CellRandomStreams::Philox(const boost::uint32_t counter[4], const boost::uint32_t key[2], boost::uint32_t output[4])
+{
+    boost::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    boost::uint32_t k0 = key[0], k1 = key[1];
+    for (unsigned round = 0; round < 10; round++)
+    {
+        boost::uint64_t product0 = (boost::uint64_t)PHILOX_M0*c0;
+        boost::uint64_t product1 = (boost::uint64_t)PHILOX_M1*c2;
+        boost::uint32_t next0 = (boost::uint32_t)(product1 >> 32) ^ c1 ^ k0;
+        boost::uint32_t next2 = (boost::uint32_t)(product0 >> 32) ^ c3 ^ k1;
+        c1 = (boost::uint32_t)product1;
+        c3 = (boost::uint32_t)product0;
+        c0 = next0;
+        c2 = next2;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    output[0] = c0;
+    output[1] = c1;
+    output[2] = c2;
+    output[3] = c3;
+}
+
+
+//A daughter's key is 48 bits of a Philox block of the parent's key and the daughter index
+boost::uint64_t CellRandomStreams::Lineage(boost::uint64_t parentKey, unsigned daughterIndex)
+{
+    boost::uint32_t counter[4];
+    MakeCounter(parentKey, daughterIndex, counter);
+    boost::uint32_t bits[4];
+    Philox(counter, LINEAGE_KEY, bits);
+    return (((boost::uint64_t)bits[1] << 32) | bits[0]) & STREAM_KEY_MASK;
+}
+
+
+//Only needed once per cell, so the cost of listing its cell data doesn't matter
+void CellRandomStreams::InitialiseCell(CellPtr pCell) const
+{
+    std::vector<std::string> keys = pCell->GetCellData()->GetKeys();
+    if (std::find(keys.begin(), keys.end(), STREAM_KEY_ITEM) == keys.end()){
+        pCell->GetCellData()->SetItem(STREAM_KEY_ITEM, (double)pCell->GetCellId());
+    }
+    if (std::find(keys.begin(), keys.end(), DRAWS_ITEM) == keys.end()){
+        pCell->GetCellData()->SetItem(DRAWS_ITEM, 0.0);
+    }
+}
+
+
+//The new key's draws start again from 0
+void CellRandomStreams::Divide(CellPtr pCell, unsigned daughterIndex) const
+{
+    pCell->GetCellData()->SetItem(STREAM_KEY_ITEM, (double)Lineage(GetStreamKey(pCell), daughterIndex));
+    pCell->GetCellData()->SetItem(DRAWS_ITEM, 0.0);
+}
+
+
+boost::uint64_t CellRandomStreams::GetStreamKey(CellPtr pCell) const
+{
+    return (boost::uint64_t)pCell->GetCellData()->GetItem(STREAM_KEY_ITEM);
+}
+
+
+//The key is the seed and stream, and the counter the cell's stream key and draw number
+double CellRandomStreams::ranf(Stream stream, boost::uint64_t streamKey, boost::uint64_t drawNumber) const
+{
+    boost::uint32_t key[2] = {mSeed, (boost::uint32_t)stream};
+    boost::uint32_t counter[4];
+    MakeCounter(streamKey, drawNumber, counter);
+    boost::uint32_t bits[4];
+    Philox(counter, key, bits);
+    return ToOpenUnitInterval(bits[0], bits[1]);
+}
+
+
+//Box-Muller, using both halves of one block so that each draw is a single counter value
+double CellRandomStreams::NormalRandomDeviate(Stream stream, boost::uint64_t streamKey, boost::uint64_t drawNumber, double mean, double sd) const
+{
+    boost::uint32_t key[2] = {mSeed, (boost::uint32_t)stream};
+    boost::uint32_t counter[4];
+    MakeCounter(streamKey, drawNumber, counter);
+    boost::uint32_t bits[4];
+    Philox(counter, key, bits);
+    double u1 = ToOpenUnitInterval(bits[0], bits[1]);
+    double u2 = ToOpenUnitInterval(bits[2], bits[3]);
+    return mean + sd*std::sqrt(-2.0*std::log(u1))*std::cos(2.0*M_PI*u2);
+}
+
+
+//The key and draw count live in the cell data, so they are saved with the cell
+double CellRandomStreams::NormalRandomDeviate(CellPtr pCell, Stream stream, double mean, double sd) const
+{
+    boost::shared_ptr<CellData> p_data = pCell->GetCellData();
+    double draws = p_data->GetItem(DRAWS_ITEM);
+    p_data->SetItem(DRAWS_ITEM, draws + 1.0);
+    return NormalRandomDeviate(stream, (boost::uint64_t)p_data->GetItem(STREAM_KEY_ITEM), (boost::uint64_t)draws, mean, sd);
+}
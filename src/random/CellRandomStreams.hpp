@@ -0,0 +1,202 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef CELLRANDOMSTREAMS_HPP_
+#define CELLRANDOMSTREAMS_HPP_
+
+#include "SerializableSingleton.hpp"
+#include "Cell.hpp"
+#include "ChasteSerialization.hpp"
+#include <boost/cstdint.hpp>
+
+/*
+* A globally available source of random numbers for individual cells, used in place of Chaste's
+* RandomNumberGenerator wherever a random number belongs to one cell (cell cycle phase lengths, apoptosis).
+*
+* Numbers come from the counter based generator Philox4x32-10 (Salmon et al., "Parallel random numbers: as
+* easy as 1, 2, 3", SC11), which turns a key and a counter into random bits with no state carried between
+* calls. The key is the run's seed and the kind of draw (a Stream), and the counter is the cell's stream key
+* and a draw number. A cell's random numbers therefore depend only on the seed and that cell's own history, and
+* not on the order in which cells are visited, how many other cells drew before it, or which thread draws them.
+*
+* Stream keys follow the lineage, rather than Chaste's cell IDs, which are handed out in the order cells divide
+* in and so depend on the order cells are visited. A cell the simulation starts with takes its ID (given in a
+* fixed order) as its key. At a division, the parent's key K becomes Lineage(K, 0), and the daughter's
+* Lineage(Lineage(K, 0), 1), where Lineage mixes a key with a daughter index into a new 48 bit key. Keys are
+* kept in the cell data item "RandomStream", which snapshots save.
+*
+* The draw number is either given by the caller (e.g. the timestep, for a draw made once per timestep), or
+* kept per cell in the cell data item "RandomDraws", which starts again from 0 with each new key.
+*/
+
+class CellRandomStreams : public SerializableSingleton<CellRandomStreams>
+{
+private:
+
+    //A pointer to the singleton instance of this class
+    static CellRandomStreams* mpInstance;
+
+    //Seed of the current run
+    unsigned mSeed;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Do not serialize this singleton directly. Instead, serialize the object returned by GetSerializationWrapper.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & mSeed;
+    }
+
+protected:
+
+    //Constructor. Protected, should only be called by Instance(). The seed starts at 0.
+    CellRandomStreams();
+
+public:
+
+    //The kinds of draw, each an independent stream of numbers
+    enum Stream
+    {
+        G1_DURATION = 1,
+        G2_DURATION = 2,
+        APOPTOSIS = 3
+    };
+
+
+    /*
+    * @return a pointer to the instance
+    */
+    static CellRandomStreams* Instance();
+
+
+    /*
+    * @destroy the instance
+    */
+    static void Destroy();
+
+
+    //Setter and getter for the seed
+    void SetSeed(unsigned seed);
+    unsigned GetSeed() const;
+
+
+    /**
+    * The Philox4x32-10 block function.
+    *
+    * @param counter the counter, four words
+    * @param key the key, two words
+    * @param output filled with four words of random bits
+    */
+    static void Philox(const boost::uint32_t counter[4], const boost::uint32_t key[2], boost::uint32_t output[4]);
+
+
+    /**
+    * @return the stream key of a daughter cell, from its parent's key
+    *
+    * @param parentKey the parent's key
+    * @param daughterIndex 0 for the parent itself, 1 for the new cell
+    */
+    static boost::uint64_t Lineage(boost::uint64_t parentKey, unsigned daughterIndex);
+
+
+    /**
+    * Gives a cell the simulation starts with (or one restored from a snapshot saved before cells had stream
+    * keys) its stream key and draw count, if it has none yet. Must be called before the cell draws.
+    *
+    * @param pCell the cell
+    */
+    void InitialiseCell(CellPtr pCell) const;
+
+
+    /**
+    * Moves a dividing cell, or its new daughter, onto its own branch of the lineage. Called on the parent before
+    * the daughter copies its cell data, then on the daughter.
+    *
+    * @param pCell the cell
+    * @param daughterIndex 0 for the parent, 1 for the daughter
+    */
+    void Divide(CellPtr pCell, unsigned daughterIndex) const;
+
+
+    /**
+    * @return a cell's stream key
+    *
+    * @param pCell the cell, which must have been given one (see InitialiseCell)
+    */
+    boost::uint64_t GetStreamKey(CellPtr pCell) const;
+
+
+    /**
+    * @return a random number uniformly distributed on (0,1)
+    *
+    * @param stream the kind of draw
+    * @param streamKey the stream key of the cell the draw is for
+    * @param drawNumber distinguishes this draw from the cell's other draws from the same stream
+    */
+    double ranf(Stream stream, boost::uint64_t streamKey, boost::uint64_t drawNumber) const;
+
+
+    /**
+    * @return a normally distributed random number
+    *
+    * @param stream the kind of draw
+    * @param streamKey the stream key of the cell the draw is for
+    * @param drawNumber distinguishes this draw from the cell's other draws from the same stream
+    * @param mean the mean
+    * @param sd the standard deviation
+    */
+    double NormalRandomDeviate(Stream stream, boost::uint64_t streamKey, boost::uint64_t drawNumber, double mean, double sd) const;
+
+
+    /**
+    * @return a normally distributed random number for a cell, using and incrementing the draw count in its
+    * "RandomDraws" cell data (see InitialiseCell)
+    *
+    * @param pCell the cell
+    * @param stream the kind of draw
+    * @param mean the mean
+    * @param sd the standard deviation
+    */
+    double NormalRandomDeviate(CellPtr pCell, Stream stream, double mean, double sd) const;
+
+};
+
+#endif /*CELLRANDOMSTREAMS_HPP_*/
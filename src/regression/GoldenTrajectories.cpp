@@ -0,0 +1,452 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GoldenTrajectories.hpp"
+#include "GermlineSimulation.hpp"
+#include "GermlineSnapshot.hpp"
+#include "GlobalParameterStruct.hpp"
+#include "EnsembleStatistics.hpp"
+#include "RunManifest.hpp"
+#include "SimulationTime.hpp"
+#include "CellId.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "OutputFileHandler.hpp"
+#include "Exception.hpp"
+
+#include <cmath>
+#include <cfloat>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <boost/cstdint.hpp>
+
+
+//Constructor
+GoldenTrajectories::GoldenTrajectories(std::string outputDirectory, std::string parameterFile, std::string parameterDirectory)
+    : mOutputDirectory(outputDirectory),
+      mParameterFile(parameterFile),
+      mParameterDirectory(parameterDirectory)
+{
+}
+
+
+//Windows are checked for the things that would make their output directories clash
+void GoldenTrajectories::AddWindow(std::string name, std::string snapshotFile, double endTime, unsigned numReplicates, unsigned seed)
+{
+    if (name.empty() || name.find_first_of(" \t\n/") != std::string::npos){
+        EXCEPTION("A window name must be non-empty, with no spaces or slashes: \"" << name << "\"");
+    }
+    for (unsigned i = 0; i < mWindows.size(); i++){
+        if (mWindows[i].Name == name){
+            EXCEPTION("There is already a window called " << name);
+        }
+    }
+    if (numReplicates == 0){
+        EXCEPTION("A window needs at least one replicate.");
+    }
+    Window window;
+    window.Name = name;
+    window.SnapshotFile = snapshotFile;
+    window.SnapshotHash = snapshotFile.empty() ? "" : RunManifest::HashFile(snapshotFile);
+    window.EndTime = endTime;
+    window.NumReplicates = numReplicates;
+    window.Seed = seed;
+    mWindows.push_back(window);
+}
+
+
+//Window, name and time to the nearest millionth of an hour, as EnsembleStatistics matches times
+std::string GoldenTrajectories::QuantityKey(std::string windowName, std::string name, double time)
+{
+    std::stringstream key;
+    key << windowName << "\t" << name << "\t" << (boost::int64_t)std::floor(time*1e6 + 0.5);
+    return key.str();
+}
+
+
+//New quantities start with every replicate missing
+void GoldenTrajectories::SetValue(const Window& rWindow, unsigned replicate, std::string name, double time, double value)
+{
+    std::string key = QuantityKey(rWindow.Name, name, time);
+    std::map<std::string, unsigned>::iterator index = mQuantityIndex.find(key);
+    if (index == mQuantityIndex.end()){
+        Quantity quantity;
+        quantity.WindowName = rWindow.Name;
+        quantity.Name = name;
+        quantity.Time = time;
+        quantity.Values.assign(rWindow.NumReplicates, std::numeric_limits<double>::quiet_NaN());
+        mQuantities.push_back(quantity);
+        index = mQuantityIndex.insert(std::make_pair(key, mQuantities.size() - 1)).first;
+    }
+    mQuantities[index->second].Values[replicate] = value;
+}
+
+
+//Every window in turn
+void GoldenTrajectories::Run()
+{
+    mParameterFileHash = RunManifest::HashFile(mParameterDirectory + mParameterFile);
+    mQuantities.clear();
+    mQuantityIndex.clear();
+    for (unsigned i = 0; i < mWindows.size(); i++){
+        for (unsigned replicate = 0; replicate < mWindows[i].NumReplicates; replicate++){
+            std::cout << "Window " << mWindows[i].Name << ", replicate " << replicate << std::endl;
+            RunReplicate(mWindows[i], replicate);
+        }
+    }
+}
+
+
+//Starts from the same state as a new run of TestElegansGermline (or TestElegansGermlineResume), whatever
+//earlier replicates did to the global state
+void GoldenTrajectories::RunReplicate(const Window& rWindow, unsigned replicate)
+{
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+    std::stringstream directory;
+    directory << mOutputDirectory << "/" << rWindow.Name << "/Replicate" << replicate;
+    unsigned seed = RunManifest::DeriveSeed(rWindow.Seed, "Replicate", replicate);
+    std::stringstream seedSource;
+    seedSource << "replicate " << replicate << " of golden trajectory window " << rWindow.Name;
+
+    //Cell IDs pick each cell's random numbers, so they must start from the same place
+    CellId::ResetMaxCellId();
+    CellPropertyRegistry::Instance()->Clear();
+
+    GermlineSimulation germline;
+    if (rWindow.SnapshotFile.empty()){
+        parameters->ConfigureFromFile(mParameterFile, mParameterDirectory);
+        parameters->ResetDirectoryName(directory.str());
+        parameters->ResetParameter(35, rWindow.EndTime);
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        RunManifest::SeedRandomNumberGenerators(seed);
+        germline.SetupFromParameters();
+        RunManifest::Write(directory.str(), mParameterDirectory + mParameterFile, seed, seedSource.str());
+    }else{
+        //The snapshot restores its own parameters, and its random number generators' state, which every
+        //replicate would then share, so they are reseeded
+        GermlineSnapshot snapshot;
+        snapshot.ReadFromFile(rWindow.SnapshotFile);
+        if (snapshot.GetTime() >= rWindow.EndTime){
+            EXCEPTION("Window " << rWindow.Name << " ends at " << rWindow.EndTime << ", before its snapshot at time " << snapshot.GetTime());
+        }
+        germline.SetupFromSnapshot(snapshot);
+        parameters->ResetDirectoryName(directory.str());
+        parameters->ResetParameter(35, rWindow.EndTime);
+        germline.rGetSimulator().SetOutputDirectory(directory.str().c_str());
+        germline.rGetSimulator().SetEndTime(rWindow.EndTime);
+        RunManifest::SeedRandomNumberGenerators(seed);
+        RunManifest::Write(directory.str(), rWindow.SnapshotFile, seed, seedSource.str());
+    }
+
+    germline.rGetSimulator().Solve();
+
+    //GonadData, at every time it was sampled
+    EnsembleStatistics gonadData(GonadArmDataOutput<3>::GetColumnNames());
+    gonadData.AddRun(directory.str(), "GonadData");
+    std::vector<std::vector<double> > records = gonadData.GetMeans();
+    std::vector<std::string> columnNames = GonadArmDataOutput<3>::GetColumnNames();
+    for (unsigned i = 0; i < records.size(); i++){
+        for (unsigned column = 1; column < columnNames.size(); column++){
+            double value = records[i][column];
+            if (value < DBL_MAX){
+                SetValue(rWindow, replicate, "GonadData." + columnNames[column], records[i][0], value);
+            }
+        }
+    }
+
+    //Cell and fate counts and the spread of cells along the gonad, at the end of the window
+    NodeBasedCellPopulation<3>& population = germline.rGetCellPopulation();
+    double time = SimulationTime::Instance()->GetTime();
+    unsigned numSpermFated = 0;
+    unsigned numOocyteFated = 0;
+    unsigned numUndecided = 0;
+    std::vector<double> distances;
+    for (AbstractCellPopulation<3>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter){
+        if (cell_iter->GetCellData()->GetItem("IsDTC") > 0.5){
+            continue;
+        }
+        if (cell_iter->GetCellData()->GetItem("SpermFated") > 0.5){
+            numSpermFated++;
+        }else if (cell_iter->GetCellData()->GetItem("OocyteFated") > 0.5){
+            numOocyteFated++;
+        }else{
+            numUndecided++;
+        }
+        distances.push_back(cell_iter->GetCellData()->GetItem("DistanceAwayFromDTC"));
+    }
+    SetValue(rWindow, replicate, "Cells", time, population.GetNumRealCells());
+    SetValue(rWindow, replicate, "SpermFated", time, numSpermFated);
+    SetValue(rWindow, replicate, "OocyteFated", time, numOocyteFated);
+    SetValue(rWindow, replicate, "Undecided", time, numUndecided);
+    if (!distances.empty()){
+        std::sort(distances.begin(), distances.end());
+        const char* names[] = {"DistanceQ10", "DistanceQ25", "DistanceQ50", "DistanceQ75", "DistanceQ90"};
+        double probabilities[] = {0.1, 0.25, 0.5, 0.75, 0.9};
+        for (unsigned i = 0; i < 5; i++){
+            //Linear interpolation between order statistics, as EnsembleStatistics gives quantiles
+            double position = probabilities[i]*(distances.size() - 1);
+            unsigned below = (unsigned)std::floor(position);
+            double quantile = (below + 1 < distances.size())
+                ? distances[below] + (position - below)*(distances[below+1] - distances[below]) : distances.back();
+            SetValue(rWindow, replicate, names[i], time, quantile);
+        }
+        SetValue(rWindow, replicate, "DistanceMax", time, distances.back());
+    }
+}
+
+
+//Tab delimited, one window or value per line, each starting with what it is
+void GoldenTrajectories::WriteReference() const
+{
+    OutputFileHandler handler(mOutputDirectory, false);
+    out_stream REFERENCE = handler.OpenOutputFile("GoldenTrajectories.txt");
+    *REFERENCE << std::setprecision(17);
+    *REFERENCE << "#ParameterFile\t<file>\t<hash>\n";
+    *REFERENCE << "#Window\t<name>\t<snapshot file, or - for none>\t<snapshot hash>\t<end time>\t<replicates>\t<seed>\n";
+    *REFERENCE << "#Value\t<window>\t<quantity>\t<time>\t<replicate>\t<value>\n";
+    *REFERENCE << "ParameterFile\t" << mParameterFile << "\t" << mParameterFileHash << "\n";
+    for (unsigned i = 0; i < mWindows.size(); i++){
+        const Window& rWindow = mWindows[i];
+        *REFERENCE << "Window\t" << rWindow.Name << "\t" << (rWindow.SnapshotFile.empty() ? "-" : rWindow.SnapshotFile)
+                   << "\t" << (rWindow.SnapshotHash.empty() ? "-" : rWindow.SnapshotHash) << "\t" << rWindow.EndTime
+                   << "\t" << rWindow.NumReplicates << "\t" << rWindow.Seed << "\n";
+    }
+    for (unsigned i = 0; i < mQuantities.size(); i++){
+        const Quantity& rQuantity = mQuantities[i];
+        for (unsigned replicate = 0; replicate < rQuantity.Values.size(); replicate++){
+            if (rQuantity.Values[replicate] == rQuantity.Values[replicate]){
+                *REFERENCE << "Value\t" << rQuantity.WindowName << "\t" << rQuantity.Name << "\t" << rQuantity.Time
+                           << "\t" << replicate << "\t" << rQuantity.Values[replicate] << "\n";
+            }
+        }
+    }
+    REFERENCE->close();
+}
+
+
+//Lines starting with # are comments
+void GoldenTrajectories::ReadReference(std::string filePath)
+{
+    std::ifstream REFERENCE(filePath.c_str());
+    if (!REFERENCE.is_open()){
+        EXCEPTION("Failed to open golden trajectory reference " << filePath);
+    }
+    mWindows.clear();
+    mQuantities.clear();
+    mQuantityIndex.clear();
+
+    std::string line;
+    unsigned lineNumber = 0;
+    while (std::getline(REFERENCE, line)){
+        lineNumber++;
+        if (line.empty() || line[0] == '#'){
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string type;
+        fields >> type;
+        bool ok;
+        if (type == "ParameterFile"){
+            ok = !(fields >> mParameterFile >> mParameterFileHash).fail();
+        }else if (type == "Window"){
+            Window window;
+            ok = !(fields >> window.Name >> window.SnapshotFile >> window.SnapshotHash >> window.EndTime
+                          >> window.NumReplicates >> window.Seed).fail();
+            if (window.SnapshotFile == "-"){
+                window.SnapshotFile = "";
+                window.SnapshotHash = "";
+            }
+            mWindows.push_back(window);
+        }else if (type == "Value"){
+            std::string windowName, name;
+            double time, value;
+            unsigned replicate;
+            ok = !(fields >> windowName >> name >> time >> replicate >> value).fail();
+            unsigned window = 0;
+            while (ok && window < mWindows.size() && mWindows[window].Name != windowName){
+                window++;
+            }
+            if (!ok || window == mWindows.size() || replicate >= mWindows[window].NumReplicates){
+                EXCEPTION("Line " << lineNumber << " of " << filePath << " has a value for an unknown window or replicate.");
+            }
+            SetValue(mWindows[window], replicate, name, time, value);
+        }else{
+            ok = false;
+        }
+        if (!ok){
+            EXCEPTION("Could not read line " << lineNumber << " of " << filePath);
+        }
+    }
+}
+
+
+//Over the values that are not NaN. The standard deviation divides by one less than their number.
+unsigned GoldenTrajectories::MeanAndStandardDeviation(const std::vector<double>& rValues, double& rMean, double& rSd)
+{
+    unsigned count = 0;
+    rMean = 0.0;
+    double sumOfSquaredDeviations = 0.0;
+    for (unsigned i = 0; i < rValues.size(); i++){
+        if (rValues[i] != rValues[i]){
+            continue;
+        }
+        count++;
+        double delta = rValues[i] - rMean;
+        rMean += delta/count;
+        sumOfSquaredDeviations += delta*(rValues[i] - rMean);
+    }
+    rSd = (count > 1) ? std::sqrt(sumOfSquaredDeviations/(count - 1)) : 0.0;
+    return count;
+}
+
+
+//Every quantity of either, in the reference's order and then any only recorded here. Differences in the
+//parameter file or snapshots are only warned about, since e.g. adding a parameter does not change the model.
+unsigned GoldenTrajectories::CompareWithReference(const GoldenTrajectories& rReference, double zScore, double relativeTolerance,
+                                                  std::ostream& rOut) const
+{
+    if (rReference.GetParameterFile() != mParameterFile || rReference.GetParameterFileHash() != mParameterFileHash){
+        rOut << "Warning: the reference was recorded with " << rReference.GetParameterFile() << " (hash "
+             << rReference.GetParameterFileHash() << "), these runs used " << mParameterFile << " (hash "
+             << mParameterFileHash << ")." << std::endl;
+    }
+    for (unsigned i = 0; i < rReference.rGetWindows().size(); i++){
+        const Window& rOld = rReference.rGetWindows()[i];
+        for (unsigned j = 0; j < mWindows.size(); j++){
+            if (mWindows[j].Name == rOld.Name && mWindows[j].SnapshotHash != rOld.SnapshotHash){
+                rOut << "Warning: window " << rOld.Name << " started from a different snapshot to the reference's." << std::endl;
+            }
+        }
+    }
+
+    OutputFileHandler handler(mOutputDirectory, false);
+    out_stream COMPARISON = handler.OpenOutputFile("GoldenComparison.txt");
+    *COMPARISON << "Window\tQuantity\tTime\tReferenceMean\tReferenceSD\tReferenceN\tMean\tSD\tN\tAllowedDifference\tResult\n";
+
+    //Pairs of reference and current quantities, with NULL for one missing from either
+    std::vector<std::pair<const Quantity*, const Quantity*> > pairs;
+    std::vector<bool> paired(mQuantities.size(), false);
+    for (unsigned i = 0; i < rReference.mQuantities.size(); i++){
+        const Quantity* p_old = &rReference.mQuantities[i];
+        const Quantity* p_new = NULL;
+        std::map<std::string, unsigned>::const_iterator index =
+            mQuantityIndex.find(QuantityKey(p_old->WindowName, p_old->Name, p_old->Time));
+        if (index != mQuantityIndex.end()){
+            p_new = &mQuantities[index->second];
+            paired[index->second] = true;
+        }
+        pairs.push_back(std::make_pair(p_old, p_new));
+    }
+    for (unsigned i = 0; i < mQuantities.size(); i++){
+        if (!paired[i]){
+            pairs.push_back(std::make_pair((const Quantity*)NULL, &mQuantities[i]));
+        }
+    }
+
+    unsigned numIdentical = 0;
+    unsigned numWithin = 0;
+    unsigned numFailed = 0;
+    for (unsigned i = 0; i < pairs.size(); i++){
+        const Quantity* p_old = pairs[i].first;
+        const Quantity* p_new = pairs[i].second;
+        const Quantity& rQuantity = (p_old != NULL) ? *p_old : *p_new;
+
+        double oldMean = DBL_MAX, oldSd = 0.0, newMean = DBL_MAX, newSd = 0.0;
+        unsigned oldCount = (p_old != NULL) ? MeanAndStandardDeviation(p_old->Values, oldMean, oldSd) : 0;
+        unsigned newCount = (p_new != NULL) ? MeanAndStandardDeviation(p_new->Values, newMean, newSd) : 0;
+        double allowed = 0.0;
+        std::string result;
+        if (oldCount == 0 || newCount == 0){
+            result = "Missing";
+        }else{
+            bool identical = (p_old->Values.size() == p_new->Values.size());
+            for (unsigned replicate = 0; identical && replicate < p_old->Values.size(); replicate++){
+                double a = p_old->Values[replicate];
+                double b = p_new->Values[replicate];
+                identical = (a != a && b != b) || std::fabs(a - b) <= 1e-12*std::max(std::fabs(a), std::fabs(b));
+            }
+            allowed = zScore*std::sqrt(oldSd*oldSd/oldCount + newSd*newSd/newCount) + relativeTolerance*std::fabs(oldMean);
+            if (identical){
+                result = "Identical";
+            }else if (std::fabs(newMean - oldMean) <= allowed){
+                result = "Within";
+            }else{
+                result = "Outside";
+            }
+        }
+        if (result == "Identical"){
+            numIdentical++;
+        }else if (result == "Within"){
+            numWithin++;
+        }else{
+            numFailed++;
+            rOut << result << ": " << rQuantity.WindowName << " " << rQuantity.Name << " at time " << rQuantity.Time
+                 << ", reference " << oldMean << " +/- " << oldSd << " (" << oldCount << "), now " << newMean
+                 << " +/- " << newSd << " (" << newCount << ")" << std::endl;
+        }
+        *COMPARISON << rQuantity.WindowName << "\t" << rQuantity.Name << "\t" << rQuantity.Time << "\t" << oldMean << "\t"
+                    << oldSd << "\t" << oldCount << "\t" << newMean << "\t" << newSd << "\t" << newCount << "\t"
+                    << allowed << "\t" << result << "\n";
+    }
+    COMPARISON->close();
+
+    rOut << numIdentical << " quantities identical, " << numWithin << " within tolerance, " << numFailed << " failed." << std::endl;
+    return numFailed;
+}
+
+
+//Getters
+const std::vector<GoldenTrajectories::Window>& GoldenTrajectories::rGetWindows() const
+{
+    return mWindows;
+}
+
+std::string GoldenTrajectories::GetParameterFile() const
+{
+    return mParameterFile;
+}
+
+std::string GoldenTrajectories::GetParameterFileHash() const
+{
+    return mParameterFileHash;
+}
+
+unsigned GoldenTrajectories::GetNumQuantities() const
+{
+    return mQuantities.size();
+}
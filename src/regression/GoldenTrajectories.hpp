@@ -0,0 +1,193 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GOLDENTRAJECTORIES_HPP_
+#define GOLDENTRAJECTORIES_HPP_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+/*
+* Short, seeded replicate runs of the germline simulation, summarised so that two versions of the code can be
+* compared: a regression check for changes that should not alter the model, such as faster force or neighbour
+* calculations, which still change the order of floating point operations.
+*
+* A window is a short stretch of simulated time, run several times with seeds derived from the window's seed
+* (as a sweep derives its replicates' seeds, see RunManifest::DeriveSeed). It either starts a new simulation at
+* time 0 from the parameter file, or starts from a stored GermlineSnapshot (e.g. of an adult, so that the adult
+* gonad can be checked without running the larval stage each time). For each replicate the harness records:
+*  - every column of GonadData at every time it was sampled in the window,
+*  - the number of cells, and of sperm fated, oocyte fated and undecided cells, at the end of the window,
+*  - the 10%, 25%, 50%, 75% and 90% quantiles and the maximum of the cells' distances from the DTC at the end
+*    of the window.
+*
+* A reference, written by WriteReference and read back by ReadReference, holds the windows, the parameter file
+* and a hash of it, and the value of every quantity for every replicate. When a later version repeats the
+* windows with the same seeds, each quantity is either identical for every replicate, or its replicate mean is
+* compared with the reference's (see CompareWithReference), since once the arithmetic is reordered the runs
+* diverge and only their statistics can be expected to agree.
+*/
+
+class GoldenTrajectories
+{
+public:
+
+    //A stretch of simulated time, and how it is run
+    struct Window
+    {
+        std::string Name;
+        std::string SnapshotFile;   //empty to start a new simulation at time 0
+        std::string SnapshotHash;   //hash of the snapshot file's contents
+        double EndTime;
+        unsigned NumReplicates;
+        unsigned Seed;
+    };
+
+private:
+
+    //One quantity at one time in one window, with its value in each replicate (NaN where missing)
+    struct Quantity
+    {
+        std::string WindowName;
+        std::string Name;
+        double Time;
+        std::vector<double> Values;
+    };
+
+    //Output directory, relative to where Chaste output is stored
+    std::string mOutputDirectory;
+
+    //Parameter file new simulations are configured from, its directory, and a hash of its contents
+    std::string mParameterFile;
+    std::string mParameterDirectory;
+    std::string mParameterFileHash;
+
+    std::vector<Window> mWindows;
+
+    //Quantities in the order first recorded, and their index keyed by window, name and time in millionths
+    std::vector<Quantity> mQuantities;
+    std::map<std::string, unsigned> mQuantityIndex;
+
+    //Key of a quantity in mQuantityIndex
+    static std::string QuantityKey(std::string windowName, std::string name, double time);
+
+    //Sets a replicate's value of a quantity, adding the quantity if it is new
+    void SetValue(const Window& rWindow, unsigned replicate, std::string name, double time, double value);
+
+    //Runs one replicate of a window and records its quantities
+    void RunReplicate(const Window& rWindow, unsigned replicate);
+
+    //Mean and sample standard deviation of the values that are not missing, and their number
+    static unsigned MeanAndStandardDeviation(const std::vector<double>& rValues, double& rMean, double& rSd);
+
+public:
+
+    /**
+    * Constructor.
+    *
+    * @param outputDirectory the output directory, relative to where Chaste output is stored. Each replicate
+    * runs in <outputDirectory>/<window name>/Replicate<number>.
+    * @param parameterFile the parameter file new simulations are configured from
+    * @param parameterDirectory the parameter file's location
+    */
+    GoldenTrajectories(std::string outputDirectory, std::string parameterFile, std::string parameterDirectory);
+
+
+    /**
+    * Adds a window to run.
+    *
+    * @param name the window's name, used for its output directory and in the reference. No spaces.
+    * @param snapshotFile path of the GermlineSnapshot to start from, or empty to start a new simulation at time 0
+    * @param endTime the simulated time the window ends at
+    * @param numReplicates the number of replicate runs
+    * @param seed the seed the replicates' seeds are derived from
+    */
+    void AddWindow(std::string name, std::string snapshotFile, double endTime, unsigned numReplicates, unsigned seed);
+
+
+    /**
+    * Runs every replicate of every window, replacing any quantities already recorded. Each replicate starts
+    * from the parameter file or the snapshot afresh, so the global parameters and simulation time are left as
+    * the last replicate left them.
+    */
+    void Run();
+
+
+    /**
+    * Writes the windows and quantities to GoldenTrajectories.txt in the output directory.
+    */
+    void WriteReference() const;
+
+
+    /**
+    * Replaces the windows and quantities with those of a reference written by WriteReference.
+    *
+    * @param filePath path of the reference file
+    */
+    void ReadReference(std::string filePath);
+
+
+    /**
+    * Compares these quantities with a reference's. A quantity is identical if every replicate's value matches
+    * the reference's to within a relative 1e-12 (only possible when the replicates had the same seeds), and
+    * otherwise passes if its replicate means differ by no more than
+    *
+    *     zScore*sqrt(SD^2/N + referenceSD^2/referenceN) + relativeTolerance*|reference mean|.
+    *
+    * A quantity present in only one of the two fails. The comparison is written, one line per quantity, to
+    * GoldenComparison.txt in the output directory, and the failures to rOut.
+    *
+    * @param rReference the reference
+    * @param zScore how many standard errors apart the means may be
+    * @param relativeTolerance the difference allowed on top, as a fraction of the reference mean, so that
+    *        quantities with no spread between replicates can still change in their last digits
+    * @param rOut stream to print the failures and a summary to
+    * @return the number of quantities that fail
+    */
+    unsigned CompareWithReference(const GoldenTrajectories& rReference, double zScore, double relativeTolerance,
+                                  std::ostream& rOut) const;
+
+
+    //Getters
+    const std::vector<Window>& rGetWindows() const;
+    std::string GetParameterFile() const;
+    std::string GetParameterFileHash() const;
+    unsigned GetNumQuantities() const;
+
+};
+
+#endif /*GOLDENTRAJECTORIES_HPP_*/
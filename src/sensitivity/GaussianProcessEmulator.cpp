@@ -0,0 +1,342 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GaussianProcessEmulator.hpp"
+#include "Exception.hpp"
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+
+//Bounds on the log hyperparameters, which keep the pattern search away from degenerate covariances
+static const double minLogLengthScale = std::log(0.01);
+static const double maxLogLengthScale = std::log(100.0);
+static const double minLogSignalVariance = std::log(1e-4);
+static const double maxLogSignalVariance = std::log(100.0);
+static const double minLogNoiseVariance = std::log(1e-8);
+static const double maxLogNoiseVariance = std::log(10.0);
+
+//Added to the diagonal when factorising, for numerical safety
+static const double jitter = 1e-10;
+
+
+//Constructor
+GaussianProcessEmulator::GaussianProcessEmulator(unsigned dimension)
+    : mDimension(dimension),
+      mOutputMean(0.0),
+      mOutputSd(0.0),
+      mLogLengthScales(dimension, std::log(0.5)),
+      mLogSignalVariance(0.0),
+      mLogNoiseVariance(std::log(0.1))
+{}
+
+
+//Squared exponential covariance with a length scale per input
+double GaussianProcessEmulator::Covariance(const std::vector<double>& rX1, const std::vector<double>& rX2) const
+{
+    double sum = 0.0;
+    for (unsigned i = 0; i < mDimension; i++){
+        double scaled = (rX1[i] - rX2[i])/std::exp(mLogLengthScales[i]);
+        sum += scaled*scaled;
+    }
+    return std::exp(mLogSignalVariance - 0.5*sum);
+}
+
+
+//Standardises the outputs and factorises with the default hyperparameters
+void GaussianProcessEmulator::SetTrainingData(const std::vector<std::vector<double> >& rInputs, const std::vector<double>& rOutputs)
+{
+    if (rInputs.size() != rOutputs.size()){
+        EXCEPTION("Emulator given " << rInputs.size() << " inputs but " << rOutputs.size() << " outputs");
+    }
+    for (unsigned i = 0; i < rInputs.size(); i++){
+        if (rInputs[i].size() != mDimension){
+            EXCEPTION("Emulator input has " << rInputs[i].size() << " values, not " << mDimension);
+        }
+    }
+    mInputs = rInputs;
+
+    mOutputMean = 0.0;
+    for (unsigned i = 0; i < rOutputs.size(); i++){
+        mOutputMean += rOutputs[i];
+    }
+    mOutputMean /= std::max<double>(rOutputs.size(), 1);
+    double sumOfSquares = 0.0;
+    for (unsigned i = 0; i < rOutputs.size(); i++){
+        sumOfSquares += (rOutputs[i] - mOutputMean)*(rOutputs[i] - mOutputMean);
+    }
+    mOutputSd = rOutputs.empty() ? 0.0 : std::sqrt(sumOfSquares/rOutputs.size());
+
+    mOutputs.resize(rOutputs.size());
+    for (unsigned i = 0; i < rOutputs.size(); i++){
+        mOutputs[i] = IsConstant() ? 0.0 : (rOutputs[i] - mOutputMean)/mOutputSd;
+    }
+    Factorise();
+}
+
+
+//Cholesky factorisation of the training covariance, then alpha = K^-1 y by two triangular solves
+bool GaussianProcessEmulator::Factorise()
+{
+    unsigned n = mInputs.size();
+    mCholesky.assign(n*n, 0.0);
+    double noise = std::exp(mLogNoiseVariance) + jitter;
+    for (unsigned i = 0; i < n; i++){
+        for (unsigned j = 0; j <= i; j++){
+            double sum = Covariance(mInputs[i], mInputs[j]) + (i == j ? noise : 0.0);
+            for (unsigned k = 0; k < j; k++){
+                sum -= mCholesky[i*n + k]*mCholesky[j*n + k];
+            }
+            if (i == j){
+                if (sum <= 0.0){
+                    mAlpha.assign(n, 0.0);
+                    return false;
+                }
+                mCholesky[i*n + i] = std::sqrt(sum);
+            }else{
+                mCholesky[i*n + j] = sum/mCholesky[j*n + j];
+            }
+        }
+    }
+
+    mAlpha = mOutputs;
+    ForwardSubstitute(mAlpha);
+    for (int i = n - 1; i >= 0; i--){
+        double sum = mAlpha[i];
+        for (unsigned k = i + 1; k < n; k++){
+            sum -= mCholesky[k*n + i]*mAlpha[k];
+        }
+        mAlpha[i] = sum/mCholesky[i*n + i];
+    }
+    return true;
+}
+
+
+//Solves L v = b
+void GaussianProcessEmulator::ForwardSubstitute(std::vector<double>& rB) const
+{
+    unsigned n = mInputs.size();
+    for (unsigned i = 0; i < n; i++){
+        double sum = rB[i];
+        for (unsigned k = 0; k < i; k++){
+            sum -= mCholesky[i*n + k]*rB[k];
+        }
+        rB[i] = sum/mCholesky[i*n + i];
+    }
+}
+
+
+//log p(y) = -y'K^-1y/2 - log|L| - n log(2 pi)/2
+double GaussianProcessEmulator::LogMarginalLikelihood()
+{
+    if (!Factorise()){
+        return -DBL_MAX;
+    }
+    unsigned n = mInputs.size();
+    double value = -0.5*n*std::log(2.0*M_PI);
+    for (unsigned i = 0; i < n; i++){
+        value -= 0.5*mOutputs[i]*mAlpha[i] + std::log(mCholesky[i*n + i]);
+    }
+    return value;
+}
+
+
+//Compass search: try a step up and down in each log hyperparameter in turn, keeping any improvement, and halve
+//the step once none helps. The step starts at a factor of e and stops below about 5%.
+void GaussianProcessEmulator::FitHyperparameters()
+{
+    if (mInputs.size() < 2 || IsConstant()){
+        return;
+    }
+
+    //Collect the log hyperparameters and their bounds in one vector
+    std::vector<double*> values;
+    std::vector<double> lower;
+    std::vector<double> upper;
+    for (unsigned i = 0; i < mDimension; i++){
+        values.push_back(&mLogLengthScales[i]);
+        lower.push_back(minLogLengthScale);
+        upper.push_back(maxLogLengthScale);
+    }
+    values.push_back(&mLogSignalVariance);
+    lower.push_back(minLogSignalVariance);
+    upper.push_back(maxLogSignalVariance);
+    values.push_back(&mLogNoiseVariance);
+    lower.push_back(minLogNoiseVariance);
+    upper.push_back(maxLogNoiseVariance);
+
+    double best = LogMarginalLikelihood();
+    for (double step = 1.0; step > 0.05; step *= 0.5){
+        bool improved = true;
+        while (improved){
+            improved = false;
+            for (unsigned h = 0; h < values.size(); h++){
+                double start = *values[h];
+                for (int direction = -1; direction <= 1; direction += 2){
+                    double trial = std::max(lower[h], std::min(upper[h], start + direction*step));
+                    if (trial == start){
+                        continue;
+                    }
+                    *values[h] = trial;
+                    double likelihood = LogMarginalLikelihood();
+                    if (likelihood > best + 1e-9){
+                        best = likelihood;
+                        improved = true;
+                        break;
+                    }
+                    *values[h] = start;
+                }
+            }
+        }
+    }
+    Factorise();
+}
+
+
+//Predictive mean and variance, back in the outputs' units
+void GaussianProcessEmulator::Predict(const std::vector<double>& rInput, double& rMean, double& rVariance) const
+{
+    if (mInputs.empty() || IsConstant()){
+        rMean = mOutputMean;
+        rVariance = 0.0;
+        return;
+    }
+    unsigned n = mInputs.size();
+    std::vector<double> covariances(n);
+    double mean = 0.0;
+    for (unsigned i = 0; i < n; i++){
+        covariances[i] = Covariance(rInput, mInputs[i]);
+        mean += covariances[i]*mAlpha[i];
+    }
+    ForwardSubstitute(covariances);
+    double variance = std::exp(mLogSignalVariance);
+    for (unsigned i = 0; i < n; i++){
+        variance -= covariances[i]*covariances[i];
+    }
+    rMean = mOutputMean + mOutputSd*mean;
+    rVariance = std::max(0.0, variance)*mOutputSd*mOutputSd;
+}
+
+
+//Predictive mean only, which needs no triangular solve
+double GaussianProcessEmulator::PredictMean(const std::vector<double>& rInput) const
+{
+    if (mInputs.empty() || IsConstant()){
+        return mOutputMean;
+    }
+    double mean = 0.0;
+    for (unsigned i = 0; i < mInputs.size(); i++){
+        mean += Covariance(rInput, mInputs[i])*mAlpha[i];
+    }
+    return mOutputMean + mOutputSd*mean;
+}
+
+
+//The new run's standardised output is the current standardised prediction
+void GaussianProcessEmulator::AddPredictedRun(const std::vector<double>& rInput)
+{
+    if (IsConstant()){
+        return;
+    }
+    double mean = 0.0;
+    for (unsigned i = 0; i < mInputs.size(); i++){
+        mean += Covariance(rInput, mInputs[i])*mAlpha[i];
+    }
+    mInputs.push_back(rInput);
+    mOutputs.push_back(mean);
+    Factorise();
+}
+
+
+//Leave-one-out residuals are alpha_i/[K^-1]_ii (Rasmussen & Williams 2006, section 5.4.2). The diagonal of
+//K^-1 is the sum of squares of each column of L^-1.
+double GaussianProcessEmulator::GetLeaveOneOutQ2() const
+{
+    unsigned n = mInputs.size();
+    if (n < 2 || IsConstant()){
+        return 0.0;
+    }
+    std::vector<double> inverseDiagonal(n, 0.0);
+    std::vector<double> column(n);
+    for (unsigned j = 0; j < n; j++){
+        std::fill(column.begin(), column.end(), 0.0);
+        column[j] = 1.0;
+        ForwardSubstitute(column);
+        for (unsigned k = j; k < n; k++){
+            inverseDiagonal[j] += column[k]*column[k];
+        }
+    }
+
+    double sumOfSquaredErrors = 0.0;
+    double sumOfSquares = 0.0;
+    for (unsigned i = 0; i < n; i++){
+        double residual = mAlpha[i]/inverseDiagonal[i];
+        sumOfSquaredErrors += residual*residual;
+        sumOfSquares += mOutputs[i]*mOutputs[i];
+    }
+    return 1.0 - sumOfSquaredErrors/sumOfSquares;
+}
+
+
+//Getters
+unsigned GaussianProcessEmulator::GetDimension() const
+{
+    return mDimension;
+}
+unsigned GaussianProcessEmulator::GetNumTrainingRuns() const
+{
+    return mInputs.size();
+}
+std::vector<double> GaussianProcessEmulator::GetLengthScales() const
+{
+    std::vector<double> lengthScales(mDimension);
+    for (unsigned i = 0; i < mDimension; i++){
+        lengthScales[i] = std::exp(mLogLengthScales[i]);
+    }
+    return lengthScales;
+}
+double GaussianProcessEmulator::GetSignalVariance() const
+{
+    return std::exp(mLogSignalVariance)*mOutputSd*mOutputSd;
+}
+double GaussianProcessEmulator::GetNoiseVariance() const
+{
+    return std::exp(mLogNoiseVariance)*mOutputSd*mOutputSd;
+}
+bool GaussianProcessEmulator::IsConstant() const
+{
+    return !(mOutputSd > 1e-12*std::max(1.0, std::fabs(mOutputMean)));
+}
@@ -0,0 +1,166 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GAUSSIANPROCESSEMULATOR_HPP_
+#define GAUSSIANPROCESSEMULATOR_HPP_
+
+#include <vector>
+
+/*
+* A Gaussian process regression model of one simulation output as a function of the varied parameters, used as
+* a cheap stand-in (an emulator) for the simulation itself.
+*
+* Inputs are points in the unit hypercube (see SweepEmulator, which scales the parameter ranges onto it). Outputs
+* are standardised to mean 0 and variance 1 internally, and predictions are given back in the outputs' own units.
+* The covariance is the squared exponential with one length scale per input (automatic relevance determination),
+* a signal variance and a noise variance; the noise absorbs the spread between replicates of a stochastic
+* simulation. Hyperparameters are fitted by maximising the log marginal likelihood with a pattern search over
+* their logarithms, which needs no gradients and copes with the likelihood's flat directions: an input the
+* output does not depend on ends up with a long length scale.
+*
+* Everything is done with dense matrices, so the cost of fitting grows with the cube of the number of training
+* runs. A few hundred runs is cheap.
+*/
+
+class GaussianProcessEmulator
+{
+private:
+
+    //Number of inputs
+    unsigned mDimension;
+
+    //Training inputs (in the unit hypercube) and standardised outputs
+    std::vector<std::vector<double> > mInputs;
+    std::vector<double> mOutputs;
+
+    //Mean and standard deviation used to standardise the outputs
+    double mOutputMean;
+    double mOutputSd;
+
+    //Log hyperparameters
+    std::vector<double> mLogLengthScales;
+    double mLogSignalVariance;
+    double mLogNoiseVariance;
+
+    //Lower Cholesky factor of the training covariance, row major, and its inverse applied to the outputs
+    std::vector<double> mCholesky;
+    std::vector<double> mAlpha;
+
+    //Covariance of the latent function between two inputs
+    double Covariance(const std::vector<double>& rX1, const std::vector<double>& rX2) const;
+
+    //Factorises the training covariance with the current hyperparameters. Returns false if it is not positive definite.
+    bool Factorise();
+
+    //Log marginal likelihood with the current hyperparameters, or -DBL_MAX if the covariance cannot be factorised
+    double LogMarginalLikelihood();
+
+    //Solves L v = b in place, for the lower Cholesky factor L
+    void ForwardSubstitute(std::vector<double>& rB) const;
+
+public:
+
+    /**
+    * Constructor. The emulator predicts 0 until it is given training data.
+    *
+    * @param dimension number of inputs
+    */
+    GaussianProcessEmulator(unsigned dimension);
+
+
+    /**
+    * Sets the training runs. Replicates of the same input may be given separately.
+    *
+    * @param rInputs one point in the unit hypercube per run
+    * @param rOutputs the output of each run
+    */
+    void SetTrainingData(const std::vector<std::vector<double> >& rInputs, const std::vector<double>& rOutputs);
+
+
+    /**
+    * Fits the hyperparameters to the training data. Without this, the length scales are 0.5, and the signal and
+    * noise variances 1 and 0.1 of the output's variance.
+    */
+    void FitHyperparameters();
+
+
+    /**
+    * Predicts the output at an input.
+    *
+    * @param rInput a point in the unit hypercube
+    * @param rMean set to the predicted mean
+    * @param rVariance set to the variance of that prediction (of the mean output, so without the noise)
+    */
+    void Predict(const std::vector<double>& rInput, double& rMean, double& rVariance) const;
+
+
+    /**
+    * @return the predicted mean output at an input, cheaper than Predict()
+    *
+    * @param rInput a point in the unit hypercube
+    */
+    double PredictMean(const std::vector<double>& rInput) const;
+
+
+    /**
+    * Adds a training run at an input whose output is taken to be the current prediction there, keeping the
+    * hyperparameters. The predictions hardly change, but their variance near the input falls as it would if
+    * the run were made, which is what choosing several new runs at once needs (the "kriging believer").
+    *
+    * @param rInput a point in the unit hypercube
+    */
+    void AddPredictedRun(const std::vector<double>& rInput);
+
+
+    /**
+    * @return the leave-one-out coefficient of determination (Q2): one minus the sum of squared errors when
+    * predicting each training run from all the others, over the outputs' sum of squares about their mean.
+    * 1 is a perfect emulator; 0 is no better than predicting the mean. Computed from the fitted covariance,
+    * without refitting.
+    */
+    double GetLeaveOneOutQ2() const;
+
+
+    //Getters, in the outputs' units where relevant
+    unsigned GetDimension() const;
+    unsigned GetNumTrainingRuns() const;
+    std::vector<double> GetLengthScales() const;
+    double GetSignalVariance() const;
+    double GetNoiseVariance() const;
+    bool IsConstant() const;
+
+};
+
+#endif /*GAUSSIANPROCESSEMULATOR_HPP_*/
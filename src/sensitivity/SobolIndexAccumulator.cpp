@@ -0,0 +1,482 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SobolIndexAccumulator.hpp"
+#include "ParameterSweepDesign.hpp"
+#include "EnsembleStatistics.hpp"
+#include "GonadArmDataOutput.hpp"
+#include "OutputFileHandler.hpp"
+#include "RunManifest.hpp"
+#include "Exception.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+
+//Constructor
+SobolIndexAccumulator::SobolIndexAccumulator(const ParameterSweepDesign& rDesign, double hoursBetweenOutputs, unsigned numResamples)
+    : mSweepName(rDesign.GetSweepName()),
+      mParameterIndices(rDesign.rGetParameterIndices()),
+      mNumBaseSamples(rDesign.GetNumberOfPoints()),
+      mSeed(rDesign.GetSeed()),
+      mHoursBetweenOutputs(hoursBetweenOutputs),
+      mNumResamples(numResamples)
+{
+    if (rDesign.GetDesignType() != "Saltelli"){
+        EXCEPTION("Sobol indices can only be accumulated over a Saltelli design, not " << rDesign.GetDesignType());
+    }
+    if (hoursBetweenOutputs <= 0.0){
+        EXCEPTION("The hours between outputs must be positive.");
+    }
+
+    std::vector<std::string> names = GonadArmDataOutput<3>::GetColumnNames();
+    const char* columns[] = {"GonadLength", "ProliferativeCount", "SpermCount", "FirstMeioticRow", "LastMitoticRow"};
+    for (unsigned c = 0; c < 5; c++){
+        mColumns.push_back(std::find(names.begin(), names.end(), columns[c]) - names.begin());
+    }
+}
+
+
+//Reads the file Save() writes, after checking it belongs to the same design and settings
+bool SobolIndexAccumulator::LoadFromFile()
+{
+    OutputFileHandler handler(mSweepName, false);
+    std::string filepath = handler.GetOutputDirectoryFullPath() + "SobolAccumulator.txt";
+    std::ifstream SUMS(filepath.c_str());
+    if (!SUMS.is_open()){
+        return false;
+    }
+
+    std::string label;
+    unsigned numParameters;
+    unsigned numBaseSamples;
+    unsigned seed;
+    double hoursBetweenOutputs;
+    unsigned numResamples;
+    unsigned numColumns;
+    SUMS >> label >> numParameters;
+    std::vector<int> parameterIndices(numParameters);
+    for (unsigned p = 0; p < numParameters; p++){
+        SUMS >> parameterIndices[p];
+    }
+    SUMS >> label >> numBaseSamples >> label >> seed >> label >> hoursBetweenOutputs >> label >> numResamples >> label >> numColumns;
+    std::vector<unsigned> columns(numColumns);
+    for (unsigned c = 0; c < numColumns; c++){
+        SUMS >> columns[c];
+    }
+    if (SUMS.fail()){
+        EXCEPTION("Sobol index sums " << filepath << " are corrupt");
+    }
+    if (parameterIndices != mParameterIndices || numBaseSamples != mNumBaseSamples || seed != mSeed
+        || std::fabs(hoursBetweenOutputs - mHoursBetweenOutputs) > 1e-9 || numResamples != mNumResamples || columns != mColumns){
+        EXCEPTION("Sobol index sums " << filepath << " are for a different design or settings; remove them to start again");
+    }
+
+    mFoldedGroups.clear();
+    mOpenGroups.clear();
+    mOutputs.clear();
+    unsigned numGroups;
+    SUMS >> label >> numGroups;
+    for (unsigned g = 0; g < numGroups; g++){
+        GroupKey group;
+        SUMS >> group.first >> group.second;
+        mFoldedGroups.insert(group);
+    }
+
+    unsigned numOutputs;
+    unsigned numParams = mParameterIndices.size();
+    SUMS >> label >> numOutputs;
+    for (unsigned o = 0; o < numOutputs; o++){
+        OutputKey key;
+        OutputSums sums;
+        SUMS >> key.first >> key.second >> sums.NumGroups;
+        sums.Weights.resize(mNumResamples + 1);
+        sums.SumsA.resize(mNumResamples + 1);
+        sums.SquaresA.resize(mNumResamples + 1);
+        sums.SumsB.resize(mNumResamples + 1);
+        sums.SquaresB.resize(mNumResamples + 1);
+        sums.DifferenceSums.resize((mNumResamples + 1)*numParams);
+        sums.FirstOrderSums.resize((mNumResamples + 1)*numParams);
+        sums.TotalOrderSums.resize((mNumResamples + 1)*numParams);
+        for (unsigned r = 0; r <= mNumResamples; r++){
+            SUMS >> sums.Weights[r] >> sums.SumsA[r] >> sums.SquaresA[r] >> sums.SumsB[r] >> sums.SquaresB[r];
+            for (unsigned p = 0; p < numParams; p++){
+                SUMS >> sums.DifferenceSums[r*numParams + p];
+            }
+            for (unsigned p = 0; p < numParams; p++){
+                SUMS >> sums.FirstOrderSums[r*numParams + p];
+            }
+            for (unsigned p = 0; p < numParams; p++){
+                SUMS >> sums.TotalOrderSums[r*numParams + p];
+            }
+        }
+        mOutputs[key] = sums;
+    }
+    if (SUMS.fail()){
+        EXCEPTION("Sobol index sums " << filepath << " are corrupt");
+    }
+    SUMS.close();
+    return true;
+}
+
+
+//Written to a temporary file then renamed over the old one, as the sweep manifest is
+void SobolIndexAccumulator::Save() const
+{
+    OutputFileHandler handler(mSweepName, false);
+    std::string filepath = handler.GetOutputDirectoryFullPath() + "SobolAccumulator.txt";
+    std::string temporaryFilepath = filepath + ".tmp";
+
+    std::ofstream SUMS(temporaryFilepath.c_str());
+    if (!SUMS.is_open()){
+        EXCEPTION("Failed to write Sobol index sums " << temporaryFilepath);
+    }
+    SUMS << std::setprecision(17);
+
+    SUMS << "Parameters\t" << mParameterIndices.size();
+    for (unsigned p = 0; p < mParameterIndices.size(); p++){
+        SUMS << "\t" << mParameterIndices[p];
+    }
+    SUMS << "\nBaseSamples\t" << mNumBaseSamples << "\nSeed\t" << mSeed << "\nHoursBetweenOutputs\t" << mHoursBetweenOutputs
+         << "\nResamples\t" << mNumResamples << "\nColumns\t" << mColumns.size();
+    for (unsigned c = 0; c < mColumns.size(); c++){
+        SUMS << "\t" << mColumns[c];
+    }
+
+    SUMS << "\nFoldedGroups\t" << mFoldedGroups.size() << "\n";
+    for (std::set<GroupKey>::const_iterator group = mFoldedGroups.begin(); group != mFoldedGroups.end(); ++group){
+        SUMS << group->first << "\t" << group->second << "\n";
+    }
+
+    unsigned numParams = mParameterIndices.size();
+    SUMS << "Outputs\t" << mOutputs.size() << "\n";
+    for (std::map<OutputKey, OutputSums>::const_iterator output = mOutputs.begin(); output != mOutputs.end(); ++output){
+        const OutputSums& rSums = output->second;
+        SUMS << output->first.first << "\t" << output->first.second << "\t" << rSums.NumGroups << "\n";
+        for (unsigned r = 0; r <= mNumResamples; r++){
+            SUMS << rSums.Weights[r] << "\t" << rSums.SumsA[r] << "\t" << rSums.SquaresA[r] << "\t" << rSums.SumsB[r]
+                 << "\t" << rSums.SquaresB[r];
+            for (unsigned p = 0; p < numParams; p++){
+                SUMS << "\t" << rSums.DifferenceSums[r*numParams + p];
+            }
+            for (unsigned p = 0; p < numParams; p++){
+                SUMS << "\t" << rSums.FirstOrderSums[r*numParams + p];
+            }
+            for (unsigned p = 0; p < numParams; p++){
+                SUMS << "\t" << rSums.TotalOrderSums[r*numParams + p];
+            }
+            SUMS << "\n";
+        }
+    }
+    SUMS.close();
+
+    if (std::rename(temporaryFilepath.c_str(), filepath.c_str()) != 0){
+        EXCEPTION("Failed to replace Sobol index sums " << filepath);
+    }
+}
+
+
+//Every completed job, in manifest order
+void SobolIndexAccumulator::CatchUp(const SweepJobManifest& rManifest)
+{
+    for (unsigned i = 0; i < rManifest.GetNumJobs(); i++){
+        if (rManifest.rGetJob(i).Status == COMPLETE){
+            JobCompleted(rManifest, i);
+        }
+    }
+}
+
+
+//Files a run under its group, and folds the group in once it is complete
+void SobolIndexAccumulator::JobCompleted(const SweepJobManifest& rManifest, unsigned jobId)
+{
+    const SweepJob& rJob = rManifest.rGetJob(jobId);
+    unsigned groupSize = mParameterIndices.size() + 2;
+    if (rJob.DesignPoint < 0 || (unsigned)rJob.DesignPoint >= mNumBaseSamples*groupSize){
+        return;
+    }
+    GroupKey group((unsigned)rJob.DesignPoint/groupSize, rJob.Replicate);
+    unsigned member = (unsigned)rJob.DesignPoint % groupSize;
+    if (mFoldedGroups.count(group) > 0){
+        return;
+    }
+
+    OpenGroup& rRuns = mOpenGroups[group];
+    if (rRuns.Received.empty()){
+        rRuns.Received.resize(groupSize, false);
+        rRuns.Values.resize(groupSize);
+    }
+    if (rRuns.Received[member]){
+        return;
+    }
+    rRuns.Values[member] = ReadRunOutputs(rJob);
+    rRuns.Received[member] = true;
+
+    if (std::find(rRuns.Received.begin(), rRuns.Received.end(), false) == rRuns.Received.end()){
+        FoldGroup(group, rRuns);
+        mOpenGroups.erase(group);
+        Save();
+    }
+}
+
+
+//A run's GonadData records at whole multiples of the sampling interval
+std::map<SobolIndexAccumulator::OutputKey, double> SobolIndexAccumulator::ReadRunOutputs(const SweepJob& rJob) const
+{
+    EnsembleStatistics run(GonadArmDataOutput<3>::GetColumnNames());
+    run.AddRun(rJob.Directory, "GonadData");
+    std::vector<std::vector<double> > records = run.GetMeans();
+
+    std::map<OutputKey, double> values;
+    for (unsigned r = 0; r < records.size(); r++){
+        double samples = records[r][0]/mHoursBetweenOutputs;
+        boost::int64_t sample = (boost::int64_t)std::floor(samples + 0.5);
+        if (sample <= 0 || std::fabs(samples - sample) > 1e-6){
+            continue;
+        }
+        for (unsigned c = 0; c < mColumns.size(); c++){
+            double value = records[r][mColumns[c]];
+            if (value < 1e300){   // <- not missing
+                values[OutputKey(sample, mColumns[c])] = value;
+            }
+        }
+    }
+    return values;
+}
+
+
+//Adds one sample of each estimator's terms, with each resample's weight
+void SobolIndexAccumulator::FoldGroup(const GroupKey& rGroup, const OpenGroup& rRuns)
+{
+    unsigned numParams = mParameterIndices.size();
+    std::vector<double> weights = GetResampleWeights(rGroup);
+
+    //Outputs that run A has and every other run of the group has too
+    const std::map<OutputKey, double>& rValuesA = rRuns.Values[0];
+    for (std::map<OutputKey, double>::const_iterator output = rValuesA.begin(); output != rValuesA.end(); ++output){
+        std::vector<double> values(numParams + 2);
+        bool complete = true;
+        for (unsigned m = 0; m < numParams + 2 && complete; m++){
+            std::map<OutputKey, double>::const_iterator found = rRuns.Values[m].find(output->first);
+            complete = (found != rRuns.Values[m].end());
+            if (complete){
+                values[m] = found->second;
+            }
+        }
+        if (!complete){
+            continue;
+        }
+
+        OutputSums& rSums = mOutputs[output->first];
+        if (rSums.Weights.empty()){
+            rSums.NumGroups = 0;
+            rSums.Weights.assign(mNumResamples + 1, 0.0);
+            rSums.SumsA.assign(mNumResamples + 1, 0.0);
+            rSums.SquaresA.assign(mNumResamples + 1, 0.0);
+            rSums.SumsB.assign(mNumResamples + 1, 0.0);
+            rSums.SquaresB.assign(mNumResamples + 1, 0.0);
+            rSums.DifferenceSums.assign((mNumResamples + 1)*numParams, 0.0);
+            rSums.FirstOrderSums.assign((mNumResamples + 1)*numParams, 0.0);
+            rSums.TotalOrderSums.assign((mNumResamples + 1)*numParams, 0.0);
+        }
+        rSums.NumGroups++;
+
+        double valueA = values[0];
+        double valueB = values[1];
+        for (unsigned r = 0; r <= mNumResamples; r++){
+            double weight = weights[r];
+            if (weight == 0.0){
+                continue;
+            }
+            rSums.Weights[r] += weight;
+            rSums.SumsA[r] += weight*valueA;
+            rSums.SquaresA[r] += weight*valueA*valueA;
+            rSums.SumsB[r] += weight*valueB;
+            rSums.SquaresB[r] += weight*valueB*valueB;
+            for (unsigned p = 0; p < numParams; p++){
+                double valueAB = values[p + 2];
+                rSums.DifferenceSums[r*numParams + p] += weight*(valueAB - valueA);
+                rSums.FirstOrderSums[r*numParams + p] += weight*valueB*(valueAB - valueA);
+                rSums.TotalOrderSums[r*numParams + p] += weight*(valueA - valueAB)*(valueA - valueAB);
+            }
+        }
+    }
+    mFoldedGroups.insert(rGroup);
+}
+
+
+//Poisson(1) by inversion, from one uniform per resample. The uniforms are hashes of the sweep seed, group and
+//resample (see RunManifest::DeriveSeed), so need no generator state.
+std::vector<double> SobolIndexAccumulator::GetResampleWeights(const GroupKey& rGroup) const
+{
+    unsigned groupSeed = RunManifest::DeriveSeed(RunManifest::DeriveSeed(mSeed, "SobolBootstrap", rGroup.first), "Replicate", rGroup.second);
+    std::vector<double> weights(mNumResamples + 1, 1.0);
+    for (unsigned r = 1; r <= mNumResamples; r++){
+        double uniform = (RunManifest::DeriveSeed(groupSeed, "Resample", r) + 0.5)/4294967296.0;
+        unsigned count = 0;
+        double probability = std::exp(-1.0);
+        double cumulative = probability;
+        while (uniform > cumulative && count < 20){
+            count++;
+            probability /= count;
+            cumulative += probability;
+        }
+        weights[r] = count;
+    }
+    return weights;
+}
+
+
+//The estimators, from the weighted sums. Centring f(B) on its mean subtracts that mean times the sum of
+//differences from the first order sum.
+bool SobolIndexAccumulator::Estimate(const OutputSums& rSums, unsigned resample, double& rVariance,
+                                     std::vector<double>& rFirstOrder, std::vector<double>& rTotalOrder) const
+{
+    unsigned numParams = mParameterIndices.size();
+    double weight = rSums.Weights[resample];
+    rVariance = 0.0;
+    if (!(weight > 0.0)){
+        return false;
+    }
+    double mean = (rSums.SumsA[resample] + rSums.SumsB[resample])/(2.0*weight);
+    double meanB = rSums.SumsB[resample]/weight;
+    rVariance = (rSums.SquaresA[resample] + rSums.SquaresB[resample])/(2.0*weight) - mean*mean;
+    if (!(rVariance > 1e-12*std::max(1.0, mean*mean))){
+        rVariance = 0.0;
+        return false;
+    }
+    rFirstOrder.resize(numParams);
+    rTotalOrder.resize(numParams);
+    for (unsigned p = 0; p < numParams; p++){
+        unsigned entry = resample*numParams + p;
+        rFirstOrder[p] = (rSums.FirstOrderSums[entry] - meanB*rSums.DifferenceSums[entry])/weight/rVariance;
+        rTotalOrder[p] = rSums.TotalOrderSums[entry]/(2.0*weight)/rVariance;
+    }
+    return true;
+}
+
+
+//Percentile intervals over the resamples, interpolated as R's default quantile()
+void SobolIndexAccumulator::WriteIndices(double confidenceLevel) const
+{
+    unsigned numParams = mParameterIndices.size();
+    std::vector<std::string> columnNames = GonadArmDataOutput<3>::GetColumnNames();
+    double lowerProbability = 0.5*(1.0 - confidenceLevel);
+
+    OutputFileHandler handler(mSweepName, false);
+    out_stream INDICES = handler.OpenOutputFile("SobolIndices.txt");
+    *INDICES << std::setprecision(8);
+    *INDICES << "Column\tTime\tGroups\tVariance";
+    for (unsigned p = 0; p < numParams; p++){
+        int index = mParameterIndices[p];
+        *INDICES << "\tS_P" << index << "\tS_P" << index << "_Lower\tS_P" << index << "_Upper"
+                 << "\tST_P" << index << "\tST_P" << index << "_Lower\tST_P" << index << "_Upper";
+    }
+    *INDICES << "\n";
+
+    for (std::map<OutputKey, OutputSums>::const_iterator output = mOutputs.begin(); output != mOutputs.end(); ++output){
+        const OutputSums& rSums = output->second;
+        double variance;
+        std::vector<double> firstOrder;
+        std::vector<double> totalOrder;
+        bool varies = rSums.NumGroups > 1 && Estimate(rSums, 0, variance, firstOrder, totalOrder);
+
+        //Each resample's indices, one list per parameter
+        std::vector<std::vector<double> > resampledFirstOrder(numParams);
+        std::vector<std::vector<double> > resampledTotalOrder(numParams);
+        if (varies){
+            double resampledVariance;
+            std::vector<double> first;
+            std::vector<double> total;
+            for (unsigned r = 1; r <= mNumResamples; r++){
+                if (Estimate(rSums, r, resampledVariance, first, total)){
+                    for (unsigned p = 0; p < numParams; p++){
+                        resampledFirstOrder[p].push_back(first[p]);
+                        resampledTotalOrder[p].push_back(total[p]);
+                    }
+                }
+            }
+        }
+
+        *INDICES << columnNames[output->first.second] << "\t" << output->first.first*mHoursBetweenOutputs << "\t"
+                 << rSums.NumGroups << "\t" << (varies ? variance : 0.0);
+        for (unsigned p = 0; p < numParams; p++){
+            if (!varies){
+                *INDICES << "\tNA\tNA\tNA\tNA\tNA\tNA";
+                continue;
+            }
+            for (unsigned kind = 0; kind < 2; kind++){
+                std::vector<double>& rResampled = (kind == 0) ? resampledFirstOrder[p] : resampledTotalOrder[p];
+                *INDICES << "\t" << ((kind == 0) ? firstOrder[p] : totalOrder[p]);
+                if (rResampled.size() < 2){
+                    *INDICES << "\tNA\tNA";
+                    continue;
+                }
+                std::sort(rResampled.begin(), rResampled.end());
+                for (unsigned bound = 0; bound < 2; bound++){
+                    double position = ((bound == 0) ? lowerProbability : 1.0 - lowerProbability)*(rResampled.size() - 1);
+                    unsigned below = std::min((unsigned)std::floor(position), (unsigned)rResampled.size() - 2);
+                    double fraction = position - below;
+                    *INDICES << "\t" << rResampled[below] + fraction*(rResampled[below+1] - rResampled[below]);
+                }
+            }
+        }
+        *INDICES << "\n";
+    }
+    INDICES->close();
+}
+
+
+//Getters
+unsigned SobolIndexAccumulator::GetNumOutputs() const
+{
+    return mOutputs.size();
+}
+unsigned SobolIndexAccumulator::GetNumGroupsFolded() const
+{
+    return mFoldedGroups.size();
+}
+unsigned SobolIndexAccumulator::GetNumOpenGroups() const
+{
+    return mOpenGroups.size();
+}
+unsigned SobolIndexAccumulator::GetNumResamples() const
+{
+    return mNumResamples;
+}
@@ -0,0 +1,209 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SOBOLINDEXACCUMULATOR_HPP_
+#define SOBOLINDEXACCUMULATOR_HPP_
+
+#include "AbstractSweepJobObserver.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <utility>
+#include <boost/cstdint.hpp>
+
+class ParameterSweepDesign;
+
+/*
+* Estimates Sobol sensitivity indices of a Saltelli sweep's GonadData while the sweep runs, keeping only running
+* sums rather than every run's output.
+*
+* A Saltelli design (see ParameterSweepDesign) has, for each of N base samples, the points A, B and AB_1 ... AB_d,
+* where AB_i is A with parameter i taken from B. Once all d+2 runs of a base sample (of one replicate) have
+* completed, their outputs are folded into the sums behind the estimators
+*
+*   first order  S_i  = mean(f(B)(f(AB_i) - f(A)))/V     (Saltelli et al. 2010)
+*   total order  ST_i = mean((f(A) - f(AB_i))^2)/(2V)    (Jansen 1999)
+*
+* where V is the variance of f(A) and f(B) together, and then forgotten. The sums of f(AB_i) - f(A) are kept
+* too, so that f(B) can be centred on its mean at the end, which makes the first order estimates much less
+* noisy. Replicates are treated as further base samples; as they share their seeds across design points, the
+* differences in these estimators are not swamped by noise. An output is one GonadData column (GonadLength,
+* ProliferativeCount, SpermCount, FirstMeioticRow or LastMitoticRow) at one sampling time, every given number of
+* hours.
+*
+* Confidence intervals come from a Poisson bootstrap, which suits data arriving one piece at a time: each base
+* sample is given, for each of a number of resamples, a weight drawn from a Poisson distribution with mean 1, and
+* every resample keeps its own weighted sums. The weights depend only on the sweep seed and the base sample, so
+* the order in which runs finish changes the sums only by floating point rounding, as they are added up in a
+* different order. Memory therefore grows with the number of outputs, parameters and resamples, not with the
+* number of runs.
+*
+* The sums, and which base samples they include, are saved to SobolAccumulator.txt in the sweep's output
+* directory (atomically) each time a base sample is folded in. Runs of base samples not yet complete are only held
+* in memory, so after an interruption CatchUp() reads them again from their output directories.
+*/
+
+class SobolIndexAccumulator : public AbstractSweepJobObserver
+{
+private:
+
+    //An output: sampling time, in multiples of mHoursBetweenOutputs, and GonadData column
+    typedef std::pair<boost::int64_t, unsigned> OutputKey;
+
+    //A group of runs making one sample of the estimators: base sample and replicate
+    typedef std::pair<unsigned, unsigned> GroupKey;
+
+    //Running sums of one output. Entry 0 of each is unweighted; entry r > 0 has resample r's weights.
+    struct OutputSums
+    {
+        unsigned NumGroups;
+        std::vector<double> Weights;
+        std::vector<double> SumsA;
+        std::vector<double> SquaresA;
+        std::vector<double> SumsB;
+        std::vector<double> SquaresB;
+        std::vector<double> DifferenceSums;     //(number of resamples + 1) by number of parameters
+        std::vector<double> FirstOrderSums;
+        std::vector<double> TotalOrderSums;
+    };
+
+    //Outputs of the runs of a group that have completed, until they all have
+    struct OpenGroup
+    {
+        std::vector<bool> Received;
+        std::vector<std::map<OutputKey, double> > Values;
+    };
+
+    //Sweep name, also the output directory
+    std::string mSweepName;
+
+    //Varied parameters, number of base samples and the sweep seed
+    std::vector<int> mParameterIndices;
+    unsigned mNumBaseSamples;
+    unsigned mSeed;
+
+    //GonadData columns and sampling interval
+    std::vector<unsigned> mColumns;
+    double mHoursBetweenOutputs;
+
+    //Number of bootstrap resamples
+    unsigned mNumResamples;
+
+    //Running sums of every output
+    std::map<OutputKey, OutputSums> mOutputs;
+
+    //Groups already in the sums, and groups still waiting for runs
+    std::set<GroupKey> mFoldedGroups;
+    std::map<GroupKey, OpenGroup> mOpenGroups;
+
+    //Reads a run's GonadData at the sampling times
+    std::map<OutputKey, double> ReadRunOutputs(const SweepJob& rJob) const;
+
+    //Adds a complete group to the sums of every output all its runs have
+    void FoldGroup(const GroupKey& rGroup, const OpenGroup& rRuns);
+
+    //Poisson(1) weight of a group in each resample, starting with 1 for the unweighted sums
+    std::vector<double> GetResampleWeights(const GroupKey& rGroup) const;
+
+    //Estimates from one set of sums. Returns false if the output has no variance.
+    bool Estimate(const OutputSums& rSums, unsigned resample, double& rVariance,
+                  std::vector<double>& rFirstOrder, std::vector<double>& rTotalOrder) const;
+
+public:
+
+    /**
+    * Constructor.
+    *
+    * @param rDesign the sweep's design, which must be a Saltelli design
+    * @param hoursBetweenOutputs how often to sample each column
+    * @param numResamples number of bootstrap resamples for the confidence intervals
+    */
+    SobolIndexAccumulator(const ParameterSweepDesign& rDesign, double hoursBetweenOutputs, unsigned numResamples = 100);
+
+
+    /**
+    * Reads back the sums saved by an earlier run of the sweep, if there are any.
+    *
+    * @return whether saved sums were found
+    */
+    bool LoadFromFile();
+
+
+    /**
+    * Writes the sums to file, replacing any previous version atomically.
+    */
+    void Save() const;
+
+
+    /**
+    * Takes in every completed job of the manifest that the sums do not include yet, e.g. after loading them.
+    *
+    * @param rManifest the sweep's manifest
+    */
+    void CatchUp(const SweepJobManifest& rManifest);
+
+
+    /**
+    * Takes in a completed job. Jobs that are not part of the Saltelli design (larval runs, or points added
+    * later) and jobs already included are ignored.
+    *
+    * @param rManifest the sweep's manifest
+    * @param jobId the job
+    */
+    virtual void JobCompleted(const SweepJobManifest& rManifest, unsigned jobId);
+
+
+    /**
+    * Writes SobolIndices.txt in the sweep's output directory: for each output, the number of groups (base
+    * samples times replicates) folded in, the output's variance, then for each parameter the first order index
+    * with the bounds of its bootstrap confidence interval and the same for the total order index, tab
+    * delimited with a header row. Indices of outputs without variance are NA.
+    *
+    * @param confidenceLevel coverage of the confidence intervals
+    */
+    void WriteIndices(double confidenceLevel = 0.95) const;
+
+
+    //Getters
+    unsigned GetNumOutputs() const;
+    unsigned GetNumGroupsFolded() const;
+    unsigned GetNumOpenGroups() const;
+    unsigned GetNumResamples() const;
+
+};
+
+#endif /*SOBOLINDEXACCUMULATOR_HPP_*/
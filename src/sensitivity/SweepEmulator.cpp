@@ -0,0 +1,429 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SweepEmulator.hpp"
+#include "ParameterSweepDesign.hpp"
+#include "SweepJobManifest.hpp"
+#include "SobolSequence.hpp"
+#include "EnsembleStatistics.hpp"
+#include "GonadArmDataOutput.hpp"
+#include "OutputFileHandler.hpp"
+#include "Exception.hpp"
+
+#include <cmath>
+#include <map>
+#include <iomanip>
+#include <algorithm>
+#include <utility>
+#include <boost/cstdint.hpp>
+
+
+//Constructor
+SweepEmulator::SweepEmulator(const ParameterSweepDesign& rDesign)
+    : mSweepName(rDesign.GetSweepName()),
+      mParameterIndices(rDesign.rGetParameterIndices()),
+      mParameterNames(rDesign.rGetParameterNames()),
+      mMinimumValues(rDesign.rGetMinimumValues()),
+      mMaximumValues(rDesign.rGetMaximumValues()),
+      mNumTrainingRuns(0)
+{
+    const char* defaultColumns[] = {"GonadLength", "ProliferativeCount", "SpermCount", "FirstMeioticRow", "LastMitoticRow"};
+    SetColumns(std::vector<std::string>(defaultColumns, defaultColumns + 5));
+}
+
+
+//Looks the columns up by name
+void SweepEmulator::SetColumns(const std::vector<std::string>& rColumnNames)
+{
+    std::vector<std::string> allNames = GonadArmDataOutput<3>::GetColumnNames();
+    mColumns.clear();
+    for (unsigned i = 0; i < rColumnNames.size(); i++){
+        std::vector<std::string>::iterator found = std::find(allNames.begin() + 1, allNames.end(), rColumnNames[i]);
+        if (found == allNames.end()){
+            EXCEPTION("Unknown GonadData column " << rColumnNames[i]);
+        }
+        mColumns.push_back(found - allNames.begin());
+    }
+}
+
+
+//Parameter ranges onto [0,1], and back
+std::vector<double> SweepEmulator::ToUnitHypercube(const std::vector<double>& rValues) const
+{
+    std::vector<double> unitPoint(rValues.size());
+    for (unsigned p = 0; p < rValues.size(); p++){
+        double range = mMaximumValues[p] - mMinimumValues[p];
+        unitPoint[p] = (range > 0.0) ? (rValues[p] - mMinimumValues[p])/range : 0.5;
+    }
+    return unitPoint;
+}
+std::vector<double> SweepEmulator::FromUnitHypercube(const std::vector<double>& rUnitPoint) const
+{
+    std::vector<double> values(rUnitPoint.size());
+    for (unsigned p = 0; p < rUnitPoint.size(); p++){
+        values[p] = mMinimumValues[p] + rUnitPoint[p]*(mMaximumValues[p] - mMinimumValues[p]);
+    }
+    return values;
+}
+
+
+//Collects every completed design point job's records at the sampling times, then fits an emulator to each
+//column and time that enough runs have
+unsigned SweepEmulator::Train(const SweepJobManifest& rManifest, double hoursBetweenOutputs)
+{
+    if (hoursBetweenOutputs <= 0.0){
+        EXCEPTION("The hours between emulated outputs must be positive.");
+    }
+    if (rManifest.rGetParameterIndices() != mParameterIndices){
+        EXCEPTION("Sweep manifest varies different parameters from the sweep design.");
+    }
+
+    //Training data, keyed by sampling time (in multiples of hoursBetweenOutputs) and column
+    typedef std::pair<boost::int64_t, unsigned> OutputKey;
+    std::map<OutputKey, std::vector<std::vector<double> > > inputs;
+    std::map<OutputKey, std::vector<double> > outputs;
+    std::vector<std::string> columnNames = GonadArmDataOutput<3>::GetColumnNames();
+
+    mNumTrainingRuns = 0;
+    for (unsigned i = 0; i < rManifest.GetNumJobs(); i++){
+        const SweepJob& rJob = rManifest.rGetJob(i);
+        if (rJob.DesignPoint < 0 || rJob.Status != COMPLETE){
+            continue;
+        }
+        EnsembleStatistics run(columnNames);
+        run.AddRun(rJob.Directory, "GonadData");
+        std::vector<std::vector<double> > records = run.GetMeans();
+        if (records.empty()){
+            continue;
+        }
+        mNumTrainingRuns++;
+        std::vector<double> unitPoint = ToUnitHypercube(rJob.ParameterValues);
+
+        for (unsigned r = 0; r < records.size(); r++){
+            double samples = records[r][0]/hoursBetweenOutputs;
+            boost::int64_t sample = (boost::int64_t)std::floor(samples + 0.5);
+            if (sample <= 0 || std::fabs(samples - sample) > 1e-6){
+                continue;
+            }
+            for (unsigned c = 0; c < mColumns.size(); c++){
+                double value = records[r][mColumns[c]];
+                if (!(value < 1e300)){
+                    continue;   // <- missing, e.g. no meiotic cell yet
+                }
+                OutputKey key(sample, mColumns[c]);
+                inputs[key].push_back(unitPoint);
+                outputs[key].push_back(value);
+            }
+        }
+    }
+
+    mOutputColumns.clear();
+    mOutputTimes.clear();
+    mEmulators.clear();
+    mOutputVariances.clear();
+    mFirstOrderIndices.clear();
+    mTotalOrderIndices.clear();
+    unsigned minimumRuns = std::max(5u, (unsigned)std::ceil(0.9*mNumTrainingRuns));
+    for (std::map<OutputKey, std::vector<double> >::iterator output = outputs.begin(); output != outputs.end(); ++output){
+        if (output->second.size() < minimumRuns){
+            continue;
+        }
+        GaussianProcessEmulator emulator(mParameterIndices.size());
+        emulator.SetTrainingData(inputs[output->first], output->second);
+        emulator.FitHyperparameters();
+        mOutputColumns.push_back(output->first.second);
+        mOutputTimes.push_back(output->first.first*hoursBetweenOutputs);
+        mEmulators.push_back(emulator);
+    }
+    return mNumTrainingRuns;
+}
+
+
+//Saltelli's scheme: base matrices A and B are the two halves of each point of a 2d-dimensional Sobol sequence,
+//and AB_i is A with its ith column taken from B. With f evaluated at each,
+//  first order  S_i  = mean(f(B)(f(AB_i) - f(A)))/V     (Saltelli et al. 2010)
+//  total order  ST_i = mean((f(A) - f(AB_i))^2)/(2V)    (Jansen 1999)
+//where V is the variance of f(A) and f(B) together.
+void SweepEmulator::ComputeSobolIndices(unsigned numSamples)
+{
+    unsigned dimension = mParameterIndices.size();
+    if (numSamples < 2){
+        EXCEPTION("Sobol indices need at least 2 samples.");
+    }
+
+    std::vector<std::vector<double> > samplesA(numSamples);
+    std::vector<std::vector<double> > samplesB(numSamples);
+    SobolSequence sequence(2*dimension);
+    sequence.Skip(1);
+    for (unsigned s = 0; s < numSamples; s++){
+        std::vector<double> point = sequence.GetNextPoint();
+        samplesA[s].assign(point.begin(), point.begin() + dimension);
+        samplesB[s].assign(point.begin() + dimension, point.end());
+    }
+
+    mOutputVariances.assign(mEmulators.size(), 0.0);
+    mFirstOrderIndices.assign(mEmulators.size(), std::vector<double>(dimension, 0.0));
+    mTotalOrderIndices.assign(mEmulators.size(), std::vector<double>(dimension, 0.0));
+    std::vector<double> valuesA(numSamples);
+    std::vector<double> valuesB(numSamples);
+    std::vector<double> mixed;
+    for (unsigned o = 0; o < mEmulators.size(); o++){
+        const GaussianProcessEmulator& rEmulator = mEmulators[o];
+        if (rEmulator.IsConstant()){
+            continue;
+        }
+
+        double mean = 0.0;
+        for (unsigned s = 0; s < numSamples; s++){
+            valuesA[s] = rEmulator.PredictMean(samplesA[s]);
+            valuesB[s] = rEmulator.PredictMean(samplesB[s]);
+            mean += valuesA[s] + valuesB[s];
+        }
+        mean /= 2*numSamples;
+        double variance = 0.0;
+        for (unsigned s = 0; s < numSamples; s++){
+            variance += (valuesA[s] - mean)*(valuesA[s] - mean) + (valuesB[s] - mean)*(valuesB[s] - mean);
+        }
+        variance /= 2*numSamples;
+        mOutputVariances[o] = variance;
+        if (!(variance > 0.0)){
+            continue;
+        }
+
+        for (unsigned p = 0; p < dimension; p++){
+            double firstOrderSum = 0.0;
+            double totalOrderSum = 0.0;
+            for (unsigned s = 0; s < numSamples; s++){
+                mixed = samplesA[s];
+                mixed[p] = samplesB[s][p];
+                double valueAB = rEmulator.PredictMean(mixed);
+                firstOrderSum += valuesB[s]*(valueAB - valuesA[s]);
+                totalOrderSum += (valuesA[s] - valueAB)*(valuesA[s] - valueAB);
+            }
+            mFirstOrderIndices[o][p] = firstOrderSum/numSamples/variance;
+            mTotalOrderIndices[o][p] = totalOrderSum/(2.0*numSamples)/variance;
+        }
+    }
+}
+
+
+//Greedy batch selection, conditioning copies of the emulators on their own prediction at each chosen point
+std::vector<std::vector<double> > SweepEmulator::ChooseNextPoints(unsigned numPoints, unsigned numCandidates) const
+{
+    if (mEmulators.empty()){
+        EXCEPTION("The emulators must be trained before choosing new points.");
+    }
+    std::vector<std::vector<double> > candidates;
+    SobolSequence sequence(mParameterIndices.size());
+    sequence.Skip(1 + mNumTrainingRuns);
+    for (unsigned i = 0; i < numCandidates; i++){
+        candidates.push_back(sequence.GetNextPoint());
+    }
+
+    std::vector<GaussianProcessEmulator> emulators = mEmulators;
+    std::vector<std::vector<double> > chosen;
+    while (chosen.size() < numPoints && !candidates.empty()){
+        unsigned best = 0;
+        double bestScore = -1.0;
+        for (unsigned i = 0; i < candidates.size(); i++){
+            double score = 0.0;
+            for (unsigned o = 0; o < emulators.size(); o++){
+                if (emulators[o].IsConstant()){
+                    continue;
+                }
+                double mean;
+                double variance;
+                emulators[o].Predict(candidates[i], mean, variance);
+                score += variance/emulators[o].GetSignalVariance();
+            }
+            if (score > bestScore){
+                bestScore = score;
+                best = i;
+            }
+        }
+        for (unsigned o = 0; o < emulators.size(); o++){
+            emulators[o].AddPredictedRun(candidates[best]);
+        }
+        chosen.push_back(FromUnitHypercube(candidates[best]));
+        candidates.erase(candidates.begin() + best);
+    }
+    return chosen;
+}
+
+
+//Each parameter's total order index, averaged over the outputs with any variance
+std::vector<double> SweepEmulator::GetMeanTotalOrderIndices() const
+{
+    std::vector<double> means(mParameterIndices.size(), 0.0);
+    unsigned numOutputs = 0;
+    for (unsigned o = 0; o < mTotalOrderIndices.size(); o++){
+        if (!(mOutputVariances[o] > 0.0)){
+            continue;
+        }
+        for (unsigned p = 0; p < means.size(); p++){
+            means[p] += mTotalOrderIndices[o][p];
+        }
+        numOutputs++;
+    }
+    for (unsigned p = 0; p < means.size(); p++){
+        means[p] /= std::max(numOutputs, 1u);
+    }
+    return means;
+}
+
+
+//Fit, indices and ranking tables
+void SweepEmulator::WriteResults() const
+{
+    OutputFileHandler handler(mSweepName, false);
+    std::vector<std::string> columnNames = GonadArmDataOutput<3>::GetColumnNames();
+    unsigned dimension = mParameterIndices.size();
+
+    out_stream FIT = handler.OpenOutputFile("EmulatorFit.txt");
+    *FIT << std::setprecision(8);
+    *FIT << "Column\tTime\tRuns\tQ2\tSignalVariance\tNoiseVariance";
+    for (unsigned p = 0; p < dimension; p++){
+        *FIT << "\tLengthScale_P" << mParameterIndices[p];
+    }
+    *FIT << "\n";
+    for (unsigned o = 0; o < mEmulators.size(); o++){
+        const GaussianProcessEmulator& rEmulator = mEmulators[o];
+        *FIT << columnNames[mOutputColumns[o]] << "\t" << mOutputTimes[o] << "\t" << rEmulator.GetNumTrainingRuns()
+             << "\t" << rEmulator.GetLeaveOneOutQ2() << "\t" << rEmulator.GetSignalVariance() << "\t" << rEmulator.GetNoiseVariance();
+        std::vector<double> lengthScales = rEmulator.GetLengthScales();
+        for (unsigned p = 0; p < dimension; p++){
+            *FIT << "\t" << lengthScales[p];
+        }
+        *FIT << "\n";
+    }
+    FIT->close();
+
+    if (mFirstOrderIndices.empty()){
+        return;
+    }
+
+    out_stream INDICES = handler.OpenOutputFile("EmulatorSobolIndices.txt");
+    *INDICES << std::setprecision(8);
+    *INDICES << "Column\tTime\tVariance";
+    for (unsigned p = 0; p < dimension; p++){
+        *INDICES << "\tS_P" << mParameterIndices[p];
+    }
+    for (unsigned p = 0; p < dimension; p++){
+        *INDICES << "\tST_P" << mParameterIndices[p];
+    }
+    *INDICES << "\n";
+    for (unsigned o = 0; o < mEmulators.size(); o++){
+        *INDICES << columnNames[mOutputColumns[o]] << "\t" << mOutputTimes[o] << "\t" << mOutputVariances[o];
+        for (unsigned p = 0; p < dimension; p++){
+            *INDICES << "\t" << mFirstOrderIndices[o][p];
+        }
+        for (unsigned p = 0; p < dimension; p++){
+            *INDICES << "\t" << mTotalOrderIndices[o][p];
+        }
+        *INDICES << "\n";
+    }
+    INDICES->close();
+
+    //Averages over the outputs that vary, most important parameter first
+    std::vector<double> meanTotalOrder = GetMeanTotalOrderIndices();
+    std::vector<double> meanFirstOrder(dimension, 0.0);
+    std::vector<double> maxTotalOrder(dimension, 0.0);
+    unsigned numOutputs = 0;
+    for (unsigned o = 0; o < mEmulators.size(); o++){
+        if (!(mOutputVariances[o] > 0.0)){
+            continue;
+        }
+        for (unsigned p = 0; p < dimension; p++){
+            meanFirstOrder[p] += mFirstOrderIndices[o][p];
+            maxTotalOrder[p] = std::max(maxTotalOrder[p], mTotalOrderIndices[o][p]);
+        }
+        numOutputs++;
+    }
+    std::vector<std::pair<double, unsigned> > order;
+    for (unsigned p = 0; p < dimension; p++){
+        meanFirstOrder[p] /= std::max(numOutputs, 1u);
+        order.push_back(std::make_pair(-meanTotalOrder[p], p));
+    }
+    std::sort(order.begin(), order.end());
+
+    out_stream RANKING = handler.OpenOutputFile("EmulatorParameterRanking.txt");
+    *RANKING << std::setprecision(8);
+    *RANKING << "Rank\tParameter\tMeanFirstOrder\tMeanTotalOrder\tMaxTotalOrder\tName\n";
+    for (unsigned r = 0; r < order.size(); r++){
+        unsigned p = order[r].second;
+        *RANKING << r + 1 << "\t" << mParameterIndices[p] << "\t" << meanFirstOrder[p] << "\t" << meanTotalOrder[p]
+                 << "\t" << maxTotalOrder[p] << "\t" << mParameterNames[p] << "\n";
+    }
+    RANKING->close();
+}
+
+
+//Getters
+unsigned SweepEmulator::GetNumOutputs() const
+{
+    return mEmulators.size();
+}
+unsigned SweepEmulator::GetNumTrainingRuns() const
+{
+    return mNumTrainingRuns;
+}
+unsigned SweepEmulator::GetOutputColumn(unsigned output) const
+{
+    return mOutputColumns.at(output);
+}
+double SweepEmulator::GetOutputTime(unsigned output) const
+{
+    return mOutputTimes.at(output);
+}
+const GaussianProcessEmulator& SweepEmulator::rGetEmulator(unsigned output) const
+{
+    return mEmulators.at(output);
+}
+const std::vector<double>& SweepEmulator::rGetFirstOrderIndices(unsigned output) const
+{
+    return mFirstOrderIndices.at(output);
+}
+const std::vector<double>& SweepEmulator::rGetTotalOrderIndices(unsigned output) const
+{
+    return mTotalOrderIndices.at(output);
+}
+const std::vector<int>& SweepEmulator::rGetParameterIndices() const
+{
+    return mParameterIndices;
+}
+const std::vector<std::string>& SweepEmulator::rGetParameterNames() const
+{
+    return mParameterNames;
+}
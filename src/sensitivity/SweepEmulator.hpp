@@ -0,0 +1,182 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SWEEPEMULATOR_HPP_
+#define SWEEPEMULATOR_HPP_
+
+#include "GaussianProcessEmulator.hpp"
+
+#include <string>
+#include <vector>
+
+class ParameterSweepDesign;
+class SweepJobManifest;
+
+/*
+* Emulates a parameter sweep's outputs from its finished jobs, so that questions needing many more simulations
+* than were run (which parameters matter, and where the next runs would be most informative) can be answered
+* from the emulator instead.
+*
+* Each output is one GonadData column (by default GonadLength, ProliferativeCount, SpermCount, FirstMeioticRow and
+* LastMitoticRow) at one time, sampled every given number of hours, and has its own GaussianProcessEmulator of
+* how it depends on the varied parameters, trained on every completed job (replicates included). The parameter
+* ranges of the sweep design are scaled onto the unit hypercube.
+*
+* Sobol indices of each output are estimated from its emulator's mean by Monte Carlo, with the estimators of
+* Saltelli et al. (2010) for the first order indices and Jansen (1999) for the total order indices, on a Sobol
+* sequence. The first order index of a parameter is the fraction of the output's variance (over uniform
+* parameters in the sweep ranges) explained by that parameter alone; the total order index adds its
+* interactions with the others, so a parameter with a small total order index can be fixed.
+*
+* New design points are chosen where the emulators are least certain: from a set of candidate points, the one
+* with the largest predictive variance (relative to each output's variance, summed over outputs) is taken, the
+* emulators are told to expect their own prediction there, and the next is chosen, and so on. Added to the
+* manifest, these are run by resuming the sweep, after which the emulators can be trained again.
+*/
+
+class SweepEmulator
+{
+private:
+
+    //Sweep name, also its output directory
+    std::string mSweepName;
+
+    //Varied parameters and their ranges
+    std::vector<int> mParameterIndices;
+    std::vector<std::string> mParameterNames;
+    std::vector<double> mMinimumValues;
+    std::vector<double> mMaximumValues;
+
+    //GonadData columns emulated
+    std::vector<unsigned> mColumns;
+
+    //One emulator per output, with the output's column and time
+    std::vector<unsigned> mOutputColumns;
+    std::vector<double> mOutputTimes;
+    std::vector<GaussianProcessEmulator> mEmulators;
+
+    //Number of completed jobs the emulators were trained on
+    unsigned mNumTrainingRuns;
+
+    //Variance and Sobol indices of each output, from ComputeSobolIndices()
+    std::vector<double> mOutputVariances;
+    std::vector<std::vector<double> > mFirstOrderIndices;
+    std::vector<std::vector<double> > mTotalOrderIndices;
+
+    //Maps parameter values onto the unit hypercube and back
+    std::vector<double> ToUnitHypercube(const std::vector<double>& rValues) const;
+    std::vector<double> FromUnitHypercube(const std::vector<double>& rUnitPoint) const;
+
+public:
+
+    /**
+    * Constructor.
+    *
+    * @param rDesign the sweep's design, which gives the varied parameters and their ranges
+    */
+    SweepEmulator(const ParameterSweepDesign& rDesign);
+
+
+    /**
+    * Changes the GonadData columns emulated.
+    *
+    * @param rColumnNames the columns' names (see GonadArmDataOutput::GetColumnNames)
+    */
+    void SetColumns(const std::vector<std::string>& rColumnNames);
+
+
+    /**
+    * Reads the GonadData of the manifest's completed jobs and fits one emulator per column and sampling time.
+    * Times that fewer than 90% of the runs reached (e.g. after some crashed), or where a column is missing
+    * from most runs, are left out.
+    *
+    * @param rManifest the sweep's manifest
+    * @param hoursBetweenOutputs how often to sample each column
+    * @return the number of runs the emulators were trained on
+    */
+    unsigned Train(const SweepJobManifest& rManifest, double hoursBetweenOutputs);
+
+
+    /**
+    * Estimates the first and total order Sobol indices of every output from its emulator. The samples come
+    * from a Sobol sequence of twice the number of parameters, so at most 10 parameters (see SobolSequence).
+    *
+    * @param numSamples number of base samples. Each output's emulator is evaluated (number of parameters + 2)
+    * times this many.
+    */
+    void ComputeSobolIndices(unsigned numSamples);
+
+
+    /**
+    * Chooses new design points where the emulators are least certain.
+    *
+    * @param numPoints number of points to choose
+    * @param numCandidates number of points of a Sobol sequence to choose them from. The sequence starts beyond the
+    * points a Sobol design of this sweep would already have run.
+    * @return the points, in parameter values
+    */
+    std::vector<std::vector<double> > ChooseNextPoints(unsigned numPoints, unsigned numCandidates) const;
+
+
+    /**
+    * Writes, in the sweep's output directory, EmulatorFit.txt (each output's number of training runs,
+    * leave-one-out Q2 and fitted hyperparameters) and, once computed, EmulatorSobolIndices.txt (each output's
+    * variance and indices) and EmulatorParameterRanking.txt (each parameter's indices averaged over the
+    * outputs, most important first). All are tab delimited with a header row, for R.
+    */
+    void WriteResults() const;
+
+
+    /**
+    * @return each parameter's total order index averaged over the outputs that vary, in the order of the
+    * sweep's parameters
+    */
+    std::vector<double> GetMeanTotalOrderIndices() const;
+
+
+    //Getters
+    unsigned GetNumOutputs() const;
+    unsigned GetNumTrainingRuns() const;
+    unsigned GetOutputColumn(unsigned output) const;
+    double GetOutputTime(unsigned output) const;
+    const GaussianProcessEmulator& rGetEmulator(unsigned output) const;
+    const std::vector<double>& rGetFirstOrderIndices(unsigned output) const;
+    const std::vector<double>& rGetTotalOrderIndices(unsigned output) const;
+    const std::vector<int>& rGetParameterIndices() const;
+    const std::vector<std::string>& rGetParameterNames() const;
+
+};
+
+#endif /*SWEEPEMULATOR_HPP_*/
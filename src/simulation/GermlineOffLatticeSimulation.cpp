@@ -0,0 +1,170 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#include "GermlineOffLatticeSimulation.hpp"
+#include "StatechartCellCycleModel.hpp"
+#include "ApoptoticCellProperty.hpp"
+#include "GermlineProfiler.hpp"
+#include "GermlineThreadPool.hpp"
+#include "Exception.hpp"
+
+
+//Updates one slab's charts per task
+template<unsigned DIM>
+class UpdateSlabTask : public AbstractParallelTask
+{
+private:
+    GermlineOffLatticeSimulation<DIM>& mrSimulation;
+
+public:
+    UpdateSlabTask(GermlineOffLatticeSimulation<DIM>& rSimulation)
+        : mrSimulation(rSimulation)
+    {
+    }
+
+    void RunTask(unsigned taskIndex)
+    {
+        mrSimulation.UpdateSlab(taskIndex);
+    }
+};
+
+
+//Constructor. No slabs until SetSlabs.
+template<unsigned DIM>
+GermlineOffLatticeSimulation<DIM>::GermlineOffLatticeSimulation(AbstractCellPopulation<DIM>& rCellPopulation,
+                                                                bool deleteCellPopulationInDestructor,
+                                                                bool initialiseCells)
+        : OffLatticeSimulation<DIM>(rCellPopulation, deleteCellPopulationInDestructor, initialiseCells){
+}
+
+
+//Empty destructor
+template<unsigned DIM>
+GermlineOffLatticeSimulation<DIM>::~GermlineOffLatticeSimulation(){
+}
+
+
+//Setter and getter for mpSlabs
+template<unsigned DIM>
+void GermlineOffLatticeSimulation<DIM>::SetSlabs(boost::shared_ptr<ArcLengthSlabs<DIM> > pSlabs)
+{
+    mpSlabs = pSlabs;
+}
+
+template<unsigned DIM>
+boost::shared_ptr<ArcLengthSlabs<DIM> > GermlineOffLatticeSimulation<DIM>::GetSlabs() const
+{
+    return mpSlabs;
+}
+
+
+//Updates the charts gathered for one slab
+template<unsigned DIM>
+void GermlineOffLatticeSimulation<DIM>::UpdateSlab(unsigned slab)
+{
+    const std::vector<CellPtr>& r_cells = mSlabCells[slab];
+    for (unsigned i = 0; i < r_cells.size(); i++){
+        AbstractStatechartCellCycleModel* p_model = dynamic_cast<AbstractStatechartCellCycleModel*>(r_cells[i]->GetCellCycleModel());
+        p_model->UpdateAheadOfDivisionCheck();
+    }
+}
+
+
+/*
+* Gathers the cells Cell::ReadyToDivide would ask their cell cycle model about (those not dead or dying), by
+* slab, then updates them. Timed as the statechart phase, which the updates would otherwise have been.
+*/
+template<unsigned DIM>
+void GermlineOffLatticeSimulation<DIM>::UpdateStatechartsBySlab()
+{
+    ScopedProfileTimer timer(GermlineProfiler::STATECHART);
+    mpSlabs->Update(this->mrCellPopulation);
+
+    unsigned numSlabs = mpSlabs->GetNumSlabs();
+    mSlabCells.resize(numSlabs + 1);
+    for (unsigned slab = 0; slab <= numSlabs; slab++){
+        mSlabCells[slab].clear();
+    }
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mrCellPopulation.Begin();
+        cell_iter != this->mrCellPopulation.End(); ++cell_iter)
+    {
+        if (cell_iter->IsDead() || cell_iter->HasApoptosisBegun() || cell_iter->template HasCellProperty<ApoptoticCellProperty>()){
+            continue;
+        }
+        if (dynamic_cast<AbstractStatechartCellCycleModel*>(cell_iter->GetCellCycleModel()) == NULL){
+            EXCEPTION("Updating statecharts by slab requires every cell to have a statechart cell cycle model.");
+        }
+        unsigned nodeIndex = this->mrCellPopulation.GetLocationIndexUsingCell(*cell_iter);
+        mSlabCells[mpSlabs->GetSlabOfNode(nodeIndex)].push_back(*cell_iter);
+    }
+
+    UpdateSlabTask<DIM> task(*this);
+    GermlineThreadPool::Instance()->Run(task, numSlabs + 1);
+}
+
+
+//Cell birth, with the charts updated by slab first. The killers have all run by now.
+template<unsigned DIM>
+unsigned GermlineOffLatticeSimulation<DIM>::DoCellBirth()
+{
+    if (mpSlabs && mpSlabs->GetNumSlabs() > 1){
+        UpdateStatechartsBySlab();
+    }
+    return OffLatticeSimulation<DIM>::DoCellBirth();
+}
+
+
+//Parameter output to log file
+template<unsigned DIM>
+void GermlineOffLatticeSimulation<DIM>::OutputSimulationParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t<NumSlabs>" << (mpSlabs ? mpSlabs->GetNumSlabs() : 1) << "</NumSlabs>\n";
+
+    // Call method on direct parent class
+    OffLatticeSimulation<DIM>::OutputSimulationParameters(rParamsFile);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class GermlineOffLatticeSimulation<1>;
+template class GermlineOffLatticeSimulation<2>;
+template class GermlineOffLatticeSimulation<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GermlineOffLatticeSimulation)
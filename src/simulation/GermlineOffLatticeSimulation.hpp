@@ -0,0 +1,189 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef GERMLINEOFFLATTICESIMULATION_HPP_
+#define GERMLINEOFFLATTICESIMULATION_HPP_
+
+#include "OffLatticeSimulation.hpp"
+#include "ArcLengthSlabs.hpp"
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+/*
+* The off-lattice simulation GermlineSimulation runs, which can update the cells' statecharts a slab along the
+* gonad (see ArcLengthSlabs) per thread.
+*
+* A cell's chart is normally updated when the population asks the cell whether it is ready to divide, one cell
+* at a time, in DoCellBirth(). Each cell's update only reads and writes that cell's data (its random numbers
+* come from its own stream, see CellRandomStreams), so the charts of different cells can be updated at once.
+* With slabs set, DoCellBirth() first does so for every cell the check will ask, and the check then uses the
+* result (see AbstractStatechartCellCycleModel::UpdateAheadOfDivisionCheck), so the simulation's results are
+* unchanged. It runs after the cell killers, whatever order they were added in. Does nothing different unless
+* there is more than one slab.
+*/
+
+template<unsigned DIM>
+class GermlineOffLatticeSimulation : public OffLatticeSimulation<DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object. The slabs are not archived.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<OffLatticeSimulation<DIM> >(*this);
+    }
+
+    //Slabs the cells are shared out between
+    boost::shared_ptr<ArcLengthSlabs<DIM> > mpSlabs;
+
+    //Working space: the cells of each slab, and last those the slabs did not hold when last updated
+    std::vector<std::vector<CellPtr> > mSlabCells;
+
+    /**
+     * Updates the slabs, then the chart of every cell the division check will ask, a slab per thread.
+     */
+    void UpdateStatechartsBySlab();
+
+protected:
+
+    /**
+     * Overridden DoCellBirth() method. Updates the statecharts by slab, if there are slabs, before the
+     * population checks its cells for division.
+     *
+     * @return the number of births that occurred
+     */
+    virtual unsigned DoCellBirth();
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rCellPopulation reference to a cell population object
+     * @param deleteCellPopulationInDestructor whether to delete the cell population on destruction
+     * @param initialiseCells whether to initialise cells
+     */
+    GermlineOffLatticeSimulation(AbstractCellPopulation<DIM>& rCellPopulation,
+                                 bool deleteCellPopulationInDestructor=false,
+                                 bool initialiseCells=true);
+
+
+    /*
+    * Destructor
+    */
+    virtual ~GermlineOffLatticeSimulation();
+
+
+    /**
+     * Sets the slabs. They are updated every timestep before the statecharts. Not archived.
+     *
+     * @param pSlabs the slabs
+     */
+    void SetSlabs(boost::shared_ptr<ArcLengthSlabs<DIM> > pSlabs);
+
+
+    /**
+     * @return the slabs, or null if none are set
+     */
+    boost::shared_ptr<ArcLengthSlabs<DIM> > GetSlabs() const;
+
+
+    /**
+     * Updates the charts of one slab's cells. Called on the thread pool.
+     *
+     * @param slab the slab, or the number of slabs for the cells the slabs did not hold
+     */
+    void UpdateSlab(unsigned slab);
+
+
+    /**
+     * Overridden OutputSimulationParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputSimulationParameters(out_stream& rParamsFile);
+
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(GermlineOffLatticeSimulation)
+
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Serialize information required to construct a GermlineOffLatticeSimulation instance.
+ */
+template<class Archive, unsigned DIM>
+inline void save_construct_data(
+    Archive & ar, const GermlineOffLatticeSimulation<DIM> * t, const BOOST_PFTO unsigned int file_version)
+{
+    // Save data required to construct instance
+    const AbstractCellPopulation<DIM>* p_cell_population = &(t->rGetCellPopulation());
+    ar << p_cell_population;
+}
+
+/**
+ * De-serialize constructor parameters and initialise a GermlineOffLatticeSimulation.
+ */
+template<class Archive, unsigned DIM>
+inline void load_construct_data(
+    Archive & ar, GermlineOffLatticeSimulation<DIM> * t, const unsigned int file_version)
+{
+    // Retrieve data from archive required to construct new instance
+    AbstractCellPopulation<DIM>* p_cell_population;
+    ar >> p_cell_population;
+
+    // Invoke inplace constructor to initialise instance, which then owns the population
+    ::new(t)GermlineOffLatticeSimulation<DIM>(*p_cell_population, true, false);
+}
+}
+} // namespace ...
+
+#endif /*GERMLINEOFFLATTICESIMULATION_HPP_*/
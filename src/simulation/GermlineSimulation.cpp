@@ -0,0 +1,640 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GermlineSimulation.hpp"
+#include "GlobalParameterStruct.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "SmartPointers.hpp"
+#include "GermlineVolumeTrackingModifier.hpp"
+#include "CellAncestorWriter.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "ProfilingModifier.hpp"
+#include "GermlineThreadPool.hpp"
+#include "SocketSlabTransport.hpp"
+#include "MpiSlabTransport.hpp"
+#include "PetscTools.hpp"
+#include "Exception.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+
+
+//Constructor
+GermlineSimulation::GermlineSimulation()
+    : mpMesh(NULL),
+      mpCellPopulation(NULL),
+      mpSimulator(NULL)
+{}
+
+
+//Destructor. The simulator refers to the population, which refers to the mesh, so delete in that order.
+GermlineSimulation::~GermlineSimulation()
+{
+    delete mpSimulator;
+    delete mpCellPopulation;
+    delete mpMesh;
+    GermlineThreadPool::Destroy();
+}
+
+
+//The larval gonad at time 0: a row of cells along the proximal straight, led by the DTC. A second arm is
+//the mirror image of the first in the plane z = -armSeparation/2, between the arms' proximal ends.
+void GermlineSimulation::SetupFromParameters()
+{
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+
+    //parameters[45] = number of gonad arms, 1 or 2
+    unsigned numArms = 1;
+    if (parameters->GetNumParameters() > 45){
+        numArms = (unsigned)(parameters->GetParameter(45) + 0.5);
+    }
+    if (numArms != 1 && numArms != 2){
+        EXCEPTION("A gonad has one or two arms, not " << numArms << ".");
+    }
+    double armSeparation = 30.0; //Distance between the proximal ends of the two arms, in microns
+
+    // 1) Create a node corresponding to each starting cell----------------------
+
+    std::vector< Node<3>* > nodes;
+    int cellIndex = 0;
+    for (unsigned arm = 0; arm < numArms; arm++){
+        for (double i = parameters->GetParameter(0); i >= 0; i--){ //parameters[0] is number of starting cells
+            double z = (arm == 0) ? 1.8*i : -(1.8*i + armSeparation);
+            Node<3>* newNode;
+            newNode = new Node<3>(cellIndex, false, 0, -parameters->GetParameter(7), z); //cellID, _, x, y, z
+            nodes.push_back(newNode);
+            cellIndex++;
+        }
+    }
+
+    //----------------------------------------------------------------------------
+
+
+
+    // 2) Initialise some cells from the nodes, using the chosen cell cycle model-
+
+    std::vector<CellPtr> cells;
+    MAKE_PTR(StemCellProliferativeType, p_stem_type);
+
+    StatechartModelRegistry::Instance()->GetSelectedModel().GenerateCells(cells, nodes.size(), p_stem_type);
+    CreateCellPopulation(nodes, cells);
+
+    //----------------------------------------------------------------------------
+
+
+
+    // 3) Setup the properties of the cells---------------------------------------
+
+    InitialiseCellData(numArms);
+    mpCellPopulation->SetCellAncestorsToLocationIndices();    // Request cell lineage tracking
+
+    //----------------------------------------------------------------------------
+
+
+
+    // 4) Initial gonad midline of each arm, along which its DTC moves------------
+
+    double MidlinePointSpacing = 2;
+    double initialGonadLength = 32;
+    unsigned nodesPerArm = nodes.size()/numArms;
+    std::vector<boost::shared_ptr<DTCMovementModel<3> > > leaderCells;
+    for (unsigned arm = 0; arm < numArms; arm++){
+        std::vector< c_vector<double, 3> > MidlinePointCollection; // Points on the DTC path
+        std::vector< int > MidlinePointTypes;                      // Records whether a point is part of a straight or the turn
+
+        double newPointZ = 0;
+        c_vector<double, 3> aPoint;
+        while (newPointZ < initialGonadLength){
+            aPoint[0] = 0;
+            aPoint[1] = -parameters->GetParameter(7);   //y coord of the middle of the proximal straight
+            aPoint[2] = (arm == 0) ? newPointZ : -(newPointZ + armSeparation);
+            MidlinePointCollection.push_back(aPoint);
+            MidlinePointTypes.push_back(0);             //0 codes for "part of the proximal straight"
+            newPointZ += MidlinePointSpacing;
+        }
+        MAKE_PTR_ARGS(DTCMovementModel<3>, dtcMovement, (false, false, 0.0, MidlinePointCollection, MidlinePointTypes, aPoint, MidlinePointSpacing));
+        if (numArms > 1){
+            dtcMovement->setArm(arm, arm*nodesPerArm);
+        }
+        leaderCells.push_back(dtcMovement);
+    }
+
+    //----------------------------------------------------------------------------
+
+    CreateSimulator(false, leaderCells, parameters->GetParameter(28)); //Parameters[28]: initial gonad radius
+}
+
+
+//A straight tube of cells with the DTC at its distal end, as the proximal straight looks once packed
+void GermlineSimulation::SetupSynthetic(unsigned numCells, double tubeLength)
+{
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+    if (numCells < 2 || tubeLength < 4.0){
+        EXCEPTION("A synthetic gonad needs at least two cells and a tube at least 4 microns long.");
+    }
+
+    //The tube is made wide enough for the cells to fill 60% of it, close to random close packing
+    double cellRadius = parameters->GetParameter(9);
+    double tubeRadius = sqrt(numCells*4.0*cellRadius*cellRadius*cellRadius/(3.0*0.6*tubeLength));
+    tubeRadius = std::max(tubeRadius, 2.0*cellRadius);
+    double midlineY = -parameters->GetParameter(7);
+
+    //Node 0 is the DTC, at the distal end. The germ cells are scattered at random through the tube.
+    std::vector< Node<3>* > nodes;
+    nodes.push_back(new Node<3>(0, false, 0, midlineY, tubeLength));
+    RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+    double maxDistanceFromMidline = tubeRadius - cellRadius;
+    while (nodes.size() < numCells){
+        double x = (2.0*p_gen->ranf() - 1.0)*maxDistanceFromMidline;
+        double y = (2.0*p_gen->ranf() - 1.0)*maxDistanceFromMidline;
+        if (x*x + y*y > maxDistanceFromMidline*maxDistanceFromMidline){
+            continue;
+        }
+        nodes.push_back(new Node<3>(nodes.size(), false, x, midlineY + y, p_gen->ranf()*tubeLength));
+    }
+
+    std::vector<CellPtr> cells;
+    MAKE_PTR(StemCellProliferativeType, p_stem_type);
+    StatechartModelRegistry::Instance()->GetSelectedModel().GenerateCells(cells, nodes.size(), p_stem_type);
+    CreateCellPopulation(nodes, cells);
+
+    //The cells start with the distances and volumes the boundary condition and volume tracking would give them,
+    //and the proximal half are oocyte fated, so that the cell killers have cells to consider
+    InitialiseCellData(1);
+    double relaxedVolume = 4.0*M_PI*cellRadius*cellRadius*cellRadius/3.0;
+    for (AbstractCellPopulation<3>::Iterator cell_iter = mpCellPopulation->Begin();
+        cell_iter != mpCellPopulation->End(); ++cell_iter)
+    {
+        double distanceAwayFromDTC = tubeLength - mpCellPopulation->GetLocationOfCellCentre(*cell_iter)[2];
+        cell_iter->GetCellData()->SetItem("DistanceAwayFromDTC", distanceAwayFromDTC);
+        cell_iter->GetCellData()->SetItem("MaxRadius", tubeRadius);
+        cell_iter->GetCellData()->SetItem("volume", relaxedVolume);
+        if (cell_iter->GetCellData()->GetItem("IsDTC") == 0.0 && distanceAwayFromDTC > 0.5*tubeLength){
+            cell_iter->GetCellData()->SetItem("OocyteFated", 1.0);
+        }
+    }
+    mpCellPopulation->SetCellAncestorsToLocationIndices();
+
+    //A straight midline from the proximal end to the DTC
+    double MidlinePointSpacing = 2;
+    std::vector< c_vector<double, 3> > MidlinePointCollection;
+    std::vector< int > MidlinePointTypes;
+    c_vector<double, 3> aPoint;
+    for (double z = 0; z <= tubeLength; z += MidlinePointSpacing){
+        aPoint[0] = 0;
+        aPoint[1] = midlineY;
+        aPoint[2] = z;
+        MidlinePointCollection.push_back(aPoint);
+        MidlinePointTypes.push_back(0);
+    }
+    MAKE_PTR_ARGS(DTCMovementModel<3>, dtcMovement, (false, false, 0.0, MidlinePointCollection, MidlinePointTypes, aPoint, MidlinePointSpacing));
+
+    CreateSimulator(false, std::vector<boost::shared_ptr<DTCMovementModel<3> > >(1, dtcMovement), tubeRadius);
+}
+
+
+//Rebuilds the simulation from a snapshot. Global state comes first, since the cell cycle models read the
+//parameters and time as they are created, and the random number generator last, since they also draw from it.
+void GermlineSimulation::SetupFromSnapshot(const GermlineSnapshot& rSnapshot)
+{
+    rSnapshot.RestoreParametersAndTime();
+
+    std::vector< Node<3>* > nodes;
+    rSnapshot.CreateNodes(nodes);
+    std::vector<CellPtr> cells;
+    rSnapshot.CreateCells(StatechartModelRegistry::Instance()->GetSelectedModel(), cells);
+    CreateCellPopulation(nodes, cells);
+
+    MAKE_PTR_ARGS(DTCMovementModel<3>, dtcMovement, (rSnapshot.GetUnc5(), rSnapshot.GetVab3(), rSnapshot.GetTimeSinceLastUpdate(),
+                                                      rSnapshot.GetPathPointCollection(), rSnapshot.GetPathPointTypes(),
+                                                      rSnapshot.GetLeaderCellLocation(), rSnapshot.GetSpacing()));
+    dtcMovement->setTurnComplete(rSnapshot.GetTurnComplete());
+    CreateSimulator(true, std::vector<boost::shared_ptr<DTCMovementModel<3> > >(1, dtcMovement), rSnapshot.GetTubeRadius());
+
+    rSnapshot.RestoreRandomNumberGenerator();
+}
+
+
+//Checkpoints are taken on whole hours, so need the number of timesteps per hour
+void GermlineSimulation::AddCheckpointing(double simulatedHoursBetweenCheckpoints, double wallClockMinutesBetweenCheckpoints)
+{
+    if (mpSimulator == NULL){
+        EXCEPTION("Set up the simulation before adding checkpointing.");
+    }
+    if (mLeaderCells.size() > 1){
+        EXCEPTION("Checkpoints only hold one gonad arm.");
+    }
+    unsigned timestepsPerHour = (unsigned)(GlobalParameterStruct::Instance()->PeekParameter(36) + 0.5);
+    mpCheckpointing.reset(new GermlineCheckpointModifier(mLeaderCells[0], mBoundaryConditions[0], mpApoptosis,
+                                                         simulatedHoursBetweenCheckpoints, wallClockMinutesBetweenCheckpoints,
+                                                         timestepsPerHour));
+    mpCheckpointing->SetDataOutput(mDataOutputs[0]);
+    mpCheckpointing->SetLineageOutput(mpLineageOutput);
+    mpSimulator->AddSimulationModifier(mpCheckpointing);
+}
+
+
+//Points the data output and checkpointing at the results folder of the run being continued
+void GermlineSimulation::ContinueInDirectory(std::string resultsDirectory)
+{
+    if (mpSimulator == NULL){
+        EXCEPTION("Set up the simulation before choosing where it continues.");
+    }
+    resultsDirectory = GetProcessDirectory(resultsDirectory);
+    for (unsigned arm = 0; arm < mDataOutputs.size(); arm++){
+        mDataOutputs[arm]->SetAppendDirectory(resultsDirectory);
+    }
+    mpTrackingOutput->SetAppendDirectory(resultsDirectory);
+    mpLineageOutput->SetAppendDirectory(resultsDirectory);
+    if (mpCheckpointing){
+        mpCheckpointing->SetCheckpointDirectory(resultsDirectory);
+    }
+}
+
+
+//Ends the other processes of a run split across several
+void GermlineSimulation::FinishProcesses()
+{
+    if (mpTransport){
+        mpTransport->Finish();
+    }
+}
+
+
+//Process 0 writes to the directory itself
+std::string GermlineSimulation::GetProcessDirectory(std::string directory) const
+{
+    unsigned rank = GetProcessRank();
+    if (rank == 0){
+        return directory;
+    }
+    std::stringstream processDirectory;
+    processDirectory << directory;
+    if (!directory.empty() && directory[directory.size() - 1] != '/'){
+        processDirectory << "/";
+    }
+    processDirectory << "Process" << rank;
+    return processDirectory.str();
+}
+
+
+//Takes and writes a snapshot
+void GermlineSimulation::SaveSnapshot(std::string filePath)
+{
+    if (mpSimulator == NULL){
+        EXCEPTION("Set up the simulation before saving a snapshot.");
+    }
+    if (mLeaderCells.size() > 1){
+        EXCEPTION("Snapshots only hold one gonad arm.");
+    }
+    GermlineSnapshot snapshot;
+    snapshot.Capture(*mpCellPopulation, *mLeaderCells[0], *mBoundaryConditions[0], *mpApoptosis);
+    snapshot.WriteToFile(filePath);
+}
+
+
+//Mesh and population settings shared by new and restored simulations
+void GermlineSimulation::CreateCellPopulation(std::vector<Node<3>*>& rNodes, std::vector<CellPtr>& rCells)
+{
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+
+    mpMesh = new NodesOnlyMesh<3>;                    //make a 3D mesh from the nodes
+    mpMesh->ConstructNodesWithoutMesh(rNodes, 25);    //specify a max interaction distance of 25, > 2x max cell radius
+    for (unsigned i = 0; i < rNodes.size(); i++){
+        delete rNodes[i];                             //the mesh holds its own copies
+    }
+    rNodes.clear();
+
+    mpCellPopulation = new NodeBasedCellPopulation<3>(*mpMesh, rCells);
+    mpCellPopulation->SetAbsoluteMovementThreshold(2.5);                      // Max cell movement in one timestep
+    mpCellPopulation->SetDampingConstantNormal(parameters->GetParameter(12)); // Baseline cell drag coefficient
+    mpCellPopulation->SetUseVariableRadii(true);                              // Different sized cells will be used
+    mpCellPopulation->AddCellWriter<CellAncestorWriter>();
+}
+
+
+//Cell data every new simulation starts with. The first cell of each arm's block of node indices is its DTC.
+void GermlineSimulation::InitialiseCellData(unsigned numArms)
+{
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+    MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
+    unsigned nodesPerArm = mpCellPopulation->GetNumRealCells()/numArms;
+
+    for (AbstractCellPopulation<3>::Iterator cell_iter = mpCellPopulation->Begin();
+        cell_iter != mpCellPopulation->End(); ++cell_iter)
+    {
+        Node<3>* node = mpCellPopulation->GetNode(mpCellPopulation->GetLocationIndexUsingCell(*cell_iter));
+        if (numArms > 1){
+            cell_iter->GetCellData()->SetItem("Arm", (double)(node->GetIndex()/nodesPerArm));
+        }
+        if (node->GetIndex() % nodesPerArm == 0){
+            cell_iter->GetCellData()->SetItem("IsDTC", 1.0);  //Make the first cell of each arm the DTC
+            cell_iter->SetCellProliferativeType(p_diff_type); //The DTC is terminally differentiated
+        }
+        else{
+            cell_iter->GetCellData()->SetItem("IsDTC", 0.0);
+        }
+        cell_iter->GetCellData()->SetItem("DistanceAwayFromDTC", 0.0); //Set other cell data
+        cell_iter->GetCellData()->SetItem("RowNumber", 0.0);
+        cell_iter->GetCellData()->SetItem("Radius", parameters->GetParameter(9));  // parameters[9] = initial radius
+        cell_iter->GetCellData()->SetItem("MaxRadius", parameters->GetParameter(9));
+        cell_iter->GetCellData()->SetItem("SpermFated", 0.0);
+        cell_iter->GetCellData()->SetItem("OocyteFated", 0.0);
+        cell_iter->GetCellData()->SetItem("Differentiation_Sperm", 0.0);
+        cell_iter->GetCellData()->SetItem("Differentiation_Oocyte", 0.0);
+        cell_iter->GetCellData()->SetItem("Fertilised", 0.0);
+        cell_iter->GetCellData()->SetItem("PreviousClosestPointIndex", -1);
+        cell_iter->GetCellData()->SetItem("ArrestedFor", 0.0);
+        cell_iter->GetCellData()->SetItem("InProximalArm", 1.0);
+    }
+}
+
+
+//Adds the forces, boundary condition, modifiers, killers and output, which are the same for new and restored simulations
+void GermlineSimulation::CreateSimulator(bool restoring, const std::vector<boost::shared_ptr<DTCMovementModel<3> > >& rLeaderCells,
+                                         double tubeRadius)
+{
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+    unsigned numArms = rLeaderCells.size();
+
+    // 5) Setup the simulation----------------------------------------------------
+
+    //Under mpirun, the slabs' forces are shared out between the MPI processes. Otherwise parameters[48] = processes
+    //on this machine to share them out between (0 or 1 = this one only), forked here, before any threads start.
+    //Every process holds every cell and runs the whole simulation; all but process 0 write their output to a subdirectory.
+    mpTransport.reset();
+    if (PetscTools::IsParallel()){
+        mpTransport.reset(new MpiSlabTransport());
+    }else if (parameters->GetNumParameters() > 48 && parameters->PeekParameter(48) > 1.5){
+        mpTransport.reset(new SocketSlabTransport((unsigned)(parameters->PeekParameter(48) + 0.5)));
+    }
+
+    mpSimulator = new GermlineOffLatticeSimulation<3>(*mpCellPopulation, false, !restoring);
+    mpSimulator->SetOutputDirectory(GetProcessDirectory(parameters->GetDirectory()).c_str());    // Set output directory name
+    mpSimulator->SetSamplingTimestepMultiple(parameters->GetParameter(36)); // How frequently to output a snapshot
+    mpSimulator->SetDt(1.0/parameters->GetParameter(36));                   // Length of a timestep (parameters[36])
+    mpSimulator->SetEndTime(parameters->GetParameter(35));                  // End time (parameters[35])
+
+    //parameters[46] = threads the arms' forces and boundary conditions are shared out among (1 = none besides
+    //this one). Only the time taken depends on it, so only peeked at.
+    unsigned numThreads = 1;
+    if (parameters->GetNumParameters() > 46){
+        numThreads = (unsigned)(parameters->PeekParameter(46) + 0.5);
+    }
+    GermlineThreadPool::Instance()->SetNumThreads(numThreads);
+
+    //parameters[47] = arc length slabs the force, boundary condition and statecharts share the cells out between,
+    //a slab at a time on each thread (0 or 1 = none). Peeked at for the same reason.
+    //Split across processes, there must be a slab for each process at least.
+    unsigned numSlabs = 1;
+    if (parameters->GetNumParameters() > 47 && parameters->PeekParameter(47) > 1.5){
+        numSlabs = (unsigned)(parameters->PeekParameter(47) + 0.5);
+    }
+    if (mpTransport && mpTransport->GetNumProcesses() > numSlabs){
+        numSlabs = mpTransport->GetNumProcesses();
+    }
+    mpSlabs.reset();
+    if (numSlabs > 1){
+        mpSlabs.reset(new ArcLengthSlabs<3>(numSlabs));
+    }
+    mpSimulator->SetSlabs(mpSlabs);      //with slabs, the statecharts are updated a slab per thread before cell birth
+
+    //----------------------------------------------------------------------------
+
+
+
+    // 6) Add a force between cells-----------------------------------------------
+
+    mpForce.reset(new RepulsionForceSizeCorrected<3>());
+    mpForce->SetMeinekeSpringStiffness(parameters->GetParameter(13));   //Set force strength (parameters[13])
+    //parameters[42] = estimate cell volumes from the overlaps the force finds (0 = use Chaste's cell volumes)
+    bool estimateVolumes = parameters->GetNumParameters() > 42 && parameters->GetParameter(42) > 0;
+    mpForce->SetEstimateVolumes(estimateVolumes);
+    mpForce->SetNumArms(numArms);
+    if (mpSlabs){
+        mpForce->SetSlabs(mpSlabs);
+    }
+    if (mpTransport){
+        mpForce->SetTransport(mpTransport);
+    }
+    mpSimulator->AddForce(mpForce);
+
+    //----------------------------------------------------------------------------
+
+
+
+    // 7) Boundary Condition------------------------------------------------------
+
+    //add code that moves each DTC, and a leader cell based boundary condition for each arm
+    mLeaderCells = rLeaderCells;
+    mBoundaryConditions.clear();
+    for (unsigned arm = 0; arm < numArms; arm++){
+        mpSimulator->AddSimulationModifier(mLeaderCells[arm]);
+        boost::shared_ptr<LeaderCellBoundaryCondition<3> > p_boundary(
+            new LeaderCellBoundaryCondition<3>(mpCellPopulation, mLeaderCells[arm], tubeRadius));
+        if (mpSlabs){
+            p_boundary->SetSlabs(mpSlabs);
+        }
+        mBoundaryConditions.push_back(p_boundary);
+    }
+    //with more than one arm, the arms' boundary conditions are applied together
+    if (numArms == 1){
+        mpSimulator->AddCellPopulationBoundaryCondition(mBoundaryConditions[0]);
+    }else{
+        MAKE_PTR_ARGS(GonadArmsBoundaryCondition<3>, armsBoundaryCondition, (mpCellPopulation));
+        for (unsigned arm = 0; arm < numArms; arm++){
+            armsBoundaryCondition->AddArm(mBoundaryConditions[arm]);
+        }
+        mpSimulator->AddCellPopulationBoundaryCondition(armsBoundaryCondition);
+    }
+
+    //---------------------------------------------------------------------------
+
+
+
+    // 8) Cell volume tracking, required to apply contact inhibition-------------
+
+    //Only works out the volumes contact inhibition and GonadArmDataOutput are about to read, so must be added
+    //before GonadArmDataOutput, with its sampling interval. parameters[36] = timesteps per hour
+    //Not needed if the force already records every cell's volume.
+    if (!estimateVolumes){
+        MAKE_PTR_ARGS(GermlineVolumeTrackingModifier<3>, volumeTrackingForContactInhibition, (parameters->GetParameter(36)));
+        mpSimulator->AddSimulationModifier(volumeTrackingForContactInhibition);
+    }
+
+    //---------------------------------------------------------------------------
+
+
+
+    // 9) Cell removal, by fertilization and apoptosis---------------------------
+
+    double lengthOfOvulationRegion = 20.0; //How close to the gonad's proximal end must a cell be before it can be removed
+    mFertilisations.clear();
+    for (unsigned arm = 0; arm < numArms; arm++){
+        boost::shared_ptr<Fertilisation<3> > p_fertilisation(new Fertilisation<3>(mpCellPopulation, lengthOfOvulationRegion));
+        if (numArms > 1){
+            p_fertilisation->SetArm(arm);      //each arm ovulates into its own spermatheca
+        }
+        mFertilisations.push_back(p_fertilisation);
+        mpSimulator->AddCellKiller(p_fertilisation);
+    }
+    //parameters[21] = cell death rate. Its first use is recorded by the killer (see SaveSnapshot)
+    mpApoptosis.reset(new OocyteFatedCellApoptosis<3>(mpCellPopulation, parameters->PeekParameter(21)));
+    mpSimulator->AddCellKiller(mpApoptosis);
+
+    //---------------------------------------------------------------------------
+
+
+
+    // 10) Add some data output--------------------------------------------------
+
+    mDataOutputs.clear();
+    for (unsigned arm = 0; arm < numArms; arm++){
+        boost::shared_ptr<GonadArmDataOutput<3> > p_data_output(new GonadArmDataOutput<3>(parameters->GetParameter(36))); // parameters[36] = timesteps per hour
+        if (numArms > 1){
+            p_data_output->SetArm(arm);
+        }
+        p_data_output->SetBoundaryCondition(mBoundaryConditions[arm]); // reuses the distances from the DTC it works out
+        mDataOutputs.push_back(p_data_output);
+        mpSimulator->AddSimulationModifier(p_data_output);
+    }
+    mpTrackingOutput.reset(new CellTrackingOutput<3>(parameters->GetParameter(36), 1));
+    mpSimulator->AddSimulationModifier(mpTrackingOutput);
+    mpLineageOutput.reset(new LineageOutput<3>());
+    mpSimulator->AddSimulationModifier(mpLineageOutput);
+
+    //----------------------------------------------------------------------------
+
+
+
+    // 11) Periodic checkpoints, if the parameter file asks for them--------------
+
+    //parameters[39] = simulated hours between checkpoints, parameters[40] = wall clock minutes between
+    //checkpoints. Neither affects the simulation itself, so they are only peeked at. Checkpoints only hold one arm.
+    //Every process holds the same cells, so only process 0 takes them.
+    if (parameters->GetNumParameters() > 40 && GetProcessRank() == 0){
+        if (numArms == 1){
+            AddCheckpointing(parameters->PeekParameter(39), parameters->PeekParameter(40));
+        }else if (parameters->PeekParameter(39) > 0 || parameters->PeekParameter(40) > 0){
+            std::cout << "Checkpoints are not taken of a gonad with two arms." << std::endl;
+        }
+    }
+
+    //----------------------------------------------------------------------------
+
+
+
+    // 12) Profiling, if the parameter file asks for it---------------------------
+
+    //parameters[44] = write Profile.json, timing each part of a timestep (0 = off). Does not affect the
+    //simulation itself, so only peeked at. Added last, so the output modifiers count towards each step.
+    if (parameters->GetNumParameters() > 44 && parameters->PeekParameter(44) > 0){
+        MAKE_PTR_ARGS(ProfilingModifier<3>, profiling, ((unsigned)(parameters->PeekParameter(36) + 0.5)));
+        mpSimulator->AddSimulationModifier(profiling);
+    }
+
+    //----------------------------------------------------------------------------
+}
+
+
+//Getters
+OffLatticeSimulation<3>& GermlineSimulation::rGetSimulator()
+{
+    return *mpSimulator;
+}
+
+NodeBasedCellPopulation<3>& GermlineSimulation::rGetCellPopulation()
+{
+    return *mpCellPopulation;
+}
+
+unsigned GermlineSimulation::GetNumArms() const
+{
+    return mLeaderCells.size();
+}
+
+boost::shared_ptr<DTCMovementModel<3> > GermlineSimulation::GetLeaderCell(unsigned arm)
+{
+    if (arm >= mLeaderCells.size()){
+        EXCEPTION("The gonad has no arm " << arm << ".");
+    }
+    return mLeaderCells[arm];
+}
+
+boost::shared_ptr<LeaderCellBoundaryCondition<3> > GermlineSimulation::GetBoundaryCondition(unsigned arm)
+{
+    if (arm >= mBoundaryConditions.size()){
+        EXCEPTION("The gonad has no arm " << arm << ".");
+    }
+    return mBoundaryConditions[arm];
+}
+
+boost::shared_ptr<OocyteFatedCellApoptosis<3> > GermlineSimulation::GetApoptosis()
+{
+    return mpApoptosis;
+}
+
+boost::shared_ptr<RepulsionForceSizeCorrected<3> > GermlineSimulation::GetForce()
+{
+    return mpForce;
+}
+
+boost::shared_ptr<ArcLengthSlabs<3> > GermlineSimulation::GetSlabs()
+{
+    return mpSlabs;
+}
+
+unsigned GermlineSimulation::GetProcessRank() const
+{
+    return mpTransport ? mpTransport->GetRank() : 0;
+}
+
+boost::shared_ptr<Fertilisation<3> > GermlineSimulation::GetFertilisation(unsigned arm)
+{
+    if (arm >= mFertilisations.size()){
+        EXCEPTION("The gonad has no arm " << arm << ".");
+    }
+    return mFertilisations[arm];
+}
+
+boost::shared_ptr<GonadArmDataOutput<3> > GermlineSimulation::GetDataOutput(unsigned arm)
+{
+    if (arm >= mDataOutputs.size()){
+        EXCEPTION("The gonad has no arm " << arm << ".");
+    }
+    return mDataOutputs[arm];
+}
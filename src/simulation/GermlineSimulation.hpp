@@ -0,0 +1,241 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GERMLINESIMULATION_HPP_
+#define GERMLINESIMULATION_HPP_
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "GermlineOffLatticeSimulation.hpp"
+#include "DTCMovementModel.hpp"
+#include "LeaderCellBoundaryCondition.hpp"
+#include "GonadArmsBoundaryCondition.hpp"
+#include "RepulsionForceSizeCorrected.hpp"
+#include "Fertilisation.hpp"
+#include "OocyteFatedCellApoptosis.hpp"
+#include "StatechartModelRegistry.hpp"
+#include "GonadArmDataOutput.hpp"
+#include "CellTrackingOutput.hpp"
+#include "LineageOutput.hpp"
+#include "GermlineSnapshot.hpp"
+#include "GermlineCheckpointModifier.hpp"
+
+/*
+* Builds a complete C. elegans germline simulation: DTC, gonad boundary, force law, contact inhibition,
+* cell removal, data output and checkpointing, all configured from the GlobalParameterStruct. A simulation
+* can either be set up from scratch (the starting row of cells behind the DTC) or restored from a
+* GermlineSnapshot.
+*
+* The object owns the mesh, cell population and simulator, and keeps the components needed to take a
+* snapshot. Only one simulation should exist at a time, since the parameters and simulation time are global.
+*
+* The cells' statechart model is the one parameter 49 chooses from the StatechartModelRegistry, by name or number.
+*
+* If parameter 45 asks for two, a new simulation holds both arms of the gonad in one population, on one
+* clock: arm 1 is the mirror image of arm 0 through the worm's centre, with its own DTC, midline, boundary
+* condition, fertilisation and GonadDataArm1 output. The arms' forces and boundary conditions are shared out
+* among the threads of the GermlineThreadPool, as many as parameter 46 asks for. Snapshots and checkpoints
+* only hold one arm, so are not available for two.
+*
+* If parameter 47 asks for more than one, the cells are also split into slabs along the gonad (see
+* ArcLengthSlabs), and the force, boundary condition and statechart updates do a slab at a time on each thread.
+* The slabs' forces can also be shared out between processes: the processes of an MPI run, or as many as
+* parameter 48 asks for, forked on this machine (see AbstractSlabTransport). Each process runs the whole
+* simulation and process 0 writes the usual output; the others write theirs to a Process<number> subdirectory,
+* and only process 0 takes checkpoints. Every process must call FinishProcesses() once the simulation is over.
+*/
+
+class GermlineSimulation
+{
+private:
+
+    //Owned objects
+    NodesOnlyMesh<3>* mpMesh;
+    NodeBasedCellPopulation<3>* mpCellPopulation;
+    GermlineOffLatticeSimulation<3>* mpSimulator;
+
+    //Components that hold state a snapshot needs, or that callers may want to query. Those belonging to an
+    //arm are stored in order of arm.
+    std::vector<boost::shared_ptr<DTCMovementModel<3> > > mLeaderCells;
+    std::vector<boost::shared_ptr<LeaderCellBoundaryCondition<3> > > mBoundaryConditions;
+    boost::shared_ptr<OocyteFatedCellApoptosis<3> > mpApoptosis;
+    boost::shared_ptr<RepulsionForceSizeCorrected<3> > mpForce;
+    std::vector<boost::shared_ptr<Fertilisation<3> > > mFertilisations;
+
+    //Slabs along the gonad shared by the force, boundary conditions and statechart updates, or null for none
+    boost::shared_ptr<ArcLengthSlabs<3> > mpSlabs;
+
+    //Carries forces between the processes the slabs are shared out between, or null for one process
+    boost::shared_ptr<AbstractSlabTransport> mpTransport;
+
+    //Components that write to the output directory
+    std::vector<boost::shared_ptr<GonadArmDataOutput<3> > > mDataOutputs;
+    boost::shared_ptr<CellTrackingOutput<3> > mpTrackingOutput;
+    boost::shared_ptr<LineageOutput<3> > mpLineageOutput;
+    boost::shared_ptr<GermlineCheckpointModifier> mpCheckpointing;
+
+    /**
+    * Builds the mesh and cell population from nodes and matching cells, and applies the population settings.
+    *
+    * @param rNodes one node per cell, with node 0 the DTC. Deleted once copied into the mesh.
+    * @param rCells the cells
+    */
+    void CreateCellPopulation(std::vector<Node<3>*>& rNodes, std::vector<CellPtr>& rCells);
+
+    /**
+    * Gives every cell of a new simulation its starting cell data. The nodes are split into equal, consecutive
+    * blocks, one per arm, and the first node of each block is that arm's DTC. With more than one arm, each
+    * cell also records its arm as its "Arm" cell data.
+    *
+    * @param numArms the number of arms
+    */
+    void InitialiseCellData(unsigned numArms);
+
+    /**
+    * Creates the simulator and adds the force, boundary condition, modifiers, killers and output.
+    *
+    * @param restoring whether the cells come from a snapshot, in which case their cell cycle models are
+    * not initialised again
+    * @param rLeaderCells the DTC movement modifier of each arm, already holding its path
+    * @param tubeRadius current radius of the gonad tube
+    */
+    void CreateSimulator(bool restoring, const std::vector<boost::shared_ptr<DTCMovementModel<3> > >& rLeaderCells,
+                         double tubeRadius);
+
+public:
+
+    /**
+    * Constructor. Call one of the Setup methods before use.
+    */
+    GermlineSimulation();
+
+
+    /**
+    * Destructor. Deletes the simulator, population and mesh, and stops the thread pool's threads.
+    */
+    ~GermlineSimulation();
+
+
+    /**
+    * Sets up a new simulation at time 0 from the global parameters, with one or two gonad arms.
+    */
+    void SetupFromParameters();
+
+
+    /**
+    * Sets up a synthetic gonad for benchmarking: a straight tube of the given length, filled with cells
+    * scattered at random, with the DTC at its distal end and the proximal half of the cells oocyte fated.
+    * The tube's radius is chosen so that the cells fill 60% of it. Uses the current simulation time.
+    *
+    * @param numCells the number of cells, including the DTC
+    * @param tubeLength the length of the tube, in microns
+    */
+    void SetupSynthetic(unsigned numCells, double tubeLength);
+
+
+    /**
+    * Restores a simulation from a snapshot, including the global parameters, simulation time and random
+    * number generator. The end time and output directory are taken from the restored parameters.
+    *
+    * @param rSnapshot the snapshot to restore
+    */
+    void SetupFromSnapshot(const GermlineSnapshot& rSnapshot);
+
+
+    /**
+    * Adds a GermlineCheckpointModifier, which periodically writes snapshots to the output directory.
+    * Called by the Setup methods if the parameter file gives checkpoint intervals (parameters 39 and 40).
+    * Only for one arm.
+    *
+    * @param simulatedHoursBetweenCheckpoints simulated time between checkpoints, 0 for none
+    * @param wallClockMinutesBetweenCheckpoints real time between checkpoints, 0 for none
+    */
+    void AddCheckpointing(double simulatedHoursBetweenCheckpoints, double wallClockMinutesBetweenCheckpoints);
+
+
+    /**
+    * Makes a restored simulation carry on in the results folder of the run it was restored from: data is
+    * appended to that folder's GonadData.txt and TrackingData.txt, and checkpoints continue to rotate there,
+    * rather than starting afresh in the new results_from_time_X folder Chaste creates on Solve.
+    *
+    * @param resultsDirectory the results folder, relative to where Chaste output is stored
+    */
+    void ContinueInDirectory(std::string resultsDirectory);
+
+
+    /**
+    * Takes a snapshot of the current state and writes it to file. Only for one arm.
+    *
+    * @param filePath full path of the file to write
+    */
+    void SaveSnapshot(std::string filePath);
+
+
+    /**
+    * Once the simulation is over, ends the processes it was split across: a forked process exits, so this
+    * does not return in it, and process 0 waits for the others. Does nothing for a run in one process.
+    */
+    void FinishProcesses();
+
+
+    /**
+    * @return the directory a process writes its output to: the given one for process 0, and its
+    * Process<number> subdirectory for the others
+    *
+    * @param directory the run's output directory, relative to where Chaste output is stored
+    */
+    std::string GetProcessDirectory(std::string directory) const;
+
+
+    //Getters. Those of an arm's components default to arm 0.
+    OffLatticeSimulation<3>& rGetSimulator();
+    NodeBasedCellPopulation<3>& rGetCellPopulation();
+    unsigned GetNumArms() const;
+    boost::shared_ptr<DTCMovementModel<3> > GetLeaderCell(unsigned arm = 0);
+    boost::shared_ptr<LeaderCellBoundaryCondition<3> > GetBoundaryCondition(unsigned arm = 0);
+    boost::shared_ptr<OocyteFatedCellApoptosis<3> > GetApoptosis();
+    boost::shared_ptr<RepulsionForceSizeCorrected<3> > GetForce();
+    boost::shared_ptr<ArcLengthSlabs<3> > GetSlabs();
+    unsigned GetProcessRank() const;
+    boost::shared_ptr<Fertilisation<3> > GetFertilisation(unsigned arm = 0);
+    boost::shared_ptr<GonadArmDataOutput<3> > GetDataOutput(unsigned arm = 0);
+
+};
+
+#endif /*GERMLINESIMULATION_HPP_*/
@@ -0,0 +1,188 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "RunManifest.hpp"
+#include "GlobalParameterStruct.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "CellRandomStreams.hpp"
+#include "CommandLineArguments.hpp"
+#include "ChasteBuildInfo.hpp"
+#include "OutputFileHandler.hpp"
+#include "Exception.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <boost/cstdint.hpp>
+
+
+//32 bit FNV-1a hash of a string
+static boost::uint32_t HashString(const std::string& rString)
+{
+    boost::uint32_t hash = 2166136261u;
+    for (unsigned i = 0; i < rString.size(); i++){
+        hash ^= (unsigned char)rString[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+
+//MurmurHash3's finaliser, which spreads every input bit over every output bit
+static boost::uint32_t Mix(boost::uint32_t value)
+{
+    value ^= value >> 16;
+    value *= 0x85EBCA6Bu;
+    value ^= value >> 13;
+    value *= 0xC2B2AE35u;
+    value ^= value >> 16;
+    return value;
+}
+
+
+//Mixes the seed, then mixes in the name and index
+unsigned RunManifest::DeriveSeed(unsigned seed, std::string name, unsigned index)
+{
+    boost::uint32_t purpose = Mix(HashString(name) ^ (index*0x9E3779B9u));
+    return Mix(Mix(seed + 0x9E3779B9u) ^ purpose);
+}
+
+
+//Parameters[43]: the run seed, 0 for one derived from the output directory name
+unsigned RunManifest::GetRunSeed(std::string& rSource)
+{
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+    if (parameters->GetNumParameters() > 43 && parameters->GetParameter(43) > 0){
+        rSource = "parameter 43";
+        return (unsigned)(parameters->GetParameter(43) + 0.5);
+    }
+    rSource = "output directory name";
+    return DeriveSeed(0, parameters->GetDirectory());
+}
+
+
+//Each generator gets its own stream, so adding draws to one never shifts the numbers another gives
+void RunManifest::SeedRandomNumberGenerators(unsigned runSeed)
+{
+    RandomNumberGenerator::Instance()->Reseed(DeriveSeed(runSeed, "RandomNumberGenerator"));
+    CellRandomStreams::Instance()->SetSeed(DeriveSeed(runSeed, "CellRandomStreams"));
+}
+
+
+//FNV-1a over the file's bytes. The 64 bit constants are built from halves, as C++98 has no long long literals.
+std::string RunManifest::HashFile(std::string filePath)
+{
+    std::ifstream file(filePath.c_str(), std::ios::binary);
+    if (!file.is_open()){
+        EXCEPTION("Failed to open " << filePath << " to hash it.");
+    }
+    boost::uint64_t hash = ((boost::uint64_t)0xCBF29CE4u << 32) | 0x84222325u;
+    const boost::uint64_t prime = ((boost::uint64_t)1 << 40) | 0x1B3u;
+    char buffer[4096];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0){
+        std::streamsize numRead = file.gcount();
+        for (std::streamsize i = 0; i < numRead; i++){
+            hash ^= (unsigned char)buffer[i];
+            hash *= prime;
+        }
+    }
+    std::stringstream hex;
+    hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return hex.str();
+}
+
+
+//Looks for the Seed line
+bool RunManifest::ReadRunSeed(std::string outputDirectory, unsigned& rSeed)
+{
+    std::string filePath = OutputFileHandler::GetChasteTestOutputDirectory() + outputDirectory + "/RunManifest.txt";
+    std::ifstream MANIFEST(filePath.c_str());
+    std::string line;
+    while (std::getline(MANIFEST, line)){
+        if (line.compare(0, 5, "Seed\t") == 0){
+            std::istringstream value(line.substr(5));
+            return (value >> rSeed);
+        }
+    }
+    return false;
+}
+
+
+//One "key, tab, value" line per item. Multi-line values have their newlines replaced.
+void RunManifest::Write(std::string outputDirectory, std::string parameterFilePath, unsigned runSeed, std::string seedSource)
+{
+    OutputFileHandler handler(outputDirectory, false);
+    out_stream MANIFEST = handler.OpenOutputFile("RunManifest.txt");
+    *MANIFEST << std::setprecision(17);
+
+    *MANIFEST << "Seed\t" << runSeed << "\n";
+    *MANIFEST << "SeedSource\t" << seedSource << "\n";
+    *MANIFEST << "RandomNumberGeneratorSeed\t" << DeriveSeed(runSeed, "RandomNumberGenerator") << "\n";
+    *MANIFEST << "CellRandomStreamsSeed\t" << DeriveSeed(runSeed, "CellRandomStreams") << "\n";
+    *MANIFEST << "ParameterFile\t" << parameterFilePath << "\n";
+    *MANIFEST << "ParameterFileHash\t" << HashFile(parameterFilePath) << "\n";
+
+    *MANIFEST << "CommandLine\t";
+    char** argv = *(CommandLineArguments::Instance()->p_argv);
+    int nArgs = *(CommandLineArguments::Instance()->p_argc);
+    for (int i = 0; i < nArgs; i++){
+        *MANIFEST << (i > 0 ? " " : "") << "\"" << argv[i] << "\"";
+    }
+    *MANIFEST << "\n";
+
+    std::string buildInformation = ChasteBuildInfo::GetBuildInformation();
+    for (unsigned i = 0; i < buildInformation.size(); i++){
+        if (buildInformation[i] == '\n' || buildInformation[i] == '\t'){
+            buildInformation[i] = ' ';
+        }
+    }
+    *MANIFEST << "ChasteVersion\t" << ChasteBuildInfo::GetVersionString()
+              << (ChasteBuildInfo::IsWorkingCopyModified() ? " (modified)" : "") << "\n";
+    const std::map<std::string, std::string>& r_projects = ChasteBuildInfo::rGetProjectVersions();
+    for (std::map<std::string, std::string>::const_iterator project = r_projects.begin(); project != r_projects.end(); ++project){
+        *MANIFEST << "ProjectVersion\t" << project->first << "\t" << project->second << "\n";
+    }
+    *MANIFEST << "BuildTime\t" << ChasteBuildInfo::GetBuildTime() << "\n";
+    *MANIFEST << "BuildInformation\t" << buildInformation << "\n";
+    *MANIFEST << "Compiler\t" << ChasteBuildInfo::GetCompilerType() << " " << ChasteBuildInfo::GetCompilerVersion() << "\n";
+
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+    *MANIFEST << "OutputDirectory\t" << parameters->GetDirectory() << "\n";
+    for (unsigned i = 0; i < parameters->GetNumParameters(); i++){
+        *MANIFEST << "Parameter\t" << i << "\t" << parameters->PeekParameter(i) << "\n";
+    }
+    MANIFEST->close();
+}
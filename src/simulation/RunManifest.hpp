@@ -0,0 +1,117 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef RUNMANIFEST_HPP_
+#define RUNMANIFEST_HPP_
+
+#include <string>
+
+/*
+* Seeding of a simulation's random number generators, and the record of how a run was made.
+*
+* A run has one seed, which comes from parameter 43 or, if that is 0 or missing, from the name of the output
+* directory, so that replicates launched together (which always have different output directories) never
+* share a seed. Each random number generator is seeded with its own seed derived from the run seed and the
+* generator's name (see DeriveSeed), and a sweep derives each replicate's run seed from the sweep seed in the
+* same way.
+*
+* The record, RunManifest.txt in the run's output directory, holds "key, tab, value" lines: the run seed and
+* where it came from, the derived seeds, the parameter file and a hash of its contents, the command line, the
+* Chaste build information and every parameter value as the run used it. Together with the parameter file,
+* this is enough to repeat the run exactly.
+*/
+
+class RunManifest
+{
+public:
+
+    /**
+    * @return a seed derived from another seed and a name (and optionally a number), e.g. the seed of one random
+    * number generator from the run seed. Different names give unrelated seeds.
+    *
+    * @param seed the seed to derive from
+    * @param name what the new seed is for
+    * @param index a number distinguishing seeds for the same purpose, e.g. a replicate number
+    */
+    static unsigned DeriveSeed(unsigned seed, std::string name, unsigned index = 0);
+
+
+    /**
+    * @return the run seed: parameter 43 if it is set, or otherwise one derived from the output directory name
+    *
+    * @param rSource filled with a description of where the seed came from
+    */
+    static unsigned GetRunSeed(std::string& rSource);
+
+
+    /**
+    * Seeds Chaste's RandomNumberGenerator and CellRandomStreams, each with its own seed derived from the run seed.
+    *
+    * @param runSeed the run seed
+    */
+    static void SeedRandomNumberGenerators(unsigned runSeed);
+
+
+    /**
+    * @return a 64 bit FNV-1a hash of a file's contents, in hexadecimal
+    *
+    * @param filePath path of the file
+    */
+    static std::string HashFile(std::string filePath);
+
+
+    /**
+    * Reads the run seed from the manifest of an earlier run.
+    *
+    * @param outputDirectory the earlier run's output directory, relative to where Chaste output is stored
+    * @param rSeed filled with the seed
+    * @return whether the run had a manifest with a seed
+    */
+    static bool ReadRunSeed(std::string outputDirectory, unsigned& rSeed);
+
+
+    /**
+    * Writes RunManifest.txt to a run's output directory, using the current global parameters.
+    *
+    * @param outputDirectory the output directory, relative to where Chaste output is stored
+    * @param parameterFilePath path of the parameter file the run was configured from
+    * @param runSeed the run seed
+    * @param seedSource where the seed came from
+    */
+    static void Write(std::string outputDirectory, std::string parameterFilePath, unsigned runSeed, std::string seedSource);
+
+};
+
+#endif /*RUNMANIFEST_HPP_*/
@@ -1,12 +1,20 @@
 #ifndef ABSTRACTSTATECHARTCELLCYCLEMODEL_HPP_
 #define ABSTRACTSTATECHARTCELLCYCLEMODEL_HPP_
 
+#include <bitset>
+#include <vector>
+#include "CellCyclePhases.hpp"
+
+//Number of bits in the encoding of a chart's state
+#define MAX_STATE_COUNT 32
+
 /*
 * This class provides a guarantee that StatechartCellCycleModel will implement two setter methods: 
 * SetCellCyclePhase and SetReadyToDivide; used by the Statechart to control aspects of cell behaviour.
 * 
 * Basically we only need this class so that StatechartInterface can "test" whether a CellCycleModel
 * exposes the right setter methods, without having to faff around referencing a templated class.
+* For the same reason it also exposes the chart's state and variables, which GermlineSnapshot saves.
 */
 
 class AbstractStatechartCellCycleModel {
@@ -17,6 +25,13 @@ public:
     virtual void SetCellCyclePhase(CellCyclePhase_ Phase) = 0;
     virtual void SetReadyToDivide(bool Ready) = 0;  
 
+    //Getters for the chart's current state (encoded as a bitset) and associated variables
+    virtual std::bitset<MAX_STATE_COUNT> GetChartState() = 0;
+    virtual std::vector<double> GetChartVariables() = 0;
+
+    //Updates the chart ahead of the next ReadyToDivide() call, which then uses the result (see GermlineOffLatticeSimulation)
+    virtual void UpdateAheadOfDivisionCheck() = 0;
+
     virtual ~AbstractStatechartCellCycleModel(){};
 
 };
@@ -38,6 +38,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "StatechartCellCycleModel.hpp"
 #include "GlobalParameterStruct.hpp" 
+#include "CellRandomStreams.hpp"
 #include "ChasteSerialization.hpp"
 
 /*
@@ -63,6 +64,8 @@ private:
     {   
         SerializableSingleton<GlobalParameterStruct>* s_wrapper = GlobalParameterStruct::Instance()->GetSerializationWrapper();
         archive & s_wrapper;    
+        SerializableSingleton<CellRandomStreams>* r_wrapper = CellRandomStreams::Instance()->GetSerializationWrapper();
+        archive & r_wrapper;
         archive & boost::serialization::base_object<StatechartCellCycleModel<CELLSTATECHART> >(*this); 
     }
 
@@ -118,13 +121,41 @@ public:
 
 
 
+    /*
+    * Duration of a cell cycle phase at the current time. Phase lengths switch linearly from their 
+    * larval to their adult values over 4.5 hours, starting at parameters[20] - 18.5. The adult 
+    * parameters are only read once the switch has begun, so that they register as unused before then
+    * (see GlobalParameterStruct::GetFirstReadTime).
+    *
+    * larvalFractionIndex, adultFractionIndex = parameter numbers of the phase's share of the larval 
+    * (parameters[14]) and adult (parameters[15]) cell cycle durations.
+    */
+    double GetCurrentPhaseDuration(int larvalFractionIndex, int adultFractionIndex){
+        GlobalParameterStruct* p_parameters = GlobalParameterStruct::Instance();
+        double larvalDuration = p_parameters->GetParameter(larvalFractionIndex)*p_parameters->GetParameter(14);
+        double delay = p_parameters->GetParameter(20) - 18.5;
+        double duration = 4.5;
+        double time = SimulationTime::Instance()->GetTime();
+        if (time <= delay){
+            return larvalDuration;
+        }
+        double adultDuration = p_parameters->GetParameter(adultFractionIndex)*p_parameters->GetParameter(15);
+        if (time <= delay + duration){
+            return larvalDuration + (time - delay)*((adultDuration - larvalDuration) / duration);
+        }
+        return adultDuration;
+    };
+
+
+
     /*
     * Method that ensures cells are not synchronised at the start of a simulation, and initialises
     * the statechart
     */
     virtual void Initialise(){
 
-        //Initiate can only be called AFTER the cell pointer has been set.
+        //Initiate can only be called AFTER the cell pointer has been set, and the cell given its random stream.
+        CellRandomStreams::Instance()->InitialiseCell(AbstractCellCycleModel::mpCell);
         StatechartCellCycleModel<CELLSTATECHART>::pStatechart->initiate();
     
         double randStartingAge;
@@ -165,94 +196,31 @@ public:
     * for a worm of the current age is calculated when the chart requests it.
     */
     virtual double GetG1Duration(){
-        double adultG1  = GlobalParameterStruct::Instance()->GetParameter(31)*GlobalParameterStruct::Instance()->GetParameter(15);
-        double larvalG1 = GlobalParameterStruct::Instance()->GetParameter(16)*GlobalParameterStruct::Instance()->GetParameter(14);
-        double delay = GlobalParameterStruct::Instance()->GetParameter(20) - 18.5; 
-        double duration = 4.5;
-        double currentG1 = larvalG1;
-        if (SimulationTime::Instance()->GetTime() > delay && SimulationTime::Instance()->GetTime() <= delay + duration){
-            currentG1=(larvalG1 + (SimulationTime::Instance()->GetTime() - delay)*((adultG1 - larvalG1) / duration));
-        }
-        else if (SimulationTime::Instance()->GetTime() >= delay + duration){
-            currentG1 = (adultG1);
-        }
-        return currentG1;
+        return GetCurrentPhaseDuration(16, 31);
     };
 
     virtual double GetStemCellG1Duration(){
-        double adultG1  = GlobalParameterStruct::Instance()->GetParameter(31)*GlobalParameterStruct::Instance()->GetParameter(15);
-        double larvalG1 = GlobalParameterStruct::Instance()->GetParameter(16)*GlobalParameterStruct::Instance()->GetParameter(14);
-        double delay = GlobalParameterStruct::Instance()->GetParameter(20) - 18.5; 
-        double duration = 4.5;
-        double currentG1=larvalG1;
-        if (SimulationTime::Instance()->GetTime()>delay && SimulationTime::Instance()->GetTime() <= delay + duration){
-            currentG1=(larvalG1 + (SimulationTime::Instance()->GetTime() - delay)*((adultG1 - larvalG1) / duration));
-        }
-        else if (SimulationTime::Instance()->GetTime() >= delay + duration){
-            currentG1 = (adultG1);
-        }
-        return currentG1;
+        return GetCurrentPhaseDuration(16, 31);
     };
 
     virtual double GetTransitCellG1Duration(){
-        double adultG1  = GlobalParameterStruct::Instance()->GetParameter(31)*GlobalParameterStruct::Instance()->GetParameter(15);
-        double larvalG1 = GlobalParameterStruct::Instance()->GetParameter(16)*GlobalParameterStruct::Instance()->GetParameter(14);
-        double delay = GlobalParameterStruct::Instance()->GetParameter(20) - 18.5; 
-        double duration = 4.5;
-        double currentG1=larvalG1;
-        if (SimulationTime::Instance()->GetTime()>delay && SimulationTime::Instance()->GetTime() <= delay + duration){
-            currentG1=(larvalG1 + (SimulationTime::Instance()->GetTime() - delay)*((adultG1 - larvalG1) / duration));
-        }
-        else if (SimulationTime::Instance()->GetTime() >= delay + duration){
-            currentG1 = (adultG1);
-        }
-        return currentG1;
+        return GetCurrentPhaseDuration(16, 31);
     };
 
     virtual double GetSDuration(){
-        double adultS = GlobalParameterStruct::Instance()->GetParameter(32)*GlobalParameterStruct::Instance()->GetParameter(15);
-        double larvalS = GlobalParameterStruct::Instance()->GetParameter(17)*GlobalParameterStruct::Instance()->GetParameter(14);
-        double delay = GlobalParameterStruct::Instance()->GetParameter(20) - 18.5;
-        double duration = 4.5;
-        double currentS = larvalS;
-        if (SimulationTime::Instance()->GetTime()>delay && SimulationTime::Instance()->GetTime() <= delay + duration){
-            currentS = (larvalS + (SimulationTime::Instance()->GetTime() - delay)*((adultS - larvalS) / duration));
-        }
-        else if (SimulationTime::Instance()->GetTime() >= delay + duration){
-            currentS = (adultS);
-        }
+        double currentS = GetCurrentPhaseDuration(17, 32);
         this->SetSDuration(currentS);
         return currentS;
     };
 
     virtual double GetG2Duration(){
-        double adultG2 = GlobalParameterStruct::Instance()->GetParameter(33)*GlobalParameterStruct::Instance()->GetParameter(15);
-        double larvalG2 = GlobalParameterStruct::Instance()->GetParameter(18)*GlobalParameterStruct::Instance()->GetParameter(14);
-        double delay = GlobalParameterStruct::Instance()->GetParameter(20) - 18.5;
-        double duration = 4.5;
-        double currentG2 = larvalG2;
-        if (SimulationTime::Instance()->GetTime()>delay && SimulationTime::Instance()->GetTime() <= delay + duration){
-            currentG2 = (larvalG2 + (SimulationTime::Instance()->GetTime() - delay)*((adultG2 - larvalG2) / duration));
-        }
-        else if (SimulationTime::Instance()->GetTime() >= delay + duration){
-            currentG2 = (adultG2);
-        }
+        double currentG2 = GetCurrentPhaseDuration(18, 33);
         this->SetG2Duration(currentG2);
         return currentG2;
     };
 
     virtual double GetMDuration(){
-        double adultM = GlobalParameterStruct::Instance()->GetParameter(34)*GlobalParameterStruct::Instance()->GetParameter(15);
-        double larvalM = GlobalParameterStruct::Instance()->GetParameter(19)*GlobalParameterStruct::Instance()->GetParameter(14);
-        double delay = GlobalParameterStruct::Instance()->GetParameter(20) - 18.5;
-        double duration = 4.5;
-        double currentM = larvalM;
-        if (SimulationTime::Instance()->GetTime()>delay && SimulationTime::Instance()->GetTime() <= delay + duration){
-            currentM = (larvalM + (SimulationTime::Instance()->GetTime() - delay)*((adultM - larvalM) / duration));
-        }
-        else if (SimulationTime::Instance()->GetTime() >= delay + duration){
-            currentM = (adultM);
-        }
+        double currentM = GetCurrentPhaseDuration(19, 34);
         this->SetMDuration(currentM);       
         return currentM;        
     };
@@ -35,13 +35,19 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <StatechartInterface.hpp>
 #include <FateDecisionCoupledToCycle.hpp>
+#include <CellRandomStreams.hpp>
 
 //--------------------STATECHART FUNCTIONS------------------------------
 
 //HARDCODED, RARELY ALTERED DETAILS
+namespace FateDecisionCoupledToCycleStates{
 double stochasticity         = 0.1;
 bool   contactInhibitionInG1 = false;
 bool   contactInhibitionInG2 = true;
+}
+
+//The states and events of this chart are declared in a namespace of their own
+using namespace FateDecisionCoupledToCycleStates;
 
 
 FateDecisionCoupledToCycle::FateDecisionCoupledToCycle(){        
@@ -62,21 +68,52 @@ void FateDecisionCoupledToCycle::SetCell(CellPtr newCell){
 };
 
 
+//The duration the active cell cycle phase drew on entry, saved after the chart's variables so that a
+//restored chart keeps it rather than drawing it again. Null in a phase without one.
+static double* ActiveDuration(FateDecisionCoupledToCycle& chart){
+    if(chart.state_cast<const CellCycle_Mitosis_G1*>()!=0){
+        return &const_cast<CellCycle_Mitosis_G1&>(chart.state_cast<const CellCycle_Mitosis_G1&>()).Duration;
+    }
+    if(chart.state_cast<const CellCycle_Mitosis_S*>()!=0){
+        return &const_cast<CellCycle_Mitosis_S&>(chart.state_cast<const CellCycle_Mitosis_S&>()).Duration;
+    }
+    if(chart.state_cast<const CellCycle_Mitosis_G2*>()!=0){
+        return &const_cast<CellCycle_Mitosis_G2&>(chart.state_cast<const CellCycle_Mitosis_G2&>()).Duration;
+    }
+    if(chart.state_cast<const CellCycle_Mitosis_M*>()!=0){
+        return &const_cast<CellCycle_Mitosis_M&>(chart.state_cast<const CellCycle_Mitosis_M&>()).Duration;
+    }
+    if(chart.state_cast<const CellCycle_ExitedProlif_G1*>()!=0){
+        return &const_cast<CellCycle_ExitedProlif_G1&>(chart.state_cast<const CellCycle_ExitedProlif_G1&>()).Duration;
+    }
+    if(chart.state_cast<const CellCycle_ExitedProlif_MeioticS*>()!=0){
+        return &const_cast<CellCycle_ExitedProlif_MeioticS&>(chart.state_cast<const CellCycle_ExitedProlif_MeioticS&>()).Duration;
+    }
+    return NULL;
+}
+
 //Get a vector containing all state associated variables
 std::vector<double> FateDecisionCoupledToCycle::GetVariables(){
     std::vector<double> variables;
     variables.push_back(TimeInPhase);
     variables.push_back(SpermatocyteDivisions);
     variables.push_back(SpermDevelopmentDelay);
+    double* p_duration = ActiveDuration(*this);
+    variables.push_back(p_duration ? *p_duration : 0.0);
     return variables;
 }
 
 
-//Set values of all state associated variables from an input vector
+//Set values of all state associated variables from an input vector. Call after SetState. Variables saved
+//without the phase duration leave the one drawn on entering the phase.
 void FateDecisionCoupledToCycle::SetVariables(std::vector<double> variables){
     TimeInPhase=variables.at(0);
     SpermatocyteDivisions=variables.at(1);
     SpermDevelopmentDelay=variables.at(2);
+    double* p_duration = ActiveDuration(*this);
+    if(variables.size() > 3 && p_duration){
+        *p_duration = variables.at(3);
+    }
 }
 
 
@@ -438,9 +475,9 @@ sc::result GLD2_Active::react( const EvGLD2Update & ){
 CellCycle_Mitosis_G1::CellCycle_Mitosis_G1( my_context ctx ):
 my_base( ctx ){ 
     CellPtr myCell = context<FateDecisionCoupledToCycle>().pCell;
-    RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance(); 
+    CellRandomStreams* p_gen = CellRandomStreams::Instance();
     double CurrentG1 = GetG1Duration(myCell);
-    Duration = p_gen->NormalRandomDeviate(CurrentG1, stochasticity*CurrentG1);
+    Duration = p_gen->NormalRandomDeviate(myCell, CellRandomStreams::G1_DURATION, CurrentG1, stochasticity*CurrentG1);
     context<FateDecisionCoupledToCycle>().TimeInPhase = 0.0;
     
     SetCellCyclePhase(myCell, G_ONE_PHASE);
@@ -502,9 +539,9 @@ sc::result CellCycle_Mitosis_S::react( const EvCellCycleUpdate & ){
 CellCycle_Mitosis_G2::CellCycle_Mitosis_G2( my_context ctx ):
 my_base( ctx ){ 
     CellPtr myCell=context<FateDecisionCoupledToCycle>().pCell;
-    RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+    CellRandomStreams* p_gen = CellRandomStreams::Instance();
     double CurrentG2 = GetG2Duration(myCell);
-    Duration = p_gen->NormalRandomDeviate(CurrentG2, stochasticity*CurrentG2);
+    Duration = p_gen->NormalRandomDeviate(myCell, CellRandomStreams::G2_DURATION, CurrentG2, stochasticity*CurrentG2);
     context<FateDecisionCoupledToCycle>().TimeInPhase = 0.0;
 
     SetCellCyclePhase(myCell,G_TWO_PHASE);
@@ -56,6 +56,9 @@ namespace mpl = boost::mpl;
 #include <bitset>
 
 
+//States and events are kept apart from those of other charts (see StatechartModelRegistry)
+namespace FateDecisionCoupledToCycleStates{
+
 //Predeclare a struct for each state
 struct Running;
 struct GLP1;
@@ -115,9 +118,11 @@ struct EvGoToDifferentiation_OocyteFated : sc::event< EvGoToDifferentiation_Oocy
 struct EvGoToDifferentiation_Sperm : sc::event< EvGoToDifferentiation_Sperm > {};
 struct EvGoToDifferentiation_Oocyte : sc::event< EvGoToDifferentiation_Oocyte > {};
 
+} // namespace FateDecisionCoupledToCycleStates
+
 
 //DEFINE THE PARENT STATECHART
-struct FateDecisionCoupledToCycle:  sc::state_machine<FateDecisionCoupledToCycle,Running>{
+struct FateDecisionCoupledToCycle:  sc::state_machine<FateDecisionCoupledToCycle,FateDecisionCoupledToCycleStates::Running>{
   
   //Basic constructor
   FateDecisionCoupledToCycle();
@@ -140,6 +145,8 @@ struct FateDecisionCoupledToCycle:  sc::state_machine<FateDecisionCoupledToCycle
 };
 
 
+namespace FateDecisionCoupledToCycleStates{
+
 //FIRSTRESPONDER STATE
 struct Running:  sc::simple_state<Running,FateDecisionCoupledToCycle,mpl::list< GLP1, LAG1, GLD1, GLD2, CellCycle, Differentiation> >{
   typedef sc::custom_reaction< EvCheckCellData > reactions;
@@ -428,6 +435,8 @@ struct Differentiation_Oocyte: sc::state<Differentiation_Oocyte,Differentiation
   sc::result react( const EvDifferentiationUpdate & );
 };
 
+} // namespace FateDecisionCoupledToCycleStates
+
 
 // Export StatechartCellCycleModel and ElegansDevStatechartCellCycleModel with this class
 // as template parameter
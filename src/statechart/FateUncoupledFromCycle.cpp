@@ -1,5 +1,6 @@
 #include <StatechartInterface.hpp>
 #include <FateUncoupledFromCycle.hpp>
+#include <CellRandomStreams.hpp>
 
 /*
 * This file actually implements the statechart's functions. 
@@ -15,9 +16,14 @@
 
 
 //FIRST, SOME HARDCODED AND RARELY ALTERED DETAILS. SPECIFIC TO THIS MODEL.
+namespace FateUncoupledFromCycleStates{
 double stochasticity         = 0.1;
 bool   contactInhibitionInG1 = false;
 bool   contactInhibitionInG2 = true;
+}
+
+//The states and events of this chart are declared in a namespace of their own
+using namespace FateUncoupledFromCycleStates;
 
 
 
@@ -37,20 +43,51 @@ void FateUncoupledFromCycle::SetCell(CellPtr newCell){ /*!REQUIRED!*/
      pCell=newCell;
 };
 
+//The duration the active cell cycle phase drew on entry, saved after the chart's variables so that a
+//restored chart keeps it rather than drawing it again. Null in a phase without one.
+static double* ActiveDuration(FateUncoupledFromCycle& chart){
+    if(chart.state_cast<const CellCycle_Mitosis_G1*>()!=0){
+        return &const_cast<CellCycle_Mitosis_G1&>(chart.state_cast<const CellCycle_Mitosis_G1&>()).Duration;
+    }
+    if(chart.state_cast<const CellCycle_Mitosis_S*>()!=0){
+        return &const_cast<CellCycle_Mitosis_S&>(chart.state_cast<const CellCycle_Mitosis_S&>()).Duration;
+    }
+    if(chart.state_cast<const CellCycle_Mitosis_G2*>()!=0){
+        return &const_cast<CellCycle_Mitosis_G2&>(chart.state_cast<const CellCycle_Mitosis_G2&>()).Duration;
+    }
+    if(chart.state_cast<const CellCycle_Mitosis_M*>()!=0){
+        return &const_cast<CellCycle_Mitosis_M&>(chart.state_cast<const CellCycle_Mitosis_M&>()).Duration;
+    }
+    if(chart.state_cast<const CellCycle_ExitedProlif_G1*>()!=0){
+        return &const_cast<CellCycle_ExitedProlif_G1&>(chart.state_cast<const CellCycle_ExitedProlif_G1&>()).Duration;
+    }
+    if(chart.state_cast<const CellCycle_ExitedProlif_MeioticS*>()!=0){
+        return &const_cast<CellCycle_ExitedProlif_MeioticS&>(chart.state_cast<const CellCycle_ExitedProlif_MeioticS&>()).Duration;
+    }
+    return NULL;
+}
+
 //Gets a vector containing all the chart's associated variables
 std::vector<double> FateUncoupledFromCycle::GetVariables(){ /*!REQUIRED!*/
     std::vector<double> variables;
     variables.push_back(TimeInPhase);
     variables.push_back(SpermatocyteDivisions);
     variables.push_back(SpermDevelopmentDelay);
+    double* p_duration = ActiveDuration(*this);
+    variables.push_back(p_duration ? *p_duration : 0.0);
     return variables;
 }
 
-//Sets the values of all chart associated variables from an input vector
+//Sets the values of all chart associated variables from an input vector. Call after SetState. Variables
+//saved without the phase duration leave the one drawn on entering the phase.
 void FateUncoupledFromCycle::SetVariables(std::vector<double> variables){ /*!REQUIRED!*/
     TimeInPhase = variables.at(0);
     SpermatocyteDivisions = variables.at(1);
     SpermDevelopmentDelay = variables.at(2);
+    double* p_duration = ActiveDuration(*this);
+    if(variables.size() > 3 && p_duration){
+        *p_duration = variables.at(3);
+    }
 }
 
 //Get an encoding of the current state in bitset form
@@ -437,9 +474,9 @@ sc::result GLD2_Active::react( const EvGLD2Update & ){ //On update...
 CellCycle_Mitosis_G1::CellCycle_Mitosis_G1( my_context ctx ):my_base( ctx ){ //Constructor with entry events
 
     CellPtr myCell = context<FateUncoupledFromCycle>().pCell;                   //Get cell pointer
-    RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();               
+    CellRandomStreams* p_gen = CellRandomStreams::Instance();
     double CurrentG1 = GetG1Duration(myCell);                                   //Get G1 duration at current time
-    Duration = p_gen->NormalRandomDeviate(CurrentG1, stochasticity*CurrentG1);  //Add some random variation
+    Duration = p_gen->NormalRandomDeviate(myCell, CellRandomStreams::G1_DURATION, CurrentG1, stochasticity*CurrentG1);  //Add some random variation
     context<FateUncoupledFromCycle>().TimeInPhase = 0.0;                        //Time in phase initially 0
     
     SetCellCyclePhase(myCell, G_ONE_PHASE);                                     //Set cell cycle phase to 1.0/G1
@@ -508,9 +545,9 @@ sc::result CellCycle_Mitosis_S::react( const EvCellCycleUpdate & ){
 //----------------------CellCycle_Mitosis_G2--------------------------------
 CellCycle_Mitosis_G2::CellCycle_Mitosis_G2( my_context ctx ):my_base( ctx ){   //Constructor
     CellPtr myCell=context<FateUncoupledFromCycle>().pCell;
-    RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();       
+    CellRandomStreams* p_gen = CellRandomStreams::Instance();
     double CurrentG2 = GetG2Duration(myCell);                                  //Get current G2 duration
-    Duration = p_gen->NormalRandomDeviate(CurrentG2, stochasticity*CurrentG2); //Add random noise to cell cycle phase length
+    Duration = p_gen->NormalRandomDeviate(myCell, CellRandomStreams::G2_DURATION, CurrentG2, stochasticity*CurrentG2); //Add random noise to cell cycle phase length
     context<FateUncoupledFromCycle>().TimeInPhase = 0.0;                       //Current time in phase = 0.0
 
     SetCellCyclePhase(myCell,G_TWO_PHASE);                                     //Set cell cycle labels to G2 (3.0)
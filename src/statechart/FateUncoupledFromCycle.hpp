@@ -74,6 +74,10 @@ namespace mpl = boost::mpl;
 
 
 
+// The states and events live in a namespace of their own, so that several charts, which often share
+// state names, can be linked into one program (see StatechartModelRegistry).
+namespace FateUncoupledFromCycleStates{
+
 // 1) DECLARE A STRUCT FOR EACH STATE IN THE CHART
 struct Running;
 struct GLP1;
@@ -140,11 +144,13 @@ struct EvGoToDifferentiation_Sperm : sc::event< EvGoToDifferentiation_Sperm > {}
 struct EvGoToDifferentiation_Oocyte : sc::event< EvGoToDifferentiation_Oocyte > {};
 
 
+} // namespace FateUncoupledFromCycleStates
+
 
 // 4) DEFINE A STATECHART OBJECT, WITH NAME = FILENAME. 
 // Inherits from sc::state_machine. Templating says "I am a FateUncoupledFromCycle 
 // with initially active child state Running".
-struct FateUncoupledFromCycle:  sc::state_machine<FateUncoupledFromCycle,Running>{ /*!REQUIRED!*/
+struct FateUncoupledFromCycle:  sc::state_machine<FateUncoupledFromCycle,FateUncoupledFromCycleStates::Running>{ /*!REQUIRED!*/
   
   FateUncoupledFromCycle();        /*!REQUIRED! - a constructor*/ 
   
@@ -164,6 +170,8 @@ struct FateUncoupledFromCycle:  sc::state_machine<FateUncoupledFromCycle,Running
 };
 
 
+namespace FateUncoupledFromCycleStates{
+
 // 5) DEFINE THE FIRSTRESPONDER STATE
 // Here the template says "I am state Running. My parent is FateUncoupledFromCycle. My initially
 // active children are GLP1, LAG1, GLD1, GLD2, CellCycle and Differentiation". Because there's a 
@@ -391,8 +399,8 @@ struct GLD2_Active: sc::state<GLD2_Active,GLD2 >{
 
 struct CellCycle_Mitosis_G1: sc::state<CellCycle_Mitosis_G1,CellCycle_Mitosis >{
   
-  double Duration;          //States can hold variables too. However they won't be saved on archiving,
-  double CompressionThresh; //so they must be set sensibly in the constructor.
+  double Duration;          //States can hold variables too. Apart from the active phase's Duration (see
+  double CompressionThresh; //GetVariables) they won't be saved on archiving, so set them in the constructor.
   CellCycle_Mitosis_G1(my_context ctx);
 
   typedef sc::custom_reaction< EvCellCycleUpdate> reactions;
@@ -502,6 +510,8 @@ struct Differentiation_Oocyte: sc::state<Differentiation_Oocyte,Differentiation
   sc::result react( const EvDifferentiationUpdate & );
 };
 
+} // namespace FateUncoupledFromCycleStates
+
 
 // 8) RIGHT HERE is where you need to export the various StatechartCellCycleModel classes,
 // making clear that they can take this model as a template parameter.
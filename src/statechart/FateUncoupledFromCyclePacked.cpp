@@ -0,0 +1,361 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include <StatechartInterface.hpp>
+#include <FateUncoupledFromCyclePacked.hpp>
+#include <CellRandomStreams.hpp>
+
+/*
+* The entry actions and update reactions of FateUncoupledFromCyclePacked, the rest of which is generated from
+* FateUncoupledFromCyclePacked.json (see PythonScripts/GenerateStatechart.py).
+*
+* These are FateUncoupledFromCycle's, written against the packed chart: an update returns the state to move
+* to, or NO_TRANSITION, where a boost::statechart reaction would transit or discard the event, and IsIn()
+* stands in for state_cast. Changes to the model's behaviour should be made to both charts.
+*/
+
+//FIRST, SOME HARDCODED AND RARELY ALTERED DETAILS. SPECIFIC TO THIS MODEL.
+static double stochasticity         = 0.1;
+static bool   contactInhibitionInG1 = false;
+static bool   contactInhibitionInG2 = true;
+
+
+
+//--------------------------------------------------------------------------
+//---------------------------------GLP1-------------------------------------
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateGLP1_Unbound(){
+    if(GetDistanceFromDTC(pCell) < 35){             //If cell is less than 35 microns from DTC...
+        return GLP1_Bound;                          //Transition to the bound state
+    }
+    return NO_TRANSITION;
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateGLP1_Bound(){
+    double DTCSignallingLength = GlobalParameterStruct::Instance()->GetParameter(24);
+    if(GetDistanceFromDTC(pCell) > DTCSignallingLength){ //If cell out of range of DTC signal
+        return GLP1_Absent;                              //Transition GLP1 signal to absent
+    }
+    return NO_TRANSITION;
+}
+
+
+//--------------------------------------------------------------------------
+//------------------------------LAG1, GLD1, GLD2----------------------------
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateLAG1_Inactive(){
+    if(IsIn(GLP1_Bound)){                            //If GLP1 is Bound...
+        return LAG1_Active;                          //Transition to LAG1 Active
+    }
+    return NO_TRANSITION;
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateLAG1_Active(){
+    if(!IsIn(GLP1_Bound)){                           //If GLP1 is in any other state BUT Bound...
+        return LAG1_Inactive;                        //Transition to LAG1 Inactive
+    }
+    return NO_TRANSITION;
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateGLD1_Inactive(){
+    if(IsIn(LAG1_Inactive)){
+        return GLD1_Active;
+    }
+    return NO_TRANSITION;
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateGLD1_Active(){
+    if(IsIn(LAG1_Active)){
+        return GLD1_Inactive;
+    }
+    return NO_TRANSITION;
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateGLD2_Inactive(){
+    if(IsIn(LAG1_Inactive)){
+        return GLD2_Active;
+    }
+    return NO_TRANSITION;
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateGLD2_Active(){
+    if(IsIn(LAG1_Active)){
+        return GLD2_Inactive;
+    }
+    return NO_TRANSITION;
+}
+
+
+//--------------------------------------------------------------------------
+//--------------------------CellCycle_Mitosis_G1----------------------------
+
+void FateUncoupledFromCyclePacked::EnterCellCycle_Mitosis_G1(){
+    CellRandomStreams* p_gen = CellRandomStreams::Instance();
+    double CurrentG1 = GetG1Duration(pCell);                                    //Get G1 duration at current time
+    CellCycle_Mitosis_G1Locals.Duration = p_gen->NormalRandomDeviate(pCell, CellRandomStreams::G1_DURATION, CurrentG1, stochasticity*CurrentG1);
+    TimeInPhase = 0.0;
+
+    SetCellCyclePhase(pCell, G_ONE_PHASE);
+    pCell->GetCellData()->SetItem("CellCyclePhase",1.0);
+    pCell->GetCellData()->SetItem("DNAContent",1.0);
+
+    if(contactInhibitionInG1 && GetTime()>17){                                  //If this is an adult worm, get the
+        CellCycle_Mitosis_G1Locals.CompressionThresh=GlobalParameterStruct::Instance()->GetParameter(29); //threshold
+        pCell->GetCellData()->SetItem("ArrestedFor",0.0);                       //compression volume
+    }
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateCellCycle_Mitosis_G1(){
+    double CompressionThresh = CellCycle_Mitosis_G1Locals.CompressionThresh;
+    if (contactInhibitionInG1 && GetTime()>17){                                 //Heavily compressed adult cells arrest
+        double rad = pCell->GetCellData()->GetItem("Radius");                   //rather than progress through G1
+        if(pCell->GetCellData()->GetItem("volume") < CompressionThresh * 4.18879 * rad*rad*rad && CompressionThresh < 1.0){
+            pCell->GetCellData()->SetItem("ArrestedFor", pCell->GetCellData()->GetItem("ArrestedFor") + GetTimestep());
+        }else{
+            TimeInPhase += GetTimestep();
+        }
+    }else{
+        TimeInPhase += GetTimestep();
+    }
+
+    if(TimeInPhase >= CellCycle_Mitosis_G1Locals.Duration){                     //If G1 is over, transit into S phase
+        return CellCycle_Mitosis_S;
+    }
+    if(GetTime()>1 && (IsIn(GLD2_Active) || IsIn(GLD1_Active))){                //If GLD1 / GLD2 on, leave the mitotic cycle
+        return CellCycle_ExitedProlif_G1;
+    }
+    return NO_TRANSITION;
+}
+
+
+//--------------------------------------------------------------------------
+//--------------------------CellCycle_Mitosis_S-----------------------------
+
+void FateUncoupledFromCyclePacked::EnterCellCycle_Mitosis_S(){
+    CellCycle_Mitosis_SLocals.Duration = GetSDuration(pCell);
+    TimeInPhase = 0.0;
+
+    SetCellCyclePhase(pCell,S_PHASE);
+    pCell->GetCellData()->SetItem("CellCyclePhase",2.0);
+    pCell->GetCellData()->SetItem("DNAContent",1.0);
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateCellCycle_Mitosis_S(){
+    double Duration = CellCycle_Mitosis_SLocals.Duration;
+    pCell->GetCellData()->SetItem("DNAContent",1.0 + TimeInPhase/Duration);     //Increment DNA content
+
+    TimeInPhase += GetTimestep();
+    if(TimeInPhase >= Duration){
+        return CellCycle_Mitosis_G2;
+    }
+    return NO_TRANSITION;
+}
+
+
+//--------------------------------------------------------------------------
+//--------------------------CellCycle_Mitosis_G2----------------------------
+
+void FateUncoupledFromCyclePacked::EnterCellCycle_Mitosis_G2(){
+    CellRandomStreams* p_gen = CellRandomStreams::Instance();
+    double CurrentG2 = GetG2Duration(pCell);
+    CellCycle_Mitosis_G2Locals.Duration = p_gen->NormalRandomDeviate(pCell, CellRandomStreams::G2_DURATION, CurrentG2, stochasticity*CurrentG2);
+    TimeInPhase = 0.0;
+
+    SetCellCyclePhase(pCell,G_TWO_PHASE);
+    pCell->GetCellData()->SetItem("CellCyclePhase",3.0);
+    pCell->GetCellData()->SetItem("DNAContent",2.0);
+
+    if(contactInhibitionInG2 && GetTime()>17){
+        CellCycle_Mitosis_G2Locals.CompressionThresh=GlobalParameterStruct::Instance()->GetParameter(29);
+        pCell->GetCellData()->SetItem("ArrestedFor",0.0);
+    }
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateCellCycle_Mitosis_G2(){
+    double CompressionThresh = CellCycle_Mitosis_G2Locals.CompressionThresh;
+    if (contactInhibitionInG2 && GetTime()>17){                                 //Heavily compressed adult cells arrest
+        double rad=pCell->GetCellData()->GetItem("Radius");                     //rather than progress through G2
+        if(pCell->GetCellData()->GetItem("volume") < CompressionThresh * 4.18879 * rad*rad*rad && CompressionThresh<1.0){
+           pCell->GetCellData()->SetItem("ArrestedFor", pCell->GetCellData()->GetItem("ArrestedFor")+GetTimestep());
+        }else{
+            TimeInPhase += GetTimestep();
+        }
+    }else{
+        TimeInPhase += GetTimestep();
+    }
+
+    if(TimeInPhase >= CellCycle_Mitosis_G2Locals.Duration){                     //If time in G2 is over...
+        if(pCell->GetCellData()->GetItem("IsDTC")==0.0){                        //If not the DTC, call for a division
+            SetReadyToDivide(pCell,true);
+        }
+        return CellCycle_Mitosis_M;
+    }
+    return NO_TRANSITION;
+}
+
+
+//--------------------------------------------------------------------------
+//--------------------------CellCycle_Mitosis_M-----------------------------
+
+void FateUncoupledFromCyclePacked::EnterCellCycle_Mitosis_M(){
+    CellCycle_Mitosis_MLocals.Duration = GetMDuration(pCell);
+    TimeInPhase = 0.0;
+    SetCellCyclePhase(pCell, M_PHASE);
+    pCell->GetCellData()->SetItem("CellCyclePhase",4.0);
+    pCell->GetCellData()->SetItem("DNAContent",2.0);
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateCellCycle_Mitosis_M(){
+    double Duration = CellCycle_Mitosis_MLocals.Duration;
+    TimeInPhase += GetTimestep();
+    pCell->GetCellData()->SetItem("DNAContent",2.0-TimeInPhase/Duration);      //Decrease DNA content
+    if(TimeInPhase >= Duration){
+        return CellCycle_Mitosis_G1;
+    }
+    return NO_TRANSITION;
+}
+
+
+//--------------------------------------------------------------------------
+//--------------------------CellCycle_ExitedProlif--------------------------
+
+void FateUncoupledFromCyclePacked::EnterCellCycle_ExitedProlif_G1(){
+    TimeInPhase = 0.0;
+    CellCycle_ExitedProlif_G1Locals.Duration = GetG1Duration(pCell);
+    pCell->GetCellData()->SetItem("CellCyclePhase",1.0);
+    pCell->GetCellData()->SetItem("DNAContent",1.0);
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateCellCycle_ExitedProlif_G1(){
+    TimeInPhase += GetTimestep();
+    if(TimeInPhase > CellCycle_ExitedProlif_G1Locals.Duration){
+        return CellCycle_ExitedProlif_MeioticS;
+    }
+    return NO_TRANSITION;
+}
+
+void FateUncoupledFromCyclePacked::EnterCellCycle_ExitedProlif_MeioticS(){
+    TimeInPhase = 0.0;
+    CellCycle_ExitedProlif_MeioticSLocals.Duration = GetSDuration(pCell);
+    pCell->GetCellData()->SetItem("CellCyclePhase",2.5);                        //2.5 labels meiotic S
+    pCell->GetCellData()->SetItem("DNAContent",1.0);
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateCellCycle_ExitedProlif_MeioticS(){
+    double Duration = CellCycle_ExitedProlif_MeioticSLocals.Duration;
+    TimeInPhase += GetTimestep();
+    pCell->GetCellData()->SetItem("DNAContent",1.0 + TimeInPhase/Duration);     //Increase DNA content
+    if(TimeInPhase > Duration){
+        return CellCycle_ExitedProlif_Meiosis;
+    }
+    return NO_TRANSITION;
+}
+
+void FateUncoupledFromCyclePacked::EnterCellCycle_ExitedProlif_Meiosis(){
+    pCell->GetCellData()->SetItem("CellCyclePhase",-1.0);                       //-1 labels meiosis
+    pCell->GetCellData()->SetItem("DNAContent",2.0);
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateCellCycle_ExitedProlif_Meiosis(){
+    if(!IsIn(Differentiation_Sperm) && !IsIn(Differentiation_Oocyte)){          //If the cell has not undergone sex determination,
+        UpdateRadiusMeiotic(pCell);                                             //grow it according to meiotic cell rules
+    }
+    return NO_TRANSITION;
+}
+
+
+//--------------------------------------------------------------------------
+//-----------------------------Differentiation------------------------------
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateDifferentiation_Precursor(){
+    if (GetTime()>1 && GetDistanceFromDTC(pCell) > 200){                        //If distance from DTC > 200 microns
+        if( GetTime() < GlobalParameterStruct::Instance()->GetParameter(22)){   //And time < threshold time
+            return Differentiation_SpermFated;                                  //Become sperm fated
+        }else{
+            return Differentiation_OocyteFated;                                 //Otherwise become oocyte fated
+        }
+    }
+    return NO_TRANSITION;
+}
+
+void FateUncoupledFromCyclePacked::EnterDifferentiation_SpermFated(){
+    pCell->GetCellData()->SetItem("SpermFated", 1.0);
+    SpermDevelopmentDelay = 0.0;
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateDifferentiation_SpermFated(){
+    SpermDevelopmentDelay += GetTimestep();                                     //Increment time spent becoming a mature sperm
+    if (SpermDevelopmentDelay > GlobalParameterStruct::Instance()->GetParameter(23)){
+        return Differentiation_Sperm;
+    }
+    return NO_TRANSITION;
+}
+
+void FateUncoupledFromCyclePacked::EnterDifferentiation_OocyteFated(){
+    pCell->GetCellData()->SetItem("OocyteFated", 1.0);
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateDifferentiation_OocyteFated(){
+    if(GetDistanceFromDTC(pCell) > 250){                                        //If cell > 250 microns from DTC
+        UpdateRadiusOocyte(pCell);                                              //Grow oocyte
+    }
+    if(pCell->GetCellData()->GetItem("Radius")>10.0){
+       return Differentiation_Oocyte;
+    }
+    return NO_TRANSITION;
+}
+
+void FateUncoupledFromCyclePacked::EnterDifferentiation_Sperm(){
+    pCell->GetCellData()->SetItem("Differentiation_Sperm", 1.0);
+}
+
+FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::UpdateDifferentiation_Sperm(){
+    if (SpermatocyteDivisions == 1){                                            //After the first sperm division,
+        SetRadius(pCell, 1.5);                                                  //shrink to sperm size and divide
+        SetReadyToDivide(pCell, true);                                          //one more time
+        SpermatocyteDivisions++;
+    }
+    if (SpermatocyteDivisions == 0){                                            //Before it, halve the cell volume
+        double radius = pCell->GetCellData()->GetItem("Radius");                //and divide
+        SetRadius(pCell, radius/1.26);
+        SetReadyToDivide(pCell, true);
+        SpermatocyteDivisions++;
+    }
+    return NO_TRANSITION;
+}
+
+void FateUncoupledFromCyclePacked::EnterDifferentiation_Oocyte(){
+    pCell->GetCellData()->SetItem("Differentiation_Oocyte", 1.0);
+}
@@ -0,0 +1,228 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+// Generated from src/statechart/FateUncoupledFromCyclePacked.json by PythonScripts/GenerateStatechart.py. Edit the
+// description and run the script again, rather than editing this file. The entry actions and update
+// reactions are written by hand, in FateUncoupledFromCyclePacked.cpp.
+
+#ifndef FATEUNCOUPLEDFROMCYCLEPACKED_HPP_
+#define FATEUNCOUPLEDFROMCYCLEPACKED_HPP_
+
+#include <StatechartCellCycleModel.hpp>
+#include <ElegansDevStatechartCellCycleModel.hpp>
+
+#include <bitset>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+
+/*
+* The FateUncoupledFromCycle model, generated with its state packed into one word. Its states are numbered
+* as FateUncoupledFromCycle's, so the two save their state in the same way, and given the same cells and
+* random streams they behave the same.
+*
+* The state is packed into one word, with a field for each orthogonal region holding the number of its
+* active leaf state:
+*
+*   region           bits    leaf states (initial first)
+*   GLP1             0-1     GLP1_Unbound, GLP1_Bound, GLP1_Absent
+*   LAG1             2       LAG1_Inactive, LAG1_Active
+*   GLD1             3       GLD1_Active, GLD1_Inactive
+*   GLD2             4       GLD2_Active, GLD2_Inactive
+*   CellCycle        5-7     CellCycle_Mitosis_G1, CellCycle_Mitosis_S, CellCycle_Mitosis_G2,
+*                            CellCycle_Mitosis_M, CellCycle_ExitedProlif_G1, CellCycle_ExitedProlif_MeioticS,
+*                            CellCycle_ExitedProlif_Meiosis
+*   Differentiation  8-10    Differentiation_Precursor, Differentiation_SpermFated,
+*                            Differentiation_OocyteFated, Differentiation_Sperm, Differentiation_Oocyte
+*
+* Checking the cell updates the regions in the order CellCycle, Differentiation, GLD2, GLD1, LAG1, GLP1.
+*/
+struct FateUncoupledFromCyclePacked{
+
+  //Leaf states, numbered as their bits in GetState()
+  enum State{
+    NO_TRANSITION = 0,
+    GLP1_Unbound = 1,
+    GLP1_Bound = 2,
+    GLP1_Absent = 3,
+    LAG1_Inactive = 4,
+    LAG1_Active = 5,
+    GLD1_Inactive = 6,
+    GLD1_Active = 7,
+    GLD2_Inactive = 8,
+    GLD2_Active = 9,
+    CellCycle_Mitosis_G1 = 10,
+    CellCycle_Mitosis_S = 11,
+    CellCycle_Mitosis_G2 = 12,
+    CellCycle_Mitosis_M = 13,
+    CellCycle_ExitedProlif_G1 = 14,
+    CellCycle_ExitedProlif_MeioticS = 15,
+    CellCycle_ExitedProlif_Meiosis = 16,
+    Differentiation_Precursor = 17,
+    Differentiation_SpermFated = 18,
+    Differentiation_OocyteFated = 19,
+    Differentiation_Sperm = 20,
+    Differentiation_Oocyte = 21
+  };
+
+  //Orthogonal regions
+  enum Region{
+    GLP1_REGION = 0,
+    LAG1_REGION = 1,
+    GLD1_REGION = 2,
+    GLD2_REGION = 3,
+    CELL_CYCLE_REGION = 4,
+    DIFFERENTIATION_REGION = 5,
+    NUM_REGIONS = 6
+  };
+
+  FateUncoupledFromCyclePacked();
+
+  CellPtr pCell;
+  void SetCell(CellPtr newCell);
+
+  //Enters the initial state of every region, in order, running their entry actions
+  void initiate();
+
+  //Updates every region once. The other events force the cell cycle into a phase, re-entering it if it is
+  //already there, as a boost::statechart GOTO event does.
+  void process_event(const EvCheckCellData&);
+  void process_event(const EvGoToCellCycle_Mitosis_G1&);
+  void process_event(const EvGoToCellCycle_Mitosis_S&);
+  void process_event(const EvGoToCellCycle_Mitosis_G2&);
+  void process_event(const EvGoToCellCycle_Mitosis_M&);
+
+  //Copying, saving and restoring, as required by StatechartCellCycleModel
+  boost::shared_ptr<FateUncoupledFromCyclePacked> CopyInto(boost::shared_ptr<FateUncoupledFromCyclePacked> myNewStatechart);
+  std::bitset<MAX_STATE_COUNT> GetState();
+  std::vector<double> GetVariables();
+  void SetState(std::bitset<MAX_STATE_COUNT> state);
+  void SetVariables(std::vector<double> variableValues);
+
+  //Makes a leaf state the active state of its region, and runs its entry action
+  void Enter(State state);
+
+  //The active leaf state of a region
+  State GetLeaf(Region region) const{
+    return (State)(mFirstLeaf[region] + ((mStateWord >> mShifts[region]) & mMasks[region]));
+  }
+
+  //Whether a leaf state is active
+  bool IsIn(State state) const{
+    return GetLeaf((Region)mRegionOf[state]) == state;
+  }
+
+  //Whether a composite state is active
+  bool IsInCellCycle_Mitosis() const{
+    State leaf = GetLeaf(CELL_CYCLE_REGION);
+    return leaf >= CellCycle_Mitosis_G1 && leaf <= CellCycle_Mitosis_M;
+  }
+  bool IsInCellCycle_ExitedProlif() const{
+    State leaf = GetLeaf(CELL_CYCLE_REGION);
+    return leaf >= CellCycle_ExitedProlif_G1 && leaf <= CellCycle_ExitedProlif_Meiosis;
+  }
+
+  //The packed state
+  boost::uint32_t GetStateWord() const{
+    return mStateWord;
+  }
+
+  //Statechart associated variables
+  double TimeInPhase;  //counts time elapsed in current cell cycle phase
+  double SpermatocyteDivisions;  //counts number of sperm divisions
+  double SpermDevelopmentDelay;  //counts time elapsed in sperm state
+
+  //Variables of leaf states, set by their entry actions. Those listed as saved in the description
+  //are saved after the chart's variables.
+  struct{ double Duration; double CompressionThresh; } CellCycle_Mitosis_G1Locals;
+  struct{ double Duration; } CellCycle_Mitosis_SLocals;
+  struct{ double Duration; double CompressionThresh; } CellCycle_Mitosis_G2Locals;
+  struct{ double Duration; } CellCycle_Mitosis_MLocals;
+  struct{ double Duration; } CellCycle_ExitedProlif_G1Locals;
+  struct{ double Duration; } CellCycle_ExitedProlif_MeioticSLocals;
+
+private:
+
+  boost::uint32_t mStateWord;
+
+  //Layout of the state word: each region's first leaf state, field position and field mask; and the
+  //region of each leaf state, the initial leaf state of each region, and the leaf states each leaf
+  //state's update may move to, as bits
+  static const unsigned mFirstLeaf[NUM_REGIONS];
+  static const unsigned mShifts[NUM_REGIONS];
+  static const boost::uint32_t mMasks[NUM_REGIONS];
+  static const unsigned mRegionOf[22];
+  static const State mInitialStates[NUM_REGIONS];
+  static const boost::uint32_t mTransitions[22];
+
+  //Entry actions and update reactions, written by hand in FateUncoupledFromCyclePacked.cpp
+  State UpdateGLP1_Unbound();
+  State UpdateGLP1_Bound();
+  State UpdateLAG1_Inactive();
+  State UpdateLAG1_Active();
+  State UpdateGLD1_Inactive();
+  State UpdateGLD1_Active();
+  State UpdateGLD2_Inactive();
+  State UpdateGLD2_Active();
+  void EnterCellCycle_Mitosis_G1();
+  State UpdateCellCycle_Mitosis_G1();
+  void EnterCellCycle_Mitosis_S();
+  State UpdateCellCycle_Mitosis_S();
+  void EnterCellCycle_Mitosis_G2();
+  State UpdateCellCycle_Mitosis_G2();
+  void EnterCellCycle_Mitosis_M();
+  State UpdateCellCycle_Mitosis_M();
+  void EnterCellCycle_ExitedProlif_G1();
+  State UpdateCellCycle_ExitedProlif_G1();
+  void EnterCellCycle_ExitedProlif_MeioticS();
+  State UpdateCellCycle_ExitedProlif_MeioticS();
+  void EnterCellCycle_ExitedProlif_Meiosis();
+  State UpdateCellCycle_ExitedProlif_Meiosis();
+  State UpdateDifferentiation_Precursor();
+  void EnterDifferentiation_SpermFated();
+  State UpdateDifferentiation_SpermFated();
+  void EnterDifferentiation_OocyteFated();
+  State UpdateDifferentiation_OocyteFated();
+  void EnterDifferentiation_Sperm();
+  State UpdateDifferentiation_Sperm();
+  void EnterDifferentiation_Oocyte();
+};
+
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS1(StatechartCellCycleModel, FateUncoupledFromCyclePacked)
+EXPORT_TEMPLATE_CLASS1(ElegansDevStatechartCellCycleModel, FateUncoupledFromCyclePacked)
+
+#endif /*FATEUNCOUPLEDFROMCYCLEPACKED_HPP_*/
@@ -0,0 +1,252 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+// Generated from src/statechart/FateUncoupledFromCyclePacked.json by PythonScripts/GenerateStatechart.py. Edit the
+// description and run the script again, rather than editing this file.
+
+#include "FateUncoupledFromCyclePacked.hpp"
+
+
+const unsigned FateUncoupledFromCyclePacked::mFirstLeaf[NUM_REGIONS] = {1, 4, 6, 8, 10, 17};
+const unsigned FateUncoupledFromCyclePacked::mShifts[NUM_REGIONS] = {0, 2, 3, 4, 5, 8};
+const boost::uint32_t FateUncoupledFromCyclePacked::mMasks[NUM_REGIONS] = {3u, 1u, 1u, 1u, 7u, 7u};
+const unsigned FateUncoupledFromCyclePacked::mRegionOf[22] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5};
+const FateUncoupledFromCyclePacked::State FateUncoupledFromCyclePacked::mInitialStates[NUM_REGIONS] = {GLP1_Unbound, LAG1_Inactive, GLD1_Active, GLD2_Active, CellCycle_Mitosis_G1, Differentiation_Precursor};
+const boost::uint32_t FateUncoupledFromCyclePacked::mTransitions[22] = {0u, 0x00000004u, 0x00000008u, 0x00000000u, 0x00000020u, 0x00000010u, 0x00000080u, 0x00000040u, 0x00000200u, 0x00000100u, 0x00004800u, 0x00001000u, 0x00002000u, 0x00000400u, 0x00008000u, 0x00010000u, 0x00000000u, 0x000c0000u, 0x00100000u, 0x00200000u, 0x00000000u, 0x00000000u};
+
+
+FateUncoupledFromCyclePacked::FateUncoupledFromCyclePacked(){
+  pCell = boost::shared_ptr<Cell>();
+  mStateWord = 0;
+  TimeInPhase = 0;
+  SpermatocyteDivisions = 0;
+  SpermDevelopmentDelay = 0;
+}
+
+
+void FateUncoupledFromCyclePacked::SetCell(CellPtr newCell){
+  assert(newCell!=NULL);
+  pCell = newCell;
+}
+
+
+void FateUncoupledFromCyclePacked::initiate(){
+  mStateWord = 0;
+  for (unsigned region = 0; region < NUM_REGIONS; region++){
+    Enter(mInitialStates[region]);
+  }
+}
+
+
+//Each region's update may move it to another leaf state, whose entry action runs before the next region
+//is updated
+void FateUncoupledFromCyclePacked::process_event(const EvCheckCellData&){
+  State next;
+
+  switch (GetLeaf(CELL_CYCLE_REGION)){
+    case CellCycle_Mitosis_G1: next = UpdateCellCycle_Mitosis_G1(); break;
+    case CellCycle_Mitosis_S: next = UpdateCellCycle_Mitosis_S(); break;
+    case CellCycle_Mitosis_G2: next = UpdateCellCycle_Mitosis_G2(); break;
+    case CellCycle_Mitosis_M: next = UpdateCellCycle_Mitosis_M(); break;
+    case CellCycle_ExitedProlif_G1: next = UpdateCellCycle_ExitedProlif_G1(); break;
+    case CellCycle_ExitedProlif_MeioticS: next = UpdateCellCycle_ExitedProlif_MeioticS(); break;
+    case CellCycle_ExitedProlif_Meiosis: next = UpdateCellCycle_ExitedProlif_Meiosis(); break;
+    default: next = NO_TRANSITION;
+  }
+  if (next != NO_TRANSITION){
+    assert(mTransitions[GetLeaf(CELL_CYCLE_REGION)] & (1u << next));
+    Enter(next);
+  }
+
+  switch (GetLeaf(DIFFERENTIATION_REGION)){
+    case Differentiation_Precursor: next = UpdateDifferentiation_Precursor(); break;
+    case Differentiation_SpermFated: next = UpdateDifferentiation_SpermFated(); break;
+    case Differentiation_OocyteFated: next = UpdateDifferentiation_OocyteFated(); break;
+    case Differentiation_Sperm: next = UpdateDifferentiation_Sperm(); break;
+    default: next = NO_TRANSITION;
+  }
+  if (next != NO_TRANSITION){
+    assert(mTransitions[GetLeaf(DIFFERENTIATION_REGION)] & (1u << next));
+    Enter(next);
+  }
+
+  switch (GetLeaf(GLD2_REGION)){
+    case GLD2_Inactive: next = UpdateGLD2_Inactive(); break;
+    case GLD2_Active: next = UpdateGLD2_Active(); break;
+    default: next = NO_TRANSITION;
+  }
+  if (next != NO_TRANSITION){
+    assert(mTransitions[GetLeaf(GLD2_REGION)] & (1u << next));
+    Enter(next);
+  }
+
+  switch (GetLeaf(GLD1_REGION)){
+    case GLD1_Inactive: next = UpdateGLD1_Inactive(); break;
+    case GLD1_Active: next = UpdateGLD1_Active(); break;
+    default: next = NO_TRANSITION;
+  }
+  if (next != NO_TRANSITION){
+    assert(mTransitions[GetLeaf(GLD1_REGION)] & (1u << next));
+    Enter(next);
+  }
+
+  switch (GetLeaf(LAG1_REGION)){
+    case LAG1_Inactive: next = UpdateLAG1_Inactive(); break;
+    case LAG1_Active: next = UpdateLAG1_Active(); break;
+    default: next = NO_TRANSITION;
+  }
+  if (next != NO_TRANSITION){
+    assert(mTransitions[GetLeaf(LAG1_REGION)] & (1u << next));
+    Enter(next);
+  }
+
+  switch (GetLeaf(GLP1_REGION)){
+    case GLP1_Unbound: next = UpdateGLP1_Unbound(); break;
+    case GLP1_Bound: next = UpdateGLP1_Bound(); break;
+    default: next = NO_TRANSITION;
+  }
+  if (next != NO_TRANSITION){
+    assert(mTransitions[GetLeaf(GLP1_REGION)] & (1u << next));
+    Enter(next);
+  }
+}
+
+void FateUncoupledFromCyclePacked::process_event(const EvGoToCellCycle_Mitosis_G1&){
+  Enter(CellCycle_Mitosis_G1);
+}
+void FateUncoupledFromCyclePacked::process_event(const EvGoToCellCycle_Mitosis_S&){
+  Enter(CellCycle_Mitosis_S);
+}
+void FateUncoupledFromCyclePacked::process_event(const EvGoToCellCycle_Mitosis_G2&){
+  Enter(CellCycle_Mitosis_G2);
+}
+void FateUncoupledFromCyclePacked::process_event(const EvGoToCellCycle_Mitosis_M&){
+  Enter(CellCycle_Mitosis_M);
+}
+
+
+void FateUncoupledFromCyclePacked::Enter(State state){
+  unsigned region = mRegionOf[state];
+  mStateWord = (mStateWord & ~(mMasks[region] << mShifts[region])) | ((state - mFirstLeaf[region]) << mShifts[region]);
+  switch (state){
+    case CellCycle_Mitosis_G1: EnterCellCycle_Mitosis_G1(); break;
+    case CellCycle_Mitosis_S: EnterCellCycle_Mitosis_S(); break;
+    case CellCycle_Mitosis_G2: EnterCellCycle_Mitosis_G2(); break;
+    case CellCycle_Mitosis_M: EnterCellCycle_Mitosis_M(); break;
+    case CellCycle_ExitedProlif_G1: EnterCellCycle_ExitedProlif_G1(); break;
+    case CellCycle_ExitedProlif_MeioticS: EnterCellCycle_ExitedProlif_MeioticS(); break;
+    case CellCycle_ExitedProlif_Meiosis: EnterCellCycle_ExitedProlif_Meiosis(); break;
+    case Differentiation_SpermFated: EnterDifferentiation_SpermFated(); break;
+    case Differentiation_OocyteFated: EnterDifferentiation_OocyteFated(); break;
+    case Differentiation_Sperm: EnterDifferentiation_Sperm(); break;
+    case Differentiation_Oocyte: EnterDifferentiation_Oocyte(); break;
+    default: break;
+  }
+}
+
+
+//The daughter's chart enters the parent's states after its initial ones, so both entry actions run
+boost::shared_ptr<FateUncoupledFromCyclePacked> FateUncoupledFromCyclePacked::CopyInto(boost::shared_ptr<FateUncoupledFromCyclePacked> myNewStatechart){
+  myNewStatechart->initiate();
+  for (unsigned region = 0; region < NUM_REGIONS; region++){
+    myNewStatechart->Enter(GetLeaf((Region)region));
+  }
+  myNewStatechart->SpermatocyteDivisions = this->SpermatocyteDivisions;
+  myNewStatechart->SpermDevelopmentDelay = this->SpermDevelopmentDelay;
+  return myNewStatechart;
+}
+
+
+std::bitset<MAX_STATE_COUNT> FateUncoupledFromCyclePacked::GetState(){
+  std::bitset<MAX_STATE_COUNT> state;
+  for (unsigned region = 0; region < NUM_REGIONS; region++){
+    state.set(GetLeaf((Region)region), 1);
+  }
+  return state;
+}
+
+
+//Enters every leaf state whose bit is set, in order
+void FateUncoupledFromCyclePacked::SetState(std::bitset<MAX_STATE_COUNT> state){
+  for (unsigned leaf = 1; leaf <= Differentiation_Oocyte; leaf++){
+    if (state[leaf]){
+      Enter((State)leaf);
+    }
+  }
+}
+
+
+std::vector<double> FateUncoupledFromCyclePacked::GetVariables(){
+  std::vector<double> variables;
+  variables.push_back(TimeInPhase);
+  variables.push_back(SpermatocyteDivisions);
+  variables.push_back(SpermDevelopmentDelay);
+  //Then the saved locals of each region's active leaf state
+  switch (GetLeaf(CELL_CYCLE_REGION)){
+    case CellCycle_Mitosis_G1: variables.push_back(CellCycle_Mitosis_G1Locals.Duration); break;
+    case CellCycle_Mitosis_S: variables.push_back(CellCycle_Mitosis_SLocals.Duration); break;
+    case CellCycle_Mitosis_G2: variables.push_back(CellCycle_Mitosis_G2Locals.Duration); break;
+    case CellCycle_Mitosis_M: variables.push_back(CellCycle_Mitosis_MLocals.Duration); break;
+    case CellCycle_ExitedProlif_G1: variables.push_back(CellCycle_ExitedProlif_G1Locals.Duration); break;
+    case CellCycle_ExitedProlif_MeioticS: variables.push_back(CellCycle_ExitedProlif_MeioticSLocals.Duration); break;
+    default: variables.push_back(0.0); break;
+  }
+  return variables;
+}
+
+
+//Call after SetState, which enters the active leaf states whose saved locals are restored. Variables
+//saved without the leaf states' locals leave the values the entry actions set.
+void FateUncoupledFromCyclePacked::SetVariables(std::vector<double> variables){
+  TimeInPhase = variables.at(0);
+  SpermatocyteDivisions = variables.at(1);
+  SpermDevelopmentDelay = variables.at(2);
+  if (variables.size() > 3){
+    switch (GetLeaf(CELL_CYCLE_REGION)){
+      case CellCycle_Mitosis_G1: CellCycle_Mitosis_G1Locals.Duration = variables.at(3); break;
+      case CellCycle_Mitosis_S: CellCycle_Mitosis_SLocals.Duration = variables.at(3); break;
+      case CellCycle_Mitosis_G2: CellCycle_Mitosis_G2Locals.Duration = variables.at(3); break;
+      case CellCycle_Mitosis_M: CellCycle_Mitosis_MLocals.Duration = variables.at(3); break;
+      case CellCycle_ExitedProlif_G1: CellCycle_ExitedProlif_G1Locals.Duration = variables.at(3); break;
+      case CellCycle_ExitedProlif_MeioticS: CellCycle_ExitedProlif_MeioticSLocals.Duration = variables.at(3); break;
+      default: break;
+    }
+  }
+}
+
+
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS1(StatechartCellCycleModel, FateUncoupledFromCyclePacked)
+EXPORT_TEMPLATE_CLASS1(ElegansDevStatechartCellCycleModel, FateUncoupledFromCyclePacked)
@@ -35,11 +35,11 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef STATECHARTCELLCYCLEMODEL_HPP_
 #define STATECHARTCELLCYCLEMODEL_HPP_
 
-#define MAX_STATE_COUNT 32
-
 #include "AbstractCellCycleModel.hpp"
 #include "AbstractStatechartCellCycleModel.hpp"
 #include "RandomNumberGenerator.hpp"
+#include "CellRandomStreams.hpp"
+#include "GermlineProfiler.hpp"
 #include <boost/statechart/event.hpp>
 namespace sc = boost::statechart;
 
@@ -114,6 +114,7 @@ public:
         
         mDimension = 3;
         mCurrentCellCyclePhase = G_ONE_PHASE;
+        mUpdatedInAdvance = false;
         
         MAKE_PTR(CELLSTATECHART, myStatechart);
         pStatechart = myStatechart;
@@ -131,6 +132,9 @@ public:
     std::vector<double> TempVariableStorage;
     std::bitset< MAX_STATE_COUNT > TempStateStorage;
 
+    /* Whether the chart has already been updated for the next ReadyToDivide() call. Not archived. */
+    bool mUpdatedInAdvance;
+
 
 
 
@@ -143,11 +147,25 @@ public:
         mpCell = pCell;
         pStatechart->SetCell(mpCell);
         //If loading from an archive, now is an appropriate time to initiate the chart and set its state
-        //and variables from stored values. 
+        //and variables from stored values. Entering the states runs their entry actions, which set cell data
+        //and draw phase durations afresh: the saved durations come back with the variables, and the cell data
+        //(including the cell's draw count) is put back as it was, so a restored run carries on as the saved one.
         if (mLoadingFromArchive == true){
+            CellRandomStreams::Instance()->InitialiseCell(mpCell);
+            boost::shared_ptr<CellData> p_data = mpCell->GetCellData();
+            std::vector<std::string> keys = p_data->GetKeys();
+            std::vector<double> values;
+            for (unsigned i = 0; i < keys.size(); i++){
+                values.push_back(p_data->GetItem(keys[i]));
+            }
             pStatechart->initiate();
-            pStatechart->SetState(TempStateStorage);
+            //Initiating puts every region in its default state, so only the non-default states need GOTO events
+            std::bitset<MAX_STATE_COUNT> defaultState = pStatechart->GetState();
+            pStatechart->SetState(TempStateStorage & ~defaultState);
             pStatechart->SetVariables(TempVariableStorage);
+            for (unsigned i = 0; i < keys.size(); i++){
+                p_data->SetItem(keys[i], values[i]);
+            }
             mLoadingFromArchive = false;
         }
     };
@@ -191,7 +209,8 @@ public:
     */
     virtual void Initialise(){
 
-        //Initialise chart
+        //Initialise chart. Its entry actions draw the cell's random numbers, so it needs its stream first.
+        CellRandomStreams::Instance()->InitialiseCell(mpCell);
         pStatechart->initiate();
     
         //Set cell starting state
@@ -228,28 +247,54 @@ public:
     * @return whether the cell is ready to divide. Set by the statechart.
     */
     bool ReadyToDivide(){
+        if (mUpdatedInAdvance){
+            mUpdatedInAdvance = false;
+            return mReadyToDivide;
+        }
         if (!mReadyToDivide){
             UpdateCellCyclePhase();
         }
         return mReadyToDivide;
     };    
+
+    /**
+    * Does the update ReadyToDivide() would do, so that the charts of many cells can be updated on separate 
+    * threads before the population asks them whether they are ready to divide. Not timed, since the 
+    * profiler's timers are not thread safe; the caller times the whole update.
+    */
+    void UpdateAheadOfDivisionCheck(){
+        if (!mReadyToDivide){
+            pStatechart->process_event(EvCheckCellData());
+        }
+        mUpdatedInAdvance = true;
+    };
     
     /**
     * This method updates the statechart, and the statechart in turn updates the current phase and
     * sets ReadyToDivide as appropriate
     */
     void UpdateCellCyclePhase(){
+        ScopedProfileTimer timer(GermlineProfiler::STATECHART);
         pStatechart->process_event(EvCheckCellData());
     };  
 
     /*
     * Only a slight change to this method from the usual one - we don't need to reset the cell cycle phase
-    * after division because the statechart will handle that.
+    * after division because the statechart will handle that. The parent moves on to a new random stream
+    * before the daughter copies its cell data (see CellRandomStreams).
     */
     void ResetForDivision(){
         mReadyToDivide = false;
+        CellRandomStreams::Instance()->Divide(mpCell, 0);
     };    
 
+    /*
+    * Gives the daughter its own random stream, branching from the parent's.
+    */
+    void InitialiseDaughterCell(){
+        CellRandomStreams::Instance()->Divide(mpCell, 1);
+    };
+
 
 
     //Setter methods for use by the statechart
@@ -260,6 +305,14 @@ public:
         mReadyToDivide = Ready;
     };
 
+    //Getters for the chart's state and variables, used when saving a snapshot of the simulation
+    std::bitset<MAX_STATE_COUNT> GetChartState(){
+        return pStatechart->GetState();
+    };
+    std::vector<double> GetChartVariables(){
+        return pStatechart->GetVariables();
+    };
+
     //A G1 setter method for use by child classes. Doesn't exist in AbstractCellCycleModel for some reason.
     void SetG1Duration(double duration){
         mG1Duration = duration;
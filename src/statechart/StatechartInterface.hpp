@@ -9,65 +9,65 @@
 
 /*
 * Implements some common functions that may be needed by many statechart models of cell
-* behaviour.
+* behaviour. Inline, since every chart's source file includes them.
 */
 
 //CONTROLLING THE CELL CYCLE:
 
-double GetMDuration(CellPtr pCell){
+inline double GetMDuration(CellPtr pCell){
     return pCell->GetCellCycleModel()->GetMDuration();
 };
-double GetSDuration(CellPtr pCell){
+inline double GetSDuration(CellPtr pCell){
     return pCell->GetCellCycleModel()->GetSDuration();
 };
-double GetG1Duration(CellPtr pCell){
+inline double GetG1Duration(CellPtr pCell){
     return pCell->GetCellCycleModel()->GetG1Duration();
 };
-double GetG2Duration(CellPtr pCell){
+inline double GetG2Duration(CellPtr pCell){
     return pCell->GetCellCycleModel()->GetG2Duration();
 };
-void SetCellCyclePhase(CellPtr pCell, CellCyclePhase_ phase){
+inline void SetCellCyclePhase(CellPtr pCell, CellCyclePhase_ phase){
     AbstractCellCycleModel* model = pCell->GetCellCycleModel();
     dynamic_cast<AbstractStatechartCellCycleModel*>(model)->SetCellCyclePhase(phase);
 }
-void SetReadyToDivide(CellPtr pCell, bool Ready){
+inline void SetReadyToDivide(CellPtr pCell, bool Ready){
     AbstractCellCycleModel* model = pCell->GetCellCycleModel();
     dynamic_cast<AbstractStatechartCellCycleModel*>(model)->SetReadyToDivide(Ready);
 };
 
 
 //MISC
-bool IsDead(CellPtr pCell){
+inline bool IsDead(CellPtr pCell){
      return pCell->IsDead();
 };
-double GetTimestep(){
+inline double GetTimestep(){
      return SimulationTime::Instance()->GetTimeStep();
 };
-double GetTime(){
+inline double GetTime(){
      return SimulationTime::Instance()->GetTime();
 };
 
 
 //C ELEGANS SPECIFIC
 
-void SetProliferationFlag(CellPtr pCell, double Flag){
+inline void SetProliferationFlag(CellPtr pCell, double Flag){
     pCell->GetCellData()->SetItem("Proliferating",Flag);
 };
 
-void SetRadius(CellPtr pCell, double radius){
+inline void SetRadius(CellPtr pCell, double radius){
       pCell->GetCellData()->SetItem("Radius",radius);
 };
 
-double GetDistanceFromDTC(CellPtr pCell){
+inline double GetDistanceFromDTC(CellPtr pCell){
     return pCell->GetCellData()->GetItem("DistanceAwayFromDTC");
 };
 
-double GetMaxRadius(CellPtr pCell){
+inline double GetMaxRadius(CellPtr pCell){
     return pCell->GetCellData()->GetItem("MaxRadius"); // Max radius that will fit in the gonad.
 };
 
 //grows cell, provided it is not going to end up too big to fit in the gonad.
-void UpdateRadiusOocyte(CellPtr pCell){
+inline void UpdateRadiusOocyte(CellPtr pCell){
   double MaxRad = GetMaxRadius(pCell);
   double Rad = pCell->GetCellData()->GetItem("Radius");
   if(Rad<(MaxRad-0.05)){
@@ -77,7 +77,7 @@ void UpdateRadiusOocyte(CellPtr pCell){
 
 //grows cell, provided it is not going to end up too big to fit in the gonad, or larger than the max meiotic
 //cell radius (Parameter 38).
-void UpdateRadiusMeiotic(CellPtr pCell){
+inline void UpdateRadiusMeiotic(CellPtr pCell){
   double MaxRad = GetMaxRadius(pCell);
   double Rad = pCell->GetCellData()->GetItem("Radius");
   if(Rad<fmin(MaxRad-0.05,GlobalParameterStruct::Instance()->GetParameter(38))){
@@ -0,0 +1,111 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef STATECHARTMODELFACTORY_HPP_
+#define STATECHARTMODELFACTORY_HPP_
+
+#include <vector>
+#include <bitset>
+#include <boost/shared_ptr.hpp>
+
+#include "StatechartCellCycleModel.hpp"
+#include "CellsGenerator.hpp"
+#include "AbstractCellProliferativeType.hpp"
+
+/*
+* Creates the cells of a simulation with one particular statechart cell cycle model, so that code choosing the
+* model at run time (see StatechartModelRegistry) needs no template parameter of its own.
+*/
+class AbstractStatechartModelFactory
+{
+public:
+
+    virtual ~AbstractStatechartModelFactory()
+    {
+    }
+
+
+    /**
+    * Creates cells with new cell cycle models and random birth times, as CellsGenerator::GenerateBasicRandom does.
+    *
+    * @param rCells filled with the cells
+    * @param numCells the number of cells
+    * @param pProliferativeType the cells' proliferative type
+    */
+    virtual void GenerateCells(std::vector<CellPtr>& rCells, unsigned numCells,
+                               boost::shared_ptr<AbstractCellProliferativeType> pProliferativeType) const = 0;
+
+
+    /**
+    * Creates a cell cycle model that puts its chart into a saved state once it is given its cell.
+    *
+    * @param state the chart's state, as from GetChartState()
+    * @param rVariables the chart's variables, as from GetChartVariables()
+    */
+    virtual AbstractCellCycleModel* CreateRestoredCellCycleModel(std::bitset<MAX_STATE_COUNT> state,
+                                                                 const std::vector<double>& rVariables) const = 0;
+
+};
+
+
+/*
+* The factory of a statechart cell cycle model CELL_CYCLE_MODEL, a StatechartCellCycleModel or one of its
+* child classes with the chart as template parameter, in DIM dimensions.
+*/
+template<class CELL_CYCLE_MODEL, unsigned DIM>
+class StatechartModelFactory : public AbstractStatechartModelFactory
+{
+public:
+
+    void GenerateCells(std::vector<CellPtr>& rCells, unsigned numCells,
+                       boost::shared_ptr<AbstractCellProliferativeType> pProliferativeType) const
+    {
+        CellsGenerator<CELL_CYCLE_MODEL, DIM> cells_generator;
+        cells_generator.GenerateBasicRandom(rCells, numCells, pProliferativeType);
+    }
+
+
+    AbstractCellCycleModel* CreateRestoredCellCycleModel(std::bitset<MAX_STATE_COUNT> state,
+                                                         const std::vector<double>& rVariables) const
+    {
+        CELL_CYCLE_MODEL* p_model = new CELL_CYCLE_MODEL(true);  // <- restores the chart when the cell is set
+        p_model->TempStateStorage = state;
+        p_model->TempVariableStorage = rVariables;
+        return p_model;
+    }
+
+};
+
+#endif /*STATECHARTMODELFACTORY_HPP_*/
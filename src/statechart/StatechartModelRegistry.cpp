@@ -0,0 +1,157 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "StatechartModelRegistry.hpp"
+#include "ElegansDevStatechartCellCycleModel.hpp"
+#include "FateUncoupledFromCycle.hpp"
+#include "FateDecisionCoupledToCycle.hpp"
+#include "FateUncoupledFromCyclePacked.hpp"
+#include "GlobalParameterStruct.hpp"
+#include "Exception.hpp"
+
+//The built in models, compiled once here with their wrapper and dimension
+template class ElegansDevStatechartCellCycleModel<FateUncoupledFromCycle>;
+template class ElegansDevStatechartCellCycleModel<FateDecisionCoupledToCycle>;
+template class ElegansDevStatechartCellCycleModel<FateUncoupledFromCyclePacked>;
+template class StatechartModelFactory<ElegansDevStatechartCellCycleModel<FateUncoupledFromCycle>, 3>;
+template class StatechartModelFactory<ElegansDevStatechartCellCycleModel<FateDecisionCoupledToCycle>, 3>;
+template class StatechartModelFactory<ElegansDevStatechartCellCycleModel<FateUncoupledFromCyclePacked>, 3>;
+
+
+//A pointer to the single registry instance. Initially null.
+StatechartModelRegistry* StatechartModelRegistry::mpInstance = NULL;
+
+
+//Creates the registry on first use
+StatechartModelRegistry* StatechartModelRegistry::Instance()
+{
+    if (mpInstance == NULL){
+        mpInstance = new StatechartModelRegistry();
+    }
+    return mpInstance;
+}
+
+
+void StatechartModelRegistry::Destroy()
+{
+    delete mpInstance;
+    mpInstance = NULL;
+}
+
+
+//The order here gives the models' numbers, so new models go at the end
+StatechartModelRegistry::StatechartModelRegistry()
+{
+    Register("FateUncoupledFromCycle", boost::shared_ptr<AbstractStatechartModelFactory>(
+             new StatechartModelFactory<ElegansDevStatechartCellCycleModel<FateUncoupledFromCycle>, 3>()));
+    Register("FateDecisionCoupledToCycle", boost::shared_ptr<AbstractStatechartModelFactory>(
+             new StatechartModelFactory<ElegansDevStatechartCellCycleModel<FateDecisionCoupledToCycle>, 3>()));
+    Register("FateUncoupledFromCyclePacked", boost::shared_ptr<AbstractStatechartModelFactory>(
+             new StatechartModelFactory<ElegansDevStatechartCellCycleModel<FateUncoupledFromCyclePacked>, 3>()));
+}
+
+
+void StatechartModelRegistry::Register(std::string name, boost::shared_ptr<AbstractStatechartModelFactory> pFactory)
+{
+    for (unsigned i = 0; i < mNames.size(); i++){
+        if (mNames[i] == name){
+            EXCEPTION("A statechart model called " << name << " is already registered.");
+        }
+    }
+    mNames.push_back(name);
+    mFactories.push_back(pFactory);
+}
+
+
+unsigned StatechartModelRegistry::GetModelNumber(std::string name) const
+{
+    std::string known;
+    for (unsigned i = 0; i < mNames.size(); i++){
+        if (mNames[i] == name){
+            return i;
+        }
+        known += (i == 0 ? "" : ", ") + mNames[i];
+    }
+    EXCEPTION("No statechart model is called " << name << ". The models are " << known << ".");
+}
+
+
+std::string StatechartModelRegistry::GetModelName(unsigned number) const
+{
+    if (number >= mNames.size()){
+        EXCEPTION("There is no statechart model " << number << "; there are " << mNames.size() << ".");
+    }
+    return mNames[number];
+}
+
+
+const AbstractStatechartModelFactory& StatechartModelRegistry::GetModel(unsigned number) const
+{
+    if (number >= mFactories.size()){
+        EXCEPTION("There is no statechart model " << number << "; there are " << mFactories.size() << ".");
+    }
+    return *mFactories[number];
+}
+
+
+//Parameter 49 may have been given as a name, which is swapped for the model's number
+unsigned StatechartModelRegistry::GetSelectedModelNumber() const
+{
+    GlobalParameterStruct* p_parameters = GlobalParameterStruct::Instance();
+    if (p_parameters->GetNumParameters() <= 49){
+        return 0;
+    }
+    std::string name = p_parameters->GetParameterText(49);
+    if (!name.empty()){
+        p_parameters->ResetParameter(49, GetModelNumber(name));
+    }
+    double number = p_parameters->GetParameter(49);
+    if (number < 0){
+        EXCEPTION("There is no statechart model " << number << ".");
+    }
+    return (unsigned)(number + 0.5);
+}
+
+
+const AbstractStatechartModelFactory& StatechartModelRegistry::GetSelectedModel() const
+{
+    return GetModel(GetSelectedModelNumber());
+}
+
+
+unsigned StatechartModelRegistry::GetNumModels() const
+{
+    return mNames.size();
+}
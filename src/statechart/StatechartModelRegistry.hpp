@@ -0,0 +1,137 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef STATECHARTMODELREGISTRY_HPP_
+#define STATECHARTMODELREGISTRY_HPP_
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "StatechartModelFactory.hpp"
+
+/*
+* The statechart models of cell behaviour built into the program, each by name and number, so that a
+* simulation's model can be chosen in its parameter file rather than when compiling. One program can then run
+* a sweep over model variants.
+*
+* Parameter 49 chooses the model. It may be given by name in the parameter file (e.g. FateDecisionCoupledToCycle),
+* or by number, which is the model's place in the list below:
+*
+*   0 FateUncoupledFromCycle (the default)
+*   1 FateDecisionCoupledToCycle
+*   2 FateUncoupledFromCyclePacked (model 0 generated with a packed state, see PythonScripts/GenerateStatechart.py)
+*
+* Each is wrapped in ElegansDevStatechartCellCycleModel, in 3 dimensions. All of them, and their wrappers, are
+* instantiated once, in StatechartModelRegistry.cpp; a chart added to the program is registered there too.
+* Models registered later with Register() are numbered after these.
+*/
+class StatechartModelRegistry
+{
+private:
+
+    //A pointer to the singleton instance of this class
+    static StatechartModelRegistry* mpInstance;
+
+    //The models, in order of number
+    std::vector<std::string> mNames;
+    std::vector<boost::shared_ptr<AbstractStatechartModelFactory> > mFactories;
+
+    //Protected constructor, which registers the built in models. Use Instance().
+    StatechartModelRegistry();
+
+public:
+
+    //For retrieving a pointer to the single instance of the class
+    static StatechartModelRegistry* Instance();
+
+
+    //Deletes the single instance
+    static void Destroy();
+
+
+    /**
+    * Adds a model, numbered after those already registered.
+    *
+    * @param name the model's name, normally that of its chart
+    * @param pFactory creates cells with the model
+    */
+    void Register(std::string name, boost::shared_ptr<AbstractStatechartModelFactory> pFactory);
+
+
+    /**
+    * @return the number of a model
+    *
+    * @param name the model's name. An unknown name is an Exception listing the known ones.
+    */
+    unsigned GetModelNumber(std::string name) const;
+
+
+    /**
+    * @return the name of a model
+    *
+    * @param number the model's number
+    */
+    std::string GetModelName(unsigned number) const;
+
+
+    /**
+    * @return the factory of a model
+    *
+    * @param number the model's number. Beyond the last model is an Exception.
+    */
+    const AbstractStatechartModelFactory& GetModel(unsigned number) const;
+
+
+    /**
+    * @return the number of the model parameter 49 chooses, or 0 if the parameters stop short of it. A name given
+    * in the parameter file is replaced by the model's number, so that snapshots and sweeps, which only hold
+    * numbers, keep the choice.
+    */
+    unsigned GetSelectedModelNumber() const;
+
+
+    /**
+    * @return the factory of the model parameter 49 chooses
+    */
+    const AbstractStatechartModelFactory& GetSelectedModel() const;
+
+
+    //Number of models
+    unsigned GetNumModels() const;
+
+};
+
+#endif /*STATECHARTMODELREGISTRY_HPP_*/
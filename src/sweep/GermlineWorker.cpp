@@ -0,0 +1,374 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "GermlineWorker.hpp"
+#include "JobProgressModifier.hpp"
+#include "GermlineSimulation.hpp"
+#include "GlobalParameterStruct.hpp"
+#include "RunManifest.hpp"
+#include "SimulationTime.hpp"
+#include "CellId.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "OutputFileHandler.hpp"
+#include "SmartPointers.hpp"
+#include "Exception.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <exception>
+#include <cstdio>
+#include <dirent.h>
+#include <unistd.h>
+#include <time.h>
+
+
+//Constructor
+GermlineWorker::GermlineWorker(std::string queueDirectory, std::string parameterDirectory)
+    : mParameterDirectory(parameterDirectory),
+      mNumJobsRun(0),
+      mNumJobsFailed(0)
+{
+    OutputFileHandler handler(queueDirectory, false);
+    mQueueDirectory = handler.GetOutputDirectoryFullPath();
+}
+
+
+//Polls the queue until told to stop, or until it has been empty for too long
+unsigned GermlineWorker::Run(double idleMinutes)
+{
+    timespec idleStart;
+    clock_gettime(CLOCK_MONOTONIC, &idleStart);
+    while (!std::ifstream((mQueueDirectory + "STOP").c_str()).is_open()){
+        if (RunNextJob()){
+            clock_gettime(CLOCK_MONOTONIC, &idleStart);
+            continue;
+        }
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (idleMinutes > 0.0 && (now.tv_sec - idleStart.tv_sec) > 60.0*idleMinutes){
+            std::cout << "No jobs for " << idleMinutes << " minutes, stopping" << std::endl;
+            break;
+        }
+        sleep(1);
+    }
+    return mNumJobsRun;
+}
+
+
+//A failed job is recorded, rather than ending the worker
+bool GermlineWorker::RunNextJob()
+{
+    Job job;
+    if (!ClaimNextJob(job)){
+        return false;
+    }
+    std::cout << "Running job " << job.Name << " in " << job.OutputDirectory << std::endl;
+    try{
+        RunJob(job);
+        FinishJob(job, true, "");
+    }catch (Exception& e){
+        std::cout << "Job " << job.Name << " failed: " << e.GetMessage() << std::endl;
+        mNumJobsFailed++;
+        FinishJob(job, false, e.GetMessage());
+    }catch (std::exception& e){
+        std::cout << "Job " << job.Name << " failed: " << e.what() << std::endl;
+        mNumJobsFailed++;
+        FinishJob(job, false, e.what());
+    }
+    mNumJobsRun++;
+    return true;
+}
+
+
+//Renaming is atomic, so if several workers share the queue only one of them gets each job
+bool GermlineWorker::ClaimNextJob(Job& rJob)
+{
+    DIR* p_dir = opendir(mQueueDirectory.c_str());
+    if (p_dir == NULL){
+        EXCEPTION("Could not read queue directory " << mQueueDirectory);
+    }
+    std::vector<std::string> names;
+    for (struct dirent* p_entry = readdir(p_dir); p_entry != NULL; p_entry = readdir(p_dir)){
+        std::string name(p_entry->d_name);
+        if (name.size() > 4 && name.compare(name.size()-4, 4, ".job") == 0){
+            names.push_back(name.substr(0, name.size()-4));
+        }
+    }
+    closedir(p_dir);
+    std::sort(names.begin(), names.end());
+
+    for (unsigned i = 0; i < names.size(); i++){
+        std::string waitingPath = mQueueDirectory + names[i] + ".job";
+        std::string runningPath = mQueueDirectory + names[i] + ".running";
+        if (std::rename(waitingPath.c_str(), runningPath.c_str()) == 0){
+            try{
+                rJob = ReadJob(runningPath, names[i]);
+            }catch (Exception& e){
+                rJob.Name = names[i];
+                std::cout << "Job " << names[i] << " could not be read: " << e.GetMessage() << std::endl;
+                mNumJobsFailed++;
+                mNumJobsRun++;
+                FinishJob(rJob, false, e.GetMessage());
+                continue;
+            }catch (std::exception& e){
+                rJob.Name = names[i];
+                std::cout << "Job " << names[i] << " could not be read: " << e.what() << std::endl;
+                mNumJobsFailed++;
+                mNumJobsRun++;
+                FinishJob(rJob, false, e.what());
+                continue;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//Starts from the same state as a new run of TestElegansGermline (or TestElegansGermlineFromCheckpoint),
+//whatever earlier jobs did to the global state
+void GermlineWorker::RunJob(const Job& rJob)
+{
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+
+    //Cell IDs pick each cell's random numbers, so they must start from the same place
+    CellId::ResetMaxCellId();
+    CellPropertyRegistry::Instance()->Clear();
+
+    GermlineSimulation germline;
+    std::string sourceFile;
+    std::string seedSource;
+    unsigned seed;
+    if (rJob.SnapshotFile.empty()){
+        parameters->ConfigureFromFile(rJob.ParameterFile, mParameterDirectory);
+        seed = ApplyJobParameters(rJob, seedSource);
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        RunManifest::SeedRandomNumberGenerators(seed);
+        germline.SetupFromParameters();
+        sourceFile = mParameterDirectory + rJob.ParameterFile;
+    }else{
+        //Read once, then kept for later jobs. The job's parameter changes go into a copy of the snapshot's
+        //parameters, so that the killers, forces and slabs are built with them. The snapshot also restores its
+        //random number generators' state, which every job would then share, so they are reseeded.
+        if (mSnapshots.find(rJob.SnapshotFile) == mSnapshots.end()){
+            mSnapshots[rJob.SnapshotFile].ReadFromFile(rJob.SnapshotFile);
+        }
+        GermlineSnapshot snapshot = mSnapshots[rJob.SnapshotFile];
+        ApplyJobParametersToSnapshot(rJob, snapshot);
+        germline.SetupFromSnapshot(snapshot);
+        seed = ApplyJobParameters(rJob, seedSource);
+        double endTime = parameters->PeekParameter(35);
+        if (snapshot.GetTime() >= endTime){
+            EXCEPTION("Job " << rJob.Name << " ends at " << endTime << ", before its snapshot at time " << snapshot.GetTime());
+        }
+        germline.rGetSimulator().SetOutputDirectory(germline.GetProcessDirectory(rJob.OutputDirectory).c_str());
+        germline.rGetSimulator().SetEndTime(endTime);
+        RunManifest::SeedRandomNumberGenerators(seed);
+        sourceFile = rJob.SnapshotFile;
+    }
+    RunManifest::Write(rJob.OutputDirectory, sourceFile, seed, seedSource);
+
+    MAKE_PTR_ARGS(JobProgressModifier<3>, p_progress, (mQueueDirectory + rJob.Name + ".progress"));
+    germline.rGetSimulator().AddSimulationModifier(p_progress);
+    germline.rGetSimulator().Solve();
+
+    //As TestElegansGermline leaves a run, less the Chaste archive
+    std::string processDirectory = germline.GetProcessDirectory(rJob.OutputDirectory);
+    OutputFileHandler handler(processDirectory, false);
+    if (germline.GetNumArms() == 1){
+        germline.SaveSnapshot(handler.GetOutputDirectoryFullPath() + "GermlineSnapshot.bin");
+    }
+    parameters->WriteFirstReadTimes(processDirectory);
+    germline.FinishProcesses();
+}
+
+
+//The output directory, parameter changes and seed, in the order TestElegansGermline makes them. A job that
+//starts from a snapshot has had its parameter changes made to the snapshot already.
+unsigned GermlineWorker::ApplyJobParameters(const Job& rJob, std::string& rSeedSource)
+{
+    GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+    parameters->ResetDirectoryName(rJob.OutputDirectory);
+    if (rJob.SnapshotFile.empty()){
+        for (unsigned i = 0; i < rJob.ParameterChanges.size(); i++){
+            parameters->ResetParameter(rJob.ParameterChanges[i].first, rJob.ParameterChanges[i].second);
+        }
+    }
+    if (rJob.Seed > 0){
+        parameters->ResetParameter(43, rJob.Seed);
+    }
+    return RunManifest::GetRunSeed(rSeedSource);
+}
+
+
+//As TestElegansGermlineFromCheckpoint, refuses to change a parameter the saved run has already used, bar the
+//end time (parameters[35]); the seed (parameters[43]) is set after setup, as it only reseeds the generators
+void GermlineWorker::ApplyJobParametersToSnapshot(const Job& rJob, GermlineSnapshot& rSnapshot)
+{
+    for (unsigned i = 0; i < rJob.ParameterChanges.size(); i++){
+        unsigned index = rJob.ParameterChanges[i].first;
+        double firstRead = rSnapshot.GetParameterFirstReadTime(index);
+        if (index != 35 && index != 43 && firstRead >= 0){
+            EXCEPTION("Parameter " << index << " was first used at time " << firstRead << ", before the snapshot at time "
+                      << rSnapshot.GetTime() << ", so job " << rJob.Name << " cannot change it");
+        }
+        rSnapshot.SetParameter(index, rJob.ParameterChanges[i].second);
+    }
+}
+
+
+//A failed job keeps its description, with the error after it
+void GermlineWorker::FinishJob(const Job& rJob, bool succeeded, std::string error)
+{
+    std::string runningPath = mQueueDirectory + rJob.Name + ".running";
+    std::string finishedPath = mQueueDirectory + rJob.Name + (succeeded ? ".done" : ".failed");
+    if (!succeeded){
+        std::ofstream JOB(runningPath.c_str(), std::ios::app);
+        JOB << "Error\t" << error << "\n";
+        JOB.close();
+    }
+    if (std::rename(runningPath.c_str(), finishedPath.c_str()) != 0){
+        EXCEPTION("Failed to rename job " << runningPath << " to " << finishedPath);
+    }
+}
+
+
+//Written to a temporary name that the worker ignores, then renamed
+void GermlineWorker::SubmitJob(std::string queueDirectory, const Job& rJob)
+{
+    if (rJob.Name.empty() || rJob.Name.find(' ') != std::string::npos){
+        EXCEPTION("Job names cannot be empty or contain spaces: \"" << rJob.Name << "\"");
+    }
+    OutputFileHandler handler(queueDirectory, false);
+    std::string filePath = handler.GetOutputDirectoryFullPath() + rJob.Name + ".job";
+    std::string temporaryFilePath = handler.GetOutputDirectoryFullPath() + rJob.Name + ".submitting";
+
+    std::ofstream JOB(temporaryFilePath.c_str());
+    if (!JOB.is_open()){
+        EXCEPTION("Failed to write job " << temporaryFilePath);
+    }
+    JOB << std::setprecision(17);
+    if (!rJob.ParameterFile.empty()){
+        JOB << "ParameterFile\t" << rJob.ParameterFile << "\n";
+    }
+    JOB << "OutputDirectory\t" << rJob.OutputDirectory << "\n";
+    JOB << "Seed\t" << rJob.Seed << "\n";
+    if (!rJob.SnapshotFile.empty()){
+        JOB << "Snapshot\t" << rJob.SnapshotFile << "\n";
+    }
+    for (unsigned i = 0; i < rJob.ParameterChanges.size(); i++){
+        JOB << "Parameter\t" << rJob.ParameterChanges[i].first << "\t" << rJob.ParameterChanges[i].second << "\n";
+    }
+    JOB.close();
+
+    if (std::rename(temporaryFilePath.c_str(), filePath.c_str()) != 0){
+        EXCEPTION("Failed to submit job " << filePath);
+    }
+}
+
+
+//Unknown keys are refused, so a misspelt one does not silently run the wrong simulation
+GermlineWorker::Job GermlineWorker::ReadJob(std::string filePath, std::string name)
+{
+    std::ifstream JOB(filePath.c_str());
+    if (!JOB.is_open()){
+        EXCEPTION("Could not open job " << filePath);
+    }
+    Job job;
+    job.Name = name;
+    job.Seed = 0;
+    std::string line;
+    while (std::getline(JOB, line)){
+        if (line.empty()){
+            continue;
+        }
+        std::stringstream lineStream(line);
+        std::string key;
+        std::getline(lineStream, key, '\t');
+        if (key == "ParameterFile"){
+            std::getline(lineStream, job.ParameterFile);
+        }else if (key == "OutputDirectory"){
+            std::getline(lineStream, job.OutputDirectory);
+        }else if (key == "Seed"){
+            lineStream >> job.Seed;
+        }else if (key == "Snapshot"){
+            std::getline(lineStream, job.SnapshotFile);
+        }else if (key == "Parameter"){
+            unsigned index;
+            double value;
+            if (!(lineStream >> index >> value)){
+                EXCEPTION("Job " << filePath << " has a Parameter line without an index and a value");
+            }
+            job.ParameterChanges.push_back(std::make_pair(index, value));
+        }else if (key == "Error"){
+            continue;
+        }else{
+            EXCEPTION("Job " << filePath << " has an unknown key " << key);
+        }
+    }
+    if (job.OutputDirectory.empty()){
+        EXCEPTION("Job " << filePath << " has no OutputDirectory");
+    }
+    if (job.ParameterFile.empty() && job.SnapshotFile.empty()){
+        EXCEPTION("Job " << filePath << " needs a ParameterFile or a Snapshot");
+    }
+    return job;
+}
+
+
+//Getters
+std::string GermlineWorker::GetQueueDirectory() const
+{
+    return mQueueDirectory;
+}
+
+unsigned GermlineWorker::GetNumJobsRun() const
+{
+    return mNumJobsRun;
+}
+
+unsigned GermlineWorker::GetNumJobsFailed() const
+{
+    return mNumJobsFailed;
+}
+
+unsigned GermlineWorker::GetNumSnapshotsHeld() const
+{
+    return mSnapshots.size();
+}
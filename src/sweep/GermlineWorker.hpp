@@ -0,0 +1,174 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef GERMLINEWORKER_HPP_
+#define GERMLINEWORKER_HPP_
+
+#include "GermlineSnapshot.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+
+/*
+* A long-lived process that runs queued simulations one after another, so that a batch of short runs (e.g. the
+* adult windows of a calibration, all starting from the same snapshot) does not pay for starting a new process,
+* and reading the same snapshot, for every run.
+*
+* The queue is a directory. Each job is a text file, <job name>.job, of "key, tab, value" lines:
+*
+*   ParameterFile      Baseline.txt           (in the data directory; not needed with a Snapshot)
+*   OutputDirectory    MyOutputDirectoryName  (relative to where Chaste output is stored)
+*   Seed               1234                   (optional; 0 or missing seeds the run as any other, see RunManifest)
+*   Snapshot           path/to/GermlineSnapshot.bin  (optional; continue from a stored state)
+*   Parameter          35    5                (optional and repeatable; index and new value. From a snapshot,
+*                                              only parameters the saved run has not used yet, and the end time)
+*
+* SubmitJob writes one, via a temporary file and a rename, so the worker never sees half a job. The worker
+* claims a job by renaming it to <job name>.running (so several workers can share a queue), keeps
+* <job name>.progress up to date with the simulated time, the number of cells and the wall time every simulated
+* hour, and on finishing renames the job to <job name>.done, or to <job name>.failed with the error appended.
+* Jobs are taken in order of name.
+*
+* Before each job the worker returns Chaste's and the model's global state (the simulation time, cell IDs, cell
+* properties, parameters and random number generators) to how a new process would find it, so that a job gives
+* the same results as the same run of TestElegansGermlineRunner. Snapshots are kept in memory once read, and
+* reused by later jobs that start from the same file.
+*/
+
+class GermlineWorker
+{
+public:
+
+    //A queued simulation
+    struct Job
+    {
+        std::string Name;
+        std::string ParameterFile;
+        std::string OutputDirectory;
+        unsigned Seed;
+        std::string SnapshotFile;
+        std::vector<std::pair<unsigned, double> > ParameterChanges;
+    };
+
+private:
+
+    //Full path of the queue directory, with a trailing slash
+    std::string mQueueDirectory;
+
+    //Directory the jobs' parameter files are in
+    std::string mParameterDirectory;
+
+    //Snapshots read so far, keyed by path
+    std::map<std::string, GermlineSnapshot> mSnapshots;
+
+    //Number of jobs run, and how many of those failed
+    unsigned mNumJobsRun;
+    unsigned mNumJobsFailed;
+
+    //Claims the first waiting job by name, returning false if there are none
+    bool ClaimNextJob(Job& rJob);
+
+    //Sets up and solves one job's simulation
+    void RunJob(const Job& rJob);
+
+    //Sets a job's output directory, parameter changes and seed, returning the run seed and where it came from
+    unsigned ApplyJobParameters(const Job& rJob, std::string& rSeedSource);
+
+    //Makes a job's parameter changes to a copy of its snapshot, before the simulation is set up from it
+    void ApplyJobParametersToSnapshot(const Job& rJob, GermlineSnapshot& rSnapshot);
+
+    //Renames a claimed job to show how it ended
+    void FinishJob(const Job& rJob, bool succeeded, std::string error);
+
+public:
+
+    /**
+    * Constructor.
+    *
+    * @param queueDirectory the queue directory, relative to where Chaste output is stored
+    * @param parameterDirectory the directory the jobs' parameter files are in
+    */
+    GermlineWorker(std::string queueDirectory, std::string parameterDirectory);
+
+
+    /**
+    * Runs jobs until the queue directory holds a file called STOP, or until no job has been waiting for a
+    * given time. Polls the queue every second while it is empty. A job that fails is recorded as failed and
+    * the worker moves on to the next.
+    *
+    * @param idleMinutes how long to wait for a job before stopping; 0 waits for ever
+    * @return the number of jobs run
+    */
+    unsigned Run(double idleMinutes);
+
+
+    /**
+    * Runs the first waiting job, if there is one.
+    *
+    * @return whether there was a job to run
+    */
+    bool RunNextJob();
+
+
+    /**
+    * Adds a job to a queue.
+    *
+    * @param queueDirectory the queue directory, relative to where Chaste output is stored
+    * @param rJob the job. Its name must be unique in the queue and contain no spaces.
+    */
+    static void SubmitJob(std::string queueDirectory, const Job& rJob);
+
+
+    /**
+    * Reads a job file.
+    *
+    * @param filePath path of the file
+    * @param name the job's name
+    * @return the job
+    */
+    static Job ReadJob(std::string filePath, std::string name);
+
+
+    //Getters
+    std::string GetQueueDirectory() const;
+    unsigned GetNumJobsRun() const;
+    unsigned GetNumJobsFailed() const;
+    unsigned GetNumSnapshotsHeld() const;
+
+};
+
+#endif /*GERMLINEWORKER_HPP_*/
@@ -0,0 +1,146 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "JobProgressModifier.hpp"
+#include "SimulationTime.hpp"
+#include "GlobalParameterStruct.hpp"
+#include "Exception.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <time.h>
+
+
+//Monotonic wall time
+static double WallSeconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + 1e-9*now.tv_nsec;
+}
+
+
+//Constructor
+template<unsigned DIM>
+JobProgressModifier<DIM>::JobProgressModifier(std::string progressFilePath)
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mProgressFilePath(progressFilePath),
+      mStartSeconds(0.0),
+      mLastHour(-1)
+{}
+
+
+//Empty destructor
+template<unsigned DIM>
+JobProgressModifier<DIM>::~JobProgressModifier(){}
+
+
+//Getter for mProgressFilePath
+template<unsigned DIM>
+std::string JobProgressModifier<DIM>::GetProgressFilePath() const
+{
+  return mProgressFilePath;
+};
+
+
+//Whoever reads the file never sees it half written
+template<unsigned DIM>
+void JobProgressModifier<DIM>::WriteProgress(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+  SimulationTime* p_time = SimulationTime::Instance();
+  std::string temporaryFilePath = mProgressFilePath + ".tmp";
+  std::ofstream PROGRESS(temporaryFilePath.c_str());
+  if (!PROGRESS.is_open()){
+    EXCEPTION("Failed to write job progress " << temporaryFilePath);
+  }
+  PROGRESS << std::setprecision(10);
+  PROGRESS << "Time\t" << p_time->GetTime() << "\tEndTime\t" << GlobalParameterStruct::Instance()->PeekParameter(35)
+           << "\tCells\t" << rCellPopulation.GetNumRealCells()
+           << "\tWallSeconds\t" << WallSeconds() - mStartSeconds
+           << "\tFinished\t" << (p_time->IsFinished() ? 1 : 0) << "\n";
+  PROGRESS.close();
+  if (std::rename(temporaryFilePath.c_str(), mProgressFilePath.c_str()) != 0){
+    EXCEPTION("Failed to replace job progress " << mProgressFilePath);
+  }
+}
+
+
+//Starting here leaves the simulation's own setup out of the wall time
+template<unsigned DIM>
+void JobProgressModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+  mStartSeconds = WallSeconds();
+  mLastHour = (int)floor(SimulationTime::Instance()->GetTime() + 1e-9);
+  if (!mProgressFilePath.empty()){
+    WriteProgress(rCellPopulation);
+  }
+}
+
+
+//A whole hour has passed when the time's floor moves on
+template<unsigned DIM>
+void JobProgressModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+  int hour = (int)floor(SimulationTime::Instance()->GetTime() + 1e-9);
+  if (!mProgressFilePath.empty() && (hour > mLastHour || SimulationTime::Instance()->IsFinished())){
+    WriteProgress(rCellPopulation);
+  }
+  mLastHour = hour;
+}
+
+
+//Output this class's parameters to a log file
+template<unsigned DIM>
+void JobProgressModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+  *rParamsFile << "\t\t\t<ProgressFilePath>" << mProgressFilePath << "</ProgressFilePath>\n";
+  // Call method on direct parent class
+  AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Explicit instantiation
+/////////////////////////////////////////////////////////////////////////////
+
+template class JobProgressModifier<1>;
+template class JobProgressModifier<2>;
+template class JobProgressModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(JobProgressModifier)
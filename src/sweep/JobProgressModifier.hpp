@@ -0,0 +1,118 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef JOBPROGRESSMODIFIER_HPP_
+#define JOBPROGRESSMODIFIER_HPP_
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/string.hpp>
+
+/**
+ * A modifier that reports how far a simulation has got, for a GermlineWorker's jobs. At the start, on every
+ * whole simulated hour and at the end, it replaces the progress file with one line of "key, tab, value" pairs:
+ * the simulated time, the end time, the number of cells, the wall time since the start in seconds, and whether
+ * the simulation has finished.
+ */
+template<unsigned DIM>
+class JobProgressModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mProgressFilePath;
+    }
+
+    //Full path of the progress file
+    std::string mProgressFilePath;
+
+    //Wall time at the start of the simulation, in seconds
+    double mStartSeconds;
+
+    //The last whole simulated hour reported
+    int mLastHour;
+
+    //Writes the progress file, via a temporary file and a rename
+    void WriteProgress(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    //Constructor
+    JobProgressModifier(std::string progressFilePath = "");
+
+
+    //Destructor
+    virtual ~JobProgressModifier();
+
+
+    //Getter for mProgressFilePath
+    std::string GetProgressFilePath() const;
+
+
+    /**
+     * Overriden SetupSolve method. Starts the wall clock and reports the starting time.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+     void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+
+    /**
+     * Overriden UpdateAtEndOfTimeStep method. Reports on whole hours and at the end of the simulation.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+     void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+
+     //Output any parameters associated with this class
+     void OutputSimulationModifierParameters(out_stream& rParamsFile);
+
+};
+
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(JobProgressModifier)
+
+#endif /*JOBPROGRESSMODIFIER_HPP_*/
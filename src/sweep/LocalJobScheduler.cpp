@@ -0,0 +1,212 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "LocalJobScheduler.hpp"
+#include "RunManifest.hpp"
+#include "OutputFileHandler.hpp"
+#include "Exception.hpp"
+
+#include <map>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+
+//Constructor. Works out how many cores are available if no job limit was given.
+LocalJobScheduler::LocalJobScheduler(std::string executable, std::string baseParameterFile, unsigned maxConcurrentJobs)
+    : mExecutable(executable),
+      mBaseParameterFile(baseParameterFile),
+      mMaxConcurrentJobs(maxConcurrentJobs),
+      mForkTime(0.0),
+      mSeed(0),
+      mUseSeed(false)
+{
+    if (mMaxConcurrentJobs == 0){
+        long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+        mMaxConcurrentJobs = (numCores > 0) ? (unsigned)numCores : 1;
+    }
+}
+
+
+//Setter for warm started sweeps
+void LocalJobScheduler::SetWarmStart(std::string forkExecutable, double forkTime)
+{
+    mForkExecutable = forkExecutable;
+    mForkTime = forkTime;
+}
+
+
+//Setter for the sweep seed
+void LocalJobScheduler::SetSeed(unsigned seed)
+{
+    mSeed = seed;
+    mUseSeed = true;
+}
+
+
+//Observers of completed jobs
+void LocalJobScheduler::AddObserver(AbstractSweepJobObserver* pObserver)
+{
+    mObservers.push_back(pObserver);
+}
+
+
+//Keeps the job slots full until the manifest runs out of pending jobs, then waits for the stragglers
+void LocalJobScheduler::Run(SweepJobManifest& rManifest, bool larvalOnly)
+{
+    OutputFileHandler logHandler(rManifest.GetSweepName() + "/logs", false);
+    std::string logDirectory = logHandler.GetOutputDirectoryFullPath();
+
+    std::map<pid_t, unsigned> runningJobs;   // <- process ID to job ID
+
+    while (true){
+
+        //Launch jobs while there are free slots
+        int nextJob = rManifest.GetNextPendingJob(larvalOnly);
+        while (nextJob >= 0 && runningJobs.size() < mMaxConcurrentJobs){
+            pid_t pid = LaunchJob(rManifest.rGetJob(nextJob), rManifest, logDirectory);
+            runningJobs[pid] = (unsigned)nextJob;
+            rManifest.SetJobStatus(nextJob, RUNNING);
+            std::cout << "Started " << rManifest.rGetJob(nextJob).Directory << std::endl;
+            nextJob = rManifest.GetNextPendingJob(larvalOnly);
+        }
+
+        if (runningJobs.empty()){
+            break;
+        }
+
+        //Wait for any job to finish
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0){
+            if (errno == EINTR){
+                continue;
+            }
+            EXCEPTION("Lost track of running sweep jobs.");
+        }
+        std::map<pid_t, unsigned>::iterator finished = runningJobs.find(pid);
+        if (finished == runningJobs.end()){
+            continue;
+        }
+
+        bool succeeded = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        rManifest.SetJobStatus(finished->second, succeeded ? COMPLETE : FAILED);
+        std::cout << (succeeded ? "Finished " : "FAILED ") << rManifest.rGetJob(finished->second).Directory
+                  << " (" << rManifest.GetNumJobsWithStatus(COMPLETE) << "/" << rManifest.GetNumJobs()
+                  << " complete)" << std::endl;
+        if (succeeded){
+            for (unsigned i = 0; i < mObservers.size(); i++){
+                mObservers[i]->JobCompleted(rManifest, finished->second);
+            }
+        }
+        runningJobs.erase(finished);
+    }
+}
+
+
+//Builds the job's command line and runs it in a child process with output redirected to a log file
+pid_t LocalJobScheduler::LaunchJob(const SweepJob& rJob, const SweepJobManifest& rManifest, std::string logDirectory)
+{
+    std::stringstream forkTime;
+    forkTime << std::setprecision(12) << mForkTime;
+
+    //Command line: executable, parameter file, output directory, then (index, value) pairs. Forked runs
+    //also give the larval run to continue from, and larval runs just reset the end time.
+    std::vector<std::string> arguments;
+    arguments.push_back(rJob.Kind == FORKED_RUN ? mForkExecutable : mExecutable);
+    arguments.push_back(mBaseParameterFile);
+    arguments.push_back(rJob.Directory);
+    if (rJob.Kind == LARVAL_RUN){
+        arguments.push_back("35");
+        arguments.push_back(forkTime.str());
+    }
+    if (rJob.Kind == FORKED_RUN){
+        arguments.push_back(rManifest.rGetJob(rJob.DependsOn).Directory);
+        arguments.push_back(forkTime.str());
+    }
+    if (mUseSeed){
+        std::stringstream seed;
+        seed << RunManifest::DeriveSeed(mSeed, "Replicate", rJob.Replicate);
+        arguments.push_back("43");
+        arguments.push_back(seed.str());
+    }
+    const std::vector<int>& rParameterIndices = rManifest.rGetParameterIndices();
+    for (unsigned p = 0; p < rJob.ParameterValues.size(); p++){
+        std::stringstream index;
+        index << rParameterIndices[p];
+        std::stringstream value;
+        value << std::setprecision(12) << rJob.ParameterValues[p];
+        arguments.push_back(index.str());
+        arguments.push_back(value.str());
+    }
+
+    std::string jobName = rJob.Directory.substr(rJob.Directory.find_last_of('/') + 1);
+    std::string logFile = logDirectory + jobName + ".txt";
+
+    //Set up everything the child needs before forking
+    std::vector<char*> argv;
+    for (unsigned i = 0; i < arguments.size(); i++){
+        argv.push_back(const_cast<char*>(arguments[i].c_str()));
+    }
+    argv.push_back(NULL);
+
+    pid_t pid = fork();
+    if (pid < 0){
+        EXCEPTION("Failed to start sweep job " << rJob.Id);
+    }
+    if (pid == 0){
+        //Child: send output to the log file, then become the simulation
+        int logDescriptor = open(logFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (logDescriptor >= 0){
+            dup2(logDescriptor, STDOUT_FILENO);
+            dup2(logDescriptor, STDERR_FILENO);
+            close(logDescriptor);
+        }
+        execv(argv[0], &argv[0]);
+        _exit(127); // <- only reached if exec failed
+    }
+    return pid;
+}
+
+
+//Getter
+unsigned LocalJobScheduler::GetMaxConcurrentJobs() const
+{
+    return mMaxConcurrentJobs;
+}
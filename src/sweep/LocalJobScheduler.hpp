@@ -0,0 +1,159 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef LOCALJOBSCHEDULER_HPP_
+#define LOCALJOBSCHEDULER_HPP_
+
+#include "SweepJobManifest.hpp"
+#include "AbstractSweepJobObserver.hpp"
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+/*
+* Runs the jobs in a sweep manifest as separate processes on the local machine, keeping up to
+* mMaxConcurrentJobs running at once.
+*
+* Each job is launched as
+*
+*   <executable> <base parameter file> <job output directory> <index 1> <value 1> <index 2> <value 2> ...
+*
+* which is the command line understood by TestElegansGermlineRunner. In a warm started sweep, larval runs
+* are launched as
+*
+*   <executable> <base parameter file> <job output directory> 35 <fork time>
+*
+* so that they stop (and save their state) at the fork time, and forked runs as
+*
+*   <fork executable> <base parameter file> <job output directory> <larval run directory> <fork time> <index 1> <value 1> ...
+*
+* which is the command line understood by TestElegansGermlineFromCheckpointRunner. If a sweep seed is set, every
+* job's (index, value) pairs start with 43 <replicate seed>, the replicate seed being derived from the sweep seed
+* and the job's replicate number (see RunManifest). Jobs of the same replicate at different design points then
+* share a seed, so that differences between design points are not swamped by noise. A job's standard output and error
+* go to <sweep name>/logs/JobNNNN.txt. A job counts as complete when its process exits with status 0.
+* The manifest is saved after every change in job status, so an interrupted sweep can be resumed by
+* running it again. Observers, if any, are told of each job as it completes.
+*/
+
+class LocalJobScheduler
+{
+private:
+
+    //Path to the simulation executable
+    std::string mExecutable;
+
+    //Parameter file every job starts from
+    std::string mBaseParameterFile;
+
+    //Number of jobs to run at once
+    unsigned mMaxConcurrentJobs;
+
+    //Executable that continues runs from saved state, and the time the larval runs stop at
+    std::string mForkExecutable;
+    double mForkTime;
+
+    //Sweep seed, from which each replicate's run seed (parameter 43) is derived, and whether it was set
+    unsigned mSeed;
+    bool mUseSeed;
+
+    //Told of every job that completes. Not owned.
+    std::vector<AbstractSweepJobObserver*> mObservers;
+
+    /**
+    * Forks and execs one job.
+    *
+    * @param rJob the job to run
+    * @param rManifest the sweep the job belongs to
+    * @param logDirectory full path of the directory for the job's log file
+    * @return the process ID of the job
+    */
+    pid_t LaunchJob(const SweepJob& rJob, const SweepJobManifest& rManifest, std::string logDirectory);
+
+public:
+
+    /**
+    * Constructor.
+    *
+    * @param executable path to the simulation executable
+    * @param baseParameterFile name of the parameter file in the data directory
+    * @param maxConcurrentJobs number of jobs to run at once. 0 means one per online core.
+    */
+    LocalJobScheduler(std::string executable, std::string baseParameterFile, unsigned maxConcurrentJobs);
+
+
+    /**
+    * Sets the executable and fork time used for larval and forked runs in warm started sweeps.
+    *
+    * @param forkExecutable path to the executable that continues a run from saved state
+    * @param forkTime the time at which larval runs stop
+    */
+    void SetWarmStart(std::string forkExecutable, double forkTime);
+
+
+    /**
+    * Sets the sweep seed. Jobs then pass their replicate's run seed as parameter 43, rather than have each run
+    * derive its seed from its output directory name.
+    *
+    * @param seed the sweep seed
+    */
+    void SetSeed(unsigned seed);
+
+
+    /**
+    * Adds an observer, to be told of every job that completes from now on.
+    *
+    * @param pObserver the observer, which must outlive the scheduler's runs
+    */
+    void AddObserver(AbstractSweepJobObserver* pObserver);
+
+
+    /**
+    * Runs every pending job in the manifest, returning once they have all finished. Jobs are only
+    * started once the job they depend on has completed; jobs whose dependency failed are left pending.
+    *
+    * @param rManifest the sweep to run. Job statuses are updated and saved as jobs start and finish.
+    * @param larvalOnly whether to run only the larval runs of a warm started sweep
+    */
+    void Run(SweepJobManifest& rManifest, bool larvalOnly = false);
+
+
+    //Getters
+    unsigned GetMaxConcurrentJobs() const;
+
+};
+
+#endif /*LOCALJOBSCHEDULER_HPP_*/
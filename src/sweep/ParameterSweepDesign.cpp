@@ -0,0 +1,341 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ParameterSweepDesign.hpp"
+#include "SobolSequence.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "Exception.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+
+//Splits a line from a sweep file into its tab separated fields
+static std::vector<std::string> SplitOnTabs(const std::string& rLine)
+{
+    std::vector<std::string> fields;
+    std::stringstream lineStream(rLine);
+    std::string field;
+    while (std::getline(lineStream, field, '\t')){
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+
+//Reads the value field of the next header line, throwing if the file ends early
+static std::string ReadHeaderValue(std::ifstream& rFile, std::string description)
+{
+    std::string line;
+    if (!std::getline(rFile, line)){
+        EXCEPTION("Sweep file ended before the " << description << " was given.");
+    }
+    std::vector<std::string> fields = SplitOnTabs(line);
+    if (fields.empty()){
+        EXCEPTION("Sweep file has an empty line where the " << description << " was expected.");
+    }
+    //Remove any trailing whitespace (comments are optional, so values may be space padded)
+    std::string value = fields[0];
+    value.erase(value.find_last_not_of(" \r") + 1);
+    return value;
+}
+
+
+//Constructor, leaves the design empty
+ParameterSweepDesign::ParameterSweepDesign()
+    : mNumberOfPoints(0),
+      mNumberOfReplicates(1),
+      mSeed(0),
+      mMaxConcurrentJobs(0),
+      mForkTime(0.0)
+{}
+
+
+//Reads the design from file, in the fixed line order documented in the header
+void ParameterSweepDesign::ConfigureFromFile(std::string filename, std::string directory)
+{
+    std::string filepath = directory + filename;
+    std::ifstream SWEEP(filepath.c_str());
+    if (!SWEEP.is_open()){
+        EXCEPTION("Failed to open sweep file " << filepath);
+    }
+
+    mSweepName          = ReadHeaderValue(SWEEP, "sweep name");
+    mBaseParameterFile  = ReadHeaderValue(SWEEP, "base parameter file");
+    mExecutable         = ReadHeaderValue(SWEEP, "simulation executable");
+    mDesignType         = ReadHeaderValue(SWEEP, "design type");
+    mNumberOfPoints     = atoi(ReadHeaderValue(SWEEP, "number of design points").c_str());
+    mNumberOfReplicates = atoi(ReadHeaderValue(SWEEP, "number of replicates").c_str());
+    mSeed               = atoi(ReadHeaderValue(SWEEP, "random seed").c_str());
+    mMaxConcurrentJobs  = atoi(ReadHeaderValue(SWEEP, "number of concurrent jobs").c_str());
+    mForkTime           = strtod(ReadHeaderValue(SWEEP, "warm start fork time").c_str(), 0);
+    mForkExecutable     = ReadHeaderValue(SWEEP, "warm start executable");
+
+    //The manifest and job command lines are split on whitespace, so the name can't hold any
+    if (mSweepName.empty() || mSweepName.find_first_of(" \t") != std::string::npos){
+        EXCEPTION("Sweep name \"" << mSweepName << "\" must be given, without spaces.");
+    }
+    if (mDesignType != "Grid" && mDesignType != "LatinHypercube" && mDesignType != "Sobol" && mDesignType != "Saltelli"){
+        EXCEPTION("Unknown sweep design type " << mDesignType << ". Use Grid, LatinHypercube, Sobol or Saltelli.");
+    }
+    if (mNumberOfReplicates == 0){
+        EXCEPTION("A sweep needs at least one replicate per design point.");
+    }
+
+    //Remaining lines describe the varied parameters
+    std::string line;
+    while (std::getline(SWEEP, line)){
+        std::vector<std::string> fields = SplitOnTabs(line);
+        if (fields.empty() || fields[0].empty()){
+            continue;
+        }
+        if (fields.size() < 4){
+            EXCEPTION("Sweep file parameter lines need an index, minimum, maximum and number of grid levels.");
+        }
+        mParameterIndices.push_back(atoi(fields[0].c_str()));
+        mMinimumValues.push_back(strtod(fields[1].c_str(), 0));
+        mMaximumValues.push_back(strtod(fields[2].c_str(), 0));
+        mGridLevels.push_back((unsigned)atoi(fields[3].c_str()));
+        mParameterNames.push_back(fields.size() > 4 ? fields[4] : std::string());
+    }
+    SWEEP.close();
+
+    if (mParameterIndices.empty()){
+        EXCEPTION("Sweep file does not vary any parameters.");
+    }
+    unsigned sobolDimension = (mDesignType == "Saltelli") ? 2*mParameterIndices.size() : mParameterIndices.size();
+    if ((mDesignType == "Sobol" || mDesignType == "Saltelli") && sobolDimension > SobolSequence::GetMaxDimension()){
+        EXCEPTION(mDesignType << " designs of " << mParameterIndices.size() << " parameters need a Sobol sequence of "
+                  << sobolDimension << " dimensions, but only " << SobolSequence::GetMaxDimension() << " are available.");
+    }
+}
+
+
+//Dispatches to the appropriate generator
+std::vector< std::vector<double> > ParameterSweepDesign::GenerateDesignPoints() const
+{
+    if (mDesignType == "Grid"){
+        return GenerateGridPoints();
+    }else if (mDesignType == "LatinHypercube"){
+        return GenerateLatinHypercubePoints();
+    }else if (mDesignType == "Saltelli"){
+        return GenerateSaltelliPoints();
+    }
+    return GenerateSobolPoints();
+}
+
+
+//Full factorial design. The first parameter varies slowest.
+std::vector< std::vector<double> > ParameterSweepDesign::GenerateGridPoints() const
+{
+    unsigned numParams = mParameterIndices.size();
+    unsigned numPoints = 1;
+    for (unsigned p = 0; p < numParams; p++){
+        if (mGridLevels[p] == 0){
+            EXCEPTION("Grid designs need at least one level for every parameter.");
+        }
+        numPoints *= mGridLevels[p];
+    }
+
+    std::vector< std::vector<double> > points(numPoints, std::vector<double>(numParams));
+    for (unsigned i = 0; i < numPoints; i++){
+        unsigned remainder = i;
+        for (int p = (int)numParams - 1; p >= 0; p--){
+            unsigned level = remainder % mGridLevels[p];
+            remainder /= mGridLevels[p];
+            if (mGridLevels[p] == 1){
+                points[i][p] = mMinimumValues[p];
+            }else{
+                points[i][p] = mMinimumValues[p] + level*(mMaximumValues[p] - mMinimumValues[p])/(mGridLevels[p] - 1);
+            }
+        }
+    }
+    return points;
+}
+
+
+//Latin hypercube: each parameter range is cut into mNumberOfPoints strata, and every stratum is
+//used exactly once per parameter. Points are jittered uniformly within their strata.
+std::vector< std::vector<double> > ParameterSweepDesign::GenerateLatinHypercubePoints() const
+{
+    if (mNumberOfPoints == 0){
+        EXCEPTION("Latin hypercube designs need a number of design points.");
+    }
+    unsigned numParams = mParameterIndices.size();
+
+    RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+    p_gen->Reseed(mSeed);
+
+    std::vector< std::vector<double> > unitPoints(mNumberOfPoints, std::vector<double>(numParams));
+    for (unsigned p = 0; p < numParams; p++){
+
+        //Random permutation of the strata (Fisher-Yates)
+        std::vector<unsigned> strata(mNumberOfPoints);
+        for (unsigned i = 0; i < mNumberOfPoints; i++){
+            strata[i] = i;
+        }
+        for (unsigned i = mNumberOfPoints - 1; i > 0; i--){
+            unsigned j = p_gen->randMod(i + 1);
+            std::swap(strata[i], strata[j]);
+        }
+
+        for (unsigned i = 0; i < mNumberOfPoints; i++){
+            unitPoints[i][p] = (strata[i] + p_gen->ranf()) / mNumberOfPoints;
+        }
+    }
+
+    std::vector< std::vector<double> > points;
+    for (unsigned i = 0; i < mNumberOfPoints; i++){
+        points.push_back(ScaleToRanges(unitPoints[i]));
+    }
+    return points;
+}
+
+
+//Sobol design. The first point of the sequence (the origin) is skipped, since it sits on the corner
+//of every range.
+std::vector< std::vector<double> > ParameterSweepDesign::GenerateSobolPoints() const
+{
+    if (mNumberOfPoints == 0){
+        EXCEPTION("Sobol designs need a number of design points.");
+    }
+    SobolSequence sequence(mParameterIndices.size());
+    sequence.Skip(1);
+
+    std::vector< std::vector<double> > points;
+    for (unsigned i = 0; i < mNumberOfPoints; i++){
+        points.push_back(ScaleToRanges(sequence.GetNextPoint()));
+    }
+    return points;
+}
+
+
+//Saltelli design. Each point of a Sobol sequence of twice the dimension is split into A (the first half) and
+//B (the second), and gives the points A, B, then A with each parameter in turn taken from B.
+std::vector< std::vector<double> > ParameterSweepDesign::GenerateSaltelliPoints() const
+{
+    if (mNumberOfPoints == 0){
+        EXCEPTION("Saltelli designs need a number of base samples.");
+    }
+    unsigned numParams = mParameterIndices.size();
+    SobolSequence sequence(2*numParams);
+    sequence.Skip(1);
+
+    std::vector< std::vector<double> > points;
+    for (unsigned i = 0; i < mNumberOfPoints; i++){
+        std::vector<double> unitPoint = sequence.GetNextPoint();
+        std::vector<double> pointA(unitPoint.begin(), unitPoint.begin() + numParams);
+        std::vector<double> pointB(unitPoint.begin() + numParams, unitPoint.end());
+        points.push_back(ScaleToRanges(pointA));
+        points.push_back(ScaleToRanges(pointB));
+        for (unsigned p = 0; p < numParams; p++){
+            std::vector<double> mixed = pointA;
+            mixed[p] = pointB[p];
+            points.push_back(ScaleToRanges(mixed));
+        }
+    }
+    return points;
+}
+
+
+//Linear map from [0,1) onto [min,max) for each parameter
+std::vector<double> ParameterSweepDesign::ScaleToRanges(const std::vector<double>& rUnitPoint) const
+{
+    std::vector<double> point(rUnitPoint.size());
+    for (unsigned p = 0; p < rUnitPoint.size(); p++){
+        point[p] = mMinimumValues[p] + rUnitPoint[p]*(mMaximumValues[p] - mMinimumValues[p]);
+    }
+    return point;
+}
+
+
+//Getters
+std::string ParameterSweepDesign::GetSweepName() const
+{
+    return mSweepName;
+}
+std::string ParameterSweepDesign::GetBaseParameterFile() const
+{
+    return mBaseParameterFile;
+}
+std::string ParameterSweepDesign::GetExecutable() const
+{
+    return mExecutable;
+}
+std::string ParameterSweepDesign::GetDesignType() const
+{
+    return mDesignType;
+}
+unsigned ParameterSweepDesign::GetNumberOfPoints() const
+{
+    return mNumberOfPoints;
+}
+unsigned ParameterSweepDesign::GetNumberOfReplicates() const
+{
+    return mNumberOfReplicates;
+}
+unsigned ParameterSweepDesign::GetSeed() const
+{
+    return mSeed;
+}
+unsigned ParameterSweepDesign::GetMaxConcurrentJobs() const
+{
+    return mMaxConcurrentJobs;
+}
+double ParameterSweepDesign::GetForkTime() const
+{
+    return mForkTime;
+}
+std::string ParameterSweepDesign::GetForkExecutable() const
+{
+    return mForkExecutable;
+}
+const std::vector<int>& ParameterSweepDesign::rGetParameterIndices() const
+{
+    return mParameterIndices;
+}
+const std::vector<std::string>& ParameterSweepDesign::rGetParameterNames() const
+{
+    return mParameterNames;
+}
+const std::vector<double>& ParameterSweepDesign::rGetMinimumValues() const
+{
+    return mMinimumValues;
+}
+const std::vector<double>& ParameterSweepDesign::rGetMaximumValues() const
+{
+    return mMaximumValues;
+}
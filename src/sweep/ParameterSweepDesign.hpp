@@ -0,0 +1,146 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef PARAMETERSWEEPDESIGN_HPP_
+#define PARAMETERSWEEPDESIGN_HPP_
+
+#include <string>
+#include <vector>
+
+/*
+* Describes a parameter sweep: which entries of the parameter file are varied, over what ranges, and
+* how points are placed in that space (full factorial grid, Latin hypercube, Sobol sequence, or the Saltelli
+* design used to estimate Sobol sensitivity indices).
+*
+* A design is read from a sweep file in the data directory. Like a parameter file, every line holds a
+* value, a tab, then an optional comment, and the lines must come in this order:
+*
+* - Line 1: sweep name, without spaces. Used as the output directory holding the manifest, index and all job outputs.
+* - Line 2: name of the base parameter file (e.g. Baseline.txt)
+* - Line 3: path of the simulation executable, relative to the directory the sweep is launched from
+* - Line 4: design type, one of Grid, LatinHypercube, Sobol or Saltelli
+* - Line 5: number of design points (ignored for Grid, where it is the product of the grid levels). For Saltelli,
+*   the number of base samples N, each of which gives (number of parameters + 2) design points (see
+*   SobolIndexAccumulator).
+* - Line 6: number of replicates to run at each design point
+* - Line 7: random seed (used by LatinHypercube, and to derive each replicate's run seed)
+* - Line 8: maximum number of jobs to run at once. 0 means one per available core.
+* - Line 9: fork time for warm starts, in hours. 0 runs every job from scratch. Otherwise the run up
+*   to this time is simulated once per replicate with the base parameters, and every design point
+*   continues from its saved state. Only valid if the varied parameters are unused before the fork,
+*   which is checked after the first stage (see SweepJobManifest::FindParametersUsedBeforeFork).
+* - Line 10: path of the executable that continues a run from saved state (normally
+*   TestElegansGermlineFromCheckpointRunner). Unused if the fork time is 0.
+* - Subsequent lines: parameter index, tab, minimum, tab, maximum, tab, number of grid levels, tab, comment.
+*   Sobol designs can vary up to 21 parameters, and Saltelli designs up to 10 (see SobolSequence).
+*
+* See data/ExampleSweep.txt.
+*/
+
+class ParameterSweepDesign
+{
+private:
+
+    //Header values, see above
+    std::string mSweepName;
+    std::string mBaseParameterFile;
+    std::string mExecutable;
+    std::string mDesignType;
+    unsigned mNumberOfPoints;
+    unsigned mNumberOfReplicates;
+    unsigned mSeed;
+    unsigned mMaxConcurrentJobs;
+    double mForkTime;
+    std::string mForkExecutable;
+
+    //One entry per varied parameter
+    std::vector<int> mParameterIndices;
+    std::vector<double> mMinimumValues;
+    std::vector<double> mMaximumValues;
+    std::vector<unsigned> mGridLevels;
+    std::vector<std::string> mParameterNames;
+
+    //Generators for each design type. Each returns points in parameter space.
+    std::vector< std::vector<double> > GenerateGridPoints() const;
+    std::vector< std::vector<double> > GenerateLatinHypercubePoints() const;
+    std::vector< std::vector<double> > GenerateSobolPoints() const;
+    std::vector< std::vector<double> > GenerateSaltelliPoints() const;
+
+    //Maps a point in the unit hypercube onto the parameter ranges
+    std::vector<double> ScaleToRanges(const std::vector<double>& rUnitPoint) const;
+
+public:
+
+    /*
+    * Constructor. Leaves the design empty until ConfigureFromFile is called.
+    */
+    ParameterSweepDesign();
+
+
+    /*
+    * Read the design from a sweep file.
+    *
+    * @param filename name of the sweep file
+    * @param directory location of the sweep file
+    */
+    void ConfigureFromFile(std::string filename, std::string directory);
+
+
+    /**
+    * @return the list of design points. Each point holds one value per varied parameter, in the
+    * order of GetParameterIndices(). Replicates are not expanded here.
+    */
+    std::vector< std::vector<double> > GenerateDesignPoints() const;
+
+
+    //Getters
+    std::string GetSweepName() const;
+    std::string GetBaseParameterFile() const;
+    std::string GetExecutable() const;
+    std::string GetDesignType() const;
+    unsigned GetNumberOfPoints() const;
+    unsigned GetNumberOfReplicates() const;
+    unsigned GetSeed() const;
+    unsigned GetMaxConcurrentJobs() const;
+    double GetForkTime() const;
+    std::string GetForkExecutable() const;
+    const std::vector<int>& rGetParameterIndices() const;
+    const std::vector<std::string>& rGetParameterNames() const;
+    const std::vector<double>& rGetMinimumValues() const;
+    const std::vector<double>& rGetMaximumValues() const;
+
+};
+
+#endif /*PARAMETERSWEEPDESIGN_HPP_*/
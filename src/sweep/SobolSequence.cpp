@@ -0,0 +1,201 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SobolSequence.hpp"
+#include "Exception.hpp"
+
+
+//Initial direction numbers m_1..m_s for dimensions 2 to 21, from Joe & Kuo (2008). Dimension 1 is
+//the van der Corput sequence and needs no table entry.
+static const unsigned numTabulatedDimensions = 20;
+static const unsigned tabulatedInitialNumbers[numTabulatedDimensions][7] = {
+    {1},
+    {1, 3},
+    {1, 3, 1},
+    {1, 1, 1},
+    {1, 1, 3, 3},
+    {1, 3, 5, 13},
+    {1, 1, 5, 5, 17},
+    {1, 1, 5, 5, 5},
+    {1, 1, 7, 11, 19},
+    {1, 1, 5, 1, 1},
+    {1, 1, 1, 3, 11},
+    {1, 3, 5, 5, 31},
+    {1, 3, 3, 9, 7, 49},
+    {1, 1, 1, 15, 21, 21},
+    {1, 3, 1, 13, 27, 49},
+    {1, 1, 1, 15, 7, 5},
+    {1, 3, 1, 15, 13, 25},
+    {1, 1, 5, 5, 19, 61},
+    {1, 3, 7, 11, 23, 15, 103},
+    {1, 3, 7, 13, 13, 15, 69}
+};
+
+
+//Tests whether a polynomial over GF(2) is primitive by checking that x has multiplicative order
+//2^degree - 1 modulo the polynomial. Degrees used here are small, so brute force is fine.
+bool SobolSequence::IsPrimitivePolynomial(unsigned degree, unsigned a)
+{
+    unsigned polynomial = (1u << degree) | (a << 1) | 1u;
+    unsigned period = (1u << degree) - 1;
+    unsigned x = 1;
+    for (unsigned k = 1; k <= period; k++){
+        x <<= 1;
+        if ((x >> degree) & 1u){
+            x ^= polynomial;
+        }
+        if (x == 1){
+            return (k == period);
+        }
+    }
+    return false;
+}
+
+
+//Constructor. Works out the direction numbers for every dimension.
+SobolSequence::SobolSequence(unsigned dimension)
+    : mDimension(dimension),
+      mCurrentPoint(dimension, 0),
+      mIndex(0)
+{
+    if (dimension == 0){
+        EXCEPTION("A Sobol sequence must have at least one dimension.");
+    }
+    if (dimension > GetMaxDimension()){
+        EXCEPTION("Sobol sequences are only available in up to " << GetMaxDimension() << " dimensions, not " << dimension << ".");
+    }
+
+    mDirectionNumbers.resize(dimension, std::vector<boost::uint32_t>(mNumBits, 0));
+
+    //First dimension: V_k = 2^(32-k)
+    for (unsigned k = 0; k < mNumBits; k++){
+        mDirectionNumbers[0][k] = (boost::uint32_t)1 << (mNumBits - 1 - k);
+    }
+
+    //Remaining dimensions, each using the next primitive polynomial in order of degree
+    unsigned degree = 1;
+    unsigned a = 0;
+    for (unsigned d = 1; d < dimension; d++){
+
+        //Find the next primitive polynomial
+        while (!IsPrimitivePolynomial(degree, a)){
+            a++;
+            if (a >= (1u << (degree - 1))){
+                degree++;
+                a = 0;
+            }
+        }
+
+        //Initial direction numbers m_1..m_degree
+        std::vector<boost::uint32_t> m(degree);
+        for (unsigned k = 0; k < degree; k++){
+            m[k] = tabulatedInitialNumbers[d - 1][k];
+        }
+
+        std::vector<boost::uint32_t>& V = mDirectionNumbers[d];
+        for (unsigned k = 0; k < mNumBits; k++){
+            if (k < degree){
+                V[k] = m[k] << (mNumBits - 1 - k);
+            }else{
+                V[k] = V[k - degree] ^ (V[k - degree] >> degree);
+                for (unsigned i = 1; i < degree; i++){
+                    if ((a >> (degree - 1 - i)) & 1u){
+                        V[k] ^= V[k - i];
+                    }
+                }
+            }
+        }
+
+        //Move on to the next polynomial for the next dimension
+        a++;
+        if (a >= (1u << (degree - 1))){
+            degree++;
+            a = 0;
+        }
+    }
+}
+
+
+//Returns the next point, using the Gray code update X_n = X_(n-1) ^ V_c, where c is the position
+//of the lowest zero bit of n-1.
+std::vector<double> SobolSequence::GetNextPoint()
+{
+    std::vector<double> point(mDimension);
+
+    if (mIndex > 0){
+        unsigned c = 0;
+        boost::uint32_t value = mIndex - 1;
+        while (value & 1u){
+            value >>= 1;
+            c++;
+        }
+        if (c >= mNumBits){
+            EXCEPTION("Sobol sequence exhausted.");
+        }
+        for (unsigned d = 0; d < mDimension; d++){
+            mCurrentPoint[d] ^= mDirectionNumbers[d][c];
+        }
+    }
+
+    for (unsigned d = 0; d < mDimension; d++){
+        point[d] = (double)mCurrentPoint[d] / 4294967296.0;
+    }
+    mIndex++;
+    return point;
+}
+
+
+//Discard some points
+void SobolSequence::Skip(unsigned numPoints)
+{
+    for (unsigned i = 0; i < numPoints; i++){
+        GetNextPoint();
+    }
+}
+
+
+//Getters
+unsigned SobolSequence::GetDimension() const
+{
+    return mDimension;
+}
+unsigned SobolSequence::GetIndex() const
+{
+    return mIndex;
+}
+unsigned SobolSequence::GetMaxDimension()
+{
+    return numTabulatedDimensions + 1;
+}
@@ -0,0 +1,110 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SOBOLSEQUENCE_HPP_
+#define SOBOLSEQUENCE_HPP_
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+/*
+* Generates points of a Sobol low discrepancy sequence in the unit hypercube [0,1)^dimension, for use
+* in quasi-random parameter sweep designs. Points are produced in Gray code order (Antonov & Saleev),
+* so each new point costs one XOR per dimension.
+*
+* Primitive polynomials are generated in order of increasing degree. Initial direction numbers are those of
+* Joe & Kuo (2008, file new-joe-kuo-6.21201), which are tabulated here for the first 21 dimensions only; more
+* dimensions than that are an Exception. That is enough for a Sobol design of up to 21 parameters, or a
+* Saltelli design (see ParameterSweepDesign) of up to 10.
+*/
+
+class SobolSequence
+{
+private:
+
+    //Number of bits used for each coordinate
+    static const unsigned mNumBits = 32;
+
+    //Dimension of the points generated
+    unsigned mDimension;
+
+    //Direction numbers, scaled by 2^32: mDirectionNumbers[d][k] is V_(k+1) for dimension d
+    std::vector< std::vector<boost::uint32_t> > mDirectionNumbers;
+
+    //Integer representation of the most recently generated point
+    std::vector<boost::uint32_t> mCurrentPoint;
+
+    //Index of the next point to be generated
+    boost::uint32_t mIndex;
+
+    //Returns true if x^degree + (interior coefficients a) + 1 is primitive over GF(2)
+    static bool IsPrimitivePolynomial(unsigned degree, unsigned a);
+
+public:
+
+    /**
+    * Constructor. Sets up direction numbers for the requested dimension, at most GetMaxDimension().
+    *
+    * @param dimension number of coordinates in each point
+    */
+    SobolSequence(unsigned dimension);
+
+
+    /**
+    * @return the next point in the sequence. The first call returns the origin.
+    */
+    std::vector<double> GetNextPoint();
+
+
+    /**
+    * Advance the sequence without returning points. Commonly used to discard the origin.
+    *
+    * @param numPoints number of points to skip
+    */
+    void Skip(unsigned numPoints);
+
+
+    //Getters
+    unsigned GetDimension() const;
+    unsigned GetIndex() const;
+
+    /**
+    * @return the largest dimension there are direction numbers for
+    */
+    static unsigned GetMaxDimension();
+
+};
+
+#endif /*SOBOLSEQUENCE_HPP_*/
@@ -0,0 +1,490 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SweepJobManifest.hpp"
+#include "ParameterSweepDesign.hpp"
+#include "OutputFileHandler.hpp"
+#include "Exception.hpp"
+#include "EnsembleStatistics.hpp"
+#include "GonadArmDataOutput.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <algorithm>
+
+
+//Constructor
+SweepJobManifest::SweepJobManifest(std::string sweepName)
+    : mSweepName(sweepName)
+{}
+
+
+//Expands a design into jobs: every design point is run mNumberOfReplicates times. Warm started
+//designs get one larval run per replicate first, which the design point jobs fork from.
+void SweepJobManifest::BuildFromDesign(const ParameterSweepDesign& rDesign)
+{
+    mParameterIndices = rDesign.rGetParameterIndices();
+    mParameterNames = rDesign.rGetParameterNames();
+    mJobs.clear();
+
+    std::vector< std::vector<double> > points = rDesign.GenerateDesignPoints();
+    bool warmStart = rDesign.GetForkTime() > 0.0;
+    unsigned numJobs = points.size()*rDesign.GetNumberOfReplicates();
+
+    //Zero-pad directory names so they sort in job order
+    unsigned width = 4;
+    unsigned limit = 10000;
+    while (numJobs >= limit){
+        width++;
+        limit *= 10;
+    }
+
+    if (warmStart){
+        for (unsigned rep = 0; rep < rDesign.GetNumberOfReplicates(); rep++){
+            SweepJob job;
+            job.Id = mJobs.size();
+            job.Kind = LARVAL_RUN;
+            job.DependsOn = -1;
+            job.DesignPoint = -1;
+            job.Replicate = rep;
+            job.Status = PENDING;
+            std::stringstream directory;
+            directory << mSweepName << "/Larval" << std::setw(width) << std::setfill('0') << rep;
+            job.Directory = directory.str();
+            mJobs.push_back(job);
+        }
+    }
+
+    unsigned firstJobId = mJobs.size();
+    for (unsigned point = 0; point < points.size(); point++){
+        for (unsigned rep = 0; rep < rDesign.GetNumberOfReplicates(); rep++){
+            SweepJob job;
+            job.Id = mJobs.size();
+            job.Kind = warmStart ? FORKED_RUN : FULL_RUN;
+            job.DependsOn = warmStart ? (int)rep : -1;
+            job.DesignPoint = point;
+            job.Replicate = rep;
+            job.Status = PENDING;
+            job.ParameterValues = points[point];
+            std::stringstream directory;
+            directory << mSweepName << "/Job" << std::setw(width) << std::setfill('0') << job.Id - firstJobId;
+            job.Directory = directory.str();
+            mJobs.push_back(job);
+        }
+    }
+}
+
+
+//New points continue the numbering of design points and of job directories. The directory width is taken
+//from the existing jobs, so the directories still sort in job order.
+void SweepJobManifest::AddDesignPoints(const std::vector< std::vector<double> >& rPoints, unsigned numReplicates)
+{
+    int nextPoint = 0;
+    unsigned numDesignJobs = 0;
+    unsigned width = 4;
+    std::map<unsigned, int> larvalJobs;
+    bool forked = false;
+    for (unsigned i = 0; i < mJobs.size(); i++){
+        if (mJobs[i].Kind == LARVAL_RUN){
+            larvalJobs[mJobs[i].Replicate] = (int)i;
+            continue;
+        }
+        forked = forked || mJobs[i].Kind == FORKED_RUN;
+        nextPoint = std::max(nextPoint, mJobs[i].DesignPoint + 1);
+        numDesignJobs++;
+        std::string::size_type digits = mJobs[i].Directory.rfind("/Job");
+        if (digits != std::string::npos){
+            width = mJobs[i].Directory.size() - digits - 4;
+        }
+    }
+
+    for (unsigned point = 0; point < rPoints.size(); point++){
+        if (rPoints[point].size() != mParameterIndices.size()){
+            EXCEPTION("Design point has " << rPoints[point].size() << " values, but the sweep varies "
+                      << mParameterIndices.size() << " parameters");
+        }
+        for (unsigned rep = 0; rep < numReplicates; rep++){
+            SweepJob job;
+            job.Id = mJobs.size();
+            job.Kind = FULL_RUN;
+            job.DependsOn = -1;
+            if (forked && larvalJobs.count(rep) > 0){
+                job.Kind = FORKED_RUN;
+                job.DependsOn = larvalJobs[rep];
+            }
+            job.DesignPoint = nextPoint + point;
+            job.Replicate = rep;
+            job.Status = PENDING;
+            job.ParameterValues = rPoints[point];
+            std::stringstream directory;
+            directory << mSweepName << "/Job" << std::setw(width) << std::setfill('0') << numDesignJobs;
+            job.Directory = directory.str();
+            mJobs.push_back(job);
+            numDesignJobs++;
+        }
+    }
+}
+
+
+//Reads SweepManifest.txt back in, if present
+bool SweepJobManifest::LoadFromFile()
+{
+    OutputFileHandler handler(mSweepName, false);
+    std::string filepath = handler.GetOutputDirectoryFullPath() + "SweepManifest.txt";
+    std::ifstream MANIFEST(filepath.c_str());
+    if (!MANIFEST.is_open()){
+        return false;
+    }
+
+    mParameterIndices.clear();
+    mParameterNames.clear();
+    mJobs.clear();
+
+    std::string line;
+    std::string label;
+
+    //Line 1: sweep name
+    std::getline(MANIFEST, line);
+
+    //Line 2: varied parameter indices
+    std::getline(MANIFEST, line);
+    std::stringstream indexStream(line);
+    indexStream >> label;
+    int index;
+    while (indexStream >> index){
+        mParameterIndices.push_back(index);
+    }
+
+    //Line 3: parameter descriptions
+    std::getline(MANIFEST, line);
+    std::stringstream nameStream(line);
+    std::string name;
+    std::getline(nameStream, label, '\t');
+    while (std::getline(nameStream, name, '\t')){
+        mParameterNames.push_back(name);
+    }
+
+    //Line 4: column headings
+    std::getline(MANIFEST, line);
+
+    //Remaining lines: one per job
+    while (std::getline(MANIFEST, line)){
+        if (line.empty()){
+            continue;
+        }
+        std::stringstream jobStream(line);
+        SweepJob job;
+        std::string kind;
+        std::string status;
+        jobStream >> job.Id >> kind >> job.DependsOn >> job.DesignPoint >> job.Replicate >> status >> job.Directory;
+        job.Kind = StringToKind(kind);
+        job.Status = StringToStatus(status);
+        if (job.Kind != LARVAL_RUN){
+            job.ParameterValues.resize(mParameterIndices.size());
+            for (unsigned p = 0; p < mParameterIndices.size(); p++){
+                jobStream >> job.ParameterValues[p];
+            }
+        }
+        if (jobStream.fail() || job.Id != mJobs.size()){
+            EXCEPTION("Sweep manifest " << filepath << " is corrupt at job " << mJobs.size());
+        }
+
+        //Anything that was running when the sweep stopped, or that failed, gets another go
+        if (job.Status == RUNNING || job.Status == FAILED){
+            job.Status = PENDING;
+        }
+        mJobs.push_back(job);
+    }
+    MANIFEST.close();
+    return true;
+}
+
+
+//Writes the manifest to a temporary file then renames it over the old one, so a crash mid-write
+//never leaves a truncated manifest behind.
+void SweepJobManifest::Save() const
+{
+    OutputFileHandler handler(mSweepName, false);
+    std::string filepath = handler.GetOutputDirectoryFullPath() + "SweepManifest.txt";
+    std::string temporaryFilepath = filepath + ".tmp";
+
+    std::ofstream MANIFEST(temporaryFilepath.c_str());
+    if (!MANIFEST.is_open()){
+        EXCEPTION("Failed to write sweep manifest " << temporaryFilepath);
+    }
+    MANIFEST << std::setprecision(12);
+
+    MANIFEST << "SweepName\t" << mSweepName << "\n";
+    MANIFEST << "ParameterIndices";
+    for (unsigned p = 0; p < mParameterIndices.size(); p++){
+        MANIFEST << "\t" << mParameterIndices[p];
+    }
+    MANIFEST << "\nParameterNames";
+    for (unsigned p = 0; p < mParameterNames.size(); p++){
+        MANIFEST << "\t" << mParameterNames[p];
+    }
+    MANIFEST << "\nJob\tKind\tDependsOn\tDesignPoint\tReplicate\tStatus\tDirectory";
+    for (unsigned p = 0; p < mParameterIndices.size(); p++){
+        MANIFEST << "\tP" << mParameterIndices[p];
+    }
+    MANIFEST << "\n";
+
+    for (unsigned i = 0; i < mJobs.size(); i++){
+        const SweepJob& job = mJobs[i];
+        MANIFEST << job.Id << "\t" << KindToString(job.Kind) << "\t" << job.DependsOn << "\t" << job.DesignPoint << "\t"
+                 << job.Replicate << "\t" << StatusToString(job.Status) << "\t" << job.Directory;
+        for (unsigned p = 0; p < job.ParameterValues.size(); p++){
+            MANIFEST << "\t" << job.ParameterValues[p];
+        }
+        MANIFEST << "\n";
+    }
+    MANIFEST.close();
+
+    if (std::rename(temporaryFilepath.c_str(), filepath.c_str()) != 0){
+        EXCEPTION("Failed to replace sweep manifest " << filepath);
+    }
+}
+
+
+//Writes the R-readable index of output directories and parameter values
+void SweepJobManifest::WriteIndex() const
+{
+    OutputFileHandler handler(mSweepName, false);
+    std::string outputRoot = OutputFileHandler::GetChasteTestOutputDirectory();
+    out_stream INDEX = handler.OpenOutputFile("SweepIndex.txt");
+    *INDEX << std::setprecision(12);
+
+    *INDEX << "Job\tKind\tDesignPoint\tReplicate\tStatus\tDirectory";
+    for (unsigned p = 0; p < mParameterIndices.size(); p++){
+        *INDEX << "\tP" << mParameterIndices[p];
+    }
+    *INDEX << "\n";
+
+    for (unsigned i = 0; i < mJobs.size(); i++){
+        const SweepJob& job = mJobs[i];
+        *INDEX << job.Id << "\t" << KindToString(job.Kind) << "\t" << job.DesignPoint << "\t" << job.Replicate << "\t"
+               << StatusToString(job.Status) << "\t" << outputRoot << job.Directory;
+        for (unsigned p = 0; p < mParameterIndices.size(); p++){
+            if (job.ParameterValues.empty()){
+                *INDEX << "\tNA";   // <- larval runs use the base parameters
+            }else{
+                *INDEX << "\t" << job.ParameterValues[p];
+            }
+        }
+        *INDEX << "\n";
+    }
+    INDEX->close();
+}
+
+
+//Summarises the GonadData of each design point's completed replicates, one design point after another
+void SweepJobManifest::WriteSummary() const
+{
+    std::map<int, std::vector<unsigned> > jobsByPoint;
+    for (unsigned i = 0; i < mJobs.size(); i++){
+        if (mJobs[i].DesignPoint >= 0 && mJobs[i].Status == COMPLETE){
+            jobsByPoint[mJobs[i].DesignPoint].push_back(i);
+        }
+    }
+
+    OutputFileHandler handler(mSweepName, false);
+    out_stream SUMMARY = handler.OpenOutputFile("SweepSummary.txt");
+    *SUMMARY << std::setprecision(12);
+    std::vector<std::string> columnNames = GonadArmDataOutput<3>::GetColumnNames();
+    *SUMMARY << "DesignPoint\t";
+    EnsembleStatistics(columnNames).WriteHeader(*SUMMARY);
+
+    for (std::map<int, std::vector<unsigned> >::const_iterator point = jobsByPoint.begin(); point != jobsByPoint.end(); ++point){
+        EnsembleStatistics ensemble(columnNames);
+        for (unsigned j = 0; j < point->second.size(); j++){
+            ensemble.AddRun(mJobs[point->second[j]].Directory, "GonadData");
+        }
+        std::stringstream prefix;
+        prefix << point->first << "\t";
+        ensemble.WriteRows(*SUMMARY, prefix.str());
+    }
+    SUMMARY->close();
+}
+
+
+//Returns the first job still waiting to run whose dependency has completed
+int SweepJobManifest::GetNextPendingJob(bool larvalOnly) const
+{
+    for (unsigned i = 0; i < mJobs.size(); i++){
+        if (mJobs[i].Status != PENDING || (larvalOnly && mJobs[i].Kind != LARVAL_RUN)){
+            continue;
+        }
+        if (mJobs[i].DependsOn < 0 || mJobs[mJobs[i].DependsOn].Status == COMPLETE){
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+
+//Collects the varied parameters that any completed larval run read before it stopped
+std::vector<int> SweepJobManifest::FindParametersUsedBeforeFork() const
+{
+    std::vector<bool> used(mParameterIndices.size(), false);
+    for (unsigned i = 0; i < mJobs.size(); i++){
+        if (mJobs[i].Kind != LARVAL_RUN || mJobs[i].Status != COMPLETE){
+            continue;
+        }
+        OutputFileHandler handler(mJobs[i].Directory, false);
+        std::string filepath = handler.GetOutputDirectoryFullPath() + "ParameterFirstReads.txt";
+        std::ifstream READS(filepath.c_str());
+        if (!READS.is_open()){
+            EXCEPTION("Larval run " << mJobs[i].Directory << " did not record its parameter use in " << filepath);
+        }
+        int index;
+        double firstRead;
+        while (READS >> index >> firstRead){
+            for (unsigned p = 0; p < mParameterIndices.size(); p++){
+                if (mParameterIndices[p] == index && firstRead >= 0){
+                    used[p] = true;
+                }
+            }
+        }
+        READS.close();
+    }
+
+    std::vector<int> usedIndices;
+    for (unsigned p = 0; p < mParameterIndices.size(); p++){
+        if (used[p]){
+            usedIndices.push_back(mParameterIndices[p]);
+        }
+    }
+    return usedIndices;
+}
+
+
+//Forked jobs become independent runs from scratch
+void SweepJobManifest::ConvertForkedJobsToFullRuns()
+{
+    for (unsigned i = 0; i < mJobs.size(); i++){
+        if (mJobs[i].Kind == FORKED_RUN){
+            mJobs[i].Kind = FULL_RUN;
+            mJobs[i].DependsOn = -1;
+        }
+    }
+    Save();
+}
+
+
+//Updates a job and records the change straight away
+void SweepJobManifest::SetJobStatus(unsigned jobId, SweepJobStatus status)
+{
+    mJobs.at(jobId).Status = status;
+    Save();
+}
+
+
+//Getters
+std::string SweepJobManifest::GetSweepName() const
+{
+    return mSweepName;
+}
+unsigned SweepJobManifest::GetNumJobs() const
+{
+    return mJobs.size();
+}
+unsigned SweepJobManifest::GetNumJobsWithStatus(SweepJobStatus status) const
+{
+    unsigned count = 0;
+    for (unsigned i = 0; i < mJobs.size(); i++){
+        if (mJobs[i].Status == status){
+            count++;
+        }
+    }
+    return count;
+}
+const SweepJob& SweepJobManifest::rGetJob(unsigned jobId) const
+{
+    return mJobs.at(jobId);
+}
+const std::vector<int>& SweepJobManifest::rGetParameterIndices() const
+{
+    return mParameterIndices;
+}
+
+
+//Status conversions
+std::string SweepJobManifest::StatusToString(SweepJobStatus status)
+{
+    switch (status){
+        case PENDING:  return "Pending";
+        case RUNNING:  return "Running";
+        case COMPLETE: return "Complete";
+        default:       return "Failed";
+    }
+}
+SweepJobStatus SweepJobManifest::StringToStatus(std::string status)
+{
+    if (status == "Pending"){
+        return PENDING;
+    }else if (status == "Running"){
+        return RUNNING;
+    }else if (status == "Complete"){
+        return COMPLETE;
+    }else if (status == "Failed"){
+        return FAILED;
+    }
+    EXCEPTION("Unknown sweep job status " << status);
+    NEVER_REACHED;
+}
+std::string SweepJobManifest::KindToString(SweepJobKind kind)
+{
+    switch (kind){
+        case FULL_RUN:   return "Full";
+        case LARVAL_RUN: return "Larval";
+        default:         return "Forked";
+    }
+}
+SweepJobKind SweepJobManifest::StringToKind(std::string kind)
+{
+    if (kind == "Full"){
+        return FULL_RUN;
+    }else if (kind == "Larval"){
+        return LARVAL_RUN;
+    }else if (kind == "Forked"){
+        return FORKED_RUN;
+    }
+    EXCEPTION("Unknown sweep job kind " << kind);
+    NEVER_REACHED;
+}
@@ -0,0 +1,218 @@
+/*
+
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SWEEPJOBMANIFEST_HPP_
+#define SWEEPJOBMANIFEST_HPP_
+
+#include <string>
+#include <vector>
+
+class ParameterSweepDesign;
+
+/*
+* Status of a single job in a sweep. Stored in the manifest as text so it can be read and edited by hand.
+*/
+enum SweepJobStatus
+{
+    PENDING,
+    RUNNING,
+    COMPLETE,
+    FAILED
+};
+
+
+/*
+* What a job runs. FULL_RUN jobs simulate a design point from scratch. In a warm started sweep, each
+* replicate has one LARVAL_RUN job that simulates up to the fork time with the base parameters, and
+* FORKED_RUN jobs continue from its saved state with a design point's parameters.
+*/
+enum SweepJobKind
+{
+    FULL_RUN,
+    LARVAL_RUN,
+    FORKED_RUN
+};
+
+
+/*
+* One simulation in a sweep: a design point, a replicate number and the output directory it writes to.
+*/
+struct SweepJob
+{
+    unsigned Id;
+    SweepJobKind Kind;
+    int DependsOn;                         //Job that must complete first (the larval run), or -1
+    int DesignPoint;                       //-1 for larval runs, which use the base parameters
+    unsigned Replicate;
+    SweepJobStatus Status;
+    std::string Directory;                 //Output directory, relative to CHASTE_TEST_OUTPUT
+    std::vector<double> ParameterValues;   //One value per varied parameter, empty for larval runs
+};
+
+
+/*
+* The list of jobs making up a parameter sweep, together with their status.
+*
+* The manifest is kept in SweepManifest.txt in the sweep's output directory and is rewritten (atomically,
+* via a temporary file and a rename) every time a job changes status. If a sweep is interrupted, reloading
+* the manifest returns any job that was running, or that failed, to the pending state, so relaunching the
+* sweep only runs the jobs that have not yet completed.
+*
+* WriteIndex() produces SweepIndex.txt, a tab delimited table with a header row that maps every job's output
+* directory to its parameter vector. It is intended to be read directly by R (read.table(..., header=TRUE)).
+* WriteSummary() produces SweepSummary.txt, the replicate statistics of each design point, in the same way.
+*/
+
+class SweepJobManifest
+{
+private:
+
+    //Sweep name, also the output directory for the manifest and index
+    std::string mSweepName;
+
+    //Indices (into the parameter file) and descriptions of the varied parameters
+    std::vector<int> mParameterIndices;
+    std::vector<std::string> mParameterNames;
+
+    //The jobs themselves, indexed by job ID
+    std::vector<SweepJob> mJobs;
+
+public:
+
+    /**
+    * Constructor.
+    *
+    * @param sweepName name of the sweep, and of the output directory the manifest lives in
+    */
+    SweepJobManifest(std::string sweepName);
+
+
+    /**
+    * Creates one pending job per design point and replicate. If the design has a fork time, also
+    * creates one larval run per replicate, and makes the design point jobs forks of those.
+    *
+    * @param rDesign the sweep design to expand
+    */
+    void BuildFromDesign(const ParameterSweepDesign& rDesign);
+
+
+    /**
+    * Appends pending jobs for extra design points (e.g. those chosen by a SweepEmulator), numbered on from the
+    * existing ones, so that resuming the sweep runs them. Each point gets the given number of replicates. If
+    * the sweep forks, they fork from the larval run of the same replicate.
+    *
+    * @param rPoints the new design points, each holding one value per varied parameter
+    * @param numReplicates number of replicates of each point
+    */
+    void AddDesignPoints(const std::vector< std::vector<double> >& rPoints, unsigned numReplicates);
+
+
+    /**
+    * Loads a previously saved manifest, if there is one. Jobs left running or failed are reset to pending.
+    *
+    * @return whether a manifest was found
+    */
+    bool LoadFromFile();
+
+
+    /**
+    * Writes the manifest to file, replacing any previous version atomically.
+    */
+    void Save() const;
+
+
+    /**
+    * Writes SweepIndex.txt, the consolidated map from output directories to parameter vectors.
+    */
+    void WriteIndex() const;
+
+
+    /**
+    * Writes SweepSummary.txt: for each design point and sampling time, the mean, standard deviation and
+    * quantiles of every GonadData column over the point's completed replicates (see EnsembleStatistics),
+    * with the design point number in the first column. Warm started runs only have data from the fork on.
+    */
+    void WriteSummary() const;
+
+
+    /**
+    * @return the ID of the first pending job that is ready to run (i.e. whose dependency, if any, has
+    * completed), or -1 if there are none.
+    *
+    * @param larvalOnly whether to consider larval runs only
+    */
+    int GetNextPendingJob(bool larvalOnly = false) const;
+
+
+    /**
+    * Checks the ParameterFirstReads.txt files written by the completed larval runs.
+    *
+    * @return the varied parameters that any larval run used, and so which cannot be varied by forking
+    */
+    std::vector<int> FindParametersUsedBeforeFork() const;
+
+
+    /**
+    * Turns every forked job into a run from scratch, for when warm starting turns out to be invalid.
+    * Saves the manifest.
+    */
+    void ConvertForkedJobsToFullRuns();
+
+
+    /**
+    * Changes a job's status and saves the manifest.
+    *
+    * @param jobId the job to update
+    * @param status the new status
+    */
+    void SetJobStatus(unsigned jobId, SweepJobStatus status);
+
+
+    //Getters
+    std::string GetSweepName() const;
+    unsigned GetNumJobs() const;
+    unsigned GetNumJobsWithStatus(SweepJobStatus status) const;
+    const SweepJob& rGetJob(unsigned jobId) const;
+    const std::vector<int>& rGetParameterIndices() const;
+
+    //Conversion between job status or kind and its text representation in the manifest
+    static std::string StatusToString(SweepJobStatus status);
+    static SweepJobStatus StringToStatus(std::string status);
+    static std::string KindToString(SweepJobKind kind);
+    static SweepJobKind StringToKind(std::string kind);
+
+};
+
+#endif /*SWEEPJOBMANIFEST_HPP_*/
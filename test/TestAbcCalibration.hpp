@@ -0,0 +1,99 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTABCCALIBRATION_HPP_
+#define TESTABCCALIBRATION_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "CommandLineArguments.hpp"
+#include <string>
+#include <iostream>
+
+//Elegans specific headers
+#include "AbcSmcCalibration.hpp"        // ABC-SMC fitting of parameters to observed GonadData
+
+
+/*
+* Fits parameters of the germ line model to observed GonadData by ABC-SMC, as described by a calibration
+* file in the data directory (see AbcSmcCalibration). Run as ./TestAbcCalibrationRunner "ExampleCalibration.txt"
+*
+* Every simulation runs in this process, and is stopped as soon as its distance from the observations exceeds
+* the current generation's tolerance. Each generation's particles, with their weights, distances and output
+* directories, are written to AbcGeneration<number>.txt in the calibration's output directory; the last is the
+* sample from the posterior. Running the same calibration again resumes it after its last finished generation.
+*/
+
+class TestAbcCalibration : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestRunCalibration() throw(Exception){
+
+        //1) Read in the calibration file specified in the first command line argument
+
+        if (*(CommandLineArguments::Instance()->p_argc) < 2){
+            EXCEPTION("Usage: TestAbcCalibrationRunner <calibration file>");
+        }
+        std::string calibrationFile = (*(CommandLineArguments::Instance()->p_argv))[1];
+        std::cout << std::endl << "Selected calibration file: " << calibrationFile << std::endl;
+        std::string myParameterFilesDirectory = "./projects/ElegansGermline/data/";
+
+        AbcSmcCalibration calibration;
+        calibration.ConfigureFromFile(calibrationFile, myParameterFilesDirectory);
+
+        //----------------------------------------------------------------------------
+
+
+
+        //2) Run the generations not yet finished, then report the last---------------
+
+        calibration.Run();
+
+        unsigned numFinished = calibration.GetNumGenerationsFinished();
+        if (numFinished == 0){
+            EXCEPTION("The calibration did not finish a generation.");
+        }
+        const AbcSmcCalibration::Generation& rLast = calibration.rGetGeneration(numFinished-1);
+        std::cout << "Finished " << numFinished << " generations; the last, with tolerance " << rLast.Tolerance
+                  << ", is in " << calibration.GetName() << "/AbcGeneration" << numFinished-1 << ".txt" << std::endl;
+
+        //----------------------------------------------------------------------------
+    }
+};
+
+#endif /* TESTABCCALIBRATION_HPP_ */
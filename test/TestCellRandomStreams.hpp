@@ -0,0 +1,134 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTCELLRANDOMSTREAMS_HPP_
+#define TESTCELLRANDOMSTREAMS_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "SmartPointers.hpp"
+#include "CellData.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "FixedDurationGenerationBasedCellCycleModel.hpp"
+
+//Elegans specific headers
+#include "CellRandomStreams.hpp"                    // the cells' random number streams
+
+
+/*
+* Checks the cells' random number streams (see CellRandomStreams): the Philox4x32-10 block function against the
+* known answers published with Random123 (kat_vectors), and that a cell's numbers follow its stream key, which
+* division moves along the lineage, rather than its ID.
+*/
+
+class TestCellRandomStreams : public AbstractCellBasedTestSuite
+{
+private:
+
+    //A cell with the given random stream key and draw count
+    CellPtr MakeCell(double streamKey, double draws)
+    {
+        MAKE_PTR(CellData, p_cell_data);
+        p_cell_data->SetItem("RandomStream", streamKey);
+        p_cell_data->SetItem("RandomDraws", draws);
+        CellPropertyCollection properties;
+        properties.AddProperty(p_cell_data);
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        return CellPtr(new Cell(p_state, new FixedDurationGenerationBasedCellCycleModel(), false, properties));
+    }
+
+public:
+
+    void TestPhiloxKnownAnswers() throw(Exception){
+        const boost::uint32_t counters[3][4] = {{0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u},
+                                                {0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu},
+                                                {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}};
+        const boost::uint32_t keys[3][2] = {{0x00000000u, 0x00000000u},
+                                            {0xffffffffu, 0xffffffffu},
+                                            {0xa4093822u, 0x299f31d0u}};
+        const boost::uint32_t answers[3][4] = {{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u},
+                                               {0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu},
+                                               {0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}};
+        for (unsigned t = 0; t < 3; t++){
+            boost::uint32_t output[4];
+            CellRandomStreams::Philox(counters[t], keys[t], output);
+            for (unsigned i = 0; i < 4; i++){
+                TS_ASSERT_EQUALS(output[i], answers[t][i]);
+            }
+        }
+    }
+
+    void TestStreamsFollowLineage() throw(Exception){
+        CellRandomStreams* p_streams = CellRandomStreams::Instance();
+        p_streams->SetSeed(12345);
+
+        //Keys are 48 bits, so fit exactly in cell data, and the two sides of a division differ
+        boost::uint64_t parentKey = CellRandomStreams::Lineage(7, 0);
+        boost::uint64_t daughterKey = CellRandomStreams::Lineage(parentKey, 1);
+        TS_ASSERT_DIFFERS(parentKey, daughterKey);
+        TS_ASSERT_DIFFERS(parentKey, 7u);
+        TS_ASSERT_LESS_THAN(parentKey, (boost::uint64_t)1 << 48);
+        TS_ASSERT_LESS_THAN(daughterKey, (boost::uint64_t)1 << 48);
+        TS_ASSERT_EQUALS(CellRandomStreams::Lineage(7, 0), parentKey);
+
+        //Division moves each side onto its own key, with its draws counted from 0
+        CellPtr p_parent = MakeCell(7.0, 3.0);
+        p_streams->Divide(p_parent, 0);
+        TS_ASSERT_EQUALS(p_streams->GetStreamKey(p_parent), parentKey);
+        TS_ASSERT_DELTA(p_parent->GetCellData()->GetItem("RandomDraws"), 0.0, 1e-12);
+        CellPtr p_daughter = MakeCell((double)parentKey, 0.0);
+        p_streams->Divide(p_daughter, 1);
+        TS_ASSERT_EQUALS(p_streams->GetStreamKey(p_daughter), daughterKey);
+
+        //A cell that already has a stream keeps it
+        p_streams->InitialiseCell(p_daughter);
+        TS_ASSERT_EQUALS(p_streams->GetStreamKey(p_daughter), daughterKey);
+
+        //Cells with the same key and draw count draw the same numbers, whatever their IDs, and count their draws
+        CellPtr p_first = MakeCell((double)daughterKey, 0.0);
+        CellPtr p_second = MakeCell((double)daughterKey, 0.0);
+        TS_ASSERT_DIFFERS(p_first->GetCellId(), p_second->GetCellId());
+        double first = p_streams->NormalRandomDeviate(p_first, CellRandomStreams::G1_DURATION, 10.0, 2.0);
+        double second = p_streams->NormalRandomDeviate(p_second, CellRandomStreams::G1_DURATION, 10.0, 2.0);
+        TS_ASSERT_EQUALS(first, second);
+        TS_ASSERT_EQUALS(first, p_streams->NormalRandomDeviate(CellRandomStreams::G1_DURATION, daughterKey, 0, 10.0, 2.0));
+        TS_ASSERT_DELTA(p_first->GetCellData()->GetItem("RandomDraws"), 1.0, 1e-12);
+        TS_ASSERT_DIFFERS(p_streams->NormalRandomDeviate(p_first, CellRandomStreams::G1_DURATION, 10.0, 2.0), first);
+
+        CellRandomStreams::Destroy();
+    }
+};
+
+#endif /*TESTCELLRANDOMSTREAMS_HPP_*/
@@ -0,0 +1,203 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTCOMPAREVOLUMEESTIMATES_HPP_
+#define TESTCOMPAREVOLUMEESTIMATES_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "OutputFileHandler.hpp"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+
+//Elegans specific headers
+#include "GlobalParameterStruct.hpp"                // parameter storage
+#include "GermlineSnapshot.hpp"                     // saved state to compare volumes in
+#include "GermlineCheckpointModifier.hpp"           // finds the latest checkpoint
+#include "GermlineSimulation.hpp"                   // rebuilds the cell population
+#include "OverlapVolumeEstimator.hpp"               // the estimate being checked
+
+
+/*
+* Compares the cell volumes estimated from overlaps (OverlapVolumeEstimator, used for contact inhibition when
+* parameter 42 is non-zero) with Chaste's own cell volumes (as recorded by VolumeTrackingModifier), for the cells
+* of a finished or interrupted run. Run as:
+*
+* ./TestCompareVolumeEstimatesRunner "MyOutputDirectoryName"
+*
+* The run's final GermlineSnapshot.bin is used if there is one, and otherwise its latest checkpoint. Each cell's
+* two volumes are written to VolumeComparison.txt in the run's output directory (columns CellId, Radius,
+* CellCyclePhase, ChasteVolume and EstimatedVolume), and a summary is printed: the mean ratio of the two and
+* their correlation, and how often the two agree on whether a cell is compressed enough for contact inhibition
+* (parameter 29). Since the estimate is a different measure of compression, the summary also gives the value of
+* parameter 29 that would make the estimate find the same number of compressed cells as Chaste's volumes do.
+*/
+
+class TestCompareVolumeEstimates : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestCompareVolumes() throw(Exception){
+
+        //1) Find the state to compare volumes in-------------------------------------
+
+        char** argv = *(CommandLineArguments::Instance()->p_argv);
+        int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+        if (nArgs < 2){
+            EXCEPTION("Usage: TestCompareVolumeEstimatesRunner <output directory>");
+        }
+        std::string outputDirectory = argv[1];
+        OutputFileHandler handler(outputDirectory, false);
+        std::string snapshotFile = handler.GetOutputDirectoryFullPath() + "GermlineSnapshot.bin";
+        if (!GermlineSnapshot::IsValidFile(snapshotFile)){
+            std::string checkpoint = GermlineCheckpointModifier::FindLatestCheckpoint(outputDirectory);
+            if (checkpoint.empty()){
+                EXCEPTION("No snapshot or valid checkpoint found in " << outputDirectory);
+            }
+            snapshotFile = OutputFileHandler::GetChasteTestOutputDirectory() + checkpoint;
+        }
+        GermlineSnapshot snapshot;
+        snapshot.ReadFromFile(snapshotFile);
+        std::cout << "Comparing volumes in " << snapshotFile << " at time " << snapshot.GetTime() << std::endl;
+
+        GermlineSimulation germline;
+        germline.SetupFromSnapshot(snapshot);
+        NodeBasedCellPopulation<3>& population = germline.rGetCellPopulation();
+        population.Update();    // <- finds the neighbours both volumes depend on
+
+        //----------------------------------------------------------------------------
+
+
+
+        //2) Estimate volumes from the overlapping pairs, as RepulsionForceSizeCorrected does
+
+        OverlapVolumeEstimator estimator;
+        estimator.Reset(population.rGetMesh().GetMaximumNodeIndex() + 1);
+        std::vector< std::pair<Node<3>*, Node<3>* > >& r_node_pairs = population.rGetNodePairs();
+        for (unsigned i = 0; i < r_node_pairs.size(); i++){
+            Node<3>* p_node_a = r_node_pairs[i].first;
+            Node<3>* p_node_b = r_node_pairs[i].second;
+            double separation = norm_2(population.rGetMesh().GetVectorFromAtoB(p_node_a->rGetLocation(), p_node_b->rGetLocation()));
+            if (separation < p_node_a->GetRadius() + p_node_b->GetRadius()){
+                estimator.AddOverlap(p_node_a->GetIndex(), p_node_a->GetRadius(), p_node_b->GetIndex(), p_node_b->GetRadius(), separation);
+            }
+        }
+
+        //----------------------------------------------------------------------------
+
+
+
+        //3) Compare them with Chaste's volumes, cell by cell-------------------------
+
+        double threshold = GlobalParameterStruct::Instance()->PeekParameter(29);
+        out_stream comparisonFile = handler.OpenOutputFile("VolumeComparison.txt");
+        *comparisonFile << "CellId\tRadius\tCellCyclePhase\tChasteVolume\tEstimatedVolume\n";
+
+        unsigned numCells = 0, numChasteCompressed = 0, numEstimateCompressed = 0, numAgree = 0;
+        double sumRatio = 0.0, sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumYY = 0.0, sumXY = 0.0;
+        std::vector<double> estimatedProportions;
+        for (AbstractCellPopulation<3>::Iterator cell_iter = population.Begin(); cell_iter != population.End(); ++cell_iter)
+        {
+            if (cell_iter->GetCellData()->GetItem("IsDTC") > 0.0){
+                continue;
+            }
+            Node<3>* p_node = population.GetNode(population.GetLocationIndexUsingCell(*cell_iter));
+            double radius = p_node->GetRadius();
+            double relaxedVolume = 4.18879*radius*radius*radius;   //4.18879 = 4/3 pi, as in the statechart
+            double chasteVolume = population.GetVolumeOfCell(*cell_iter);
+            double estimatedVolume = estimator.GetVolume(p_node->GetIndex(), radius);
+
+            *comparisonFile << cell_iter->GetCellId() << "\t" << radius << "\t"
+                            << cell_iter->GetCellData()->GetItem("CellCyclePhase") << "\t"
+                            << chasteVolume << "\t" << estimatedVolume << "\n";
+
+            bool chasteCompressed = chasteVolume < threshold*relaxedVolume;
+            bool estimateCompressed = estimatedVolume < threshold*relaxedVolume;
+            numChasteCompressed += chasteCompressed ? 1 : 0;
+            numEstimateCompressed += estimateCompressed ? 1 : 0;
+            numAgree += (chasteCompressed == estimateCompressed) ? 1 : 0;
+            estimatedProportions.push_back(estimatedVolume/relaxedVolume);
+
+            numCells++;
+            sumRatio += estimatedVolume/chasteVolume;
+            sumX += chasteVolume;
+            sumY += estimatedVolume;
+            sumXX += chasteVolume*chasteVolume;
+            sumYY += estimatedVolume*estimatedVolume;
+            sumXY += chasteVolume*estimatedVolume;
+        }
+        comparisonFile->close();
+        if (numCells == 0){
+            EXCEPTION("No germ cells to compare in " << snapshotFile);
+        }
+
+        //----------------------------------------------------------------------------
+
+
+
+        //4) Summarise----------------------------------------------------------------
+
+        double covariance = sumXY - sumX*sumY/numCells;
+        double varianceX = sumXX - sumX*sumX/numCells;
+        double varianceY = sumYY - sumY*sumY/numCells;
+        double correlation = (varianceX > 0.0 && varianceY > 0.0) ? covariance/sqrt(varianceX*varianceY) : 1.0;
+
+        //The threshold below which the estimate finds as many compressed cells as Chaste's volumes do
+        std::sort(estimatedProportions.begin(), estimatedProportions.end());
+        double matchingThreshold = 0.0;
+        if (numChasteCompressed == numCells){
+            matchingThreshold = estimatedProportions.back();
+        }else if (numChasteCompressed > 0){
+            matchingThreshold = 0.5*(estimatedProportions[numChasteCompressed-1] + estimatedProportions[numChasteCompressed]);
+        }
+
+        std::cout << "Germ cells compared:\t" << numCells << std::endl;
+        std::cout << "Mean estimated/Chaste volume:\t" << sumRatio/numCells << std::endl;
+        std::cout << "Correlation:\t" << correlation << std::endl;
+        std::cout << "Compressed at parameter 29 = " << threshold << " (Chaste, estimate):\t"
+                  << numChasteCompressed << "\t" << numEstimateCompressed << std::endl;
+        std::cout << "Agreement on compression:\t" << (double)numAgree/numCells << std::endl;
+        std::cout << "Parameter 29 matching Chaste's compressed count:\t" << matchingThreshold << std::endl;
+
+        //----------------------------------------------------------------------------
+    }
+};
+
+#endif /* TESTCOMPAREVOLUMEESTIMATES_HPP_ */
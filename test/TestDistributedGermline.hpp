@@ -0,0 +1,160 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTDISTRIBUTEDGERMLINE_HPP_
+#define TESTDISTRIBUTEDGERMLINE_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include <string>
+#include <iostream>
+#include <vector>
+#include <map>
+
+//Elegans specific headers
+#include "GlobalParameterStruct.hpp"                // parameter storage and read-in from file
+#include "GermlineSimulation.hpp"                   // sets up the simulation
+#include "RunManifest.hpp"                          // seeding
+#include "AbstractSlabTransport.hpp"                // messages between the processes
+
+
+/*
+* Checks that a simulation whose force is worked out by several processes (see AbstractSlabTransport) keeps
+* every process's copy of the gonad the same. Runs the simulation in as many processes, forked on this machine, then every process sends
+* its cells' ids, radii and positions to process 0, which checks they are identical to its own.
+*
+* ./TestDistributedGermlineRunner "Baseline.txt" "DistributedCheck" <processes> [<parameter number> <value> ...]
+*
+* The remaining arguments change parameters as for TestElegansGermline, e.g. "35 5" for a short run, or
+* "47 8" for more slabs than processes. To check the MPI transport instead, build this test with
+* PetscSetupAndFinalize.hpp in place of FakePetscSetup.hpp and start it with mpirun; the number of processes
+* is then mpirun's.
+*/
+
+class TestDistributedGermline : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestProcessesAgree() throw(Exception){
+
+        //1) Read in the parameters, and the number of processes--------------------
+
+        char** argv = *(CommandLineArguments::Instance()->p_argv);
+        int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+        if (nArgs < 4){
+            EXCEPTION("Usage: TestDistributedGermlineRunner <parameter file> <output directory> <processes> [<parameter number> <value> ...]");
+        }
+        std::string myParameterFilesDirectory = "./projects/ElegansGermline/data/";
+        GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+        parameters->ConfigureFromFile(argv[1], myParameterFilesDirectory);
+        parameters->ResetDirectoryName(argv[2]);
+        parameters->ResetParameter(48, atof(argv[3]));
+        for (int i=4; i<nArgs-1; i+=2){
+            parameters->ResetParameter(atof(argv[i]), atof(argv[i+1]));
+        }
+
+        std::string seedSource;
+        unsigned seed = RunManifest::GetRunSeed(seedSource);
+        RunManifest::SeedRandomNumberGenerators(seed);
+
+        //----------------------------------------------------------------------------
+
+
+
+        //2) Run the simulation in every process--------------------------------------
+
+        GermlineSimulation germline;
+        germline.SetupFromParameters();
+        germline.rGetSimulator().Solve();
+
+        //----------------------------------------------------------------------------
+
+
+
+        //3) Compare every process's cells with process 0's----------------------------
+
+        boost::shared_ptr<AbstractSlabTransport> p_transport = germline.GetForce()->GetTransport();
+        TS_ASSERT(p_transport);
+        if (p_transport){
+            //Each cell's id, radius and position, in order of id
+            NodeBasedCellPopulation<3>& r_population = germline.rGetCellPopulation();
+            std::map<unsigned, std::vector<double> > cells;
+            for (AbstractCellPopulation<3>::Iterator cell_iter = r_population.Begin();
+                cell_iter != r_population.End(); ++cell_iter)
+            {
+                Node<3>* p_node = r_population.GetNode(r_population.GetLocationIndexUsingCell(*cell_iter));
+                std::vector<double>& r_cell = cells[cell_iter->GetCellId()];
+                r_cell.push_back(p_node->GetRadius());
+                for (unsigned j=0; j<3; j++){
+                    r_cell.push_back(p_node->rGetLocation()[j]);
+                }
+            }
+            std::vector<double> mine;
+            for (std::map<unsigned, std::vector<double> >::iterator it = cells.begin(); it != cells.end(); ++it){
+                mine.push_back(it->first);
+                mine.insert(mine.end(), it->second.begin(), it->second.end());
+            }
+
+            std::vector<std::vector<double> > all;
+            p_transport->AllGather(mine, all);
+            if (p_transport->GetRank() == 0){
+                std::cout << p_transport->GetNumProcesses() << " processes, " << cells.size() << " cells, "
+                          << germline.GetSlabs()->GetNumSlabs() << " slabs, rebalanced "
+                          << germline.GetSlabs()->GetNumRebalances() << " times" << std::endl;
+                for (unsigned rank = 1; rank < all.size(); rank++){
+                    TS_ASSERT_EQUALS(all[rank].size(), mine.size());
+                    unsigned numDifferent = 0;
+                    for (unsigned i = 0; i < mine.size() && i < all[rank].size(); i++){
+                        if (all[rank][i] != mine[i]){
+                            numDifferent++;
+                        }
+                    }
+                    TS_ASSERT_EQUALS(numDifferent, 0u);
+                    std::cout << "Process " << rank << ": " << numDifferent << " values differ from process 0's" << std::endl;
+                }
+            }
+        }
+
+        germline.FinishProcesses();
+
+        //----------------------------------------------------------------------------
+    }
+};
+
+#endif /* TESTDISTRIBUTEDGERMLINE_HPP_ */
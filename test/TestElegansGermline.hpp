@@ -49,10 +49,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "VolumeTrackingModifier.hpp"
 #include "CellAncestorWriter.hpp"
 #include "RandomNumberGenerator.hpp"
+#include "OutputFileHandler.hpp"
 #include <string>
 #include <iostream>
 #include <vector>
-#include <ctime>
 
 //Elegans specific headers
 #include "GlobalParameterStruct.hpp"                // parameter storage and read-in from file
@@ -61,11 +61,14 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "RepulsionForceSizeCorrected.hpp"          // force law
 #include "GonadArmDataOutput.hpp"                   // data recording
 #include "CellTrackingOutput.hpp"                   // cell tracking
+#include "GermlineVolumeTrackingModifier.hpp"       // cell volumes for contact inhibition
 #include "OocyteFatedCellApoptosis.hpp"             // apoptosis
 #include "Fertilisation.hpp"                        // fertilisation
 #include "StatechartCellCycleModel.hpp"             // statechart wrapper class
 #include "ElegansDevStatechartCellCycleModel.hpp"   // elegans specific changes in cell cycle length
 #include "FateUncoupledFromCycle.hpp"               // statechart model of cell behaviour 
+#include "GermlineSimulation.hpp"                   // sets up the simulation from the above
+#include "RunManifest.hpp"                          // seeding and a record of the run
 
 
 /*
@@ -82,13 +85,6 @@ public:
 
     void TestLarvalDevelopment() throw(Exception){
 
-        //0) Seed random number generator with the system time----------------------
-
-        int seed = (int)std::time(NULL);
-        std::cout << seed << std::endl;
-        RandomNumberGenerator::Instance()->Reseed(seed);      
-    
-
         //1) Read in parameter set from the config file specified in the first command 
         //line argument---------------------------------------------------------------
         
@@ -112,190 +108,63 @@ public:
         parameters->ResetDirectoryName( (*(CommandLineArguments::Instance()->p_argv))[2] );   
         std::cout << "New output directory name: " << (*(CommandLineArguments::Instance()->p_argv))[2] << std::endl;
         
+        // ResetParameter checks the number: a parameter file may stop short of the optional parameters
+        // (39 on), e.g. the seed a sweep gives as parameter 43, which are then added.
         int nArgs = (*(CommandLineArguments::Instance()->p_argc));
         
         for (int i=3; i<nArgs-1; i+=2){
-            parameters->ResetParameter(atof( (*(CommandLineArguments::Instance()->p_argv))[i] ) ,
+            parameters->ResetParameter(atoi( (*(CommandLineArguments::Instance()->p_argv))[i] ) ,
                                        atof( (*(CommandLineArguments::Instance()->p_argv))[i+1] ));
         
             std::cout << "Param number: " << 
-            atof( (*(CommandLineArguments::Instance()->p_argv))[i] ) <<
+            atoi( (*(CommandLineArguments::Instance()->p_argv))[i] ) <<
             " New value: " <<
             atof( (*(CommandLineArguments::Instance()->p_argv))[i+1] ) << std::endl;
         }
 
-        //---------------------------------------------------------------------------
-    
-
-
-        // 2) Create a node corresponding to each starting cell----------------------
-
-        std::vector< Node<3>* > nodes;
-        int cellIndex = 0;
-        for (double i = parameters->GetParameter(0); i >= 0; i--){ //parameters[0] is number of starting cells
-            Node<3>* newNode;
-            newNode = new Node<3>(cellIndex, false, 0, -parameters->GetParameter(7), 1.8*i); //cellID, _, x, y, z
-            nodes.push_back(newNode);
-            cellIndex++;
-        }
-        NodesOnlyMesh<3>* p_mesh = new NodesOnlyMesh<3>; //make a 3D mesh from the nodes
-        p_mesh->ConstructNodesWithoutMesh(nodes, 25);    //specify a max interaction distance of 25, > 2x max cell radius
-    
-        //----------------------------------------------------------------------------
-
-
-
-        // 3) Initialise some cells from the nodes, and select a cell cycle model-----
-
-        std::vector<CellPtr> cells;
-        MAKE_PTR(StemCellProliferativeType, p_stem_type);
-        MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
-
-        //choice of model is "ElegansDevStatechartCellCycleModel" with the statechart "FateUncoupledFromCycle":
-        CellsGenerator< ElegansDevStatechartCellCycleModel < FateUncoupledFromCycle >, 3> cells_generator;
-        
-        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumNodes(), p_stem_type);
-        NodeBasedCellPopulation<3> cell_population(*p_mesh, cells); // <- finally, we have a cell population!
-    
-        //----------------------------------------------------------------------------
-
-
-
-        // 4) Setup the properties of the cells---------------------------------------       
-
-        for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
-            cell_iter != cell_population.End(); ++cell_iter)
-        {
-            Node<3>* node = cell_population.GetNode(cell_population.GetLocationIndexUsingCell(*cell_iter));
-            if (node->GetIndex() == 0){
-                cell_iter->GetCellData()->SetItem("IsDTC", 1.0);  //Make the cell with node index 0 the DTC
-                cell_iter->SetCellProliferativeType(p_diff_type); //The DTC is terminally differentiated
-            }
-            else{
-                cell_iter->GetCellData()->SetItem("IsDTC", 0.0);
-            }
-            cell_iter->GetCellData()->SetItem("DistanceAwayFromDTC", 0.0); //Set other cell data
-            cell_iter->GetCellData()->SetItem("RowNumber", 0.0);
-            cell_iter->GetCellData()->SetItem("Radius", parameters->GetParameter(9));  // parameters[9] = initial radius
-            cell_iter->GetCellData()->SetItem("MaxRadius", parameters->GetParameter(9));   
-            cell_iter->GetCellData()->SetItem("SpermFated", 0.0);
-            cell_iter->GetCellData()->SetItem("OocyteFated", 0.0);  
-            cell_iter->GetCellData()->SetItem("Differentiation_Sperm", 0.0);
-            cell_iter->GetCellData()->SetItem("Differentiation_Oocyte", 0.0);
-            cell_iter->GetCellData()->SetItem("Fertilised", 0.0);
-            cell_iter->GetCellData()->SetItem("PreviousClosestPointIndex", -1);
-            cell_iter->GetCellData()->SetItem("ArrestedFor", 0.0);
-            cell_iter->GetCellData()->SetItem("InProximalArm", 1.0);
-        }
-        cell_population.SetAbsoluteMovementThreshold(2.5);                      // Max cell movement in one timestep
-        cell_population.SetDampingConstantNormal(parameters->GetParameter(12)); // Baseline cell drag coefficient
-        cell_population.SetUseVariableRadii(true);                              // Different sized cells will be used
-        cell_population.SetCellAncestorsToLocationIndices();                    // Request cell lineage tracking
-        cell_population.AddCellWriter<CellAncestorWriter>();
-
-        //----------------------------------------------------------------------------
-
-
-
-        // 5) Setup the simulation----------------------------------------------------
-
-        OffLatticeSimulation<3> simulator(cell_population);
-        simulator.SetOutputDirectory(parameters->GetDirectory().c_str());    // Set output directory name
-        simulator.SetSamplingTimestepMultiple(parameters->GetParameter(36)); // How frequently to output a snapshot
-        simulator.SetDt(1.0/parameters->GetParameter(36));                   // Length of a timestep (parameters[36])
-        simulator.SetEndTime(parameters->GetParameter(35));                  // End time (parameters[35])
-        
-        //----------------------------------------------------------------------------
-
-
-    
-        // 6) Add a force between cells-----------------------------------------------
-
-        MAKE_PTR(RepulsionForceSizeCorrected<3>, p_force);
-        p_force->SetMeinekeSpringStiffness(parameters->GetParameter(13));   //Set force strength (parameters[13])
-        simulator.AddForce(p_force);
-    
-        //----------------------------------------------------------------------------
-
-
-    
-        // 7) Boundary Condition------------------------------------------------------
-
-        double MidlinePointSpacing = 2;
-        double initialGonadLength = 32;
-        std::vector< c_vector<double, 3> > MidlinePointCollection; // Points on the DTC path
-        std::vector< int > MidlinePointTypes;                      // Records whether a point is part of a straight or the turn
-        
-        //initialise the points on the gonad midline at start of the simulation: 
-        double newPointZ = 0;
-        c_vector<double, 3> aPoint;
-        while (newPointZ < initialGonadLength){
-            aPoint[0] = 0;
-            aPoint[1] = -parameters->GetParameter(7);   //y coord of the middle of the proximal straight
-            aPoint[2] = newPointZ;
-            MidlinePointCollection.push_back(aPoint);
-            MidlinePointTypes.push_back(0);             //0 codes for "part of the proximal straight"
-            newPointZ += MidlinePointSpacing;
-        }
-        //add code that moves the DTC
-        MAKE_PTR_ARGS(DTCMovementModel<3>, dtcMovement, (false, false, 0.0, MidlinePointCollection, MidlinePointTypes, aPoint, MidlinePointSpacing));
-        simulator.AddSimulationModifier(dtcMovement);
-        //add a leader cell based boundary condition
-        MAKE_PTR_ARGS(LeaderCellBoundaryCondition<3>, boundaryCondition, (&cell_population, dtcMovement, parameters->GetParameter(28)) ); //Parameters[28]: initial gonad radius
-        simulator.AddCellPopulationBoundaryCondition(boundaryCondition);
-    
-        //---------------------------------------------------------------------------
-
-
-    
-        // 8) Cell volume tracking, required to apply contact inhibition-------------
-
-        MAKE_PTR(VolumeTrackingModifier<3>, volumeTrackingForContactInhibition);
-        simulator.AddSimulationModifier(volumeTrackingForContactInhibition);
+        // Seed the random number generators from parameters[43], or if that is 0 from the output directory
+        // name, so that replicates never share a seed and any run can be repeated. The seed, parameters and
+        // build are recorded in RunManifest.txt in the output directory.
+        std::string seedSource;
+        unsigned seed = RunManifest::GetRunSeed(seedSource);
+        std::cout << "Seed: " << seed << " (from " << seedSource << ")" << std::endl;
+        RunManifest::SeedRandomNumberGenerators(seed);
+        RunManifest::Write(parameters->GetDirectory(), myParameterFilesDirectory + (*(CommandLineArguments::Instance()->p_argv))[1],
+                           seed, seedSource);
 
         //---------------------------------------------------------------------------
-
-    
     
-        // 9) Cell removal, by fertilization and apoptosis---------------------------
 
-        double lengthOfOvulationRegion = 20.0; //How close to the gonad's proximal end must a cell be before it can be removed
-        MAKE_PTR_ARGS(Fertilisation<3>, removalByFertilisation, (&cell_population, lengthOfOvulationRegion));
-        simulator.AddCellKiller(removalByFertilisation);
-        MAKE_PTR_ARGS(OocyteFatedCellApoptosis<3>, removalByApoptosis, (&cell_population, parameters->GetParameter(21))); // parameters[21] = cell death rate
-        simulator.AddCellKiller(removalByApoptosis);
 
-        //---------------------------------------------------------------------------
+        // 2) Build the simulation: starting cells behind the DTC, gonad boundary, force law, contact
+        // inhibition, cell removal and data output (see GermlineSimulation)-----------
 
-    
-    
-        // 10) Add some data output--------------------------------------------------
+        GermlineSimulation germline;
+        germline.SetupFromParameters();
+        OffLatticeSimulation<3>& simulator = germline.rGetSimulator();
 
-        MAKE_PTR_ARGS(GonadArmDataOutput<3>, dataRecording, (parameters->GetParameter(36))); // parameters[36] = timesteps per hour
-        simulator.AddSimulationModifier(dataRecording);
-        MAKE_PTR_ARGS(CellTrackingOutput<3>, positionRecording, (parameters->GetParameter(36), 1));
-        simulator.AddSimulationModifier(positionRecording);
-    
         //----------------------------------------------------------------------------
 
-    
 
-        // 11) Run simulation and save the final state--------------------------------
+
+        // 3) Run simulation and save the final state, both as a Chaste archive and as a snapshot (snapshots
+        // only hold a gonad with one arm). If the run was split across processes, each saves its own copy
+        // to its own directory, then the processes are ended.
         
         simulator.Solve();
         CellBasedSimulationArchiver<3, OffLatticeSimulation<3> >::Save(&simulator);
-    
-        //----------------------------------------------------------------------------
-
-
-
-        // 12) Delete nodes-----------------------------------------------------------
-        
-        for (unsigned i = 0; i<nodes.size(); i++)
-        {
-            delete nodes[i];
-        } 
+        std::string processDirectory = germline.GetProcessDirectory(parameters->GetDirectory());
+        OutputFileHandler handler(processDirectory, false);
+        if (germline.GetNumArms() == 1){
+            germline.SaveSnapshot(handler.GetOutputDirectoryFullPath() + "GermlineSnapshot.bin");
+        }
 
+        //Record when each parameter first affected the run, so a run restarted from the saved state
+        //knows which parameters it may change (see TestElegansGermlineFromCheckpoint). Saving the
+        //snapshot has already noted the apoptosis killer's use of parameters[21].
+        parameters->WriteFirstReadTimes(processDirectory);
+        germline.FinishProcesses();
+    
         //----------------------------------------------------------------------------
     }
 };
@@ -0,0 +1,213 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTELEGANSGERMLINEFROMCHECKPOINT_HPP_
+#define TESTELEGANSGERMLINEFROMCHECKPOINT_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "SmartPointers.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "CellBasedSimulationArchiver.hpp"
+#include "OutputFileHandler.hpp"
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <vector>
+
+//Elegans specific headers
+#include "GlobalParameterStruct.hpp"                // parameter storage and read-in from file
+#include "DTCMovementModel.hpp"                     // leader cell movement
+#include "LeaderCellBoundaryCondition.hpp"          // boundary condition
+#include "RepulsionForceSizeCorrected.hpp"          // force law
+#include "GonadArmDataOutput.hpp"                   // data recording
+#include "CellTrackingOutput.hpp"                   // cell tracking
+#include "GermlineVolumeTrackingModifier.hpp"       // cell volumes for contact inhibition
+#include "OocyteFatedCellApoptosis.hpp"             // apoptosis
+#include "Fertilisation.hpp"                        // fertilisation
+#include "GermlineOffLatticeSimulation.hpp"         // the simulation type GermlineSimulation saves
+#include "StatechartCellCycleModel.hpp"             // statechart wrapper class
+#include "ElegansDevStatechartCellCycleModel.hpp"   // elegans specific changes in cell cycle length
+#include "FateUncoupledFromCycle.hpp"               // statechart model of cell behaviour 
+#include "GermlineCheckpointModifier.hpp"           // periodic checkpoints, saved with the archive
+#include "RunManifest.hpp"                          // a record of the run
+
+
+/*
+* Continues a germ line simulation from the state saved at the end of an earlier run, with a
+* different parameter set. Used by warm started parameter sweeps, where the larval stage is run once
+* (TestElegansGermline with parameters[35] set to the fork time) and every variant of the adult stage
+* starts from its saved state. Run as:
+*
+* ./TestElegansGermlineFromCheckpointRunner "Baseline.txt" "MyOutput1" "LarvalRun" 12  21 0.2
+*
+* which loads the state saved by the run in LarvalRun at time 12, resets the parameters to those in
+* Baseline.txt, then applies any (parameter number, new value) pairs as for TestElegansGermline.
+*
+* Changing a parameter that the saved run had already used would give a simulation that no single 
+* parameter set could produce, so this is checked against the ParameterFirstReads.txt file the saved 
+* run wrote, and refused. Output for times before the fork stays in the saved run's directory.
+*/
+
+class TestElegansGermlineFromCheckpoint : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestAdultFromLarvalCheckpoint() throw(Exception){
+
+        //1) Read command line arguments----------------------------------------------
+
+        char** argv = *(CommandLineArguments::Instance()->p_argv);
+        int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+        if (nArgs < 5){
+            EXCEPTION("Usage: TestElegansGermlineFromCheckpointRunner <parameter file> <output directory> <saved run directory> <saved time> [<parameter number> <value>] ...");
+        }
+        std::string parameterFile = argv[1];
+        std::string outputDirectory = argv[2];
+        std::string checkpointDirectory = argv[3];
+        double checkpointTime = atof(argv[4]);
+
+        //----------------------------------------------------------------------------
+
+
+
+        //2) Load the saved simulation. This also restores the parameters it was run with.
+
+        OffLatticeSimulation<3>* p_simulator = 
+            CellBasedSimulationArchiver<3, OffLatticeSimulation<3> >::Load(checkpointDirectory, checkpointTime);
+
+        GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+        std::vector<double> savedParameters;
+        for (unsigned i = 0; i < parameters->GetNumParameters(); i++){
+            savedParameters.push_back(parameters->PeekParameter(i));
+        }
+
+        //----------------------------------------------------------------------------
+
+
+
+        //3) Set up the new parameters: config file first, then command line overrides
+
+        std::string myParameterFilesDirectory = "./projects/ElegansGermline/data/";
+        parameters->ConfigureFromFile(parameterFile, myParameterFilesDirectory);
+        parameters->ResetDirectoryName(outputDirectory);
+        for (int i=5; i<nArgs-1; i+=2){
+            parameters->ResetParameter(atoi(argv[i]), atof(argv[i+1]));
+            std::cout << "Param number: " << atoi(argv[i]) << " New value: " << atof(argv[i+1]) << std::endl;
+        }
+
+        //----------------------------------------------------------------------------
+
+
+
+        //4) Refuse to change any parameter the saved run has already used. parameters[35], the 
+        //end time, is exempt: the saved run stopped early precisely by changing it. So is parameters[43],
+        //the seed: the random number generators carry on from their saved state.
+
+        std::string readsFile = OutputFileHandler::GetChasteTestOutputDirectory() + checkpointDirectory + "/ParameterFirstReads.txt";
+        std::ifstream READS(readsFile.c_str());
+        if (!READS.is_open()){
+            EXCEPTION("Failed to open " << readsFile << ". Was the saved run made by TestElegansGermline?");
+        }
+        int index;
+        double firstRead;
+        while (READS >> index >> firstRead){
+            if (index == 35 || index == 43 || index >= (int)savedParameters.size()){
+                continue;
+            }
+            if (firstRead >= 0 && parameters->PeekParameter(index) != savedParameters[index]){
+                EXCEPTION("Parameter " << index << " was first used at time " << firstRead << ", before the saved state at time "
+                          << checkpointTime << ", so it cannot be changed when continuing from " << checkpointDirectory);
+            }
+        }
+        READS.close();
+
+        //The continued run's random numbers follow from the saved run's seed, so that is the one recorded
+        unsigned seed = 0;
+        std::string seedSource = "unknown (no manifest in " + checkpointDirectory + ")";
+        if (RunManifest::ReadRunSeed(checkpointDirectory, seed)){
+            seedSource = "continued from " + checkpointDirectory;
+        }
+        RunManifest::Write(parameters->GetDirectory(), myParameterFilesDirectory + parameterFile, seed, seedSource);
+
+        //----------------------------------------------------------------------------
+
+
+
+        //5) Rebuild the cell killers as GermlineSimulation made them, so that apoptosis uses the new death rate
+
+        AbstractCellPopulation<3>* p_population = &(p_simulator->rGetCellPopulation());
+        p_simulator->RemoveAllCellKillers();
+        unsigned numArms = 1;                   //parameters[45], which the saved run has used, so can't have changed
+        if (savedParameters.size() > 45){
+            numArms = (unsigned)(savedParameters[45] + 0.5);
+        }
+        double lengthOfOvulationRegion = 20.0;
+        for (unsigned arm = 0; arm < numArms; arm++){
+            MAKE_PTR_ARGS(Fertilisation<3>, removalByFertilisation, (p_population, lengthOfOvulationRegion));
+            if (numArms > 1){
+                removalByFertilisation->SetArm(arm);
+            }
+            p_simulator->AddCellKiller(removalByFertilisation);
+        }
+        MAKE_PTR_ARGS(OocyteFatedCellApoptosis<3>, removalByApoptosis, (p_population, parameters->PeekParameter(21)));
+        p_simulator->AddCellKiller(removalByApoptosis);
+
+        //----------------------------------------------------------------------------
+
+
+
+        //6) Run the rest of the simulation and save the final state------------------
+
+        p_simulator->SetOutputDirectory(parameters->GetDirectory().c_str());
+        p_simulator->SetEndTime(parameters->GetParameter(35));
+        p_simulator->Solve();
+        CellBasedSimulationArchiver<3, OffLatticeSimulation<3> >::Save(p_simulator);
+
+        if (removalByApoptosis->GetTimeOfFirstUse() >= 0){
+            parameters->RecordParameterRead(21, removalByApoptosis->GetTimeOfFirstUse());
+        }
+        parameters->WriteFirstReadTimes(parameters->GetDirectory());
+
+        delete p_simulator;
+
+        //----------------------------------------------------------------------------
+    }
+};
+
+#endif /* TESTELEGANSGERMLINEFROMCHECKPOINT_HPP_ */
@@ -0,0 +1,132 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTELEGANSGERMLINERESUME_HPP_
+#define TESTELEGANSGERMLINERESUME_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "CellBasedSimulationArchiver.hpp"
+#include "OutputFileHandler.hpp"
+#include <string>
+#include <iostream>
+
+//Elegans specific headers
+#include "GlobalParameterStruct.hpp"                // parameter storage
+#include "GermlineSnapshot.hpp"                     // checkpoint file format
+#include "GermlineCheckpointModifier.hpp"           // finds the latest checkpoint
+#include "GermlineSimulation.hpp"                   // rebuilds the simulation from a checkpoint
+
+
+/*
+* Resumes a germ line simulation that was killed part way through, from the latest valid checkpoint
+* written by its GermlineCheckpointModifier, and runs it to the end time in its parameter set. Run as:
+*
+* ./TestElegansGermlineResumeRunner "MyOutputDirectoryName"
+*
+* where MyOutputDirectoryName is the output directory of the interrupted run. An optional second argument
+* gives a new end time. The resumed run carries on in the results folder that holds the checkpoint: rows the
+* interrupted run recorded after the checkpoint are removed from GonadData.txt and TrackingData.txt, and the
+* resumed run appends to them, so the files read as one run.
+*/
+
+class TestElegansGermlineResume : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestResumeFromLatestCheckpoint() throw(Exception){
+
+        //1) Find the latest valid checkpoint-----------------------------------------
+
+        char** argv = *(CommandLineArguments::Instance()->p_argv);
+        int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+        if (nArgs < 2){
+            EXCEPTION("Usage: TestElegansGermlineResumeRunner <output directory> [<end time>]");
+        }
+        std::string outputDirectory = argv[1];
+        std::string checkpoint = GermlineCheckpointModifier::FindLatestCheckpoint(outputDirectory);
+        if (checkpoint.empty()){
+            EXCEPTION("No valid checkpoint found in " << outputDirectory);
+        }
+        std::string resultsDirectory = checkpoint.substr(0, checkpoint.rfind('/'));
+        GermlineSnapshot snapshot;
+        snapshot.ReadFromFile(OutputFileHandler::GetChasteTestOutputDirectory() + checkpoint);
+        std::cout << "Resuming from " << checkpoint << " at time " << snapshot.GetTime() << std::endl;
+
+        //----------------------------------------------------------------------------
+
+
+
+        //2) Rebuild the simulation. This restores the parameters, time and random number generator.
+
+        GermlineSimulation germline;
+        germline.SetupFromSnapshot(snapshot);
+        OffLatticeSimulation<3>& simulator = germline.rGetSimulator();
+
+        GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+        parameters->ResetDirectoryName(outputDirectory);    // <- in case the run's output has been moved
+        simulator.SetOutputDirectory(outputDirectory.c_str());
+        germline.ContinueInDirectory(resultsDirectory);
+        if (nArgs > 2){
+            parameters->ResetParameter(35, atof(argv[2]));
+            simulator.SetEndTime(atof(argv[2]));
+        }
+        if (snapshot.GetTime() >= parameters->PeekParameter(35)){
+            std::cout << "The checkpoint is already at the end time, nothing to do." << std::endl;
+            return;
+        }
+
+        //----------------------------------------------------------------------------
+
+
+
+        //3) Run the rest of the simulation and save the final state, as TestElegansGermline does
+
+        OutputFileHandler resultsHandler(resultsDirectory, false);
+        GermlineCheckpointModifier::DiscardOutputAfter(resultsHandler.GetOutputDirectoryFullPath(), snapshot.GetTime());
+        simulator.Solve();
+        CellBasedSimulationArchiver<3, OffLatticeSimulation<3> >::Save(&simulator);
+        OutputFileHandler handler(outputDirectory, false);
+        germline.SaveSnapshot(handler.GetOutputDirectoryFullPath() + "GermlineSnapshot.bin");
+        parameters->WriteFirstReadTimes(parameters->GetDirectory());
+
+        //----------------------------------------------------------------------------
+    }
+};
+
+#endif /* TESTELEGANSGERMLINERESUME_HPP_ */
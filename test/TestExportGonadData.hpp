@@ -0,0 +1,109 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTEXPORTGONADDATA_HPP_
+#define TESTEXPORTGONADDATA_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "OutputFileHandler.hpp"
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <dirent.h>
+
+//Elegans specific headers
+#include "BinaryRecordReader.hpp"                   // reads GonadData.bin
+
+
+/*
+* Converts the binary GonadData.bin files written when parameter 41 is set back into text, for the R scripts.
+* Run as:
+*
+* ./TestExportGonadDataRunner "MyOutputDirectoryName"
+*
+* which writes GonadData.txt next to each GonadData.bin in the run's results folders. The text is identical
+* to what the simulation writes without parameter 41, so plotGonadData.R and the other scripts read it as
+* they are. Adding "csv" as a second argument writes comma separated GonadData.csv files with a header row
+* instead.
+*/
+
+class TestExportGonadData : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestExportBinaryGonadData() throw(Exception){
+
+        char** argv = *(CommandLineArguments::Instance()->p_argv);
+        int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+        if (nArgs < 2){
+            EXCEPTION("Usage: TestExportGonadDataRunner <output directory> [csv]");
+        }
+        std::string outputDirectory = argv[1];
+        bool csv = (nArgs > 2 && std::string(argv[2]) == "csv");
+
+        //Every results_from_time_X folder of the run may have its own data file
+        OutputFileHandler handler(outputDirectory, false);
+        std::string fullPath = handler.GetOutputDirectoryFullPath();
+        DIR* p_dir = opendir(fullPath.c_str());
+        if (p_dir == NULL){
+            EXCEPTION("Could not read directory " << fullPath);
+        }
+        unsigned numExported = 0;
+        for (struct dirent* p_entry = readdir(p_dir); p_entry != NULL; p_entry = readdir(p_dir)){
+            std::string name(p_entry->d_name);
+            std::string binaryFile = fullPath + name + "/GonadData.bin";
+            if (name.compare(0, 18, "results_from_time_") != 0 || !std::ifstream(binaryFile.c_str()).is_open()){
+                continue;
+            }
+            BinaryRecordReader reader(binaryFile);
+            if (csv){
+                reader.WriteDelimited(fullPath + name + "/GonadData.csv", ",", true);
+            }else{
+                reader.WriteDelimited(fullPath + name + "/GonadData.txt", "\t", false);
+            }
+            std::cout << "Exported " << reader.GetNumRecords() << " records from " << binaryFile << std::endl;
+            numExported++;
+        }
+        closedir(p_dir);
+
+        if (numExported == 0){
+            std::cout << "No GonadData.bin files found in " << fullPath << std::endl;
+        }
+    }
+};
+
+#endif /* TESTEXPORTGONADDATA_HPP_ */
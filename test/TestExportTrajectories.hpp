@@ -0,0 +1,111 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTEXPORTTRAJECTORIES_HPP_
+#define TESTEXPORTTRAJECTORIES_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "OutputFileHandler.hpp"
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <cfloat>
+#include <cstdlib>
+#include <dirent.h>
+
+//Elegans specific headers
+#include "TrajectoryReader.hpp"                     // reads TrackingData.traj
+
+
+/*
+* Converts the compressed TrackingData.traj files written when parameter 41 is set back into text, for
+* getTreePath.R. Run as:
+*
+* ./TestExportTrajectoriesRunner "MyOutputDirectoryName" [<start time> <end time>]
+*
+* which writes TrackingData.txt next to each TrackingData.traj in the run's results folders, in the same
+* layout as the text output (with cells in ID order within each hour). Giving a start and end time only
+* exports that part of the run; thanks to the frame index, the rest of the file is not read.
+*/
+
+class TestExportTrajectories : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestExportCompressedTrajectories() throw(Exception){
+
+        char** argv = *(CommandLineArguments::Instance()->p_argv);
+        int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+        if (nArgs < 2){
+            EXCEPTION("Usage: TestExportTrajectoriesRunner <output directory> [<start time> <end time>]");
+        }
+        std::string outputDirectory = argv[1];
+        double startTime = -DBL_MAX;
+        double endTime = DBL_MAX;
+        if (nArgs > 3){
+            startTime = atof(argv[2]);
+            endTime = atof(argv[3]);
+        }
+
+        //Every results_from_time_X folder of the run may have its own trajectory file
+        OutputFileHandler handler(outputDirectory, false);
+        std::string fullPath = handler.GetOutputDirectoryFullPath();
+        DIR* p_dir = opendir(fullPath.c_str());
+        if (p_dir == NULL){
+            EXCEPTION("Could not read directory " << fullPath);
+        }
+        unsigned numExported = 0;
+        for (struct dirent* p_entry = readdir(p_dir); p_entry != NULL; p_entry = readdir(p_dir)){
+            std::string name(p_entry->d_name);
+            std::string trajectoryFile = fullPath + name + "/TrackingData.traj";
+            if (name.compare(0, 18, "results_from_time_") != 0 || !std::ifstream(trajectoryFile.c_str()).is_open()){
+                continue;
+            }
+            TrajectoryReader reader(trajectoryFile);
+            reader.WriteText(fullPath + name + "/TrackingData.txt", startTime, endTime);
+            std::cout << "Exported " << trajectoryFile << " (" << reader.GetNumFrames() << " frames)" << std::endl;
+            numExported++;
+        }
+        closedir(p_dir);
+
+        if (numExported == 0){
+            std::cout << "No TrackingData.traj files found in " << fullPath << std::endl;
+        }
+    }
+};
+
+#endif /* TESTEXPORTTRAJECTORIES_HPP_ */
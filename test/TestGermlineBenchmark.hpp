@@ -0,0 +1,113 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTGERMLINEBENCHMARK_HPP_
+#define TESTGERMLINEBENCHMARK_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include <string>
+#include <iostream>
+
+//Elegans specific headers
+#include "GlobalParameterStruct.hpp"                // parameter storage and read-in from file
+#include "GermlineBenchmark.hpp"                    // builds the synthetic gonads and times them
+
+
+/*
+* Times each part of a simulation step on synthetic gonads of 100, 1000, 10000 and 100000 cells (see
+* GermlineBenchmark), writing the results to BenchmarkResults.txt in the output directory. Run as:
+*
+* ./TestGermlineBenchmarkRunner "Baseline.txt" "MyBenchmark" [<tube length> [<timesteps> [<earlier benchmark> [<tolerance>]]]]
+*
+* The parameter file sets up the cells as for a normal run. The tube length, in microns, defaults to 300, and
+* the number of timesteps timed at each size to 10. If the output directory of an earlier benchmark is given,
+* the results are compared with it and the runner fails if any part has slowed by more than the tolerance
+* (default 0.1, i.e. 10%), so a change can be checked against the benchmark from before it. Compare results
+* from the same machine only.
+*/
+
+class TestGermlineBenchmark : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestScaling() throw(Exception){
+
+        //1) Read command line arguments and the parameter file-----------------------
+
+        char** argv = *(CommandLineArguments::Instance()->p_argv);
+        int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+        if (nArgs < 3){
+            EXCEPTION("Usage: TestGermlineBenchmarkRunner <parameter file> <output directory> [<tube length> [<timesteps> [<earlier benchmark> [<tolerance>]]]]");
+        }
+        std::string myParameterFilesDirectory = "./projects/ElegansGermline/data/";
+        GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+        parameters->ConfigureFromFile(argv[1], myParameterFilesDirectory);
+        std::string outputDirectory = argv[2];
+        parameters->ResetDirectoryName(outputDirectory);
+        double tubeLength = (nArgs > 3) ? atof(argv[3]) : 300.0;
+        unsigned numSteps = (nArgs > 4) ? (unsigned)atoi(argv[4]) : 10;
+
+        //----------------------------------------------------------------------------
+
+
+
+        //2) Time the synthetic gonads and save the results---------------------------
+
+        GermlineBenchmark benchmark(outputDirectory, tubeLength, numSteps);
+        benchmark.Run();
+        benchmark.WriteResults();
+
+        //----------------------------------------------------------------------------
+
+
+
+        //3) Compare with an earlier benchmark, if asked to---------------------------
+
+        if (nArgs > 5){
+            double tolerance = (nArgs > 6) ? atof(argv[6]) : 0.1;
+            unsigned numSlower = benchmark.CompareWithEarlierResults(argv[5], tolerance, std::cout);
+            if (numSlower > 0){
+                EXCEPTION(numSlower << " benchmark times are more than " << 100*tolerance << "% slower than in " << argv[5]);
+            }
+        }
+
+        //----------------------------------------------------------------------------
+    }
+};
+
+#endif /* TESTGERMLINEBENCHMARK_HPP_ */
@@ -0,0 +1,132 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTGERMLINEDETERMINISM_HPP_
+#define TESTGERMLINEDETERMINISM_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "OutputFileHandler.hpp"
+#include "CellPropertyRegistry.hpp"
+#include <string>
+#include <sstream>
+#include <fstream>
+
+//Elegans specific headers
+#include "GlobalParameterStruct.hpp"                // parameter storage and read-in from file
+#include "GermlineSimulation.hpp"                   // sets up the simulation
+#include "RunManifest.hpp"                          // seeding
+
+
+/*
+* Checks that how the work of a timestep is shared out does not change a run's results. A short run of a gonad
+* with two arms, from the Baseline.txt parameters and a fixed seed, is repeated with the arms worked out on
+* one thread and on several (parameter 46), and with its cells split into different numbers of slabs
+* (parameter 47). Every run's GonadData.txt and GonadDataArm1.txt must be the same, character for character.
+*/
+
+class TestGermlineDeterminism : public AbstractCellBasedTestSuite
+{
+private:
+
+    //Runs the two-armed gonad into the given directory, on the given number of threads and slabs, starting
+    //from the same state as a new run of TestElegansGermline whatever earlier runs did to the global state
+    void RunGonad(std::string directory, unsigned numThreads, unsigned numSlabs)
+    {
+        GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+        parameters->ConfigureFromFile("Baseline.txt", "./projects/ElegansGermline/data/");
+        parameters->ResetDirectoryName(directory);
+        parameters->ResetParameter(35, 6);
+        parameters->ResetParameter(43, 1234);
+        parameters->ResetParameter(45, 2);
+        parameters->ResetParameter(46, numThreads);
+        parameters->ResetParameter(47, numSlabs);
+
+        //Cell IDs pick each cell's random numbers, so they must start from the same place
+        CellId::ResetMaxCellId();
+        CellPropertyRegistry::Instance()->Clear();
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        std::string seedSource;
+        RunManifest::SeedRandomNumberGenerators(RunManifest::GetRunSeed(seedSource));
+
+        GermlineSimulation germline;
+        germline.SetupFromParameters();
+        germline.rGetSimulator().Solve();
+    }
+
+    //The whole of one of a run's output files, from the results folder Chaste made for it
+    std::string ReadOutput(std::string directory, std::string fileName)
+    {
+        std::string path = OutputFileHandler::GetChasteTestOutputDirectory() + directory + "/results_from_time_0/" + fileName;
+        std::ifstream file(path.c_str());
+        if (!file.is_open()){
+            EXCEPTION("Failed to open " << path);
+        }
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    //Checks that two runs wrote the same data for both arms
+    void CompareRuns(std::string firstDirectory, std::string secondDirectory)
+    {
+        const char* files[] = {"GonadData.txt", "GonadDataArm1.txt"};
+        for (unsigned i = 0; i < 2; i++){
+            std::string first = ReadOutput(firstDirectory, files[i]);
+            TS_ASSERT(!first.empty());
+            TS_ASSERT_EQUALS(first, ReadOutput(secondDirectory, files[i]));
+        }
+    }
+
+public:
+
+    void TestThreadsDoNotChangeResults() throw(Exception){
+        RunGonad("DeterminismCheck/OneThread", 1, 0);
+        RunGonad("DeterminismCheck/FourThreads", 4, 0);
+        CompareRuns("DeterminismCheck/OneThread", "DeterminismCheck/FourThreads");
+    }
+
+    void TestSlabsDoNotChangeResults() throw(Exception){
+        RunGonad("DeterminismCheck/NoSlabs", 4, 0);
+        RunGonad("DeterminismCheck/TwoSlabs", 4, 2);
+        RunGonad("DeterminismCheck/FiveSlabs", 4, 5);
+        CompareRuns("DeterminismCheck/NoSlabs", "DeterminismCheck/TwoSlabs");
+        CompareRuns("DeterminismCheck/NoSlabs", "DeterminismCheck/FiveSlabs");
+    }
+};
+
+#endif /* TESTGERMLINEDETERMINISM_HPP_ */
@@ -0,0 +1,129 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTGERMLINEWORKER_HPP_
+#define TESTGERMLINEWORKER_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include <string>
+#include <iostream>
+#include <cstdlib>
+
+//Elegans specific headers
+#include "GermlineWorker.hpp"                       // runs queued simulations in one process
+
+
+/*
+* Runs queued simulations one after another in a single process (see GermlineWorker). Start a worker on a
+* queue directory:
+*
+* ./TestGermlineWorkerRunner work "MyQueue" [<idle minutes>]
+*
+* which runs every job put in the queue until a file called STOP is created in it, or until no job has been
+* waiting for the given number of minutes (by default, it waits for ever). Several workers can share a queue.
+* Jobs are added with
+*
+* ./TestGermlineWorkerRunner submit "MyQueue" <job name> <parameter file or snapshot> <output directory> <seed> [<index> <value> ...]
+*
+* where the third argument is a parameter file in the data directory, or the path of a GermlineSnapshot (any
+* file ending in .bin) to continue from, the seed is 0 to seed the run from parameters[43] or the output
+* directory name as usual, and the (index, value) pairs change parameters as for TestElegansGermlineRunner.
+* Each job's progress is kept in <job name>.progress in the queue directory.
+*/
+
+class TestGermlineWorker : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestWorker() throw(Exception){
+
+        //1) Read command line arguments----------------------------------------------
+
+        char** argv = *(CommandLineArguments::Instance()->p_argv);
+        int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+        std::string mode = (nArgs > 1) ? argv[1] : "";
+        if ((mode != "work" || nArgs < 3) && (mode != "submit" || nArgs < 7)){
+            EXCEPTION("Usage: TestGermlineWorkerRunner work <queue directory> [<idle minutes>]\n"
+                      "   or: TestGermlineWorkerRunner submit <queue directory> <job name> <parameter file or snapshot> <output directory> <seed> [<index> <value> ...]");
+        }
+        std::string myParameterFilesDirectory = "./projects/ElegansGermline/data/";
+        std::string queueDirectory = argv[2];
+
+        //----------------------------------------------------------------------------
+
+
+
+        //2) Add a job to the queue----------------------------------------------------
+
+        if (mode == "submit"){
+            GermlineWorker::Job job;
+            job.Name = argv[3];
+            std::string source = argv[4];
+            if (source.size() > 4 && source.compare(source.size()-4, 4, ".bin") == 0){
+                job.SnapshotFile = source;
+            }else{
+                job.ParameterFile = source;
+            }
+            job.OutputDirectory = argv[5];
+            job.Seed = (unsigned)strtoul(argv[6], NULL, 10);
+            for (int i = 7; i < nArgs-1; i += 2){
+                job.ParameterChanges.push_back(std::make_pair((unsigned)atoi(argv[i]), atof(argv[i+1])));
+            }
+            GermlineWorker::SubmitJob(queueDirectory, job);
+            std::cout << "Submitted job " << job.Name << " to " << queueDirectory << std::endl;
+        }
+
+        //----------------------------------------------------------------------------
+
+
+
+        //3) Or run the queue's jobs until told to stop--------------------------------
+
+        if (mode == "work"){
+            double idleMinutes = (nArgs > 3) ? atof(argv[3]) : 0.0;
+            GermlineWorker worker(queueDirectory, myParameterFilesDirectory);
+            worker.Run(idleMinutes);
+            std::cout << "Ran " << worker.GetNumJobsRun() << " jobs, of which " << worker.GetNumJobsFailed()
+                      << " failed" << std::endl;
+        }
+
+        //----------------------------------------------------------------------------
+    }
+};
+
+#endif /* TESTGERMLINEWORKER_HPP_ */
@@ -0,0 +1,154 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTGOLDENTRAJECTORIES_HPP_
+#define TESTGOLDENTRAJECTORIES_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include <string>
+#include <iostream>
+
+//Elegans specific headers
+#include "GlobalParameterStruct.hpp"                // parameter storage and read-in from file
+#include "GermlineSnapshot.hpp"                     // the stored adult state
+#include "RunManifest.hpp"                          // the seed the replicates' seeds come from
+#include "GoldenTrajectories.hpp"                   // runs and compares the replicates
+
+
+/*
+* Regression check for changes that should not alter the model, but do change the order of its floating point
+* arithmetic (see GoldenTrajectories). First record a reference with the code before the change:
+*
+* ./TestGoldenTrajectoriesRunner record "Baseline.txt" "GoldenBaseline" "projects/ElegansGermline/data/Adult17h.bin" [<replicates> [<window length>]]
+*
+* which runs 8 replicates (by default) of a larval window, from time 0 to 2, and of an adult window, from the
+* snapshot's time for 2 hours, and writes GoldenTrajectories.txt to the output directory. The snapshot can be any
+* GermlineSnapshot, e.g. the GermlineSnapshot.bin of a TestElegansGermline run with parameters[35] = 17; give "-"
+* to leave the adult window out. The replicates' seeds are derived from parameters[43] or the output directory
+* name, as for any run. Then, with the changed code:
+*
+* ./TestGoldenTrajectoriesRunner check "GoldenTrajectories.txt" "GoldenCheck" [<z score> [<relative tolerance>]]
+*
+* repeats the reference's windows with the same parameter file, snapshot and seeds, writes GoldenComparison.txt
+* to the output directory, and fails if any quantity's replicate mean is more than z score (default 4) standard
+* errors plus the relative tolerance (default 0.01) from the reference's. The reference file is read from the
+* current directory, so keep references somewhere such as projects/ElegansGermline/data/.
+*/
+
+class TestGoldenTrajectories : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestAgainstReference() throw(Exception){
+
+        //1) Read command line arguments----------------------------------------------
+
+        char** argv = *(CommandLineArguments::Instance()->p_argv);
+        int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+        std::string mode = (nArgs > 1) ? argv[1] : "";
+        if (nArgs < 4 || (mode != "record" && mode != "check")){
+            EXCEPTION("Usage: TestGoldenTrajectoriesRunner record <parameter file> <output directory> [<adult snapshot> [<replicates> [<window length>]]]\n"
+                      "   or: TestGoldenTrajectoriesRunner check <reference file> <output directory> [<z score> [<relative tolerance>]]");
+        }
+        std::string myParameterFilesDirectory = "./projects/ElegansGermline/data/";
+        std::string outputDirectory = argv[3];
+
+        //----------------------------------------------------------------------------
+
+
+
+        //2) Record a reference: a larval window, and an adult window if given a snapshot
+
+        if (mode == "record"){
+            std::string snapshotFile = (nArgs > 4) ? argv[4] : "-";
+            unsigned numReplicates = (nArgs > 5) ? (unsigned)atoi(argv[5]) : 8;
+            double windowLength = (nArgs > 6) ? atof(argv[6]) : 2.0;
+
+            GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+            parameters->ConfigureFromFile(argv[2], myParameterFilesDirectory);
+            parameters->ResetDirectoryName(outputDirectory);
+            std::string seedSource;
+            unsigned seed = RunManifest::GetRunSeed(seedSource);
+            std::cout << "Seed: " << seed << " (from " << seedSource << ")" << std::endl;
+
+            GoldenTrajectories golden(outputDirectory, argv[2], myParameterFilesDirectory);
+            golden.AddWindow("Larval", "", windowLength, numReplicates, RunManifest::DeriveSeed(seed, "Larval"));
+            if (snapshotFile != "-"){
+                GermlineSnapshot snapshot;
+                snapshot.ReadFromFile(snapshotFile);
+                golden.AddWindow("Adult", snapshotFile, snapshot.GetTime() + windowLength, numReplicates,
+                                 RunManifest::DeriveSeed(seed, "Adult"));
+            }
+            golden.Run();
+            golden.WriteReference();
+            std::cout << "Recorded " << golden.GetNumQuantities() << " quantities in " << outputDirectory
+                      << "/GoldenTrajectories.txt" << std::endl;
+        }
+
+        //----------------------------------------------------------------------------
+
+
+
+        //3) Or repeat a reference's windows and compare with it-----------------------
+
+        if (mode == "check"){
+            double zScore = (nArgs > 4) ? atof(argv[4]) : 4.0;
+            double relativeTolerance = (nArgs > 5) ? atof(argv[5]) : 0.01;
+
+            GoldenTrajectories reference(outputDirectory, "", myParameterFilesDirectory);
+            reference.ReadReference(argv[2]);
+            GoldenTrajectories golden(outputDirectory, reference.GetParameterFile(), myParameterFilesDirectory);
+            for (unsigned i = 0; i < reference.rGetWindows().size(); i++){
+                const GoldenTrajectories::Window& rWindow = reference.rGetWindows()[i];
+                golden.AddWindow(rWindow.Name, rWindow.SnapshotFile, rWindow.EndTime, rWindow.NumReplicates, rWindow.Seed);
+            }
+            golden.Run();
+            golden.WriteReference();    // <- so that the new results can become the next reference
+
+            unsigned numFailed = golden.CompareWithReference(reference, zScore, relativeTolerance, std::cout);
+            if (numFailed > 0){
+                EXCEPTION(numFailed << " quantities differ from the reference " << argv[2] << " (see "
+                          << outputDirectory << "/GoldenComparison.txt)");
+            }
+        }
+
+        //----------------------------------------------------------------------------
+    }
+};
+
+#endif /* TESTGOLDENTRAJECTORIES_HPP_ */
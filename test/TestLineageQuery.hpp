@@ -0,0 +1,104 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTLINEAGEQUERY_HPP_
+#define TESTLINEAGEQUERY_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <cstdlib>
+
+//Elegans specific headers
+#include "LineageIndex.hpp"                         // indexes DivisionData files
+
+
+/*
+* Answers lineage questions from the division logs (DivisionData.txt or DivisionData.bin) of one or more runs.
+* Run as either of:
+*
+* ./TestLineageQueryRunner descendants <cell ID> <start time> <end time> "MyOutputDirectoryName" ["Another" ...]
+* ./TestLineageQueryRunner clones <time> "MyOutputDirectoryName" ["Another" ...]
+*
+* The first lists every descendant of a cell born between the two times, with its parent and birth time. The
+* second lists, for each founder (a cell present when division logging began) that has ever divided, the
+* number of cells its clone had produced by the given time, including any that have since died. Output is tab delimited, with the run directory in the first column.
+*
+* The first query of a run builds an index, LineageIndex.bin, in its output directory; later queries load it,
+* so only take as long as reading the part of the tree they need.
+*/
+
+class TestLineageQuery : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestQueryLineages() throw(Exception){
+
+        char** argv = *(CommandLineArguments::Instance()->p_argv);
+        int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+        std::string query = (nArgs > 1) ? argv[1] : "";
+        int firstDirectory = (query == "descendants") ? 5 : 3;
+        if ((query != "descendants" && query != "clones") || nArgs <= firstDirectory){
+            EXCEPTION("Usage: TestLineageQueryRunner descendants <cell ID> <start time> <end time> <output directory> [...]\n"
+                      "       TestLineageQueryRunner clones <time> <output directory> [...]");
+        }
+
+        for (int i = firstDirectory; i < nArgs; i++){
+            std::string outputDirectory = argv[i];
+            LineageIndex index;
+            index.LoadOrBuild(outputDirectory);
+
+            if (query == "descendants"){
+                std::vector<unsigned> descendants, parents;
+                std::vector<double> birthTimes;
+                index.GetDescendants(atoi(argv[2]), atof(argv[3]), atof(argv[4]), descendants, parents, birthTimes);
+                for (unsigned j = 0; j < descendants.size(); j++){
+                    std::cout << outputDirectory << "\t" << descendants[j] << "\t" << parents[j] << "\t" << birthTimes[j] << std::endl;
+                }
+            }else{
+                std::map<unsigned, unsigned> cloneSizes = index.GetCloneSizes(atof(argv[2]));
+                for (std::map<unsigned, unsigned>::const_iterator clone = cloneSizes.begin(); clone != cloneSizes.end(); ++clone){
+                    std::cout << outputDirectory << "\t" << clone->first << "\t" << clone->second << std::endl;
+                }
+            }
+        }
+    }
+};
+
+#endif /* TESTLINEAGEQUERY_HPP_ */
@@ -56,11 +56,14 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "RepulsionForce.hpp"
 #include "GonadArmDataOutput.hpp"
 #include "CellTrackingOutput.hpp"
+#include "GermlineVolumeTrackingModifier.hpp"
 #include "OocyteFatedCellApoptosis.hpp"
 #include "Fertilisation.hpp"
 #include "StatechartCellCycleModel.hpp"
 #include "ElegansDevStatechartCellCycleModel.hpp"
 #include "FateUncoupledFromCycle.hpp"
+#include "GermlineCheckpointModifier.hpp"
+#include "GermlineOffLatticeSimulation.hpp"
 
 /* 
 * Tests loading a C. elegans simulation from a saved file (unarchiving). 
@@ -68,7 +71,12 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 * startTime = the time at which the simulation being loaded finished
 * endTime = the desired end time for this simulation
 * directory = the directory name for the loaded simulation (under testoutput) -
-* currently set to Baseline
+* defaults to Baseline, 1.0 and 1.5, or can be given on the command line as
+*
+* ./TestLoadOffLatticeFromArchiveRunner "Baseline" 1.0 1.5
+*
+* To carry on a run that was killed part way through, use TestElegansGermlineResume instead, which
+* starts from the run's latest checkpoint.
 */
 
 class TestLoadOffLatticeFromArchive : public AbstractCellBasedTestSuite
@@ -81,6 +89,14 @@ public:
     double startTime = 1.0;
     double endTime = 1.5;
     std::string directory = std::string("Baseline");
+
+    char** argv = *(CommandLineArguments::Instance()->p_argv);
+    int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+    if (nArgs > 3){
+      directory = argv[1];
+      startTime = atof(argv[2]);
+      endTime = atof(argv[3]);
+    }
 	
   	OffLatticeSimulation<3>* p_simulator = 
             CellBasedSimulationArchiver<3, OffLatticeSimulation<3> >::Load(directory, startTime);
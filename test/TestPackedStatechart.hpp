@@ -0,0 +1,247 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTCELLRANDOMSTREAMS_HPP_
+#define TESTCELLRANDOMSTREAMS_HPP_
+#ifndef TESTPACKEDSTATECHART_HPP_
+#define TESTPACKEDSTATECHART_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "SmartPointers.hpp"
+#include "CellData.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "StemCellProliferativeType.hpp"
+#include <bitset>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+//Elegans specific headers
+#include "GlobalParameterStruct.hpp"                // parameter storage and read-in from file
+#include "CellRandomStreams.hpp"                    // the cells' random number streams
+#include "StatechartModelRegistry.hpp"              // restores the charts' cell cycle models
+#include "ElegansDevStatechartCellCycleModel.hpp"   // elegans specific changes in cell cycle length
+#include "FateUncoupledFromCycle.hpp"               // the boost statechart model
+#include "FateUncoupledFromCyclePacked.hpp"         // the same model, generated with a packed state
+
+
+/*
+* Checks that FateUncoupledFromCyclePacked, generated by PythonScripts/GenerateStatechart.py with its behaviour
+* written by hand, stays the same model as FateUncoupledFromCycle.
+*
+* Pairs of cells, one with each chart, start on the same random stream, and are updated side by side for a
+* day of development with the Baseline.txt parameters, with the same changes to their position and volume.
+* After every update the two charts must be in the same state, with the same variables, and have left their
+* cells with the same cell data. Ready cells divide, and every so often a pair is saved and restored as a
+* checkpoint restores them, which must change nothing. The generated files must also be what the script
+* writes from FateUncoupledFromCyclePacked.json, so that neither has been changed without the other.
+*/
+
+class TestPackedStatechart : public AbstractCellBasedTestSuite
+{
+private:
+
+    //A cell with a new chart, on the given random stream, born at the given time at the given distance from the DTC
+    template<class CHART>
+    CellPtr MakeCell(double streamKey, double birthTime, double distance)
+    {
+        MAKE_PTR(CellData, p_cell_data);
+        p_cell_data->SetItem("RandomStream", streamKey);
+        p_cell_data->SetItem("RandomDraws", 0.0);
+        p_cell_data->SetItem("DistanceAwayFromDTC", distance);
+        p_cell_data->SetItem("IsDTC", 0.0);
+        p_cell_data->SetItem("Radius", 2.8);
+        p_cell_data->SetItem("MaxRadius", 5.48);
+        p_cell_data->SetItem("volume", 4.18879*2.8*2.8*2.8);
+        p_cell_data->SetItem("ArrestedFor", 0.0);
+        CellPropertyCollection properties;
+        properties.AddProperty(p_cell_data);
+
+        ElegansDevStatechartCellCycleModel<CHART>* p_model = new ElegansDevStatechartCellCycleModel<CHART>();
+        p_model->SetBirthTime(birthTime);
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        CellPtr p_cell(new Cell(p_state, p_model, false, properties));
+        p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<StemCellProliferativeType>());
+        p_cell->InitialiseCellCycleModel();
+        return p_cell;
+    }
+
+    //The cell as a checkpoint or snapshot restores it: a new cell with the same cell data, whose cell cycle
+    //model (registry model modelNumber) puts the chart back in its saved state and variables
+    CellPtr RestoreCell(CellPtr pCell, unsigned modelNumber)
+    {
+        AbstractStatechartCellCycleModel* p_saved = dynamic_cast<AbstractStatechartCellCycleModel*>(pCell->GetCellCycleModel());
+        AbstractCellCycleModel* p_model = StatechartModelRegistry::Instance()->GetModel(modelNumber).CreateRestoredCellCycleModel(
+            p_saved->GetChartState(), p_saved->GetChartVariables());
+        p_model->SetBirthTime(pCell->GetBirthTime());
+
+        MAKE_PTR(CellData, p_cell_data);
+        std::vector<std::string> keys = pCell->GetCellData()->GetKeys();
+        for (unsigned k = 0; k < keys.size(); k++){
+            p_cell_data->SetItem(keys[k], pCell->GetCellData()->GetItem(keys[k]));
+        }
+        CellPropertyCollection properties;
+        properties.AddProperty(p_cell_data);
+
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        CellPtr p_cell(new Cell(p_state, p_model, false, properties));
+        p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<StemCellProliferativeType>());
+        return p_cell;
+    }
+
+    //Checks that two cells' charts are in the same state, with the same variables, and their cell data is the same
+    void CompareCells(CellPtr pFirst, CellPtr pSecond)
+    {
+        AbstractStatechartCellCycleModel* p_first = dynamic_cast<AbstractStatechartCellCycleModel*>(pFirst->GetCellCycleModel());
+        AbstractStatechartCellCycleModel* p_second = dynamic_cast<AbstractStatechartCellCycleModel*>(pSecond->GetCellCycleModel());
+        TS_ASSERT_EQUALS(p_first->GetChartState(), p_second->GetChartState());
+        TS_ASSERT_EQUALS(pFirst->GetCellCycleModel()->GetCurrentCellCyclePhase(), pSecond->GetCellCycleModel()->GetCurrentCellCyclePhase());
+
+        std::vector<double> firstVariables = p_first->GetChartVariables();
+        std::vector<double> secondVariables = p_second->GetChartVariables();
+        TS_ASSERT_EQUALS(firstVariables.size(), secondVariables.size());
+        for (unsigned i = 0; i < firstVariables.size() && i < secondVariables.size(); i++){
+            TS_ASSERT_EQUALS(firstVariables[i], secondVariables[i]);
+        }
+
+        std::vector<std::string> firstKeys = pFirst->GetCellData()->GetKeys();
+        std::vector<std::string> secondKeys = pSecond->GetCellData()->GetKeys();
+        TS_ASSERT_EQUALS(firstKeys.size(), secondKeys.size());
+        for (unsigned k = 0; k < firstKeys.size() && k < secondKeys.size(); k++){
+            TS_ASSERT_EQUALS(firstKeys[k], secondKeys[k]);
+            TS_ASSERT_EQUALS(pFirst->GetCellData()->GetItem(firstKeys[k]), pSecond->GetCellData()->GetItem(secondKeys[k]));
+        }
+    }
+
+public:
+
+    void TestPackedChartMatchesBoostChart() throw(Exception){
+
+        GlobalParameterStruct* parameters = GlobalParameterStruct::Instance();
+        parameters->ConfigureFromFile("Baseline.txt", "./projects/ElegansGermline/data/");
+        CellRandomStreams::Instance()->SetSeed(2017);
+        unsigned boostModel = StatechartModelRegistry::Instance()->GetModelNumber("FateUncoupledFromCycle");
+        unsigned packedModel = StatechartModelRegistry::Instance()->GetModelNumber("FateUncoupledFromCyclePacked");
+
+        //A day from hatching covers the larval and adult cell cycles, and the sperm/oocyte switch (parameter 22)
+        double endTime = 24.0;
+        unsigned numSteps = 1200;
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(endTime, numSteps);
+        double dt = endTime/numSteps;
+
+        //Cells of staggered ages, from the DTC to beyond the mitotic zone (parameter 24)
+        std::vector<CellPtr> boostCells;
+        std::vector<CellPtr> packedCells;
+        for (unsigned i = 0; i < 20; i++){
+            boostCells.push_back(MakeCell<FateUncoupledFromCycle>(i + 1, -0.15*i, 5.0*i));
+            packedCells.push_back(MakeCell<FateUncoupledFromCyclePacked>(i + 1, -0.15*i, 5.0*i));
+            CompareCells(boostCells[i], packedCells[i]);
+        }
+
+        unsigned maxCells = 150;
+        unsigned numDivisions = 0;
+        unsigned numRestores = 0;
+        std::bitset<MAX_STATE_COUNT> initialStates, statesReached;
+        for (unsigned i = 0; i < boostCells.size(); i++){
+            initialStates |= dynamic_cast<AbstractStatechartCellCycleModel*>(boostCells[i]->GetCellCycleModel())->GetChartState();
+        }
+
+        for (unsigned step = 0; step < numSteps; step++){
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            unsigned numCells = boostCells.size();
+            for (unsigned i = 0; i < numCells; i++){
+
+                //Both cells drift away from the DTC, and are now and then compressed enough to arrest
+                double distance = boostCells[i]->GetCellData()->GetItem("DistanceAwayFromDTC") + 2.0*dt;
+                double radius = boostCells[i]->GetCellData()->GetItem("Radius");
+                double volume = 4.18879*radius*radius*radius;
+                if ((step/50 + i) % 5 == 0){
+                    volume *= 0.5;
+                }
+                boostCells[i]->GetCellData()->SetItem("DistanceAwayFromDTC", distance);
+                packedCells[i]->GetCellData()->SetItem("DistanceAwayFromDTC", distance);
+                boostCells[i]->GetCellData()->SetItem("volume", volume);
+                packedCells[i]->GetCellData()->SetItem("volume", volume);
+
+                bool boostReady = boostCells[i]->ReadyToDivide();
+                bool packedReady = packedCells[i]->ReadyToDivide();
+                TS_ASSERT_EQUALS(boostReady, packedReady);
+                CompareCells(boostCells[i], packedCells[i]);
+                statesReached |= dynamic_cast<AbstractStatechartCellCycleModel*>(boostCells[i]->GetCellCycleModel())->GetChartState();
+
+                if (boostReady && packedReady && boostCells.size() < maxCells){
+                    boostCells.push_back(boostCells[i]->Divide());
+                    packedCells.push_back(packedCells[i]->Divide());
+                    CompareCells(boostCells[i], packedCells[i]);
+                    CompareCells(boostCells.back(), packedCells.back());
+                    numDivisions++;
+                }
+
+                //Now and then the pair is saved and restored, after which both carry on as before
+                if ((step + 7*i) % 250 == 125){
+                    CellPtr p_boost = RestoreCell(boostCells[i], boostModel);
+                    CellPtr p_packed = RestoreCell(packedCells[i], packedModel);
+                    CompareCells(p_boost, boostCells[i]);
+                    CompareCells(p_packed, packedCells[i]);
+                    boostCells[i] = p_boost;
+                    packedCells[i] = p_packed;
+                    numRestores++;
+                }
+            }
+        }
+
+        //The run must have exercised division, restoring and the charts' transitions
+        TS_ASSERT_LESS_THAN(0u, numDivisions);
+        TS_ASSERT_LESS_THAN(0u, numRestores);
+        TS_ASSERT_LESS_THAN(initialStates.count(), statesReached.count());
+
+        StatechartModelRegistry::Destroy();
+        CellRandomStreams::Destroy();
+        GlobalParameterStruct::Destroy();
+    }
+
+    void TestGeneratedFilesMatchDescription() throw(Exception){
+
+        //Run from the Chaste directory, as the runners are. Fails if the generated files have been edited by
+        //hand, or the description changed without regenerating them.
+        std::string command = "python projects/ElegansGermline/PythonScripts/GenerateStatechart.py --check "
+                              "projects/ElegansGermline/src/statechart/FateUncoupledFromCyclePacked.json";
+        TS_ASSERT_EQUALS(system(command.c_str()), 0);
+    }
+};
+
+#endif /*TESTPACKEDSTATECHART_HPP_*/
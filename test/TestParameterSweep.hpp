@@ -0,0 +1,160 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTPARAMETERSWEEP_HPP_
+#define TESTPARAMETERSWEEP_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "CommandLineArguments.hpp"
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <boost/shared_ptr.hpp>
+
+//Elegans specific headers
+#include "ParameterSweepDesign.hpp"     // sweep specification read-in and design point generation
+#include "SweepJobManifest.hpp"         // list of jobs and their status
+#include "LocalJobScheduler.hpp"        // runs jobs across local cores
+#include "SobolIndexAccumulator.hpp"    // running Sobol indices of Saltelli designs
+
+
+/*
+* Runs a parameter sweep of the germ line model, as described by a sweep file in the data directory.
+* Run as ./TestParameterSweepRunner "ExampleSweep.txt" [<hours between sensitivity outputs>]
+*
+* The sweep file names a base parameter file, the simulation executable to run (normally
+* TestElegansGermlineRunner), the design (Grid, LatinHypercube, Sobol or Saltelli) and the range of each varied
+* parameter. Every design point and replicate becomes one job, with its own output directory under
+* the sweep's output directory. Running the same sweep again resumes it: completed jobs are skipped.
+*
+* If the sweep file gives a fork time, the run up to that time is simulated once per replicate and
+* each design point continues from the saved state (TestElegansGermlineFromCheckpoint), provided
+* none of the varied parameters were used before the fork.
+* Once all jobs have finished, SweepIndex.txt maps each output directory to its parameter values, and
+* SweepSummary.txt gives the mean, standard deviation and quantiles of each design point's GonadData.
+*
+* For a Saltelli design, the Sobol indices of GonadData columns sampled every few hours (by default 6; see the
+* optional argument) are accumulated as jobs complete (see SobolIndexAccumulator) and written to SobolIndices.txt.
+*/
+
+class TestParameterSweep : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestRunSweep() throw(Exception){
+
+        //1) Read in the sweep file specified in the first command line argument------
+
+        std::string sweepFile = (*(CommandLineArguments::Instance()->p_argv))[1];
+        int nArgs = *(CommandLineArguments::Instance()->p_argc);
+        double hoursBetweenOutputs = (nArgs > 2) ? atof((*(CommandLineArguments::Instance()->p_argv))[2]) : 6.0;
+        std::cout << std::endl << "Selected sweep file: " << sweepFile << std::endl;
+        std::string myParameterFilesDirectory = "./projects/ElegansGermline/data/";
+
+        ParameterSweepDesign design;
+        design.ConfigureFromFile(sweepFile, myParameterFilesDirectory);
+
+        //----------------------------------------------------------------------------
+
+
+
+        //2) Load the manifest of a previous run of this sweep, or build a new one----
+
+        SweepJobManifest manifest(design.GetSweepName());
+        if (manifest.LoadFromFile()){
+            std::cout << "Resuming sweep " << design.GetSweepName() << ": "
+                      << manifest.GetNumJobsWithStatus(COMPLETE) << " of " << manifest.GetNumJobs()
+                      << " jobs already complete" << std::endl;
+        }else{
+            manifest.BuildFromDesign(design);
+            std::cout << "New sweep " << design.GetSweepName() << " with " << manifest.GetNumJobs() << " jobs" << std::endl;
+        }
+        manifest.Save();
+
+        //----------------------------------------------------------------------------
+
+
+
+        //3) Run the outstanding jobs, then write the index and summary---------------
+
+        LocalJobScheduler scheduler(design.GetExecutable(), design.GetBaseParameterFile(), design.GetMaxConcurrentJobs());
+        std::cout << "Running up to " << scheduler.GetMaxConcurrentJobs() << " jobs at once" << std::endl;
+        scheduler.SetSeed(design.GetSeed());
+
+        //Saltelli designs: fold each job into the Sobol index sums as it completes, starting with any that
+        //completed before an interruption
+        boost::shared_ptr<SobolIndexAccumulator> p_accumulator;
+        if (design.GetDesignType() == "Saltelli"){
+            p_accumulator.reset(new SobolIndexAccumulator(design, hoursBetweenOutputs));
+            p_accumulator->LoadFromFile();
+            p_accumulator->CatchUp(manifest);
+            scheduler.AddObserver(p_accumulator.get());
+        }
+
+        //Warm starts: run the larval stages first, then check that none of them used a varied parameter
+        //before the fork. If any did, forking would be invalid, so every job is run from scratch instead.
+        if (design.GetForkTime() > 0.0){
+            scheduler.SetWarmStart(design.GetForkExecutable(), design.GetForkTime());
+            scheduler.Run(manifest, true);
+            std::vector<int> usedBeforeFork = manifest.FindParametersUsedBeforeFork();
+            if (!usedBeforeFork.empty()){
+                std::cout << "Parameters";
+                for (unsigned i = 0; i < usedBeforeFork.size(); i++){
+                    std::cout << " " << usedBeforeFork[i];
+                }
+                std::cout << " are used before time " << design.GetForkTime() << ", running all jobs from scratch" << std::endl;
+                manifest.ConvertForkedJobsToFullRuns();
+            }
+        }
+        scheduler.Run(manifest);
+        manifest.WriteIndex();
+        manifest.WriteSummary();
+        if (p_accumulator){
+            p_accumulator->WriteIndices();
+            std::cout << "Sobol indices from " << p_accumulator->GetNumGroupsFolded() << " base samples (counting replicates) are in "
+                      << design.GetSweepName() << "/SobolIndices.txt" << std::endl;
+        }
+
+        std::cout << manifest.GetNumJobsWithStatus(COMPLETE) << " jobs complete, "
+                  << manifest.GetNumJobsWithStatus(FAILED) << " failed" << std::endl;
+
+        //----------------------------------------------------------------------------
+    }
+};
+
+#endif /* TESTPARAMETERSWEEP_HPP_ */
@@ -0,0 +1,92 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTSUMMARISEGONADDATA_HPP_
+#define TESTSUMMARISEGONADDATA_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "OutputFileHandler.hpp"
+#include <string>
+#include <iostream>
+#include <iomanip>
+
+//Elegans specific headers
+#include "EnsembleStatistics.hpp"                   // replicate means, SDs and quantiles
+#include "GonadArmDataOutput.hpp"                   // GonadData column names
+
+
+/*
+* Summarises the GonadData of a set of replicate runs, for plotGonadData.R. Run as:
+*
+* ./TestSummariseGonadDataRunner "SummaryDirectoryName" "Replicate0" "Replicate1" ...
+*
+* which reads GonadData.txt (or GonadData.bin) from the results folders of each replicate and writes
+* GonadDataSummary.txt to the first directory: for each sampling time, the number of replicates with data
+* and each column's mean, standard deviation and 5%, 50% and 95% quantiles across them. The summary
+* directory may also be one of the replicates.
+*/
+
+class TestSummariseGonadData : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestSummariseReplicates() throw(Exception){
+
+        char** argv = *(CommandLineArguments::Instance()->p_argv);
+        int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+        if (nArgs < 3){
+            EXCEPTION("Usage: TestSummariseGonadDataRunner <summary directory> <replicate directory> [...]");
+        }
+
+        EnsembleStatistics ensemble(GonadArmDataOutput<3>::GetColumnNames());
+        for (int i = 2; i < nArgs; i++){
+            unsigned numRecords = ensemble.AddRun(argv[i], "GonadData");
+            std::cout << "Read " << numRecords << " records from " << argv[i] << std::endl;
+        }
+
+        OutputFileHandler handler(argv[1], false);
+        out_stream SUMMARY = handler.OpenOutputFile("GonadDataSummary.txt");
+        *SUMMARY << std::setprecision(12);
+        ensemble.WriteHeader(*SUMMARY);
+        ensemble.WriteRows(*SUMMARY);
+        SUMMARY->close();
+        std::cout << "Summarised " << ensemble.GetNumRuns() << " runs at " << ensemble.GetNumTimePoints()
+                  << " times in " << handler.GetOutputDirectoryFullPath() << "GonadDataSummary.txt" << std::endl;
+    }
+};
+
+#endif /* TESTSUMMARISEGONADDATA_HPP_ */
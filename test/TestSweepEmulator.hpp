@@ -0,0 +1,138 @@
+/*
+Copyright (c) 2005-2015, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TESTSWEEPEMULATOR_HPP_
+#define TESTSWEEPEMULATOR_HPP_
+
+//Chaste and system headers
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "CommandLineArguments.hpp"
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+//Elegans specific headers
+#include "ParameterSweepDesign.hpp"     // sweep specification read-in
+#include "SweepJobManifest.hpp"         // list of jobs and their status
+#include "SweepEmulator.hpp"            // Gaussian process emulators of the sweep's outputs
+
+
+/*
+* Trains emulators of a finished (or partly finished) parameter sweep's GonadData and uses them to estimate
+* which of the varied parameters matter (see SweepEmulator). Run as
+*
+* ./TestSweepEmulatorRunner "ExampleSweep.txt" [<hours between outputs> [<new points>]]
+*
+* Each of GonadLength, ProliferativeCount, SpermCount, FirstMeioticRow and LastMitoticRow is emulated every given
+* number of hours (by default 6). The fit of each emulator, the Sobol indices of each output and the parameters
+* ranked by their average total order index are written to EmulatorFit.txt, EmulatorSobolIndices.txt and
+* EmulatorParameterRanking.txt in the sweep's output directory.
+*
+* Given a number of new points, that many design points are chosen where the emulators are least certain and
+* added to the sweep's manifest, with the design's number of replicates. Running TestParameterSweepRunner on the
+* same sweep file then simulates them, after which this can be run again.
+*/
+
+class TestSweepEmulator : public AbstractCellBasedTestSuite
+{
+
+public:
+
+    void TestEmulateSweep() throw(Exception){
+
+        //1) Read command line arguments and the sweep--------------------------------
+
+        char** argv = *(CommandLineArguments::Instance()->p_argv);
+        int nArgs = (*(CommandLineArguments::Instance()->p_argc));
+        if (nArgs < 2){
+            EXCEPTION("Usage: TestSweepEmulatorRunner <sweep file> [<hours between outputs> [<new points>]]");
+        }
+        std::string sweepFile = argv[1];
+        double hoursBetweenOutputs = (nArgs > 2) ? atof(argv[2]) : 6.0;
+        unsigned numNewPoints = (nArgs > 3) ? atoi(argv[3]) : 0;
+        std::string myParameterFilesDirectory = "./projects/ElegansGermline/data/";
+
+        ParameterSweepDesign design;
+        design.ConfigureFromFile(sweepFile, myParameterFilesDirectory);
+
+        SweepJobManifest manifest(design.GetSweepName());
+        if (!manifest.LoadFromFile()){
+            EXCEPTION("Sweep " << design.GetSweepName() << " has not been run yet.");
+        }
+
+        //----------------------------------------------------------------------------
+
+
+
+        //2) Train the emulators and estimate the Sobol indices-----------------------
+
+        SweepEmulator emulator(design);
+        unsigned numRuns = emulator.Train(manifest, hoursBetweenOutputs);
+        std::cout << "Trained " << emulator.GetNumOutputs() << " emulators on " << numRuns << " runs" << std::endl;
+        if (emulator.GetNumOutputs() == 0){
+            EXCEPTION("Too few completed runs to train the emulators.");
+        }
+
+        emulator.ComputeSobolIndices(1000);
+        emulator.WriteResults();
+
+        std::vector<double> totalOrder = emulator.GetMeanTotalOrderIndices();
+        std::cout << "Mean total order Sobol index of each parameter:" << std::endl;
+        for (unsigned p = 0; p < totalOrder.size(); p++){
+            std::cout << "  " << emulator.rGetParameterIndices()[p] << "\t" << totalOrder[p] << "\t"
+                      << emulator.rGetParameterNames()[p] << std::endl;
+        }
+        std::cout << "Emulator fit and Sobol indices are in " << design.GetSweepName() << std::endl;
+
+        //----------------------------------------------------------------------------
+
+
+
+        //3) Add new design points where the emulators are least certain--------------
+
+        if (numNewPoints > 0){
+            std::vector<std::vector<double> > points = emulator.ChooseNextPoints(numNewPoints, 500);
+            manifest.AddDesignPoints(points, design.GetNumberOfReplicates());
+            manifest.Save();
+            std::cout << "Added " << points.size() << " design points to the sweep; run TestParameterSweepRunner "
+                      << sweepFile << " to simulate them" << std::endl;
+        }
+
+        //----------------------------------------------------------------------------
+    }
+};
+
+#endif /* TESTSWEEPEMULATOR_HPP_ */